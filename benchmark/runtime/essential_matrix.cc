@@ -0,0 +1,88 @@
+#include "colmap/estimators/essential_matrix.h"
+
+#include "colmap/geometry/rigid3.h"
+#include "colmap/math/polynomial.h"
+#include "colmap/math/random.h"
+#include "colmap/util/eigen_alignment.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace colmap;
+
+struct FivePointProblem {
+  std::vector<Eigen::Vector3d> cam_rays1;
+  std::vector<Eigen::Vector3d> cam_rays2;
+};
+
+static std::vector<FivePointProblem> CreateFivePointProblems(
+    size_t num_problems) {
+  SetPRNGSeed(0);
+  std::vector<FivePointProblem> problems(num_problems);
+  for (FivePointProblem& problem : problems) {
+    const Rigid3d cam2_from_cam1(Eigen::Quaterniond::UnitRandom(),
+                                 Eigen::Vector3d::Random());
+    for (int i = 0; i < 5; ++i) {
+      problem.cam_rays1.push_back(Eigen::Vector3d::Random().normalized());
+      const double depth = RandomUniformReal<double>(0.2, 2.0);
+      problem.cam_rays2.push_back(
+          (cam2_from_cam1 * (depth * problem.cam_rays1.back())).normalized());
+    }
+  }
+  return problems;
+}
+
+static void BM_EssentialMatrixFivePointEstimator(benchmark::State& state) {
+  const std::vector<FivePointProblem> problems = CreateFivePointProblems(1000);
+  std::vector<Eigen::Matrix3d> models;
+  size_t problem_idx = 0;
+  for (auto _ : state) {
+    const FivePointProblem& problem = problems[problem_idx++ % problems.size()];
+    EssentialMatrixFivePointEstimator::Estimate(
+        problem.cam_rays1, problem.cam_rays2, &models);
+    benchmark::DoNotOptimize(models.data());
+  }
+}
+
+BENCHMARK(BM_EssentialMatrixFivePointEstimator);
+
+static std::vector<Eigen::Matrix<double, 11, 1>> CreatePolynomials(
+    size_t num_polynomials) {
+  SetPRNGSeed(0);
+  std::vector<Eigen::Matrix<double, 11, 1>> polynomials(num_polynomials);
+  for (Eigen::Matrix<double, 11, 1>& coeffs : polynomials) {
+    for (int i = 0; i < coeffs.size(); ++i) {
+      coeffs(i) = RandomUniformReal<double>(-1, 1);
+    }
+  }
+  return polynomials;
+}
+
+static void BM_FindPolynomialRootsCompanionMatrix(benchmark::State& state) {
+  const std::vector<Eigen::Matrix<double, 11, 1>> polynomials =
+      CreatePolynomials(1000);
+  Eigen::VectorXd real;
+  Eigen::VectorXd imag;
+  size_t polynomial_idx = 0;
+  for (auto _ : state) {
+    FindPolynomialRootsCompanionMatrix(
+        polynomials[polynomial_idx++ % polynomials.size()], &real, &imag);
+    benchmark::DoNotOptimize(real.data());
+  }
+}
+
+BENCHMARK(BM_FindPolynomialRootsCompanionMatrix);
+
+static void BM_FindRealPolynomialRootsSturm(benchmark::State& state) {
+  const std::vector<Eigen::Matrix<double, 11, 1>> polynomials =
+      CreatePolynomials(1000);
+  Eigen::Matrix<double, 10, 1> roots;
+  size_t polynomial_idx = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FindRealPolynomialRootsSturm<10>(
+        polynomials[polynomial_idx++ % polynomials.size()], &roots));
+  }
+}
+
+BENCHMARK(BM_FindRealPolynomialRootsSturm);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,70 @@
+import threading
+
+import numpy as np
+
+import pycolmap
+
+
+def create_database(tmp_path):
+    database = pycolmap.Database(tmp_path / "database.db")
+    synthetic_dataset_options = pycolmap.SyntheticDatasetOptions()
+    synthetic_dataset_options.num_frames_per_rig = 3
+    synthetic_dataset_options.num_points3D = 20
+    pycolmap.synthesize_dataset(synthetic_dataset_options, database)
+    database.clear_keypoints()
+    return database
+
+
+def create_keypoints(image_ids):
+    rng = np.random.default_rng(0)
+    num_keypoints = [5 * (i + 1) for i in range(len(image_ids))]
+    keypoints = rng.random((sum(num_keypoints), 6), dtype=np.float32)
+    offsets = np.concatenate([[0], np.cumsum(num_keypoints)]).astype(np.int64)
+    return keypoints, offsets
+
+
+def test_write_batch_inside_transaction(tmp_path):
+    database = create_database(tmp_path)
+    image_ids = sorted(image.image_id for image in database.read_all_images())
+    keypoints, offsets = create_keypoints(image_ids)
+
+    with pycolmap.DatabaseTransaction(database):
+        database.write_keypoints_batch(image_ids, keypoints, offsets)
+        assert database.num_keypoints() == keypoints.shape[0]
+
+    read_keypoints, read_offsets = database.read_keypoints_batch(image_ids)
+    np.testing.assert_array_equal(read_keypoints, keypoints)
+    np.testing.assert_array_equal(read_offsets, offsets)
+    database.close()
+
+
+def test_write_batch_concurrently(tmp_path):
+    database = create_database(tmp_path)
+    image_ids = sorted(image.image_id for image in database.read_all_images())
+    keypoints, offsets = create_keypoints(image_ids)
+
+    def write_batch(i):
+        database.write_keypoints_batch(
+            [image_ids[i]],
+            keypoints[offsets[i] : offsets[i + 1]],
+            np.array([0, offsets[i + 1] - offsets[i]], dtype=np.int64),
+        )
+
+    def read_single():
+        for _ in range(100):
+            database.num_images()
+            database.exists_keypoints(image_ids[0])
+
+    threads = [
+        threading.Thread(target=write_batch, args=(i,))
+        for i in range(len(image_ids))
+    ]
+    threads += [threading.Thread(target=read_single) for _ in range(2)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    read_keypoints, _ = database.read_keypoints_batch(image_ids)
+    np.testing.assert_array_equal(read_keypoints, keypoints)
+    database.close()
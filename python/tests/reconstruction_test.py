@@ -0,0 +1,49 @@
+import numpy as np
+
+import pycolmap
+
+
+def test_point3D_is_modified_in_place():
+    reconstruction = pycolmap.Reconstruction()
+    point3D_id = reconstruction.add_point3D(
+        np.array([1.0, 2.0, 3.0]), pycolmap.Track()
+    )
+    reconstruction.point3D(point3D_id).color = np.array([1, 2, 3])
+    reconstruction.points3D[point3D_id].xyz = np.array([4.0, 5.0, 6.0])
+    np.testing.assert_array_equal(
+        reconstruction.point3D(point3D_id).color, [1, 2, 3]
+    )
+    np.testing.assert_array_equal(
+        reconstruction.point3D(point3D_id).xyz, [4.0, 5.0, 6.0]
+    )
+
+
+def test_point3D_lookup_after_insertions():
+    reconstruction = pycolmap.Reconstruction()
+    point3D_id = reconstruction.add_point3D(
+        np.array([1.0, 2.0, 3.0]), pycolmap.Track()
+    )
+    for i in range(10000):
+        reconstruction.add_point3D(
+            np.array([float(i), 0.0, 0.0]), pycolmap.Track()
+        )
+    # References are invalidated by insertions and must be obtained again.
+    np.testing.assert_array_equal(
+        reconstruction.point3D(point3D_id).xyz, [1.0, 2.0, 3.0]
+    )
+    np.testing.assert_array_equal(
+        reconstruction.points3D[point3D_id].xyz, [1.0, 2.0, 3.0]
+    )
+
+
+def test_point3D_is_modified_through_arrays():
+    reconstruction = pycolmap.Reconstruction()
+    point3D_id = reconstruction.add_point3D(
+        np.array([1.0, 2.0, 3.0]), pycolmap.Track()
+    )
+    reconstruction.set_points3D_arrays(
+        np.array([point3D_id], dtype=np.uint64), np.array([[4.0, 5.0, 6.0]])
+    )
+    np.testing.assert_array_equal(
+        reconstruction.point3D(point3D_id).xyz, [4.0, 5.0, 6.0]
+    )
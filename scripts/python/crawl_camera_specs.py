@@ -56,93 +56,107 @@ def request_trial(func, *args, **kwargs):
     raise SystemError
 
 
-def main():
-    args = parse_args()
+SORTED_BY_MAKE_CHECK = """constexpr bool IsSortedByMake(const CameraMakeSpecs* makes,
+                              const size_t num_makes) {
+  for (size_t i = 1; i < num_makes; ++i) {
+    if (!(makes[i - 1].make < makes[i].make)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(IsSortedByMake(kCameraMakeSpecs, std::size(kCameraMakeSpecs)),
+              "Camera makes must be unique and sorted.");
+
+"""
+
+
+def make_identifier(make):
+    words = re.split(r"[^0-9a-z]+", make)
+    return "k" + "".join(word.capitalize() for word in words) + "Models"
+
+
+def write_specs(specs, path):
+    # The makes are sorted for a deterministic order, whereas the models are
+    # kept in the crawled order, which determines the result of ambiguous
+    # partial matches.
+    with open(path, "w") as f:
+        f.write('#include "colmap/sensor/specs.h"\n\n')
+        f.write("#include <iterator>\n\n")
+        f.write("namespace colmap {\n")
+        f.write("namespace {\n\n")
+        for make in sorted(specs):
+            f.write(
+                "constexpr CameraModelSpecs %s[] = {\n"
+                % make_identifier(make)
+            )
+            for model, sensor_width in specs[make]:
+                f.write('    {"%s", %.4ff},\n' % (model, sensor_width))
+            f.write("};\n\n")
 
-    ##########################################################################
-    # Header file
-    ##########################################################################
-
-    with open(args.lib_path + ".h", "w") as f:
-        f.write("#include <vector>\n")
-        f.write("#include <string>\n")
-        f.write("#include <unordered_map>\n\n")
-        f.write("// { make1 : ({ model1 : sensor-width in mm }, ...), ... }\n")
-        f.write(
-            "typedef std::vector<std::pair<std::string, float>> make_specs_t;\n"
-        )
-        f.write(
-            "typedef std::unordered_map<std::string, make_specs_t> camera_specs_t;;\n\n"
-        )
-        f.write("camera_specs_t InitializeCameraSpecs();\n\n")
+        f.write("constexpr CameraMakeSpecs kCameraMakeSpecs[] = {\n")
+        for make in sorted(specs):
+            identifier = make_identifier(make)
+            f.write(
+                '    {"%s", %s, std::size(%s)},\n'
+                % (make, identifier, identifier)
+            )
+        f.write("};\n\n")
+        f.write(SORTED_BY_MAKE_CHECK)
+        f.write("}  // namespace\n\n")
+        f.write("CameraSpecs GetCameraSpecs() {\n")
+        f.write("  return {kCameraMakeSpecs, std::size(kCameraMakeSpecs)};\n")
+        f.write("}\n\n")
+        f.write("}  // namespace colmap\n")
 
-    ##########################################################################
-    # Source file
-    ##########################################################################
+
+def main():
+    args = parse_args()
 
     makes_response = requests.get("http://www.digicamdb.com")
     makes_tree = soupparser.fromstring(makes_response.text)
     makes_node = makes_tree.find('.//select[@id="select_brand"]')
     makes = [b.attrib["value"] for b in makes_node.iter("option")]
 
-    with open(args.lib_path + ".cc", "w") as f:
-        f.write("camera_specs_t InitializeCameraSpecs() {\n")
-        f.write("  camera_specs_t specs;\n\n")
-        for make in makes:
-            f.write("  {\n")
-            f.write(
-                '    auto& make_specs = specs["%s"];\n'
-                % make.lower().replace(" ", "")
-            )
+    specs = {}
+    for make in makes:
+        make_specs = specs.setdefault(make.lower().replace(" ", ""), [])
 
-            models_response = request_trial(
-                requests.post,
-                "http://www.digicamdb.com/inc/ajax.php",
-                data={"b": make, "role": "header_search"},
-            )
+        models_response = request_trial(
+            requests.post,
+            "http://www.digicamdb.com/inc/ajax.php",
+            data={"b": make, "role": "header_search"},
+        )
 
-            models_tree = soupparser.fromstring(models_response.text)
-            models_code = ""
-            num_models = 0
-            for model_node in models_tree.iter("option"):
-                model = model_node.attrib.get("value")
-                model_name = model_node.text
-                if model is None:
-                    continue
-
-                url = "http://www.digicamdb.com/specs/{0}_{1}".format(
-                    make, model
-                )
-                specs_response = request_trial(requests.get, url)
-
-                specs_tree = soupparser.fromstring(specs_response.text)
-                for spec in specs_tree.findall('.//td[@class="info_key"]'):
-                    if spec.text.strip() == "Sensor:":
-                        sensor_text = spec.find("..").find(
-                            './td[@class="bold"]'
-                        )
-                        sensor_text = sensor_text.text.strip()
-                        m = re.match(".*?([\d.]+) x ([\d.]+).*?", sensor_text)
-                        sensor_width = m.group(1)
-                        data = (
+        models_tree = soupparser.fromstring(models_response.text)
+        for model_node in models_tree.iter("option"):
+            model = model_node.attrib.get("value")
+            model_name = model_node.text
+            if model is None:
+                continue
+
+            url = "http://www.digicamdb.com/specs/{0}_{1}".format(make, model)
+            specs_response = request_trial(requests.get, url)
+
+            specs_tree = soupparser.fromstring(specs_response.text)
+            for spec in specs_tree.findall('.//td[@class="info_key"]'):
+                if spec.text.strip() == "Sensor:":
+                    sensor_text = spec.find("..").find('./td[@class="bold"]')
+                    sensor_text = sensor_text.text.strip()
+                    m = re.match(".*?([\d.]+) x ([\d.]+).*?", sensor_text)
+                    sensor_width = m.group(1)
+                    make_specs.append(
+                        (
                             model_name.lower().replace(" ", ""),
                             float(sensor_width.replace(" ", "")),
                         )
-                        models_code += (
-                            '    make_specs.emplace_back("%s", %.4ff);\n' % data
-                        )
-
-                        print(make, model_name)
-                        print("   ", sensor_text)
-
-                        num_models += 1
+                    )
 
-            f.write("    make_specs.reserve(%d);\n" % num_models)
-            f.write(models_code)
-            f.write("  }\n\n")
+                    print(make, model_name)
+                    print("   ", sensor_text)
 
-        f.write("  return specs;\n")
-        f.write("}\n")
+    write_specs(specs, args.lib_path + ".cc")
 
 
 if __name__ == "__main__":
@@ -39,14 +39,16 @@
 #include "colmap/mvs/patch_match.h"
 #include "colmap/util/logging.h"
 
+#include <chrono>
+#include <thread>
+
 namespace colmap {
 
 AutomaticReconstructionController::AutomaticReconstructionController(
     const Options& options,
     std::shared_ptr<ReconstructionManager> reconstruction_manager)
     : options_(options),
-      reconstruction_manager_(std::move(reconstruction_manager)),
-      active_thread_(nullptr) {
+      reconstruction_manager_(std::move(reconstruction_manager)) {
   THROW_CHECK_DIR_EXISTS(options_.workspace_path);
   THROW_CHECK_DIR_EXISTS(options_.image_path);
   THROW_CHECK_NOTNULL(reconstruction_manager_);
@@ -155,8 +157,11 @@ AutomaticReconstructionController::AutomaticReconstructionController(
 }
 
 void AutomaticReconstructionController::Stop() {
-  if (active_thread_ != nullptr) {
-    active_thread_->Stop();
+  {
+    std::lock_guard<std::mutex> lock(active_threads_mutex_);
+    for (Thread* thread : active_threads_) {
+      thread->Stop();
+    }
   }
   Thread::Stop();
 }
@@ -167,7 +172,12 @@ void AutomaticReconstructionController::Run() {
   }
 
   if (options_.extraction) {
-    RunFeatureExtraction();
+    if (options_.overlap_stages && options_.matching &&
+        options_.data_type == DataType::VIDEO) {
+      RunFeatureExtractionWithOverlappedMatching();
+    } else {
+      RunFeatureExtraction();
+    }
   }
 
   if (IsStopped()) {
@@ -197,11 +207,54 @@ void AutomaticReconstructionController::Run() {
 
 void AutomaticReconstructionController::RunFeatureExtraction() {
   THROW_CHECK_NOTNULL(feature_extractor_);
-  active_thread_ = feature_extractor_.get();
-  feature_extractor_->Start();
-  feature_extractor_->Wait();
+  StartActiveThread(feature_extractor_.get());
+  WaitActiveThread(feature_extractor_.get());
+  feature_extractor_.reset();
+}
+
+void AutomaticReconstructionController::
+    RunFeatureExtractionWithOverlappedMatching() {
+  THROW_CHECK_NOTNULL(feature_extractor_);
+  StartActiveThread(feature_extractor_.get());
+
+  // Sequentially match the images extracted so far in rounds of new images.
+  // Already matched pairs are skipped by later rounds and by the final
+  // matching after extraction, which also performs the loop detection.
+  SequentialPairingOptions pairing_options =
+      *option_manager_.sequential_pairing;
+  pairing_options.loop_detection = false;
+  FeatureMatchingOptions matching_options = *option_manager_.feature_matching;
+#if !defined(COLMAP_CUDA_ENABLED)
+  // The matchers of the rounds are created on this thread, but OpenGL contexts
+  // for GPU matching can only be created on the main thread.
+  matching_options.use_gpu = false;
+#endif
+  constexpr size_t kMinNumNewImages = 50;
+  const size_t min_num_new_images =
+      std::max<size_t>(kMinNumNewImages, pairing_options.overlap);
+
+  Database database(*option_manager_.database_path);
+  size_t num_matched_images = 0;
+  while (!feature_extractor_->IsFinished() && !IsStopped()) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    const size_t num_images = database.NumImages();
+    if (num_images < num_matched_images + min_num_new_images) {
+      continue;
+    }
+
+    LOG(INFO) << "Matching " << num_images << " extracted images";
+    std::unique_ptr<Thread> matcher =
+        CreateSequentialFeatureMatcher(pairing_options,
+                                       matching_options,
+                                       *option_manager_.two_view_geometry,
+                                       *option_manager_.database_path);
+    StartActiveThread(matcher.get());
+    WaitActiveThread(matcher.get());
+    num_matched_images = num_images;
+  }
+
+  WaitActiveThread(feature_extractor_.get());
   feature_extractor_.reset();
-  active_thread_ = nullptr;
 }
 
 void AutomaticReconstructionController::RunFeatureMatching() {
@@ -220,13 +273,11 @@ void AutomaticReconstructionController::RunFeatureMatching() {
   }
 
   THROW_CHECK_NOTNULL(matcher);
-  active_thread_ = matcher;
-  matcher->Start();
-  matcher->Wait();
+  StartActiveThread(matcher);
+  WaitActiveThread(matcher);
   exhaustive_matcher_.reset();
   sequential_matcher_.reset();
   vocab_tree_matcher_.reset();
-  active_thread_ = nullptr;
 }
 
 void AutomaticReconstructionController::RunSparseMapper() {
@@ -249,6 +300,28 @@ void AutomaticReconstructionController::RunSparseMapper() {
                              *option_manager_.database_path,
                              reconstruction_manager_);
   mapper.SetCheckIfStoppedFunc([&]() { return IsStopped(); });
+
+  // Start the dense reconstruction of every kept model once it is complete.
+  // Models are only ever discarded right before this callback, so the models
+  // beyond the already dispatched ones are the newly completed models.
+  size_t num_dense_reconstructions = reconstruction_manager_->Size();
+  if (options_.overlap_stages && options_.dense) {
+    num_dense_reconstructions = 0;
+    dense_thread_pool_ = std::make_unique<ThreadPool>(1);
+    mapper.AddCallback(IncrementalPipeline::LAST_IMAGE_REG_CALLBACK, [&]() {
+      for (; num_dense_reconstructions < reconstruction_manager_->Size();
+           ++num_dense_reconstructions) {
+        const size_t reconstruction_idx = num_dense_reconstructions;
+        auto reconstruction = std::make_shared<const Reconstruction>(
+            *reconstruction_manager_->Get(reconstruction_idx));
+        dense_futures_.push_back(dense_thread_pool_->AddTask(
+            [this, reconstruction_idx, reconstruction]() {
+              RunDenseMapper(reconstruction_idx, *reconstruction);
+            }));
+      }
+    });
+  }
+
   mapper.Run();
 
   CreateDirIfNotExists(sparse_path);
@@ -257,114 +330,138 @@ void AutomaticReconstructionController::RunSparseMapper() {
 }
 
 void AutomaticReconstructionController::RunDenseMapper() {
-  CreateDirIfNotExists(JoinPaths(options_.workspace_path, "dense"));
+  // Finish the overlapped dense reconstructions and then reconstruct the
+  // remaining models, which skips the already reconstructed models.
+  if (dense_thread_pool_) {
+    dense_thread_pool_->Wait();
+    for (std::future<void>& future : dense_futures_) {
+      future.get();
+    }
+    dense_futures_.clear();
+    dense_thread_pool_.reset();
+  }
 
   for (size_t i = 0; i < reconstruction_manager_->Size(); ++i) {
     if (IsStopped()) {
       return;
     }
+    RunDenseMapper(i, *reconstruction_manager_->Get(i));
+  }
+}
 
-    const std::string dense_path =
-        JoinPaths(options_.workspace_path, "dense", std::to_string(i));
-    const std::string fused_path = JoinPaths(dense_path, "fused.ply");
+void AutomaticReconstructionController::RunDenseMapper(
+    const size_t reconstruction_idx, const Reconstruction& reconstruction) {
+  CreateDirIfNotExists(JoinPaths(options_.workspace_path, "dense"));
 
-    std::string meshing_path;
-    if (options_.mesher == Mesher::POISSON) {
-      meshing_path = JoinPaths(dense_path, "meshed-poisson.ply");
-    } else if (options_.mesher == Mesher::DELAUNAY) {
-      meshing_path = JoinPaths(dense_path, "meshed-delaunay.ply");
-    }
+  const std::string dense_path = JoinPaths(
+      options_.workspace_path, "dense", std::to_string(reconstruction_idx));
+  const std::string fused_path = JoinPaths(dense_path, "fused.ply");
 
-    if (ExistsFile(fused_path) && ExistsFile(meshing_path)) {
-      continue;
-    }
+  std::string meshing_path;
+  if (options_.mesher == Mesher::POISSON) {
+    meshing_path = JoinPaths(dense_path, "meshed-poisson.ply");
+  } else if (options_.mesher == Mesher::DELAUNAY) {
+    meshing_path = JoinPaths(dense_path, "meshed-delaunay.ply");
+  }
+
+  if (ExistsFile(fused_path) && ExistsFile(meshing_path)) {
+    return;
+  }
 
-    // Image undistortion.
+  // Image undistortion.
 
-    if (!ExistsDir(dense_path)) {
-      CreateDirIfNotExists(dense_path);
+  if (!ExistsDir(dense_path)) {
+    CreateDirIfNotExists(dense_path);
 
-      UndistortCameraOptions undistortion_options;
-      undistortion_options.max_image_size =
-          option_manager_.patch_match_stereo->max_image_size;
-      COLMAPUndistorter undistorter(undistortion_options,
-                                    *reconstruction_manager_->Get(i),
-                                    *option_manager_.image_path,
-                                    dense_path);
-      undistorter.SetCheckIfStoppedFunc([&]() { return IsStopped(); });
-      undistorter.Run();
-    }
+    UndistortCameraOptions undistortion_options;
+    undistortion_options.max_image_size =
+        option_manager_.patch_match_stereo->max_image_size;
+    COLMAPUndistorter undistorter(undistortion_options,
+                                  reconstruction,
+                                  *option_manager_.image_path,
+                                  dense_path);
+    undistorter.SetCheckIfStoppedFunc([&]() { return IsStopped(); });
+    undistorter.Run();
+  }
 
-    if (IsStopped()) {
-      return;
-    }
+  if (IsStopped()) {
+    return;
+  }
 
-    // Patch match stereo.
+  // Patch match stereo.
 
 #if defined(COLMAP_CUDA_ENABLED)
-    {
-      mvs::PatchMatchController patch_match_controller(
-          *option_manager_.patch_match_stereo, dense_path, "COLMAP", "");
-      patch_match_controller.SetCheckIfStoppedFunc(
-          [&]() { return IsStopped(); });
-      patch_match_controller.Run();
-    }
+  {
+    mvs::PatchMatchController patch_match_controller(
+        *option_manager_.patch_match_stereo, dense_path, "COLMAP", "");
+    patch_match_controller.SetCheckIfStoppedFunc([&]() { return IsStopped(); });
+    patch_match_controller.Run();
+  }
 #else   // COLMAP_CUDA_ENABLED
-    LOG(WARNING) << "Skipping patch match stereo because CUDA is not available";
-    return;
+  LOG(WARNING) << "Skipping patch match stereo because CUDA is not available";
+  return;
 #endif  // COLMAP_CUDA_ENABLED
 
-    if (IsStopped()) {
-      return;
-    }
+  if (IsStopped()) {
+    return;
+  }
 
-    // Stereo fusion.
-
-    if (!ExistsFile(fused_path)) {
-      auto fusion_options = *option_manager_.stereo_fusion;
-      const int num_reg_images =
-          reconstruction_manager_->Get(i)->NumRegImages();
-      fusion_options.min_num_pixels =
-          std::min(num_reg_images + 1, fusion_options.min_num_pixels);
-      mvs::StereoFusion fuser(
-          fusion_options,
-          dense_path,
-          "COLMAP",
-          "",
-          option_manager_.patch_match_stereo->geom_consistency ? "geometric"
-                                                               : "photometric");
-      fuser.SetCheckIfStoppedFunc([&]() { return IsStopped(); });
-      fuser.Run();
-
-      LOG(INFO) << "Writing output: " << fused_path;
-      WriteBinaryPlyPoints(fused_path, fuser.GetFusedPoints());
-      mvs::WritePointsVisibility(fused_path + ".vis",
-                                 fuser.GetFusedPointsVisibility());
-    }
+  // Stereo fusion.
+
+  if (!ExistsFile(fused_path)) {
+    auto fusion_options = *option_manager_.stereo_fusion;
+    const int num_reg_images = reconstruction.NumRegImages();
+    fusion_options.min_num_pixels =
+        std::min(num_reg_images + 1, fusion_options.min_num_pixels);
+    mvs::StereoFusion fuser(
+        fusion_options,
+        dense_path,
+        "COLMAP",
+        "",
+        option_manager_.patch_match_stereo->geom_consistency ? "geometric"
+                                                             : "photometric");
+    fuser.SetCheckIfStoppedFunc([&]() { return IsStopped(); });
+    fuser.Run();
+
+    LOG(INFO) << "Writing output: " << fused_path;
+    WriteBinaryPlyPoints(fused_path, fuser.GetFusedPoints());
+    mvs::WritePointsVisibility(fused_path + ".vis",
+                               fuser.GetFusedPointsVisibility());
+  }
 
-    if (IsStopped()) {
-      return;
-    }
+  if (IsStopped()) {
+    return;
+  }
 
-    // Surface meshing.
+  // Surface meshing.
 
-    if (!ExistsFile(meshing_path)) {
-      if (options_.mesher == Mesher::POISSON) {
-        mvs::PoissonMeshing(
-            *option_manager_.poisson_meshing, fused_path, meshing_path);
-      } else if (options_.mesher == Mesher::DELAUNAY) {
+  if (!ExistsFile(meshing_path)) {
+    if (options_.mesher == Mesher::POISSON) {
+      mvs::PoissonMeshing(
+          *option_manager_.poisson_meshing, fused_path, meshing_path);
+    } else if (options_.mesher == Mesher::DELAUNAY) {
 #if defined(COLMAP_CGAL_ENABLED)
-        mvs::DenseDelaunayMeshing(
-            *option_manager_.delaunay_meshing, dense_path, meshing_path);
+      mvs::DenseDelaunayMeshing(
+          *option_manager_.delaunay_meshing, dense_path, meshing_path);
 #else  // COLMAP_CGAL_ENABLED
-        LOG(WARNING)
-            << "Skipping Delaunay meshing because CGAL is not available";
-        return;
+      LOG(WARNING) << "Skipping Delaunay meshing because CGAL is not available";
+      return;
 
 #endif  // COLMAP_CGAL_ENABLED
-      }
     }
   }
 }
 
+void AutomaticReconstructionController::StartActiveThread(Thread* thread) {
+  std::lock_guard<std::mutex> lock(active_threads_mutex_);
+  active_threads_.insert(thread);
+  thread->Start();
+}
+
+void AutomaticReconstructionController::WaitActiveThread(Thread* thread) {
+  thread->Wait();
+  std::lock_guard<std::mutex> lock(active_threads_mutex_);
+  active_threads_.erase(thread);
+}
+
 }  // namespace colmap
@@ -35,8 +35,12 @@
 #include "colmap/util/enum_utils.h"
 #include "colmap/util/threading.h"
 
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 namespace colmap {
 
@@ -101,6 +105,14 @@ class AutomaticReconstructionController : public Thread {
     // The meshing algorithm to be used.
     Mesher mesher = Mesher::POISSON;
 
+    // Whether to overlap the execution of the stages. For video data, the
+    // images are matched sequentially in rounds while features are still
+    // being extracted. Without CUDA, these rounds match on the CPU. The
+    // dense reconstruction of a sparse model starts as soon as the model is
+    // complete, while the mapper continues to reconstruct the remaining
+    // models.
+    bool overlap_stages = false;
+
     // The number of threads to use in all stages.
     int num_threads = -1;
 
@@ -127,14 +139,24 @@ class AutomaticReconstructionController : public Thread {
  private:
   void Run() override;
   void RunFeatureExtraction();
+  void RunFeatureExtractionWithOverlappedMatching();
   void RunFeatureMatching();
   void RunSparseMapper();
   void RunDenseMapper();
+  void RunDenseMapper(size_t reconstruction_idx,
+                      const Reconstruction& reconstruction);
+
+  void StartActiveThread(Thread* thread);
+  void WaitActiveThread(Thread* thread);
 
   const Options options_;
   OptionManager option_manager_;
   std::shared_ptr<ReconstructionManager> reconstruction_manager_;
-  Thread* active_thread_;
+  std::mutex active_threads_mutex_;
+  std::unordered_set<Thread*> active_threads_;
+  // Dense reconstruction of completed sparse models while the mapper runs.
+  std::unique_ptr<ThreadPool> dense_thread_pool_;
+  std::vector<std::future<void>> dense_futures_;
   std::unique_ptr<Thread> feature_extractor_;
   std::unique_ptr<Thread> exhaustive_matcher_;
   std::unique_ptr<Thread> sequential_matcher_;
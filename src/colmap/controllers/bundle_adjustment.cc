@@ -101,7 +101,8 @@ void BundleAdjustmentController::Run() {
   std::unique_ptr<BundleAdjuster> bundle_adjuster = CreateDefaultBundleAdjuster(
       std::move(ba_options), std::move(ba_config), *reconstruction_);
   bundle_adjuster->Solve();
-  reconstruction_->UpdatePoint3DErrors();
+  reconstruction_->UpdatePoint3DErrors(
+      options_.bundle_adjustment->solver_options.num_threads);
 
   run_timer.PrintMinutes();
 }
@@ -88,6 +88,15 @@ class FeatureMatcherThread : public Thread {
       matcher_.Match(image_pairs);
       PrintElapsedTime(timer);
     }
+
+    const FeatureMatcherVerificationStats& stats = matcher_.VerificationStats();
+    if (stats.num_pre_filtered_pairs > 0) {
+      LOG(INFO) << StringPrintf(
+          "Pre-filtered %d of %d image pairs before geometric verification",
+          stats.num_pre_filtered_pairs.load(),
+          stats.num_pairs.load());
+    }
+
     run_timer.PrintMinutes();
   }
 
@@ -322,18 +331,26 @@ class FeaturePairsFeatureMatcher : public Thread {
       if (options_.verify_matches) {
         database_->WriteMatches(image1.ImageId(), image2.ImageId(), matches);
 
-        const std::shared_ptr<FeatureKeypoints> keypoints1 =
-            cache_->GetKeypoints(image1.ImageId());
-        const std::shared_ptr<FeatureKeypoints> keypoints2 =
-            cache_->GetKeypoints(image2.ImageId());
-
-        two_view_geometry =
-            EstimateTwoViewGeometry(camera1,
-                                    FeatureKeypointsToPointsVector(*keypoints1),
-                                    camera2,
-                                    FeatureKeypointsToPointsVector(*keypoints2),
-                                    std::move(matches),
-                                    geometry_options_);
+        const auto points1 = cache_->GetPoints(image1.ImageId());
+        const auto points2 = cache_->GetPoints(image2.ImageId());
+        if (TwoViewGeometryUsesCamRays(camera1, camera2, geometry_options_)) {
+          two_view_geometry =
+              EstimateTwoViewGeometry(camera1,
+                                      *points1,
+                                      *cache_->GetCamRays(image1.ImageId()),
+                                      camera2,
+                                      *points2,
+                                      *cache_->GetCamRays(image2.ImageId()),
+                                      std::move(matches),
+                                      geometry_options_);
+        } else {
+          two_view_geometry = EstimateTwoViewGeometry(camera1,
+                                                      *points1,
+                                                      camera2,
+                                                      *points2,
+                                                      std::move(matches),
+                                                      geometry_options_);
+        }
 
       } else {
         if (camera1.has_prior_focal_length && camera2.has_prior_focal_length) {
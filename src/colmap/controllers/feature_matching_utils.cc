@@ -39,6 +39,7 @@
 #include <cuda_runtime.h>
 #endif
 
+#include <algorithm>
 #include <unordered_set>
 
 namespace colmap {
@@ -106,64 +107,81 @@ void FeatureMatcherWorker::Run() {
 
   SignalValidSetup();
 
+  auto GetMatcherImage = [this](const image_t image_id) {
+    const Camera& camera =
+        cache_->GetCamera(cache_->GetImage(image_id).CameraId());
+    return FeatureMatcher::Image{image_id,
+                                 static_cast<int>(camera.width),
+                                 static_cast<int>(camera.height),
+                                 cache_->GetKeypoints(image_id),
+                                 cache_->GetDescriptors(image_id)};
+  };
+
+  // Guided matching is always performed pair by pair, while unguided matching
+  // collects the queued pairs into batches of up to the maximum batch size
+  // supported by the matcher.
+  const size_t max_batch_size =
+      matching_options_.guided_matching
+          ? 1
+          : static_cast<size_t>(std::max(1, matcher->MaxBatchSize()));
+
+  std::vector<FeatureMatcherData> batch;
+  std::vector<std::pair<FeatureMatcher::Image, FeatureMatcher::Image>>
+      batch_images;
+  std::vector<FeatureMatches> batch_matches;
+
   while (true) {
     if (IsStopped()) {
       break;
     }
 
     auto input_job = input_queue_->Pop();
-    if (input_job.IsValid()) {
+    while (input_job.IsValid()) {
       auto& data = input_job.Data();
 
       if (!cache_->ExistsDescriptors(data.image_id1) ||
           !cache_->ExistsDescriptors(data.image_id2)) {
         THROW_CHECK(output_queue_->Push(std::move(data)));
-        continue;
-      }
-
-      const auto& camera1 =
-          cache_->GetCamera(cache_->GetImage(data.image_id1).CameraId());
-      const auto& camera2 =
-          cache_->GetCamera(cache_->GetImage(data.image_id2).CameraId());
-
-      if (matching_options_.guided_matching) {
+      } else if (matching_options_.guided_matching) {
         matcher->MatchGuided(geometry_options_.ransac_options.max_error,
-                             {
-                                 data.image_id1,
-                                 static_cast<int>(camera1.width),
-                                 static_cast<int>(camera1.height),
-                                 cache_->GetKeypoints(data.image_id1),
-                                 cache_->GetDescriptors(data.image_id1),
-                             },
-                             {
-                                 data.image_id2,
-                                 static_cast<int>(camera2.width),
-                                 static_cast<int>(camera2.height),
-                                 cache_->GetKeypoints(data.image_id2),
-                                 cache_->GetDescriptors(data.image_id2),
-                             },
+                             GetMatcherImage(data.image_id1),
+                             GetMatcherImage(data.image_id2),
                              &data.two_view_geometry);
+        THROW_CHECK(output_queue_->Push(std::move(data)));
       } else {
-        matcher->Match(
-            {
-                data.image_id1,
-                static_cast<int>(camera1.width),
-                static_cast<int>(camera1.height),
-                cache_->GetKeypoints(data.image_id1),
-                cache_->GetDescriptors(data.image_id1),
-            },
-            {
-                data.image_id2,
-                static_cast<int>(camera2.width),
-                static_cast<int>(camera2.height),
-                cache_->GetKeypoints(data.image_id2),
-                cache_->GetDescriptors(data.image_id2),
-            },
-            &data.matches);
+        batch.push_back(std::move(data));
       }
 
+      if (batch.size() >= max_batch_size) {
+        break;
+      }
+
+      input_job = input_queue_->TryPop();
+    }
+
+    if (batch.size() == 1) {
+      FeatureMatcherData& data = batch.front();
+      matcher->Match(GetMatcherImage(data.image_id1),
+                     GetMatcherImage(data.image_id2),
+                     &data.matches);
+    } else if (batch.size() > 1) {
+      batch_images.clear();
+      for (const FeatureMatcherData& data : batch) {
+        batch_images.emplace_back(GetMatcherImage(data.image_id1),
+                                  GetMatcherImage(data.image_id2));
+      }
+      batch_matches.clear();
+      matcher->MatchBatch(batch_images, &batch_matches);
+      THROW_CHECK_EQ(batch_matches.size(), batch.size());
+      for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i].matches = std::move(batch_matches[i]);
+      }
+    }
+
+    for (FeatureMatcherData& data : batch) {
       THROW_CHECK(output_queue_->Push(std::move(data)));
     }
+    batch.clear();
   }
 }
 
@@ -176,10 +194,12 @@ class VerifierWorker : public Thread {
 
   VerifierWorker(const TwoViewGeometryOptions& options,
                  std::shared_ptr<FeatureMatcherCache> cache,
+                 FeatureMatcherVerificationStats* stats,
                  JobQueue<Input>* input_queue,
                  JobQueue<Output>* output_queue)
       : options_(options),
         cache_(std::move(cache)),
+        stats_(THROW_CHECK_NOTNULL(stats)),
         input_queue_(input_queue),
         output_queue_(output_queue) {
     THROW_CHECK(options_.Check());
@@ -206,15 +226,37 @@ class VerifierWorker : public Thread {
             cache_->GetCamera(cache_->GetImage(data.image_id1).CameraId());
         const auto& camera2 =
             cache_->GetCamera(cache_->GetImage(data.image_id2).CameraId());
-        const auto keypoints1 = cache_->GetKeypoints(data.image_id1);
-        const auto keypoints2 = cache_->GetKeypoints(data.image_id2);
-        const std::vector<Eigen::Vector2d> points1 =
-            FeatureKeypointsToPointsVector(*keypoints1);
-        const std::vector<Eigen::Vector2d> points2 =
-            FeatureKeypointsToPointsVector(*keypoints2);
+        const auto points1 = cache_->GetPoints(data.image_id1);
+        const auto points2 = cache_->GetPoints(data.image_id2);
+
+        stats_->num_pairs += 1;
+        if (options_.pre_filter &&
+            !PreFilterTwoViewGeometry(
+                *points1, *points2, data.matches, options_)) {
+          stats_->num_pre_filtered_pairs += 1;
+          data.two_view_geometry.config =
+              TwoViewGeometry::ConfigurationType::DEGENERATE;
+          THROW_CHECK(output_queue_->Push(std::move(data)));
+          continue;
+        }
 
-        data.two_view_geometry = EstimateTwoViewGeometry(
-            camera1, points1, camera2, points2, data.matches, options_);
+        // The normalized camera rays are only needed for the calibrated
+        // estimation and the relative pose. They are cached per image, so
+        // that the keypoints are not undistorted again for every pair.
+        if (TwoViewGeometryUsesCamRays(camera1, camera2, options_)) {
+          data.two_view_geometry =
+              EstimateTwoViewGeometry(camera1,
+                                      *points1,
+                                      *cache_->GetCamRays(data.image_id1),
+                                      camera2,
+                                      *points2,
+                                      *cache_->GetCamRays(data.image_id2),
+                                      data.matches,
+                                      options_);
+        } else {
+          data.two_view_geometry = EstimateTwoViewGeometry(
+              camera1, *points1, camera2, *points2, data.matches, options_);
+        }
 
         THROW_CHECK(output_queue_->Push(std::move(data)));
       }
@@ -224,6 +266,7 @@ class VerifierWorker : public Thread {
  private:
   const TwoViewGeometryOptions options_;
   std::shared_ptr<FeatureMatcherCache> cache_;
+  FeatureMatcherVerificationStats* stats_;
   JobQueue<Input>* input_queue_;
   JobQueue<Output>* output_queue_;
 };
@@ -290,8 +333,12 @@ FeatureMatcherController::FeatureMatcherController(
   if (matching_options_.guided_matching) {
     // Redirect the verification output to final round of guided matching.
     for (int i = 0; i < num_threads; ++i) {
-      verifiers_.emplace_back(std::make_unique<VerifierWorker>(
-          geometry_options_, cache_, &verifier_queue_, &guided_matcher_queue_));
+      verifiers_.emplace_back(
+          std::make_unique<VerifierWorker>(geometry_options_,
+                                           cache_,
+                                           &verification_stats_,
+                                           &verifier_queue_,
+                                           &guided_matcher_queue_));
     }
 
     if (matching_options_.use_gpu) {
@@ -319,8 +366,12 @@ FeatureMatcherController::FeatureMatcherController(
     }
   } else {
     for (int i = 0; i < num_threads; ++i) {
-      verifiers_.emplace_back(std::make_unique<VerifierWorker>(
-          geometry_options_, cache_, &verifier_queue_, &output_queue_));
+      verifiers_.emplace_back(
+          std::make_unique<VerifierWorker>(geometry_options_,
+                                           cache_,
+                                           &verification_stats_,
+                                           &verifier_queue_,
+                                           &output_queue_));
     }
   }
 }
@@ -391,6 +442,11 @@ bool FeatureMatcherController::Setup() {
   return true;
 }
 
+const FeatureMatcherVerificationStats&
+FeatureMatcherController::VerificationStats() const {
+  return verification_stats_;
+}
+
 void FeatureMatcherController::Match(
     const std::vector<std::pair<image_t, image_t>>& image_pairs) {
   THROW_CHECK_NOTNULL(cache_);
@@ -34,11 +34,20 @@
 #include "colmap/util/opengl_utils.h"
 #include "colmap/util/threading.h"
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
 namespace colmap {
 
+// Statistics of the geometric verification, shared by all verifier threads.
+struct FeatureMatcherVerificationStats {
+  // The number of image pairs with enough matches for verification.
+  std::atomic<size_t> num_pairs{0};
+  // The number of image pairs rejected by the verification pre-filter.
+  std::atomic<size_t> num_pre_filtered_pairs{0};
+};
+
 struct FeatureMatcherData {
   image_t image_id1 = kInvalidImageId;
   image_t image_id2 = kInvalidImageId;
@@ -89,6 +98,9 @@ class FeatureMatcherController {
   // Match one batch of multiple image pairs.
   void Match(const std::vector<std::pair<image_t, image_t>>& image_pairs);
 
+  // Accumulated statistics of the geometric verification over all batches.
+  const FeatureMatcherVerificationStats& VerificationStats() const;
+
  private:
   FeatureMatchingOptions matching_options_;
   TwoViewGeometryOptions geometry_options_;
@@ -96,6 +108,8 @@ class FeatureMatcherController {
 
   bool is_setup_;
 
+  FeatureMatcherVerificationStats verification_stats_;
+
   std::vector<std::unique_ptr<FeatureMatcherWorker>> matchers_;
   std::vector<std::unique_ptr<FeatureMatcherWorker>> guided_matchers_;
   std::vector<std::unique_ptr<Thread>> verifiers_;
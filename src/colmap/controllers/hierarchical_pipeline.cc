@@ -248,7 +248,8 @@ void HierarchicalPipeline::Run() {
 
   for (size_t i = 0; i < reconstruction_manager_->Size(); ++i) {
     auto reconstruction = reconstruction_manager_->Get(i);
-    reconstruction->UpdatePoint3DErrors();
+    reconstruction->UpdatePoint3DErrors(
+        options_.incremental_options.num_threads);
   }
 
   run_timer.PrintMinutes();
@@ -100,6 +100,7 @@ IncrementalTriangulator::Options IncrementalPipelineOptions::Triangulation()
   options.min_focal_length_ratio = min_focal_length_ratio;
   options.max_focal_length_ratio = max_focal_length_ratio;
   options.max_extra_param = max_extra_param;
+  options.num_threads = num_threads;
   options.random_seed = random_seed;
   return options;
 }
@@ -367,6 +368,72 @@ IncrementalPipeline::Status IncrementalPipeline::InitializeReconstruction(
   return Status::SUCCESS;
 }
 
+IncrementalPipeline::Status
+IncrementalPipeline::InitializeReconstructionFromPosePriors(
+    IncrementalMapper& mapper,
+    const IncrementalMapper::Options& mapper_options,
+    Reconstruction& reconstruction) {
+  LOG(INFO) << "Registering frames from pose priors";
+  const size_t num_reg_frames =
+      mapper.RegisterFramesFromPosePriors(mapper_options);
+  if (num_reg_frames == 0) {
+    LOG(INFO) << "=> Could not initialize frames from pose priors.";
+    return Status::NO_INITIAL_PAIR;
+  }
+  LOG(INFO) << "=> Registered " << num_reg_frames << " frames";
+
+  LOG(INFO) << "Parallel triangulation of all tracks";
+  const IncrementalTriangulator::Options tri_options =
+      options_->Triangulation();
+  const size_t num_tris =
+      mapper.Triangulator().TriangulateAllTracks(tri_options);
+  LOG(INFO) << "=> Triangulated " << num_tris << " observations";
+
+  // The initial rotations are only approximate, so use a robust loss and
+  // triangulate the tracks again after each refinement.
+  LOG(INFO) << "Robust global bundle adjustment";
+  BundleAdjustmentOptions ba_options = options_->GlobalBundleAdjustment();
+  ba_options.loss_function_type =
+      BundleAdjustmentOptions::LossFunctionType::CAUCHY;
+  for (int i = 0; i < options_->ba_global_max_refinements; ++i) {
+    if (reconstruction.NumPoints3D() == 0) {
+      break;
+    }
+    const size_t num_observations = reconstruction.ComputeNumObservations();
+    mapper.AdjustGlobalBundle(mapper_options, ba_options);
+    size_t num_changed_observations =
+        mapper.Triangulator().TriangulateAllTracks(tri_options);
+    num_changed_observations += mapper.CompleteAndMergeTracks(tri_options);
+    num_changed_observations += mapper.FilterPoints(mapper_options);
+    const double changed =
+        num_observations == 0
+            ? 0
+            : static_cast<double>(num_changed_observations) / num_observations;
+    VLOG(1) << StringPrintf("=> Changed observations: %.6f", changed);
+    if (changed < options_->ba_global_max_refinement_change) {
+      break;
+    }
+  }
+  mapper.FilterFrames(mapper_options);
+  mapper.ClearModifiedPoints3D();
+
+  if (reconstruction.NumRegFrames() == 0 || reconstruction.NumPoints3D() == 0) {
+    return Status::BAD_INITIAL_PAIR;
+  }
+
+  if (static_cast<int>(reconstruction.NumPoints3D()) <
+      mapper_options.abs_pose_min_num_inliers) {
+    return Status::BAD_INITIAL_PAIR;
+  }
+
+  if (options_->extract_colors) {
+    for (const image_t image_id : reconstruction.RegImageIds()) {
+      ExtractColors(image_path_, image_id, reconstruction);
+    }
+  }
+  return Status::SUCCESS;
+}
+
 bool IncrementalPipeline::CheckRunGlobalRefinement(
     const Reconstruction& reconstruction,
     const size_t ba_prev_num_reg_frames,
@@ -392,8 +459,18 @@ IncrementalPipeline::Status IncrementalPipeline::ReconstructSubModel(
   ////////////////////////////////////////////////////////////////////////////
 
   if (reconstruction->NumRegFrames() == 0) {
-    const Status init_status = IncrementalPipeline::InitializeReconstruction(
-        mapper, mapper_options, *reconstruction);
+    Status init_status = Status::NO_INITIAL_PAIR;
+    if (options_->use_prior_position &&
+        options_->init_frames_from_pose_priors &&
+        !init_from_pose_priors_tried_) {
+      init_from_pose_priors_tried_ = true;
+      init_status = IncrementalPipeline::InitializeReconstructionFromPosePriors(
+          mapper, mapper_options, *reconstruction);
+    }
+    if (init_status == Status::NO_INITIAL_PAIR) {
+      init_status = IncrementalPipeline::InitializeReconstruction(
+          mapper, mapper_options, *reconstruction);
+    }
     if (init_status != Status::SUCCESS) {
       return init_status;
     }
@@ -418,45 +495,37 @@ IncrementalPipeline::Status IncrementalPipeline::ReconstructSubModel(
     prev_reg_next_success = reg_next_success;
     reg_next_success = false;
 
-    const std::vector<image_t> next_images =
-        mapper.FindNextImages(mapper_options);
+    std::vector<image_t> next_images = mapper.FindNextImages(mapper_options);
 
     if (next_images.empty()) {
       break;
     }
 
-    image_t next_image_id;
-    for (size_t reg_trial = 0; reg_trial < next_images.size(); ++reg_trial) {
-      next_image_id = next_images[reg_trial];
+    // If initial pair fails to continue for some time,
+    // abort and try different initial pair.
+    const size_t kMinNumInitialRegTrials = 30;
+    if (reconstruction->NumRegFrames() <
+            static_cast<size_t>(options_->min_model_size) &&
+        next_images.size() > kMinNumInitialRegTrials + 1) {
+      next_images.resize(kMinNumInitialRegTrials + 1);
+    }
 
-      LOG(INFO) << StringPrintf("Registering image #%d (num_reg_frames=%d)",
-                                next_image_id,
-                                reconstruction->NumRegFrames());
+    LOG(INFO) << StringPrintf(
+        "Registering next image from %d candidates (num_reg_frames=%d)",
+        next_images.size(),
+        reconstruction->NumRegFrames());
+
+    const image_t next_image_id =
+        mapper.RegisterNextImageFromCandidates(mapper_options, next_images);
+    reg_next_success = next_image_id != kInvalidImageId;
+
+    if (reg_next_success) {
       LOG(INFO) << StringPrintf(
-          "=> Image sees %d / %d points",
+          "=> Registered image #%d, which sees %d / %d points",
+          next_image_id,
           mapper.ObservationManager().NumVisiblePoints3D(next_image_id),
           mapper.ObservationManager().NumObservations(next_image_id));
 
-      reg_next_success =
-          mapper.RegisterNextImage(mapper_options, next_image_id);
-
-      if (reg_next_success) {
-        break;
-      } else {
-        LOG(INFO) << "=> Could not register, trying another image.";
-
-        // If initial pair fails to continue for some time,
-        // abort and try different initial pair.
-        const size_t kMinNumInitialRegTrials = 30;
-        if (reg_trial >= kMinNumInitialRegTrials &&
-            reconstruction->NumRegFrames() <
-                static_cast<size_t>(options_->min_model_size)) {
-          break;
-        }
-      }
-    }
-
-    if (reg_next_success) {
       const Image& image = reconstruction->Image(next_image_id);
       for (const data_t& data_id : image.FramePtr()->ImageIds()) {
         mapper.TriangulateImage(options_->Triangulation(), data_id.id);
@@ -489,6 +558,8 @@ IncrementalPipeline::Status IncrementalPipeline::ReconstructSubModel(
       }
 
       Callback(NEXT_IMAGE_REG_CALLBACK);
+    } else {
+      LOG(INFO) << "=> Could not register any of the candidates.";
     }
 
     const size_t max_model_overlap =
@@ -540,7 +611,7 @@ void IncrementalPipeline::Reconstruct(
         ReconstructSubModel(mapper, mapper_options, reconstruction);
     switch (status) {
       case Status::INTERRUPTED: {
-        reconstruction->UpdatePoint3DErrors();
+        reconstruction->UpdatePoint3DErrors(options_->num_threads);
         LOG(INFO) << "Keeping reconstruction due to interrupt";
         mapper.EndReconstruction(/*discard=*/false);
         AlignReconstructionToOrigRigScales(database_cache_->Rigs(),
@@ -586,7 +657,7 @@ void IncrementalPipeline::Reconstruct(
           mapper.EndReconstruction(/*discard=*/true);
           reconstruction_manager_->Delete(reconstruction_idx);
         } else {
-          reconstruction->UpdatePoint3DErrors();
+          reconstruction->UpdatePoint3DErrors(options_->num_threads);
           LOG(INFO) << "Keeping successful reconstruction";
           mapper.EndReconstruction(/*discard=*/false);
           AlignReconstructionToOrigRigScales(database_cache_->Rigs(),
@@ -617,36 +688,65 @@ void IncrementalPipeline::TriangulateReconstruction(
   IncrementalMapper mapper(database_cache_);
   mapper.BeginReconstruction(reconstruction);
 
-  LOG(INFO) << "Iterative triangulation";
-  size_t image_idx = 0;
-  for (const image_t image_id : reconstruction->RegImageIds()) {
-    const auto& image = reconstruction->Image(image_id);
+  if (options_->parallel_point_triangulation) {
+    LOG(INFO) << "Parallel triangulation of all tracks";
+    const size_t num_tris =
+        mapper.Triangulator().TriangulateAllTracks(options_->Triangulation());
+    LOG(INFO) << "=> Triangulated " << num_tris << " observations";
+
+    LOG(INFO) << "Filtering and global bundle adjustment";
+    const IncrementalMapper::Options mapper_options = options_->Mapper();
+    mapper.FilterPoints(mapper_options);
+    for (int i = 0; i < options_->ba_global_max_refinements; ++i) {
+      const size_t num_observations = reconstruction->ComputeNumObservations();
+      mapper.AdjustGlobalBundle(mapper_options,
+                                options_->GlobalBundleAdjustment());
+      const size_t num_changed_observations =
+          mapper.FilterPoints(mapper_options);
+      const double changed =
+          num_observations == 0
+              ? 0
+              : static_cast<double>(num_changed_observations) /
+                    num_observations;
+      VLOG(1) << StringPrintf("=> Changed observations: %.6f", changed);
+      if (changed < options_->ba_global_max_refinement_change) {
+        break;
+      }
+    }
+    mapper.ClearModifiedPoints3D();
+  } else {
+    LOG(INFO) << "Iterative triangulation";
+    size_t image_idx = 0;
+    for (const image_t image_id : reconstruction->RegImageIds()) {
+      const auto& image = reconstruction->Image(image_id);
 
-    LOG(INFO) << StringPrintf(
-        "Triangulating image #%d (%d)", image_id, image_idx++);
-    const size_t num_existing_points3D = image.NumPoints3D();
-    LOG(INFO) << "=> Image sees " << num_existing_points3D << " / "
-              << mapper.ObservationManager().NumObservations(image_id)
-              << " points";
-
-    mapper.TriangulateImage(options_->Triangulation(), image_id);
-    VLOG(1) << "=> Triangulated "
-            << (image.NumPoints3D() - num_existing_points3D) << " points";
-  }
+      LOG(INFO) << StringPrintf(
+          "Triangulating image #%d (%d)", image_id, image_idx++);
+      const size_t num_existing_points3D = image.NumPoints3D();
+      LOG(INFO) << "=> Image sees " << num_existing_points3D << " / "
+                << mapper.ObservationManager().NumObservations(image_id)
+                << " points";
+
+      mapper.TriangulateImage(options_->Triangulation(), image_id);
+      VLOG(1) << "=> Triangulated "
+              << (image.NumPoints3D() - num_existing_points3D) << " points";
+    }
 
-  LOG(INFO) << "Retriangulation and Global bundle adjustment";
-  mapper.IterativeGlobalRefinement(options_->ba_global_max_refinements,
-                                   options_->ba_global_max_refinement_change,
-                                   options_->Mapper(),
-                                   options_->GlobalBundleAdjustment(),
-                                   options_->Triangulation(),
-                                   /*normalize_reconstruction=*/false);
+    LOG(INFO) << "Retriangulation and Global bundle adjustment";
+    mapper.IterativeGlobalRefinement(options_->ba_global_max_refinements,
+                                     options_->ba_global_max_refinement_change,
+                                     options_->Mapper(),
+                                     options_->GlobalBundleAdjustment(),
+                                     options_->Triangulation(),
+                                     /*normalize_reconstruction=*/false);
+  }
   mapper.EndReconstruction(/*discard=*/false);
 
-  reconstruction->UpdatePoint3DErrors();
+  reconstruction->UpdatePoint3DErrors(options_->num_threads);
 
   LOG(INFO) << "Extracting colors";
-  reconstruction->ExtractColorsForAllImages(image_path_);
+  reconstruction->ExtractColorsForAllImages(image_path_,
+                                            options_->num_threads);
 }
 
 }  // namespace colmap
@@ -153,6 +153,20 @@ struct IncrementalPipelineOptions {
   // If reconstruction is provided as input, fix the existing frame poses.
   bool fix_existing_frames = false;
 
+  // Whether to triangulate all tracks of an existing reconstruction at once
+  // in parallel instead of image by image, followed by bundle adjustment and
+  // filtering of the points. Only used when triangulating points for known
+  // poses, e.g., in the point_triangulator.
+  bool parallel_point_triangulation = false;
+
+  // Whether to initialize the reconstruction by registering all frames with
+  // pose priors at once instead of from an initial image pair. The points are
+  // then triangulated in bulk and refined by robust global bundle adjustment,
+  // before registering any remaining frames incrementally. Only used together
+  // with use_prior_position and requires accurate prior positions, e.g., from
+  // RTK-GNSS. Falls back to the default initialization on failure.
+  bool init_frames_from_pose_priors = false;
+
   // List of cameras for which to fix the camera parameters independent
   // of refine_focal_length, refine_principal_point, and refine_extra_params.
   std::unordered_set<camera_t> constant_cameras;
@@ -222,6 +236,11 @@ class IncrementalPipeline : public BaseController {
       const IncrementalMapper::Options& mapper_options,
       Reconstruction& reconstruction);
 
+  Status InitializeReconstructionFromPosePriors(
+      IncrementalMapper& mapper,
+      const IncrementalMapper::Options& mapper_options,
+      Reconstruction& reconstruction);
+
   void TriangulateReconstruction(
       const std::shared_ptr<Reconstruction>& reconstruction);
 
@@ -235,6 +254,9 @@ class IncrementalPipeline : public BaseController {
   const std::string database_path_;
   std::shared_ptr<class ReconstructionManager> reconstruction_manager_;
   std::shared_ptr<class DatabaseCache> database_cache_;
+  // Whether the initialization from pose priors was already attempted, which
+  // is only done once for the first reconstruction.
+  bool init_from_pose_priors_tried_ = false;
 };
 
 }  // namespace colmap
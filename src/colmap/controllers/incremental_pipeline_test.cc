@@ -31,8 +31,11 @@
 
 #include "colmap/estimators/alignment.h"
 #include "colmap/scene/synthetic.h"
+#include "colmap/sfm/incremental_mapper.h"
 #include "colmap/util/testing.h"
 
+#include <set>
+
 #include <gtest/gtest.h>
 
 namespace colmap {
@@ -182,6 +185,54 @@ TEST(IncrementalPipeline, WithoutNoiseAndWithNonTrivialFrames) {
   }
 }
 
+TEST(IncrementalPipeline, WithoutNoiseAndWithNonTrivialFramesMultiThreaded) {
+  const std::string database_path = CreateTestDir() + "/database.db";
+
+  Database database(database_path);
+  Reconstruction gt_reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_rigs = 2;
+  synthetic_dataset_options.num_cameras_per_rig = 3;
+  synthetic_dataset_options.num_frames_per_rig = 7;
+  synthetic_dataset_options.num_points3D = 100;
+  synthetic_dataset_options.point2D_stddev = 0;
+  synthetic_dataset_options.camera_has_prior_focal_length = true;
+  synthetic_dataset_options.sensor_from_rig_translation_stddev = 0.05;
+  synthetic_dataset_options.sensor_from_rig_rotation_stddev = 30;
+  SynthesizeDataset(synthetic_dataset_options, &gt_reconstruction, &database);
+
+  // With multiple threads, the poses of candidate frames are estimated
+  // concurrently during registration, which must not change the result.
+  std::vector<std::set<image_t>> reg_image_ids;
+  for (const int num_threads : {1, 4}) {
+    auto reconstruction_manager = std::make_shared<ReconstructionManager>();
+    auto options = std::make_shared<IncrementalPipelineOptions>();
+    options->num_threads = num_threads;
+    options->random_seed = 42;
+    IncrementalPipeline mapper(options,
+                               /*image_path=*/"",
+                               database_path,
+                               reconstruction_manager);
+    mapper.Run();
+
+    ASSERT_EQ(reconstruction_manager->Size(), 1);
+    ExpectReconstructionsNear(gt_reconstruction,
+                              *reconstruction_manager->Get(0),
+                              /*max_rotation_error_deg=*/1e-2,
+                              /*max_proj_center_error=*/1e-3,
+                              /*num_obs_tolerance=*/0,
+                              /*align=*/true,
+                              /*check_scale=*/true,
+                              /*max_scale_error=*/1e-2);
+    const std::vector<image_t> image_ids =
+        reconstruction_manager->Get(0)->RegImageIds();
+    reg_image_ids.emplace_back(image_ids.begin(), image_ids.end());
+  }
+
+  ASSERT_EQ(reg_image_ids.size(), 2);
+  EXPECT_EQ(reg_image_ids[0], reg_image_ids[1]);
+}
+
 TEST(IncrementalPipeline, WithoutNoiseAndWithPanoramicNonTrivialFrames) {
   const std::string database_path = CreateTestDir() + "/database.db";
 
@@ -478,6 +529,82 @@ TEST(IncrementalPipeline, PriorBasedSfMWithoutNoiseAndWithNonTrivialFrames) {
                             /*align=*/true);
 }
 
+TEST(IncrementalPipeline, PriorBasedSfMWithInitFramesFromPosePriors) {
+  const std::string database_path = CreateTestDir() + "/database.db";
+
+  Database database(database_path);
+  Reconstruction gt_reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_rigs = 2;
+  synthetic_dataset_options.num_cameras_per_rig = 2;
+  synthetic_dataset_options.num_frames_per_rig = 7;
+  synthetic_dataset_options.num_points3D = 100;
+  synthetic_dataset_options.point2D_stddev = 0.5;
+
+  synthetic_dataset_options.use_prior_position = true;
+  synthetic_dataset_options.prior_position_stddev = 0.0;
+  SynthesizeDataset(synthetic_dataset_options, &gt_reconstruction, &database);
+
+  std::shared_ptr<IncrementalPipelineOptions> mapper_options =
+      std::make_shared<IncrementalPipelineOptions>();
+  mapper_options->use_prior_position = true;
+  mapper_options->init_frames_from_pose_priors = true;
+
+  auto reconstruction_manager = std::make_shared<ReconstructionManager>();
+  IncrementalPipeline mapper(mapper_options,
+                             /*image_path=*/"",
+                             database_path,
+                             reconstruction_manager);
+  mapper.Run();
+
+  ASSERT_EQ(reconstruction_manager->Size(), 1);
+  ExpectReconstructionsNear(gt_reconstruction,
+                            *reconstruction_manager->Get(0),
+                            /*max_rotation_error_deg=*/1e-1,
+                            /*max_proj_center_error=*/1e-1,
+                            /*num_obs_tolerance=*/0.02,
+                            /*align=*/false);
+}
+
+TEST(IncrementalPipeline, RegisterFramesFromPosePriors) {
+  Database database(Database::kInMemoryDatabasePath);
+  Reconstruction gt_reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_rigs = 2;
+  synthetic_dataset_options.num_cameras_per_rig = 2;
+  synthetic_dataset_options.num_frames_per_rig = 7;
+  synthetic_dataset_options.num_points3D = 100;
+  synthetic_dataset_options.point2D_stddev = 0;
+  synthetic_dataset_options.use_prior_position = true;
+  synthetic_dataset_options.prior_position_stddev = 0.0;
+  SynthesizeDataset(synthetic_dataset_options, &gt_reconstruction, &database);
+  const auto database_cache =
+      DatabaseCache::Create(database,
+                            /*min_num_matches=*/0,
+                            /*ignore_watermarks=*/false,
+                            /*image_names=*/{});
+
+  auto reconstruction = std::make_shared<Reconstruction>();
+  IncrementalMapper mapper(database_cache);
+  mapper.BeginReconstruction(reconstruction);
+  EXPECT_EQ(mapper.RegisterFramesFromPosePriors(IncrementalMapper::Options()),
+            gt_reconstruction.NumFrames());
+  EXPECT_EQ(reconstruction->NumRegFrames(), gt_reconstruction.NumFrames());
+  EXPECT_EQ(reconstruction->NumRegImages(), gt_reconstruction.NumImages());
+
+  // Frames are registered in the frame of the prior positions, which is the
+  // ground-truth frame, so the rotations are compared without alignment.
+  for (const frame_t frame_id : reconstruction->RegFrameIds()) {
+    const Eigen::Quaterniond& rotation =
+        reconstruction->Frame(frame_id).RigFromWorld().rotation;
+    const Eigen::Quaterniond& gt_rotation =
+        gt_reconstruction.Frame(frame_id).RigFromWorld().rotation;
+    EXPECT_LT(RadToDeg(rotation.angularDistance(gt_rotation)), 1e-1);
+  }
+
+  mapper.EndReconstruction(/*discard=*/false);
+}
+
 TEST(IncrementalPipeline, PriorBasedSfMWithNoise) {
   const std::string database_path = CreateTestDir() + "/database.db";
 
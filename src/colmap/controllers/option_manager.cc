@@ -330,6 +330,15 @@ void OptionManager::AddMatchingOptions() {
                               &two_view_geometry->multiple_models);
   AddAndRegisterDefaultOption("TwoViewGeometry.compute_relative_pose",
                               &two_view_geometry->compute_relative_pose);
+  AddAndRegisterDefaultOption(
+      "TwoViewGeometry.staged_calibrated_estimation",
+      &two_view_geometry->staged_calibrated_estimation);
+  AddAndRegisterDefaultOption("TwoViewGeometry.pre_filter",
+                              &two_view_geometry->pre_filter);
+  AddAndRegisterDefaultOption("TwoViewGeometry.pre_filter_min_inlier_ratio",
+                              &two_view_geometry->pre_filter_min_inlier_ratio);
+  AddAndRegisterDefaultOption("TwoViewGeometry.pre_filter_confidence",
+                              &two_view_geometry->pre_filter_confidence);
   AddAndRegisterDefaultOption("TwoViewGeometry.detect_watermark",
                               &two_view_geometry->detect_watermark);
   AddAndRegisterDefaultOption("TwoViewGeometry.multiple_ignore_watermark",
@@ -602,6 +611,10 @@ void OptionManager::AddMapperOptions() {
                               &mapper->snapshot_frames_freq);
   AddAndRegisterDefaultOption("Mapper.fix_existing_frames",
                               &mapper->fix_existing_frames);
+  AddAndRegisterDefaultOption("Mapper.parallel_point_triangulation",
+                              &mapper->parallel_point_triangulation);
+  AddAndRegisterDefaultOption("Mapper.init_frames_from_pose_priors",
+                              &mapper->init_frames_from_pose_priors);
 
   // IncrementalMapper.
   AddAndRegisterDefaultOption("Mapper.init_min_num_inliers",
@@ -796,6 +809,8 @@ void OptionManager::AddRenderOptions() {
 
   AddAndRegisterDefaultOption("Render.min_track_len", &render->min_track_len);
   AddAndRegisterDefaultOption("Render.max_error", &render->max_error);
+  AddAndRegisterDefaultOption("Render.max_num_points",
+                              &render->max_num_points);
   AddAndRegisterDefaultOption("Render.refresh_rate", &render->refresh_rate);
   AddAndRegisterDefaultOption("Render.adapt_refresh_rate",
                               &render->adapt_refresh_rate);
@@ -0,0 +1,449 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "colmap/controllers/streaming_pipeline.h"
+
+#include "colmap/controllers/feature_extraction.h"
+#include "colmap/controllers/feature_matching_utils.h"
+#include "colmap/estimators/alignment.h"
+#include "colmap/scene/database_cache.h"
+#include "colmap/util/file.h"
+#include "colmap/util/misc.h"
+#include "colmap/util/timer.h"
+
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+namespace colmap {
+
+bool StreamingPipelineOptions::Check() const {
+  CHECK_OPTION_GT(poll_interval, 0);
+  CHECK_OPTION_GE(min_file_age, 0);
+  CHECK_OPTION_GT(max_batch_size, 0);
+  CHECK_OPTION_GE(num_recent_images, 0);
+  CHECK_OPTION_GE(num_retrieval_images, 0);
+  CHECK_OPTION_GT(retrieval_num_checks, 0);
+  CHECK_OPTION_GT(global_ba_frames_freq, 0);
+  return true;
+}
+
+std::vector<std::string> FindNewStreamingImages(
+    const StreamingPipelineOptions& options,
+    const std::string& image_path,
+    const std::unordered_set<std::string>& processed_image_names) {
+  const auto now = std::filesystem::file_time_type::clock::now();
+  const auto min_file_age = std::chrono::milliseconds(
+      static_cast<int64_t>(1000 * options.min_file_age));
+
+  std::vector<std::string> image_names;
+  for (const std::string& file_path : GetRecursiveFileList(image_path)) {
+    std::string image_name = GetNormalizedRelativePath(file_path, image_path);
+    if (processed_image_names.count(image_name) > 0) {
+      continue;
+    }
+    std::error_code error_code;
+    const auto write_time =
+        std::filesystem::last_write_time(file_path, error_code);
+    if (error_code || now - write_time < min_file_age) {
+      continue;
+    }
+    image_names.push_back(std::move(image_name));
+  }
+
+  // Process the images in the order of their names, which usually reflects
+  // the capture order, and defer the remaining images to the next batch.
+  std::sort(image_names.begin(), image_names.end());
+  if (image_names.size() > static_cast<size_t>(options.max_batch_size)) {
+    image_names.resize(options.max_batch_size);
+  }
+
+  return image_names;
+}
+
+StreamingPipeline::StreamingPipeline(
+    const StreamingPipelineOptions& options,
+    const ImageReaderOptions& reader_options,
+    const FeatureExtractionOptions& extraction_options,
+    const FeatureMatchingOptions& matching_options,
+    const TwoViewGeometryOptions& geometry_options,
+    std::shared_ptr<const IncrementalPipelineOptions> mapper_options,
+    const std::string& database_path,
+    std::shared_ptr<class ReconstructionManager> reconstruction_manager)
+    : options_(options),
+      reader_options_(reader_options),
+      extraction_options_(extraction_options),
+      matching_options_(matching_options),
+      geometry_options_(geometry_options),
+      mapper_options_(std::move(mapper_options)),
+      database_path_(database_path),
+      reconstruction_manager_(std::move(reconstruction_manager)),
+      ba_prev_num_reg_frames_(0),
+      global_ba_thread_pool_(1),
+      batch_finished_callback_pending_(false),
+      finish_requested_(false) {
+  THROW_CHECK(options_.Check());
+  THROW_CHECK(reader_options_.Check());
+  THROW_CHECK(extraction_options_.Check());
+  THROW_CHECK(matching_options_.Check());
+  THROW_CHECK(geometry_options_.Check());
+  THROW_CHECK(mapper_options_->Check());
+  THROW_CHECK_LE(reconstruction_manager_->Size(), 1)
+      << "Streaming reconstruction only supports a single model";
+  RegisterCallback(NEXT_IMAGE_REG_CALLBACK);
+  RegisterCallback(BATCH_FINISHED_CALLBACK);
+}
+
+void StreamingPipeline::Run() {
+  PrintHeading1("Streaming reconstruction");
+
+  database_ = std::make_shared<Database>(database_path_);
+
+  if (!options_.vocab_tree_path.empty()) {
+    visual_index_ = retrieval::VisualIndex::Read(options_.vocab_tree_path);
+  }
+
+  // Images already in the database were extracted and matched in a previous
+  // run, e.g., when resuming an interrupted capture. Only keep track of them
+  // as matching candidates for the new images.
+  std::vector<Image> existing_images = database_->ReadAllImages();
+  std::sort(existing_images.begin(),
+            existing_images.end(),
+            [](const Image& image1, const Image& image2) {
+              return image1.Name() < image2.Name();
+            });
+  std::vector<image_t> existing_image_ids;
+  existing_image_ids.reserve(existing_images.size());
+  for (const Image& image : existing_images) {
+    processed_image_names_.insert(image.Name());
+    existing_image_ids.push_back(image.ImageId());
+  }
+  if (!existing_image_ids.empty()) {
+    LOG(INFO) << StringPrintf("Resuming with %d existing images",
+                              existing_image_ids.size());
+    MatchFeatures(existing_image_ids);
+  }
+
+  if (reconstruction_manager_->Size() > 0) {
+    ba_prev_num_reg_frames_ = reconstruction_manager_->Get(0)->NumRegFrames();
+  }
+
+  Timer idle_timer;
+  idle_timer.Start();
+
+  while (!CheckIfStopped() && !finish_requested_) {
+    const std::vector<std::string> image_names = FindNewStreamingImages(
+        options_, reader_options_.image_path, processed_image_names_);
+    if (image_names.empty()) {
+      // Join a finished global refinement, such that the deferred callback of
+      // the last batch is not delayed until the next batch arrives.
+      if (global_ba_future_.valid() &&
+          global_ba_future_.wait_for(std::chrono::seconds(0)) ==
+              std::future_status::ready) {
+        WaitForGlobalRefinement();
+      }
+      if (options_.idle_timeout > 0 &&
+          idle_timer.ElapsedSeconds() > options_.idle_timeout) {
+        LOG(INFO) << "No new images arrived, finishing reconstruction";
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(
+          static_cast<int>(1000 * options_.poll_interval)));
+      continue;
+    }
+
+    PrintHeading1(
+        StringPrintf("Processing batch of %d images", image_names.size()));
+    Timer batch_timer;
+    batch_timer.Start();
+
+    const std::vector<image_t> image_ids = ExtractFeatures(image_names);
+    MatchFeatures(image_ids);
+    Reconstruct(/*final_refinement=*/false);
+
+    if (global_ba_future_.valid()) {
+      batch_finished_callback_pending_ = true;
+    } else {
+      Callback(BATCH_FINISHED_CALLBACK);
+    }
+    batch_timer.PrintSeconds();
+    idle_timer.Restart();
+  }
+
+  WaitForGlobalRefinement();
+
+  if (!CheckIfStopped()) {
+    Reconstruct(/*final_refinement=*/true);
+  } else if (reconstruction_manager_->Size() > 0) {
+    LOG(INFO) << "Keeping reconstruction due to interrupt";
+    WriteReconstruction(*reconstruction_manager_->Get(0));
+  }
+}
+
+std::vector<image_t> StreamingPipeline::ExtractFeatures(
+    const std::vector<std::string>& image_names) {
+  ImageReaderOptions reader_options = reader_options_;
+  reader_options.image_names = image_names;
+  auto extractor = CreateFeatureExtractorController(
+      database_path_, reader_options, extraction_options_);
+  extractor->Start();
+  extractor->Wait();
+
+  // Images that could not be read are not retried, as they would otherwise
+  // fail again in every subsequent batch.
+  processed_image_names_.insert(image_names.begin(), image_names.end());
+
+  std::vector<image_t> image_ids;
+  image_ids.reserve(image_names.size());
+  for (const std::string& image_name : image_names) {
+    const std::optional<Image> image = database_->ReadImageWithName(image_name);
+    if (!image.has_value()) {
+      LOG(WARNING) << StringPrintf("Failed to extract features for image %s",
+                                   image_name.c_str());
+      continue;
+    }
+    image_ids.push_back(image->ImageId());
+
+    // The image reader creates a new camera in every batch, so subsequent
+    // batches explicitly share the camera of the first image.
+    if (reader_options_.single_camera &&
+        static_cast<camera_t>(reader_options_.existing_camera_id) ==
+            kInvalidCameraId) {
+      reader_options_.existing_camera_id = image->CameraId();
+    }
+  }
+
+  return image_ids;
+}
+
+void StreamingPipeline::MatchFeatures(const std::vector<image_t>& image_ids) {
+  if (image_ids.empty()) {
+    return;
+  }
+
+  auto cache = std::make_shared<FeatureMatcherCache>(
+      /*cache_size=*/2 * (options_.max_batch_size + options_.num_recent_images +
+                          options_.num_retrieval_images),
+      database_);
+
+  std::vector<std::pair<image_t, image_t>> image_pairs;
+  image_pairs.reserve(
+      image_ids.size() *
+      (options_.num_recent_images + options_.num_retrieval_images));
+
+  // Match against the most recent images in the order of arrival, which
+  // typically have the largest overlap with the new images.
+  for (const image_t image_id : image_ids) {
+    for (const image_t recent_image_id : recent_image_ids_) {
+      image_pairs.emplace_back(recent_image_id, image_id);
+    }
+    if (options_.num_recent_images > 0) {
+      recent_image_ids_.push_back(image_id);
+      if (recent_image_ids_.size() >
+          static_cast<size_t>(options_.num_recent_images)) {
+        recent_image_ids_.pop_front();
+      }
+    }
+  }
+
+  // Match against the most similar images in the visual index, which is
+  // incrementally extended by the new images.
+  if (visual_index_ != nullptr && options_.num_retrieval_images > 0) {
+    retrieval::VisualIndex::IndexOptions index_options;
+    index_options.num_checks = options_.retrieval_num_checks;
+    index_options.num_threads = extraction_options_.num_threads;
+    for (const image_t image_id : image_ids) {
+      visual_index_->Add(index_options,
+                         image_id,
+                         *cache->GetKeypoints(image_id),
+                         cache->GetDescriptors(image_id)->cast<float>());
+    }
+    visual_index_->Prepare();
+
+    retrieval::VisualIndex::QueryOptions query_options;
+    // Retrieve one more image, since the query image itself is indexed.
+    query_options.max_num_images = options_.num_retrieval_images + 1;
+    query_options.num_checks = options_.retrieval_num_checks;
+    query_options.num_threads = extraction_options_.num_threads;
+    std::vector<retrieval::ImageScore> image_scores;
+    for (const image_t image_id : image_ids) {
+      visual_index_->Query(query_options,
+                           cache->GetDescriptors(image_id)->cast<float>(),
+                           &image_scores);
+      for (const retrieval::ImageScore& image_score : image_scores) {
+        image_pairs.emplace_back(image_score.image_id, image_id);
+      }
+    }
+  }
+
+  FeatureMatcherController matcher(
+      matching_options_, geometry_options_, std::move(cache));
+  if (!matcher.Setup()) {
+    LOG(ERROR) << "Failed to setup feature matcher";
+    return;
+  }
+
+  // Self-matches and duplicate or already matched pairs are skipped.
+  matcher.Match(image_pairs);
+}
+
+void StreamingPipeline::Reconstruct(const bool final_refinement) {
+  WaitForGlobalRefinement();
+
+  IncrementalPipeline pipeline(mapper_options_,
+                               reader_options_.image_path,
+                               database_path_,
+                               reconstruction_manager_);
+  if (!pipeline.LoadDatabase()) {
+    return;
+  }
+
+  if (reconstruction_manager_->Size() == 0) {
+    reconstruction_manager_->Add();
+    ba_prev_num_reg_frames_ = 0;
+  }
+  std::shared_ptr<Reconstruction> reconstruction =
+      reconstruction_manager_->Get(0);
+
+  const IncrementalMapper::Options mapper_options = mapper_options_->Mapper();
+  auto mapper = std::make_shared<IncrementalMapper>(pipeline.DatabaseCache());
+  mapper->BeginReconstruction(reconstruction);
+
+  if (reconstruction->NumRegFrames() == 0) {
+    const IncrementalPipeline::Status status =
+        pipeline.InitializeReconstruction(
+            *mapper, mapper_options, *reconstruction);
+    if (status != IncrementalPipeline::Status::SUCCESS) {
+      // Wait for more images to arrive and then try again.
+      LOG(INFO) << "Could not initialize reconstruction, waiting for more "
+                   "images";
+      mapper->EndReconstruction(/*discard=*/true);
+      reconstruction_manager_->Delete(0);
+      return;
+    }
+    ba_prev_num_reg_frames_ = reconstruction->NumRegFrames();
+    Callback(NEXT_IMAGE_REG_CALLBACK);
+  }
+
+  while (!CheckIfStopped()) {
+    const std::vector<image_t> next_images =
+        mapper->FindNextImages(mapper_options);
+
+    const image_t next_image_id =
+        mapper->RegisterNextImageFromCandidates(mapper_options, next_images);
+    if (next_image_id == kInvalidImageId) {
+      break;
+    }
+
+    LOG(INFO) << StringPrintf("Registered image #%d (num_reg_frames=%d)",
+                              next_image_id,
+                              reconstruction->NumRegFrames());
+
+    const Image& image = reconstruction->Image(next_image_id);
+    for (const data_t& data_id : image.FramePtr()->ImageIds()) {
+      mapper->TriangulateImage(mapper_options_->Triangulation(), data_id.id);
+    }
+    mapper->IterativeLocalRefinement(
+        mapper_options_->ba_local_max_refinements,
+        mapper_options_->ba_local_max_refinement_change,
+        mapper_options,
+        mapper_options_->LocalBundleAdjustment(),
+        mapper_options_->Triangulation(),
+        next_image_id);
+
+    if (mapper_options_->extract_colors) {
+      for (const data_t& data_id : image.FramePtr()->ImageIds()) {
+        reconstruction->ExtractColorsForImage(data_id.id,
+                                              reader_options_.image_path);
+      }
+    }
+
+    Callback(NEXT_IMAGE_REG_CALLBACK);
+  }
+
+  auto global_refinement = [this, mapper, mapper_options]() {
+    LOG(INFO) << "Retriangulation and Global bundle adjustment";
+    mapper->IterativeGlobalRefinement(
+        mapper_options_->ba_global_max_refinements,
+        mapper_options_->ba_global_max_refinement_change,
+        mapper_options,
+        mapper_options_->GlobalBundleAdjustment(),
+        mapper_options_->Triangulation());
+    mapper->FilterFrames(mapper_options);
+    mapper->EndReconstruction(/*discard=*/false);
+  };
+
+  if (final_refinement) {
+    global_refinement();
+    AlignReconstructionToOrigRigScales(pipeline.DatabaseCache()->Rigs(),
+                                       reconstruction.get());
+    WriteReconstruction(*reconstruction);
+  } else if (reconstruction->NumRegFrames() >=
+             ba_prev_num_reg_frames_ + options_.global_ba_frames_freq) {
+    // The reconstruction is not modified until the next batch is extracted and
+    // matched, so the global refinement can run in the meantime.
+    ba_prev_num_reg_frames_ = reconstruction->NumRegFrames();
+    global_ba_future_ = global_ba_thread_pool_.AddTask(
+        [this, global_refinement, reconstruction]() {
+          global_refinement();
+          WriteReconstruction(*reconstruction);
+        });
+  } else {
+    mapper->EndReconstruction(/*discard=*/false);
+    WriteReconstruction(*reconstruction);
+  }
+}
+
+void StreamingPipeline::Finish() {
+  static_assert(std::atomic<bool>::is_always_lock_free,
+                "Finish must be async-signal-safe");
+  finish_requested_ = true;
+}
+
+void StreamingPipeline::WaitForGlobalRefinement() {
+  if (global_ba_future_.valid()) {
+    global_ba_future_.get();
+  }
+  if (batch_finished_callback_pending_) {
+    batch_finished_callback_pending_ = false;
+    Callback(BATCH_FINISHED_CALLBACK);
+  }
+}
+
+void StreamingPipeline::WriteReconstruction(
+    const Reconstruction& reconstruction) const {
+  if (options_.output_path.empty()) {
+    return;
+  }
+  const std::string reconstruction_path = JoinPaths(options_.output_path, "0");
+  CreateDirIfNotExists(reconstruction_path);
+  reconstruction.Write(reconstruction_path);
+}
+
+}  // namespace colmap
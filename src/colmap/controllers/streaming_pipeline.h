@@ -0,0 +1,187 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "colmap/controllers/image_reader.h"
+#include "colmap/controllers/incremental_pipeline.h"
+#include "colmap/estimators/two_view_geometry.h"
+#include "colmap/feature/extractor.h"
+#include "colmap/feature/matcher.h"
+#include "colmap/retrieval/visual_index.h"
+#include "colmap/scene/database.h"
+#include "colmap/scene/reconstruction_manager.h"
+#include "colmap/util/base_controller.h"
+#include "colmap/util/threading.h"
+
+#include <atomic>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace colmap {
+
+struct StreamingPipelineOptions {
+  // Interval in seconds at which the image directory is scanned for new
+  // images.
+  double poll_interval = 1.0;
+
+  // Minimum time in seconds since the last modification of an image file
+  // before it is processed. Avoids reading images that are still being
+  // written to the directory.
+  double min_file_age = 1.0;
+
+  // Maximum number of new images processed in one batch.
+  int max_batch_size = 50;
+
+  // Number of most recently processed images each new image is matched
+  // against.
+  int num_recent_images = 10;
+
+  // Optional path to a vocabulary tree used to retrieve additional matching
+  // candidates for each new image, e.g., to close loops. If empty, images are
+  // only matched against the most recent images.
+  std::string vocab_tree_path = "";
+
+  // Number of images to retrieve from the vocabulary tree for each new image.
+  int num_retrieval_images = 10;
+
+  // Number of nearest-neighbor checks to use in retrieval.
+  int retrieval_num_checks = 64;
+
+  // Number of newly registered frames after which a global bundle adjustment
+  // is run in the background while the next batch is extracted and matched.
+  int global_ba_frames_freq = 100;
+
+  // Stop after no new images have arrived for the given number of seconds.
+  // If non-positive, the pipeline runs until it is explicitly finished or
+  // stopped.
+  double idle_timeout = -1.0;
+
+  // Optional path to which the live reconstruction is written after every
+  // batch, after every global bundle adjustment, and when the pipeline
+  // finishes.
+  std::string output_path = "";
+
+  bool Check() const;
+};
+
+// Find the images in image_path that are not yet processed and whose files
+// were last modified at least min_file_age seconds ago. Returns at most
+// max_batch_size image names in lexicographic order.
+std::vector<std::string> FindNewStreamingImages(
+    const StreamingPipelineOptions& options,
+    const std::string& image_path,
+    const std::unordered_set<std::string>& processed_image_names);
+
+// Reconstruct a scene from images that incrementally arrive in a directory,
+// e.g., from a camera that is currently capturing. New images are extracted
+// and matched against the most recently processed and retrieved images in
+// small batches and then registered into a single live reconstruction, such
+// that the reconstruction grows while the capture is still ongoing. Global
+// bundle adjustment is periodically run in the background, overlapped with
+// feature extraction and matching of the next batch.
+//
+// The live reconstruction is owned by the thread calling Run, except while a
+// background global bundle adjustment is pending, which owns it until it is
+// joined before the next registration. All callbacks are invoked on the
+// thread calling Run while it owns the reconstruction. Hence, the batch
+// finished callback is deferred until the pending global bundle adjustment is
+// joined.
+class StreamingPipeline : public BaseController {
+ public:
+  enum CallbackType {
+    NEXT_IMAGE_REG_CALLBACK,
+    BATCH_FINISHED_CALLBACK,
+  };
+
+  StreamingPipeline(
+      const StreamingPipelineOptions& options,
+      const ImageReaderOptions& reader_options,
+      const FeatureExtractionOptions& extraction_options,
+      const FeatureMatchingOptions& matching_options,
+      const TwoViewGeometryOptions& geometry_options,
+      std::shared_ptr<const IncrementalPipelineOptions> mapper_options,
+      const std::string& database_path,
+      std::shared_ptr<class ReconstructionManager> reconstruction_manager);
+
+  void Run();
+
+  // Stop waiting for new images and finish the reconstruction with a final
+  // global refinement once the current batch is processed. In contrast to
+  // stopping the pipeline, the final refinement is still run. Can be called
+  // from any thread and from signal handlers.
+  void Finish();
+
+ private:
+  std::vector<image_t> ExtractFeatures(
+      const std::vector<std::string>& image_names);
+
+  void MatchFeatures(const std::vector<image_t>& image_ids);
+
+  // Register all registrable images into the live reconstruction. If
+  // final_refinement is true, the reconstruction is globally refined before
+  // returning. Otherwise, global refinement is scheduled in the background if
+  // sufficiently many new frames were registered.
+  void Reconstruct(bool final_refinement);
+
+  // Join the pending global refinement, if any, and invoke the deferred batch
+  // finished callback.
+  void WaitForGlobalRefinement();
+
+  void WriteReconstruction(const Reconstruction& reconstruction) const;
+
+  const StreamingPipelineOptions options_;
+  ImageReaderOptions reader_options_;
+  const FeatureExtractionOptions extraction_options_;
+  const FeatureMatchingOptions matching_options_;
+  const TwoViewGeometryOptions geometry_options_;
+  const std::shared_ptr<const IncrementalPipelineOptions> mapper_options_;
+  const std::string database_path_;
+  std::shared_ptr<class ReconstructionManager> reconstruction_manager_;
+
+  std::shared_ptr<Database> database_;
+  std::unique_ptr<retrieval::VisualIndex> visual_index_;
+
+  // Names of all images that have been processed or failed to be processed.
+  std::unordered_set<std::string> processed_image_names_;
+  // The most recently processed images in the order of their arrival.
+  std::deque<image_t> recent_image_ids_;
+
+  size_t ba_prev_num_reg_frames_;
+  ThreadPool global_ba_thread_pool_;
+  std::future<void> global_ba_future_;
+  bool batch_finished_callback_pending_;
+  std::atomic<bool> finish_requested_;
+};
+
+}  // namespace colmap
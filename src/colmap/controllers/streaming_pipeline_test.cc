@@ -0,0 +1,245 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "colmap/controllers/streaming_pipeline.h"
+
+#include "colmap/scene/synthetic.h"
+#include "colmap/util/file.h"
+#include "colmap/util/testing.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+namespace colmap {
+namespace {
+
+void CreateFile(const std::string& path, const double age_seconds) {
+  std::ofstream file(path);
+  file << "image";
+  file.close();
+  std::filesystem::last_write_time(
+      path,
+      std::filesystem::file_time_type::clock::now() -
+          std::chrono::milliseconds(static_cast<int64_t>(1000 * age_seconds)));
+}
+
+void CreateImageWithSquare(const int size, Bitmap* bitmap) {
+  bitmap->Allocate(size, size, false);
+  bitmap->Fill(BitmapColor<uint8_t>(0, 0, 0));
+  for (int r = size / 2 - size / 8; r < size / 2 + size / 8; ++r) {
+    for (int c = size / 2 - size / 8; c < size / 2 + size / 8; ++c) {
+      bitmap->SetPixel(r, c, BitmapColor<uint8_t>(255));
+    }
+  }
+}
+
+TEST(FindNewStreamingImages, Nominal) {
+  const std::string image_path = CreateTestDir();
+  CreateDirIfNotExists(image_path + "/sub");
+  CreateFile(image_path + "/c.png", /*age_seconds=*/100);
+  CreateFile(image_path + "/a.png", /*age_seconds=*/100);
+  CreateFile(image_path + "/sub/b.png", /*age_seconds=*/100);
+
+  StreamingPipelineOptions options;
+  options.min_file_age = 10;
+  EXPECT_EQ(FindNewStreamingImages(options, image_path, {}),
+            (std::vector<std::string>{"a.png", "c.png", "sub/b.png"}));
+  EXPECT_EQ(FindNewStreamingImages(options, image_path, {"a.png"}),
+            (std::vector<std::string>{"c.png", "sub/b.png"}));
+  EXPECT_TRUE(FindNewStreamingImages(
+                  options, image_path, {"a.png", "c.png", "sub/b.png"})
+                  .empty());
+}
+
+TEST(FindNewStreamingImages, MinFileAge) {
+  const std::string image_path = CreateTestDir();
+  CreateFile(image_path + "/a.png", /*age_seconds=*/100);
+  CreateFile(image_path + "/b.png", /*age_seconds=*/0);
+
+  StreamingPipelineOptions options;
+  options.min_file_age = 10;
+  EXPECT_EQ(FindNewStreamingImages(options, image_path, {}),
+            std::vector<std::string>{"a.png"});
+  options.min_file_age = 0;
+  EXPECT_EQ(FindNewStreamingImages(options, image_path, {}),
+            (std::vector<std::string>{"a.png", "b.png"}));
+  options.min_file_age = 1000;
+  EXPECT_TRUE(FindNewStreamingImages(options, image_path, {}).empty());
+}
+
+TEST(FindNewStreamingImages, MaxBatchSize) {
+  const std::string image_path = CreateTestDir();
+  for (const std::string name : {"d.png", "b.png", "a.png", "c.png"}) {
+    CreateFile(image_path + "/" + name, /*age_seconds=*/100);
+  }
+
+  StreamingPipelineOptions options;
+  options.min_file_age = 0;
+  options.max_batch_size = 3;
+  EXPECT_EQ(FindNewStreamingImages(options, image_path, {}),
+            (std::vector<std::string>{"a.png", "b.png", "c.png"}));
+  EXPECT_EQ(FindNewStreamingImages(options, image_path, {"a.png", "b.png"}),
+            (std::vector<std::string>{"c.png", "d.png"}));
+}
+
+class StreamingPipelineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    test_dir_ = CreateTestDir();
+    database_path_ = test_dir_ + "/database.db";
+    image_path_ = test_dir_ + "/images";
+    output_path_ = test_dir_ + "/sparse";
+    CreateDirIfNotExists(image_path_);
+    CreateDirIfNotExists(output_path_);
+
+    options_.poll_interval = 0.1;
+    options_.min_file_age = 0;
+    options_.max_batch_size = 2;
+    options_.idle_timeout = 1;
+    options_.output_path = output_path_;
+    reader_options_.image_path = image_path_;
+    extraction_options_.use_gpu = false;
+    matching_options_.use_gpu = false;
+    auto mapper_options = std::make_shared<IncrementalPipelineOptions>();
+    mapper_options->extract_colors = false;
+    mapper_options_ = std::move(mapper_options);
+  }
+
+  std::unique_ptr<StreamingPipeline> CreatePipeline(
+      std::shared_ptr<ReconstructionManager> reconstruction_manager) const {
+    return std::make_unique<StreamingPipeline>(options_,
+                                               reader_options_,
+                                               extraction_options_,
+                                               matching_options_,
+                                               geometry_options_,
+                                               mapper_options_,
+                                               database_path_,
+                                               reconstruction_manager);
+  }
+
+  std::string test_dir_;
+  std::string database_path_;
+  std::string image_path_;
+  std::string output_path_;
+  StreamingPipelineOptions options_;
+  ImageReaderOptions reader_options_;
+  FeatureExtractionOptions extraction_options_;
+  FeatureMatchingOptions matching_options_;
+  TwoViewGeometryOptions geometry_options_;
+  std::shared_ptr<const IncrementalPipelineOptions> mapper_options_;
+};
+
+TEST_F(StreamingPipelineTest, ProcessesAllImagesUntilIdle) {
+  constexpr int kNumImages = 5;
+  Bitmap bitmap;
+  CreateImageWithSquare(256, &bitmap);
+  for (int i = 0; i < kNumImages; ++i) {
+    bitmap.Write(image_path_ + "/" + std::to_string(i) + ".png");
+  }
+
+  auto reconstruction_manager = std::make_shared<ReconstructionManager>();
+  auto pipeline = CreatePipeline(reconstruction_manager);
+  int num_batches = 0;
+  pipeline->AddCallback(StreamingPipeline::BATCH_FINISHED_CALLBACK,
+                        [&]() { ++num_batches; });
+  pipeline->Run();
+
+  // The images only show a single square, so they cannot be reconstructed,
+  // but all of them are processed in batches before the pipeline goes idle.
+  EXPECT_EQ(num_batches, 3);
+  Database database(database_path_);
+  EXPECT_EQ(database.NumImages(), kNumImages);
+  for (int i = 0; i < kNumImages; ++i) {
+    EXPECT_TRUE(database.ExistsImageWithName(std::to_string(i) + ".png"));
+  }
+}
+
+TEST_F(StreamingPipelineTest, FinishesWithoutIdleTimeout) {
+  constexpr int kNumImages = 5;
+  Bitmap bitmap;
+  CreateImageWithSquare(256, &bitmap);
+  for (int i = 0; i < kNumImages; ++i) {
+    bitmap.Write(image_path_ + "/" + std::to_string(i) + ".png");
+  }
+  options_.idle_timeout = -1;
+
+  auto reconstruction_manager = std::make_shared<ReconstructionManager>();
+  auto pipeline = CreatePipeline(reconstruction_manager);
+  int num_batches = 0;
+  pipeline->AddCallback(StreamingPipeline::BATCH_FINISHED_CALLBACK, [&]() {
+    ++num_batches;
+    pipeline->Finish();
+  });
+  pipeline->Run();
+
+  // The current batch is completed, but no further batches are processed.
+  EXPECT_EQ(num_batches, 1);
+  EXPECT_EQ(Database(database_path_).NumImages(), options_.max_batch_size);
+}
+
+TEST_F(StreamingPipelineTest, DefersBatchCallbackUntilGlobalRefinement) {
+  // Images in the database are resumed from a previous run and registered
+  // with the first batch, which schedules the global refinement.
+  {
+    Database database(database_path_);
+    Reconstruction gt_reconstruction;
+    SyntheticDatasetOptions synthetic_dataset_options;
+    synthetic_dataset_options.num_rigs = 1;
+    synthetic_dataset_options.num_cameras_per_rig = 1;
+    synthetic_dataset_options.num_frames_per_rig = 5;
+    synthetic_dataset_options.num_points3D = 50;
+    SynthesizeDataset(synthetic_dataset_options, &gt_reconstruction, &database);
+  }
+  Bitmap bitmap;
+  CreateImageWithSquare(256, &bitmap);
+  bitmap.Write(image_path_ + "/new.png");
+  options_.global_ba_frames_freq = 1;
+
+  auto reconstruction_manager = std::make_shared<ReconstructionManager>();
+  auto pipeline = CreatePipeline(reconstruction_manager);
+  int num_batches = 0;
+  pipeline->AddCallback(StreamingPipeline::BATCH_FINISHED_CALLBACK, [&]() {
+    ++num_batches;
+    // The background refinement writes the reconstruction when it is done.
+    EXPECT_TRUE(ExistsFile(JoinPaths(output_path_, "0", "images.bin")));
+    ASSERT_EQ(reconstruction_manager->Size(), 1);
+    EXPECT_EQ(reconstruction_manager->Get(0)->NumRegFrames(), 5);
+  });
+  pipeline->Run();
+
+  EXPECT_EQ(num_batches, 1);
+  ASSERT_EQ(reconstruction_manager->Size(), 1);
+  EXPECT_EQ(reconstruction_manager->Get(0)->NumRegFrames(), 5);
+}
+
+}  // namespace
+}  // namespace colmap
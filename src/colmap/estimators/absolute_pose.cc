@@ -72,6 +72,22 @@ void P3PEstimator::Residuals(const std::vector<X_t>& points2D,
       points2D, points3D, cam_from_world, img_from_cam_func_, residuals);
 }
 
+void P3PEstimator::BatchedResiduals(
+    const std::vector<X_t>& points2D,
+    const std::vector<Y_t>& points3D,
+    const std::vector<M_t>& cams_from_world,
+    const double max_residual,
+    const size_t min_num_inliers,
+    std::vector<std::vector<double>>* residuals) const {
+  ComputeBatchedSquaredReprojectionErrors(points2D,
+                                          points3D,
+                                          cams_from_world,
+                                          img_from_cam_func_,
+                                          max_residual,
+                                          min_num_inliers,
+                                          residuals);
+}
+
 void P4PFEstimator::Estimate(const std::vector<X_t>& points2D,
                              const std::vector<Y_t>& points3D,
                              std::vector<M_t>* models) {
@@ -574,4 +590,84 @@ void ComputeSquaredReprojectionError(
   }
 }
 
+void ComputeBatchedSquaredReprojectionErrors(
+    const std::vector<Point2DWithRay>& points2D,
+    const std::vector<Eigen::Vector3d>& points3D,
+    const std::vector<Eigen::Matrix3x4d>& cams_from_world,
+    const ImgFromCamFunc& img_from_cam_func,
+    const double max_residual,
+    const size_t min_num_inliers,
+    std::vector<std::vector<double>>* residuals) {
+  const size_t num_points = points2D.size();
+  THROW_CHECK_EQ(num_points, points3D.size());
+  THROW_CHECK_NOTNULL(residuals);
+
+  const size_t num_models = cams_from_world.size();
+  residuals->resize(num_models);
+  for (std::vector<double>& model_residuals : *residuals) {
+    model_residuals.resize(num_points);
+  }
+
+  std::vector<size_t> num_inliers(num_models, 0);
+  std::vector<char> is_active(num_models, true);
+  size_t num_active_models = num_models;
+
+  constexpr int kBlockSize = 64;
+  Eigen::Array<double, kBlockSize, 3> block_points3D =
+      Eigen::Array<double, kBlockSize, 3>::Zero();
+  Eigen::Array<double, kBlockSize, 3> block_points3D_in_cam;
+
+  for (size_t block_beg = 0; block_beg < num_points && num_active_models > 0;
+       block_beg += kBlockSize) {
+    const size_t block_end = std::min(block_beg + kBlockSize, num_points);
+    const size_t block_size = block_end - block_beg;
+    for (size_t i = 0; i < block_size; ++i) {
+      block_points3D.row(i) = points3D[block_beg + i].transpose();
+    }
+
+    for (size_t model_idx = 0; model_idx < num_models; ++model_idx) {
+      if (!is_active[model_idx]) {
+        continue;
+      }
+
+      const Eigen::Matrix3x4d& cam_from_world = cams_from_world[model_idx];
+      for (int d = 0; d < 3; ++d) {
+        block_points3D_in_cam.col(d) =
+            cam_from_world(d, 0) * block_points3D.col(0) +
+            cam_from_world(d, 1) * block_points3D.col(1) +
+            cam_from_world(d, 2) * block_points3D.col(2) + cam_from_world(d, 3);
+      }
+
+      std::vector<double>& model_residuals = (*residuals)[model_idx];
+      for (size_t i = 0; i < block_size; ++i) {
+        double& residual = model_residuals[block_beg + i];
+        residual = std::numeric_limits<double>::max();
+        if (block_points3D_in_cam(i, 2) <
+            std::numeric_limits<double>::epsilon()) {
+          continue;
+        }
+        const std::optional<Eigen::Vector2d> proj_image_point =
+            img_from_cam_func(block_points3D_in_cam.row(i).transpose());
+        if (proj_image_point) {
+          residual =
+              (*proj_image_point - points2D[block_beg + i].image_point)
+                  .squaredNorm();
+          if (residual <= max_residual) {
+            num_inliers[model_idx] += 1;
+          }
+        }
+      }
+
+      // Reject the model, if the remaining points cannot provide enough
+      // inliers anymore.
+      if (num_inliers[model_idx] + (num_points - block_end) <
+          min_num_inliers) {
+        model_residuals.clear();
+        is_active[model_idx] = false;
+        num_active_models -= 1;
+      }
+    }
+  }
+}
+
 }  // namespace colmap
@@ -89,6 +89,17 @@ class P3PEstimator {
                  const M_t& cam_from_world,
                  std::vector<double>* residuals) const;
 
+  // Calculate the squared reprojection errors of all poses estimated from a
+  // minimal sample in a single pass over the correspondences. Poses with
+  // provably fewer than `min_num_inliers` inliers are rejected early and
+  // their residuals are left empty.
+  void BatchedResiduals(const std::vector<X_t>& points2D,
+                        const std::vector<Y_t>& points3D,
+                        const std::vector<M_t>& cams_from_world,
+                        double max_residual,
+                        size_t min_num_inliers,
+                        std::vector<std::vector<double>>* residuals) const;
+
  private:
   const ImgFromCamFunc img_from_cam_func_;
 };
@@ -227,4 +238,19 @@ void ComputeSquaredReprojectionError(
     const ImgFromCamFunc& img_from_cam_func,
     std::vector<double>* residuals);
 
+// Compute squared reprojection errors in pixels for multiple poses at once.
+// The correspondences are processed in blocks, which are transformed by all
+// poses in structure-of-arrays layout. Points behind the camera are assigned
+// the maximum residual without calling `img_from_cam_func`. The evaluation of
+// a pose stops as soon as it can no longer reach `min_num_inliers` residuals
+// smaller or equal to `max_residual`, in which case its residuals are empty.
+void ComputeBatchedSquaredReprojectionErrors(
+    const std::vector<Point2DWithRay>& points2D,
+    const std::vector<Eigen::Vector3d>& points3D,
+    const std::vector<Eigen::Matrix3x4d>& cams_from_world,
+    const ImgFromCamFunc& img_from_cam_func,
+    double max_residual,
+    size_t min_num_inliers,
+    std::vector<std::vector<double>>* residuals);
+
 }  // namespace colmap
@@ -344,5 +344,79 @@ TEST(ComputeSquaredReprojectionError, Nominal) {
                                    std::numeric_limits<double>::max()));
 }
 
+TEST(ComputeBatchedSquaredReprojectionErrors, Nominal) {
+  const Camera camera = Camera::CreateFromModelId(
+      kInvalidCameraId, CameraModelId::kSimpleRadial, 100, 200, 150);
+  auto img_from_cam_func =
+      std::bind(&Camera::ImgFromCam, &camera, std::placeholders::_1);
+
+  const Rigid3d cam_from_world(Eigen::Quaterniond::UnitRandom(),
+                               Eigen::Vector3d::Random());
+  std::vector<Eigen::Vector3d> points3D;
+  std::vector<Point2DWithRay> points2D;
+  for (int i = 0; i < 150; ++i) {
+    const Eigen::Vector3d point3D_in_cam(
+        Eigen::Vector2d::Random().x(), Eigen::Vector2d::Random().y(), 2);
+    points3D.push_back(Inverse(cam_from_world) * point3D_in_cam);
+    points2D.push_back(Point2DWithRay{camera.ImgFromCam(point3D_in_cam).value(),
+                                      Eigen::Vector3d::Zero()});
+    if (i % 3 == 0) {
+      points2D.back().image_point += Eigen::Vector2d(10, 0);
+    }
+  }
+
+  const std::vector<Eigen::Matrix3x4d> cams_from_world = {
+      cam_from_world.ToMatrix(),
+      Rigid3d(Eigen::Quaterniond::UnitRandom(), Eigen::Vector3d::Random())
+          .ToMatrix(),
+      Rigid3d(cam_from_world.rotation, Eigen::Vector3d(0, 0, -10)).ToMatrix(),
+  };
+
+  constexpr double kMaxResidual = 1;
+  std::vector<std::vector<double>> residuals;
+  ComputeBatchedSquaredReprojectionErrors(points2D,
+                                          points3D,
+                                          cams_from_world,
+                                          img_from_cam_func,
+                                          kMaxResidual,
+                                          /*min_num_inliers=*/0,
+                                          &residuals);
+  ASSERT_EQ(residuals.size(), cams_from_world.size());
+  for (size_t i = 0; i < cams_from_world.size(); ++i) {
+    std::vector<double> expected_residuals;
+    ComputeSquaredReprojectionError(points2D,
+                                    points3D,
+                                    cams_from_world[i],
+                                    img_from_cam_func,
+                                    &expected_residuals);
+    ASSERT_EQ(residuals[i].size(), expected_residuals.size());
+    for (size_t j = 0; j < expected_residuals.size(); ++j) {
+      EXPECT_NEAR(residuals[i][j], expected_residuals[j], 1e-6);
+    }
+  }
+
+  // Only the correct pose has enough inliers, all others are rejected early.
+  ComputeBatchedSquaredReprojectionErrors(points2D,
+                                          points3D,
+                                          cams_from_world,
+                                          img_from_cam_func,
+                                          kMaxResidual,
+                                          /*min_num_inliers=*/100,
+                                          &residuals);
+  ASSERT_EQ(residuals.size(), cams_from_world.size());
+  EXPECT_EQ(residuals[0].size(), points2D.size());
+  EXPECT_TRUE(residuals[1].empty());
+  EXPECT_TRUE(residuals[2].empty());
+
+  ComputeBatchedSquaredReprojectionErrors(points2D,
+                                          points3D,
+                                          cams_from_world,
+                                          img_from_cam_func,
+                                          kMaxResidual,
+                                          /*min_num_inliers=*/101,
+                                          &residuals);
+  EXPECT_TRUE(residuals[0].empty());
+}
+
 }  // namespace
 }  // namespace colmap
@@ -30,7 +30,9 @@
 #include "colmap/estimators/covariance.h"
 
 #include "colmap/estimators/manifold.h"
+#include "colmap/util/threading.h"
 
+#include <algorithm>
 #include <unordered_set>
 
 #include <ceres/crs_matrix.h>
@@ -38,11 +40,14 @@
 namespace colmap {
 namespace {
 
+constexpr size_t kPointsChunkSize = 4096;
+
 bool ComputeSchurComplement(
     bool estimate_point_covs,
     bool estimate_pose_covs,
     bool estimate_other_covs,
     double damping,
+    int num_threads,
     int point_num_params,
     const std::vector<internal::PointParam>& points,
     const std::vector<internal::PoseParam>& poses,
@@ -106,35 +111,51 @@ bool ComputeSchurComplement(
   const Eigen::SparseMatrix<double> H_aa = J_a.transpose() * J_a;
   const Eigen::SparseMatrix<double> H_ap = J_a.transpose() * J_p;
   const Eigen::SparseMatrix<double> H_pa = H_ap.transpose();
-  Eigen::SparseMatrix<double> H_pp = J_p.transpose() * J_p;
-  // In-place computation of H_pp_inv.
-  Eigen::SparseMatrix<double>& H_pp_inv = H_pp;
-  int point_param_idx = 0;
-  for (const internal::PointParam& point : points) {
-    const int tangent_size = ParameterBlockTangentSize(problem, point.xyz);
-    const Eigen::MatrixXd H_pp_idx =
-        H_pp.block(
-            point_param_idx, point_param_idx, tangent_size, tangent_size) +
-        damping * Eigen::MatrixXd::Identity(tangent_size, tangent_size);
-    const Eigen::MatrixXd H_pp_idx_inv = H_pp_idx.inverse();
-    for (int i = 0; i < tangent_size; ++i) {
-      for (int j = 0; j < tangent_size; ++j) {
-        H_pp_inv.coeffRef(point_param_idx + i, point_param_idx + j) =
-            H_pp_idx_inv(i, j);
+  const Eigen::SparseMatrix<double> H_pp = J_p.transpose() * J_p;
+
+  // The point blocks of H_pp are independent and inverted in parallel.
+  std::vector<Eigen::MatrixXd> H_pp_inv_blocks(points.size());
+  ParallelFor(points.size(),
+              kPointsChunkSize,
+              num_threads,
+              [&](const size_t point_idx) {
+                const int point_param_idx = 3 * point_idx;
+                const int tangent_size =
+                    ParameterBlockTangentSize(problem, points[point_idx].xyz);
+                const Eigen::MatrixXd H_pp_idx =
+                    H_pp.block(point_param_idx,
+                               point_param_idx,
+                               tangent_size,
+                               tangent_size) +
+                    damping *
+                        Eigen::MatrixXd::Identity(tangent_size, tangent_size);
+                H_pp_inv_blocks[point_idx] = H_pp_idx.inverse();
+              });
+
+  std::vector<Eigen::Triplet<double>> H_pp_inv_triplets;
+  H_pp_inv_triplets.reserve(9 * points.size());
+  for (size_t point_idx = 0; point_idx < points.size(); ++point_idx) {
+    const int point_param_idx = 3 * point_idx;
+    Eigen::MatrixXd& H_pp_idx_inv = H_pp_inv_blocks[point_idx];
+    for (int i = 0; i < H_pp_idx_inv.rows(); ++i) {
+      for (int j = 0; j < H_pp_idx_inv.cols(); ++j) {
+        H_pp_inv_triplets.emplace_back(
+            point_param_idx + i, point_param_idx + j, H_pp_idx_inv(i, j));
       }
     }
     if (estimate_point_covs) {
       // Point covariance conditioned on fixed pose/other parameters.
-      point_covs.emplace(point.point3D_id, H_pp_idx_inv);
+      point_covs.emplace(points[point_idx].point3D_id,
+                         std::move(H_pp_idx_inv));
     }
-    point_param_idx += 3;
   }
 
   if (!estimate_pose_covs && !estimate_other_covs) {
     return true;
   }
 
-  H_pp_inv.makeCompressed();
+  Eigen::SparseMatrix<double> H_pp_inv(H_pp.rows(), H_pp.cols());
+  H_pp_inv.setFromTriplets(H_pp_inv_triplets.begin(), H_pp_inv_triplets.end());
   S = H_aa - H_ap * H_pp_inv * H_pa;
 
   return true;
@@ -175,6 +196,21 @@ bool SchurEliminateOtherParams(double damping,
   return true;
 }
 
+bool CheckFullRank(const Eigen::VectorXd& D_dense) {
+  const int rank = (D_dense.array().abs() > 1e-6).count();
+  if (rank < D_dense.size()) {
+    LOG(WARNING) << StringPrintf(
+        "Unable to compute covariance. The Schur complement on pose/other "
+        "parameters is rank deficient. Number of columns: %d, rank: %d. This "
+        "is likely due to the pose/other parameters being underconstrained "
+        "with Gauge ambiguity or other degeneracies.",
+        D_dense.size(),
+        rank);
+    return false;
+  }
+  return true;
+}
+
 bool ComputeLInverse(Eigen::SparseMatrix<double>& S, Eigen::MatrixXd& L_inv) {
   VLOG(2) << "Start sparse Cholesky decomposition (n = " << S.rows() << ")";
   Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> ldlt_S(S);
@@ -184,16 +220,7 @@ bool ComputeLInverse(Eigen::SparseMatrix<double>& S, Eigen::MatrixXd& L_inv) {
   }
 
   const Eigen::VectorXd D_dense = ldlt_S.vectorD();
-
-  const int rank = (D_dense.array().abs() > 1e-6).count();
-  if (rank < S.rows()) {
-    LOG(WARNING) << StringPrintf(
-        "Unable to compute covariance. The Schur complement on pose/other "
-        "parameters is rank deficient. Number of columns: %d, rank: %d. This "
-        "is likely due to the pose/other parameters being underconstrained "
-        "with Gauge ambiguity or other degeneracies.",
-        S.rows(),
-        rank);
+  if (!CheckFullRank(D_dense)) {
     return false;
   }
   VLOG(2) << "Finish sparse Cholesky decomposition.";
@@ -210,6 +237,123 @@ bool ComputeLInverse(Eigen::SparseMatrix<double>& S, Eigen::MatrixXd& L_inv) {
   return true;
 }
 
+// Computes the entries of S^-1 on the sparsity pattern of the Cholesky factor
+// of S using the Takahashi recursions. Given the factorization P S P^T = L D
+// L^T with unit lower triangular L, the entries of Z = (P S P^T)^-1 satisfy
+//
+//    Z_ij = -sum_{k > j} L_kj Z_ik                 for i > j,
+//    Z_jj = 1 / D_j - sum_{k > j} L_kj Z_kj,
+//
+// where the sums only run over the non-zeros of column j of L. Processing the
+// columns from last to first, all required entries of Z are on the sparsity
+// pattern of L and have already been computed. The given blocks on the
+// diagonal of S are made structurally dense before the factorization, such
+// that their covariances are always part of the result.
+bool ComputeSelectedInverse(
+    const std::vector<std::pair<int, int>>& block_start_sizes,
+    Eigen::SparseMatrix<double>& S,
+    Eigen::SparseMatrix<double>& S_inv) {
+  std::vector<Eigen::Triplet<double>> block_triplets;
+  for (const auto& [start, size] : block_start_sizes) {
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        block_triplets.emplace_back(start + i, start + j, 0.0);
+      }
+    }
+  }
+  Eigen::SparseMatrix<double> block_pattern(S.rows(), S.cols());
+  block_pattern.setFromTriplets(block_triplets.begin(), block_triplets.end());
+  S = S + block_pattern;
+
+  VLOG(2) << "Start sparse Cholesky decomposition (n = " << S.rows() << ")";
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> ldlt_S(S);
+  if (ldlt_S.info() != Eigen::Success) {
+    LOG(WARNING) << "Simplicial LDLT for computing the selected inverse failed";
+    return false;
+  }
+
+  const Eigen::VectorXd D_dense = ldlt_S.vectorD();
+  if (!CheckFullRank(D_dense)) {
+    return false;
+  }
+  VLOG(2) << "Finish sparse Cholesky decomposition.";
+
+  // Strictly lower triangular part of L in compressed column storage.
+  const int n = S.rows();
+  const Eigen::SparseMatrix<double> L_full = ldlt_S.matrixL();
+  std::vector<int> L_col_begs(n + 1, 0);
+  std::vector<int> L_rows;
+  std::vector<double> L_values;
+  L_rows.reserve(L_full.nonZeros());
+  L_values.reserve(L_full.nonZeros());
+  for (int j = 0; j < n; ++j) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(L_full, j); it; ++it) {
+      if (it.row() > j) {
+        L_rows.push_back(it.row());
+        L_values.push_back(it.value());
+      }
+    }
+    L_col_begs[j + 1] = L_rows.size();
+  }
+
+  // Entries of Z on the pattern of L, where the lower triangular entry Z_ij
+  // with i > j is stored at the position of L_ij.
+  std::vector<double> Z_values(L_rows.size());
+  Eigen::VectorXd Z_diag(n);
+  auto Z = [&](const int i, const int j) {
+    if (i == j) {
+      return Z_diag(i);
+    }
+    const int row = std::max(i, j);
+    const int col = std::min(i, j);
+    const auto beg = L_rows.begin() + L_col_begs[col];
+    const auto end = L_rows.begin() + L_col_begs[col + 1];
+    const auto it = std::lower_bound(beg, end, row);
+    THROW_CHECK(it != end && *it == row);
+    return Z_values[it - L_rows.begin()];
+  };
+
+  for (int j = n - 1; j >= 0; --j) {
+    const int beg = L_col_begs[j];
+    const int end = L_col_begs[j + 1];
+    for (int idx_i = beg; idx_i < end; ++idx_i) {
+      double Z_ij = 0;
+      for (int idx_k = beg; idx_k < end; ++idx_k) {
+        Z_ij -= L_values[idx_k] * Z(L_rows[idx_i], L_rows[idx_k]);
+      }
+      Z_values[idx_i] = Z_ij;
+    }
+    double Z_jj = 1.0 / D_dense(j);
+    for (int idx_k = beg; idx_k < end; ++idx_k) {
+      Z_jj -= L_values[idx_k] * Z_values[idx_k];
+    }
+    Z_diag(j) = Z_jj;
+  }
+
+  // Undo the fill-reducing permutation, i.e., S^-1_ab = Z_{P(a),P(b)}.
+  const Eigen::VectorXi& perm = ldlt_S.permutationP().indices();
+  Eigen::VectorXi perm_inv(n);
+  for (int i = 0; i < n; ++i) {
+    perm_inv(perm(i)) = i;
+  }
+
+  std::vector<Eigen::Triplet<double>> S_inv_triplets;
+  S_inv_triplets.reserve(n + 2 * Z_values.size());
+  for (int j = 0; j < n; ++j) {
+    S_inv_triplets.emplace_back(perm_inv(j), perm_inv(j), Z_diag(j));
+    for (int idx = L_col_begs[j]; idx < L_col_begs[j + 1]; ++idx) {
+      const int a = perm_inv(L_rows[idx]);
+      const int b = perm_inv(j);
+      S_inv_triplets.emplace_back(a, b, Z_values[idx]);
+      S_inv_triplets.emplace_back(b, a, Z_values[idx]);
+    }
+  }
+  S_inv.resize(n, n);
+  S_inv.setFromTriplets(S_inv_triplets.begin(), S_inv_triplets.end());
+  VLOG(2) << "Finish selected inversion.";
+  return true;
+}
+
 Eigen::MatrixXd ExtractCovFromLInverse(const Eigen::MatrixXd& L_inv,
                                        int row_start,
                                        int col_start,
@@ -219,6 +363,35 @@ Eigen::MatrixXd ExtractCovFromLInverse(const Eigen::MatrixXd& L_inv,
          L_inv.block(0, col_start, L_inv.cols(), col_block_size);
 }
 
+// Returns null if any of the entries is not part of the selected inverse.
+std::optional<Eigen::MatrixXd> ExtractCovFromSelectedInverse(
+    const Eigen::SparseMatrix<double>& selected_cov,
+    int row_start,
+    int col_start,
+    int row_block_size,
+    int col_block_size) {
+  Eigen::MatrixXd cov(row_block_size, col_block_size);
+  for (int c = 0; c < col_block_size; ++c) {
+    const int col = col_start + c;
+    const int* rows_beg =
+        selected_cov.innerIndexPtr() + selected_cov.outerIndexPtr()[col];
+    const int* rows_end =
+        selected_cov.innerIndexPtr() + selected_cov.outerIndexPtr()[col + 1];
+    const int* rows_it = std::lower_bound(rows_beg, rows_end, row_start);
+    if (rows_end - rows_it < row_block_size) {
+      return std::nullopt;
+    }
+    for (int r = 0; r < row_block_size; ++r, ++rows_it) {
+      if (*rows_it != row_start + r) {
+        return std::nullopt;
+      }
+      cov(r, c) =
+          selected_cov.valuePtr()[rows_it - selected_cov.innerIndexPtr()];
+    }
+  }
+  return cov;
+}
+
 }  // namespace
 
 BACovariance::BACovariance(
@@ -231,6 +404,29 @@ BACovariance::BACovariance(
       other_L_start_size_(std::move(other_L_start_size)),
       L_inv_(std::move(L_inv)) {}
 
+BACovariance::BACovariance(
+    std::unordered_map<point3D_t, Eigen::MatrixXd> point_covs,
+    std::unordered_map<image_t, std::pair<int, int>> pose_L_start_size,
+    std::unordered_map<const double*, std::pair<int, int>> other_L_start_size,
+    Eigen::SparseMatrix<double> selected_cov)
+    : point_covs_(std::move(point_covs)),
+      pose_L_start_size_(std::move(pose_L_start_size)),
+      other_L_start_size_(std::move(other_L_start_size)),
+      selected_cov_(std::move(selected_cov)) {}
+
+std::optional<Eigen::MatrixXd> BACovariance::ExtractCov(
+    int row_start,
+    int col_start,
+    int row_block_size,
+    int col_block_size) const {
+  if (selected_cov_.size() > 0) {
+    return ExtractCovFromSelectedInverse(
+        selected_cov_, row_start, col_start, row_block_size, col_block_size);
+  }
+  return ExtractCovFromLInverse(
+      L_inv_, row_start, col_start, row_block_size, col_block_size);
+}
+
 std::optional<Eigen::MatrixXd> BACovariance::GetPointCov(
     point3D_t point3D_id) const {
   const auto it = point_covs_.find(point3D_id);
@@ -247,7 +443,7 @@ std::optional<Eigen::MatrixXd> BACovariance::GetCamCovFromWorld(
     return std::nullopt;
   }
   const auto [start, size] = it->second;
-  return ExtractCovFromLInverse(L_inv_, start, start, size, size);
+  return ExtractCov(start, start, size, size);
 }
 
 std::optional<Eigen::MatrixXd> BACovariance::GetCamCrossCovFromWorld(
@@ -259,7 +455,7 @@ std::optional<Eigen::MatrixXd> BACovariance::GetCamCrossCovFromWorld(
   }
   const auto [start1, size1] = it1->second;
   const auto [start2, size2] = it2->second;
-  return ExtractCovFromLInverse(L_inv_, start1, start2, size1, size2);
+  return ExtractCov(start1, start2, size1, size2);
 }
 
 std::optional<Eigen::MatrixXd> BACovariance::GetCam2CovFromCam1(
@@ -282,7 +478,12 @@ std::optional<Eigen::MatrixXd> BACovariance::GetCam2CovFromCam1(
     return std::nullopt;
   }
   auto cov_12 = GetCamCrossCovFromWorld(image_id1, image_id2);
-  THROW_CHECK(cov_12.has_value());
+  if (!cov_12.has_value()) {
+    LOG(WARNING) << "Cross-covariance between cam1_from_world and "
+                    "cam2_from_world is not available. This is likely due to "
+                    "the covariance being estimated with selected inversion.";
+    return std::nullopt;
+  }
   Eigen::Matrix<double, 12, 12> cov;
   cov.block<6, 6>(0, 0) = *cov_11;
   cov.block<6, 6>(6, 6) = *cov_22;
@@ -298,7 +499,7 @@ std::optional<Eigen::MatrixXd> BACovariance::GetOtherParamsCov(
     return std::nullopt;
   }
   const auto [start, size] = it->second;
-  return ExtractCovFromLInverse(L_inv_, start, start, size, size);
+  return ExtractCov(start, start, size, size);
 }
 
 std::optional<BACovariance> EstimateBACovariance(
@@ -372,6 +573,7 @@ std::optional<BACovariance> EstimateBACovarianceFromProblem(
                               estimate_pose_covs,
                               estimate_other_covs,
                               options.damping,
+                              options.num_threads,
                               point_num_params,
                               points,
                               poses,
@@ -396,6 +598,32 @@ std::optional<BACovariance> EstimateBACovarianceFromProblem(
     }
   }
 
+  if (options.use_selected_inversion) {
+    VLOG(2) << "Computing selected inverse";
+
+    std::vector<std::pair<int, int>> block_start_sizes;
+    block_start_sizes.reserve(pose_L_start_size.size() +
+                              other_L_start_size.size());
+    for (const auto& [_, start_size] : pose_L_start_size) {
+      block_start_sizes.push_back(start_size);
+    }
+    if (estimate_other_covs) {
+      for (const auto& [_, start_size] : other_L_start_size) {
+        block_start_sizes.push_back(start_size);
+      }
+    }
+
+    Eigen::SparseMatrix<double> selected_cov;
+    if (!ComputeSelectedInverse(block_start_sizes, S, selected_cov)) {
+      return std::nullopt;
+    }
+
+    return BACovariance(std::move(point_covs),
+                        std::move(pose_L_start_size),
+                        std::move(other_L_start_size),
+                        std::move(selected_cov));
+  }
+
   VLOG(2) << "Computing L inverse";
 
   Eigen::MatrixXd L_inv;
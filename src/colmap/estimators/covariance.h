@@ -54,6 +54,14 @@ struct BACovariance {
       std::unordered_map<const double*, std::pair<int, int>> other_L_start_size,
       Eigen::MatrixXd L_inv);
 
+  // Covariance from selected inversion, which only contains the entries on the
+  // sparsity pattern of the Cholesky factor of the Schur complement.
+  explicit BACovariance(
+      std::unordered_map<point3D_t, Eigen::MatrixXd> point_covs,
+      std::unordered_map<image_t, std::pair<int, int>> pose_L_start_size,
+      std::unordered_map<const double*, std::pair<int, int>> other_L_start_size,
+      Eigen::SparseMatrix<double> selected_cov);
+
   // Covariance for 3D points, conditioned on all other variables set constant.
   // If some dimensions are kept constant, the respective rows/columns are
   // omitted. Returns null if 3D point not a variable in the problem.
@@ -63,13 +71,16 @@ struct BACovariance {
   // dimensions are kept constant, the respective rows/columns are omitted.
   // Returns null if image is not a variable in the problem.
   std::optional<Eigen::MatrixXd> GetCamCovFromWorld(image_t image_id) const;
+  // Cross-covariance between two poses. With selected inversion, this returns
+  // null for pairs of images that are not connected in the Cholesky factor,
+  // which is always the case for images without shared 3D points.
   std::optional<Eigen::MatrixXd> GetCamCrossCovFromWorld(
       image_t image_id1, image_t image_id2) const;
   // Get relative pose covariance in the order [rotation, translation]. This
   // function returns null if some dimensions are kept constant for either of
-  // the two poses. This does not mean that one cannot get relative pose
-  // covariance for such case, but requires custom logic to fill in zero block
-  // in the covariance matrix.
+  // the two poses or if the cross-covariance is not available. This does not
+  // mean that one cannot get relative pose covariance for such case, but
+  // requires custom logic to fill in zero block in the covariance matrix.
   std::optional<Eigen::MatrixXd> GetCam2CovFromCam1(
       image_t image_id1,
       const Rigid3d& cam1_from_world,
@@ -83,11 +94,17 @@ struct BACovariance {
   std::optional<Eigen::MatrixXd> GetOtherParamsCov(const double* params) const;
 
  private:
+  std::optional<Eigen::MatrixXd> ExtractCov(int row_start,
+                                            int col_start,
+                                            int row_block_size,
+                                            int col_block_size) const;
+
   const std::unordered_map<point3D_t, Eigen::MatrixXd> point_covs_;
   const std::unordered_map<image_t, std::pair<int, int>> pose_L_start_size_;
   const std::unordered_map<const double*, std::pair<int, int>>
       other_L_start_size_;
   const Eigen::MatrixXd L_inv_;
+  const Eigen::SparseMatrix<double> selected_cov_;
 };
 
 struct BACovarianceOptions {
@@ -105,6 +122,18 @@ struct BACovarianceOptions {
   // Enables to robustly deal with poorly conditioned parameters.
   double damping = 1e-8;
 
+  // Whether to only compute the pose/other covariances on the sparsity
+  // pattern of the Cholesky factor of the Schur complement using selected
+  // inversion (Takahashi recursions) instead of densely inverting the factor.
+  // This scales to large problems, since the memory grows with the number of
+  // non-zeros in the factor instead of quadratically with the number of
+  // parameters. The covariance of every individual pose/other parameter block
+  // is always available but cross-covariances only for connected poses.
+  bool use_selected_inversion = false;
+
+  // The number of threads used for the Schur elimination of the points.
+  int num_threads = -1;
+
   // WARNING: This option will be removed in a future release, use at your own
   // risk. For custom bundle adjustment problems, this enables to specify a
   // custom set of pose parameter blocks to consider. Note that these pose
@@ -343,6 +343,21 @@ INSTANTIATE_TEST_SUITE_P(
           options.params = BACovarianceOptions::Params::POSES_AND_POINTS;
           BACovarianceTestOptions test_options;
           return std::make_pair(options, test_options);
+        }(),
+        []() {
+          BACovarianceOptions options;
+          options.params = BACovarianceOptions::Params::ALL;
+          options.use_selected_inversion = true;
+          BACovarianceTestOptions test_options;
+          return std::make_pair(options, test_options);
+        }(),
+        []() {
+          BACovarianceOptions options;
+          options.params = BACovarianceOptions::Params::POSES;
+          options.use_selected_inversion = true;
+          BACovarianceTestOptions test_options;
+          test_options.fixed_cam_intrinsics = true;
+          return std::make_pair(options, test_options);
         }()));
 
 }  // namespace
@@ -35,6 +35,9 @@
 #include "colmap/util/eigen_alignment.h"
 #include "colmap/util/logging.h"
 
+#include <algorithm>
+#include <array>
+
 #include <Eigen/Geometry>
 #include <Eigen/LU>
 #include <Eigen/SVD>
@@ -51,21 +54,27 @@ void EssentialMatrixFivePointEstimator::Estimate(
 
   models->clear();
 
-  // Setup system of equations: [cam_rays2(i,:), 1]' * E * [cam_rays1(i,:), 1]'.
-
-  Eigen::Matrix<double, Eigen::Dynamic, 9> Q(cam_rays1.size(), 9);
-  for (size_t i = 0; i < cam_rays1.size(); ++i) {
-    Q.row(i) << cam_rays2[i].x() * cam_rays1[i].transpose(),
-        cam_rays2[i].y() * cam_rays1[i].transpose(),
-        cam_rays2[i].z() * cam_rays1[i].transpose();
-  }
-
-  // Step 1: Extraction of the nullspace.
+  // Step 1: Extraction of the nullspace of the system of equations:
+  // [cam_rays2(i,:), 1]' * E * [cam_rays1(i,:), 1]'.
 
   Eigen::Matrix<double, 9, 4> E;
   if (cam_rays1.size() == 5) {
-    E = Q.transpose().fullPivHouseholderQr().matrixQ().rightCols<4>();
+    // Fixed-size path for the minimal problem without memory allocations.
+    Eigen::Matrix<double, 9, 5> Qt;
+    for (int i = 0; i < 5; ++i) {
+      Qt.col(i) << cam_rays2[i].x() * cam_rays1[i],
+          cam_rays2[i].y() * cam_rays1[i], cam_rays2[i].z() * cam_rays1[i];
+    }
+    const Eigen::Matrix<double, 9, 9> Q =
+        Eigen::FullPivHouseholderQR<Eigen::Matrix<double, 9, 5>>(Qt).matrixQ();
+    E = Q.rightCols<4>();
   } else {
+    Eigen::Matrix<double, Eigen::Dynamic, 9> Q(cam_rays1.size(), 9);
+    for (size_t i = 0; i < cam_rays1.size(); ++i) {
+      Q.row(i) << cam_rays2[i].x() * cam_rays1[i].transpose(),
+          cam_rays2[i].y() * cam_rays1[i].transpose(),
+          cam_rays2[i].z() * cam_rays1[i].transpose();
+    }
     const Eigen::JacobiSVD<Eigen::Matrix<double, Eigen::Dynamic, 9>> svd(
         Q, Eigen::ComputeFullV);
     E = svd.matrixV().rightCols<4>();
@@ -94,26 +103,17 @@ void EssentialMatrixFivePointEstimator::Estimate(
     B.block<4, 1>(8, i) -= AA.block<1, 4>(i * 2 + 5, 6);
   }
 
-  // Step 5: Extraction of roots from the degree 10 polynomial.
+  // Step 5: Extraction of the real roots from the degree 10 polynomial.
   Eigen::Matrix<double, 11, 1> coeffs;
 #include "colmap/estimators/essential_matrix_coeffs.h"
 
-  Eigen::VectorXd roots_real;
-  Eigen::VectorXd roots_imag;
-  if (!FindPolynomialRootsCompanionMatrix(coeffs, &roots_real, &roots_imag)) {
-    return;
-  }
+  Eigen::Matrix<double, 10, 1> roots;
+  const int num_roots = FindRealPolynomialRootsSturm<10>(coeffs, &roots);
 
-  const int num_roots = roots_real.size();
   models->reserve(num_roots);
 
   for (int i = 0; i < num_roots; ++i) {
-    const double kMaxRootImag = 1e-10;
-    if (std::abs(roots_imag(i)) > kMaxRootImag) {
-      continue;
-    }
-
-    const double z1 = roots_real(i);
+    const double z1 = roots(i);
     const double z2 = z1 * z1;
     const double z3 = z2 * z1;
     const double z4 = z3 * z1;
@@ -126,11 +126,22 @@ void EssentialMatrixFivePointEstimator::Estimate(
                  B(12, j);
     }
 
-    const Eigen::JacobiSVD<Eigen::Matrix3d> svd(Bz, Eigen::ComputeFullV);
-    const Eigen::Vector3d X = svd.matrixV().rightCols<1>();
+    // The null vector of the rank-deficient Bz is orthogonal to its rows and
+    // is thus obtained as the most stable cross product of two of its rows.
+    const std::array<Eigen::Vector3d, 3> row_crosses = {
+        Bz.row(0).transpose().cross(Bz.row(1).transpose()),
+        Bz.row(0).transpose().cross(Bz.row(2).transpose()),
+        Bz.row(1).transpose().cross(Bz.row(2).transpose())};
+    Eigen::Vector3d X = *std::max_element(
+        row_crosses.begin(),
+        row_crosses.end(),
+        [](const Eigen::Vector3d& X1, const Eigen::Vector3d& X2) {
+          return X1.squaredNorm() < X2.squaredNorm();
+        });
+    X.normalize();
 
     const double kMaxX3 = 1e-10;
-    if (std::abs(X(2)) < kMaxX3) {
+    if (!(std::abs(X(2)) >= kMaxX3)) {
       continue;
     }
 
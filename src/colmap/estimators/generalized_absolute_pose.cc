@@ -84,25 +84,116 @@ void GP3PEstimator::Residuals(const std::vector<X_t>& points2D,
   THROW_CHECK_EQ(points2D.size(), points3D.size());
   residuals->resize(points2D.size(), 0);
   for (size_t i = 0; i < points2D.size(); ++i) {
-    const Eigen::Vector3d point3D_in_cam =
-        points2D[i].cam_from_rig * (rig_from_world * points3D[i]);
-    // Check if 3D point is in front of camera.
-    if (point3D_in_cam.z() > std::numeric_limits<double>::epsilon()) {
-      if (residual_type_ == ResidualType::CosineDistance) {
-        const double cosine_dist =
-            1 - point3D_in_cam.normalized().dot(points2D[i].ray_in_cam);
-        (*residuals)[i] = cosine_dist * cosine_dist;
-      } else if (residual_type_ == ResidualType::ReprojectionError) {
-        (*residuals)[i] = (point3D_in_cam.hnormalized() -
-                           points2D[i].ray_in_cam.hnormalized())
-                              .squaredNorm();
-      } else {
-        LOG(FATAL_THROW) << "Invalid residual type";
+    (*residuals)[i] = Residual(
+        points2D[i], points2D[i].cam_from_rig * (rig_from_world * points3D[i]));
+  }
+}
+
+void GP3PEstimator::BatchedResiduals(
+    const std::vector<X_t>& points2D,
+    const std::vector<Y_t>& points3D,
+    const std::vector<M_t>& rigs_from_world,
+    const double max_residual,
+    const size_t min_num_inliers,
+    std::vector<std::vector<double>>* residuals) const {
+  const size_t num_points = points2D.size();
+  THROW_CHECK_EQ(num_points, points3D.size());
+  THROW_CHECK_NOTNULL(residuals);
+
+  const size_t num_models = rigs_from_world.size();
+  residuals->resize(num_models);
+  std::vector<Eigen::Matrix3x4d> rig_from_world_matrices(num_models);
+  for (size_t model_idx = 0; model_idx < num_models; ++model_idx) {
+    (*residuals)[model_idx].resize(num_points);
+    rig_from_world_matrices[model_idx] = rigs_from_world[model_idx].ToMatrix();
+  }
+
+  std::vector<size_t> num_inliers(num_models, 0);
+  std::vector<char> is_active(num_models, true);
+  size_t num_active_models = num_models;
+
+  // The camera poses of a block are shared by all rig poses. Consecutive
+  // correspondences mostly stem from the same camera of the rig, so each
+  // distinct camera pose in a block is composed with the rig pose only once
+  // and the points are then transformed by a single 3x4 matrix.
+  constexpr int kBlockSize = 64;
+  std::array<Eigen::Matrix3x4d, kBlockSize> block_cams_from_rig;
+  std::array<Eigen::Matrix3x4d, kBlockSize> block_cams_from_world;
+  std::array<size_t, kBlockSize> block_cam_idxs;
+
+  for (size_t block_beg = 0; block_beg < num_points && num_active_models > 0;
+       block_beg += kBlockSize) {
+    const size_t block_end = std::min(block_beg + kBlockSize, num_points);
+    const size_t block_size = block_end - block_beg;
+    size_t num_block_cams = 0;
+    for (size_t i = 0; i < block_size; ++i) {
+      const Rigid3d& cam_from_rig = points2D[block_beg + i].cam_from_rig;
+      if (i == 0 ||
+          cam_from_rig.rotation.coeffs() !=
+              points2D[block_beg + i - 1].cam_from_rig.rotation.coeffs() ||
+          cam_from_rig.translation !=
+              points2D[block_beg + i - 1].cam_from_rig.translation) {
+        block_cams_from_rig[num_block_cams++] = cam_from_rig.ToMatrix();
+      }
+      block_cam_idxs[i] = num_block_cams - 1;
+    }
+
+    for (size_t model_idx = 0; model_idx < num_models; ++model_idx) {
+      if (!is_active[model_idx]) {
+        continue;
+      }
+
+      const Eigen::Matrix3x4d& rig_from_world =
+          rig_from_world_matrices[model_idx];
+      for (size_t cam_idx = 0; cam_idx < num_block_cams; ++cam_idx) {
+        const Eigen::Matrix3x4d& cam_from_rig = block_cams_from_rig[cam_idx];
+        Eigen::Matrix3x4d& cam_from_world = block_cams_from_world[cam_idx];
+        cam_from_world.noalias() = cam_from_rig.leftCols<3>() * rig_from_world;
+        cam_from_world.col(3) += cam_from_rig.col(3);
+      }
+
+      std::vector<double>& model_residuals = (*residuals)[model_idx];
+      for (size_t i = 0; i < block_size; ++i) {
+        const size_t point_idx = block_beg + i;
+        const Eigen::Vector3d point3D_in_cam =
+            block_cams_from_world[block_cam_idxs[i]] *
+            points3D[point_idx].homogeneous();
+        const double residual = Residual(points2D[point_idx], point3D_in_cam);
+        model_residuals[point_idx] = residual;
+        if (residual <= max_residual) {
+          num_inliers[model_idx] += 1;
+        }
+      }
+
+      // Reject the model, if the remaining points cannot provide enough
+      // inliers anymore.
+      if (num_inliers[model_idx] + (num_points - block_end) <
+          min_num_inliers) {
+        model_residuals.clear();
+        is_active[model_idx] = false;
+        num_active_models -= 1;
       }
-    } else {
-      (*residuals)[i] = std::numeric_limits<double>::max();
     }
   }
 }
 
+double GP3PEstimator::Residual(const X_t& point2D,
+                               const Eigen::Vector3d& point3D_in_cam) const {
+  // Check if 3D point is in front of camera.
+  if (point3D_in_cam.z() <= std::numeric_limits<double>::epsilon()) {
+    return std::numeric_limits<double>::max();
+  }
+  if (residual_type_ == ResidualType::CosineDistance) {
+    const double cosine_dist =
+        1 - point3D_in_cam.normalized().dot(point2D.ray_in_cam);
+    return cosine_dist * cosine_dist;
+  } else if (residual_type_ == ResidualType::ReprojectionError) {
+    return (point3D_in_cam.hnormalized() - point2D.ray_in_cam.hnormalized())
+        .squaredNorm();
+  } else {
+    LOG(FATAL_THROW) << "Invalid residual type";
+  }
+  return std::numeric_limits<double>::max();
+}
+
 }  // namespace colmap
@@ -82,7 +82,21 @@ class GP3PEstimator {
                  const M_t& rig_from_world,
                  std::vector<double>* residuals) const;
 
+  // Calculate the residuals of all rig poses estimated from a minimal sample
+  // in a single pass over the correspondences. Poses with provably fewer than
+  // `min_num_inliers` inliers are rejected early and their residuals are left
+  // empty.
+  void BatchedResiduals(const std::vector<X_t>& points2D,
+                        const std::vector<Y_t>& points3D,
+                        const std::vector<M_t>& rigs_from_world,
+                        double max_residual,
+                        size_t min_num_inliers,
+                        std::vector<std::vector<double>>* residuals) const;
+
  private:
+  double Residual(const X_t& point2D,
+                  const Eigen::Vector3d& point3D_in_cam) const;
+
   const ResidualType residual_type_;
 };
 
@@ -36,6 +36,7 @@
 #include "colmap/util/eigen_alignment.h"
 #include "colmap/util/eigen_matchers.h"
 
+#include <algorithm>
 #include <array>
 
 #include <Eigen/Core>
@@ -129,6 +130,30 @@ TEST_P(ParameterizedGP3PEstimatorTests, Nominal) {
       for (size_t i = 0; i < residuals_outlier.size(); ++i) {
         EXPECT_GT(residuals_outlier[i], 1e-2);
       }
+
+      // Test batched residuals with and without early rejection.
+      std::vector<std::vector<double>> batched_residuals;
+      ransac.estimator.BatchedResiduals(points2D,
+                                        points3D_outlier,
+                                        {report.model},
+                                        options.max_error * options.max_error,
+                                        /*min_num_inliers=*/0,
+                                        &batched_residuals);
+      ASSERT_EQ(batched_residuals.size(), 1);
+      ASSERT_EQ(batched_residuals[0].size(), points2D.size());
+      for (size_t i = 0; i < residuals_outlier.size(); ++i) {
+        EXPECT_NEAR(batched_residuals[0][i],
+                    residuals_outlier[i],
+                    1e-6 * std::max(1.0, residuals_outlier[i]));
+      }
+      ransac.estimator.BatchedResiduals(points2D,
+                                        points3D_outlier,
+                                        {report.model},
+                                        options.max_error * options.max_error,
+                                        /*min_num_inliers=*/1,
+                                        &batched_residuals);
+      ASSERT_EQ(batched_residuals.size(), 1);
+      EXPECT_TRUE(batched_residuals[0].empty());
     }
   }
 }
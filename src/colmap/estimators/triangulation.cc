@@ -37,6 +37,7 @@
 #include "colmap/scene/projection.h"
 #include "colmap/util/eigen_alignment.h"
 #include "colmap/util/logging.h"
+#include "colmap/util/threading.h"
 
 #include <Eigen/Geometry>
 
@@ -44,7 +45,9 @@ namespace colmap {
 
 TriangulationEstimator::TriangulationEstimator(double min_tri_angle,
                                                ResidualType residual_type)
-    : min_tri_angle_(min_tri_angle), residual_type_(residual_type) {
+    : min_tri_angle_(min_tri_angle),
+      max_abs_cos_tri_angle_(std::cos(min_tri_angle)),
+      residual_type_(residual_type) {
   THROW_CHECK_GE(min_tri_angle, 0);
 }
 
@@ -67,9 +70,7 @@ void TriangulationEstimator::Estimate(const std::vector<X_t>& point_data,
                          &xyz) &&
         HasPointPositiveDepth(pose_data[0].cam_from_world, xyz) &&
         HasPointPositiveDepth(pose_data[1].cam_from_world, xyz) &&
-        CalculateTriangulationAngle(pose_data[0].proj_center,
-                                    pose_data[1].proj_center,
-                                    xyz) >= min_tri_angle_) {
+        HasSufficientTriangulationAngle(pose_data, xyz)) {
       models->resize(1);
       (*models)[0] = xyz;
       return;
@@ -77,13 +78,11 @@ void TriangulationEstimator::Estimate(const std::vector<X_t>& point_data,
   } else {
     // Multi-view triangulation.
 
-    std::vector<Eigen::Matrix3x4d> cams_from_world;
-    cams_from_world.reserve(point_data.size());
-    std::vector<Eigen::Vector2d> cam_points;
-    cam_points.reserve(point_data.size());
+    std::vector<Eigen::Matrix3x4d> cams_from_world(point_data.size());
+    std::vector<Eigen::Vector2d> cam_points(point_data.size());
     for (size_t i = 0; i < point_data.size(); ++i) {
-      cams_from_world.push_back(pose_data[i].cam_from_world);
-      cam_points.push_back(point_data[i].cam_point);
+      cams_from_world[i] = pose_data[i].cam_from_world;
+      cam_points[i] = point_data[i].cam_point;
     }
 
     M_t xyz;
@@ -103,18 +102,42 @@ void TriangulationEstimator::Estimate(const std::vector<X_t>& point_data,
     }
 
     // Check for sufficient triangulation angle.
-    for (size_t i = 0; i < pose_data.size(); ++i) {
-      for (size_t j = 0; j < i; ++j) {
-        const double tri_angle = CalculateTriangulationAngle(
-            pose_data[i].proj_center, pose_data[j].proj_center, xyz);
-        if (tri_angle >= min_tri_angle_) {
-          models->resize(1);
-          (*models)[0] = xyz;
-          return;
-        }
+    if (HasSufficientTriangulationAngle(pose_data, xyz)) {
+      models->resize(1);
+      (*models)[0] = xyz;
+      return;
+    }
+  }
+}
+
+bool TriangulationEstimator::HasSufficientTriangulationAngle(
+    const std::vector<Y_t>& pose_data, const M_t& xyz) const {
+  // The minimum angle between two rays min(angle, pi - angle) is at least
+  // min_tri_angle, iff |cos(angle)| <= cos(min_tri_angle). Degenerate rays
+  // have a triangulation angle of zero, see CalculateTriangulationAngle.
+  if (min_tri_angle_ == 0) {
+    return true;
+  }
+
+  std::vector<Eigen::Vector3d> rays(pose_data.size());
+  for (size_t i = 0; i < pose_data.size(); ++i) {
+    rays[i] = xyz - pose_data[i].proj_center;
+    const double ray_norm = rays[i].norm();
+    if (ray_norm == 0) {
+      return false;
+    }
+    rays[i] /= ray_norm;
+  }
+
+  for (size_t i = 0; i < rays.size(); ++i) {
+    for (size_t j = 0; j < i; ++j) {
+      if (std::abs(rays[i].dot(rays[j])) <= max_abs_cos_tri_angle_) {
+        return true;
       }
     }
   }
+
+  return false;
 }
 
 void TriangulationEstimator::Residuals(const std::vector<X_t>& point_data,
@@ -174,13 +197,19 @@ bool EstimateTriangulation(const EstimateTriangulationOptions& options,
     pose_data[i].camera = cameras[i];
   }
 
+  RANSACOptions ransac_options = options.ransac_options;
+  if (points.size() <= static_cast<size_t>(
+                           options.max_num_exhaustive_sampling_observations)) {
+    ransac_options.min_num_trials = NChooseK(points.size(), 2);
+  }
+
   // Robustly estimate track using LORANSAC.
   LORANSAC<TriangulationEstimator,
            TriangulationEstimator,
            InlierSupportMeasurer,
            CombinationSampler>
       ransac(
-          options.ransac_options,
+          ransac_options,
           TriangulationEstimator(options.min_tri_angle, options.residual_type),
           TriangulationEstimator(options.min_tri_angle, options.residual_type));
   auto report = ransac.Estimate(point_data, pose_data);
@@ -194,4 +223,67 @@ bool EstimateTriangulation(const EstimateTriangulationOptions& options,
   return report.success;
 }
 
+void EstimateTriangulations(const EstimateTriangulationOptions& options,
+                            const std::vector<size_t>& point_offsets,
+                            const std::vector<Eigen::Vector2d>& points,
+                            const std::vector<Rigid3d>& cams_from_world,
+                            const std::vector<Camera const*>& cameras,
+                            const int num_threads,
+                            std::vector<char>* success,
+                            std::vector<char>* inlier_masks,
+                            std::vector<Eigen::Vector3d>* xyzs) {
+  THROW_CHECK_NOTNULL(success);
+  THROW_CHECK_NOTNULL(inlier_masks);
+  THROW_CHECK_NOTNULL(xyzs);
+  THROW_CHECK(!point_offsets.empty());
+  THROW_CHECK_EQ(point_offsets.back(), points.size());
+  THROW_CHECK_EQ(points.size(), cams_from_world.size());
+  THROW_CHECK_EQ(points.size(), cameras.size());
+
+  const size_t num_points = point_offsets.size() - 1;
+  success->assign(num_points, false);
+  inlier_masks->assign(points.size(), false);
+  xyzs->resize(num_points);
+
+  // Each point is an independent robust estimation problem that writes to
+  // disjoint output ranges, so the points can be processed in any order.
+  const size_t kChunkSize = 64;
+  ParallelForChunks(
+      num_points,
+      kChunkSize,
+      num_threads,
+      [&](size_t /*chunk_idx*/, size_t begin, size_t end) {
+        std::vector<Eigen::Vector2d> point_points;
+        std::vector<Rigid3d> point_cams_from_world;
+        std::vector<Camera const*> point_cameras;
+        std::vector<char> point_inlier_mask;
+        for (size_t point_idx = begin; point_idx < end; ++point_idx) {
+          const size_t obs_begin = point_offsets[point_idx];
+          const size_t obs_end = point_offsets[point_idx + 1];
+          THROW_CHECK_LE(obs_begin, obs_end);
+          if (obs_end - obs_begin < 2) {
+            continue;
+          }
+          point_points.assign(points.begin() + obs_begin,
+                              points.begin() + obs_end);
+          point_cams_from_world.assign(cams_from_world.begin() + obs_begin,
+                                       cams_from_world.begin() + obs_end);
+          point_cameras.assign(cameras.begin() + obs_begin,
+                               cameras.begin() + obs_end);
+          if (!EstimateTriangulation(options,
+                                     point_points,
+                                     point_cams_from_world,
+                                     point_cameras,
+                                     &point_inlier_mask,
+                                     &(*xyzs)[point_idx])) {
+            continue;
+          }
+          (*success)[point_idx] = true;
+          std::copy(point_inlier_mask.begin(),
+                    point_inlier_mask.end(),
+                    inlier_masks->begin() + obs_begin);
+        }
+      });
+}
+
 }  // namespace colmap
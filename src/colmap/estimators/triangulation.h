@@ -115,7 +115,14 @@ class TriangulationEstimator {
                  std::vector<double>* residuals) const;
 
  private:
+  // Whether any pair of observations has a sufficient triangulation angle.
+  bool HasSufficientTriangulationAngle(const std::vector<Y_t>& pose_data,
+                                       const M_t& xyz) const;
+
   const double min_tri_angle_;
+  // Cosine of the minimum triangulation angle to check the angle between
+  // viewing rays without evaluating the arc cosine.
+  const double max_abs_cos_tri_angle_;
   const ResidualType residual_type_;
 };
 
@@ -127,6 +134,10 @@ struct EstimateTriangulationOptions {
   TriangulationEstimator::ResidualType residual_type =
       TriangulationEstimator::ResidualType::ANGULAR_ERROR;
 
+  // Enforce exhaustive sampling of all observation pairs for points with at
+  // most this number of observations. Disabled if zero.
+  int max_num_exhaustive_sampling_observations = 0;
+
   // RANSAC options for TriangulationEstimator.
   RANSACOptions ransac_options;
 
@@ -139,6 +150,7 @@ struct EstimateTriangulationOptions {
 
   void Check() const {
     THROW_CHECK_GE(min_tri_angle, 0.0);
+    THROW_CHECK_GE(max_num_exhaustive_sampling_observations, 0);
     ransac_options.Check();
   }
 };
@@ -153,4 +165,24 @@ bool EstimateTriangulation(const EstimateTriangulationOptions& options,
                            std::vector<char>* inlier_mask,
                            Eigen::Vector3d* xyz);
 
+// Robustly estimate many independent 3D points in parallel. The observations
+// of all points are stored contiguously, where the observations of the i-th
+// point are in the range [point_offsets[i], point_offsets[i + 1]). The result
+// for each point is the same as calling EstimateTriangulation on its range.
+//
+// @param num_threads       Number of threads, see GetEffectiveNumThreads.
+// @param success           Whether the estimation succeeded for each point.
+// @param inlier_masks      Inlier mask for all observations, which is only
+//                          valid for the ranges of successful points.
+// @param xyzs              Estimated 3D point for each point.
+void EstimateTriangulations(const EstimateTriangulationOptions& options,
+                            const std::vector<size_t>& point_offsets,
+                            const std::vector<Eigen::Vector2d>& points,
+                            const std::vector<Rigid3d>& cams_from_world,
+                            const std::vector<Camera const*>& cameras,
+                            int num_threads,
+                            std::vector<char>* success,
+                            std::vector<char>* inlier_masks,
+                            std::vector<Eigen::Vector3d>* xyzs);
+
 }  // namespace colmap
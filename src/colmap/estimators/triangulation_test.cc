@@ -0,0 +1,195 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "colmap/estimators/triangulation.h"
+
+#include "colmap/math/random.h"
+#include "colmap/scene/synthetic.h"
+#include "colmap/util/eigen_matchers.h"
+
+#include <gtest/gtest.h>
+
+namespace colmap {
+namespace {
+
+struct TriangulationProblem {
+  std::vector<size_t> point_offsets = {0};
+  std::vector<Eigen::Vector2d> points;
+  std::vector<Rigid3d> cams_from_world;
+  std::vector<Camera const*> cameras;
+  std::vector<Eigen::Vector3d> xyzs;
+};
+
+TriangulationProblem CreateTriangulationTestData(
+    const Reconstruction& reconstruction) {
+  TriangulationProblem problem;
+  for (const auto& [_, point3D] : reconstruction.Points3D()) {
+    for (const auto& track_el : point3D.track.Elements()) {
+      const Image& image = reconstruction.Image(track_el.image_id);
+      problem.points.push_back(image.Point2D(track_el.point2D_idx).xy);
+      problem.cams_from_world.push_back(image.CamFromWorld());
+      problem.cameras.push_back(image.CameraPtr());
+    }
+    // Add an outlier observation to every point.
+    problem.points.push_back(problem.points.back() +
+                             Eigen::Vector2d(100, -100));
+    problem.cams_from_world.push_back(problem.cams_from_world.back());
+    problem.cameras.push_back(problem.cameras.back());
+    problem.point_offsets.push_back(problem.points.size());
+    problem.xyzs.push_back(point3D.xyz);
+  }
+  return problem;
+}
+
+TEST(EstimateTriangulation, Nominal) {
+  Reconstruction reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_frames_per_rig = 4;
+  synthetic_dataset_options.num_points3D = 20;
+  synthetic_dataset_options.point2D_stddev = 0;
+  SynthesizeDataset(synthetic_dataset_options, &reconstruction);
+  const TriangulationProblem problem =
+      CreateTriangulationTestData(reconstruction);
+
+  EstimateTriangulationOptions options;
+  options.residual_type =
+      TriangulationEstimator::ResidualType::REPROJECTION_ERROR;
+  options.ransac_options.max_error = 1;
+
+  for (size_t i = 0; i < problem.xyzs.size(); ++i) {
+    const size_t begin = problem.point_offsets[i];
+    const size_t end = problem.point_offsets[i + 1];
+    std::vector<char> inlier_mask;
+    Eigen::Vector3d xyz;
+    ASSERT_TRUE(EstimateTriangulation(
+        options,
+        {problem.points.begin() + begin, problem.points.begin() + end},
+        {problem.cams_from_world.begin() + begin,
+         problem.cams_from_world.begin() + end},
+        {problem.cameras.begin() + begin, problem.cameras.begin() + end},
+        &inlier_mask,
+        &xyz));
+    EXPECT_THAT(xyz, EigenMatrixNear(problem.xyzs[i], 1e-4));
+    EXPECT_EQ(std::count(inlier_mask.begin(), inlier_mask.end(), true),
+              end - begin - 1);
+    EXPECT_FALSE(inlier_mask.back());
+  }
+}
+
+TEST(EstimateTriangulation, MinTriAngle) {
+  Reconstruction reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_frames_per_rig = 3;
+  synthetic_dataset_options.num_points3D = 1;
+  synthetic_dataset_options.point2D_stddev = 0;
+  SynthesizeDataset(synthetic_dataset_options, &reconstruction);
+  const TriangulationProblem problem =
+      CreateTriangulationTestData(reconstruction);
+
+  EstimateTriangulationOptions options;
+  std::vector<char> inlier_mask;
+  Eigen::Vector3d xyz;
+  EXPECT_TRUE(EstimateTriangulation(options,
+                                    problem.points,
+                                    problem.cams_from_world,
+                                    problem.cameras,
+                                    &inlier_mask,
+                                    &xyz));
+  options.min_tri_angle = DegToRad(89.9);
+  EXPECT_FALSE(EstimateTriangulation(options,
+                                     problem.points,
+                                     problem.cams_from_world,
+                                     problem.cameras,
+                                     &inlier_mask,
+                                     &xyz));
+}
+
+TEST(EstimateTriangulations, MatchesEstimateTriangulation) {
+  Reconstruction reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_frames_per_rig = 5;
+  synthetic_dataset_options.num_points3D = 200;
+  synthetic_dataset_options.point2D_stddev = 0.5;
+  SynthesizeDataset(synthetic_dataset_options, &reconstruction);
+  TriangulationProblem problem = CreateTriangulationTestData(reconstruction);
+
+  // Add a point with a single observation, which cannot be triangulated.
+  problem.points.push_back(problem.points.back());
+  problem.cams_from_world.push_back(problem.cams_from_world.back());
+  problem.cameras.push_back(problem.cameras.back());
+  problem.point_offsets.push_back(problem.points.size());
+  const size_t num_points = problem.point_offsets.size() - 1;
+
+  EstimateTriangulationOptions options;
+  options.ransac_options.random_seed = 42;
+
+  for (const int num_threads : {1, 3}) {
+    std::vector<char> success;
+    std::vector<char> inlier_masks;
+    std::vector<Eigen::Vector3d> xyzs;
+    EstimateTriangulations(options,
+                           problem.point_offsets,
+                           problem.points,
+                           problem.cams_from_world,
+                           problem.cameras,
+                           num_threads,
+                           &success,
+                           &inlier_masks,
+                           &xyzs);
+    ASSERT_EQ(success.size(), num_points);
+    ASSERT_EQ(inlier_masks.size(), problem.points.size());
+    ASSERT_EQ(xyzs.size(), num_points);
+    EXPECT_FALSE(success.back());
+
+    for (size_t i = 0; i + 1 < num_points; ++i) {
+      const size_t begin = problem.point_offsets[i];
+      const size_t end = problem.point_offsets[i + 1];
+      std::vector<char> inlier_mask;
+      Eigen::Vector3d xyz;
+      const bool expected_success = EstimateTriangulation(
+          options,
+          {problem.points.begin() + begin, problem.points.begin() + end},
+          {problem.cams_from_world.begin() + begin,
+           problem.cams_from_world.begin() + end},
+          {problem.cameras.begin() + begin, problem.cameras.begin() + end},
+          &inlier_mask,
+          &xyz);
+      ASSERT_EQ(success[i], expected_success);
+      if (expected_success) {
+        EXPECT_EQ(xyzs[i], xyz);
+        EXPECT_EQ(std::vector<char>(inlier_masks.begin() + begin,
+                                    inlier_masks.begin() + end),
+                  inlier_mask);
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace colmap
@@ -40,6 +40,7 @@
 #include "colmap/math/random.h"
 #include "colmap/optim/loransac.h"
 #include "colmap/optim/ransac.h"
+#include "colmap/optim/support_measurement.h"
 #include "colmap/scene/camera.h"
 
 #include <unordered_set>
@@ -86,11 +87,215 @@ FeatureMatches ExtractOutlierMatches(const FeatureMatches& matches,
   return outlier_matches;
 }
 
+using FundamentalMatrixRANSAC = LORANSAC<FundamentalMatrixSevenPointEstimator,
+                                         FundamentalMatrixEightPointEstimator>;
+using HomographyMatrixRANSAC =
+    LORANSAC<HomographyMatrixEstimator, HomographyMatrixEstimator>;
+
+// Evaluates the support of the fundamental matrix composed from the given
+// essential matrix and the camera calibrations instead of estimating it.
+FundamentalMatrixRANSAC::Report FundamentalFromEssentialMatrixReport(
+    const Camera& camera1,
+    const std::vector<Eigen::Vector2d>& matched_img_points1,
+    const Camera& camera2,
+    const std::vector<Eigen::Vector2d>& matched_img_points2,
+    const Eigen::Matrix3d& E,
+    const RANSACOptions& ransac_options) {
+  FundamentalMatrixRANSAC::Report report;
+  report.model = FundamentalFromEssentialMatrix(
+      camera2.CalibrationMatrix(), E, camera1.CalibrationMatrix());
+
+  std::vector<double> residuals;
+  FundamentalMatrixSevenPointEstimator::Residuals(
+      matched_img_points1, matched_img_points2, report.model, &residuals);
+  const double max_residual =
+      ransac_options.max_error * ransac_options.max_error;
+  report.support = InlierSupportMeasurer().Evaluate(residuals, max_residual);
+  report.inlier_mask.resize(residuals.size());
+  for (size_t i = 0; i < residuals.size(); ++i) {
+    report.inlier_mask[i] = residuals[i] <= max_residual;
+  }
+  report.success = report.support.num_inliers > 0;
+
+  return report;
+}
+
+// Estimates the homography only on the subset of matches in the given mask.
+// The returned inlier mask refers to all matches.
+HomographyMatrixRANSAC::Report EstimateHomographyOnSubset(
+    const std::vector<Eigen::Vector2d>& matched_img_points1,
+    const std::vector<Eigen::Vector2d>& matched_img_points2,
+    const std::vector<char>& subset_mask,
+    const RANSACOptions& ransac_options) {
+  std::vector<size_t> subset_idxs;
+  subset_idxs.reserve(subset_mask.size());
+  for (size_t i = 0; i < subset_mask.size(); ++i) {
+    if (subset_mask[i]) {
+      subset_idxs.push_back(i);
+    }
+  }
+
+  std::vector<Eigen::Vector2d> subset_img_points1(subset_idxs.size());
+  std::vector<Eigen::Vector2d> subset_img_points2(subset_idxs.size());
+  for (size_t i = 0; i < subset_idxs.size(); ++i) {
+    subset_img_points1[i] = matched_img_points1[subset_idxs[i]];
+    subset_img_points2[i] = matched_img_points2[subset_idxs[i]];
+  }
+
+  HomographyMatrixRANSAC H_ransac(ransac_options);
+  HomographyMatrixRANSAC::Report report =
+      H_ransac.Estimate(subset_img_points1, subset_img_points2);
+
+  std::vector<char> inlier_mask(subset_mask.size(), false);
+  if (report.inlier_mask.size() == subset_idxs.size()) {
+    for (size_t i = 0; i < subset_idxs.size(); ++i) {
+      inlier_mask[subset_idxs[i]] = report.inlier_mask[i];
+    }
+  }
+  report.inlier_mask = std::move(inlier_mask);
+
+  return report;
+}
+
+// Returns the normalized camera ray of the given point, either from the
+// precomputed rays or by lifting the image point. Points that cannot be lifted
+// are mapped to zero rays.
+Eigen::Vector3d CamRayFromImg(const Camera& camera,
+                              const std::vector<Eigen::Vector2d>& points,
+                              const std::vector<Eigen::Vector3d>* cam_rays,
+                              const point2D_t point2D_idx) {
+  if (cam_rays != nullptr) {
+    return (*cam_rays)[point2D_idx];
+  }
+  if (const std::optional<Eigen::Vector2d> cam_point =
+          camera.CamFromImg(points[point2D_idx]);
+      cam_point) {
+    return cam_point->homogeneous().normalized();
+  }
+  return Eigen::Vector3d::Zero();
+}
+
+bool EstimateTwoViewGeometryPoseImpl(
+    const Camera& camera1,
+    const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector3d>* cam_rays1,
+    const Camera& camera2,
+    const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Vector3d>* cam_rays2,
+    TwoViewGeometry* geometry) {
+  // We need a valid epopolar geometry to estimate the relative pose.
+  if (geometry->config != TwoViewGeometry::ConfigurationType::CALIBRATED &&
+      geometry->config != TwoViewGeometry::ConfigurationType::UNCALIBRATED &&
+      geometry->config != TwoViewGeometry::ConfigurationType::PLANAR &&
+      geometry->config != TwoViewGeometry::ConfigurationType::PANORAMIC &&
+      geometry->config !=
+          TwoViewGeometry::ConfigurationType::PLANAR_OR_PANORAMIC) {
+    return false;
+  }
+
+  // Extract normalized inlier points.
+  const size_t num_inlier_matches = geometry->inlier_matches.size();
+  if (num_inlier_matches == 0) {
+    return false;
+  }
+
+  std::vector<Eigen::Vector3d> inlier_cam_rays1(num_inlier_matches);
+  std::vector<Eigen::Vector3d> inlier_cam_rays2(num_inlier_matches);
+  for (size_t i = 0; i < num_inlier_matches; ++i) {
+    const FeatureMatch& match = geometry->inlier_matches[i];
+    inlier_cam_rays1[i] =
+        CamRayFromImg(camera1, points1, cam_rays1, match.point2D_idx1);
+    inlier_cam_rays2[i] =
+        CamRayFromImg(camera2, points2, cam_rays2, match.point2D_idx2);
+  }
+
+  std::vector<Eigen::Vector3d> points3D;
+
+  if (geometry->config == TwoViewGeometry::ConfigurationType::CALIBRATED) {
+    PoseFromEssentialMatrix(geometry->E,
+                            inlier_cam_rays1,
+                            inlier_cam_rays2,
+                            &geometry->cam2_from_cam1,
+                            &points3D);
+    if (points3D.empty()) {
+      return false;
+    }
+  } else if (geometry->config ==
+             TwoViewGeometry::ConfigurationType::UNCALIBRATED) {
+    const Eigen::Matrix3d E = EssentialFromFundamentalMatrix(
+        camera2.CalibrationMatrix(), geometry->F, camera1.CalibrationMatrix());
+    PoseFromEssentialMatrix(E,
+                            inlier_cam_rays1,
+                            inlier_cam_rays2,
+                            &geometry->cam2_from_cam1,
+                            &points3D);
+    if (points3D.empty()) {
+      return false;
+    }
+  } else if (geometry->config == TwoViewGeometry::ConfigurationType::PLANAR ||
+             geometry->config ==
+                 TwoViewGeometry::ConfigurationType::PANORAMIC ||
+             geometry->config ==
+                 TwoViewGeometry::ConfigurationType::PLANAR_OR_PANORAMIC) {
+    Eigen::Vector3d normal;
+    PoseFromHomographyMatrix(geometry->H,
+                             camera1.CalibrationMatrix(),
+                             camera2.CalibrationMatrix(),
+                             inlier_cam_rays1,
+                             inlier_cam_rays2,
+                             &geometry->cam2_from_cam1,
+                             &normal,
+                             &points3D);
+    if (geometry->config ==
+        TwoViewGeometry::ConfigurationType::PLANAR_OR_PANORAMIC) {
+      if (geometry->cam2_from_cam1.translation.squaredNorm() < 1e-12) {
+        geometry->config = TwoViewGeometry::ConfigurationType::PANORAMIC;
+      } else {
+        geometry->config = TwoViewGeometry::ConfigurationType::PLANAR;
+      }
+    }
+
+    if (geometry->config == TwoViewGeometry::ConfigurationType::PANORAMIC) {
+      geometry->tri_angle = 0;
+    }
+
+    if (geometry->config == TwoViewGeometry::ConfigurationType::PLANAR &&
+        points3D.empty()) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+
+  if (!points3D.empty()) {
+    const Eigen::Vector3d proj_center1 = Eigen::Vector3d::Zero();
+    const Eigen::Vector3d proj_center2 =
+        geometry->cam2_from_cam1.rotation.inverse() *
+        -geometry->cam2_from_cam1.translation;
+    geometry->tri_angle = Median(
+        CalculateTriangulationAngles(proj_center1, proj_center2, points3D));
+  }
+
+  return true;
+}
+
+TwoViewGeometry EstimateTwoViewGeometryImpl(
+    const Camera& camera1,
+    const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector3d>* cam_rays1,
+    const Camera& camera2,
+    const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Vector3d>* cam_rays2,
+    FeatureMatches matches,
+    const TwoViewGeometryOptions& options);
+
 TwoViewGeometry EstimateCalibratedHomography(
     const Camera& camera1,
     const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector3d>* cam_rays1,
     const Camera& camera2,
     const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Vector3d>* cam_rays2,
     const FeatureMatches& matches,
     const TwoViewGeometryOptions& options) {
   TwoViewGeometry geometry;
@@ -138,7 +343,8 @@ TwoViewGeometry EstimateCalibratedHomography(
   }
 
   if (options.compute_relative_pose) {
-    EstimateTwoViewGeometryPose(camera1, points1, camera2, points2, &geometry);
+    EstimateTwoViewGeometryPoseImpl(
+        camera1, points1, cam_rays1, camera2, points2, cam_rays2, &geometry);
   }
 
   return geometry;
@@ -147,8 +353,10 @@ TwoViewGeometry EstimateCalibratedHomography(
 TwoViewGeometry EstimateUncalibratedTwoViewGeometry(
     const Camera& camera1,
     const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector3d>* cam_rays1,
     const Camera& camera2,
     const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Vector3d>* cam_rays2,
     const FeatureMatches& matches,
     const TwoViewGeometryOptions& options) {
   TwoViewGeometry geometry;
@@ -223,7 +431,8 @@ TwoViewGeometry EstimateUncalibratedTwoViewGeometry(
   }
 
   if (options.compute_relative_pose) {
-    EstimateTwoViewGeometryPose(camera1, points1, camera2, points2, &geometry);
+    EstimateTwoViewGeometryPoseImpl(
+        camera1, points1, cam_rays1, camera2, points2, cam_rays2, &geometry);
   }
 
   return geometry;
@@ -232,16 +441,24 @@ TwoViewGeometry EstimateUncalibratedTwoViewGeometry(
 TwoViewGeometry EstimateMultipleTwoViewGeometries(
     const Camera& camera1,
     const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector3d>* cam_rays1,
     const Camera& camera2,
     const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Vector3d>* cam_rays2,
     const FeatureMatches& matches,
     const TwoViewGeometryOptions& options) {
   FeatureMatches remaining_matches = matches;
   TwoViewGeometry multi_geometry;
   std::vector<TwoViewGeometry> geometries;
   while (true) {
-    TwoViewGeometry geometry = EstimateTwoViewGeometry(
-        camera1, points1, camera2, points2, remaining_matches, options);
+    TwoViewGeometry geometry = EstimateTwoViewGeometryImpl(camera1,
+                                                           points1,
+                                                           cam_rays1,
+                                                           camera2,
+                                                           points2,
+                                                           cam_rays2,
+                                                           remaining_matches,
+                                                           options);
     if (geometry.config == TwoViewGeometry::ConfigurationType::DEGENERATE) {
       break;
     }
@@ -274,175 +491,13 @@ TwoViewGeometry EstimateMultipleTwoViewGeometries(
   return multi_geometry;
 }
 
-}  // namespace
-
-bool TwoViewGeometryOptions::Check() const {
-  CHECK_OPTION_GE(min_num_inliers, 0);
-  CHECK_OPTION_GE(min_E_F_inlier_ratio, 0);
-  CHECK_OPTION_LE(min_E_F_inlier_ratio, 1);
-  CHECK_OPTION_GE(max_H_inlier_ratio, 0);
-  CHECK_OPTION_LE(max_H_inlier_ratio, 1);
-  CHECK_OPTION_GE(watermark_min_inlier_ratio, 0);
-  CHECK_OPTION_LE(watermark_min_inlier_ratio, 1);
-  CHECK_OPTION_GE(watermark_border_size, 0);
-  CHECK_OPTION_LE(watermark_border_size, 1);
-  CHECK_OPTION_GT(ransac_options.max_error, 0);
-  CHECK_OPTION_GE(ransac_options.min_inlier_ratio, 0);
-  CHECK_OPTION_LE(ransac_options.min_inlier_ratio, 1);
-  CHECK_OPTION_GE(ransac_options.confidence, 0);
-  CHECK_OPTION_LE(ransac_options.confidence, 1);
-  CHECK_OPTION_LE(ransac_options.min_num_trials, ransac_options.max_num_trials);
-  CHECK_OPTION_GE(ransac_options.random_seed, -1);
-  return true;
-}
-
-TwoViewGeometry EstimateTwoViewGeometry(
-    const Camera& camera1,
-    const std::vector<Eigen::Vector2d>& points1,
-    const Camera& camera2,
-    const std::vector<Eigen::Vector2d>& points2,
-    FeatureMatches matches,
-    const TwoViewGeometryOptions& options) {
-  if (options.filter_stationary_matches) {
-    FilterStationaryMatches(
-        options.stationary_matches_max_error, points1, points2, &matches);
-  }
-  if (options.multiple_models) {
-    TwoViewGeometryOptions multiple_model_options = options;
-    // Set to false to prevent recursive calls to this function.
-    multiple_model_options.multiple_models = false;
-    // Set to false to prevent redundant filtering of stationary matches.
-    multiple_model_options.filter_stationary_matches = false;
-    return EstimateMultipleTwoViewGeometries(
-        camera1, points1, camera2, points2, matches, multiple_model_options);
-  } else if (options.force_H_use) {
-    return EstimateCalibratedHomography(
-        camera1, points1, camera2, points2, matches, options);
-  } else if (camera1.has_prior_focal_length && camera2.has_prior_focal_length) {
-    return EstimateCalibratedTwoViewGeometry(
-        camera1, points1, camera2, points2, matches, options);
-  } else {
-    return EstimateUncalibratedTwoViewGeometry(
-        camera1, points1, camera2, points2, matches, options);
-  }
-}
-
-bool EstimateTwoViewGeometryPose(const Camera& camera1,
-                                 const std::vector<Eigen::Vector2d>& points1,
-                                 const Camera& camera2,
-                                 const std::vector<Eigen::Vector2d>& points2,
-                                 TwoViewGeometry* geometry) {
-  // We need a valid epopolar geometry to estimate the relative pose.
-  if (geometry->config != TwoViewGeometry::ConfigurationType::CALIBRATED &&
-      geometry->config != TwoViewGeometry::ConfigurationType::UNCALIBRATED &&
-      geometry->config != TwoViewGeometry::ConfigurationType::PLANAR &&
-      geometry->config != TwoViewGeometry::ConfigurationType::PANORAMIC &&
-      geometry->config !=
-          TwoViewGeometry::ConfigurationType::PLANAR_OR_PANORAMIC) {
-    return false;
-  }
-
-  // Extract normalized inlier points.
-  const size_t num_inlier_matches = geometry->inlier_matches.size();
-  if (num_inlier_matches == 0) {
-    return false;
-  }
-
-  std::vector<Eigen::Vector3d> inlier_cam_rays1(num_inlier_matches);
-  std::vector<Eigen::Vector3d> inlier_cam_rays2(num_inlier_matches);
-  for (size_t i = 0; i < num_inlier_matches; ++i) {
-    const FeatureMatch& match = geometry->inlier_matches[i];
-    if (const std::optional<Eigen::Vector2d> cam_point1 =
-            camera1.CamFromImg(points1[match.point2D_idx1]);
-        cam_point1) {
-      inlier_cam_rays1[i] = cam_point1->homogeneous().normalized();
-    } else {
-      inlier_cam_rays1[i].setZero();
-    }
-    if (const std::optional<Eigen::Vector2d> cam_point2 =
-            camera2.CamFromImg(points2[match.point2D_idx2]);
-        cam_point2) {
-      inlier_cam_rays2[i] = cam_point2->homogeneous().normalized();
-    } else {
-      inlier_cam_rays2[i].setZero();
-    }
-  }
-
-  std::vector<Eigen::Vector3d> points3D;
-
-  if (geometry->config == TwoViewGeometry::ConfigurationType::CALIBRATED) {
-    PoseFromEssentialMatrix(geometry->E,
-                            inlier_cam_rays1,
-                            inlier_cam_rays2,
-                            &geometry->cam2_from_cam1,
-                            &points3D);
-    if (points3D.empty()) {
-      return false;
-    }
-  } else if (geometry->config ==
-             TwoViewGeometry::ConfigurationType::UNCALIBRATED) {
-    const Eigen::Matrix3d E = EssentialFromFundamentalMatrix(
-        camera2.CalibrationMatrix(), geometry->F, camera1.CalibrationMatrix());
-    PoseFromEssentialMatrix(E,
-                            inlier_cam_rays1,
-                            inlier_cam_rays2,
-                            &geometry->cam2_from_cam1,
-                            &points3D);
-    if (points3D.empty()) {
-      return false;
-    }
-  } else if (geometry->config == TwoViewGeometry::ConfigurationType::PLANAR ||
-             geometry->config ==
-                 TwoViewGeometry::ConfigurationType::PANORAMIC ||
-             geometry->config ==
-                 TwoViewGeometry::ConfigurationType::PLANAR_OR_PANORAMIC) {
-    Eigen::Vector3d normal;
-    PoseFromHomographyMatrix(geometry->H,
-                             camera1.CalibrationMatrix(),
-                             camera2.CalibrationMatrix(),
-                             inlier_cam_rays1,
-                             inlier_cam_rays2,
-                             &geometry->cam2_from_cam1,
-                             &normal,
-                             &points3D);
-    if (geometry->config ==
-        TwoViewGeometry::ConfigurationType::PLANAR_OR_PANORAMIC) {
-      if (geometry->cam2_from_cam1.translation.squaredNorm() < 1e-12) {
-        geometry->config = TwoViewGeometry::ConfigurationType::PANORAMIC;
-      } else {
-        geometry->config = TwoViewGeometry::ConfigurationType::PLANAR;
-      }
-    }
-
-    if (geometry->config == TwoViewGeometry::ConfigurationType::PANORAMIC) {
-      geometry->tri_angle = 0;
-    }
-
-    if (geometry->config == TwoViewGeometry::ConfigurationType::PLANAR &&
-        points3D.empty()) {
-      return false;
-    }
-  } else {
-    return false;
-  }
-
-  if (!points3D.empty()) {
-    const Eigen::Vector3d proj_center1 = Eigen::Vector3d::Zero();
-    const Eigen::Vector3d proj_center2 =
-        geometry->cam2_from_cam1.rotation.inverse() *
-        -geometry->cam2_from_cam1.translation;
-    geometry->tri_angle = Median(
-        CalculateTriangulationAngles(proj_center1, proj_center2, points3D));
-  }
-
-  return true;
-}
-
-TwoViewGeometry EstimateCalibratedTwoViewGeometry(
+TwoViewGeometry EstimateCalibratedTwoViewGeometryImpl(
     const Camera& camera1,
     const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector3d>* cam_rays1,
     const Camera& camera2,
     const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Vector3d>* cam_rays2,
     const FeatureMatches& matches,
     const TwoViewGeometryOptions& options) {
   THROW_CHECK(options.Check());
@@ -465,20 +520,8 @@ TwoViewGeometry EstimateCalibratedTwoViewGeometry(
     const point2D_t idx2 = matches[i].point2D_idx2;
     matched_img_points1[i] = points1[idx1];
     matched_img_points2[i] = points2[idx2];
-    if (const std::optional<Eigen::Vector2d> cam_point1 =
-            camera1.CamFromImg(points1[idx1]);
-        cam_point1) {
-      matched_cam_rays1[i] = cam_point1->homogeneous().normalized();
-    } else {
-      matched_cam_rays1[i].setZero();
-    }
-    if (const std::optional<Eigen::Vector2d> cam_point2 =
-            camera2.CamFromImg(points2[idx2]);
-        cam_point2) {
-      matched_cam_rays2[i] = cam_point2->homogeneous().normalized();
-    } else {
-      matched_cam_rays2[i].setZero();
-    }
+    matched_cam_rays1[i] = CamRayFromImg(camera1, points1, cam_rays1, idx1);
+    matched_cam_rays2[i] = CamRayFromImg(camera2, points2, cam_rays2, idx2);
   }
 
   // Estimate epipolar models.
@@ -494,19 +537,42 @@ TwoViewGeometry EstimateCalibratedTwoViewGeometry(
   const auto E_report = E_ransac.Estimate(matched_cam_rays1, matched_cam_rays2);
   geometry.E = E_report.model;
 
-  LORANSAC<FundamentalMatrixSevenPointEstimator,
-           FundamentalMatrixEightPointEstimator>
-      F_ransac(options.ransac_options);
-  const auto F_report =
-      F_ransac.Estimate(matched_img_points1, matched_img_points2);
+  // In staged estimation, the calibration is trusted without estimating the
+  // fundamental matrix if the E/F inlier ratio cannot drop below the
+  // threshold, since F cannot have more inliers than there are matches.
+  const bool trust_calibration =
+      options.staged_calibrated_estimation && E_report.success &&
+      E_report.support.num_inliers >= min_num_inliers &&
+      E_report.support.num_inliers >
+          options.min_E_F_inlier_ratio * matches.size();
+
+  FundamentalMatrixRANSAC::Report F_report;
+  if (trust_calibration) {
+    F_report = FundamentalFromEssentialMatrixReport(camera1,
+                                                    matched_img_points1,
+                                                    camera2,
+                                                    matched_img_points2,
+                                                    E_report.model,
+                                                    options.ransac_options);
+  } else {
+    FundamentalMatrixRANSAC F_ransac(options.ransac_options);
+    F_report = F_ransac.Estimate(matched_img_points1, matched_img_points2);
+  }
   geometry.F = F_report.model;
 
-  // Estimate planar or panoramic model.
+  // Estimate planar or panoramic model. If the calibration is trusted, only
+  // the E inliers can decide about a planar or panoramic configuration.
 
-  LORANSAC<HomographyMatrixEstimator, HomographyMatrixEstimator> H_ransac(
-      options.ransac_options);
-  const auto H_report =
-      H_ransac.Estimate(matched_img_points1, matched_img_points2);
+  HomographyMatrixRANSAC::Report H_report;
+  if (trust_calibration) {
+    H_report = EstimateHomographyOnSubset(matched_img_points1,
+                                          matched_img_points2,
+                                          E_report.inlier_mask,
+                                          options.ransac_options);
+  } else {
+    HomographyMatrixRANSAC H_ransac(options.ransac_options);
+    H_report = H_ransac.Estimate(matched_img_points1, matched_img_points2);
+  }
   geometry.H = H_report.model;
 
   if ((!E_report.success && !F_report.success && !H_report.success) ||
@@ -595,14 +661,240 @@ TwoViewGeometry EstimateCalibratedTwoViewGeometry(
     }
 
     if (options.compute_relative_pose) {
-      EstimateTwoViewGeometryPose(
-          camera1, points1, camera2, points2, &geometry);
+      EstimateTwoViewGeometryPoseImpl(
+          camera1, points1, cam_rays1, camera2, points2, cam_rays2, &geometry);
     }
   }
 
   return geometry;
 }
 
+TwoViewGeometry EstimateTwoViewGeometryImpl(
+    const Camera& camera1,
+    const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector3d>* cam_rays1,
+    const Camera& camera2,
+    const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Vector3d>* cam_rays2,
+    FeatureMatches matches,
+    const TwoViewGeometryOptions& options) {
+  if (options.filter_stationary_matches) {
+    FilterStationaryMatches(
+        options.stationary_matches_max_error, points1, points2, &matches);
+  }
+  if (options.multiple_models) {
+    TwoViewGeometryOptions multiple_model_options = options;
+    // Set to false to prevent recursive calls to this function.
+    multiple_model_options.multiple_models = false;
+    // Set to false to prevent redundant filtering of stationary matches.
+    multiple_model_options.filter_stationary_matches = false;
+    return EstimateMultipleTwoViewGeometries(camera1,
+                                             points1,
+                                             cam_rays1,
+                                             camera2,
+                                             points2,
+                                             cam_rays2,
+                                             matches,
+                                             multiple_model_options);
+  } else if (options.force_H_use) {
+    return EstimateCalibratedHomography(camera1,
+                                        points1,
+                                        cam_rays1,
+                                        camera2,
+                                        points2,
+                                        cam_rays2,
+                                        matches,
+                                        options);
+  } else if (camera1.has_prior_focal_length && camera2.has_prior_focal_length) {
+    return EstimateCalibratedTwoViewGeometryImpl(camera1,
+                                                 points1,
+                                                 cam_rays1,
+                                                 camera2,
+                                                 points2,
+                                                 cam_rays2,
+                                                 matches,
+                                                 options);
+  } else {
+    return EstimateUncalibratedTwoViewGeometry(camera1,
+                                               points1,
+                                               cam_rays1,
+                                               camera2,
+                                               points2,
+                                               cam_rays2,
+                                               matches,
+                                               options);
+  }
+}
+
+}  // namespace
+
+bool TwoViewGeometryOptions::Check() const {
+  CHECK_OPTION_GE(min_num_inliers, 0);
+  CHECK_OPTION_GE(min_E_F_inlier_ratio, 0);
+  CHECK_OPTION_LE(min_E_F_inlier_ratio, 1);
+  CHECK_OPTION_GE(max_H_inlier_ratio, 0);
+  CHECK_OPTION_LE(max_H_inlier_ratio, 1);
+  CHECK_OPTION_GE(watermark_min_inlier_ratio, 0);
+  CHECK_OPTION_LE(watermark_min_inlier_ratio, 1);
+  CHECK_OPTION_GE(watermark_border_size, 0);
+  CHECK_OPTION_LE(watermark_border_size, 1);
+  CHECK_OPTION_GT(ransac_options.max_error, 0);
+  CHECK_OPTION_GE(ransac_options.min_inlier_ratio, 0);
+  CHECK_OPTION_LE(ransac_options.min_inlier_ratio, 1);
+  CHECK_OPTION_GE(ransac_options.confidence, 0);
+  CHECK_OPTION_LE(ransac_options.confidence, 1);
+  CHECK_OPTION_LE(ransac_options.min_num_trials, ransac_options.max_num_trials);
+  CHECK_OPTION_GE(ransac_options.random_seed, -1);
+  CHECK_OPTION_GT(pre_filter_min_inlier_ratio, 0);
+  CHECK_OPTION_LE(pre_filter_min_inlier_ratio, 1);
+  CHECK_OPTION_GE(pre_filter_confidence, 0);
+  CHECK_OPTION_LE(pre_filter_confidence, 1);
+  return true;
+}
+
+bool PreFilterTwoViewGeometry(const std::vector<Eigen::Vector2d>& points1,
+                              const std::vector<Eigen::Vector2d>& points2,
+                              const FeatureMatches& matches,
+                              const TwoViewGeometryOptions& options) {
+  const size_t min_num_inliers = static_cast<size_t>(options.min_num_inliers);
+  if (matches.size() < min_num_inliers) {
+    return false;
+  }
+
+  std::vector<Eigen::Vector2d> matched_img_points1(matches.size());
+  std::vector<Eigen::Vector2d> matched_img_points2(matches.size());
+  for (size_t i = 0; i < matches.size(); ++i) {
+    matched_img_points1[i] = points1[matches[i].point2D_idx1];
+    matched_img_points2[i] = points2[matches[i].point2D_idx2];
+  }
+
+  // The maximum number of trials is determined by the assumed minimum inlier
+  // ratio and the confidence, which bounds the probability of rejecting a
+  // pair with at least this inlier ratio.
+  RANSACOptions ransac_options = options.ransac_options;
+  ransac_options.min_inlier_ratio = options.pre_filter_min_inlier_ratio;
+  ransac_options.confidence = options.pre_filter_confidence;
+  ransac_options.dyn_num_trials_multiplier = 1;
+  ransac_options.min_num_trials = 0;
+
+  RANSAC<FundamentalMatrixSevenPointEstimator> F_ransac(ransac_options);
+  const auto F_report =
+      F_ransac.Estimate(matched_img_points1, matched_img_points2);
+
+  return F_report.success && F_report.support.num_inliers >= min_num_inliers;
+}
+
+TwoViewGeometry EstimateTwoViewGeometry(
+    const Camera& camera1,
+    const std::vector<Eigen::Vector2d>& points1,
+    const Camera& camera2,
+    const std::vector<Eigen::Vector2d>& points2,
+    FeatureMatches matches,
+    const TwoViewGeometryOptions& options) {
+  return EstimateTwoViewGeometryImpl(camera1,
+                                     points1,
+                                     /*cam_rays1=*/nullptr,
+                                     camera2,
+                                     points2,
+                                     /*cam_rays2=*/nullptr,
+                                     std::move(matches),
+                                     options);
+}
+
+TwoViewGeometry EstimateTwoViewGeometry(
+    const Camera& camera1,
+    const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector3d>& cam_rays1,
+    const Camera& camera2,
+    const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Vector3d>& cam_rays2,
+    FeatureMatches matches,
+    const TwoViewGeometryOptions& options) {
+  THROW_CHECK_EQ(points1.size(), cam_rays1.size());
+  THROW_CHECK_EQ(points2.size(), cam_rays2.size());
+  return EstimateTwoViewGeometryImpl(camera1,
+                                     points1,
+                                     &cam_rays1,
+                                     camera2,
+                                     points2,
+                                     &cam_rays2,
+                                     std::move(matches),
+                                     options);
+}
+
+bool TwoViewGeometryUsesCamRays(const Camera& camera1,
+                                const Camera& camera2,
+                                const TwoViewGeometryOptions& options) {
+  return (camera1.has_prior_focal_length && camera2.has_prior_focal_length &&
+          !options.force_H_use) ||
+         options.compute_relative_pose;
+}
+
+bool EstimateTwoViewGeometryPose(const Camera& camera1,
+                                 const std::vector<Eigen::Vector2d>& points1,
+                                 const Camera& camera2,
+                                 const std::vector<Eigen::Vector2d>& points2,
+                                 TwoViewGeometry* geometry) {
+  return EstimateTwoViewGeometryPoseImpl(camera1,
+                                         points1,
+                                         /*cam_rays1=*/nullptr,
+                                         camera2,
+                                         points2,
+                                         /*cam_rays2=*/nullptr,
+                                         geometry);
+}
+
+bool EstimateTwoViewGeometryPose(const Camera& camera1,
+                                 const std::vector<Eigen::Vector2d>& points1,
+                                 const std::vector<Eigen::Vector3d>& cam_rays1,
+                                 const Camera& camera2,
+                                 const std::vector<Eigen::Vector2d>& points2,
+                                 const std::vector<Eigen::Vector3d>& cam_rays2,
+                                 TwoViewGeometry* geometry) {
+  THROW_CHECK_EQ(points1.size(), cam_rays1.size());
+  THROW_CHECK_EQ(points2.size(), cam_rays2.size());
+  return EstimateTwoViewGeometryPoseImpl(
+      camera1, points1, &cam_rays1, camera2, points2, &cam_rays2, geometry);
+}
+
+TwoViewGeometry EstimateCalibratedTwoViewGeometry(
+    const Camera& camera1,
+    const std::vector<Eigen::Vector2d>& points1,
+    const Camera& camera2,
+    const std::vector<Eigen::Vector2d>& points2,
+    const FeatureMatches& matches,
+    const TwoViewGeometryOptions& options) {
+  return EstimateCalibratedTwoViewGeometryImpl(camera1,
+                                               points1,
+                                               /*cam_rays1=*/nullptr,
+                                               camera2,
+                                               points2,
+                                               /*cam_rays2=*/nullptr,
+                                               matches,
+                                               options);
+}
+
+TwoViewGeometry EstimateCalibratedTwoViewGeometry(
+    const Camera& camera1,
+    const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector3d>& cam_rays1,
+    const Camera& camera2,
+    const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Vector3d>& cam_rays2,
+    const FeatureMatches& matches,
+    const TwoViewGeometryOptions& options) {
+  THROW_CHECK_EQ(points1.size(), cam_rays1.size());
+  THROW_CHECK_EQ(points2.size(), cam_rays2.size());
+  return EstimateCalibratedTwoViewGeometryImpl(camera1,
+                                               points1,
+                                               &cam_rays1,
+                                               camera2,
+                                               points2,
+                                               &cam_rays2,
+                                               matches,
+                                               options);
+}
+
 bool DetectWatermarkMatches(const Camera& camera1,
                             const std::vector<Eigen::Vector2d>& points1,
                             const Camera& camera2,
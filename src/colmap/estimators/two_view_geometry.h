@@ -94,6 +94,24 @@ struct TwoViewGeometryOptions {
   // Whether to compute the relative pose between the two views.
   bool compute_relative_pose = false;
 
+  // Whether to estimate the models for calibrated image pairs in stages
+  // instead of running independent E, F, and H RANSACs. The essential matrix
+  // is estimated first. If it explains so many matches that the calibration
+  // check can no longer fail, the fundamental matrix is derived from it and
+  // the homography is only estimated on the essential matrix inliers.
+  // Otherwise, the estimation falls back to the full F and H RANSACs.
+  bool staged_calibrated_estimation = false;
+
+  // Whether to reject hopeless image pairs with a cheap hypothesis test before
+  // the full estimation. A small budget of RANSAC trials is spent to find a
+  // fundamental matrix with at least `min_num_inliers` inliers. The budget is
+  // chosen such that pairs with an inlier ratio of at least
+  // `pre_filter_min_inlier_ratio` pass the test with a probability of at least
+  // `pre_filter_confidence`.
+  bool pre_filter = false;
+  double pre_filter_min_inlier_ratio = 0.5;
+  double pre_filter_confidence = 0.99;
+
   // Recursively estimate multiple configurations by removing the previous set
   // of inliers from the matches until not enough inliers are found. Inlier
   // matches are concatenated and the configuration type is `MULTIPLE` if
@@ -136,6 +154,43 @@ TwoViewGeometry EstimateTwoViewGeometry(
     FeatureMatches matches,
     const TwoViewGeometryOptions& options);
 
+// Same as above but with precomputed normalized camera rays for all feature
+// points, e.g., as computed by `PointsVectorToCamRays`. This avoids repeatedly
+// undistorting the same feature points when an image is verified against many
+// other images.
+//
+// @param cam_rays1       Normalized camera rays of all points in first image.
+// @param cam_rays2       Normalized camera rays of all points in second image.
+TwoViewGeometry EstimateTwoViewGeometry(
+    const Camera& camera1,
+    const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector3d>& cam_rays1,
+    const Camera& camera2,
+    const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Vector3d>& cam_rays2,
+    FeatureMatches matches,
+    const TwoViewGeometryOptions& options);
+
+// Whether the estimation benefits from precomputed normalized camera rays,
+// i.e., whether it estimates a calibrated geometry or the relative pose.
+// Otherwise, the overload without camera rays avoids computing them.
+bool TwoViewGeometryUsesCamRays(const Camera& camera1,
+                                const Camera& camera2,
+                                const TwoViewGeometryOptions& options);
+
+// Cheap hypothesis test whether the matches can be explained by an epipolar
+// geometry with at least `min_num_inliers` inliers, see `pre_filter` in the
+// options. Returns false for hopeless image pairs that can be skipped.
+//
+// @param points1         Feature points in first image.
+// @param points2         Feature points in second image.
+// @param matches         Feature matches between first and second image.
+// @param options         Two-view geometry estimation options.
+bool PreFilterTwoViewGeometry(const std::vector<Eigen::Vector2d>& points1,
+                              const std::vector<Eigen::Vector2d>& points2,
+                              const FeatureMatches& matches,
+                              const TwoViewGeometryOptions& options);
+
 // Estimate relative pose for two-view geometry.
 //
 // @param camera1         Camera of first image.
@@ -149,6 +204,13 @@ bool EstimateTwoViewGeometryPose(const Camera& camera1,
                                  const Camera& camera2,
                                  const std::vector<Eigen::Vector2d>& points2,
                                  TwoViewGeometry* geometry);
+bool EstimateTwoViewGeometryPose(const Camera& camera1,
+                                 const std::vector<Eigen::Vector2d>& points1,
+                                 const std::vector<Eigen::Vector3d>& cam_rays1,
+                                 const Camera& camera2,
+                                 const std::vector<Eigen::Vector2d>& points2,
+                                 const std::vector<Eigen::Vector3d>& cam_rays2,
+                                 TwoViewGeometry* geometry);
 
 // Estimate two-view geometry from calibrated image pair.
 //
@@ -165,6 +227,15 @@ TwoViewGeometry EstimateCalibratedTwoViewGeometry(
     const std::vector<Eigen::Vector2d>& points2,
     const FeatureMatches& matches,
     const TwoViewGeometryOptions& options);
+TwoViewGeometry EstimateCalibratedTwoViewGeometry(
+    const Camera& camera1,
+    const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector3d>& cam_rays1,
+    const Camera& camera2,
+    const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Vector3d>& cam_rays2,
+    const FeatureMatches& matches,
+    const TwoViewGeometryOptions& options);
 
 // Detect if inlier matches are caused by a watermark, where a
 // watermark causes a pure translation in the border of the image.
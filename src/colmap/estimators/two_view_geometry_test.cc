@@ -544,6 +544,208 @@ TEST(EstimateTwoViewGeometry, CalibratedDeterministic) {
   EXPECT_NE(geometry1.E, geometry3.E);
 }
 
+TEST(EstimateTwoViewGeometry, CalibratedWithCamRays) {
+  SetPRNGSeed(1);
+
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_rigs = 2;
+  synthetic_dataset_options.num_cameras_per_rig = 1;
+  synthetic_dataset_options.num_frames_per_rig = 1;
+  synthetic_dataset_options.num_points3D = 500;
+  synthetic_dataset_options.point2D_stddev = 1;
+  synthetic_dataset_options.inlier_match_ratio = 0.6;
+  synthetic_dataset_options.camera_has_prior_focal_length = true;
+  const TwoViewGeometryTestData test_data =
+      CreateTwoViewGeometryTestData(synthetic_dataset_options);
+
+  auto cam_rays_from_img = [](const Camera& camera,
+                              const std::vector<Eigen::Vector2d>& points) {
+    std::vector<Eigen::Vector3d> cam_rays(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+      cam_rays[i] = camera.CamFromImg(points[i])->homogeneous().normalized();
+    }
+    return cam_rays;
+  };
+  const std::vector<Eigen::Vector3d> cam_rays1 =
+      cam_rays_from_img(test_data.camera1, test_data.points1);
+  const std::vector<Eigen::Vector3d> cam_rays2 =
+      cam_rays_from_img(test_data.camera2, test_data.points2);
+
+  TwoViewGeometryOptions two_view_geometry_options;
+  two_view_geometry_options.compute_relative_pose = true;
+  two_view_geometry_options.ransac_options.random_seed = 42;
+  const TwoViewGeometry geometry1 =
+      EstimateTwoViewGeometry(test_data.camera1,
+                              test_data.points1,
+                              test_data.camera2,
+                              test_data.points2,
+                              test_data.matches,
+                              two_view_geometry_options);
+  EXPECT_EQ(geometry1.config, TwoViewGeometry::ConfigurationType::CALIBRATED);
+
+  const TwoViewGeometry geometry2 =
+      EstimateTwoViewGeometry(test_data.camera1,
+                              test_data.points1,
+                              cam_rays1,
+                              test_data.camera2,
+                              test_data.points2,
+                              cam_rays2,
+                              test_data.matches,
+                              two_view_geometry_options);
+  EXPECT_EQ(geometry2.config, TwoViewGeometry::ConfigurationType::CALIBRATED);
+
+  // Precomputed rays must produce identical results.
+  EXPECT_EQ(geometry1.E, geometry2.E);
+  ASSERT_EQ(geometry1.inlier_matches.size(), geometry2.inlier_matches.size());
+  for (size_t i = 0; i < geometry1.inlier_matches.size(); ++i) {
+    EXPECT_EQ(geometry1.inlier_matches[i].point2D_idx1,
+              geometry2.inlier_matches[i].point2D_idx1);
+    EXPECT_EQ(geometry1.inlier_matches[i].point2D_idx2,
+              geometry2.inlier_matches[i].point2D_idx2);
+  }
+  EXPECT_EQ(geometry1.cam2_from_cam1.rotation.coeffs(),
+            geometry2.cam2_from_cam1.rotation.coeffs());
+  EXPECT_EQ(geometry1.cam2_from_cam1.translation,
+            geometry2.cam2_from_cam1.translation);
+}
+
+TEST(EstimateTwoViewGeometry, StagedCalibratedEstimation) {
+  SetPRNGSeed(1);
+
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_rigs = 2;
+  synthetic_dataset_options.num_cameras_per_rig = 1;
+  synthetic_dataset_options.num_frames_per_rig = 1;
+  synthetic_dataset_options.num_points3D = 500;
+  synthetic_dataset_options.point2D_stddev = 0.5;
+  synthetic_dataset_options.camera_has_prior_focal_length = true;
+
+  TwoViewGeometryOptions two_view_geometry_options;
+  two_view_geometry_options.ransac_options.random_seed = 42;
+
+  // Unambiguous pair, where the E inliers decide the configuration.
+  const TwoViewGeometryTestData test_data1 =
+      CreateTwoViewGeometryTestData(synthetic_dataset_options);
+  const TwoViewGeometry geometry1 =
+      EstimateTwoViewGeometry(test_data1.camera1,
+                              test_data1.points1,
+                              test_data1.camera2,
+                              test_data1.points2,
+                              test_data1.matches,
+                              two_view_geometry_options);
+  two_view_geometry_options.staged_calibrated_estimation = true;
+  const TwoViewGeometry staged_geometry1 =
+      EstimateTwoViewGeometry(test_data1.camera1,
+                              test_data1.points1,
+                              test_data1.camera2,
+                              test_data1.points2,
+                              test_data1.matches,
+                              two_view_geometry_options);
+  EXPECT_EQ(geometry1.config, TwoViewGeometry::ConfigurationType::CALIBRATED);
+  EXPECT_EQ(staged_geometry1.config,
+            TwoViewGeometry::ConfigurationType::CALIBRATED);
+  EXPECT_EQ(staged_geometry1.E, geometry1.E);
+  EXPECT_EQ(staged_geometry1.F,
+            FundamentalFromEssentialMatrix(
+                test_data1.camera2.CalibrationMatrix(),
+                staged_geometry1.E,
+                test_data1.camera1.CalibrationMatrix()));
+  EXPECT_GE(staged_geometry1.inlier_matches.size(),
+            0.95 * test_data1.matches.size());
+
+  // Ambiguous pair with outlier matches, where the staged estimation falls
+  // back to the full RANSACs.
+  TwoViewGeometryTestData test_data2 = test_data1;
+  const size_t num_inlier_matches = test_data1.matches.size();
+  for (size_t i = 0; i < num_inlier_matches / 2; ++i) {
+    test_data2.matches.emplace_back(
+        test_data1.matches[i].point2D_idx1,
+        test_data1.matches[i + num_inlier_matches / 2].point2D_idx2);
+  }
+  two_view_geometry_options.staged_calibrated_estimation = false;
+  const TwoViewGeometry geometry2 =
+      EstimateTwoViewGeometry(test_data2.camera1,
+                              test_data2.points1,
+                              test_data2.camera2,
+                              test_data2.points2,
+                              test_data2.matches,
+                              two_view_geometry_options);
+  two_view_geometry_options.staged_calibrated_estimation = true;
+  const TwoViewGeometry staged_geometry2 =
+      EstimateTwoViewGeometry(test_data2.camera1,
+                              test_data2.points1,
+                              test_data2.camera2,
+                              test_data2.points2,
+                              test_data2.matches,
+                              two_view_geometry_options);
+  EXPECT_EQ(staged_geometry2.config, geometry2.config);
+  EXPECT_EQ(staged_geometry2.E, geometry2.E);
+  EXPECT_EQ(staged_geometry2.F, geometry2.F);
+  EXPECT_EQ(staged_geometry2.H, geometry2.H);
+  EXPECT_EQ(staged_geometry2.inlier_matches.size(),
+            geometry2.inlier_matches.size());
+}
+
+TEST(PreFilterTwoViewGeometry, Nominal) {
+  SetPRNGSeed(1);
+
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_rigs = 2;
+  synthetic_dataset_options.num_cameras_per_rig = 1;
+  synthetic_dataset_options.num_frames_per_rig = 1;
+  synthetic_dataset_options.num_points3D = 200;
+  synthetic_dataset_options.point2D_stddev = 0.5;
+  const TwoViewGeometryTestData test_data =
+      CreateTwoViewGeometryTestData(synthetic_dataset_options);
+
+  TwoViewGeometryOptions two_view_geometry_options;
+  two_view_geometry_options.ransac_options.random_seed = 42;
+  EXPECT_TRUE(PreFilterTwoViewGeometry(test_data.points1,
+                                       test_data.points2,
+                                       test_data.matches,
+                                       two_view_geometry_options));
+
+  // A few dozen random matches between unrelated points are rejected.
+  FeatureMatches random_matches;
+  for (size_t i = 0; i < 40; ++i) {
+    random_matches.emplace_back(
+        test_data.matches[i].point2D_idx1,
+        test_data.matches[RandomUniformInteger<size_t>(
+                              0, test_data.matches.size() - 1)]
+            .point2D_idx2);
+  }
+  EXPECT_FALSE(PreFilterTwoViewGeometry(test_data.points1,
+                                        test_data.points2,
+                                        random_matches,
+                                        two_view_geometry_options));
+
+  // Not enough matches.
+  EXPECT_FALSE(PreFilterTwoViewGeometry(
+      test_data.points1,
+      test_data.points2,
+      FeatureMatches(test_data.matches.begin(),
+                     test_data.matches.begin() +
+                         two_view_geometry_options.min_num_inliers - 1),
+      two_view_geometry_options));
+}
+
+TEST(TwoViewGeometryUsesCamRays, Nominal) {
+  Camera camera1 = Camera::CreateFromModelName(1, "SIMPLE_PINHOLE", 1, 1, 1);
+  Camera camera2 = Camera::CreateFromModelName(2, "SIMPLE_PINHOLE", 1, 1, 1);
+  TwoViewGeometryOptions options;
+  EXPECT_FALSE(TwoViewGeometryUsesCamRays(camera1, camera2, options));
+  camera1.has_prior_focal_length = true;
+  EXPECT_FALSE(TwoViewGeometryUsesCamRays(camera1, camera2, options));
+  camera2.has_prior_focal_length = true;
+  EXPECT_TRUE(TwoViewGeometryUsesCamRays(camera1, camera2, options));
+  options.force_H_use = true;
+  EXPECT_FALSE(TwoViewGeometryUsesCamRays(camera1, camera2, options));
+  options.compute_relative_pose = true;
+  EXPECT_TRUE(TwoViewGeometryUsesCamRays(camera1, camera2, options));
+  camera1.has_prior_focal_length = false;
+  EXPECT_TRUE(TwoViewGeometryUsesCamRays(camera1, camera2, options));
+}
+
 TEST(EstimateTwoViewGeometry, UncalibratedDeterministic) {
   SetPRNGSeed(1);
 
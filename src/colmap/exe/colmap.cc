@@ -126,6 +126,7 @@ int main(int argc, char** argv) {
   commands.emplace_back("sequential_matcher", &colmap::RunSequentialMatcher);
   commands.emplace_back("spatial_matcher", &colmap::RunSpatialMatcher);
   commands.emplace_back("stereo_fusion", &colmap::RunStereoFuser);
+  commands.emplace_back("streaming_mapper", &colmap::RunStreamingMapper);
   commands.emplace_back("transitive_matcher", &colmap::RunTransitiveMatcher);
   commands.emplace_back("vocab_tree_builder", &colmap::RunVocabTreeBuilder);
   commands.emplace_back("vocab_tree_matcher", &colmap::RunVocabTreeMatcher);
@@ -34,6 +34,7 @@
 #include "colmap/image/undistortion.h"
 #include "colmap/scene/reconstruction.h"
 #include "colmap/sfm/incremental_mapper.h"
+#include "colmap/sfm/localized_registration.h"
 #include "colmap/sfm/observation_manager.h"
 #include "colmap/util/base_controller.h"
 #include "colmap/util/misc.h"
@@ -75,6 +76,96 @@ std::vector<std::pair<image_t, image_t>> ReadStereoImagePairs(
   return stereo_pairs;
 }
 
+// Register the unregistered database images against a local reconstruction
+// that only contains their neighborhood in the given reconstruction, and write
+// the changes back into the reconstruction. See `localized_registration.h`.
+void RegisterImagesLocalized(const OptionManager& options,
+                             LocalizedRegistrationOptions localized_options,
+                             Reconstruction& reconstruction) {
+  PrintHeading1("Loading database");
+
+  std::shared_ptr<DatabaseCache> database_cache;
+
+  {
+    Timer timer;
+    timer.Start();
+    const Database database(*options.database_path);
+    localized_options.min_num_matches = options.mapper->min_num_matches;
+    localized_options.image_names = {options.mapper->image_names.begin(),
+                                     options.mapper->image_names.end()};
+    const std::unordered_set<std::string> image_names =
+        FindLocalizedRegistrationImageNames(
+            localized_options, database, reconstruction);
+    if (image_names.empty()) {
+      LOG(INFO) << "No new images to register";
+      return;
+    }
+    database_cache = DatabaseCache::Create(
+        database,
+        static_cast<size_t>(options.mapper->min_num_matches),
+        options.mapper->ignore_watermarks,
+        image_names);
+    timer.PrintMinutes();
+  }
+
+  const std::unordered_set<frame_t> local_frame_ids =
+      FindLocalFrameIds(*database_cache, reconstruction);
+  auto local_reconstruction = std::make_shared<Reconstruction>(
+      ExtractLocalReconstruction(reconstruction, local_frame_ids));
+
+  IncrementalMapper mapper(database_cache);
+  mapper.BeginReconstruction(local_reconstruction);
+
+  // The frames outside of the local reconstruction are not refined, so the
+  // existing frames in the local reconstruction must remain fixed as well.
+  IncrementalMapper::Options mapper_options = options.mapper->Mapper();
+  mapper_options.fix_existing_frames = true;
+
+  std::vector<image_t> image_ids;
+  for (const auto& [image_id, image] : local_reconstruction->Images()) {
+    if (!image.HasPose()) {
+      image_ids.push_back(image_id);
+    }
+  }
+  std::sort(image_ids.begin(), image_ids.end());
+
+  for (const image_t image_id : image_ids) {
+    const Image& image = local_reconstruction->Image(image_id);
+    if (image.HasPose()) {
+      continue;
+    }
+
+    PrintHeading1("Registering image #" + std::to_string(image_id) + " (" +
+                  std::to_string(local_reconstruction->NumRegImages() + 1) +
+                  ")");
+
+    LOG(INFO) << "\n=> Image sees "
+              << mapper.ObservationManager().NumVisiblePoints3D(image_id)
+              << " / " << mapper.ObservationManager().NumObservations(image_id)
+              << " points";
+
+    if (!mapper.RegisterNextImage(mapper_options, image_id)) {
+      continue;
+    }
+
+    for (const data_t& data_id : image.FramePtr()->ImageIds()) {
+      mapper.TriangulateImage(options.mapper->Triangulation(), data_id.id);
+    }
+    mapper.IterativeLocalRefinement(
+        options.mapper->ba_local_max_refinements,
+        options.mapper->ba_local_max_refinement_change,
+        mapper_options,
+        options.mapper->LocalBundleAdjustment(),
+        options.mapper->Triangulation(),
+        image_id);
+  }
+
+  mapper.EndReconstruction(/*discard=*/false);
+
+  MergeLocalReconstruction(
+      *local_reconstruction, local_frame_ids, reconstruction);
+}
+
 }  // namespace
 
 int RunImageDeleter(int argc, char** argv) {
@@ -254,11 +345,18 @@ int RunImageRectifier(int argc, char** argv) {
 int RunImageRegistrator(int argc, char** argv) {
   std::string input_path;
   std::string output_path;
+  bool localized = false;
+  LocalizedRegistrationOptions localized_options;
 
   OptionManager options;
   options.AddDatabaseOptions();
   options.AddRequiredOption("input_path", &input_path);
   options.AddRequiredOption("output_path", &output_path);
+  options.AddDefaultOption("localized", &localized);
+  options.AddDefaultOption("localized_max_num_neighbors",
+                           &localized_options.max_num_neighbors);
+  options.AddDefaultOption("localized_max_prior_distance",
+                           &localized_options.max_prior_distance);
   options.AddMapperOptions();
   options.Parse(argc, argv);
 
@@ -272,6 +370,14 @@ int RunImageRegistrator(int argc, char** argv) {
     return EXIT_FAILURE;
   }
 
+  if (localized) {
+    Reconstruction reconstruction;
+    reconstruction.Read(input_path);
+    RegisterImagesLocalized(options, localized_options, reconstruction);
+    reconstruction.Write(output_path);
+    return EXIT_SUCCESS;
+  }
+
   PrintHeading1("Loading database");
 
   std::shared_ptr<DatabaseCache> database_cache;
@@ -31,9 +31,12 @@
 
 #include "colmap/controllers/option_manager.h"
 #include "colmap/estimators/alignment.h"
+#include "colmap/estimators/bundle_adjustment.h"
 #include "colmap/estimators/coordinate_frame.h"
+#include "colmap/estimators/covariance.h"
 #include "colmap/geometry/gps.h"
 #include "colmap/geometry/pose.h"
+#include "colmap/math/math.h"
 #include "colmap/optim/ransac.h"
 #include "colmap/scene/reconstruction_io.h"
 #include "colmap/sfm/observation_manager.h"
@@ -84,6 +87,71 @@ Eigen::Vector3d TransformLatLonAltToModelCoords(const Sim3d& tform,
   return xyz;
 }
 
+// Estimates the pose covariances of all registered images and reports the
+// rotational and translational standard deviations. Uses selected inversion,
+// so that this also scales to large reconstructions.
+void PrintPoseCovariances(Reconstruction& reconstruction, bool verbose) {
+  BundleAdjustmentConfig config;
+  for (const image_t image_id : reconstruction.RegImageIds()) {
+    if (!reconstruction.Image(image_id).HasTrivialFrame()) {
+      LOG(WARNING) << "Pose covariances are only supported for "
+                      "reconstructions with trivial frames";
+      return;
+    }
+    config.AddImage(image_id);
+  }
+  config.FixGauge(BundleAdjustmentGauge::THREE_POINTS);
+
+  std::unique_ptr<BundleAdjuster> bundle_adjuster = CreateDefaultBundleAdjuster(
+      BundleAdjustmentOptions(), std::move(config), reconstruction);
+
+  BACovarianceOptions options;
+  options.params = BACovarianceOptions::Params::POSES;
+  options.use_selected_inversion = true;
+  const std::optional<BACovariance> ba_cov =
+      EstimateBACovariance(options, reconstruction, *bundle_adjuster);
+  if (!ba_cov.has_value()) {
+    LOG(WARNING) << "Failed to estimate pose covariances";
+    return;
+  }
+
+  if (verbose) {
+    PrintHeading2("Pose covariances");
+  }
+
+  std::vector<double> rotation_stddevs;
+  std::vector<double> translation_stddevs;
+  for (const image_t image_id : reconstruction.RegImageIds()) {
+    const std::optional<Eigen::MatrixXd> cov =
+        ba_cov->GetCamCovFromWorld(image_id);
+    if (!cov.has_value() || cov->rows() != 6) {
+      continue;
+    }
+    const double rotation_stddev =
+        RadToDeg(std::sqrt(cov->topLeftCorner<3, 3>().trace()));
+    const double translation_stddev =
+        std::sqrt(cov->bottomRightCorner<3, 3>().trace());
+    rotation_stddevs.push_back(rotation_stddev);
+    translation_stddevs.push_back(translation_stddev);
+    if (verbose) {
+      LOG(INFO) << StringPrintf(
+          " - Image Id: %d, Rotation stddev: %fdeg, Translation stddev: %f",
+          image_id,
+          rotation_stddev,
+          translation_stddev);
+    }
+  }
+
+  if (rotation_stddevs.empty()) {
+    return;
+  }
+
+  LOG(INFO) << StringPrintf("Median rotation stddev: %fdeg",
+                            Median(rotation_stddevs));
+  LOG(INFO) << StringPrintf("Median translation stddev: %f",
+                            Median(translation_stddevs));
+}
+
 void WriteBoundingBox(const std::string& reconstruction_path,
                       const Eigen::AlignedBox3d& bbox,
                       const std::string& suffix = "") {
@@ -276,6 +344,7 @@ int RunModelAligner(int argc, char** argv) {
   std::string alignment_type = "custom";
   int min_common_images = 3;
   RANSACOptions ransac_options;
+  int num_threads = -1;
 
   OptionManager options;
   options.AddRequiredOption("input_path", &input_path);
@@ -292,6 +361,7 @@ int RunModelAligner(int argc, char** argv) {
       "{plane, ecef, enu, enu-plane, enu-plane-unscaled, custom}");
   options.AddDefaultOption("min_common_images", &min_common_images);
   options.AddDefaultOption("alignment_max_error", &ransac_options.max_error);
+  options.AddDefaultOption("num_threads", &num_threads);
   options.Parse(argc, argv);
 
   StringToLower(&alignment_type);
@@ -374,7 +444,7 @@ int RunModelAligner(int argc, char** argv) {
       return EXIT_FAILURE;
     }
 
-    reconstruction.Transform(tform);
+    reconstruction.Transform(tform, num_threads);
 
     std::vector<double> errors;
     errors.reserve(ref_image_names.size());
@@ -411,7 +481,7 @@ int RunModelAligner(int argc, char** argv) {
         LOG(INFO) << "\n Aligning reconstruction's origin with ref origin: "
                   << first_img_position.transpose() << '\n';
 
-        reconstruction.Transform(origin_align);
+        reconstruction.Transform(origin_align, num_threads);
 
         // Update the Sim3 transformation in case it is stored next.
         tform =
@@ -434,10 +504,15 @@ int RunModelAligner(int argc, char** argv) {
 int RunModelAnalyzer(int argc, char** argv) {
   std::string path;
   bool verbose = false;
+  bool compute_pose_covariances = false;
+  int num_threads = -1;
 
   OptionManager options;
   options.AddRequiredOption("path", &path);
   options.AddDefaultOption("verbose", &verbose);
+  options.AddDefaultOption("compute_pose_covariances",
+                           &compute_pose_covariances);
+  options.AddDefaultOption("num_threads", &num_threads);
   options.Parse(argc, argv);
 
   Reconstruction reconstruction;
@@ -459,8 +534,13 @@ int RunModelAnalyzer(int argc, char** argv) {
   LOG(INFO) << StringPrintf(
       "Mean observations per image: %f",
       reconstruction.ComputeMeanObservationsPerRegImage());
-  LOG(INFO) << StringPrintf("Mean reprojection error: %fpx",
-                            reconstruction.ComputeMeanReprojectionError());
+  LOG(INFO) << StringPrintf(
+      "Mean reprojection error: %fpx",
+      reconstruction.ComputeMeanReprojectionError(num_threads));
+
+  if (compute_pose_covariances) {
+    PrintPoseCovariances(reconstruction, verbose);
+  }
 
   // verbose information
   if (verbose) {
@@ -773,6 +853,7 @@ int RunModelOrientationAligner(int argc, char** argv) {
 #endif
 
   ManhattanWorldFrameEstimationOptions frame_estimation_options;
+  int num_threads = -1;
 
   OptionManager options;
   options.AddImageOptions();
@@ -786,6 +867,7 @@ int RunModelOrientationAligner(int argc, char** argv) {
 #endif
   options.AddDefaultOption("max_image_size",
                            &frame_estimation_options.max_image_size);
+  options.AddDefaultOption("num_threads", &num_threads);
   options.Parse(argc, argv);
 
   StringToLower(&method);
@@ -843,7 +925,7 @@ int RunModelOrientationAligner(int argc, char** argv) {
   LOG(INFO) << "Using the rotation matrix:";
   LOG(INFO) << new_from_old_world.rotation.toRotationMatrix();
 
-  reconstruction.Transform(new_from_old_world);
+  reconstruction.Transform(new_from_old_world, num_threads);
 
   LOG(INFO) << "Writing aligned reconstruction...";
   reconstruction.Write(output_path);
@@ -1036,12 +1118,14 @@ int RunModelTransformer(int argc, char** argv) {
   std::string output_path;
   std::string transform_path;
   bool is_inverse = false;
+  int num_threads = -1;
 
   OptionManager options;
   options.AddRequiredOption("input_path", &input_path);
   options.AddRequiredOption("output_path", &output_path);
   options.AddRequiredOption("transform_path", &transform_path);
   options.AddDefaultOption("is_inverse", &is_inverse);
+  options.AddDefaultOption("num_threads", &num_threads);
   options.Parse(argc, argv);
 
   LOG(INFO) << "Reading points input: " << input_path;
@@ -1067,7 +1151,7 @@ int RunModelTransformer(int argc, char** argv) {
 
   LOG(INFO) << "Applying transform to recon with " << recon.NumPoints3D()
             << " points";
-  recon.Transform(tform);
+  recon.Transform(tform, num_threads);
 
   LOG(INFO) << "Writing output: " << output_path;
   if (is_dense) {
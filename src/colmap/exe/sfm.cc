@@ -33,15 +33,19 @@
 #include "colmap/controllers/bundle_adjustment.h"
 #include "colmap/controllers/hierarchical_pipeline.h"
 #include "colmap/controllers/option_manager.h"
+#include "colmap/controllers/streaming_pipeline.h"
 #include "colmap/estimators/similarity_transform.h"
 #include "colmap/exe/gui.h"
 #include "colmap/scene/reconstruction.h"
 #include "colmap/scene/rig.h"
 #include "colmap/sfm/observation_manager.h"
+#include "colmap/util/controller_thread.h"
 #include "colmap/util/file.h"
 #include "colmap/util/misc.h"
 #include "colmap/util/opengl_utils.h"
 
+#include <csignal>
+
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 
@@ -78,6 +82,15 @@ void UpdateDatabasePosePriorsCovariance(const std::string& database_path,
   }
 }
 
+// Streaming pipeline that is finished on SIGINT or SIGTERM.
+StreamingPipeline* signaled_streaming_pipeline = nullptr;
+
+void FinishStreamingPipeline(const int signal) {
+  signaled_streaming_pipeline->Finish();
+  // A repeated signal terminates the process without finishing.
+  std::signal(signal, SIG_DFL);
+}
+
 }  // namespace
 
 int RunAutomaticReconstructor(int argc, char** argv) {
@@ -111,6 +124,8 @@ int RunAutomaticReconstructor(int argc, char** argv) {
   options.AddDefaultOption("sparse", &reconstruction_options.sparse);
   options.AddDefaultOption("dense", &reconstruction_options.dense);
   options.AddDefaultOption("mesher", &mesher, "{poisson, delaunay}");
+  options.AddDefaultOption("overlap_stages",
+                           &reconstruction_options.overlap_stages);
   options.AddDefaultOption("num_threads", &reconstruction_options.num_threads);
   options.AddDefaultOption("random_seed", &reconstruction_options.random_seed);
   options.AddDefaultOption("use_gpu", &reconstruction_options.use_gpu);
@@ -185,16 +200,18 @@ int RunBundleAdjuster(int argc, char** argv) {
 int RunColorExtractor(int argc, char** argv) {
   std::string input_path;
   std::string output_path;
+  int num_threads = -1;
 
   OptionManager options;
   options.AddImageOptions();
   options.AddDefaultOption("input_path", &input_path);
   options.AddRequiredOption("output_path", &output_path);
+  options.AddDefaultOption("num_threads", &num_threads);
   options.Parse(argc, argv);
 
   Reconstruction reconstruction;
   reconstruction.Read(input_path);
-  reconstruction.ExtractColorsForAllImages(*options.image_path);
+  reconstruction.ExtractColorsForAllImages(*options.image_path, num_threads);
   reconstruction.Write(output_path);
 
   return EXIT_SUCCESS;
@@ -290,7 +307,8 @@ int RunMapper(int argc, char** argv) {
         if (EstimateSim3d(new_fixed_image_positions,
                           orig_fixed_image_positions,
                           orig_from_new)) {
-          reconstruction->Transform(orig_from_new);
+          reconstruction->Transform(orig_from_new,
+                                    options.mapper->num_threads);
         } else {
           LOG(WARNING) << "Failed to transform the reconstruction back "
                           "to the input coordinate frame.";
@@ -462,7 +480,8 @@ int RunPosePriorMapper(int argc, char** argv) {
         if (EstimateSim3d(new_fixed_image_positions,
                           orig_fixed_image_positions,
                           orig_from_new)) {
-          reconstruction->Transform(orig_from_new);
+          reconstruction->Transform(orig_from_new,
+                                    options.mapper->num_threads);
         } else {
           LOG(WARNING) << "Failed to transform the reconstruction back "
                           "to the input coordinate frame.";
@@ -483,6 +502,7 @@ int RunPointFiltering(int argc, char** argv) {
   size_t min_track_len = 2;
   double max_reproj_error = 4.0;
   double min_tri_angle = 1.5;
+  int num_threads = -1;
 
   OptionManager options;
   options.AddRequiredOption("input_path", &input_path);
@@ -490,13 +510,15 @@ int RunPointFiltering(int argc, char** argv) {
   options.AddDefaultOption("min_track_len", &min_track_len);
   options.AddDefaultOption("max_reproj_error", &max_reproj_error);
   options.AddDefaultOption("min_tri_angle", &min_tri_angle);
+  options.AddDefaultOption("num_threads", &num_threads);
   options.Parse(argc, argv);
 
   Reconstruction reconstruction;
   reconstruction.Read(input_path);
 
-  size_t num_filtered = ObservationManager(reconstruction)
-                            .FilterAllPoints3D(max_reproj_error, min_tri_angle);
+  size_t num_filtered =
+      ObservationManager(reconstruction)
+          .FilterAllPoints3D(max_reproj_error, min_tri_angle, num_threads);
 
   for (const auto point3D_id : reconstruction.Point3DIds()) {
     const auto& point3D = reconstruction.Point3D(point3D_id);
@@ -632,10 +654,106 @@ int RunRigBundleAdjuster(int argc, char** argv) {
     LOG(ERROR) << "Failed to solve rig bundle adjustment";
     return EXIT_FAILURE;
   }
-  reconstruction.UpdatePoint3DErrors();
+  reconstruction.UpdatePoint3DErrors(
+      options.bundle_adjustment->solver_options.num_threads);
   reconstruction.Write(output_path);
 
   return EXIT_SUCCESS;
 }
 
+int RunStreamingMapper(int argc, char** argv) {
+  std::string input_path;
+  StreamingPipelineOptions streaming_options;
+
+  OptionManager options;
+  options.AddDatabaseOptions();
+  options.AddImageOptions();
+  options.AddDefaultOption("input_path", &input_path);
+  options.AddRequiredOption("output_path", &streaming_options.output_path);
+  options.AddDefaultOption("poll_interval", &streaming_options.poll_interval);
+  options.AddDefaultOption("min_file_age", &streaming_options.min_file_age);
+  options.AddDefaultOption("max_batch_size",
+                           &streaming_options.max_batch_size);
+  options.AddDefaultOption("num_recent_images",
+                           &streaming_options.num_recent_images);
+  options.AddDefaultOption("vocab_tree_path",
+                           &streaming_options.vocab_tree_path);
+  options.AddDefaultOption("num_retrieval_images",
+                           &streaming_options.num_retrieval_images);
+  options.AddDefaultOption("global_ba_frames_freq",
+                           &streaming_options.global_ba_frames_freq);
+  options.AddDefaultOption("idle_timeout", &streaming_options.idle_timeout);
+  options.AddExtractionOptions();
+  options.AddMatchingOptions();
+  options.AddMapperOptions();
+  options.Parse(argc, argv);
+
+  if (!ExistsDir(streaming_options.output_path)) {
+    LOG(ERROR) << "`output_path` is not a directory.";
+    return EXIT_FAILURE;
+  }
+
+  auto reconstruction_manager = std::make_shared<ReconstructionManager>();
+  if (input_path != "") {
+    if (!ExistsDir(input_path)) {
+      LOG(ERROR) << "`input_path` is not a directory.";
+      return EXIT_FAILURE;
+    }
+    reconstruction_manager->Read(input_path);
+  }
+
+  if (reconstruction_manager->Size() > 1) {
+    LOG(ERROR) << "Streaming reconstruction only supports a single model.";
+    return EXIT_FAILURE;
+  }
+
+  ImageReaderOptions reader_options = *options.image_reader;
+  reader_options.image_path = *options.image_path;
+
+  const bool use_opengl = (options.feature_extraction->use_gpu ||
+                           options.feature_matching->use_gpu) &&
+                          kUseOpenGL;
+  std::unique_ptr<QApplication> app;
+  if (use_opengl) {
+    app.reset(new QApplication(argc, argv));
+  }
+
+  auto mapper = std::make_shared<StreamingPipeline>(streaming_options,
+                                                    reader_options,
+                                                    *options.feature_extraction,
+                                                    *options.feature_matching,
+                                                    *options.two_view_geometry,
+                                                    options.mapper,
+                                                    *options.database_path,
+                                                    reconstruction_manager);
+
+  // Without an idle timeout, the pipeline waits for new images until it is
+  // finished by the user.
+  signaled_streaming_pipeline = mapper.get();
+  std::signal(SIGINT, FinishStreamingPipeline);
+  std::signal(SIGTERM, FinishStreamingPipeline);
+  LOG(INFO) << "Press Ctrl-C to finish the reconstruction";
+
+  ControllerThread<StreamingPipeline> mapper_thread(mapper);
+  if (use_opengl) {
+    RunThreadWithOpenGLContext(&mapper_thread);
+  } else {
+    mapper_thread.Start();
+    mapper_thread.Wait();
+  }
+
+  std::signal(SIGINT, SIG_DFL);
+  std::signal(SIGTERM, SIG_DFL);
+  signaled_streaming_pipeline = nullptr;
+
+  if (reconstruction_manager->Size() == 0) {
+    LOG(ERROR) << "failed to create sparse model";
+    return EXIT_FAILURE;
+  }
+
+  options.Write(JoinPaths(streaming_options.output_path, "0", "project.ini"));
+
+  return EXIT_SUCCESS;
+}
+
 }  // namespace colmap
@@ -52,5 +52,6 @@ int RunPosePriorMapper(int argc, char** argv);
 int RunPointFiltering(int argc, char** argv);
 int RunPointTriangulator(int argc, char** argv);
 int RunRigBundleAdjuster(int argc, char** argv);
+int RunStreamingMapper(int argc, char** argv);
 
 }  // namespace colmap
@@ -32,6 +32,9 @@
 #include "colmap/feature/sift.h"
 #include "colmap/util/misc.h"
 
+#include <mutex>
+#include <unordered_map>
+
 namespace colmap {
 namespace {
 
@@ -41,6 +44,17 @@ void ThrowUnknownFeatureExtractorType(FeatureExtractorType type) {
   throw std::runtime_error(error.str());
 }
 
+std::mutex& FeatureExtractorRegistryMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::unordered_map<std::string, FeatureExtractorFactory>&
+FeatureExtractorRegistry() {
+  static std::unordered_map<std::string, FeatureExtractorFactory> registry;
+  return registry;
+}
+
 }  // namespace
 
 FeatureExtractionOptions::FeatureExtractionOptions(FeatureExtractorType type)
@@ -50,6 +64,8 @@ int FeatureExtractionOptions::MaxImageSize() const {
   switch (type) {
     case FeatureExtractorType::SIFT:
       return sift->max_image_size;
+    case FeatureExtractorType::CUSTOM:
+      return custom_max_image_size;
     default:
       ThrowUnknownFeatureExtractorType(type);
   }
@@ -67,6 +83,8 @@ bool FeatureExtractionOptions::Check() const {
   }
   if (type == FeatureExtractorType::SIFT) {
     return THROW_CHECK_NOTNULL(sift)->Check();
+  } else if (type == FeatureExtractorType::CUSTOM) {
+    CHECK_OPTION(IsFeatureExtractorRegistered(custom_extractor));
   } else {
     LOG(ERROR) << "Unknown feature extractor type: " << type;
     return false;
@@ -79,10 +97,42 @@ std::unique_ptr<FeatureExtractor> FeatureExtractor::Create(
   switch (options.type) {
     case FeatureExtractorType::SIFT:
       return CreateSiftFeatureExtractor(options);
+    case FeatureExtractorType::CUSTOM: {
+      FeatureExtractorFactory factory;
+      {
+        std::lock_guard<std::mutex> lock(FeatureExtractorRegistryMutex());
+        const auto it = FeatureExtractorRegistry().find(
+            options.custom_extractor);
+        if (it == FeatureExtractorRegistry().end()) {
+          LOG(ERROR) << "Feature extractor " << options.custom_extractor
+                     << " is not registered";
+          return nullptr;
+        }
+        factory = it->second;
+      }
+      return factory(options);
+    }
     default:
       ThrowUnknownFeatureExtractorType(options.type);
   }
   return nullptr;
 }
 
+void RegisterFeatureExtractor(const std::string& name,
+                              FeatureExtractorFactory factory) {
+  THROW_CHECK(factory);
+  std::lock_guard<std::mutex> lock(FeatureExtractorRegistryMutex());
+  FeatureExtractorRegistry()[name] = std::move(factory);
+}
+
+void UnregisterFeatureExtractor(const std::string& name) {
+  std::lock_guard<std::mutex> lock(FeatureExtractorRegistryMutex());
+  FeatureExtractorRegistry().erase(name);
+}
+
+bool IsFeatureExtractorRegistered(const std::string& name) {
+  std::lock_guard<std::mutex> lock(FeatureExtractorRegistryMutex());
+  return FeatureExtractorRegistry().count(name) > 0;
+}
+
 }  // namespace colmap
@@ -33,11 +33,13 @@
 #include "colmap/sensor/bitmap.h"
 #include "colmap/util/enum_utils.h"
 
+#include <functional>
 #include <memory>
+#include <string>
 
 namespace colmap {
 
-MAKE_ENUM_CLASS_OVERLOAD_STREAM(FeatureExtractorType, 0, SIFT);
+MAKE_ENUM_CLASS_OVERLOAD_STREAM(FeatureExtractorType, 0, SIFT, CUSTOM);
 
 struct SiftExtractionOptions;
 
@@ -59,6 +61,13 @@ struct FeatureExtractionOptions {
 
   std::shared_ptr<SiftExtractionOptions> sift;
 
+  // Name of the registered feature extractor used for the CUSTOM type.
+  std::string custom_extractor;
+
+  // Maximum image size for the CUSTOM type, otherwise image will be
+  // down-scaled.
+  int custom_max_image_size = 3200;
+
   int MaxImageSize() const;
 
   bool Check() const;
@@ -76,4 +85,18 @@ class FeatureExtractor {
                        FeatureDescriptors* descriptors) = 0;
 };
 
+// Factory for a custom feature extractor, which is created by
+// FeatureExtractor::Create for the CUSTOM type, e.g., to run learned features
+// inside the feature extraction pipeline.
+typedef std::function<std::unique_ptr<FeatureExtractor>(
+    const FeatureExtractionOptions& options)>
+    FeatureExtractorFactory;
+
+// Register a custom feature extractor factory under the given name. An
+// existing factory with the same name is replaced. Thread-safe.
+void RegisterFeatureExtractor(const std::string& name,
+                              FeatureExtractorFactory factory);
+void UnregisterFeatureExtractor(const std::string& name);
+bool IsFeatureExtractorRegistered(const std::string& name);
+
 }  // namespace colmap
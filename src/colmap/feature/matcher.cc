@@ -30,9 +30,24 @@
 #include "colmap/feature/matcher.h"
 
 #include "colmap/feature/sift.h"
+#include "colmap/feature/utils.h"
 #include "colmap/util/misc.h"
 
 namespace colmap {
+namespace {
+
+std::mutex& FeatureMatcherRegistryMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::unordered_map<std::string, FeatureMatcherFactory>&
+FeatureMatcherRegistry() {
+  static std::unordered_map<std::string, FeatureMatcherFactory> registry;
+  return registry;
+}
+
+}  // namespace
 
 FeatureMatchingOptions::FeatureMatchingOptions(FeatureMatcherType type)
     : type(type), sift(std::make_shared<SiftMatchingOptions>()) {}
@@ -49,6 +64,8 @@ bool FeatureMatchingOptions::Check() const {
   CHECK_OPTION_GE(max_num_matches, 0);
   if (type == FeatureMatcherType::SIFT) {
     return THROW_CHECK_NOTNULL(sift)->Check();
+  } else if (type == FeatureMatcherType::CUSTOM) {
+    CHECK_OPTION(IsFeatureMatcherRegistered(custom_matcher));
   } else {
     LOG(ERROR) << "Unknown feature matcher type: " << type;
     return false;
@@ -61,6 +78,20 @@ std::unique_ptr<FeatureMatcher> FeatureMatcher::Create(
   switch (options.type) {
     case FeatureMatcherType::SIFT:
       return CreateSiftFeatureMatcher(options);
+    case FeatureMatcherType::CUSTOM: {
+      FeatureMatcherFactory factory;
+      {
+        std::lock_guard<std::mutex> lock(FeatureMatcherRegistryMutex());
+        const auto it = FeatureMatcherRegistry().find(options.custom_matcher);
+        if (it == FeatureMatcherRegistry().end()) {
+          LOG(ERROR) << "Feature matcher " << options.custom_matcher
+                     << " is not registered";
+          return nullptr;
+        }
+        factory = it->second;
+      }
+      return factory(options);
+    }
     default:
       std::ostringstream error;
       error << "Unknown feature matcher type: " << options.type;
@@ -68,6 +99,33 @@ std::unique_ptr<FeatureMatcher> FeatureMatcher::Create(
   }
 }
 
+void FeatureMatcher::MatchBatch(
+    const std::vector<std::pair<Image, Image>>& image_pairs,
+    std::vector<FeatureMatches>* matches) {
+  THROW_CHECK_NOTNULL(matches);
+  matches->resize(image_pairs.size());
+  for (size_t i = 0; i < image_pairs.size(); ++i) {
+    Match(image_pairs[i].first, image_pairs[i].second, &(*matches)[i]);
+  }
+}
+
+void RegisterFeatureMatcher(const std::string& name,
+                            FeatureMatcherFactory factory) {
+  THROW_CHECK(factory);
+  std::lock_guard<std::mutex> lock(FeatureMatcherRegistryMutex());
+  FeatureMatcherRegistry()[name] = std::move(factory);
+}
+
+void UnregisterFeatureMatcher(const std::string& name) {
+  std::lock_guard<std::mutex> lock(FeatureMatcherRegistryMutex());
+  FeatureMatcherRegistry().erase(name);
+}
+
+bool IsFeatureMatcherRegistered(const std::string& name) {
+  std::lock_guard<std::mutex> lock(FeatureMatcherRegistryMutex());
+  return FeatureMatcherRegistry().count(name) > 0;
+}
+
 FeatureMatcherCache::FeatureMatcherCache(
     const size_t cache_size, const std::shared_ptr<Database>& database)
     : cache_size_(cache_size),
@@ -94,6 +152,21 @@ FeatureMatcherCache::FeatureMatcherCache(
                 database_->ReadDescriptors(image_id));
           });
 
+  points_cache_ = std::make_unique<
+      ThreadSafeLRUCache<image_t, std::vector<Eigen::Vector2d>>>(
+      cache_size_, [this](const image_t image_id) {
+        return std::make_shared<std::vector<Eigen::Vector2d>>(
+            FeatureKeypointsToPointsVector(*GetKeypoints(image_id)));
+      });
+
+  cam_rays_cache_ = std::make_unique<
+      ThreadSafeLRUCache<image_t, std::vector<Eigen::Vector3d>>>(
+      cache_size_, [this](const image_t image_id) {
+        const Camera& camera = GetCamera(GetImage(image_id).CameraId());
+        return std::make_shared<std::vector<Eigen::Vector3d>>(
+            PointsVectorToCamRays(camera, *GetPoints(image_id)));
+      });
+
   keypoints_exists_cache_ = std::make_unique<ThreadSafeLRUCache<image_t, bool>>(
       cache_size_, [this](const image_t image_id) {
         std::lock_guard<std::mutex> lock(database_mutex_);
@@ -145,6 +218,16 @@ std::shared_ptr<FeatureKeypoints> FeatureMatcherCache::GetKeypoints(
   return keypoints_cache_->Get(image_id);
 }
 
+std::shared_ptr<std::vector<Eigen::Vector2d>> FeatureMatcherCache::GetPoints(
+    const image_t image_id) {
+  return points_cache_->Get(image_id);
+}
+
+std::shared_ptr<std::vector<Eigen::Vector3d>> FeatureMatcherCache::GetCamRays(
+    const image_t image_id) {
+  return cam_rays_cache_->Get(image_id);
+}
+
 std::shared_ptr<FeatureDescriptors> FeatureMatcherCache::GetDescriptors(
     const image_t image_id) {
   return descriptors_cache_->Get(image_id);
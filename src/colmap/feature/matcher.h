@@ -39,13 +39,16 @@
 #include "colmap/util/cache.h"
 #include "colmap/util/types.h"
 
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace colmap {
 
-MAKE_ENUM_CLASS_OVERLOAD_STREAM(FeatureMatcherType, 0, SIFT);
+MAKE_ENUM_CLASS_OVERLOAD_STREAM(FeatureMatcherType, 0, SIFT, CUSTOM);
 
 struct SiftMatchingOptions;
 
@@ -81,6 +84,9 @@ struct FeatureMatchingOptions {
 
   std::shared_ptr<SiftMatchingOptions> sift;
 
+  // Name of the registered feature matcher used for the CUSTOM type.
+  std::string custom_matcher;
+
   bool Check() const;
 };
 
@@ -110,8 +116,33 @@ class FeatureMatcher {
                            const Image& image1,
                            const Image& image2,
                            TwoViewGeometry* two_view_geometry) = 0;
+
+  // Maximum number of image pairs passed to a single MatchBatch call. Matchers
+  // with a high per-call overhead, e.g., learned matchers, can benefit from
+  // larger batches.
+  virtual int MaxBatchSize() const { return 1; }
+
+  // Match multiple image pairs at once. The default implementation calls Match
+  // for every pair.
+  virtual void MatchBatch(
+      const std::vector<std::pair<Image, Image>>& image_pairs,
+      std::vector<FeatureMatches>* matches);
 };
 
+// Factory for a custom feature matcher, which is created by
+// FeatureMatcher::Create for the CUSTOM type, e.g., to run learned matchers
+// inside the feature matching pipeline.
+typedef std::function<std::unique_ptr<FeatureMatcher>(
+    const FeatureMatchingOptions& options)>
+    FeatureMatcherFactory;
+
+// Register a custom feature matcher factory under the given name. An existing
+// factory with the same name is replaced. Thread-safe.
+void RegisterFeatureMatcher(const std::string& name,
+                            FeatureMatcherFactory factory);
+void UnregisterFeatureMatcher(const std::string& name);
+bool IsFeatureMatcherRegistered(const std::string& name);
+
 // Cache for feature matching to minimize database access during matching.
 class FeatureMatcherCache {
  public:
@@ -127,6 +158,10 @@ class FeatureMatcherCache {
   const Image& GetImage(image_t image_id);
   const PosePrior* GetPosePriorOrNull(image_t image_id);
   std::shared_ptr<FeatureKeypoints> GetKeypoints(image_t image_id);
+  // Keypoint locations as contiguous pixel coordinates and the corresponding
+  // normalized camera rays, which are lazily computed once per image.
+  std::shared_ptr<std::vector<Eigen::Vector2d>> GetPoints(image_t image_id);
+  std::shared_ptr<std::vector<Eigen::Vector3d>> GetCamRays(image_t image_id);
   std::shared_ptr<FeatureDescriptors> GetDescriptors(image_t image_id);
   FeatureMatches GetMatches(image_t image_id1, image_t image_id2);
   std::vector<frame_t> GetFrameIds();
@@ -169,6 +204,10 @@ class FeatureMatcherCache {
       keypoints_cache_;
   std::unique_ptr<ThreadSafeLRUCache<image_t, FeatureDescriptors>>
       descriptors_cache_;
+  std::unique_ptr<ThreadSafeLRUCache<image_t, std::vector<Eigen::Vector2d>>>
+      points_cache_;
+  std::unique_ptr<ThreadSafeLRUCache<image_t, std::vector<Eigen::Vector3d>>>
+      cam_rays_cache_;
   std::unique_ptr<ThreadSafeLRUCache<image_t, bool>> keypoints_exists_cache_;
   std::unique_ptr<ThreadSafeLRUCache<image_t, bool>> descriptors_exists_cache_;
   ThreadSafeLRUCache<image_t, FeatureDescriptorIndex> descriptor_index_cache_;
@@ -0,0 +1,125 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "colmap/feature/matcher.h"
+
+#include <gtest/gtest.h>
+
+namespace colmap {
+namespace {
+
+// Matches the i-th keypoint of the first to the i-th keypoint of the second
+// image and counts the number of calls.
+class IdentityFeatureMatcher : public FeatureMatcher {
+ public:
+  explicit IdentityFeatureMatcher(int* num_match_calls)
+      : num_match_calls_(num_match_calls) {}
+
+  void Match(const Image& image1,
+             const Image& image2,
+             FeatureMatches* matches) override {
+    ++(*num_match_calls_);
+    matches->clear();
+    const size_t num_keypoints =
+        std::min(image1.keypoints->size(), image2.keypoints->size());
+    for (size_t i = 0; i < num_keypoints; ++i) {
+      matches->emplace_back(i, i);
+    }
+  }
+
+  void MatchGuided(double /*max_error*/,
+                   const Image& /*image1*/,
+                   const Image& /*image2*/,
+                   TwoViewGeometry* /*two_view_geometry*/) override {}
+
+ private:
+  int* num_match_calls_;
+};
+
+FeatureMatcher::Image CreateMatcherImage(image_t image_id,
+                                         size_t num_keypoints) {
+  FeatureMatcher::Image image;
+  image.image_id = image_id;
+  image.keypoints = std::make_shared<FeatureKeypoints>(num_keypoints);
+  image.descriptors = std::make_shared<FeatureDescriptors>(num_keypoints, 128);
+  return image;
+}
+
+TEST(FeatureMatcher, DefaultMatchBatch) {
+  int num_match_calls = 0;
+  IdentityFeatureMatcher matcher(&num_match_calls);
+  EXPECT_EQ(matcher.MaxBatchSize(), 1);
+
+  std::vector<FeatureMatches> matches;
+  matcher.MatchBatch({}, &matches);
+  EXPECT_TRUE(matches.empty());
+  EXPECT_EQ(num_match_calls, 0);
+
+  matcher.MatchBatch(
+      {{CreateMatcherImage(1, 3), CreateMatcherImage(2, 5)},
+       {CreateMatcherImage(1, 3), CreateMatcherImage(3, 2)}},
+      &matches);
+  ASSERT_EQ(matches.size(), 2);
+  EXPECT_EQ(matches[0].size(), 3);
+  EXPECT_EQ(matches[1].size(), 2);
+  EXPECT_EQ(num_match_calls, 2);
+}
+
+TEST(FeatureMatcher, RegisterCustom) {
+  const std::string kName = "identity_matcher_test";
+  FeatureMatchingOptions options(FeatureMatcherType::CUSTOM);
+  options.use_gpu = false;
+  options.custom_matcher = kName;
+
+  EXPECT_FALSE(IsFeatureMatcherRegistered(kName));
+  EXPECT_FALSE(options.Check());
+  EXPECT_EQ(FeatureMatcher::Create(options), nullptr);
+
+  int num_match_calls = 0;
+  RegisterFeatureMatcher(
+      kName, [&num_match_calls](const FeatureMatchingOptions&) {
+        return std::make_unique<IdentityFeatureMatcher>(&num_match_calls);
+      });
+  EXPECT_TRUE(IsFeatureMatcherRegistered(kName));
+  EXPECT_TRUE(options.Check());
+
+  std::unique_ptr<FeatureMatcher> matcher = FeatureMatcher::Create(options);
+  ASSERT_NE(matcher, nullptr);
+  FeatureMatches matches;
+  matcher->Match(CreateMatcherImage(1, 4), CreateMatcherImage(2, 4), &matches);
+  EXPECT_EQ(matches.size(), 4);
+  EXPECT_EQ(num_match_calls, 1);
+
+  UnregisterFeatureMatcher(kName);
+  EXPECT_FALSE(IsFeatureMatcherRegistered(kName));
+  EXPECT_EQ(FeatureMatcher::Create(options), nullptr);
+}
+
+}  // namespace
+}  // namespace colmap
@@ -971,6 +971,228 @@ Eigen::RowMajorMatrixXf ComputeSiftDistanceMatrix(
   return distances;
 }
 
+// Spatial grid over the keypoints of an image, such that guided matching only
+// needs to consider the keypoints close to the transferred point or the
+// epipolar line instead of all keypoints.
+class KeypointsGrid {
+ public:
+  KeypointsGrid(const FeatureKeypoints& keypoints, const float min_cell_size) {
+    THROW_CHECK_GT(min_cell_size, 0);
+    for (const FeatureKeypoint& keypoint : keypoints) {
+      bounds_.extend(Eigen::Vector2f(keypoint.x, keypoint.y));
+    }
+    if (keypoints.empty()) {
+      num_cells_x_ = 0;
+      num_cells_y_ = 0;
+      return;
+    }
+
+    // Aim for a small constant number of keypoints per cell.
+    constexpr float kNumKeypointsPerCell = 4;
+    const Eigen::Vector2f extent = bounds_.sizes();
+    cell_size_ = std::max(
+        min_cell_size,
+        std::sqrt(extent.x() * extent.y() * kNumKeypointsPerCell /
+                  static_cast<float>(keypoints.size())));
+    num_cells_x_ = static_cast<int>(extent.x() / cell_size_) + 1;
+    num_cells_y_ = static_cast<int>(extent.y() / cell_size_) + 1;
+
+    cell_offsets_.resize(num_cells_x_ * num_cells_y_ + 1, 0);
+    std::vector<int> keypoint_cells(keypoints.size());
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+      keypoint_cells[i] =
+          CellIdx(CellX(keypoints[i].x), CellY(keypoints[i].y));
+      cell_offsets_[keypoint_cells[i] + 1] += 1;
+    }
+    for (size_t i = 1; i < cell_offsets_.size(); ++i) {
+      cell_offsets_[i] += cell_offsets_[i - 1];
+    }
+    keypoint_idxs_.resize(keypoints.size());
+    std::vector<int> cell_sizes(num_cells_x_ * num_cells_y_, 0);
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+      const int cell_idx = keypoint_cells[i];
+      keypoint_idxs_[cell_offsets_[cell_idx] + cell_sizes[cell_idx]] = i;
+      cell_sizes[cell_idx] += 1;
+    }
+  }
+
+  const Eigen::AlignedBox2f& Bounds() const { return bounds_; }
+
+  // Calls func(keypoint_idx) for all keypoints in the cells overlapping the
+  // given axis-aligned box.
+  template <typename Func>
+  void ForEachInBox(const Eigen::Vector2f& min,
+                    const Eigen::Vector2f& max,
+                    const Func& func) const {
+    if (num_cells_x_ == 0 || !min.allFinite() || !max.allFinite() ||
+        max.x() < bounds_.min().x() || max.y() < bounds_.min().y() ||
+        min.x() > bounds_.max().x() || min.y() > bounds_.max().y()) {
+      return;
+    }
+    const int min_cell_x = CellX(min.x());
+    const int max_cell_x = CellX(max.x());
+    const int min_cell_y = CellY(min.y());
+    const int max_cell_y = CellY(max.y());
+    for (int cell_y = min_cell_y; cell_y <= max_cell_y; ++cell_y) {
+      ForEachInCells(min_cell_x, max_cell_x, cell_y, func);
+    }
+  }
+
+  // Calls func(keypoint_idx) for all keypoints in the cells overlapping the
+  // band of points with a distance of at most half_width to the given line.
+  template <typename Func>
+  void ForEachInBand(const Eigen::Vector3f& line,
+                     const float half_width,
+                     const Func& func) const {
+    if (num_cells_x_ == 0 || !line.allFinite() || !std::isfinite(half_width)) {
+      return;
+    }
+    const float a = line(0);
+    const float b = line(1);
+    const float c = line(2);
+    const float max_dist = half_width * std::sqrt(a * a + b * b);
+    if (std::abs(b) >= std::abs(a)) {
+      // Mostly horizontal line: enumerate the cells column by column.
+      for (int cell_x = 0; cell_x < num_cells_x_; ++cell_x) {
+        const float x0 = bounds_.min().x() + cell_x * cell_size_;
+        const float x1 = x0 + cell_size_;
+        const float y00 = -(a * x0 + c - max_dist) / b;
+        const float y01 = -(a * x0 + c + max_dist) / b;
+        const float y10 = -(a * x1 + c - max_dist) / b;
+        const float y11 = -(a * x1 + c + max_dist) / b;
+        const float min_y = std::min({y00, y01, y10, y11});
+        const float max_y = std::max({y00, y01, y10, y11});
+        if (max_y < bounds_.min().y() || min_y > bounds_.max().y()) {
+          continue;
+        }
+        const int max_cell_y = CellY(max_y);
+        for (int cell_y = CellY(min_y); cell_y <= max_cell_y; ++cell_y) {
+          ForEachInCells(cell_x, cell_x, cell_y, func);
+        }
+      }
+    } else {
+      // Mostly vertical line: enumerate the cells row by row.
+      for (int cell_y = 0; cell_y < num_cells_y_; ++cell_y) {
+        const float y0 = bounds_.min().y() + cell_y * cell_size_;
+        const float y1 = y0 + cell_size_;
+        const float x00 = -(b * y0 + c - max_dist) / a;
+        const float x01 = -(b * y0 + c + max_dist) / a;
+        const float x10 = -(b * y1 + c - max_dist) / a;
+        const float x11 = -(b * y1 + c + max_dist) / a;
+        const float min_x = std::min({x00, x01, x10, x11});
+        const float max_x = std::max({x00, x01, x10, x11});
+        if (max_x < bounds_.min().x() || min_x > bounds_.max().x()) {
+          continue;
+        }
+        ForEachInCells(CellX(min_x), CellX(max_x), cell_y, func);
+      }
+    }
+  }
+
+ private:
+  int CellX(const float x) const {
+    return std::clamp(static_cast<int>((x - bounds_.min().x()) / cell_size_),
+                      0,
+                      num_cells_x_ - 1);
+  }
+
+  int CellY(const float y) const {
+    return std::clamp(static_cast<int>((y - bounds_.min().y()) / cell_size_),
+                      0,
+                      num_cells_y_ - 1);
+  }
+
+  int CellIdx(const int cell_x, const int cell_y) const {
+    return cell_y * num_cells_x_ + cell_x;
+  }
+
+  template <typename Func>
+  void ForEachInCells(const int min_cell_x,
+                      const int max_cell_x,
+                      const int cell_y,
+                      const Func& func) const {
+    // Cells in the same row are contiguous.
+    const int begin = cell_offsets_[CellIdx(min_cell_x, cell_y)];
+    const int end = cell_offsets_[CellIdx(max_cell_x, cell_y) + 1];
+    for (int i = begin; i < end; ++i) {
+      func(keypoint_idxs_[i]);
+    }
+  }
+
+  Eigen::AlignedBox2f bounds_;
+  float cell_size_ = 1;
+  int num_cells_x_ = 0;
+  int num_cells_y_ = 0;
+  // Keypoint indices sorted by cell in compressed row storage.
+  std::vector<int> cell_offsets_;
+  std::vector<int> keypoint_idxs_;
+};
+
+// Best and second best squared L2 descriptor distance of a keypoint.
+struct GuidedMatchCandidate {
+  int best_idx = -1;
+  float best_l2_dist = std::numeric_limits<float>::max();
+  float second_best_l2_dist = std::numeric_limits<float>::max();
+  int num_candidates = 0;
+
+  void Update(const int idx, const float l2_dist) {
+    num_candidates += 1;
+    if (l2_dist < best_l2_dist) {
+      best_idx = idx;
+      second_best_l2_dist = best_l2_dist;
+      best_l2_dist = l2_dist;
+    } else if (l2_dist < second_best_l2_dist) {
+      second_best_l2_dist = l2_dist;
+    }
+  }
+};
+
+// Applies the distance and ratio test to the best candidates. Keypoints that
+// are not candidates are treated as having the maximum descriptor distance, as
+// in the dense guided matching.
+size_t FindBestMatchesOneWayGuided(
+    const std::vector<GuidedMatchCandidate>& candidates,
+    const int num_keypoints_other,
+    const float max_ratio,
+    const float max_distance,
+    std::vector<int>* matches) {
+  const float max_l2_dist = kSqSiftDescriptorNorm * max_distance * max_distance;
+
+  size_t num_matches = 0;
+  matches->resize(candidates.size(), -1);
+
+  for (size_t idx = 0; idx < candidates.size(); ++idx) {
+    GuidedMatchCandidate candidate = candidates[idx];
+    if (candidate.num_candidates < num_keypoints_other) {
+      const int num_candidates = candidate.num_candidates;
+      candidate.Update(-1, kSqSiftDescriptorNorm);
+      candidate.num_candidates = num_candidates;
+    }
+
+    // Check if any match found.
+    if (candidate.best_idx == -1) {
+      continue;
+    }
+
+    // Check if match distance passes threshold.
+    if (candidate.best_l2_dist > max_l2_dist) {
+      continue;
+    }
+
+    // Check if match passes ratio test. Keep this comparison >= in order to
+    // ensure that the case of best == second_best is detected.
+    if (std::sqrt(candidate.best_l2_dist) >=
+        max_ratio * std::sqrt(candidate.second_best_l2_dist)) {
+      continue;
+    }
+
+    ++num_matches;
+    (*matches)[idx] = candidate.best_idx;
+  }
+
+  return num_matches;
+}
+
 class SiftCPUFeatureMatcher : public FeatureMatcher {
  public:
   explicit SiftCPUFeatureMatcher(const FeatureMatchingOptions& options)
@@ -1088,72 +1310,145 @@ class SiftCPUFeatureMatcher : public FeatureMatcher {
       prev_image_id2_ = image2.image_id;
     }
 
+    const FeatureKeypoints& keypoints1 = *image1.keypoints;
+    const FeatureKeypoints& keypoints2 = *image2.keypoints;
+    const int num_keypoints1 = static_cast<int>(keypoints1.size());
+    const int num_keypoints2 = static_cast<int>(keypoints2.size());
+
+    const bool is_epipolar =
+        two_view_geometry->config == TwoViewGeometry::CALIBRATED ||
+        two_view_geometry->config == TwoViewGeometry::UNCALIBRATED;
+    const bool is_homography =
+        two_view_geometry->config == TwoViewGeometry::PLANAR ||
+        two_view_geometry->config == TwoViewGeometry::PANORAMIC ||
+        two_view_geometry->config == TwoViewGeometry::PLANAR_OR_PANORAMIC;
+    if ((!is_epipolar && !is_homography) || num_keypoints1 == 0 ||
+        num_keypoints2 == 0) {
+      return;
+    }
+
     const float max_residual = max_error * max_error;
 
     const Eigen::Matrix3f F = two_view_geometry->F.cast<float>();
     const Eigen::Matrix3f H = two_view_geometry->H.cast<float>();
 
-    std::function<bool(float, float, float, float)> guided_filter;
-    if (two_view_geometry->config == TwoViewGeometry::CALIBRATED ||
-        two_view_geometry->config == TwoViewGeometry::UNCALIBRATED) {
-      guided_filter =
-          [&](const float x1, const float y1, const float x2, const float y2) {
-            const Eigen::Vector3f p1(x1, y1, 1.0f);
-            const Eigen::Vector3f p2(x2, y2, 1.0f);
-            const Eigen::Vector3f Fx1 = F * p1;
-            const Eigen::Vector3f Ftx2 = F.transpose() * p2;
-            const float x2tFx1 = p2.transpose() * Fx1;
-            return x2tFx1 * x2tFx1 /
-                       (Fx1(0) * Fx1(0) + Fx1(1) * Fx1(1) + Ftx2(0) * Ftx2(0) +
-                        Ftx2(1) * Ftx2(1)) >
-                   max_residual;
-          };
-    } else if (two_view_geometry->config == TwoViewGeometry::PLANAR ||
-               two_view_geometry->config == TwoViewGeometry::PANORAMIC ||
-               two_view_geometry->config ==
-                   TwoViewGeometry::PLANAR_OR_PANORAMIC) {
-      guided_filter =
-          [&](const float x1, const float y1, const float x2, const float y2) {
-            const Eigen::Vector3f p1(x1, y1, 1.0f);
-            const Eigen::Vector2f p2(x2, y2);
-            return ((H * p1).hnormalized() - p2).squaredNorm() > max_residual;
-          };
-    } else {
-      return;
+    const KeypointsGrid grid2(keypoints2,
+                              /*min_cell_size=*/std::max(1.0f,
+                                                         static_cast<float>(
+                                                             max_error)));
+
+    // The squared norm of the epipolar line in the second image is bounded by
+    // its maximum over the corners of the keypoints' bounding box, since it is
+    // a convex function of the point. This bounds the width of the band around
+    // the epipolar line of the first point, in which the Sampson error can be
+    // below the threshold.
+    float max_sq_epipolar_line_norm2 = 0;
+    if (is_epipolar) {
+      for (const auto corner : {Eigen::AlignedBox2f::BottomLeft,
+                                Eigen::AlignedBox2f::BottomRight,
+                                Eigen::AlignedBox2f::TopLeft,
+                                Eigen::AlignedBox2f::TopRight}) {
+        const Eigen::Vector3f Ftx2 =
+            F.transpose() * grid2.Bounds().corner(corner).homogeneous();
+        max_sq_epipolar_line_norm2 = std::max(
+            max_sq_epipolar_line_norm2, Ftx2.head<2>().squaredNorm());
+      }
     }
 
-    THROW_CHECK(guided_filter);
+    // Descriptor norms and dot products are exact in single precision, so the
+    // squared L2 distances are identical to the integer computation.
+    const Eigen::Matrix<float, Eigen::Dynamic, 128, Eigen::RowMajor>
+        descriptors1 = image1.descriptors->cast<float>();
+    const Eigen::Matrix<float, Eigen::Dynamic, 128, Eigen::RowMajor>
+        descriptors2 = image2.descriptors->cast<float>();
+    const Eigen::VectorXf sq_norms1 = descriptors1.rowwise().squaredNorm();
+    const Eigen::VectorXf sq_norms2 = descriptors2.rowwise().squaredNorm();
+
+    std::vector<GuidedMatchCandidate> candidates_1to2(num_keypoints1);
+    std::vector<GuidedMatchCandidate> candidates_2to1(num_keypoints2);
+
+    for (int i1 = 0; i1 < num_keypoints1; ++i1) {
+      const Eigen::Vector3f p1(keypoints1[i1].x, keypoints1[i1].y, 1.0f);
+
+      const auto update_candidates = [&](const int i2) {
+        const float l2_dist =
+            sq_norms1(i1) + sq_norms2(i2) -
+            2 * descriptors1.row(i1).dot(descriptors2.row(i2));
+        candidates_1to2[i1].Update(i2, l2_dist);
+        candidates_2to1[i2].Update(i1, l2_dist);
+      };
+
+      if (is_epipolar) {
+        const Eigen::Vector3f Fx1 = F * p1;
+        const auto update_epipolar_candidates = [&](const int i2) {
+          const Eigen::Vector3f p2(keypoints2[i2].x, keypoints2[i2].y, 1.0f);
+          const Eigen::Vector3f Ftx2 = F.transpose() * p2;
+          const float x2tFx1 = p2.transpose() * Fx1;
+          if (x2tFx1 * x2tFx1 /
+                  (Fx1(0) * Fx1(0) + Fx1(1) * Fx1(1) + Ftx2(0) * Ftx2(0) +
+                   Ftx2(1) * Ftx2(1)) <=
+              max_residual) {
+            update_candidates(i2);
+          }
+        };
+        const float sq_line_norm1 = Fx1(0) * Fx1(0) + Fx1(1) * Fx1(1);
+        if (sq_line_norm1 > 0) {
+          const float half_width = std::sqrt(
+              max_residual * (sq_line_norm1 + max_sq_epipolar_line_norm2) /
+              sq_line_norm1);
+          grid2.ForEachInBand(Fx1, half_width, update_epipolar_candidates);
+        } else {
+          // The first point is the epipole, so the band is not defined.
+          grid2.ForEachInBox(grid2.Bounds().min(),
+                             grid2.Bounds().max(),
+                             update_epipolar_candidates);
+        }
+      } else {
+        const Eigen::Vector2f Hx1 = (H * p1).hnormalized();
+        const Eigen::Vector2f max_offset = Eigen::Vector2f::Constant(max_error);
+        grid2.ForEachInBox(
+            Hx1 - max_offset, Hx1 + max_offset, [&](const int i2) {
+              const Eigen::Vector2f p2(keypoints2[i2].x, keypoints2[i2].y);
+              if ((Hx1 - p2).squaredNorm() <= max_residual) {
+                update_candidates(i2);
+              }
+            });
+      }
+    }
 
-    const Eigen::RowMajorMatrixXf l2_dists_1to2 =
-        ComputeSiftDistanceMatrix(DistanceType::L2,
-                                  image1.keypoints.get(),
-                                  image2.keypoints.get(),
-                                  *image1.descriptors,
-                                  *image2.descriptors,
-                                  guided_filter);
-    const Eigen::RowMajorMatrixXf l2_dists_2to1 = l2_dists_1to2.transpose();
+    FeatureMatches& matches = two_view_geometry->inlier_matches;
 
-    Eigen::RowMajorMatrixXi indices_1to2(l2_dists_1to2.rows(),
-                                         l2_dists_1to2.cols());
-    for (int i = 0; i < indices_1to2.rows(); ++i) {
-      indices_1to2.row(i) = Eigen::VectorXi::LinSpaced(
-          indices_1to2.cols(), 0, indices_1to2.cols() - 1);
-    }
-    Eigen::RowMajorMatrixXi indices_2to1(l2_dists_1to2.cols(),
-                                         l2_dists_1to2.rows());
-    for (int i = 0; i < indices_2to1.rows(); ++i) {
-      indices_2to1.row(i) = Eigen::VectorXi::LinSpaced(
-          indices_2to1.cols(), 0, indices_2to1.cols() - 1);
-    }
+    std::vector<int> matches_1to2;
+    const size_t num_matches_1to2 =
+        FindBestMatchesOneWayGuided(candidates_1to2,
+                                    num_keypoints2,
+                                    options_.sift->max_ratio,
+                                    options_.sift->max_distance,
+                                    &matches_1to2);
 
-    FindBestMatchesIndex(indices_1to2,
-                         l2_dists_1to2,
-                         indices_2to1,
-                         l2_dists_2to1,
-                         options_.sift->max_ratio,
-                         options_.sift->max_distance,
-                         options_.sift->cross_check,
-                         &two_view_geometry->inlier_matches);
+    if (options_.sift->cross_check) {
+      std::vector<int> matches_2to1;
+      const size_t num_matches_2to1 =
+          FindBestMatchesOneWayGuided(candidates_2to1,
+                                      num_keypoints1,
+                                      options_.sift->max_ratio,
+                                      options_.sift->max_distance,
+                                      &matches_2to1);
+      matches.reserve(std::min(num_matches_1to2, num_matches_2to1));
+      for (size_t i1 = 0; i1 < matches_1to2.size(); ++i1) {
+        if (matches_1to2[i1] != -1 && matches_2to1[matches_1to2[i1]] != -1 &&
+            matches_2to1[matches_1to2[i1]] == static_cast<int>(i1)) {
+          matches.emplace_back(i1, matches_1to2[i1]);
+        }
+      }
+    } else {
+      matches.reserve(num_matches_1to2);
+      for (size_t i1 = 0; i1 < matches_1to2.size(); ++i1) {
+        if (matches_1to2[i1] != -1) {
+          matches.emplace_back(i1, matches_1to2[i1]);
+        }
+      }
+    }
   }
 
  private:
@@ -618,6 +618,72 @@ TEST(MatchGuidedSiftFeaturesCPU, Nominal) {
   EXPECT_EQ(two_view_geometry.inlier_matches.size(), 0);
 }
 
+TEST(MatchGuidedSiftFeaturesCPU, Epipolar) {
+  // Rectified stereo pair with horizontal epipolar lines.
+  constexpr int kNumKeypoints = 50;
+  const FeatureDescriptors descriptors =
+      CreateRandomFeatureDescriptors(kNumKeypoints);
+
+  FeatureKeypoints keypoints1;
+  for (int i = 0; i < kNumKeypoints; ++i) {
+    keypoints1.emplace_back(RandomUniformReal<float>(0, 100), 20 * i);
+  }
+
+  // The first half of the keypoints in the second image are the reversed
+  // correspondences on the same epipolar line. The second half are distractors
+  // with identical descriptors but outside of the epipolar band.
+  FeatureKeypoints keypoints2;
+  FeatureDescriptors descriptors2(2 * kNumKeypoints, 128);
+  for (int i = 0; i < kNumKeypoints; ++i) {
+    const int i1 = kNumKeypoints - 1 - i;
+    keypoints2.emplace_back(RandomUniformReal<float>(0, 100),
+                            keypoints1[i1].y);
+    descriptors2.row(i) = descriptors.row(i1);
+  }
+  for (int i = 0; i < kNumKeypoints; ++i) {
+    keypoints2.emplace_back(RandomUniformReal<float>(0, 100),
+                            keypoints1[i].y + 10);
+    descriptors2.row(kNumKeypoints + i) = descriptors.row(i);
+  }
+
+  const FeatureMatcher::Image image1 = {
+      /*image_id=*/1,
+      /*width=*/100,
+      /*height=*/1000,
+      std::make_shared<FeatureKeypoints>(keypoints1),
+      std::make_shared<FeatureDescriptors>(descriptors)};
+  const FeatureMatcher::Image image2 = {
+      /*image_id=*/2,
+      /*width=*/100,
+      /*height=*/1000,
+      std::make_shared<FeatureKeypoints>(keypoints2),
+      std::make_shared<FeatureDescriptors>(descriptors2)};
+
+  FeatureDescriptorIndexCacheHelper index_cache_helper({image1, image2});
+
+  TwoViewGeometry two_view_geometry;
+  two_view_geometry.config = TwoViewGeometry::UNCALIBRATED;
+  two_view_geometry.F << 0, 0, 0, 0, 0, -1, 0, 1, 0;
+
+  FeatureMatchingOptions options(FeatureMatcherType::SIFT);
+  options.use_gpu = false;
+  options.sift->cpu_descriptor_index_cache = &index_cache_helper.index_cache;
+  auto matcher = CreateSiftFeatureMatcher(options);
+
+  constexpr double kMaxError = 4.0;
+
+  matcher->MatchGuided(kMaxError, image1, image2, &two_view_geometry);
+  EXPECT_EQ(two_view_geometry.inlier_matches.size(), kNumKeypoints);
+  for (const FeatureMatch& match : two_view_geometry.inlier_matches) {
+    EXPECT_EQ(match.point2D_idx2, kNumKeypoints - 1 - match.point2D_idx1);
+  }
+
+  // Without a valid geometry, no matches are found.
+  two_view_geometry.config = TwoViewGeometry::DEGENERATE;
+  matcher->MatchGuided(kMaxError, image1, image2, &two_view_geometry);
+  EXPECT_EQ(two_view_geometry.inlier_matches.size(), 0);
+}
+
 TEST(MatchSiftFeaturesGPU, Nominal) {
   char app_name[] = "Test";
   int argc = 1;
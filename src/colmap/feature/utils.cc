@@ -42,6 +42,21 @@ std::vector<Eigen::Vector2d> FeatureKeypointsToPointsVector(
   return points;
 }
 
+std::vector<Eigen::Vector3d> PointsVectorToCamRays(
+    const Camera& camera, const std::vector<Eigen::Vector2d>& points) {
+  std::vector<Eigen::Vector3d> cam_rays(points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (const std::optional<Eigen::Vector2d> cam_point =
+            camera.CamFromImg(points[i]);
+        cam_point) {
+      cam_rays[i] = cam_point->homogeneous().normalized();
+    } else {
+      cam_rays[i].setZero();
+    }
+  }
+  return cam_rays;
+}
+
 void L2NormalizeFeatureDescriptors(FeatureDescriptorsFloat* descriptors) {
   descriptors->rowwise().normalize();
 }
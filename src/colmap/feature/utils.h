@@ -30,6 +30,7 @@
 #pragma once
 
 #include "colmap/feature/types.h"
+#include "colmap/scene/camera.h"
 
 namespace colmap {
 
@@ -37,6 +38,12 @@ namespace colmap {
 std::vector<Eigen::Vector2d> FeatureKeypointsToPointsVector(
     const FeatureKeypoints& keypoints);
 
+// Lift image points to normalized camera rays with unit norm. Points that
+// cannot be lifted (e.g., outside the valid range of the distortion model) are
+// mapped to zero rays, which are rejected as outliers by the estimators.
+std::vector<Eigen::Vector3d> PointsVectorToCamRays(
+    const Camera& camera, const std::vector<Eigen::Vector2d>& points);
+
 // L2-normalize feature descriptor, where each row represents one feature.
 void L2NormalizeFeatureDescriptors(FeatureDescriptorsFloat* descriptors);
 
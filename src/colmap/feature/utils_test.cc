@@ -29,6 +29,9 @@
 
 #include "colmap/feature/utils.h"
 
+#include "colmap/util/eigen_matchers.h"
+
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 namespace colmap {
@@ -44,6 +47,24 @@ TEST(FeatureKeypointsToPointsVector, Nominal) {
   EXPECT_EQ(points[1].cast<float>(), Eigen::Vector2f(0.1, 0.2));
 }
 
+TEST(PointsVectorToCamRays, Nominal) {
+  const Camera camera = Camera::CreateFromModelId(
+      1, CameraModelId::kSimpleRadial, 100, 200, 100);
+  const std::vector<Eigen::Vector2d> points = {Eigen::Vector2d(100, 50),
+                                               Eigen::Vector2d(10, 20)};
+  const std::vector<Eigen::Vector3d> cam_rays =
+      PointsVectorToCamRays(camera, points);
+  ASSERT_EQ(cam_rays.size(), points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_NEAR(cam_rays[i].norm(), 1, 1e-12);
+    EXPECT_THAT(
+        cam_rays[i],
+        EigenMatrixNear(
+            camera.CamFromImg(points[i])->homogeneous().normalized().eval(),
+            1e-12));
+  }
+}
+
 TEST(L2NormalizeFeatureDescriptors, Nominal) {
   FeatureDescriptorsFloat descriptors = Eigen::MatrixXf::Random(100, 128);
   descriptors.array() += 1.0f;
@@ -40,11 +40,11 @@ namespace colmap {
 Eigen::Matrix3d ComputeClosestRotationMatrix(const Eigen::Matrix3d& matrix) {
   const Eigen::JacobiSVD<Eigen::Matrix3d> svd(
       matrix, Eigen::ComputeFullU | Eigen::ComputeFullV);
-  Eigen::Matrix3d R = svd.matrixU() * (svd.matrixV().transpose());
-  if (R.determinant() < 0.0) {
-    R *= -1.0;
+  Eigen::Matrix3d U = svd.matrixU();
+  if ((U * svd.matrixV().transpose()).determinant() < 0.0) {
+    U.col(2) *= -1.0;
   }
-  return R;
+  return U * svd.matrixV().transpose();
 }
 
 bool DecomposeProjectionMatrix(const Eigen::Matrix3x4d& P,
@@ -55,7 +55,9 @@ bool DecomposeProjectionMatrix(const Eigen::Matrix3x4d& P,
   Eigen::Matrix3d QQ;
   DecomposeMatrixRQ(P.leftCols<3>().eval(), &RR, &QQ);
 
-  *R = ComputeClosestRotationMatrix(QQ);
+  // QQ is orthogonal, so a reflection is turned into a rotation by negation,
+  // which is compensated by the sign of K below.
+  *R = QQ.determinant() < 0 ? (-QQ).eval() : QQ;
 
   const double det_K = RR.determinant();
   if (det_K == 0) {
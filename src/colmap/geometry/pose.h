@@ -40,8 +40,9 @@
 
 namespace colmap {
 
-// Compute the closes rotation matrix with the closest Frobenius norm by setting
-// the singular values of the given matrix to 1.
+// Compute the rotation matrix with the closest Frobenius norm by setting the
+// singular values of the given matrix to 1. If the closest orthogonal matrix
+// is a reflection, the sign of the smallest singular value is flipped.
 Eigen::Matrix3d ComputeClosestRotationMatrix(const Eigen::Matrix3d& matrix);
 
 // Decompose projection matrix into intrinsic camera matrix, rotation matrix and
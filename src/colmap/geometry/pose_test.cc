@@ -45,6 +45,15 @@ TEST(ComputeClosestRotationMatrix, Nominal) {
   EXPECT_LT((ComputeClosestRotationMatrix(2 * A) - A).norm(), 1e-6);
 }
 
+TEST(ComputeClosestRotationMatrix, NegativeDeterminant) {
+  const Eigen::Matrix3d A =
+      Eigen::Quaterniond::UnitRandom().toRotationMatrix();
+  const Eigen::Matrix3d R =
+      ComputeClosestRotationMatrix(A * Eigen::Vector3d(3, 2, -1).asDiagonal());
+  EXPECT_NEAR(R.determinant(), 1, 1e-6);
+  EXPECT_LT((R - A).norm(), 1e-6);
+}
+
 TEST(DecomposeProjectionMatrix, Nominal) {
   for (int i = 1; i < 100; ++i) {
     Eigen::Matrix3d ref_K = i * Eigen::Matrix3d::Identity();
@@ -31,6 +31,11 @@
 
 #include "colmap/util/eigen_alignment.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
 #include <Eigen/Core>
 
 namespace colmap {
@@ -91,6 +96,17 @@ bool FindPolynomialRootsCompanionMatrix(const Eigen::VectorXd& coeffs,
                                         Eigen::VectorXd* real,
                                         Eigen::VectorXd* imag);
 
+// Find the real roots of a polynomial of fixed degree N using a Sturm sequence
+// to isolate the roots, which are then refined by safeguarded Newton
+// iterations. Compared to the companion matrix method, this method only
+// computes the real roots, does not allocate memory, and is much faster.
+// Multiple roots are only reported once. Leading zero coefficients are
+// removed, such that the polynomial may be of lower degree than N. Returns the
+// number of roots, which are stored in ascending order.
+template <int N>
+int FindRealPolynomialRootsSturm(const Eigen::Matrix<double, N + 1, 1>& coeffs,
+                                 Eigen::Matrix<double, N, 1>* roots);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
@@ -104,4 +120,272 @@ T EvaluatePolynomial(const Eigen::VectorXd& coeffs, const T& x) {
   return value;
 }
 
+namespace internal {
+
+template <int N>
+class SturmSequence {
+ public:
+  explicit SturmSequence(const Eigen::Matrix<double, N + 1, 1>& coeffs);
+
+  // Upper bound on the absolute value of all roots.
+  double RootBound() const;
+
+  // Number of sign changes in the sequence evaluated at x.
+  int NumSignChanges(double x) const;
+
+  // Evaluate the polynomial and its derivative at x.
+  void Evaluate(double x, double* value, double* derivative) const;
+
+ private:
+  double EvaluatePolynomial(int idx, double x) const;
+
+  int num_polys_ = 0;
+  std::array<int, N + 1> degrees_;
+  // The i-th row holds the degrees_[i] + 1 coefficients of the i-th
+  // polynomial of the sequence, starting with the highest order coefficient.
+  Eigen::Matrix<double, N + 1, N + 1, Eigen::RowMajor> polys_;
+};
+
+template <int N>
+SturmSequence<N>::SturmSequence(const Eigen::Matrix<double, N + 1, 1>& coeffs) {
+  static_assert(N >= 1);
+
+  // The polynomial and its derivative.
+  degrees_[0] = N;
+  polys_.row(0) = coeffs.transpose() / coeffs(0);
+  degrees_[1] = N - 1;
+  for (int i = 0; i < N; ++i) {
+    polys_(1, i) = (N - i) * polys_(0, i) / N;
+  }
+  num_polys_ = 2;
+
+  // Negated remainders of the polynomial division of the previous two
+  // polynomials until the remainder vanishes or is constant.
+  Eigen::Matrix<double, 1, N + 1> rem;
+  while (degrees_[num_polys_ - 1] > 0) {
+    const int prev_degree = degrees_[num_polys_ - 2];
+    const int degree = degrees_[num_polys_ - 1];
+    double scale = 0;
+    for (int i = 0; i <= prev_degree; ++i) {
+      rem(i) = polys_(num_polys_ - 2, i);
+      scale = std::max(scale, std::abs(rem(i)));
+    }
+    for (int i = 0; i <= prev_degree - degree; ++i) {
+      const double factor = rem(i) / polys_(num_polys_ - 1, 0);
+      for (int j = 0; j <= degree; ++j) {
+        rem(i + j) -= factor * polys_(num_polys_ - 1, j);
+      }
+    }
+
+    // The remainder is stored in the last `degree` coefficients. Strip
+    // leading coefficients that vanish relative to the previous polynomial.
+    const double kEps = 1e-13;
+    int rem_beg = prev_degree - degree + 1;
+    while (rem_beg <= prev_degree && std::abs(rem(rem_beg)) <= kEps * scale) {
+      ++rem_beg;
+    }
+    if (rem_beg > prev_degree) {
+      break;
+    }
+
+    const int rem_degree = prev_degree - rem_beg;
+    double rem_norm = 0;
+    for (int i = rem_beg; i <= prev_degree; ++i) {
+      rem_norm = std::max(rem_norm, std::abs(rem(i)));
+    }
+    degrees_[num_polys_] = rem_degree;
+    for (int i = 0; i <= rem_degree; ++i) {
+      polys_(num_polys_, i) = -rem(rem_beg + i) / rem_norm;
+    }
+    ++num_polys_;
+  }
+}
+
+template <int N>
+double SturmSequence<N>::RootBound() const {
+  // Cauchy's bound for the monic polynomial.
+  return 1 + polys_.row(0).tail(N).cwiseAbs().maxCoeff();
+}
+
+template <int N>
+int SturmSequence<N>::NumSignChanges(const double x) const {
+  int num_sign_changes = 0;
+  double prev_value = 0;
+  for (int i = 0; i < num_polys_; ++i) {
+    const double value = EvaluatePolynomial(i, x);
+    if (value == 0) {
+      continue;
+    }
+    if ((value < 0) != (prev_value < 0) && prev_value != 0) {
+      ++num_sign_changes;
+    }
+    prev_value = value;
+  }
+  return num_sign_changes;
+}
+
+template <int N>
+void SturmSequence<N>::Evaluate(const double x,
+                                double* value,
+                                double* derivative) const {
+  *value = EvaluatePolynomial(0, x);
+  *derivative = N * EvaluatePolynomial(1, x);
+}
+
+template <int N>
+double SturmSequence<N>::EvaluatePolynomial(const int idx,
+                                            const double x) const {
+  double value = polys_(idx, 0);
+  for (int i = 1; i <= degrees_[idx]; ++i) {
+    value = value * x + polys_(idx, i);
+  }
+  return value;
+}
+
+// Refine the single root of the polynomial in the interval (lower, upper),
+// where the polynomial changes its sign, using Newton iterations that fall back
+// to bisection, whenever a step leaves the bracketing interval or does not
+// shrink it fast enough.
+template <int N>
+double RefineSturmRoot(const SturmSequence<N>& sturm_seq,
+                       double lower,
+                       double upper) {
+  const int kMaxNumIterations = 200;
+  const double kTol = 4 * std::numeric_limits<double>::epsilon();
+  double lower_value;
+  double derivative;
+  sturm_seq.Evaluate(lower, &lower_value, &derivative);
+  double x = 0.5 * (lower + upper);
+  double step = upper - lower;
+  double prev_step = step;
+  double value;
+  sturm_seq.Evaluate(x, &value, &derivative);
+  for (int iter = 0; iter < kMaxNumIterations; ++iter) {
+    if (value == 0) {
+      return x;
+    }
+    if ((value < 0) == (lower_value < 0)) {
+      lower = x;
+      lower_value = value;
+    } else {
+      upper = x;
+    }
+
+    const double newton_x = x - value / derivative;
+    if (newton_x > lower && newton_x < upper &&
+        std::abs(2 * value) <= std::abs(prev_step * derivative)) {
+      prev_step = step;
+      step = x - newton_x;
+      x = newton_x;
+    } else {
+      prev_step = step;
+      step = 0.5 * (upper - lower);
+      x = lower + step;
+    }
+
+    if (std::abs(step) <= kTol * std::max(1.0, std::abs(x))) {
+      return x;
+    }
+
+    sturm_seq.Evaluate(x, &value, &derivative);
+  }
+  return x;
+}
+
+// Recursively bisect the interval (lower, upper] until each sub-interval
+// contains a single root according to the Sturm sequence.
+template <int N>
+void IsolateSturmRoots(const SturmSequence<N>& sturm_seq,
+                       const double lower,
+                       const double upper,
+                       const int lower_num_sign_changes,
+                       const int upper_num_sign_changes,
+                       const int depth,
+                       Eigen::Matrix<double, N, 1>* roots,
+                       int* num_roots) {
+  const int num_interval_roots =
+      lower_num_sign_changes - upper_num_sign_changes;
+  if (num_interval_roots <= 0 || *num_roots >= N) {
+    return;
+  }
+
+  const int kMaxDepth = 100;
+  const double kTol = 4 * std::numeric_limits<double>::epsilon();
+  const double mid = 0.5 * (lower + upper);
+  if (depth >= kMaxDepth ||
+      upper - lower <= kTol * std::max(1.0, std::abs(mid))) {
+    // Cluster of roots that cannot be separated numerically.
+    (*roots)(*num_roots) = mid;
+    ++*num_roots;
+    return;
+  }
+
+  if (num_interval_roots == 1) {
+    double lower_value;
+    double upper_value;
+    double derivative;
+    sturm_seq.Evaluate(lower, &lower_value, &derivative);
+    sturm_seq.Evaluate(upper, &upper_value, &derivative);
+    if (upper_value == 0) {
+      (*roots)(*num_roots) = upper;
+      ++*num_roots;
+      return;
+    }
+    if ((lower_value < 0) != (upper_value < 0)) {
+      (*roots)(*num_roots) = RefineSturmRoot(sturm_seq, lower, upper);
+      ++*num_roots;
+      return;
+    }
+  }
+
+  const int mid_num_sign_changes = sturm_seq.NumSignChanges(mid);
+  IsolateSturmRoots(sturm_seq,
+                    lower,
+                    mid,
+                    lower_num_sign_changes,
+                    mid_num_sign_changes,
+                    depth + 1,
+                    roots,
+                    num_roots);
+  IsolateSturmRoots(sturm_seq,
+                    mid,
+                    upper,
+                    mid_num_sign_changes,
+                    upper_num_sign_changes,
+                    depth + 1,
+                    roots,
+                    num_roots);
+}
+
+}  // namespace internal
+
+template <int N>
+int FindRealPolynomialRootsSturm(const Eigen::Matrix<double, N + 1, 1>& coeffs,
+                                 Eigen::Matrix<double, N, 1>* roots) {
+  if (coeffs(0) == 0) {
+    if constexpr (N > 1) {
+      Eigen::Matrix<double, N - 1, 1> lower_roots;
+      const int num_roots = FindRealPolynomialRootsSturm<N - 1>(
+          coeffs.template tail<N>().eval(), &lower_roots);
+      roots->head(num_roots) = lower_roots.head(num_roots);
+      return num_roots;
+    } else {
+      return 0;
+    }
+  }
+
+  const internal::SturmSequence<N> sturm_seq(coeffs);
+  const double bound = sturm_seq.RootBound();
+  int num_roots = 0;
+  internal::IsolateSturmRoots(sturm_seq,
+                              -bound,
+                              bound,
+                              sturm_seq.NumSignChanges(-bound),
+                              sturm_seq.NumSignChanges(bound),
+                              /*depth=*/0,
+                              roots,
+                              &num_roots);
+  return num_roots;
+}
+
 }  // namespace colmap
@@ -31,6 +31,8 @@
 
 #include "colmap/util/eigen_matchers.h"
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 
 namespace colmap {
@@ -243,5 +245,85 @@ TEST(FindPolynomialRootsCompanionMatrixZeroSolution, Nominal) {
   EXPECT_THAT(imag, EigenMatrixNear(ref_imag, 1e-6));
 }
 
+TEST(FindRealPolynomialRootsSturm, Nominal) {
+  // (x - 1) * (x + 2) * (x - 0.5) * (x^2 + 1)
+  Eigen::Matrix<double, 6, 1> coeffs;
+  coeffs << 1, 0.5, -1.5, 1.5, -2.5, 1;
+  Eigen::Matrix<double, 5, 1> roots;
+  ASSERT_EQ(FindRealPolynomialRootsSturm<5>(coeffs, &roots), 3);
+  EXPECT_NEAR(roots(0), -2, 1e-12);
+  EXPECT_NEAR(roots(1), 0.5, 1e-12);
+  EXPECT_NEAR(roots(2), 1, 1e-12);
+
+  // Scaling of the coefficients does not change the roots.
+  Eigen::Matrix<double, 5, 1> scaled_roots;
+  ASSERT_EQ(FindRealPolynomialRootsSturm<5>(-3 * coeffs, &scaled_roots), 3);
+  EXPECT_THAT(scaled_roots.head<3>(), EigenMatrixNear(roots.head<3>(), 1e-12));
+}
+
+TEST(FindRealPolynomialRootsSturm, MultipleRoots) {
+  // (x - 1)^2 * (x + 1)
+  Eigen::Vector4d coeffs(1, -1, -1, 1);
+  Eigen::Vector3d roots;
+  ASSERT_EQ(FindRealPolynomialRootsSturm<3>(coeffs, &roots), 2);
+  EXPECT_NEAR(roots(0), -1, 1e-12);
+  EXPECT_NEAR(roots(1), 1, 1e-8);
+}
+
+TEST(FindRealPolynomialRootsSturm, NoRealRoots) {
+  Eigen::Vector3d coeffs(1, 0, 1);
+  Eigen::Vector2d roots;
+  EXPECT_EQ(FindRealPolynomialRootsSturm<2>(coeffs, &roots), 0);
+  EXPECT_EQ(FindRealPolynomialRootsSturm<2>(Eigen::Vector3d(0, 0, 1), &roots),
+            0);
+  EXPECT_EQ(FindRealPolynomialRootsSturm<2>(Eigen::Vector3d::Zero(), &roots),
+            0);
+}
+
+TEST(FindRealPolynomialRootsSturm, LeadingZeros) {
+  // (x - 1) * (x + 2) * (x - 0.5)
+  Eigen::Matrix<double, 6, 1> coeffs;
+  coeffs << 0, 0, 1, 0.5, -2.5, 1;
+  Eigen::Matrix<double, 5, 1> roots;
+  ASSERT_EQ(FindRealPolynomialRootsSturm<5>(coeffs, &roots), 3);
+  EXPECT_NEAR(roots(0), -2, 1e-12);
+  EXPECT_NEAR(roots(1), 0.5, 1e-12);
+  EXPECT_NEAR(roots(2), 1, 1e-12);
+
+  Eigen::Vector2d linear_roots;
+  ASSERT_EQ(
+      FindRealPolynomialRootsSturm<2>(Eigen::Vector3d(0, 2, 1), &linear_roots),
+      1);
+  EXPECT_NEAR(linear_roots(0), -0.5, 1e-12);
+}
+
+TEST(FindRealPolynomialRootsSturm, CompareCompanionMatrix) {
+  for (int i = 0; i < 100; ++i) {
+    const Eigen::Matrix<double, 11, 1> coeffs =
+        Eigen::Matrix<double, 11, 1>::Random();
+    Eigen::Matrix<double, 10, 1> roots;
+    const int num_roots = FindRealPolynomialRootsSturm<10>(coeffs, &roots);
+
+    Eigen::VectorXd real;
+    Eigen::VectorXd imag;
+    ASSERT_TRUE(FindPolynomialRootsCompanionMatrix(coeffs, &real, &imag));
+    std::vector<double> ref_roots;
+    for (int j = 0; j < real.size(); ++j) {
+      if (std::abs(imag(j)) < 1e-10) {
+        ref_roots.push_back(real(j));
+      }
+    }
+    std::sort(ref_roots.begin(), ref_roots.end());
+
+    ASSERT_EQ(num_roots, ref_roots.size());
+    for (int j = 0; j < num_roots; ++j) {
+      EXPECT_NEAR(roots(j), ref_roots[j], 1e-8);
+      EXPECT_LT(std::abs(EvaluatePolynomial(coeffs, roots(j))),
+                1e-12 * EvaluatePolynomial(coeffs.cwiseAbs().eval(),
+                                           std::abs(roots(j))));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace colmap
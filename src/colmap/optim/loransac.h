@@ -131,6 +131,7 @@ LORANSAC<Estimator, LocalEstimator, SupportMeasurer, Sampler>::Estimate(
 
   std::vector<double> residuals;
   std::vector<double> best_local_residuals;
+  std::vector<std::vector<double>> sample_residuals;
 
   std::vector<typename LocalEstimator::X_t> X_inlier;
   std::vector<typename LocalEstimator::Y_t> Y_inlier;
@@ -159,15 +160,38 @@ LORANSAC<Estimator, LocalEstimator, SupportMeasurer, Sampler>::Estimate(
     // Estimate model for current subset.
     estimator.Estimate(X_rand, Y_rand, &sample_models);
 
+    if constexpr (has_batched_residuals<Estimator>::value) {
+      estimator.BatchedResiduals(
+          X,
+          Y,
+          sample_models,
+          max_residual,
+          RANSAC<Estimator, SupportMeasurer, Sampler>::MinNumInliersToImprove(
+              best_support),
+          &sample_residuals);
+      THROW_CHECK_EQ(sample_residuals.size(), sample_models.size());
+    }
+
     // Iterate through all estimated models
-    for (const auto& sample_model : sample_models) {
-      estimator.Residuals(X, Y, sample_model, &residuals);
-      THROW_CHECK_EQ(residuals.size(), num_samples);
+    for (size_t model_idx = 0; model_idx < sample_models.size(); ++model_idx) {
+      const auto& sample_model = sample_models[model_idx];
+      if constexpr (has_batched_residuals<Estimator>::value) {
+        residuals.swap(sample_residuals[model_idx]);
+      } else {
+        estimator.Residuals(X, Y, sample_model, &residuals);
+      }
+
+      // Models rejected early by the batched residuals cannot improve on the
+      // best support and are not evaluated.
+      const bool rejected = residuals.empty();
+      THROW_CHECK(rejected || residuals.size() == num_samples);
 
-      const auto support = support_measurer.Evaluate(residuals, max_residual);
+      const auto support =
+          rejected ? typename SupportMeasurer::Support()
+                   : support_measurer.Evaluate(residuals, max_residual);
 
       // Do local optimization if better than all previous subsets.
-      if (support_measurer.IsLeftBetter(support, best_support)) {
+      if (!rejected && support_measurer.IsLeftBetter(support, best_support)) {
         best_support = support;
         best_model = sample_model;
         best_model_is_local = false;
@@ -30,8 +30,12 @@
 #include "colmap/optim/loransac.h"
 
 #include "colmap/estimators/similarity_transform.h"
+#include "colmap/geometry/sim3.h"
+#include "colmap/math/random.h"
 #include "colmap/util/eigen_alignment.h"
 
+#include <algorithm>
+
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 #include <gtest/gtest.h>
@@ -39,6 +43,31 @@
 namespace colmap {
 namespace {
 
+// Estimator with a naive batched residual computation to verify that batched
+// scoring and early rejection of models do not change the estimation result.
+class BatchedSimilarityTransformEstimator
+    : public SimilarityTransformEstimator<3> {
+ public:
+  void BatchedResiduals(const std::vector<X_t>& src,
+                        const std::vector<Y_t>& tgt,
+                        const std::vector<M_t>& tgt_from_src,
+                        double max_residual,
+                        size_t min_num_inliers,
+                        std::vector<std::vector<double>>* residuals) const {
+    residuals->resize(tgt_from_src.size());
+    for (size_t i = 0; i < tgt_from_src.size(); ++i) {
+      Residuals(src, tgt, tgt_from_src[i], &(*residuals)[i]);
+      const size_t num_inliers = std::count_if(
+          (*residuals)[i].begin(),
+          (*residuals)[i].end(),
+          [max_residual](double residual) { return residual <= max_residual; });
+      if (num_inliers < min_num_inliers) {
+        (*residuals)[i].clear();
+      }
+    }
+  }
+};
+
 TEST(LORANSAC, Report) {
   LORANSAC<SimilarityTransformEstimator<3>,
            SimilarityTransformEstimator<3>>::Report report;
@@ -49,5 +78,46 @@ TEST(LORANSAC, Report) {
   EXPECT_EQ(report.inlier_mask.size(), 0);
 }
 
+TEST(LORANSAC, BatchedResiduals) {
+  const size_t num_samples = 1000;
+  const size_t num_outliers = 400;
+
+  const Sim3d expected_tgt_from_src(
+      2, Eigen::Quaterniond::UnitRandom(), Eigen::Vector3d(100, 10, 10));
+
+  std::vector<Eigen::Vector3d> src;
+  std::vector<Eigen::Vector3d> tgt;
+  for (size_t i = 0; i < num_samples; ++i) {
+    src.emplace_back(i, std::sqrt(i) + 2, std::sqrt(2 * i + 2));
+    tgt.push_back(expected_tgt_from_src * src.back() +
+                  Eigen::Vector3d::Random());
+  }
+
+  for (size_t i = 0; i < num_outliers; ++i) {
+    tgt[i] = Eigen::Vector3d(RandomUniformReal(-3000.0, -2000.0),
+                             RandomUniformReal(-4000.0, -3000.0),
+                             RandomUniformReal(-5000.0, -4000.0));
+  }
+
+  RANSACOptions options;
+  options.max_error = 10;
+  options.random_seed = 42;
+  LORANSAC<SimilarityTransformEstimator<3>, SimilarityTransformEstimator<3>>
+      loransac(options);
+  const auto report = loransac.Estimate(src, tgt);
+  LORANSAC<BatchedSimilarityTransformEstimator,
+           SimilarityTransformEstimator<3>>
+      batched_loransac(options);
+  const auto batched_report = batched_loransac.Estimate(src, tgt);
+
+  ASSERT_TRUE(report.success);
+  ASSERT_TRUE(batched_report.success);
+  EXPECT_EQ(report.num_trials, batched_report.num_trials);
+  EXPECT_EQ(report.support.num_inliers, batched_report.support.num_inliers);
+  EXPECT_EQ(report.support.residual_sum, batched_report.support.residual_sum);
+  EXPECT_EQ(report.inlier_mask, batched_report.inlier_mask);
+  EXPECT_EQ(report.model, batched_report.model);
+}
+
 }  // namespace
 }  // namespace colmap
@@ -36,6 +36,7 @@
 
 #include <cfloat>
 #include <optional>
+#include <type_traits>
 #include <vector>
 
 namespace colmap {
@@ -76,6 +77,33 @@ struct RANSACOptions {
   }
 };
 
+// Estimators can optionally score all models estimated from one minimal sample
+// together by implementing:
+//
+//    void BatchedResiduals(const std::vector<X_t>& X,
+//                          const std::vector<Y_t>& Y,
+//                          const std::vector<M_t>& models,
+//                          double max_residual,
+//                          size_t min_num_inliers,
+//                          std::vector<std::vector<double>>* residuals) const;
+//
+// The residuals of a model may be left empty, if it has provably fewer than
+// `min_num_inliers` residuals smaller or equal to `max_residual`.
+template <typename Estimator, typename = void>
+struct has_batched_residuals : std::false_type {};
+
+template <typename Estimator>
+struct has_batched_residuals<
+    Estimator,
+    std::void_t<decltype(std::declval<const Estimator&>().BatchedResiduals(
+        std::declval<const std::vector<typename Estimator::X_t>&>(),
+        std::declval<const std::vector<typename Estimator::Y_t>&>(),
+        std::declval<const std::vector<typename Estimator::M_t>&>(),
+        std::declval<double>(),
+        std::declval<size_t>(),
+        std::declval<std::vector<std::vector<double>>*>()))>>
+    : std::true_type {};
+
 template <typename Estimator,
           typename SupportMeasurer = InlierSupportMeasurer,
           typename Sampler = RandomSampler>
@@ -132,6 +160,12 @@ class RANSAC {
   Sampler sampler;
 
  protected:
+  // Minimum number of inliers required for a model to possibly have better
+  // support than the given one. Zero, if the support measure does not allow
+  // to reject models based on their number of inliers.
+  static size_t MinNumInliersToImprove(
+      const typename SupportMeasurer::Support& support);
+
   RANSACOptions options_;
 };
 
@@ -196,6 +230,20 @@ size_t RANSAC<Estimator, SupportMeasurer, Sampler>::ComputeNumTrials(
       std::log(prob_failure) / std::log(prob_outlier) * num_trials_multiplier));
 }
 
+template <typename Estimator, typename SupportMeasurer, typename Sampler>
+size_t RANSAC<Estimator, SupportMeasurer, Sampler>::MinNumInliersToImprove(
+    const typename SupportMeasurer::Support& support) {
+  if constexpr (std::is_same_v<SupportMeasurer, InlierSupportMeasurer>) {
+    return support.num_inliers;
+  } else if constexpr (std::is_same_v<SupportMeasurer,
+                                      UniqueInlierSupportMeasurer>) {
+    // The number of unique inliers is bounded by the number of inliers.
+    return support.num_unique_inliers;
+  } else {
+    return 0;
+  }
+}
+
 template <typename Estimator, typename SupportMeasurer, typename Sampler>
 typename RANSAC<Estimator, SupportMeasurer, Sampler>::Report
 RANSAC<Estimator, SupportMeasurer, Sampler>::Estimate(
@@ -227,6 +275,7 @@ RANSAC<Estimator, SupportMeasurer, Sampler>::Estimate(
   const double max_residual = options_.max_error * options_.max_error;
 
   std::vector<double> residuals(num_samples);
+  std::vector<std::vector<double>> sample_residuals;
 
   std::vector<typename Estimator::X_t> X_rand(Estimator::kMinNumSamples);
   std::vector<typename Estimator::Y_t> Y_rand(Estimator::kMinNumSamples);
@@ -251,15 +300,36 @@ RANSAC<Estimator, SupportMeasurer, Sampler>::Estimate(
     // Estimate model for current subset.
     estimator.Estimate(X_rand, Y_rand, &sample_models);
 
+    if constexpr (has_batched_residuals<Estimator>::value) {
+      estimator.BatchedResiduals(X,
+                                 Y,
+                                 sample_models,
+                                 max_residual,
+                                 MinNumInliersToImprove(best_support),
+                                 &sample_residuals);
+      THROW_CHECK_EQ(sample_residuals.size(), sample_models.size());
+    }
+
     // Iterate through all estimated models.
-    for (const auto& sample_model : sample_models) {
-      estimator.Residuals(X, Y, sample_model, &residuals);
-      THROW_CHECK_EQ(residuals.size(), num_samples);
+    for (size_t model_idx = 0; model_idx < sample_models.size(); ++model_idx) {
+      const auto& sample_model = sample_models[model_idx];
+      if constexpr (has_batched_residuals<Estimator>::value) {
+        residuals.swap(sample_residuals[model_idx]);
+      } else {
+        estimator.Residuals(X, Y, sample_model, &residuals);
+      }
+
+      // Models rejected early by the batched residuals cannot improve on the
+      // best support and are not evaluated.
+      const bool rejected = residuals.empty();
+      THROW_CHECK(rejected || residuals.size() == num_samples);
 
-      const auto support = support_measurer.Evaluate(residuals, max_residual);
+      const auto support =
+          rejected ? typename SupportMeasurer::Support()
+                   : support_measurer.Evaluate(residuals, max_residual);
 
       // Save as best subset if better than all previous subsets.
-      if (support_measurer.IsLeftBetter(support, best_support)) {
+      if (!rejected && support_measurer.IsLeftBetter(support, best_support)) {
         best_support = support;
         best_model = sample_model;
 
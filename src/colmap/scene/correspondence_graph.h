@@ -78,6 +78,10 @@ class CorrespondenceGraph {
   // Get the number of correspondences per image.
   inline point2D_t NumCorrespondencesForImage(image_t image_id) const;
 
+  // Get the number of image points in an image, including the points without
+  // any correspondences.
+  inline point2D_t NumPoints2DForImage(image_t image_id) const;
+
   // Get the number of correspondences between a pair of images.
   inline point2D_t NumCorrespondencesBetweenImages(image_t image_id1,
                                                    image_t image_id2) const;
@@ -211,6 +215,17 @@ point2D_t CorrespondenceGraph::NumCorrespondencesForImage(
   }
 }
 
+point2D_t CorrespondenceGraph::NumPoints2DForImage(
+    const image_t image_id) const {
+  try {
+    const Image& image = images_.at(image_id);
+    return finalized_ ? image.flat_corr_begs.size() - 1 : image.corrs.size();
+  } catch (const std::out_of_range&) {
+    throw std::out_of_range(
+        StringPrintf("Image with ID %d does not exist", image_id));
+  }
+}
+
 point2D_t CorrespondenceGraph::NumCorrespondencesBetweenImages(
     const image_t image_id1, const image_t image_id2) const {
   const image_pair_t pair_id = ImagePairToPairId(image_id1, image_id2);
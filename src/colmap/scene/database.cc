@@ -440,6 +440,10 @@ void Database::Open(const std::string& path) {
   // Use faster journaling mode
   SQLITE3_EXEC(database_, "PRAGMA journal_mode=WAL", nullptr);
 
+  // Wait for the locks of other connections instead of failing immediately,
+  // e.g., when extracting and matching features concurrently.
+  SQLITE3_CALL(sqlite3_busy_timeout(database_, 60000));
+
   // Store temporary tables and indices in memory
   SQLITE3_EXEC(database_, "PRAGMA temp_store=MEMORY", nullptr);
 
@@ -2094,11 +2098,21 @@ size_t Database::MaxColumn(const std::string& column,
 }
 
 DatabaseTransaction::DatabaseTransaction(Database* database)
-    : database_(database), database_lock_(database->transaction_mutex_) {
+    : database_(database) {
   THROW_CHECK_NOTNULL(database_);
+  if (database_->transaction_thread_id_ == std::this_thread::get_id()) {
+    return;
+  }
+  database_lock_ = std::unique_lock<std::mutex>(database_->transaction_mutex_);
+  database_->transaction_thread_id_ = std::this_thread::get_id();
   database_->BeginTransaction();
 }
 
-DatabaseTransaction::~DatabaseTransaction() { database_->EndTransaction(); }
+DatabaseTransaction::~DatabaseTransaction() {
+  if (database_lock_.owns_lock()) {
+    database_->transaction_thread_id_ = std::thread::id();
+    database_->EndTransaction();
+  }
+}
 
 }  // namespace colmap
@@ -38,7 +38,9 @@
 #include "colmap/util/eigen_alignment.h"
 #include "colmap/util/types.h"
 
+#include <atomic>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 #include <Eigen/Core>
@@ -275,6 +277,11 @@ class Database {
                     const Database& database2,
                     Database* merged_database);
 
+  // Mutex for callers that access the same database from multiple threads,
+  // e.g., the Python bindings, to serialize the use of the shared SQL
+  // statements. The database itself does not lock it.
+  std::mutex& StatementMutex() const { return statement_mutex_; }
+
  private:
   friend class DatabaseTransaction;
 
@@ -335,6 +342,11 @@ class Database {
 
   // Used to ensure that only one transaction is active at the same time.
   std::mutex transaction_mutex_;
+  // The thread owning the active transaction, whose nested transactions are
+  // merged into the active transaction.
+  std::atomic<std::thread::id> transaction_thread_id_;
+
+  mutable std::mutex statement_mutex_;
 
   // A collection of all `sqlite3_stmt` objects for deletion in the destructor.
   std::vector<sqlite3_stmt*> sql_stmts_;
@@ -418,7 +430,8 @@ class Database {
 
 // This class automatically manages the scope of a database transaction by
 // calling `BeginTransaction` and `EndTransaction` during construction and
-// destruction, respectively.
+// destruction, respectively. A transaction created while the same thread
+// already owns a transaction is part of the outer transaction.
 class DatabaseTransaction {
  public:
   explicit DatabaseTransaction(Database* database);
@@ -135,8 +135,39 @@ void DatabaseCache::Load(const Database& database,
   timer.Restart();
   LOG(INFO) << "Loading matches...";
 
-  const std::vector<std::pair<image_pair_t, TwoViewGeometry>>
-      two_view_geometries = database.ReadTwoViewGeometries();
+  std::vector<std::pair<image_pair_t, TwoViewGeometry>> two_view_geometries;
+  if (image_names.empty()) {
+    two_view_geometries = database.ReadTwoViewGeometries();
+  } else {
+    // Only read the two-view geometries between the frames of the selected
+    // images. For large databases, reading all geometries otherwise dominates
+    // the loading time when only a small subset of images is selected.
+    auto GetFrameId = [has_frames,
+                       &image_to_frame_id](const image_t image_id) {
+      return has_frames ? image_to_frame_id.at(image_id)
+                        : static_cast<frame_t>(image_id);
+    };
+    std::unordered_set<frame_t> selected_frame_ids;
+    for (const std::string& image_name : image_names) {
+      const std::optional<class Image> image =
+          database.ReadImageWithName(image_name);
+      if (image.has_value()) {
+        selected_frame_ids.insert(GetFrameId(image->ImageId()));
+      }
+    }
+    for (const auto& [pair_id, num_inliers] :
+         database.ReadTwoViewGeometryNumInliers()) {
+      if (static_cast<size_t>(num_inliers) < min_num_matches) {
+        continue;
+      }
+      const auto [image_id1, image_id2] = PairIdToImagePair(pair_id);
+      if (selected_frame_ids.count(GetFrameId(image_id1)) > 0 &&
+          selected_frame_ids.count(GetFrameId(image_id2)) > 0) {
+        two_view_geometries.emplace_back(
+            pair_id, database.ReadTwoViewGeometry(image_id1, image_id2));
+      }
+    }
+  }
 
   LOG(INFO) << StringPrintf(
       " %d in %.3fs", two_view_geometries.size(), timer.ElapsedSeconds());
@@ -81,6 +81,20 @@ TEST(Database, Transaction) {
   DatabaseTransaction database_transaction(&database);
 }
 
+TEST(Database, NestedTransaction) {
+  Database database(Database::kInMemoryDatabasePath);
+  {
+    DatabaseTransaction database_transaction(&database);
+    {
+      DatabaseTransaction nested_database_transaction(&database);
+      database.WriteCamera(Camera::CreateFromModelName(
+          kInvalidCameraId, "SIMPLE_PINHOLE", 1.0, 1, 1));
+    }
+    EXPECT_EQ(database.NumCameras(), 1);
+  }
+  EXPECT_EQ(database.NumCameras(), 1);
+}
+
 TEST(Database, TransactionMultiThreaded) {
   Database database(Database::kInMemoryDatabasePath);
 
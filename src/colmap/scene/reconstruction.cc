@@ -38,8 +38,16 @@
 #include "colmap/sensor/bitmap.h"
 #include "colmap/util/file.h"
 #include "colmap/util/ply.h"
+#include "colmap/util/threading.h"
 
 namespace colmap {
+namespace {
+
+// Whole-model operations process the 3D points in parallel chunks of this size.
+// Smaller models are processed on the calling thread.
+constexpr size_t kPoints3DChunkSize = 16384;
+
+}  // namespace
 
 Reconstruction::Reconstruction() : max_point3D_id_(0) {}
 
@@ -536,7 +544,8 @@ Reconstruction::ComputeBBBoxAndCentroid(const double min_percentile,
                                        std::move(coords_z));
 }
 
-void Reconstruction::Transform(const Sim3d& new_from_old_world) {
+void Reconstruction::Transform(const Sim3d& new_from_old_world,
+                               const int num_threads) {
   for (auto& [_, rig] : rigs_) {
     for (auto& [_, sensor_from_rig] : rig.Sensors()) {
       if (sensor_from_rig.has_value()) {
@@ -550,9 +559,13 @@ void Reconstruction::Transform(const Sim3d& new_from_old_world) {
           TransformCameraWorld(new_from_old_world, frame.RigFromWorld()));
     }
   }
-  for (auto& point3D : points3D_) {
-    point3D.second.xyz = new_from_old_world * point3D.second.xyz;
-  }
+  ParallelFor(points3D_.size(),
+              kPoints3DChunkSize,
+              num_threads,
+              [&](const size_t idx) {
+                Eigen::Vector3d& xyz = (points3D_.begin() + idx)->second.xyz;
+                xyz = new_from_old_world * xyz;
+              });
 }
 
 Reconstruction Reconstruction::Crop(const Eigen::AlignedBox3d& bbox) const {
@@ -674,14 +687,32 @@ double Reconstruction::ComputeMeanObservationsPerRegImage() const {
   }
 }
 
-double Reconstruction::ComputeMeanReprojectionError() const {
+double Reconstruction::ComputeMeanReprojectionError(
+    const int num_threads) const {
+  const size_t num_chunks = NumChunks(points3D_.size(), kPoints3DChunkSize);
+  std::vector<double> chunk_error_sums(num_chunks, 0.0);
+  std::vector<size_t> chunk_num_valid_errors(num_chunks, 0);
+  ParallelForChunks(
+      points3D_.size(),
+      kPoints3DChunkSize,
+      num_threads,
+      [&](const size_t chunk_idx, const size_t begin, const size_t end) {
+        for (auto it = points3D_.begin() + begin;
+             it != points3D_.begin() + end;
+             ++it) {
+          if (it->second.HasError()) {
+            chunk_error_sums[chunk_idx] += it->second.error;
+            chunk_num_valid_errors[chunk_idx] += 1;
+          }
+        }
+      });
+
+  // Accumulate in chunk order for deterministic results.
   double error_sum = 0.0;
   size_t num_valid_errors = 0;
-  for (const auto& point3D : points3D_) {
-    if (point3D.second.HasError()) {
-      error_sum += point3D.second.error;
-      num_valid_errors += 1;
-    }
+  for (size_t chunk_idx = 0; chunk_idx < num_chunks; ++chunk_idx) {
+    error_sum += chunk_error_sums[chunk_idx];
+    num_valid_errors += chunk_num_valid_errors[chunk_idx];
   }
 
   if (num_valid_errors == 0) {
@@ -691,22 +722,26 @@ double Reconstruction::ComputeMeanReprojectionError() const {
   }
 }
 
-void Reconstruction::UpdatePoint3DErrors() {
-  for (auto& point3D : points3D_) {
-    if (point3D.second.track.Length() == 0) {
-      point3D.second.error = 0;
-      continue;
-    }
-    point3D.second.error = 0;
-    for (const auto& track_el : point3D.second.track.Elements()) {
-      const auto& image = Image(track_el.image_id);
-      const auto& point2D = image.Point2D(track_el.point2D_idx);
-      const auto& camera = *image.CameraPtr();
-      point3D.second.error += std::sqrt(CalculateSquaredReprojectionError(
-          point2D.xy, point3D.second.xyz, image.CamFromWorld(), camera));
-    }
-    point3D.second.error /= point3D.second.track.Length();
-  }
+void Reconstruction::UpdatePoint3DErrors(const int num_threads) {
+  ParallelFor(
+      points3D_.size(),
+      kPoints3DChunkSize,
+      num_threads,
+      [&](const size_t idx) {
+        struct Point3D& point3D = (points3D_.begin() + idx)->second;
+        point3D.error = 0;
+        if (point3D.track.Length() == 0) {
+          return;
+        }
+        for (const auto& track_el : point3D.track.Elements()) {
+          const auto& image = Image(track_el.image_id);
+          const auto& point2D = image.Point2D(track_el.point2D_idx);
+          const auto& camera = *image.CameraPtr();
+          point3D.error += std::sqrt(CalculateSquaredReprojectionError(
+              point2D.xy, point3D.xyz, image.CamFromWorld(), camera));
+        }
+        point3D.error /= point3D.track.Length();
+      });
 }
 
 void Reconstruction::Read(const std::string& path) {
@@ -853,11 +888,14 @@ bool Reconstruction::ExtractColorsForImage(const image_t image_id,
   return true;
 }
 
-void Reconstruction::ExtractColorsForAllImages(const std::string& path) {
-  std::unordered_map<point3D_t, Eigen::Vector3d> color_sums;
-  std::unordered_map<point3D_t, size_t> color_counts;
+void Reconstruction::ExtractColorsForAllImages(const std::string& path,
+                                               const int num_threads) {
+  // Colors sampled in an image, as pairs of 3D point slot and color.
+  using ImageColors = std::vector<std::pair<size_t, Eigen::Vector3d>>;
+
+  const auto sample_image_colors = [this, &path](const image_t image_id) {
+    ImageColors image_colors;
 
-  for (const auto& image_id : RegImageIds()) {
     const class Image& image = Image(image_id);
     const std::string image_path = JoinPaths(path, image.Name());
 
@@ -865,44 +903,78 @@ void Reconstruction::ExtractColorsForAllImages(const std::string& path) {
     if (!bitmap.Read(image_path)) {
       LOG(WARNING) << "Could not read image " << image.Name() << " at path "
                    << image_path;
-      continue;
+      return image_colors;
     }
 
+    image_colors.reserve(image.NumPoints3D());
     for (const Point2D& point2D : image.Points2D()) {
       if (point2D.HasPoint3D()) {
         BitmapColor<float> color;
         // COLMAP assumes that the upper left pixel center is (0.5, 0.5).
         if (bitmap.InterpolateBilinear(
                 point2D.xy(0) - 0.5, point2D.xy(1) - 0.5, &color)) {
-          if (color_sums.count(point2D.point3D_id)) {
-            Eigen::Vector3d& color_sum = color_sums[point2D.point3D_id];
-            color_sum(0) += color.r;
-            color_sum(1) += color.g;
-            color_sum(2) += color.b;
-            color_counts[point2D.point3D_id] += 1;
-          } else {
-            color_sums.emplace(point2D.point3D_id,
-                               Eigen::Vector3d(color.r, color.g, color.b));
-            color_counts.emplace(point2D.point3D_id, 1);
-          }
+          image_colors.emplace_back(
+              points3D_.find(point2D.point3D_id) - points3D_.begin(),
+              Eigen::Vector3d(color.r, color.g, color.b));
         }
       }
     }
-  }
 
-  const Eigen::Vector3ub kBlackColor = Eigen::Vector3ub::Zero();
-  for (auto& point3D : points3D_) {
-    if (color_sums.count(point3D.first)) {
-      Eigen::Vector3d color =
-          color_sums[point3D.first] / color_counts[point3D.first];
-      for (Eigen::Index i = 0; i < color.size(); ++i) {
-        color[i] = std::round(color[i]);
+    return image_colors;
+  };
+
+  std::vector<Eigen::Vector3d> color_sums(points3D_.size(),
+                                          Eigen::Vector3d::Zero());
+  std::vector<size_t> color_counts(points3D_.size(), 0);
+
+  // Images are read and sampled in parallel, while their colors are
+  // accumulated in image order for deterministic results. The number of
+  // images in flight is bounded to limit memory usage.
+  const auto accumulate_image_colors = [&](const ImageColors& image_colors) {
+    for (const auto& [slot, color] : image_colors) {
+      color_sums[slot] += color;
+      color_counts[slot] += 1;
+    }
+  };
+
+  const std::vector<image_t> reg_image_ids = RegImageIds();
+  const int num_eff_threads = GetEffectiveNumThreads(num_threads);
+  if (num_eff_threads == 1) {
+    for (const image_t image_id : reg_image_ids) {
+      accumulate_image_colors(sample_image_colors(image_id));
+    }
+  } else {
+    const size_t max_num_pending_images = 2 * num_eff_threads;
+    ThreadPool thread_pool(num_eff_threads);
+    std::queue<std::future<ImageColors>> pending_image_colors;
+    size_t next_image_idx = 0;
+    while (next_image_idx < reg_image_ids.size() ||
+           !pending_image_colors.empty()) {
+      while (next_image_idx < reg_image_ids.size() &&
+             pending_image_colors.size() < max_num_pending_images) {
+        pending_image_colors.push(thread_pool.AddTask(
+            sample_image_colors, reg_image_ids[next_image_idx]));
+        ++next_image_idx;
       }
-      point3D.second.color = color.cast<uint8_t>();
-    } else {
-      point3D.second.color = kBlackColor;
+      accumulate_image_colors(pending_image_colors.front().get());
+      pending_image_colors.pop();
     }
   }
+
+  const Eigen::Vector3ub kBlackColor = Eigen::Vector3ub::Zero();
+  ParallelFor(points3D_.size(),
+              kPoints3DChunkSize,
+              num_threads,
+              [&](const size_t slot) {
+                struct Point3D& point3D = (points3D_.begin() + slot)->second;
+                if (color_counts[slot] > 0) {
+                  const Eigen::Vector3d color =
+                      (color_sums[slot] / color_counts[slot]).array().round();
+                  point3D.color = color.cast<uint8_t>();
+                } else {
+                  point3D.color = kBlackColor;
+                }
+              });
 }
 
 void Reconstruction::CreateImageDirs(const std::string& path) const {
@@ -36,6 +36,7 @@
 #include "colmap/scene/point3d.h"
 #include "colmap/scene/track.h"
 #include "colmap/sensor/rig.h"
+#include "colmap/util/dense_id_map.h"
 #include "colmap/util/eigen_alignment.h"
 #include "colmap/util/types.h"
 
@@ -89,7 +90,7 @@ class Reconstruction {
   inline const std::unordered_map<frame_t, class Frame>& Frames() const;
   inline const std::vector<frame_t>& RegFrameIds() const;
   inline const std::unordered_map<image_t, class Image>& Images() const;
-  inline const std::unordered_map<point3D_t, struct Point3D>& Points3D() const;
+  inline const DenseIdMap<point3D_t, struct Point3D>& Points3D() const;
 
   // Number of images in all registered frames.
   size_t NumRegImages() const;
@@ -193,8 +194,9 @@ class Reconstruction {
                                          double max_percentile = 1.0,
                                          bool use_images = false) const;
 
-  // Apply the 3D similarity transformation to all images and points.
-  void Transform(const Sim3d& new_from_old_world);
+  // Apply the 3D similarity transformation to all images and points. The 3D
+  // points are transformed on the given number of threads.
+  void Transform(const Sim3d& new_from_old_world, int num_threads = 1);
 
   // Creates a cropped reconstruction using the input bounds as corner points
   // of the bounding box containing the included 3D points of the new
@@ -218,10 +220,10 @@ class Reconstruction {
   size_t ComputeNumObservations() const;
   double ComputeMeanTrackLength() const;
   double ComputeMeanObservationsPerRegImage() const;
-  double ComputeMeanReprojectionError() const;
+  double ComputeMeanReprojectionError(int num_threads = 1) const;
 
   // Updates mean reprojection errors for all 3D points.
-  void UpdatePoint3DErrors();
+  void UpdatePoint3DErrors(int num_threads = 1);
 
   // Read data from text or binary file. Prefer binary data if it exists.
   void Read(const std::string& path);
@@ -259,7 +261,8 @@ class Reconstruction {
   // @param path          Absolute or relative path to root folder of image.
   //                      The image path is determined by concatenating the
   //                      root path and the name of the image.
-  void ExtractColorsForAllImages(const std::string& path);
+  // @param num_threads   Number of threads reading the images.
+  void ExtractColorsForAllImages(const std::string& path, int num_threads = 1);
 
   // Create all image sub-directories in the given path.
   void CreateImageDirs(const std::string& path) const;
@@ -272,7 +275,9 @@ class Reconstruction {
   std::unordered_map<camera_t, struct Camera> cameras_;
   std::unordered_map<frame_t, class Frame> frames_;
   std::unordered_map<image_t, class Image> images_;
-  std::unordered_map<point3D_t, struct Point3D> points3D_;
+  // 3D points are stored contiguously, since they are by far the most
+  // numerous objects and many operations iterate over all of them.
+  DenseIdMap<point3D_t, struct Point3D> points3D_;
 
   // Unique set of frame_ids where `Frame(frame_id).HasPose() == true`.
   // Note that we intentionally use a vector instead of a set here leading
@@ -414,7 +419,7 @@ const std::vector<frame_t>& Reconstruction::RegFrameIds() const {
   return reg_frame_ids_;
 }
 
-const std::unordered_map<point3D_t, Point3D>& Reconstruction::Points3D() const {
+const DenseIdMap<point3D_t, Point3D>& Reconstruction::Points3D() const {
   return points3D_;
 }
 
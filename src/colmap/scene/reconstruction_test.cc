@@ -33,6 +33,7 @@
 #include "colmap/geometry/sim3.h"
 #include "colmap/scene/reconstruction_io.h"
 #include "colmap/scene/synthetic.h"
+#include "colmap/sensor/bitmap.h"
 #include "colmap/sensor/models.h"
 #include "colmap/util/file.h"
 #include "colmap/util/testing.h"
@@ -760,6 +761,32 @@ TEST(Reconstruction, UpdatePoint3DErrors) {
   EXPECT_EQ(reconstruction.Point3D(point3D_id).error, 1);
 }
 
+TEST(Reconstruction, PointPassesWithMultipleThreads) {
+  Reconstruction reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_points3D = 100;
+  synthetic_dataset_options.point2D_stddev = 1;
+  SynthesizeDataset(synthetic_dataset_options, &reconstruction);
+
+  Reconstruction multi_threaded_reconstruction = reconstruction;
+  const Sim3d new_from_old_world(
+      2, Eigen::Quaterniond::UnitRandom(), Eigen::Vector3d::Random());
+  reconstruction.Transform(new_from_old_world);
+  multi_threaded_reconstruction.Transform(new_from_old_world,
+                                          /*num_threads=*/4);
+  reconstruction.UpdatePoint3DErrors();
+  multi_threaded_reconstruction.UpdatePoint3DErrors(/*num_threads=*/4);
+  for (const auto& [point3D_id, point3D] : reconstruction.Points3D()) {
+    const Point3D& multi_threaded_point3D =
+        multi_threaded_reconstruction.Point3D(point3D_id);
+    EXPECT_EQ(multi_threaded_point3D.xyz, point3D.xyz);
+    EXPECT_EQ(multi_threaded_point3D.error, point3D.error);
+  }
+  EXPECT_EQ(multi_threaded_reconstruction.ComputeMeanReprojectionError(
+                /*num_threads=*/4),
+            reconstruction.ComputeMeanReprojectionError());
+}
+
 TEST(Reconstruction, DeleteAllPoints2DAndPoints3D) {
   Reconstruction reconstruction;
   SyntheticDatasetOptions synthetic_dataset_options;
@@ -774,5 +801,73 @@ TEST(Reconstruction, DeleteAllPoints2DAndPoints3D) {
   ExpectValidPtrs(reconstruction);
 }
 
+TEST(Reconstruction, ExtractColorsForAllImages) {
+  Reconstruction reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_rigs = 1;
+  synthetic_dataset_options.num_cameras_per_rig = 1;
+  synthetic_dataset_options.num_frames_per_rig = 10;
+  synthetic_dataset_options.num_points3D = 50;
+  synthetic_dataset_options.camera_width = 200;
+  synthetic_dataset_options.camera_height = 150;
+  synthetic_dataset_options.camera_params = {250, 100, 75, 0};
+  SynthesizeDataset(synthetic_dataset_options, &reconstruction);
+
+  // Alternate between two colors, such that every point gets the mean color
+  // of its observations.
+  const Eigen::Vector3d kEvenColor(10, 20, 30);
+  const Eigen::Vector3d kOddColor(30, 40, 50);
+  Bitmap bitmap;
+  bitmap.Allocate(synthetic_dataset_options.camera_width,
+                  synthetic_dataset_options.camera_height,
+                  /*as_rgb=*/true);
+  const std::string test_dir = CreateTestDir();
+  for (const image_t image_id : reconstruction.RegImageIds()) {
+    Image& image = reconstruction.Image(image_id);
+    image.SetName(image.Name() + ".png");
+    const Eigen::Vector3d& color = image_id % 2 == 0 ? kEvenColor : kOddColor;
+    bitmap.Fill(BitmapColor<uint8_t>(color(0), color(1), color(2)));
+    ASSERT_TRUE(bitmap.Write(JoinPaths(test_dir, image.Name())));
+  }
+
+  reconstruction.ExtractColorsForAllImages(test_dir, /*num_threads=*/3);
+
+  for (const auto& [point3D_id, point3D] : reconstruction.Points3D()) {
+    Eigen::Vector3d color_sum = Eigen::Vector3d::Zero();
+    int num_colors = 0;
+    for (const auto& track_el : point3D.track.Elements()) {
+      const Point2D& point2D =
+          reconstruction.Image(track_el.image_id).Point2D(track_el.point2D_idx);
+      BitmapColor<float> color;
+      if (bitmap.InterpolateBilinear(
+              point2D.xy(0) - 0.5, point2D.xy(1) - 0.5, &color)) {
+        color_sum += track_el.image_id % 2 == 0 ? kEvenColor : kOddColor;
+        ++num_colors;
+      }
+    }
+    if (num_colors == 0) {
+      EXPECT_EQ(point3D.color, Eigen::Vector3ub::Zero());
+    } else {
+      const Eigen::Vector3d expected_color =
+          (color_sum / num_colors).array().round();
+      EXPECT_EQ(point3D.color, expected_color.cast<uint8_t>());
+    }
+  }
+
+  // The colors do not depend on the number of threads.
+  Reconstruction single_threaded_reconstruction = reconstruction;
+  single_threaded_reconstruction.ExtractColorsForAllImages(test_dir);
+  for (const auto& [point3D_id, point3D] : reconstruction.Points3D()) {
+    EXPECT_EQ(single_threaded_reconstruction.Point3D(point3D_id).color,
+              point3D.color);
+  }
+
+  // Points without any readable image are reset to black.
+  reconstruction.ExtractColorsForAllImages(JoinPaths(test_dir, "missing"));
+  for (const auto& [point3D_id, point3D] : reconstruction.Points3D()) {
+    EXPECT_EQ(point3D.color, Eigen::Vector3ub::Zero());
+  }
+}
+
 }  // namespace
 }  // namespace colmap
@@ -0,0 +1,362 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "colmap/scene/track_table.h"
+
+#include "colmap/util/logging.h"
+#include "colmap/util/threading.h"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <unordered_map>
+
+namespace colmap {
+namespace {
+
+// Lock-free union-find for concurrent use. Roots are always linked to the
+// smaller root, so the root of each set is its smallest element independent
+// of the order of the union operations.
+class ConcurrentUnionFind {
+ public:
+  ConcurrentUnionFind(const size_t num_elements, const int num_threads)
+      : parents_(num_elements) {
+    ParallelFor(num_elements,
+                kChunkSize,
+                num_threads,
+                [this](const size_t idx) {
+                  parents_[idx].store(idx, std::memory_order_relaxed);
+                });
+  }
+
+  size_t Find(size_t idx) {
+    while (true) {
+      size_t parent = parents_[idx].load(std::memory_order_relaxed);
+      if (parent == idx) {
+        return idx;
+      }
+      const size_t grand_parent =
+          parents_[parent].load(std::memory_order_relaxed);
+      if (grand_parent == parent) {
+        return parent;
+      }
+      // Compress the path by halving. If this fails, another thread already
+      // moved the element closer to the root.
+      parents_[idx].compare_exchange_weak(
+          parent, grand_parent, std::memory_order_relaxed);
+      idx = grand_parent;
+    }
+  }
+
+  void Union(size_t idx1, size_t idx2) {
+    while (true) {
+      idx1 = Find(idx1);
+      idx2 = Find(idx2);
+      if (idx1 == idx2) {
+        return;
+      }
+      if (idx1 < idx2) {
+        std::swap(idx1, idx2);
+      }
+      // Link the larger to the smaller root. If this fails, the larger root
+      // was concurrently linked to another root and we retry.
+      size_t expected_root = idx1;
+      if (parents_[idx1].compare_exchange_strong(
+              expected_root, idx2, std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  static constexpr size_t kChunkSize = 1 << 16;
+
+ private:
+  std::vector<std::atomic<size_t>> parents_;
+};
+
+// Observations of all images, where the observations of the i-th image are in
+// the range [image_obs_offsets[i], image_obs_offsets[i + 1]).
+struct Observations {
+  const std::vector<image_t>& image_ids;
+  std::unordered_map<image_t, size_t> image_idxs;
+  std::vector<size_t> image_obs_offsets;
+
+  size_t NumObservations() const { return image_obs_offsets.back(); }
+
+  size_t ImageIdx(const size_t obs_idx) const {
+    return std::upper_bound(image_obs_offsets.begin(),
+                            image_obs_offsets.end(),
+                            obs_idx) -
+           image_obs_offsets.begin() - 1;
+  }
+
+  TrackElement Element(const size_t obs_idx) const {
+    const size_t image_idx = ImageIdx(obs_idx);
+    return TrackElement(
+        image_ids[image_idx],
+        static_cast<point2D_t>(obs_idx - image_obs_offsets[image_idx]));
+  }
+
+  // Calls func(corr_obs_idx) for all correspondences of the observation to
+  // the given images.
+  template <typename Func>
+  void ForEachCorrespondence(const CorrespondenceGraph& correspondence_graph,
+                             const size_t obs_idx,
+                             Func&& func) const {
+    const TrackElement element = Element(obs_idx);
+    const CorrespondenceGraph::CorrespondenceRange corr_range =
+        correspondence_graph.FindCorrespondences(element.image_id,
+                                                 element.point2D_idx);
+    for (const CorrespondenceGraph::Correspondence* corr = corr_range.beg;
+         corr < corr_range.end;
+         ++corr) {
+      const auto corr_image_idx = image_idxs.find(corr->image_id);
+      if (corr_image_idx != image_idxs.end()) {
+        func(image_obs_offsets[corr_image_idx->second] + corr->point2D_idx);
+      }
+    }
+  }
+};
+
+// Split the given connected component with multiple observations in the same
+// image into consistent tracks by greedily joining its correspondences.
+std::vector<std::vector<size_t>> SplitInconsistentTrack(
+    const CorrespondenceGraph& correspondence_graph,
+    const Observations& observations,
+    const std::vector<size_t>& obs_idxs) {
+  const size_t num_obs = obs_idxs.size();
+
+  // Union-find over the observations of the component, where each set
+  // maintains the sorted list of its observed images.
+  std::vector<size_t> parents(num_obs);
+  std::iota(parents.begin(), parents.end(), 0);
+  std::vector<std::vector<size_t>> set_image_idxs(num_obs);
+  for (size_t i = 0; i < num_obs; ++i) {
+    set_image_idxs[i].push_back(observations.ImageIdx(obs_idxs[i]));
+  }
+  const auto find = [&parents](size_t idx) {
+    while (parents[idx] != idx) {
+      parents[idx] = parents[parents[idx]];
+      idx = parents[idx];
+    }
+    return idx;
+  };
+
+  std::vector<size_t> merged_image_idxs;
+  for (size_t i = 0; i < num_obs; ++i) {
+    observations.ForEachCorrespondence(
+        correspondence_graph, obs_idxs[i], [&](const size_t corr_obs_idx) {
+          const size_t j =
+              std::lower_bound(obs_idxs.begin(), obs_idxs.end(), corr_obs_idx) -
+              obs_idxs.begin();
+          if (j <= i) {
+            return;
+          }
+          const size_t root1 = find(i);
+          const size_t root2 = find(j);
+          if (root1 == root2) {
+            return;
+          }
+          std::vector<size_t>& image_idxs1 = set_image_idxs[root1];
+          std::vector<size_t>& image_idxs2 = set_image_idxs[root2];
+          merged_image_idxs.clear();
+          std::set_union(image_idxs1.begin(),
+                         image_idxs1.end(),
+                         image_idxs2.begin(),
+                         image_idxs2.end(),
+                         std::back_inserter(merged_image_idxs));
+          if (merged_image_idxs.size() !=
+              image_idxs1.size() + image_idxs2.size()) {
+            // Joining would result in multiple observations in one image.
+            return;
+          }
+          const size_t min_root = std::min(root1, root2);
+          const size_t max_root = std::max(root1, root2);
+          parents[max_root] = min_root;
+          set_image_idxs[min_root].swap(merged_image_idxs);
+          set_image_idxs[max_root].clear();
+        });
+  }
+
+  // Gather the tracks in the order of their first observation.
+  std::vector<std::vector<size_t>> tracks;
+  std::vector<size_t> root_track_idxs(num_obs);
+  for (size_t i = 0; i < num_obs; ++i) {
+    const size_t root = find(i);
+    if (set_image_idxs[root].size() < 2) {
+      continue;
+    }
+    if (root == i) {
+      root_track_idxs[root] = tracks.size();
+      tracks.emplace_back();
+    }
+    tracks[root_track_idxs[root]].push_back(obs_idxs[i]);
+  }
+
+  return tracks;
+}
+
+}  // namespace
+
+TrackTable BuildTrackTable(const CorrespondenceGraph& correspondence_graph,
+                           const std::vector<image_t>& image_ids,
+                           const int num_threads) {
+  Observations observations{image_ids};
+  observations.image_idxs.reserve(image_ids.size());
+  observations.image_obs_offsets.resize(image_ids.size() + 1, 0);
+  for (size_t image_idx = 0; image_idx < image_ids.size(); ++image_idx) {
+    const image_t image_id = image_ids[image_idx];
+    size_t num_points2D = 0;
+    if (correspondence_graph.ExistsImage(image_id)) {
+      THROW_CHECK(observations.image_idxs.emplace(image_id, image_idx).second)
+          << "Duplicate image " << image_id;
+      num_points2D = correspondence_graph.NumPoints2DForImage(image_id);
+    }
+    observations.image_obs_offsets[image_idx + 1] =
+        observations.image_obs_offsets[image_idx] + num_points2D;
+  }
+  const size_t num_obs = observations.NumObservations();
+
+  // Join all corresponding observations in parallel. Correspondences are
+  // stored in both directions, so each image only joins its observations with
+  // the observations of larger index.
+  ConcurrentUnionFind union_find(num_obs, num_threads);
+  std::vector<char> has_corrs(num_obs, false);
+  ParallelFor(
+      image_ids.size(), /*chunk_size=*/1, num_threads, [&](size_t image_idx) {
+        for (size_t obs_idx = observations.image_obs_offsets[image_idx];
+             obs_idx < observations.image_obs_offsets[image_idx + 1];
+             ++obs_idx) {
+          observations.ForEachCorrespondence(
+              correspondence_graph, obs_idx, [&](const size_t corr_obs_idx) {
+                has_corrs[obs_idx] = true;
+                if (obs_idx < corr_obs_idx) {
+                  union_find.Union(obs_idx, corr_obs_idx);
+                }
+              });
+        }
+      });
+
+  std::vector<size_t> roots(num_obs);
+  ParallelFor(num_obs,
+              ConcurrentUnionFind::kChunkSize,
+              num_threads,
+              [&](const size_t obs_idx) {
+                if (has_corrs[obs_idx]) {
+                  roots[obs_idx] = union_find.Find(obs_idx);
+                }
+              });
+
+  // Gather the observations of each connected component into contiguous
+  // ranges. The components are ordered by their smallest observation, which
+  // is their root, and the observations are in ascending order.
+  std::vector<size_t> obs_component_idxs(num_obs);
+  std::vector<size_t> component_offsets = {0};
+  for (size_t obs_idx = 0; obs_idx < num_obs; ++obs_idx) {
+    if (!has_corrs[obs_idx]) {
+      continue;
+    }
+    if (roots[obs_idx] == obs_idx) {
+      obs_component_idxs[obs_idx] = component_offsets.size() - 1;
+      component_offsets.push_back(0);
+    } else {
+      obs_component_idxs[obs_idx] = obs_component_idxs[roots[obs_idx]];
+    }
+    component_offsets[obs_component_idxs[obs_idx] + 1] += 1;
+  }
+  std::partial_sum(component_offsets.begin(),
+                   component_offsets.end(),
+                   component_offsets.begin());
+  const size_t num_components = component_offsets.size() - 1;
+  std::vector<size_t> component_obs_idxs(component_offsets.back());
+  {
+    std::vector<size_t> component_sizes(num_components, 0);
+    for (size_t obs_idx = 0; obs_idx < num_obs; ++obs_idx) {
+      if (has_corrs[obs_idx]) {
+        const size_t component_idx = obs_component_idxs[obs_idx];
+        component_obs_idxs[component_offsets[component_idx] +
+                           component_sizes[component_idx]++] = obs_idx;
+      }
+    }
+  }
+
+  // Split inconsistent components in parallel. Observations of the same image
+  // are adjacent in the sorted ranges.
+  std::vector<std::vector<std::vector<size_t>>> split_tracks(num_components);
+  std::vector<char> is_consistent(num_components, true);
+  ParallelFor(
+      num_components,
+      /*chunk_size=*/1024,
+      num_threads,
+      [&](const size_t component_idx) {
+        const size_t begin = component_offsets[component_idx];
+        const size_t end = component_offsets[component_idx + 1];
+        for (size_t i = begin + 1; i < end; ++i) {
+          if (observations.ImageIdx(component_obs_idxs[i - 1]) ==
+              observations.ImageIdx(component_obs_idxs[i])) {
+            is_consistent[component_idx] = false;
+            break;
+          }
+        }
+        if (!is_consistent[component_idx]) {
+          split_tracks[component_idx] = SplitInconsistentTrack(
+              correspondence_graph,
+              observations,
+              std::vector<size_t>(component_obs_idxs.begin() + begin,
+                                  component_obs_idxs.begin() + end));
+        }
+      });
+
+  TrackTable track_table;
+  track_table.track_offsets.reserve(num_components + 1);
+  track_table.elements.reserve(component_obs_idxs.size());
+  for (size_t component_idx = 0; component_idx < num_components;
+       ++component_idx) {
+    if (is_consistent[component_idx]) {
+      for (size_t i = component_offsets[component_idx];
+           i < component_offsets[component_idx + 1];
+           ++i) {
+        track_table.elements.push_back(
+            observations.Element(component_obs_idxs[i]));
+      }
+      track_table.track_offsets.push_back(track_table.elements.size());
+    } else {
+      for (const std::vector<size_t>& track : split_tracks[component_idx]) {
+        for (const size_t obs_idx : track) {
+          track_table.elements.push_back(observations.Element(obs_idx));
+        }
+        track_table.track_offsets.push_back(track_table.elements.size());
+      }
+    }
+  }
+
+  return track_table;
+}
+
+}  // namespace colmap
@@ -0,0 +1,93 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "colmap/scene/correspondence_graph.h"
+#include "colmap/scene/track.h"
+#include "colmap/util/types.h"
+
+#include <vector>
+
+namespace colmap {
+
+// Compact table of feature tracks in compressed sparse row format, where the
+// elements of the i-th track are in the range
+// [track_offsets[i], track_offsets[i + 1]) of all elements.
+struct TrackTable {
+  std::vector<size_t> track_offsets = {0};
+  std::vector<TrackElement> elements;
+
+  // The number of tracks.
+  inline size_t NumTracks() const;
+
+  // The total number of elements of all tracks.
+  inline size_t NumElements() const;
+
+  // The number of elements of a track.
+  inline size_t TrackLength(size_t track_idx) const;
+
+  // Access the elements of a track.
+  inline span<const TrackElement> Track(size_t track_idx) const;
+};
+
+// Build feature tracks as the connected components of the correspondence
+// graph, restricted to the given images. The components are found in parallel
+// using a lock-free union-find over all image observations.
+//
+// Inconsistent components with multiple observations in the same image are
+// split into consistent tracks by greedily joining their correspondences, as
+// long as the joined tracks do not observe a common image. Tracks with a
+// single element are discarded.
+//
+// The elements of each track are sorted by the order of the given images and
+// by point index. The result is deterministic and independent of the number
+// of threads. Images that are not in the correspondence graph are ignored.
+TrackTable BuildTrackTable(const CorrespondenceGraph& correspondence_graph,
+                           const std::vector<image_t>& image_ids,
+                           int num_threads = -1);
+
+////////////////////////////////////////////////////////////////////////////////
+// Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+size_t TrackTable::NumTracks() const { return track_offsets.size() - 1; }
+
+size_t TrackTable::NumElements() const { return elements.size(); }
+
+size_t TrackTable::TrackLength(const size_t track_idx) const {
+  return track_offsets[track_idx + 1] - track_offsets[track_idx];
+}
+
+span<const TrackElement> TrackTable::Track(const size_t track_idx) const {
+  return span<const TrackElement>(elements.data() + track_offsets[track_idx],
+                                  TrackLength(track_idx));
+}
+
+}  // namespace colmap
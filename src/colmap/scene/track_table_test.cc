@@ -0,0 +1,134 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "colmap/scene/track_table.h"
+
+#include "colmap/scene/database_cache.h"
+#include "colmap/scene/synthetic.h"
+
+#include <gtest/gtest.h>
+
+namespace colmap {
+namespace {
+
+std::vector<TrackElement> TrackElements(const TrackTable& track_table,
+                                        size_t track_idx) {
+  const span<const TrackElement> track = track_table.Track(track_idx);
+  return std::vector<TrackElement>(track.begin(), track.end());
+}
+
+CorrespondenceGraph CreateTestCorrespondenceGraph() {
+  CorrespondenceGraph correspondence_graph;
+  correspondence_graph.AddImage(1, 4);
+  correspondence_graph.AddImage(2, 4);
+  correspondence_graph.AddImage(3, 4);
+  correspondence_graph.AddCorrespondences(1, 2, {{0, 0}, {1, 1}, {2, 2}});
+  correspondence_graph.AddCorrespondences(2, 3, {{0, 0}, {2, 2}});
+  // Inconsistent track with two observations in the first image.
+  correspondence_graph.AddCorrespondences(3, 1, {{2, 3}});
+  correspondence_graph.Finalize();
+  return correspondence_graph;
+}
+
+TEST(TrackTable, Empty) {
+  const TrackTable track_table;
+  EXPECT_EQ(track_table.NumTracks(), 0);
+  EXPECT_EQ(track_table.NumElements(), 0);
+  EXPECT_EQ(BuildTrackTable(CorrespondenceGraph(), {}).NumTracks(), 0);
+}
+
+TEST(BuildTrackTable, Nominal) {
+  const CorrespondenceGraph correspondence_graph =
+      CreateTestCorrespondenceGraph();
+  for (const int num_threads : {1, 3}) {
+    const TrackTable track_table =
+        BuildTrackTable(correspondence_graph, {1, 2, 3}, num_threads);
+    ASSERT_EQ(track_table.NumTracks(), 4);
+    EXPECT_EQ(track_table.NumElements(), 9);
+    EXPECT_EQ(TrackElements(track_table, 0),
+              std::vector<TrackElement>({{1, 0}, {2, 0}, {3, 0}}));
+    EXPECT_EQ(TrackElements(track_table, 1),
+              std::vector<TrackElement>({{1, 1}, {2, 1}}));
+    EXPECT_EQ(TrackElements(track_table, 2),
+              std::vector<TrackElement>({{1, 2}, {2, 2}}));
+    EXPECT_EQ(TrackElements(track_table, 3),
+              std::vector<TrackElement>({{1, 3}, {3, 2}}));
+    EXPECT_EQ(track_table.TrackLength(0), 3);
+  }
+}
+
+TEST(BuildTrackTable, SubsetOfImages) {
+  const CorrespondenceGraph correspondence_graph =
+      CreateTestCorrespondenceGraph();
+  const TrackTable track_table =
+      BuildTrackTable(correspondence_graph, {3, 2, 4});
+  ASSERT_EQ(track_table.NumTracks(), 2);
+  EXPECT_EQ(TrackElements(track_table, 0),
+            std::vector<TrackElement>({{3, 0}, {2, 0}}));
+  EXPECT_EQ(TrackElements(track_table, 1),
+            std::vector<TrackElement>({{3, 2}, {2, 2}}));
+}
+
+TEST(BuildTrackTable, SyntheticDataset) {
+  Database database(Database::kInMemoryDatabasePath);
+  Reconstruction reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_frames_per_rig = 5;
+  synthetic_dataset_options.num_points3D = 100;
+  SynthesizeDataset(synthetic_dataset_options, &reconstruction, &database);
+  const auto database_cache =
+      DatabaseCache::Create(database,
+                            /*min_num_matches=*/0,
+                            /*ignore_watermarks=*/false,
+                            /*image_names=*/{});
+
+  const TrackTable track_table = BuildTrackTable(
+      *database_cache->CorrespondenceGraph(), reconstruction.RegImageIds());
+  EXPECT_EQ(track_table.NumTracks(), reconstruction.NumPoints3D());
+  EXPECT_EQ(track_table.NumElements(),
+            reconstruction.ComputeNumObservations());
+  for (size_t track_idx = 0; track_idx < track_table.NumTracks();
+       ++track_idx) {
+    const span<const TrackElement> track = track_table.Track(track_idx);
+    const point3D_t point3D_id = reconstruction.Image(track[0].image_id)
+                                     .Point2D(track[0].point2D_idx)
+                                     .point3D_id;
+    EXPECT_EQ(track.size(),
+              reconstruction.Point3D(point3D_id).track.Length());
+    for (const TrackElement& track_el : track) {
+      EXPECT_EQ(reconstruction.Image(track_el.image_id)
+                    .Point2D(track_el.point2D_idx)
+                    .point3D_id,
+                point3D_id);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace colmap
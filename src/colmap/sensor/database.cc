@@ -31,9 +31,17 @@
 
 #include "colmap/util/string.h"
 
+#include <string_view>
+
 namespace colmap {
+namespace {
+
+bool StringViewContains(const std::string_view str,
+                        const std::string_view sub_str) {
+  return str.find(sub_str) != std::string_view::npos;
+}
 
-const camera_specs_t CameraDatabase::specs_ = InitializeCameraSpecs();
+}  // namespace
 
 bool CameraDatabase::QuerySensorWidth(const std::string& make,
                                       const std::string& model,
@@ -54,14 +62,14 @@ bool CameraDatabase::QuerySensorWidth(const std::string& make,
   // Check if cleaned_make exists in database: Test whether EXIF string is
   // substring of database entry and vice versa.
   size_t spec_matches = 0;
-  for (const auto& make_elem : specs_) {
-    if (StringContains(cleaned_make, make_elem.first) ||
-        StringContains(make_elem.first, cleaned_make)) {
-      for (const auto& model_elem : make_elem.second) {
-        if (StringContains(cleaned_model, model_elem.first) ||
-            StringContains(model_elem.first, cleaned_model)) {
-          *sensor_width = model_elem.second;
-          if (cleaned_model == model_elem.first) {
+  for (const CameraMakeSpecs& make_specs : GetCameraSpecs()) {
+    if (StringViewContains(cleaned_make, make_specs.make) ||
+        StringViewContains(make_specs.make, cleaned_make)) {
+      for (const CameraModelSpecs& model_specs : make_specs) {
+        if (StringViewContains(cleaned_model, model_specs.model) ||
+            StringViewContains(model_specs.model, cleaned_model)) {
+          *sensor_width = model_specs.sensor_width;
+          if (cleaned_model == model_specs.model) {
             // Model exactly matches, return immediately.
             return true;
           }
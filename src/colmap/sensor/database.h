@@ -41,14 +41,11 @@ struct CameraDatabase {
  public:
   CameraDatabase() = default;
 
-  size_t NumEntries() const { return specs_.size(); }
+  size_t NumEntries() const { return GetCameraSpecs().size(); }
 
   bool QuerySensorWidth(const std::string& make,
                         const std::string& model,
                         double* sensor_width);
-
- private:
-  static const camera_specs_t specs_;
 };
 
 }  // namespace colmap
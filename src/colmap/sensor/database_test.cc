@@ -29,6 +29,8 @@
 
 #include "colmap/sensor/database.h"
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 
 namespace colmap {
@@ -36,8 +38,22 @@ namespace {
 
 TEST(CameraDatabase, Initialization) {
   CameraDatabase database;
-  camera_specs_t specs = InitializeCameraSpecs();
-  EXPECT_EQ(database.NumEntries(), specs.size());
+  EXPECT_GT(database.NumEntries(), 0);
+  EXPECT_EQ(database.NumEntries(), GetCameraSpecs().size());
+}
+
+TEST(CameraSpecs, SortedByMake) {
+  const CameraSpecs specs = GetCameraSpecs();
+  EXPECT_TRUE(std::is_sorted(
+      specs.begin(),
+      specs.end(),
+      [](const CameraMakeSpecs& make_specs1,
+         const CameraMakeSpecs& make_specs2) {
+        return make_specs1.make < make_specs2.make;
+      }));
+  for (const CameraMakeSpecs& make_specs : specs) {
+    EXPECT_GT(make_specs.num_models, 0);
+  }
 }
 
 TEST(CameraDatabase, ExactMatch) {
@@ -29,3861 +29,3847 @@
 
 #include "colmap/sensor/specs.h"
 
+#include <iterator>
+
 namespace colmap {
+namespace {
 
-camera_specs_t InitializeCameraSpecs() {
-  camera_specs_t specs;
+// The models of each make are kept in the order of the crawled database, as
+// the order determines the result of ambiguous partial matches.
+constexpr CameraModelSpecs kAcerModels[] = {
+    {"ce5330", 5.7500f},
+    {"ce5430", 5.7500f},
+    {"ce6430", 5.7500f},
+    {"ci6330", 7.1100f},
+    {"ci6530", 7.1100f},
+    {"ci8330", 7.1100f},
+    {"cl5300", 5.7500f},
+    {"cp8531", 7.1100f},
+    {"cp8660", 7.1100f},
+    {"cr5130", 7.1100f},
+    {"cr6530", 7.1100f},
+    {"cr8530", 7.1100f},
+    {"cs5530", 5.7500f},
+    {"cs5531", 5.7500f},
+    {"cs6530", 5.7500f},
+    {"cs6531", 5.7500f},
+    {"cu6530", 5.7500f},
+};
 
-  {
-    auto& make_specs = specs["acer"];
-    make_specs.reserve(17);
-    make_specs.emplace_back("ce5330", 5.7500f);
-    make_specs.emplace_back("ce5430", 5.7500f);
-    make_specs.emplace_back("ce6430", 5.7500f);
-    make_specs.emplace_back("ci6330", 7.1100f);
-    make_specs.emplace_back("ci6530", 7.1100f);
-    make_specs.emplace_back("ci8330", 7.1100f);
-    make_specs.emplace_back("cl5300", 5.7500f);
-    make_specs.emplace_back("cp8531", 7.1100f);
-    make_specs.emplace_back("cp8660", 7.1100f);
-    make_specs.emplace_back("cr5130", 7.1100f);
-    make_specs.emplace_back("cr6530", 7.1100f);
-    make_specs.emplace_back("cr8530", 7.1100f);
-    make_specs.emplace_back("cs5530", 5.7500f);
-    make_specs.emplace_back("cs5531", 5.7500f);
-    make_specs.emplace_back("cs6530", 5.7500f);
-    make_specs.emplace_back("cs6531", 5.7500f);
-    make_specs.emplace_back("cu6530", 5.7500f);
-  }
+constexpr CameraModelSpecs kAgfaphotoModels[] = {
+    {"compact100", 5.7500f},
+    {"compact102", 6.1600f},
+    {"compact103", 6.0800f},
+    {"dc1030i", 7.1100f},
+    {"dc1033m", 5.7500f},
+    {"dc1033x", 7.1100f},
+    {"dc1338i", 7.1100f},
+    {"dc1338st", 7.1100f},
+    {"dc2030m", 6.1600f},
+    {"dc302", 4.8000f},
+    {"dc500", 4.8000f},
+    {"dc530i", 5.7500f},
+    {"dc533", 5.7500f},
+    {"dc600uw", 6.1600f},
+    {"dc630i", 5.7500f},
+    {"dc630x", 5.7500f},
+    {"dc630", 5.7500f},
+    {"dc633xs", 5.7500f},
+    {"dc633x", 5.7500f},
+    {"dc730i", 5.7500f},
+    {"dc733i", 5.7500f},
+    {"dc733s", 5.7500f},
+    {"dc735i", 5.7500f},
+    {"dc735", 5.7500f},
+    {"dc738i", 5.7500f},
+    {"dc830i", 7.1100f},
+    {"dc830", 5.7500f},
+    {"dc8330i", 5.7500f},
+    {"dc8338i", 5.7500f},
+    {"dc833m", 5.7500f},
+    {"dc8428s", 7.1100f},
+    {"ephoto1280", 6.1600f},
+    {"ephoto1680", 6.1600f},
+    {"ephotocl18", 6.1600f},
+    {"ephotocl30clik!", 6.1600f},
+    {"ephotocl30", 6.1600f},
+    {"ephotocl45", 6.1600f},
+    {"ephotocl50", 6.1600f},
+    {"optima100", 6.0800f},
+    {"optima102", 6.0800f},
+    {"optima103", 6.1600f},
+    {"optima104", 6.0800f},
+    {"optima105", 6.1600f},
+    {"optima1338mt", 6.1600f},
+    {"optima1438m", 6.0800f},
+    {"optima1", 6.0800f},
+    {"optima3", 6.1600f},
+    {"optima830uw", 5.7500f},
+    {"optima8328m", 5.7500f},
+    {"sensor505d", 5.7500f},
+    {"sensor505x", 5.7500f},
+    {"sensor530s", 5.7500f},
+    {"sensor830s", 5.7500f},
+};
 
-  {
-    auto& make_specs = specs["agfaphoto"];
-    make_specs.reserve(53);
-    make_specs.emplace_back("compact100", 5.7500f);
-    make_specs.emplace_back("compact102", 6.1600f);
-    make_specs.emplace_back("compact103", 6.0800f);
-    make_specs.emplace_back("dc1030i", 7.1100f);
-    make_specs.emplace_back("dc1033m", 5.7500f);
-    make_specs.emplace_back("dc1033x", 7.1100f);
-    make_specs.emplace_back("dc1338i", 7.1100f);
-    make_specs.emplace_back("dc1338st", 7.1100f);
-    make_specs.emplace_back("dc2030m", 6.1600f);
-    make_specs.emplace_back("dc302", 4.8000f);
-    make_specs.emplace_back("dc500", 4.8000f);
-    make_specs.emplace_back("dc530i", 5.7500f);
-    make_specs.emplace_back("dc533", 5.7500f);
-    make_specs.emplace_back("dc600uw", 6.1600f);
-    make_specs.emplace_back("dc630i", 5.7500f);
-    make_specs.emplace_back("dc630x", 5.7500f);
-    make_specs.emplace_back("dc630", 5.7500f);
-    make_specs.emplace_back("dc633xs", 5.7500f);
-    make_specs.emplace_back("dc633x", 5.7500f);
-    make_specs.emplace_back("dc730i", 5.7500f);
-    make_specs.emplace_back("dc733i", 5.7500f);
-    make_specs.emplace_back("dc733s", 5.7500f);
-    make_specs.emplace_back("dc735i", 5.7500f);
-    make_specs.emplace_back("dc735", 5.7500f);
-    make_specs.emplace_back("dc738i", 5.7500f);
-    make_specs.emplace_back("dc830i", 7.1100f);
-    make_specs.emplace_back("dc830", 5.7500f);
-    make_specs.emplace_back("dc8330i", 5.7500f);
-    make_specs.emplace_back("dc8338i", 5.7500f);
-    make_specs.emplace_back("dc833m", 5.7500f);
-    make_specs.emplace_back("dc8428s", 7.1100f);
-    make_specs.emplace_back("ephoto1280", 6.1600f);
-    make_specs.emplace_back("ephoto1680", 6.1600f);
-    make_specs.emplace_back("ephotocl18", 6.1600f);
-    make_specs.emplace_back("ephotocl30clik!", 6.1600f);
-    make_specs.emplace_back("ephotocl30", 6.1600f);
-    make_specs.emplace_back("ephotocl45", 6.1600f);
-    make_specs.emplace_back("ephotocl50", 6.1600f);
-    make_specs.emplace_back("optima100", 6.0800f);
-    make_specs.emplace_back("optima102", 6.0800f);
-    make_specs.emplace_back("optima103", 6.1600f);
-    make_specs.emplace_back("optima104", 6.0800f);
-    make_specs.emplace_back("optima105", 6.1600f);
-    make_specs.emplace_back("optima1338mt", 6.1600f);
-    make_specs.emplace_back("optima1438m", 6.0800f);
-    make_specs.emplace_back("optima1", 6.0800f);
-    make_specs.emplace_back("optima3", 6.1600f);
-    make_specs.emplace_back("optima830uw", 5.7500f);
-    make_specs.emplace_back("optima8328m", 5.7500f);
-    make_specs.emplace_back("sensor505d", 5.7500f);
-    make_specs.emplace_back("sensor505x", 5.7500f);
-    make_specs.emplace_back("sensor530s", 5.7500f);
-    make_specs.emplace_back("sensor830s", 5.7500f);
-  }
+constexpr CameraModelSpecs kBenqModels[] = {
+    {"ac100", 6.1600f},
+    {"ae100", 6.1600f},
+    {"c1420", 6.0800f},
+    {"dc2300", 4.5000f},
+    {"dc2410", 5.3300f},
+    {"dc3400", 4.5000f},
+    {"dc3410", 4.5000f},
+    {"dc4330", 5.7500f},
+    {"dc4500", 5.7500f},
+    {"dc5330", 5.7500f},
+    {"dcc1000", 7.1100f},
+    {"dcc1020", 6.1600f},
+    {"dcc1030eco", 6.1600f},
+    {"dcc1035", 6.1600f},
+    {"dcc1050", 7.5300f},
+    {"dcc1060", 6.1600f},
+    {"dcc1220", 6.1600f},
+    {"dcc1230", 6.1600f},
+    {"dcc1250", 6.1600f},
+    {"dcc1255", 6.1600f},
+    {"dcc1430", 6.1600f},
+    {"dcc1450", 6.1600f},
+    {"dcc1460", 6.0800f},
+    {"dcc1480", 6.1600f},
+    {"dcc30", 5.7500f},
+    {"dcc35", 5.7500f},
+    {"dcc40", 5.7500f},
+    {"dcc420", 5.7500f},
+    {"dcc500", 5.7500f},
+    {"dcc50", 7.1100f},
+    {"dcc510", 5.7500f},
+    {"dcc51", 5.7500f},
+    {"dcc520", 5.7500f},
+    {"dcc530", 5.7500f},
+    {"dcc540", 5.7500f},
+    {"dcc60", 7.1100f},
+    {"dcc610", 5.7500f},
+    {"dcc62", 7.1100f},
+    {"dcc630", 5.7500f},
+    {"dcc640", 7.5300f},
+    {"dcc740i", 5.7500f},
+    {"dcc740", 5.7500f},
+    {"dcc750", 5.7500f},
+    {"dcc800", 7.1100f},
+    {"dcc840", 5.7500f},
+    {"dcc850", 5.7500f},
+    {"dce1000", 7.1100f},
+    {"dce1020", 6.1600f},
+    {"dce1030", 6.1600f},
+    {"dce1035", 6.1600f},
+    {"dce1050t", 6.1600f},
+    {"dce1050", 7.5300f},
+    {"dce1220", 6.1600f},
+    {"dce1230", 6.1600f},
+    {"dce1240", 6.1600f},
+    {"dce1250", 6.1600f},
+    {"dce1260", 6.1600f},
+    {"dce1280", 6.1600f},
+    {"dce1420", 6.1600f},
+    {"dce1430", 6.1600f},
+    {"dce1460", 6.1600f},
+    {"dce1465", 6.1600f},
+    {"dce300", 6.4000f},
+    {"dce30", 6.4000f},
+    {"dce310", 6.4000f},
+    {"dce40", 5.7500f},
+    {"dce41", 5.7500f},
+    {"dce43", 5.7500f},
+    {"dce510", 5.7500f},
+    {"dce520plus", 5.7500f},
+    {"dce520", 5.7500f},
+    {"dce53", 5.7500f},
+    {"dce600", 5.7500f},
+    {"dce605", 5.7500f},
+    {"dce610", 5.7500f},
+    {"dce63plus", 5.7500f},
+    {"dce720", 5.7500f},
+    {"dce800", 5.7500f},
+    {"dce820", 5.7500f},
+    {"dcl1020", 6.1600f},
+    {"dcp1410", 6.1600f},
+    {"dcp500", 5.7500f},
+    {"dcp860", 7.1100f},
+    {"dcs1430", 6.0800f},
+    {"dcs30", 5.3300f},
+    {"dcs40", 5.7500f},
+    {"dct1260", 6.1600f},
+    {"dct700", 5.7500f},
+    {"dct800", 6.0300f},
+    {"dct850", 5.7500f},
+    {"dcw1220", 6.1600f},
+    {"dcx600", 5.7500f},
+    {"dcx710", 5.7500f},
+    {"dcx720", 5.7500f},
+    {"dcx725", 5.7500f},
+    {"dcx735", 5.7500f},
+    {"dcx800", 5.7500f},
+    {"dcx835", 5.7500f},
+    {"e1480", 6.1600f},
+    {"g1", 6.1600f},
+    {"gh200", 6.1600f},
+    {"gh600", 6.1600f},
+    {"gh700", 6.1600f},
+    {"lm100", 6.1600f},
+    {"s1410", 6.0800f},
+    {"s1420", 6.1600f},
+    {"t1460", 6.1600f},
+};
 
-  {
-    auto& make_specs = specs["benq"];
-    make_specs.reserve(107);
-    make_specs.emplace_back("ac100", 6.1600f);
-    make_specs.emplace_back("ae100", 6.1600f);
-    make_specs.emplace_back("c1420", 6.0800f);
-    make_specs.emplace_back("dc2300", 4.5000f);
-    make_specs.emplace_back("dc2410", 5.3300f);
-    make_specs.emplace_back("dc3400", 4.5000f);
-    make_specs.emplace_back("dc3410", 4.5000f);
-    make_specs.emplace_back("dc4330", 5.7500f);
-    make_specs.emplace_back("dc4500", 5.7500f);
-    make_specs.emplace_back("dc5330", 5.7500f);
-    make_specs.emplace_back("dcc1000", 7.1100f);
-    make_specs.emplace_back("dcc1020", 6.1600f);
-    make_specs.emplace_back("dcc1030eco", 6.1600f);
-    make_specs.emplace_back("dcc1035", 6.1600f);
-    make_specs.emplace_back("dcc1050", 7.5300f);
-    make_specs.emplace_back("dcc1060", 6.1600f);
-    make_specs.emplace_back("dcc1220", 6.1600f);
-    make_specs.emplace_back("dcc1230", 6.1600f);
-    make_specs.emplace_back("dcc1250", 6.1600f);
-    make_specs.emplace_back("dcc1255", 6.1600f);
-    make_specs.emplace_back("dcc1430", 6.1600f);
-    make_specs.emplace_back("dcc1450", 6.1600f);
-    make_specs.emplace_back("dcc1460", 6.0800f);
-    make_specs.emplace_back("dcc1480", 6.1600f);
-    make_specs.emplace_back("dcc30", 5.7500f);
-    make_specs.emplace_back("dcc35", 5.7500f);
-    make_specs.emplace_back("dcc40", 5.7500f);
-    make_specs.emplace_back("dcc420", 5.7500f);
-    make_specs.emplace_back("dcc500", 5.7500f);
-    make_specs.emplace_back("dcc50", 7.1100f);
-    make_specs.emplace_back("dcc510", 5.7500f);
-    make_specs.emplace_back("dcc51", 5.7500f);
-    make_specs.emplace_back("dcc520", 5.7500f);
-    make_specs.emplace_back("dcc530", 5.7500f);
-    make_specs.emplace_back("dcc540", 5.7500f);
-    make_specs.emplace_back("dcc60", 7.1100f);
-    make_specs.emplace_back("dcc610", 5.7500f);
-    make_specs.emplace_back("dcc62", 7.1100f);
-    make_specs.emplace_back("dcc630", 5.7500f);
-    make_specs.emplace_back("dcc640", 7.5300f);
-    make_specs.emplace_back("dcc740i", 5.7500f);
-    make_specs.emplace_back("dcc740", 5.7500f);
-    make_specs.emplace_back("dcc750", 5.7500f);
-    make_specs.emplace_back("dcc800", 7.1100f);
-    make_specs.emplace_back("dcc840", 5.7500f);
-    make_specs.emplace_back("dcc850", 5.7500f);
-    make_specs.emplace_back("dce1000", 7.1100f);
-    make_specs.emplace_back("dce1020", 6.1600f);
-    make_specs.emplace_back("dce1030", 6.1600f);
-    make_specs.emplace_back("dce1035", 6.1600f);
-    make_specs.emplace_back("dce1050t", 6.1600f);
-    make_specs.emplace_back("dce1050", 7.5300f);
-    make_specs.emplace_back("dce1220", 6.1600f);
-    make_specs.emplace_back("dce1230", 6.1600f);
-    make_specs.emplace_back("dce1240", 6.1600f);
-    make_specs.emplace_back("dce1250", 6.1600f);
-    make_specs.emplace_back("dce1260", 6.1600f);
-    make_specs.emplace_back("dce1280", 6.1600f);
-    make_specs.emplace_back("dce1420", 6.1600f);
-    make_specs.emplace_back("dce1430", 6.1600f);
-    make_specs.emplace_back("dce1460", 6.1600f);
-    make_specs.emplace_back("dce1465", 6.1600f);
-    make_specs.emplace_back("dce300", 6.4000f);
-    make_specs.emplace_back("dce30", 6.4000f);
-    make_specs.emplace_back("dce310", 6.4000f);
-    make_specs.emplace_back("dce40", 5.7500f);
-    make_specs.emplace_back("dce41", 5.7500f);
-    make_specs.emplace_back("dce43", 5.7500f);
-    make_specs.emplace_back("dce510", 5.7500f);
-    make_specs.emplace_back("dce520plus", 5.7500f);
-    make_specs.emplace_back("dce520", 5.7500f);
-    make_specs.emplace_back("dce53", 5.7500f);
-    make_specs.emplace_back("dce600", 5.7500f);
-    make_specs.emplace_back("dce605", 5.7500f);
-    make_specs.emplace_back("dce610", 5.7500f);
-    make_specs.emplace_back("dce63plus", 5.7500f);
-    make_specs.emplace_back("dce720", 5.7500f);
-    make_specs.emplace_back("dce800", 5.7500f);
-    make_specs.emplace_back("dce820", 5.7500f);
-    make_specs.emplace_back("dcl1020", 6.1600f);
-    make_specs.emplace_back("dcp1410", 6.1600f);
-    make_specs.emplace_back("dcp500", 5.7500f);
-    make_specs.emplace_back("dcp860", 7.1100f);
-    make_specs.emplace_back("dcs1430", 6.0800f);
-    make_specs.emplace_back("dcs30", 5.3300f);
-    make_specs.emplace_back("dcs40", 5.7500f);
-    make_specs.emplace_back("dct1260", 6.1600f);
-    make_specs.emplace_back("dct700", 5.7500f);
-    make_specs.emplace_back("dct800", 6.0300f);
-    make_specs.emplace_back("dct850", 5.7500f);
-    make_specs.emplace_back("dcw1220", 6.1600f);
-    make_specs.emplace_back("dcx600", 5.7500f);
-    make_specs.emplace_back("dcx710", 5.7500f);
-    make_specs.emplace_back("dcx720", 5.7500f);
-    make_specs.emplace_back("dcx725", 5.7500f);
-    make_specs.emplace_back("dcx735", 5.7500f);
-    make_specs.emplace_back("dcx800", 5.7500f);
-    make_specs.emplace_back("dcx835", 5.7500f);
-    make_specs.emplace_back("e1480", 6.1600f);
-    make_specs.emplace_back("g1", 6.1600f);
-    make_specs.emplace_back("gh200", 6.1600f);
-    make_specs.emplace_back("gh600", 6.1600f);
-    make_specs.emplace_back("gh700", 6.1600f);
-    make_specs.emplace_back("lm100", 6.1600f);
-    make_specs.emplace_back("s1410", 6.0800f);
-    make_specs.emplace_back("s1420", 6.1600f);
-    make_specs.emplace_back("t1460", 6.1600f);
-  }
+constexpr CameraModelSpecs kCanonModels[] = {
+    {"digitalixus100is", 6.1600f},
+    {"digitalixus110is", 6.1600f},
+    {"digitalixus200is", 6.1600f},
+    {"digitalixus300", 5.3300f},
+    {"digitalixus330", 5.3300f},
+    {"digitalixus400", 7.1100f},
+    {"digitalixus40", 5.7500f},
+    {"digitalixus430", 7.1100f},
+    {"digitalixus500", 7.1100f},
+    {"digitalixus50", 5.7500f},
+    {"digitalixus60", 5.7500f},
+    {"digitalixus65", 5.7500f},
+    {"digitalixus80is", 5.7500f},
+    {"digitalixus800is", 5.7500f},
+    {"digitalixus85is", 6.1600f},
+    {"digitalixus850is", 5.7500f},
+    {"digitalixus860is", 5.7500f},
+    {"digitalixus870is", 6.1600f},
+    {"digitalixus90is", 6.1600f},
+    {"digitalixus900ti", 7.1100f},
+    {"digitalixus95is", 6.1600f},
+    {"digitalixus950is", 5.7500f},
+    {"digitalixus960is", 7.5300f},
+    {"digitalixus970is", 6.1600f},
+    {"digitalixus980is", 7.5300f},
+    {"digitalixus990is", 6.1600f},
+    {"digitalixusizoom", 5.7500f},
+    {"digitalixusi7", 5.7500f},
+    {"digitalixusiis", 5.3300f},
+    {"digitalixusii", 5.3300f},
+    {"digitalixusi", 5.7500f},
+    {"digitalixusv2", 5.3300f},
+    {"digitalixusv3", 5.3300f},
+    {"digitalixusv", 5.3300f},
+    {"digitalixus", 5.3300f},
+    {"elph135/ixus145", 6.1600f},
+    {"elph140is/ixus150", 6.1600f},
+    {"elph150is/ixus155", 6.1600f},
+    {"elph160/ixus160", 6.1600f},
+    {"elph170is/ixus170", 6.1600f},
+    {"eos1000d", 22.2000f},
+    {"eos10d", 22.7000f},
+    {"eos1dc", 36.0000f},
+    {"eos1dmarkiin", 28.7000f},
+    {"eos1dmarkiii", 28.7000f},
+    {"eos1dmarkii", 28.7000f},
+    {"eos1dmarkiv", 27.9000f},
+    {"eos1dx", 36.0000f},
+    {"eos1dsmarkiii", 36.0000f},
+    {"eos1dsmarkii", 36.0000f},
+    {"eos1ds", 35.8000f},
+    {"eos1d", 28.7000f},
+    {"eos20da", 22.5000f},
+    {"eos20d", 22.5000f},
+    {"eos300d", 22.7000f},
+    {"eos30d", 22.5000f},
+    {"eos350d", 22.2000f},
+    {"eos400d", 22.2000f},
+    {"eos40d", 22.2000f},
+    {"eos450d", 22.2000f},
+    {"eos500d", 22.3000f},
+    {"eos50d", 22.3000f},
+    {"eos5dmarkiii", 36.0000f},
+    {"eos5dmarkii", 36.0000f},
+    {"eos5dsr", 36.0000f},
+    {"eos5ds", 36.0000f},
+    {"eos5d", 35.8000f},
+    {"eos60da", 22.3000f},
+    {"eos60d", 22.3000f},
+    {"eos6d", 35.8000f},
+    {"eos70d", 22.5000f},
+    {"eos7dmarkii", 22.4000f},
+    {"eos7d", 22.3000f},
+    {"eosd30", 22.7000f},
+    {"eosd60", 22.7000f},
+    {"eosm10", 22.3000f},
+    {"eosm3", 22.3000f},
+    {"eosm", 22.3000f},
+    {"eosrebelsl1/100d", 22.3000f},
+    {"eosrebelt2i/550d", 22.3000f},
+    {"eosrebelt3i/600d", 22.3000f},
+    {"eosrebelt3/1100d", 22.2000f},
+    {"eosrebelt4i/650d", 22.3000f},
+    {"eosrebelt5i/700d", 22.3000f},
+    {"eosrebelt5/1200d", 22.3000f},
+    {"eosrebelt6i/750d", 22.3000f},
+    {"eosrebelt6s/760d", 22.3000f},
+    {"ixus1000hs", 6.1600f},
+    {"ixus105", 6.1600f},
+    {"ixus1100hs", 6.1600f},
+    {"ixus115hs", 6.1600f},
+    {"ixus125hs", 6.1600f},
+    {"ixus130", 6.1600f},
+    {"ixus132", 6.1600f},
+    {"ixus165", 6.1600f},
+    {"ixus210", 6.1600f},
+    {"ixus220hs", 6.1600f},
+    {"ixus230hs", 6.1600f},
+    {"ixus240hs", 6.1600f},
+    {"ixus300hs", 6.1600f},
+    {"ixus310hs", 6.1600f},
+    {"ixus500hs", 6.1600f},
+    {"ixus510hs", 6.1600f},
+    {"powershot350", 4.8000f},
+    {"powershot600", 4.8000f},
+    {"powershota1000is", 6.1600f},
+    {"powershota100", 4.5000f},
+    {"powershota10", 5.3300f},
+    {"powershota1100is", 6.1600f},
+    {"powershota1200", 6.1600f},
+    {"powershota1300", 6.1600f},
+    {"powershota1400", 6.1600f},
+    {"powershota2000is", 6.1600f},
+    {"powershota200", 4.5000f},
+    {"powershota20", 5.3300f},
+    {"powershota2100is", 6.1600f},
+    {"powershota2200", 6.1600f},
+    {"powershota2300", 6.1600f},
+    {"powershota2400is", 6.1600f},
+    {"powershota2500", 6.1600f},
+    {"powershota2600", 6.1600f},
+    {"powershota3000is", 6.1600f},
+    {"powershota300", 5.3300f},
+    {"powershota30", 5.3300f},
+    {"powershota3100is", 6.1600f},
+    {"powershota310", 5.3300f},
+    {"powershota3200is", 6.1600f},
+    {"powershota3300is", 6.1600f},
+    {"powershota3400is", 6.1600f},
+    {"powershota3500is", 6.1600f},
+    {"powershota4000is", 6.1600f},
+    {"powershota400", 4.5000f},
+    {"powershota40", 5.3300f},
+    {"powershota410", 4.5000f},
+    {"powershota420", 4.8000f},
+    {"powershota430", 4.8000f},
+    {"powershota450", 4.8000f},
+    {"powershota460", 4.8000f},
+    {"powershota470", 5.7500f},
+    {"powershota480", 6.1600f},
+    {"powershota490", 6.1600f},
+    {"powershota495", 6.1600f},
+    {"powershota5zoom", 4.8000f},
+    {"powershota50", 4.8000f},
+    {"powershota510", 5.3300f},
+    {"powershota520", 5.7500f},
+    {"powershota530", 5.7500f},
+    {"powershota540", 5.7500f},
+    {"powershota550", 5.7500f},
+    {"powershota560", 5.7500f},
+    {"powershota570is", 5.7500f},
+    {"powershota580", 5.7500f},
+    {"powershota590is", 5.7500f},
+    {"powershota5", 4.8000f},
+    {"powershota60", 5.3300f},
+    {"powershota610", 7.1100f},
+    {"powershota620", 7.1100f},
+    {"powershota630", 7.1100f},
+    {"powershota640", 7.1100f},
+    {"powershota650is", 7.5300f},
+    {"powershota700", 5.7500f},
+    {"powershota70", 5.3300f},
+    {"powershota710is", 5.7500f},
+    {"powershota720is", 5.7500f},
+    {"powershota75", 5.3300f},
+    {"powershota800", 6.1600f},
+    {"powershota80", 7.1100f},
+    {"powershota810", 6.1600f},
+    {"powershota85", 5.3300f},
+    {"powershota95", 7.1100f},
+    {"powershotd10", 6.1600f},
+    {"powershotd20", 6.1600f},
+    {"powershotd30", 6.1600f},
+    {"powershote1", 6.1600f},
+    {"powershotelph100hs", 6.1600f},
+    {"powershotelph110hs", 6.1600f},
+    {"powershotelph115is", 6.1600f},
+    {"powershotelph130is", 6.1600f},
+    {"powershotelph300hs", 6.1600f},
+    {"powershotelph310hs", 6.1600f},
+    {"powershotelph320hs", 6.1600f},
+    {"powershotelph330hs", 6.1600f},
+    {"powershotelph340hs", 6.1600f},
+    {"powershotelph350hs", 6.1600f},
+    {"powershotelph500hs", 6.1600f},
+    {"powershotelph510hs", 6.1600f},
+    {"powershotelph520hs", 6.1600f},
+    {"powershotelph530hs", 6.1600f},
+    {"powershotg1xmarkii", 18.7000f},
+    {"powershotg1x", 18.7000f},
+    {"powershotg10", 7.5300f},
+    {"powershotg11", 7.5300f},
+    {"powershotg12", 7.5300f},
+    {"powershotg15", 7.5300f},
+    {"powershotg16", 7.5300f},
+    {"powershotg1", 7.1100f},
+    {"powershotg2", 7.1100f},
+    {"powershotg3x", 13.2000f},
+    {"powershotg3", 7.1100f},
+    {"powershotg5x", 13.2000f},
+    {"powershotg5", 7.1100f},
+    {"powershotg6", 7.1100f},
+    {"powershotg7x", 13.2000f},
+    {"powershotg7", 7.1100f},
+    {"powershotg9x", 13.2000f},
+    {"powershotg9", 7.5300f},
+    {"powershotn100", 7.5300f},
+    {"powershotn2", 6.1600f},
+    {"powershotn", 6.1600f},
+    {"powershotpro1", 8.8000f},
+    {"powershotpro70", 6.4000f},
+    {"powershotpro90is", 7.1100f},
+    {"powershots1is", 5.3300f},
+    {"powershots100digitalixus", 5.3300f},
+    {"powershots100", 7.5300f},
+    {"powershots10", 6.4000f},
+    {"powershots110", 7.5300f},
+    {"powershots120", 7.5300f},
+    {"powershots2is", 5.7500f},
+    {"powershots200", 5.3300f},
+    {"powershots20", 7.1100f},
+    {"powershots230", 5.3300f},
+    {"powershots3is", 5.7500f},
+    {"powershots300", 5.3300f},
+    {"powershots30", 7.1100f},
+    {"powershots330", 5.3300f},
+    {"powershots400", 7.1100f},
+    {"powershots40", 7.1100f},
+    {"powershots410", 7.1100f},
+    {"powershots45", 7.1100f},
+    {"powershots5is", 5.7500f},
+    {"powershots500", 7.1100f},
+    {"powershots50", 7.1100f},
+    {"powershots60", 7.1100f},
+    {"powershots70", 7.1100f},
+    {"powershots80", 7.1100f},
+    {"powershots90", 7.5300f},
+    {"powershots95", 7.5300f},
+    {"powershotsd1000", 5.7500f},
+    {"powershotsd100", 5.3300f},
+    {"powershotsd10", 5.7500f},
+    {"powershotsd1100is", 5.7500f},
+    {"powershotsd110", 5.3300f},
+    {"powershotsd1200is", 6.1600f},
+    {"powershotsd1300is", 6.1600f},
+    {"powershotsd1400is", 6.1600f},
+    {"powershotsd200", 5.7500f},
+    {"powershotsd20", 5.7500f},
+    {"powershotsd300", 5.7500f},
+    {"powershotsd30", 5.7500f},
+    {"powershotsd3500is", 6.1600f},
+    {"powershotsd4000is", 6.1600f},
+    {"powershotsd400", 5.7500f},
+    {"powershotsd40", 5.7500f},
+    {"powershotsd430wireless", 5.7500f},
+    {"powershotsd4500is", 6.1600f},
+    {"powershotsd450", 5.7500f},
+    {"powershotsd500", 7.1100f},
+    {"powershotsd550", 7.1100f},
+    {"powershotsd600", 5.7500f},
+    {"powershotsd630", 5.7500f},
+    {"powershotsd700is", 5.7500f},
+    {"powershotsd750", 5.7500f},
+    {"powershotsd770is", 6.1600f},
+    {"powershotsd780is", 6.1600f},
+    {"powershotsd790is", 6.1600f},
+    {"powershotsd800is", 5.7500f},
+    {"powershotsd850is", 5.7500f},
+    {"powershotsd870is", 5.7500f},
+    {"powershotsd880is", 6.1600f},
+    {"powershotsd890is", 6.1600f},
+    {"powershotsd900", 7.1100f},
+    {"powershotsd940is", 6.1600f},
+    {"powershotsd950is", 7.5300f},
+    {"powershotsd960is", 6.1600f},
+    {"powershotsd970is", 6.1600f},
+    {"powershotsd980is", 6.1600f},
+    {"powershotsd990is", 7.5300f},
+    {"powershotsx1is", 6.1600f},
+    {"powershotsx10is", 6.1600f},
+    {"powershotsx100is", 5.7500f},
+    {"powershotsx110is", 6.1600f},
+    {"powershotsx120is", 5.7500f},
+    {"powershotsx130is", 6.1600f},
+    {"powershotsx150is", 6.1600f},
+    {"powershotsx160is", 6.1600f},
+    {"powershotsx170is", 6.1600f},
+    {"powershotsx20is", 6.1600f},
+    {"powershotsx200is", 6.1600f},
+    {"powershotsx210is", 6.1600f},
+    {"powershotsx220hs", 6.1600f},
+    {"powershotsx230hs", 6.1600f},
+    {"powershotsx240hs", 6.1600f},
+    {"powershotsx260hs", 6.1600f},
+    {"powershotsx270hs", 6.1600f},
+    {"powershotsx280hs", 6.1600f},
+    {"powershotsx30is", 6.1600f},
+    {"powershotsx40hs", 6.1600f},
+    {"powershotsx400is", 6.1600f},
+    {"powershotsx410is", 6.1600f},
+    {"powershotsx50hs", 6.1600f},
+    {"powershotsx500is", 6.1600f},
+    {"powershotsx510hs", 6.1600f},
+    {"powershotsx520hs", 6.1600f},
+    {"powershotsx530hs", 6.1600f},
+    {"powershotsx60hs", 6.1600f},
+    {"powershotsx600hs", 6.1600f},
+    {"powershotsx610hs", 6.1600f},
+    {"powershotsx700hs", 6.1600f},
+    {"powershotsx710hs", 6.1600f},
+    {"powershottx1", 5.7500f},
+    {"pro90is", 7.1100f},
+    {"s200", 7.5300f},
+    {"sx220hs", 6.1600f},
+};
 
-  {
-    auto& make_specs = specs["canon"];
-    make_specs.reserve(314);
-    make_specs.emplace_back("digitalixus100is", 6.1600f);
-    make_specs.emplace_back("digitalixus110is", 6.1600f);
-    make_specs.emplace_back("digitalixus200is", 6.1600f);
-    make_specs.emplace_back("digitalixus300", 5.3300f);
-    make_specs.emplace_back("digitalixus330", 5.3300f);
-    make_specs.emplace_back("digitalixus400", 7.1100f);
-    make_specs.emplace_back("digitalixus40", 5.7500f);
-    make_specs.emplace_back("digitalixus430", 7.1100f);
-    make_specs.emplace_back("digitalixus500", 7.1100f);
-    make_specs.emplace_back("digitalixus50", 5.7500f);
-    make_specs.emplace_back("digitalixus60", 5.7500f);
-    make_specs.emplace_back("digitalixus65", 5.7500f);
-    make_specs.emplace_back("digitalixus80is", 5.7500f);
-    make_specs.emplace_back("digitalixus800is", 5.7500f);
-    make_specs.emplace_back("digitalixus85is", 6.1600f);
-    make_specs.emplace_back("digitalixus850is", 5.7500f);
-    make_specs.emplace_back("digitalixus860is", 5.7500f);
-    make_specs.emplace_back("digitalixus870is", 6.1600f);
-    make_specs.emplace_back("digitalixus90is", 6.1600f);
-    make_specs.emplace_back("digitalixus900ti", 7.1100f);
-    make_specs.emplace_back("digitalixus95is", 6.1600f);
-    make_specs.emplace_back("digitalixus950is", 5.7500f);
-    make_specs.emplace_back("digitalixus960is", 7.5300f);
-    make_specs.emplace_back("digitalixus970is", 6.1600f);
-    make_specs.emplace_back("digitalixus980is", 7.5300f);
-    make_specs.emplace_back("digitalixus990is", 6.1600f);
-    make_specs.emplace_back("digitalixusizoom", 5.7500f);
-    make_specs.emplace_back("digitalixusi7", 5.7500f);
-    make_specs.emplace_back("digitalixusiis", 5.3300f);
-    make_specs.emplace_back("digitalixusii", 5.3300f);
-    make_specs.emplace_back("digitalixusi", 5.7500f);
-    make_specs.emplace_back("digitalixusv2", 5.3300f);
-    make_specs.emplace_back("digitalixusv3", 5.3300f);
-    make_specs.emplace_back("digitalixusv", 5.3300f);
-    make_specs.emplace_back("digitalixus", 5.3300f);
-    make_specs.emplace_back("elph135/ixus145", 6.1600f);
-    make_specs.emplace_back("elph140is/ixus150", 6.1600f);
-    make_specs.emplace_back("elph150is/ixus155", 6.1600f);
-    make_specs.emplace_back("elph160/ixus160", 6.1600f);
-    make_specs.emplace_back("elph170is/ixus170", 6.1600f);
-    make_specs.emplace_back("eos1000d", 22.2000f);
-    make_specs.emplace_back("eos10d", 22.7000f);
-    make_specs.emplace_back("eos1dc", 36.0000f);
-    make_specs.emplace_back("eos1dmarkiin", 28.7000f);
-    make_specs.emplace_back("eos1dmarkiii", 28.7000f);
-    make_specs.emplace_back("eos1dmarkii", 28.7000f);
-    make_specs.emplace_back("eos1dmarkiv", 27.9000f);
-    make_specs.emplace_back("eos1dx", 36.0000f);
-    make_specs.emplace_back("eos1dsmarkiii", 36.0000f);
-    make_specs.emplace_back("eos1dsmarkii", 36.0000f);
-    make_specs.emplace_back("eos1ds", 35.8000f);
-    make_specs.emplace_back("eos1d", 28.7000f);
-    make_specs.emplace_back("eos20da", 22.5000f);
-    make_specs.emplace_back("eos20d", 22.5000f);
-    make_specs.emplace_back("eos300d", 22.7000f);
-    make_specs.emplace_back("eos30d", 22.5000f);
-    make_specs.emplace_back("eos350d", 22.2000f);
-    make_specs.emplace_back("eos400d", 22.2000f);
-    make_specs.emplace_back("eos40d", 22.2000f);
-    make_specs.emplace_back("eos450d", 22.2000f);
-    make_specs.emplace_back("eos500d", 22.3000f);
-    make_specs.emplace_back("eos50d", 22.3000f);
-    make_specs.emplace_back("eos5dmarkiii", 36.0000f);
-    make_specs.emplace_back("eos5dmarkii", 36.0000f);
-    make_specs.emplace_back("eos5dsr", 36.0000f);
-    make_specs.emplace_back("eos5ds", 36.0000f);
-    make_specs.emplace_back("eos5d", 35.8000f);
-    make_specs.emplace_back("eos60da", 22.3000f);
-    make_specs.emplace_back("eos60d", 22.3000f);
-    make_specs.emplace_back("eos6d", 35.8000f);
-    make_specs.emplace_back("eos70d", 22.5000f);
-    make_specs.emplace_back("eos7dmarkii", 22.4000f);
-    make_specs.emplace_back("eos7d", 22.3000f);
-    make_specs.emplace_back("eosd30", 22.7000f);
-    make_specs.emplace_back("eosd60", 22.7000f);
-    make_specs.emplace_back("eosm10", 22.3000f);
-    make_specs.emplace_back("eosm3", 22.3000f);
-    make_specs.emplace_back("eosm", 22.3000f);
-    make_specs.emplace_back("eosrebelsl1/100d", 22.3000f);
-    make_specs.emplace_back("eosrebelt2i/550d", 22.3000f);
-    make_specs.emplace_back("eosrebelt3i/600d", 22.3000f);
-    make_specs.emplace_back("eosrebelt3/1100d", 22.2000f);
-    make_specs.emplace_back("eosrebelt4i/650d", 22.3000f);
-    make_specs.emplace_back("eosrebelt5i/700d", 22.3000f);
-    make_specs.emplace_back("eosrebelt5/1200d", 22.3000f);
-    make_specs.emplace_back("eosrebelt6i/750d", 22.3000f);
-    make_specs.emplace_back("eosrebelt6s/760d", 22.3000f);
-    make_specs.emplace_back("ixus1000hs", 6.1600f);
-    make_specs.emplace_back("ixus105", 6.1600f);
-    make_specs.emplace_back("ixus1100hs", 6.1600f);
-    make_specs.emplace_back("ixus115hs", 6.1600f);
-    make_specs.emplace_back("ixus125hs", 6.1600f);
-    make_specs.emplace_back("ixus130", 6.1600f);
-    make_specs.emplace_back("ixus132", 6.1600f);
-    make_specs.emplace_back("ixus165", 6.1600f);
-    make_specs.emplace_back("ixus210", 6.1600f);
-    make_specs.emplace_back("ixus220hs", 6.1600f);
-    make_specs.emplace_back("ixus230hs", 6.1600f);
-    make_specs.emplace_back("ixus240hs", 6.1600f);
-    make_specs.emplace_back("ixus300hs", 6.1600f);
-    make_specs.emplace_back("ixus310hs", 6.1600f);
-    make_specs.emplace_back("ixus500hs", 6.1600f);
-    make_specs.emplace_back("ixus510hs", 6.1600f);
-    make_specs.emplace_back("powershot350", 4.8000f);
-    make_specs.emplace_back("powershot600", 4.8000f);
-    make_specs.emplace_back("powershota1000is", 6.1600f);
-    make_specs.emplace_back("powershota100", 4.5000f);
-    make_specs.emplace_back("powershota10", 5.3300f);
-    make_specs.emplace_back("powershota1100is", 6.1600f);
-    make_specs.emplace_back("powershota1200", 6.1600f);
-    make_specs.emplace_back("powershota1300", 6.1600f);
-    make_specs.emplace_back("powershota1400", 6.1600f);
-    make_specs.emplace_back("powershota2000is", 6.1600f);
-    make_specs.emplace_back("powershota200", 4.5000f);
-    make_specs.emplace_back("powershota20", 5.3300f);
-    make_specs.emplace_back("powershota2100is", 6.1600f);
-    make_specs.emplace_back("powershota2200", 6.1600f);
-    make_specs.emplace_back("powershota2300", 6.1600f);
-    make_specs.emplace_back("powershota2400is", 6.1600f);
-    make_specs.emplace_back("powershota2500", 6.1600f);
-    make_specs.emplace_back("powershota2600", 6.1600f);
-    make_specs.emplace_back("powershota3000is", 6.1600f);
-    make_specs.emplace_back("powershota300", 5.3300f);
-    make_specs.emplace_back("powershota30", 5.3300f);
-    make_specs.emplace_back("powershota3100is", 6.1600f);
-    make_specs.emplace_back("powershota310", 5.3300f);
-    make_specs.emplace_back("powershota3200is", 6.1600f);
-    make_specs.emplace_back("powershota3300is", 6.1600f);
-    make_specs.emplace_back("powershota3400is", 6.1600f);
-    make_specs.emplace_back("powershota3500is", 6.1600f);
-    make_specs.emplace_back("powershota4000is", 6.1600f);
-    make_specs.emplace_back("powershota400", 4.5000f);
-    make_specs.emplace_back("powershota40", 5.3300f);
-    make_specs.emplace_back("powershota410", 4.5000f);
-    make_specs.emplace_back("powershota420", 4.8000f);
-    make_specs.emplace_back("powershota430", 4.8000f);
-    make_specs.emplace_back("powershota450", 4.8000f);
-    make_specs.emplace_back("powershota460", 4.8000f);
-    make_specs.emplace_back("powershota470", 5.7500f);
-    make_specs.emplace_back("powershota480", 6.1600f);
-    make_specs.emplace_back("powershota490", 6.1600f);
-    make_specs.emplace_back("powershota495", 6.1600f);
-    make_specs.emplace_back("powershota5zoom", 4.8000f);
-    make_specs.emplace_back("powershota50", 4.8000f);
-    make_specs.emplace_back("powershota510", 5.3300f);
-    make_specs.emplace_back("powershota520", 5.7500f);
-    make_specs.emplace_back("powershota530", 5.7500f);
-    make_specs.emplace_back("powershota540", 5.7500f);
-    make_specs.emplace_back("powershota550", 5.7500f);
-    make_specs.emplace_back("powershota560", 5.7500f);
-    make_specs.emplace_back("powershota570is", 5.7500f);
-    make_specs.emplace_back("powershota580", 5.7500f);
-    make_specs.emplace_back("powershota590is", 5.7500f);
-    make_specs.emplace_back("powershota5", 4.8000f);
-    make_specs.emplace_back("powershota60", 5.3300f);
-    make_specs.emplace_back("powershota610", 7.1100f);
-    make_specs.emplace_back("powershota620", 7.1100f);
-    make_specs.emplace_back("powershota630", 7.1100f);
-    make_specs.emplace_back("powershota640", 7.1100f);
-    make_specs.emplace_back("powershota650is", 7.5300f);
-    make_specs.emplace_back("powershota700", 5.7500f);
-    make_specs.emplace_back("powershota70", 5.3300f);
-    make_specs.emplace_back("powershota710is", 5.7500f);
-    make_specs.emplace_back("powershota720is", 5.7500f);
-    make_specs.emplace_back("powershota75", 5.3300f);
-    make_specs.emplace_back("powershota800", 6.1600f);
-    make_specs.emplace_back("powershota80", 7.1100f);
-    make_specs.emplace_back("powershota810", 6.1600f);
-    make_specs.emplace_back("powershota85", 5.3300f);
-    make_specs.emplace_back("powershota95", 7.1100f);
-    make_specs.emplace_back("powershotd10", 6.1600f);
-    make_specs.emplace_back("powershotd20", 6.1600f);
-    make_specs.emplace_back("powershotd30", 6.1600f);
-    make_specs.emplace_back("powershote1", 6.1600f);
-    make_specs.emplace_back("powershotelph100hs", 6.1600f);
-    make_specs.emplace_back("powershotelph110hs", 6.1600f);
-    make_specs.emplace_back("powershotelph115is", 6.1600f);
-    make_specs.emplace_back("powershotelph130is", 6.1600f);
-    make_specs.emplace_back("powershotelph300hs", 6.1600f);
-    make_specs.emplace_back("powershotelph310hs", 6.1600f);
-    make_specs.emplace_back("powershotelph320hs", 6.1600f);
-    make_specs.emplace_back("powershotelph330hs", 6.1600f);
-    make_specs.emplace_back("powershotelph340hs", 6.1600f);
-    make_specs.emplace_back("powershotelph350hs", 6.1600f);
-    make_specs.emplace_back("powershotelph500hs", 6.1600f);
-    make_specs.emplace_back("powershotelph510hs", 6.1600f);
-    make_specs.emplace_back("powershotelph520hs", 6.1600f);
-    make_specs.emplace_back("powershotelph530hs", 6.1600f);
-    make_specs.emplace_back("powershotg1xmarkii", 18.7000f);
-    make_specs.emplace_back("powershotg1x", 18.7000f);
-    make_specs.emplace_back("powershotg10", 7.5300f);
-    make_specs.emplace_back("powershotg11", 7.5300f);
-    make_specs.emplace_back("powershotg12", 7.5300f);
-    make_specs.emplace_back("powershotg15", 7.5300f);
-    make_specs.emplace_back("powershotg16", 7.5300f);
-    make_specs.emplace_back("powershotg1", 7.1100f);
-    make_specs.emplace_back("powershotg2", 7.1100f);
-    make_specs.emplace_back("powershotg3x", 13.2000f);
-    make_specs.emplace_back("powershotg3", 7.1100f);
-    make_specs.emplace_back("powershotg5x", 13.2000f);
-    make_specs.emplace_back("powershotg5", 7.1100f);
-    make_specs.emplace_back("powershotg6", 7.1100f);
-    make_specs.emplace_back("powershotg7x", 13.2000f);
-    make_specs.emplace_back("powershotg7", 7.1100f);
-    make_specs.emplace_back("powershotg9x", 13.2000f);
-    make_specs.emplace_back("powershotg9", 7.5300f);
-    make_specs.emplace_back("powershotn100", 7.5300f);
-    make_specs.emplace_back("powershotn2", 6.1600f);
-    make_specs.emplace_back("powershotn", 6.1600f);
-    make_specs.emplace_back("powershotpro1", 8.8000f);
-    make_specs.emplace_back("powershotpro70", 6.4000f);
-    make_specs.emplace_back("powershotpro90is", 7.1100f);
-    make_specs.emplace_back("powershots1is", 5.3300f);
-    make_specs.emplace_back("powershots100digitalixus", 5.3300f);
-    make_specs.emplace_back("powershots100", 7.5300f);
-    make_specs.emplace_back("powershots10", 6.4000f);
-    make_specs.emplace_back("powershots110", 7.5300f);
-    make_specs.emplace_back("powershots120", 7.5300f);
-    make_specs.emplace_back("powershots2is", 5.7500f);
-    make_specs.emplace_back("powershots200", 5.3300f);
-    make_specs.emplace_back("powershots20", 7.1100f);
-    make_specs.emplace_back("powershots230", 5.3300f);
-    make_specs.emplace_back("powershots3is", 5.7500f);
-    make_specs.emplace_back("powershots300", 5.3300f);
-    make_specs.emplace_back("powershots30", 7.1100f);
-    make_specs.emplace_back("powershots330", 5.3300f);
-    make_specs.emplace_back("powershots400", 7.1100f);
-    make_specs.emplace_back("powershots40", 7.1100f);
-    make_specs.emplace_back("powershots410", 7.1100f);
-    make_specs.emplace_back("powershots45", 7.1100f);
-    make_specs.emplace_back("powershots5is", 5.7500f);
-    make_specs.emplace_back("powershots500", 7.1100f);
-    make_specs.emplace_back("powershots50", 7.1100f);
-    make_specs.emplace_back("powershots60", 7.1100f);
-    make_specs.emplace_back("powershots70", 7.1100f);
-    make_specs.emplace_back("powershots80", 7.1100f);
-    make_specs.emplace_back("powershots90", 7.5300f);
-    make_specs.emplace_back("powershots95", 7.5300f);
-    make_specs.emplace_back("powershotsd1000", 5.7500f);
-    make_specs.emplace_back("powershotsd100", 5.3300f);
-    make_specs.emplace_back("powershotsd10", 5.7500f);
-    make_specs.emplace_back("powershotsd1100is", 5.7500f);
-    make_specs.emplace_back("powershotsd110", 5.3300f);
-    make_specs.emplace_back("powershotsd1200is", 6.1600f);
-    make_specs.emplace_back("powershotsd1300is", 6.1600f);
-    make_specs.emplace_back("powershotsd1400is", 6.1600f);
-    make_specs.emplace_back("powershotsd200", 5.7500f);
-    make_specs.emplace_back("powershotsd20", 5.7500f);
-    make_specs.emplace_back("powershotsd300", 5.7500f);
-    make_specs.emplace_back("powershotsd30", 5.7500f);
-    make_specs.emplace_back("powershotsd3500is", 6.1600f);
-    make_specs.emplace_back("powershotsd4000is", 6.1600f);
-    make_specs.emplace_back("powershotsd400", 5.7500f);
-    make_specs.emplace_back("powershotsd40", 5.7500f);
-    make_specs.emplace_back("powershotsd430wireless", 5.7500f);
-    make_specs.emplace_back("powershotsd4500is", 6.1600f);
-    make_specs.emplace_back("powershotsd450", 5.7500f);
-    make_specs.emplace_back("powershotsd500", 7.1100f);
-    make_specs.emplace_back("powershotsd550", 7.1100f);
-    make_specs.emplace_back("powershotsd600", 5.7500f);
-    make_specs.emplace_back("powershotsd630", 5.7500f);
-    make_specs.emplace_back("powershotsd700is", 5.7500f);
-    make_specs.emplace_back("powershotsd750", 5.7500f);
-    make_specs.emplace_back("powershotsd770is", 6.1600f);
-    make_specs.emplace_back("powershotsd780is", 6.1600f);
-    make_specs.emplace_back("powershotsd790is", 6.1600f);
-    make_specs.emplace_back("powershotsd800is", 5.7500f);
-    make_specs.emplace_back("powershotsd850is", 5.7500f);
-    make_specs.emplace_back("powershotsd870is", 5.7500f);
-    make_specs.emplace_back("powershotsd880is", 6.1600f);
-    make_specs.emplace_back("powershotsd890is", 6.1600f);
-    make_specs.emplace_back("powershotsd900", 7.1100f);
-    make_specs.emplace_back("powershotsd940is", 6.1600f);
-    make_specs.emplace_back("powershotsd950is", 7.5300f);
-    make_specs.emplace_back("powershotsd960is", 6.1600f);
-    make_specs.emplace_back("powershotsd970is", 6.1600f);
-    make_specs.emplace_back("powershotsd980is", 6.1600f);
-    make_specs.emplace_back("powershotsd990is", 7.5300f);
-    make_specs.emplace_back("powershotsx1is", 6.1600f);
-    make_specs.emplace_back("powershotsx10is", 6.1600f);
-    make_specs.emplace_back("powershotsx100is", 5.7500f);
-    make_specs.emplace_back("powershotsx110is", 6.1600f);
-    make_specs.emplace_back("powershotsx120is", 5.7500f);
-    make_specs.emplace_back("powershotsx130is", 6.1600f);
-    make_specs.emplace_back("powershotsx150is", 6.1600f);
-    make_specs.emplace_back("powershotsx160is", 6.1600f);
-    make_specs.emplace_back("powershotsx170is", 6.1600f);
-    make_specs.emplace_back("powershotsx20is", 6.1600f);
-    make_specs.emplace_back("powershotsx200is", 6.1600f);
-    make_specs.emplace_back("powershotsx210is", 6.1600f);
-    make_specs.emplace_back("powershotsx220hs", 6.1600f);
-    make_specs.emplace_back("powershotsx230hs", 6.1600f);
-    make_specs.emplace_back("powershotsx240hs", 6.1600f);
-    make_specs.emplace_back("powershotsx260hs", 6.1600f);
-    make_specs.emplace_back("powershotsx270hs", 6.1600f);
-    make_specs.emplace_back("powershotsx280hs", 6.1600f);
-    make_specs.emplace_back("powershotsx30is", 6.1600f);
-    make_specs.emplace_back("powershotsx40hs", 6.1600f);
-    make_specs.emplace_back("powershotsx400is", 6.1600f);
-    make_specs.emplace_back("powershotsx410is", 6.1600f);
-    make_specs.emplace_back("powershotsx50hs", 6.1600f);
-    make_specs.emplace_back("powershotsx500is", 6.1600f);
-    make_specs.emplace_back("powershotsx510hs", 6.1600f);
-    make_specs.emplace_back("powershotsx520hs", 6.1600f);
-    make_specs.emplace_back("powershotsx530hs", 6.1600f);
-    make_specs.emplace_back("powershotsx60hs", 6.1600f);
-    make_specs.emplace_back("powershotsx600hs", 6.1600f);
-    make_specs.emplace_back("powershotsx610hs", 6.1600f);
-    make_specs.emplace_back("powershotsx700hs", 6.1600f);
-    make_specs.emplace_back("powershotsx710hs", 6.1600f);
-    make_specs.emplace_back("powershottx1", 5.7500f);
-    make_specs.emplace_back("pro90is", 7.1100f);
-    make_specs.emplace_back("s200", 7.5300f);
-    make_specs.emplace_back("sx220hs", 6.1600f);
-  }
+constexpr CameraModelSpecs kCasioModels[] = {
+    {"exfr10", 6.1600f},
+    {"exilimexje10", 6.1600f},
+    {"exn10", 6.1600f},
+    {"exn1", 6.1600f},
+    {"exn20", 6.1600f},
+    {"exn50", 6.1600f},
+    {"exn5", 6.1600f},
+    {"extr10", 6.1600f},
+    {"extr15", 6.1600f},
+    {"exzr400", 6.1600f},
+    {"exzr700", 6.1600f},
+    {"exzr800", 6.1600f},
+    {"exzs30", 6.1600f},
+    {"exilimex100", 7.5300f},
+    {"exilimex10", 7.5300f},
+    {"exilimexfc100", 6.1600f},
+    {"exilimexfc150", 6.1600f},
+    {"exilimexfc160s", 6.1600f},
+    {"exilimexfh100", 6.1600f},
+    {"exilimexfh150", 6.1600f},
+    {"exilimexfh20", 6.1600f},
+    {"exilimexfh25", 6.1600f},
+    {"exilimexfs10", 6.1600f},
+    {"exilimexg1", 6.1600f},
+    {"exilimexh10", 6.1600f},
+    {"exilimexh15", 6.1600f},
+    {"exilimexh20g", 6.1600f},
+    {"exilimexh30", 6.1600f},
+    {"exilimexh50", 6.1600f},
+    {"exilimexh5", 6.1600f},
+    {"exilimexm1", 5.3300f},
+    {"exilimexm20", 5.3300f},
+    {"exilimexm2", 7.1100f},
+    {"exilimexp505", 5.7500f},
+    {"exilimexp600", 7.1100f},
+    {"exilimexp700", 7.1100f},
+    {"exilimexs100", 4.5000f},
+    {"exilimexs10", 6.1600f},
+    {"exilimexs12", 6.1600f},
+    {"exilimexs1", 5.3300f},
+    {"exilimexs200", 6.1600f},
+    {"exilimexs20", 5.3300f},
+    {"exilimexs2", 7.1100f},
+    {"exilimexs3", 7.1100f},
+    {"exilimexs500", 5.7500f},
+    {"exilimexs5", 6.1600f},
+    {"exilimexs600d", 5.7500f},
+    {"exilimexs600", 5.7500f},
+    {"exilimexs770d", 5.7500f},
+    {"exilimexs770", 5.7500f},
+    {"exilimexs7", 6.1600f},
+    {"exilimexs880", 5.7500f},
+    {"exilimexs8", 6.0800f},
+    {"exilimextr100", 6.1600f},
+    {"exilimextr150", 6.1600f},
+    {"exilimexv7", 5.7500f},
+    {"exilimexv8", 5.7500f},
+    {"exilimexz1000", 7.1100f},
+    {"exilimexz100", 6.1600f},
+    {"exilimexz1050", 7.3100f},
+    {"exilimexz1080", 7.3100f},
+    {"exilimexz10", 5.7500f},
+    {"exilimexz110", 5.7500f},
+    {"exilimexz1200sr", 7.5300f},
+    {"exilimexz120", 7.1100f},
+    {"exilimexz150", 5.7500f},
+    {"exilimexz16", 6.1600f},
+    {"exilimexz19", 5.7500f},
+    {"exilimexz1", 6.1600f},
+    {"exilimexz2000", 6.1600f},
+    {"exilimexz200", 6.1600f},
+    {"exilimexz20", 5.7500f},
+    {"exilimexz2300", 6.1600f},
+    {"exilimexz250", 5.7500f},
+    {"exilimexz25", 6.1600f},
+    {"exilimexz270", 5.7500f},
+    {"exilimexz280", 5.7500f},
+    {"exilimexz29", 5.7500f},
+    {"exilimexz2", 6.1600f},
+    {"exilimexz3000", 6.1600f},
+    {"exilimexz300", 6.1600f},
+    {"exilimexz30", 5.7500f},
+    {"exilimexz330", 6.1600f},
+    {"exilimexz33", 6.1600f},
+    {"exilimexz350", 6.1600f},
+    {"exilimexz35", 6.1600f},
+    {"exilimexz3", 5.7500f},
+    {"exilimexz400", 6.1600f},
+    {"exilimexz40", 5.7500f},
+    {"exilimexz450", 6.1600f},
+    {"exilimexz4", 5.7500f},
+    {"exilimexz500", 5.7500f},
+    {"exilimexz50", 5.7500f},
+    {"exilimexz550", 6.1600f},
+    {"exilimexz55", 5.7500f},
+    {"exilimexz57", 5.7500f},
+    {"exilimexz5", 5.7500f},
+    {"exilimexz600", 5.7500f},
+    {"exilimexz60", 7.1100f},
+    {"exilimexz65", 5.7500f},
+    {"exilimexz6", 5.7500f},
+    {"exilimexz700", 5.7500f},
+    {"exilimexz70", 5.7500f},
+    {"exilimexz750", 7.1100f},
+    {"exilimexz75", 5.7500f},
+    {"exilimexz77", 5.7500f},
+    {"exilimexz7", 5.7500f},
+    {"exilimexz800", 6.1600f},
+    {"exilimexz80", 5.7500f},
+    {"exilimexz850", 7.1100f},
+    {"exilimexz85", 5.7500f},
+    {"exilimexz8", 5.7500f},
+    {"exilimexz90", 6.1600f},
+    {"exilimexz9", 5.7500f},
+    {"exilimexzr1000", 6.1600f},
+    {"exilimexzr100", 6.1600f},
+    {"exilimexzr10", 6.1600f},
+    {"exilimexzr1100", 6.1600f},
+    {"exilimexzr15", 6.1600f},
+    {"exilimexzr200", 6.1600f},
+    {"exilimexzr20", 6.1600f},
+    {"exilimexzr300", 6.1600f},
+    {"exilimexzs100", 6.1600f},
+    {"exilimexzs10", 6.1600f},
+    {"exilimexzs12", 6.1600f},
+    {"exilimexzs150", 6.1600f},
+    {"exilimexzs15", 6.1600f},
+    {"exilimexzs20", 6.1600f},
+    {"exilimexzs5", 6.1600f},
+    {"exilimexzs6", 6.1600f},
+    {"exilimproexf1", 7.1100f},
+    {"exilimqvr100", 6.1600f},
+    {"exilimtryx", 6.1600f},
+    {"gv10", 4.5000f},
+    {"gv20", 4.5000f},
+    {"qv2000ux", 6.4000f},
+    {"qv2100", 5.3300f},
+    {"qv2300ux", 5.3300f},
+    {"qv2400ux", 5.3300f},
+    {"qv2800ux", 5.3300f},
+    {"qv2900ux", 5.3300f},
+    {"qv3000ex", 7.1100f},
+    {"qv300", 4.8000f},
+    {"qv3500ex", 7.1100f},
+    {"qv3ex/xv3", 7.1100f},
+    {"qv4000", 7.1100f},
+    {"qv5000sx", 4.8000f},
+    {"qv5500sx", 4.8000f},
+    {"qv5700", 7.1100f},
+    {"qv7000sx", 4.8000f},
+    {"qv700", 4.8000f},
+    {"qv770", 4.8000f},
+    {"qv8000sx", 4.8000f},
+    {"qvr3", 7.1100f},
+    {"qvr40", 7.1100f},
+    {"qvr41", 7.1100f},
+    {"qvr4", 7.1100f},
+    {"qvr51", 7.1100f},
+    {"qvr52", 7.1100f},
+    {"qvr61", 7.1100f},
+    {"qvr62", 7.1100f},
+};
 
-  {
-    auto& make_specs = specs["casio"];
-    make_specs.reserve(161);
-    make_specs.emplace_back("exfr10", 6.1600f);
-    make_specs.emplace_back("exilimexje10", 6.1600f);
-    make_specs.emplace_back("exn10", 6.1600f);
-    make_specs.emplace_back("exn1", 6.1600f);
-    make_specs.emplace_back("exn20", 6.1600f);
-    make_specs.emplace_back("exn50", 6.1600f);
-    make_specs.emplace_back("exn5", 6.1600f);
-    make_specs.emplace_back("extr10", 6.1600f);
-    make_specs.emplace_back("extr15", 6.1600f);
-    make_specs.emplace_back("exzr400", 6.1600f);
-    make_specs.emplace_back("exzr700", 6.1600f);
-    make_specs.emplace_back("exzr800", 6.1600f);
-    make_specs.emplace_back("exzs30", 6.1600f);
-    make_specs.emplace_back("exilimex100", 7.5300f);
-    make_specs.emplace_back("exilimex10", 7.5300f);
-    make_specs.emplace_back("exilimexfc100", 6.1600f);
-    make_specs.emplace_back("exilimexfc150", 6.1600f);
-    make_specs.emplace_back("exilimexfc160s", 6.1600f);
-    make_specs.emplace_back("exilimexfh100", 6.1600f);
-    make_specs.emplace_back("exilimexfh150", 6.1600f);
-    make_specs.emplace_back("exilimexfh20", 6.1600f);
-    make_specs.emplace_back("exilimexfh25", 6.1600f);
-    make_specs.emplace_back("exilimexfs10", 6.1600f);
-    make_specs.emplace_back("exilimexg1", 6.1600f);
-    make_specs.emplace_back("exilimexh10", 6.1600f);
-    make_specs.emplace_back("exilimexh15", 6.1600f);
-    make_specs.emplace_back("exilimexh20g", 6.1600f);
-    make_specs.emplace_back("exilimexh30", 6.1600f);
-    make_specs.emplace_back("exilimexh50", 6.1600f);
-    make_specs.emplace_back("exilimexh5", 6.1600f);
-    make_specs.emplace_back("exilimexm1", 5.3300f);
-    make_specs.emplace_back("exilimexm20", 5.3300f);
-    make_specs.emplace_back("exilimexm2", 7.1100f);
-    make_specs.emplace_back("exilimexp505", 5.7500f);
-    make_specs.emplace_back("exilimexp600", 7.1100f);
-    make_specs.emplace_back("exilimexp700", 7.1100f);
-    make_specs.emplace_back("exilimexs100", 4.5000f);
-    make_specs.emplace_back("exilimexs10", 6.1600f);
-    make_specs.emplace_back("exilimexs12", 6.1600f);
-    make_specs.emplace_back("exilimexs1", 5.3300f);
-    make_specs.emplace_back("exilimexs200", 6.1600f);
-    make_specs.emplace_back("exilimexs20", 5.3300f);
-    make_specs.emplace_back("exilimexs2", 7.1100f);
-    make_specs.emplace_back("exilimexs3", 7.1100f);
-    make_specs.emplace_back("exilimexs500", 5.7500f);
-    make_specs.emplace_back("exilimexs5", 6.1600f);
-    make_specs.emplace_back("exilimexs600d", 5.7500f);
-    make_specs.emplace_back("exilimexs600", 5.7500f);
-    make_specs.emplace_back("exilimexs770d", 5.7500f);
-    make_specs.emplace_back("exilimexs770", 5.7500f);
-    make_specs.emplace_back("exilimexs7", 6.1600f);
-    make_specs.emplace_back("exilimexs880", 5.7500f);
-    make_specs.emplace_back("exilimexs8", 6.0800f);
-    make_specs.emplace_back("exilimextr100", 6.1600f);
-    make_specs.emplace_back("exilimextr150", 6.1600f);
-    make_specs.emplace_back("exilimexv7", 5.7500f);
-    make_specs.emplace_back("exilimexv8", 5.7500f);
-    make_specs.emplace_back("exilimexz1000", 7.1100f);
-    make_specs.emplace_back("exilimexz100", 6.1600f);
-    make_specs.emplace_back("exilimexz1050", 7.3100f);
-    make_specs.emplace_back("exilimexz1080", 7.3100f);
-    make_specs.emplace_back("exilimexz10", 5.7500f);
-    make_specs.emplace_back("exilimexz110", 5.7500f);
-    make_specs.emplace_back("exilimexz1200sr", 7.5300f);
-    make_specs.emplace_back("exilimexz120", 7.1100f);
-    make_specs.emplace_back("exilimexz150", 5.7500f);
-    make_specs.emplace_back("exilimexz16", 6.1600f);
-    make_specs.emplace_back("exilimexz19", 5.7500f);
-    make_specs.emplace_back("exilimexz1", 6.1600f);
-    make_specs.emplace_back("exilimexz2000", 6.1600f);
-    make_specs.emplace_back("exilimexz200", 6.1600f);
-    make_specs.emplace_back("exilimexz20", 5.7500f);
-    make_specs.emplace_back("exilimexz2300", 6.1600f);
-    make_specs.emplace_back("exilimexz250", 5.7500f);
-    make_specs.emplace_back("exilimexz25", 6.1600f);
-    make_specs.emplace_back("exilimexz270", 5.7500f);
-    make_specs.emplace_back("exilimexz280", 5.7500f);
-    make_specs.emplace_back("exilimexz29", 5.7500f);
-    make_specs.emplace_back("exilimexz2", 6.1600f);
-    make_specs.emplace_back("exilimexz3000", 6.1600f);
-    make_specs.emplace_back("exilimexz300", 6.1600f);
-    make_specs.emplace_back("exilimexz30", 5.7500f);
-    make_specs.emplace_back("exilimexz330", 6.1600f);
-    make_specs.emplace_back("exilimexz33", 6.1600f);
-    make_specs.emplace_back("exilimexz350", 6.1600f);
-    make_specs.emplace_back("exilimexz35", 6.1600f);
-    make_specs.emplace_back("exilimexz3", 5.7500f);
-    make_specs.emplace_back("exilimexz400", 6.1600f);
-    make_specs.emplace_back("exilimexz40", 5.7500f);
-    make_specs.emplace_back("exilimexz450", 6.1600f);
-    make_specs.emplace_back("exilimexz4", 5.7500f);
-    make_specs.emplace_back("exilimexz500", 5.7500f);
-    make_specs.emplace_back("exilimexz50", 5.7500f);
-    make_specs.emplace_back("exilimexz550", 6.1600f);
-    make_specs.emplace_back("exilimexz55", 5.7500f);
-    make_specs.emplace_back("exilimexz57", 5.7500f);
-    make_specs.emplace_back("exilimexz5", 5.7500f);
-    make_specs.emplace_back("exilimexz600", 5.7500f);
-    make_specs.emplace_back("exilimexz60", 7.1100f);
-    make_specs.emplace_back("exilimexz65", 5.7500f);
-    make_specs.emplace_back("exilimexz6", 5.7500f);
-    make_specs.emplace_back("exilimexz700", 5.7500f);
-    make_specs.emplace_back("exilimexz70", 5.7500f);
-    make_specs.emplace_back("exilimexz750", 7.1100f);
-    make_specs.emplace_back("exilimexz75", 5.7500f);
-    make_specs.emplace_back("exilimexz77", 5.7500f);
-    make_specs.emplace_back("exilimexz7", 5.7500f);
-    make_specs.emplace_back("exilimexz800", 6.1600f);
-    make_specs.emplace_back("exilimexz80", 5.7500f);
-    make_specs.emplace_back("exilimexz850", 7.1100f);
-    make_specs.emplace_back("exilimexz85", 5.7500f);
-    make_specs.emplace_back("exilimexz8", 5.7500f);
-    make_specs.emplace_back("exilimexz90", 6.1600f);
-    make_specs.emplace_back("exilimexz9", 5.7500f);
-    make_specs.emplace_back("exilimexzr1000", 6.1600f);
-    make_specs.emplace_back("exilimexzr100", 6.1600f);
-    make_specs.emplace_back("exilimexzr10", 6.1600f);
-    make_specs.emplace_back("exilimexzr1100", 6.1600f);
-    make_specs.emplace_back("exilimexzr15", 6.1600f);
-    make_specs.emplace_back("exilimexzr200", 6.1600f);
-    make_specs.emplace_back("exilimexzr20", 6.1600f);
-    make_specs.emplace_back("exilimexzr300", 6.1600f);
-    make_specs.emplace_back("exilimexzs100", 6.1600f);
-    make_specs.emplace_back("exilimexzs10", 6.1600f);
-    make_specs.emplace_back("exilimexzs12", 6.1600f);
-    make_specs.emplace_back("exilimexzs150", 6.1600f);
-    make_specs.emplace_back("exilimexzs15", 6.1600f);
-    make_specs.emplace_back("exilimexzs20", 6.1600f);
-    make_specs.emplace_back("exilimexzs5", 6.1600f);
-    make_specs.emplace_back("exilimexzs6", 6.1600f);
-    make_specs.emplace_back("exilimproexf1", 7.1100f);
-    make_specs.emplace_back("exilimqvr100", 6.1600f);
-    make_specs.emplace_back("exilimtryx", 6.1600f);
-    make_specs.emplace_back("gv10", 4.5000f);
-    make_specs.emplace_back("gv20", 4.5000f);
-    make_specs.emplace_back("qv2000ux", 6.4000f);
-    make_specs.emplace_back("qv2100", 5.3300f);
-    make_specs.emplace_back("qv2300ux", 5.3300f);
-    make_specs.emplace_back("qv2400ux", 5.3300f);
-    make_specs.emplace_back("qv2800ux", 5.3300f);
-    make_specs.emplace_back("qv2900ux", 5.3300f);
-    make_specs.emplace_back("qv3000ex", 7.1100f);
-    make_specs.emplace_back("qv300", 4.8000f);
-    make_specs.emplace_back("qv3500ex", 7.1100f);
-    make_specs.emplace_back("qv3ex/xv3", 7.1100f);
-    make_specs.emplace_back("qv4000", 7.1100f);
-    make_specs.emplace_back("qv5000sx", 4.8000f);
-    make_specs.emplace_back("qv5500sx", 4.8000f);
-    make_specs.emplace_back("qv5700", 7.1100f);
-    make_specs.emplace_back("qv7000sx", 4.8000f);
-    make_specs.emplace_back("qv700", 4.8000f);
-    make_specs.emplace_back("qv770", 4.8000f);
-    make_specs.emplace_back("qv8000sx", 4.8000f);
-    make_specs.emplace_back("qvr3", 7.1100f);
-    make_specs.emplace_back("qvr40", 7.1100f);
-    make_specs.emplace_back("qvr41", 7.1100f);
-    make_specs.emplace_back("qvr4", 7.1100f);
-    make_specs.emplace_back("qvr51", 7.1100f);
-    make_specs.emplace_back("qvr52", 7.1100f);
-    make_specs.emplace_back("qvr61", 7.1100f);
-    make_specs.emplace_back("qvr62", 7.1100f);
-  }
+constexpr CameraModelSpecs kConcordModels[] = {
+    {"1500", 6.4000f},
+    {"3043", 6.4000f},
+    {"3045", 6.4000f},
+    {"3046", 6.4000f},
+    {"3047", 6.4000f},
+    {"3345z", 6.4000f},
+    {"3346z", 6.4000f},
+    {"4042", 5.7500f},
+    {"4340z", 5.7500f},
+    {"5040", 7.1100f},
+    {"5340z", 5.7500f},
+    {"5345z", 7.1100f},
+    {"6340z", 7.1100f},
+    {"642", 6.4000f},
+    {"dvx", 6.4000f},
+    {"es500z", 5.7500f},
+    {"es510z", 7.1100f},
+    {"eyeq1000", 6.4000f},
+    {"eyeq1300", 6.4000f},
+    {"eyeq2040", 6.4000f},
+    {"eyeq2133z", 6.4000f},
+    {"eyeq3040af", 6.4000f},
+    {"eyeq3103", 6.4000f},
+    {"eyeq3120af", 4.0000f},
+    {"eyeq3132z", 6.4000f},
+    {"eyeq3340z", 5.3300f},
+    {"eyeq3341z", 7.1100f},
+    {"eyeq3343z", 5.3300f},
+    {"eyeq4060af", 7.1100f},
+    {"eyeq4330z", 7.1100f},
+    {"eyeq4342z", 7.1100f},
+    {"eyeq4360z", 7.1100f},
+    {"eyeq4363z", 7.1100f},
+    {"eyeq5062af", 7.1100f},
+    {"eyeq5330z", 7.1100f},
+    {"eyeqduo2000", 7.1100f},
+    {"eyeqduolcd", 6.4000f},
+    {"eyeqgo2000", 7.1100f},
+    {"eyeqgolcd", 6.4000f},
+    {"eyeqgowireless", 7.1100f},
+};
 
-  {
-    auto& make_specs = specs["concord"];
-    make_specs.reserve(40);
-    make_specs.emplace_back("1500", 6.4000f);
-    make_specs.emplace_back("3043", 6.4000f);
-    make_specs.emplace_back("3045", 6.4000f);
-    make_specs.emplace_back("3046", 6.4000f);
-    make_specs.emplace_back("3047", 6.4000f);
-    make_specs.emplace_back("3345z", 6.4000f);
-    make_specs.emplace_back("3346z", 6.4000f);
-    make_specs.emplace_back("4042", 5.7500f);
-    make_specs.emplace_back("4340z", 5.7500f);
-    make_specs.emplace_back("5040", 7.1100f);
-    make_specs.emplace_back("5340z", 5.7500f);
-    make_specs.emplace_back("5345z", 7.1100f);
-    make_specs.emplace_back("6340z", 7.1100f);
-    make_specs.emplace_back("642", 6.4000f);
-    make_specs.emplace_back("dvx", 6.4000f);
-    make_specs.emplace_back("es500z", 5.7500f);
-    make_specs.emplace_back("es510z", 7.1100f);
-    make_specs.emplace_back("eyeq1000", 6.4000f);
-    make_specs.emplace_back("eyeq1300", 6.4000f);
-    make_specs.emplace_back("eyeq2040", 6.4000f);
-    make_specs.emplace_back("eyeq2133z", 6.4000f);
-    make_specs.emplace_back("eyeq3040af", 6.4000f);
-    make_specs.emplace_back("eyeq3103", 6.4000f);
-    make_specs.emplace_back("eyeq3120af", 4.0000f);
-    make_specs.emplace_back("eyeq3132z", 6.4000f);
-    make_specs.emplace_back("eyeq3340z", 5.3300f);
-    make_specs.emplace_back("eyeq3341z", 7.1100f);
-    make_specs.emplace_back("eyeq3343z", 5.3300f);
-    make_specs.emplace_back("eyeq4060af", 7.1100f);
-    make_specs.emplace_back("eyeq4330z", 7.1100f);
-    make_specs.emplace_back("eyeq4342z", 7.1100f);
-    make_specs.emplace_back("eyeq4360z", 7.1100f);
-    make_specs.emplace_back("eyeq4363z", 7.1100f);
-    make_specs.emplace_back("eyeq5062af", 7.1100f);
-    make_specs.emplace_back("eyeq5330z", 7.1100f);
-    make_specs.emplace_back("eyeqduo2000", 7.1100f);
-    make_specs.emplace_back("eyeqduolcd", 6.4000f);
-    make_specs.emplace_back("eyeqgo2000", 7.1100f);
-    make_specs.emplace_back("eyeqgolcd", 6.4000f);
-    make_specs.emplace_back("eyeqgowireless", 7.1100f);
-  }
+constexpr CameraModelSpecs kContaxModels[] = {
+    {"i4r", 5.3300f},
+    {"ndigital", 36.0000f},
+    {"sl300rt", 5.3300f},
+    {"tvsdigital", 7.1100f},
+    {"u4r", 5.3300f},
+};
 
-  {
-    auto& make_specs = specs["contax"];
-    make_specs.reserve(5);
-    make_specs.emplace_back("i4r", 5.3300f);
-    make_specs.emplace_back("ndigital", 36.0000f);
-    make_specs.emplace_back("sl300rt", 5.3300f);
-    make_specs.emplace_back("tvsdigital", 7.1100f);
-    make_specs.emplace_back("u4r", 5.3300f);
-  }
+constexpr CameraModelSpecs kEpsonModels[] = {
+    {"l500v", 5.7500f},
+    {"photopc3000zoom", 7.1100f},
+    {"photopc3100zoom", 7.1100f},
+    {"photopc500", 4.8000f},
+    {"photopc550", 4.8000f},
+    {"photopc600", 4.8000f},
+    {"photopc650", 4.8000f},
+    {"photopc700", 4.8000f},
+    {"photopc750zoom", 6.4000f},
+    {"photopc800", 6.4000f},
+    {"photopc850zoom", 6.4000f},
+    {"photopcl200", 5.7500f},
+    {"photopcl300", 5.7500f},
+    {"photopcl400", 5.7500f},
+    {"photopcl410", 5.7500f},
+    {"photopcl500v", 5.7500f},
+    {"rd1xg", 23.7000f},
+    {"rd1", 23.7000f},
+    {"rd1s", 23.7000f},
+};
 
-  {
-    auto& make_specs = specs["epson"];
-    make_specs.reserve(19);
-    make_specs.emplace_back("l500v", 5.7500f);
-    make_specs.emplace_back("photopc3000zoom", 7.1100f);
-    make_specs.emplace_back("photopc3100zoom", 7.1100f);
-    make_specs.emplace_back("photopc500", 4.8000f);
-    make_specs.emplace_back("photopc550", 4.8000f);
-    make_specs.emplace_back("photopc600", 4.8000f);
-    make_specs.emplace_back("photopc650", 4.8000f);
-    make_specs.emplace_back("photopc700", 4.8000f);
-    make_specs.emplace_back("photopc750zoom", 6.4000f);
-    make_specs.emplace_back("photopc800", 6.4000f);
-    make_specs.emplace_back("photopc850zoom", 6.4000f);
-    make_specs.emplace_back("photopcl200", 5.7500f);
-    make_specs.emplace_back("photopcl300", 5.7500f);
-    make_specs.emplace_back("photopcl400", 5.7500f);
-    make_specs.emplace_back("photopcl410", 5.7500f);
-    make_specs.emplace_back("photopcl500v", 5.7500f);
-    make_specs.emplace_back("rd1xg", 23.7000f);
-    make_specs.emplace_back("rd1", 23.7000f);
-    make_specs.emplace_back("rd1s", 23.7000f);
-  }
+constexpr CameraModelSpecs kFujifilmModels[] = {
+    {"a850", 5.7500f},
+    {"bigjobhd3w", 5.7500f},
+    {"bigjobhd1", 5.3300f},
+    {"digitalq1", 6.4000f},
+    {"ds260hd", 6.4000f},
+    {"ds300", 8.8000f},
+    {"finepix1300", 5.3300f},
+    {"finepix1400z", 5.3300f},
+    {"finepix2300", 5.3300f},
+    {"finepix2400zoom", 5.3300f},
+    {"finepix2600zoom", 5.3300f},
+    {"finepix2650", 5.3300f},
+    {"finepix2800zoom", 5.3300f},
+    {"finepix30i", 5.3300f},
+    {"finepix3800", 5.3300f},
+    {"finepix40i", 5.3300f},
+    {"finepix4700zoom", 7.5300f},
+    {"finepix4800zoom", 7.5300f},
+    {"finepix4900zoom", 7.5300f},
+    {"finepix50i", 7.5300f},
+    {"finepix6800zoom", 7.5300f},
+    {"finepix6900zoom", 7.5300f},
+    {"finepixa100", 6.1600f},
+    {"finepixa101", 5.3300f},
+    {"finepixa120", 5.3300f},
+    {"finepixa150", 6.1600f},
+    {"finepixa160", 6.1600f},
+    {"finepixa170", 6.1600f},
+    {"finepixa175", 6.1600f},
+    {"finepixa180", 6.1600f},
+    {"finepixa200", 5.3300f},
+    {"finepixa201", 5.3300f},
+    {"finepixa202", 5.3300f},
+    {"finepixa203", 5.3300f},
+    {"finepixa204", 5.3300f},
+    {"finepixa205zoom", 5.3300f},
+    {"finepixa210zoom", 5.3300f},
+    {"finepixa220", 6.1600f},
+    {"finepixa225", 6.1600f},
+    {"finepixa235", 6.1600f},
+    {"finepixa303", 5.3300f},
+    {"finepixa310zoom", 5.3300f},
+    {"finepixa330", 5.3300f},
+    {"finepixa340", 5.3300f},
+    {"finepixa345zoom", 5.7500f},
+    {"finepixa350zoom", 5.7500f},
+    {"finepixa400zoom", 5.7500f},
+    {"finepixa500zoom", 5.7500f},
+    {"finepixa510", 5.7500f},
+    {"finepixa600zoom", 7.5300f},
+    {"finepixa610", 5.7500f},
+    {"finepixa700", 8.0000f},
+    {"finepixa800", 8.0000f},
+    {"finepixa820", 8.0000f},
+    {"finepixa825", 8.0000f},
+    {"finepixa900", 8.0000f},
+    {"finepixa920", 8.0000f},
+    {"finepixav100", 6.1600f},
+    {"finepixav105", 6.1600f},
+    {"finepixav110", 6.1600f},
+    {"finepixav130", 6.1600f},
+    {"finepixav140", 6.1600f},
+    {"finepixav150", 6.1600f},
+    {"finepixav180", 6.1600f},
+    {"finepixav200", 6.1600f},
+    {"finepixav205", 6.1600f},
+    {"finepixav250", 6.1600f},
+    {"finepixav255", 6.1600f},
+    {"finepixax200", 6.1600f},
+    {"finepixax205", 6.1600f},
+    {"finepixax230", 6.1600f},
+    {"finepixax245w", 6.1600f},
+    {"finepixax250", 6.1600f},
+    {"finepixax280", 6.1600f},
+    {"finepixax300", 6.1600f},
+    {"finepixax305", 6.1600f},
+    {"finepixax350", 6.1600f},
+    {"finepixax355", 6.1600f},
+    {"finepixax500", 6.1600f},
+    {"finepixax550", 6.1600f},
+    {"finepixax650", 6.1600f},
+    {"finepixe500zoom", 5.7500f},
+    {"finepixe510zoom", 5.7500f},
+    {"finepixe550zoom", 7.5300f},
+    {"finepixe900zoom", 8.0000f},
+    {"finepixex20", 5.3300f},
+    {"finepixf10zoom", 7.5300f},
+    {"finepixf100fd", 8.0000f},
+    {"finepixf11zoom", 7.5300f},
+    {"finepixf20zoom", 7.5300f},
+    {"finepixf200exr", 8.0000f},
+    {"finepixf30zoom", 7.5300f},
+    {"finepixf300exr", 6.4000f},
+    {"finepixf305exr", 6.4000f},
+    {"finepixf31fd", 7.5300f},
+    {"finepixf401zoom", 5.3300f},
+    {"finepixf402", 5.3300f},
+    {"finepixf40fd", 8.0000f},
+    {"finepixf410zoom", 5.3300f},
+    {"finepixf420zoom", 5.3300f},
+    {"finepixf440zoom", 5.7500f},
+    {"finepixf450zoom", 5.7500f},
+    {"finepixf455zoom", 5.7500f},
+    {"finepixf45fd", 8.0000f},
+    {"finepixf460", 5.7500f},
+    {"finepixf470zoom", 5.7500f},
+    {"finepixf47fd", 8.0000f},
+    {"finepixf480zoom", 5.7500f},
+    {"finepixf500exr", 6.4000f},
+    {"finepixf50fd", 8.0000f},
+    {"finepixf550exr", 6.4000f},
+    {"finepixf600exr", 6.4000f},
+    {"finepixf601zoom", 7.5300f},
+    {"finepixf605exr", 6.4000f},
+    {"finepixf60fd", 8.0000f},
+    {"finepixf610", 7.5300f},
+    {"finepixf650zoom", 5.7500f},
+    {"finepixf660exr", 6.4000f},
+    {"finepixf700", 7.5300f},
+    {"finepixf70exr", 6.4000f},
+    {"finepixf710", 7.5300f},
+    {"finepixf72exr", 6.4000f},
+    {"finepixf750exr", 6.4000f},
+    {"finepixf75exr", 6.4000f},
+    {"finepixf770exr", 6.4000f},
+    {"finepixf800exr", 6.4000f},
+    {"finepixf80exr", 6.4000f},
+    {"finepixf810zoom", 7.5300f},
+    {"finepixf850exr", 6.4000f},
+    {"finepixf85exr", 6.4000f},
+    {"finepixf900exr", 6.4000f},
+    {"finepixhs10", 6.1600f},
+    {"finepixhs11", 6.1600f},
+    {"finepixhs20exr", 6.4000f},
+    {"finepixhs22exr", 6.4000f},
+    {"finepixhs25exr", 6.4000f},
+    {"finepixhs30exr", 6.4000f},
+    {"finepixhs35exr", 6.4000f},
+    {"finepixhs50exr", 6.4000f},
+    {"finepixis1", 8.0000f},
+    {"finepixispro", 23.0000f},
+    {"finepixj100", 6.1600f},
+    {"finepixj10", 5.7500f},
+    {"finepixj110w", 6.1600f},
+    {"finepixj120", 6.1600f},
+    {"finepixj12", 5.7500f},
+    {"finepixj150w", 6.1600f},
+    {"finepixj15", 5.7500f},
+    {"finepixj20", 6.1600f},
+    {"finepixj210", 6.1600f},
+    {"finepixj22", 6.1600f},
+    {"finepixj250", 6.1600f},
+    {"finepixj25", 6.1600f},
+    {"finepixj26", 6.1600f},
+    {"finepixj27", 6.1600f},
+    {"finepixj28", 6.1600f},
+    {"finepixj29", 6.1600f},
+    {"finepixj30", 6.1600f},
+    {"finepixj32", 6.1600f},
+    {"finepixj35", 6.1600f},
+    {"finepixj37", 6.1600f},
+    {"finepixj38", 6.1600f},
+    {"finepixj50", 5.7500f},
+    {"finepixjv100", 6.1600f},
+    {"finepixjv105", 6.1600f},
+    {"finepixjv110", 6.1600f},
+    {"finepixjv150", 6.1600f},
+    {"finepixjv200", 6.1600f},
+    {"finepixjv205", 6.1600f},
+    {"finepixjv250", 6.1600f},
+    {"finepixjv255", 6.1600f},
+    {"finepixjx200", 6.1600f},
+    {"finepixjx205", 6.1600f},
+    {"finepixjx210", 6.1600f},
+    {"finepixjx250", 6.1600f},
+    {"finepixjx280", 6.1600f},
+    {"finepixjx300", 6.1600f},
+    {"finepixjx305", 6.1600f},
+    {"finepixjx350", 6.1600f},
+    {"finepixjx355", 6.1600f},
+    {"finepixjx370", 6.1600f},
+    {"finepixjx375", 6.1600f},
+    {"finepixjx400", 6.1600f},
+    {"finepixjx405", 6.1600f},
+    {"finepixjx420", 6.1600f},
+    {"finepixjx500", 6.1600f},
+    {"finepixjx520", 6.1600f},
+    {"finepixjx530", 6.1600f},
+    {"finepixjx550", 6.1600f},
+    {"finepixjx580", 6.1600f},
+    {"finepixjx700", 6.1600f},
+    {"finepixjz100", 6.1600f},
+    {"finepixjz200", 6.1600f},
+    {"finepixjz250", 6.1600f},
+    {"finepixjz300", 6.1600f},
+    {"finepixjz305", 6.1600f},
+    {"finepixjz310", 6.1600f},
+    {"finepixjz500", 6.1600f},
+    {"finepixjz505", 6.1600f},
+    {"finepixjz510", 6.1600f},
+    {"finepixjz700", 6.1600f},
+    {"finepixm603", 7.5300f},
+    {"finepixpr21", 6.4000f},
+    {"finepixreal3dw1", 6.1600f},
+    {"finepixreal3dw3", 6.1600f},
+    {"finepixs1pro", 23.0000f},
+    {"finepixs1000fd", 6.1600f},
+    {"finepixs100fs", 8.8000f},
+    {"finepixs1500", 6.1600f},
+    {"finepixs1600", 6.1600f},
+    {"finepixs1700", 6.1600f},
+    {"finepixs1730", 6.1600f},
+    {"finepixs1770", 6.1600f},
+    {"finepixs1800", 6.1600f},
+    {"finepixs1850", 6.1600f},
+    {"finepixs1880", 6.1600f},
+    {"finepixs1900", 6.1600f},
+    {"finepixs1", 6.1600f},
+    {"finepixs2pro", 23.0000f},
+    {"finepixs20pro", 7.5300f},
+    {"finepixs2000hd", 6.1600f},
+    {"finepixs200exr", 8.0000f},
+    {"finepixs205exr", 8.0000f},
+    {"finepixs2500hd", 6.1600f},
+    {"finepixs2550hd", 6.1600f},
+    {"finepixs2600hd", 6.1600f},
+    {"finepixs2800hd", 6.1600f},
+    {"finepixs2900hd", 6.1600f},
+    {"finepixs2950", 6.1600f},
+    {"finepixs2980", 6.1600f},
+    {"finepixs2990", 6.1600f},
+    {"finepixs3pro", 23.5000f},
+    {"finepixs3000z", 5.3300f},
+    {"finepixs304", 5.3300f},
+    {"finepixs3200", 6.1600f},
+    {"finepixs3250", 6.1600f},
+    {"finepixs3300", 6.1600f},
+    {"finepixs3350", 6.1600f},
+    {"finepixs3400", 6.1600f},
+    {"finepixs3450", 6.1600f},
+    {"finepixs3500zoom", 5.3300f},
+    {"finepixs4000", 6.1600f},
+    {"finepixs4050", 6.1600f},
+    {"finepixs4200", 6.1600f},
+    {"finepixs4300", 6.1600f},
+    {"finepixs4400", 6.1600f},
+    {"finepixs4500", 6.1600f},
+    {"finepixs4600", 6.1600f},
+    {"finepixs4700", 6.1600f},
+    {"finepixs4800", 6.1600f},
+    {"finepixs5pro", 23.0000f},
+    {"finepixs5000zoom", 5.3300f},
+    {"finepixs5100zoom", 5.3300f},
+    {"finepixs5200zoom", 5.7500f},
+    {"finepixs5500zoom", 5.3300f},
+    {"finepixs5600zoom", 5.7500f},
+    {"finepixs5700zoom", 5.7500f},
+    {"finepixs5800", 5.7500f},
+    {"finepixs6000fd", 7.5300f},
+    {"finepixs602zoom", 7.5300f},
+    {"finepixs602zpro", 7.5300f},
+    {"finepixs6500fd", 7.5300f},
+    {"finepixs6600", 6.1600f},
+    {"finepixs6700", 6.1600f},
+    {"finepixs6800", 6.1600f},
+    {"finepixs7000zoom", 7.5300f},
+    {"finepixs8000fd", 6.0300f},
+    {"finepixs8100fd", 6.1600f},
+    {"finepixs8200", 6.1600f},
+    {"finepixs8300", 6.1600f},
+    {"finepixs8400", 6.1600f},
+    {"finepixs8500", 6.1600f},
+    {"finepixs8600", 6.1600f},
+    {"finepixs9000zoom", 8.0000f},
+    {"finepixs9100", 8.0000f},
+    {"finepixs9200", 6.1600f},
+    {"finepixs9400w", 6.1600f},
+    {"finepixs9500", 8.0000f},
+    {"finepixs9600", 8.0000f},
+    {"finepixs9800", 6.1600f},
+    {"finepixs9900w", 6.1600f},
+    {"finepixsl1000", 6.1600f},
+    {"finepixsl240", 6.1600f},
+    {"finepixsl260", 6.1600f},
+    {"finepixsl280", 6.1600f},
+    {"finepixsl300", 6.1600f},
+    {"finepixt200", 6.1600f},
+    {"finepixt205", 6.1600f},
+    {"finepixt300", 6.1600f},
+    {"finepixt305", 6.1600f},
+    {"finepixt350", 6.1600f},
+    {"finepixt400", 6.1600f},
+    {"finepixt500", 6.1600f},
+    {"finepixt550", 6.1600f},
+    {"finepixv10zoom", 5.7500f},
+    {"finepixx100", 23.6000f},
+    {"finepixxp100", 6.1600f},
+    {"finepixxp10", 6.1600f},
+    {"finepixxp11", 6.1600f},
+    {"finepixxp150", 6.1600f},
+    {"finepixxp170", 6.1600f},
+    {"finepixxp200", 6.1600f},
+    {"finepixxp20", 6.1600f},
+    {"finepixxp22", 6.1600f},
+    {"finepixxp30", 6.1600f},
+    {"finepixxp33", 6.1600f},
+    {"finepixxp50", 6.1600f},
+    {"finepixxp60", 6.1600f},
+    {"finepixxp70", 6.1600f},
+    {"finepixxp80", 6.1600f},
+    {"finepixz1000exr", 6.4000f},
+    {"finepixz100fd", 5.7500f},
+    {"finepixz10fd", 5.7500f},
+    {"finepixz110", 6.1600f},
+    {"finepixz1", 5.7500f},
+    {"finepixz200fd", 6.1600f},
+    {"finepixz20fd", 6.1600f},
+    {"finepixz2", 5.7500f},
+    {"finepixz300", 6.1600f},
+    {"finepixz30", 6.1600f},
+    {"finepixz31", 6.1600f},
+    {"finepixz33wp", 6.1600f},
+    {"finepixz35", 6.1600f},
+    {"finepixz37", 6.1600f},
+    {"finepixz3", 5.7500f},
+    {"finepixz5fd", 5.7500f},
+    {"finepixz700exr", 6.4000f},
+    {"finepixz707exr", 6.4000f},
+    {"finepixz70", 6.1600f},
+    {"finepixz71", 6.1600f},
+    {"finepixz800exr", 6.4000f},
+    {"finepixz808exr", 6.4000f},
+    {"finepixz80", 6.1600f},
+    {"finepixz81", 6.1600f},
+    {"finepixz900exr", 6.4000f},
+    {"finepixz909exr", 6.4000f},
+    {"finepixz90", 6.1600f},
+    {"finepixz91", 6.1600f},
+    {"finepixz950exr", 6.4000f},
+    {"mx1200", 6.4000f},
+    {"mx1400", 5.3300f},
+    {"mx1500", 6.4000f},
+    {"mx1700", 6.4000f},
+    {"mx2700", 6.4000f},
+    {"mx2900zoom", 6.4000f},
+    {"mx500", 6.4000f},
+    {"mx600zoom", 6.4000f},
+    {"mx700", 6.4000f},
+    {"xa1", 23.6000f},
+    {"xa2", 23.6000f},
+    {"xe1", 23.6000f},
+    {"xe2", 23.6000f},
+    {"xm1", 23.6000f},
+    {"xpro1", 23.6000f},
+    {"xs1", 8.8000f},
+    {"xt10", 23.6000f},
+    {"xt1", 23.6000f},
+    {"x100s", 23.6000f},
+    {"x100t", 23.6000f},
+    {"x10", 8.8000f},
+    {"x20", 8.8000f},
+    {"x30", 8.8000f},
+    {"xf1", 8.8000f},
+    {"xq1", 8.8000f},
+    {"xq2", 8.8000f},
+};
 
-  {
-    auto& make_specs = specs["fujifilm"];
-    make_specs.reserve(365);
-    make_specs.emplace_back("a850", 5.7500f);
-    make_specs.emplace_back("bigjobhd3w", 5.7500f);
-    make_specs.emplace_back("bigjobhd1", 5.3300f);
-    make_specs.emplace_back("digitalq1", 6.4000f);
-    make_specs.emplace_back("ds260hd", 6.4000f);
-    make_specs.emplace_back("ds300", 8.8000f);
-    make_specs.emplace_back("finepix1300", 5.3300f);
-    make_specs.emplace_back("finepix1400z", 5.3300f);
-    make_specs.emplace_back("finepix2300", 5.3300f);
-    make_specs.emplace_back("finepix2400zoom", 5.3300f);
-    make_specs.emplace_back("finepix2600zoom", 5.3300f);
-    make_specs.emplace_back("finepix2650", 5.3300f);
-    make_specs.emplace_back("finepix2800zoom", 5.3300f);
-    make_specs.emplace_back("finepix30i", 5.3300f);
-    make_specs.emplace_back("finepix3800", 5.3300f);
-    make_specs.emplace_back("finepix40i", 5.3300f);
-    make_specs.emplace_back("finepix4700zoom", 7.5300f);
-    make_specs.emplace_back("finepix4800zoom", 7.5300f);
-    make_specs.emplace_back("finepix4900zoom", 7.5300f);
-    make_specs.emplace_back("finepix50i", 7.5300f);
-    make_specs.emplace_back("finepix6800zoom", 7.5300f);
-    make_specs.emplace_back("finepix6900zoom", 7.5300f);
-    make_specs.emplace_back("finepixa100", 6.1600f);
-    make_specs.emplace_back("finepixa101", 5.3300f);
-    make_specs.emplace_back("finepixa120", 5.3300f);
-    make_specs.emplace_back("finepixa150", 6.1600f);
-    make_specs.emplace_back("finepixa160", 6.1600f);
-    make_specs.emplace_back("finepixa170", 6.1600f);
-    make_specs.emplace_back("finepixa175", 6.1600f);
-    make_specs.emplace_back("finepixa180", 6.1600f);
-    make_specs.emplace_back("finepixa200", 5.3300f);
-    make_specs.emplace_back("finepixa201", 5.3300f);
-    make_specs.emplace_back("finepixa202", 5.3300f);
-    make_specs.emplace_back("finepixa203", 5.3300f);
-    make_specs.emplace_back("finepixa204", 5.3300f);
-    make_specs.emplace_back("finepixa205zoom", 5.3300f);
-    make_specs.emplace_back("finepixa210zoom", 5.3300f);
-    make_specs.emplace_back("finepixa220", 6.1600f);
-    make_specs.emplace_back("finepixa225", 6.1600f);
-    make_specs.emplace_back("finepixa235", 6.1600f);
-    make_specs.emplace_back("finepixa303", 5.3300f);
-    make_specs.emplace_back("finepixa310zoom", 5.3300f);
-    make_specs.emplace_back("finepixa330", 5.3300f);
-    make_specs.emplace_back("finepixa340", 5.3300f);
-    make_specs.emplace_back("finepixa345zoom", 5.7500f);
-    make_specs.emplace_back("finepixa350zoom", 5.7500f);
-    make_specs.emplace_back("finepixa400zoom", 5.7500f);
-    make_specs.emplace_back("finepixa500zoom", 5.7500f);
-    make_specs.emplace_back("finepixa510", 5.7500f);
-    make_specs.emplace_back("finepixa600zoom", 7.5300f);
-    make_specs.emplace_back("finepixa610", 5.7500f);
-    make_specs.emplace_back("finepixa700", 8.0000f);
-    make_specs.emplace_back("finepixa800", 8.0000f);
-    make_specs.emplace_back("finepixa820", 8.0000f);
-    make_specs.emplace_back("finepixa825", 8.0000f);
-    make_specs.emplace_back("finepixa900", 8.0000f);
-    make_specs.emplace_back("finepixa920", 8.0000f);
-    make_specs.emplace_back("finepixav100", 6.1600f);
-    make_specs.emplace_back("finepixav105", 6.1600f);
-    make_specs.emplace_back("finepixav110", 6.1600f);
-    make_specs.emplace_back("finepixav130", 6.1600f);
-    make_specs.emplace_back("finepixav140", 6.1600f);
-    make_specs.emplace_back("finepixav150", 6.1600f);
-    make_specs.emplace_back("finepixav180", 6.1600f);
-    make_specs.emplace_back("finepixav200", 6.1600f);
-    make_specs.emplace_back("finepixav205", 6.1600f);
-    make_specs.emplace_back("finepixav250", 6.1600f);
-    make_specs.emplace_back("finepixav255", 6.1600f);
-    make_specs.emplace_back("finepixax200", 6.1600f);
-    make_specs.emplace_back("finepixax205", 6.1600f);
-    make_specs.emplace_back("finepixax230", 6.1600f);
-    make_specs.emplace_back("finepixax245w", 6.1600f);
-    make_specs.emplace_back("finepixax250", 6.1600f);
-    make_specs.emplace_back("finepixax280", 6.1600f);
-    make_specs.emplace_back("finepixax300", 6.1600f);
-    make_specs.emplace_back("finepixax305", 6.1600f);
-    make_specs.emplace_back("finepixax350", 6.1600f);
-    make_specs.emplace_back("finepixax355", 6.1600f);
-    make_specs.emplace_back("finepixax500", 6.1600f);
-    make_specs.emplace_back("finepixax550", 6.1600f);
-    make_specs.emplace_back("finepixax650", 6.1600f);
-    make_specs.emplace_back("finepixe500zoom", 5.7500f);
-    make_specs.emplace_back("finepixe510zoom", 5.7500f);
-    make_specs.emplace_back("finepixe550zoom", 7.5300f);
-    make_specs.emplace_back("finepixe900zoom", 8.0000f);
-    make_specs.emplace_back("finepixex20", 5.3300f);
-    make_specs.emplace_back("finepixf10zoom", 7.5300f);
-    make_specs.emplace_back("finepixf100fd", 8.0000f);
-    make_specs.emplace_back("finepixf11zoom", 7.5300f);
-    make_specs.emplace_back("finepixf20zoom", 7.5300f);
-    make_specs.emplace_back("finepixf200exr", 8.0000f);
-    make_specs.emplace_back("finepixf30zoom", 7.5300f);
-    make_specs.emplace_back("finepixf300exr", 6.4000f);
-    make_specs.emplace_back("finepixf305exr", 6.4000f);
-    make_specs.emplace_back("finepixf31fd", 7.5300f);
-    make_specs.emplace_back("finepixf401zoom", 5.3300f);
-    make_specs.emplace_back("finepixf402", 5.3300f);
-    make_specs.emplace_back("finepixf40fd", 8.0000f);
-    make_specs.emplace_back("finepixf410zoom", 5.3300f);
-    make_specs.emplace_back("finepixf420zoom", 5.3300f);
-    make_specs.emplace_back("finepixf440zoom", 5.7500f);
-    make_specs.emplace_back("finepixf450zoom", 5.7500f);
-    make_specs.emplace_back("finepixf455zoom", 5.7500f);
-    make_specs.emplace_back("finepixf45fd", 8.0000f);
-    make_specs.emplace_back("finepixf460", 5.7500f);
-    make_specs.emplace_back("finepixf470zoom", 5.7500f);
-    make_specs.emplace_back("finepixf47fd", 8.0000f);
-    make_specs.emplace_back("finepixf480zoom", 5.7500f);
-    make_specs.emplace_back("finepixf500exr", 6.4000f);
-    make_specs.emplace_back("finepixf50fd", 8.0000f);
-    make_specs.emplace_back("finepixf550exr", 6.4000f);
-    make_specs.emplace_back("finepixf600exr", 6.4000f);
-    make_specs.emplace_back("finepixf601zoom", 7.5300f);
-    make_specs.emplace_back("finepixf605exr", 6.4000f);
-    make_specs.emplace_back("finepixf60fd", 8.0000f);
-    make_specs.emplace_back("finepixf610", 7.5300f);
-    make_specs.emplace_back("finepixf650zoom", 5.7500f);
-    make_specs.emplace_back("finepixf660exr", 6.4000f);
-    make_specs.emplace_back("finepixf700", 7.5300f);
-    make_specs.emplace_back("finepixf70exr", 6.4000f);
-    make_specs.emplace_back("finepixf710", 7.5300f);
-    make_specs.emplace_back("finepixf72exr", 6.4000f);
-    make_specs.emplace_back("finepixf750exr", 6.4000f);
-    make_specs.emplace_back("finepixf75exr", 6.4000f);
-    make_specs.emplace_back("finepixf770exr", 6.4000f);
-    make_specs.emplace_back("finepixf800exr", 6.4000f);
-    make_specs.emplace_back("finepixf80exr", 6.4000f);
-    make_specs.emplace_back("finepixf810zoom", 7.5300f);
-    make_specs.emplace_back("finepixf850exr", 6.4000f);
-    make_specs.emplace_back("finepixf85exr", 6.4000f);
-    make_specs.emplace_back("finepixf900exr", 6.4000f);
-    make_specs.emplace_back("finepixhs10", 6.1600f);
-    make_specs.emplace_back("finepixhs11", 6.1600f);
-    make_specs.emplace_back("finepixhs20exr", 6.4000f);
-    make_specs.emplace_back("finepixhs22exr", 6.4000f);
-    make_specs.emplace_back("finepixhs25exr", 6.4000f);
-    make_specs.emplace_back("finepixhs30exr", 6.4000f);
-    make_specs.emplace_back("finepixhs35exr", 6.4000f);
-    make_specs.emplace_back("finepixhs50exr", 6.4000f);
-    make_specs.emplace_back("finepixis1", 8.0000f);
-    make_specs.emplace_back("finepixispro", 23.0000f);
-    make_specs.emplace_back("finepixj100", 6.1600f);
-    make_specs.emplace_back("finepixj10", 5.7500f);
-    make_specs.emplace_back("finepixj110w", 6.1600f);
-    make_specs.emplace_back("finepixj120", 6.1600f);
-    make_specs.emplace_back("finepixj12", 5.7500f);
-    make_specs.emplace_back("finepixj150w", 6.1600f);
-    make_specs.emplace_back("finepixj15", 5.7500f);
-    make_specs.emplace_back("finepixj20", 6.1600f);
-    make_specs.emplace_back("finepixj210", 6.1600f);
-    make_specs.emplace_back("finepixj22", 6.1600f);
-    make_specs.emplace_back("finepixj250", 6.1600f);
-    make_specs.emplace_back("finepixj25", 6.1600f);
-    make_specs.emplace_back("finepixj26", 6.1600f);
-    make_specs.emplace_back("finepixj27", 6.1600f);
-    make_specs.emplace_back("finepixj28", 6.1600f);
-    make_specs.emplace_back("finepixj29", 6.1600f);
-    make_specs.emplace_back("finepixj30", 6.1600f);
-    make_specs.emplace_back("finepixj32", 6.1600f);
-    make_specs.emplace_back("finepixj35", 6.1600f);
-    make_specs.emplace_back("finepixj37", 6.1600f);
-    make_specs.emplace_back("finepixj38", 6.1600f);
-    make_specs.emplace_back("finepixj50", 5.7500f);
-    make_specs.emplace_back("finepixjv100", 6.1600f);
-    make_specs.emplace_back("finepixjv105", 6.1600f);
-    make_specs.emplace_back("finepixjv110", 6.1600f);
-    make_specs.emplace_back("finepixjv150", 6.1600f);
-    make_specs.emplace_back("finepixjv200", 6.1600f);
-    make_specs.emplace_back("finepixjv205", 6.1600f);
-    make_specs.emplace_back("finepixjv250", 6.1600f);
-    make_specs.emplace_back("finepixjv255", 6.1600f);
-    make_specs.emplace_back("finepixjx200", 6.1600f);
-    make_specs.emplace_back("finepixjx205", 6.1600f);
-    make_specs.emplace_back("finepixjx210", 6.1600f);
-    make_specs.emplace_back("finepixjx250", 6.1600f);
-    make_specs.emplace_back("finepixjx280", 6.1600f);
-    make_specs.emplace_back("finepixjx300", 6.1600f);
-    make_specs.emplace_back("finepixjx305", 6.1600f);
-    make_specs.emplace_back("finepixjx350", 6.1600f);
-    make_specs.emplace_back("finepixjx355", 6.1600f);
-    make_specs.emplace_back("finepixjx370", 6.1600f);
-    make_specs.emplace_back("finepixjx375", 6.1600f);
-    make_specs.emplace_back("finepixjx400", 6.1600f);
-    make_specs.emplace_back("finepixjx405", 6.1600f);
-    make_specs.emplace_back("finepixjx420", 6.1600f);
-    make_specs.emplace_back("finepixjx500", 6.1600f);
-    make_specs.emplace_back("finepixjx520", 6.1600f);
-    make_specs.emplace_back("finepixjx530", 6.1600f);
-    make_specs.emplace_back("finepixjx550", 6.1600f);
-    make_specs.emplace_back("finepixjx580", 6.1600f);
-    make_specs.emplace_back("finepixjx700", 6.1600f);
-    make_specs.emplace_back("finepixjz100", 6.1600f);
-    make_specs.emplace_back("finepixjz200", 6.1600f);
-    make_specs.emplace_back("finepixjz250", 6.1600f);
-    make_specs.emplace_back("finepixjz300", 6.1600f);
-    make_specs.emplace_back("finepixjz305", 6.1600f);
-    make_specs.emplace_back("finepixjz310", 6.1600f);
-    make_specs.emplace_back("finepixjz500", 6.1600f);
-    make_specs.emplace_back("finepixjz505", 6.1600f);
-    make_specs.emplace_back("finepixjz510", 6.1600f);
-    make_specs.emplace_back("finepixjz700", 6.1600f);
-    make_specs.emplace_back("finepixm603", 7.5300f);
-    make_specs.emplace_back("finepixpr21", 6.4000f);
-    make_specs.emplace_back("finepixreal3dw1", 6.1600f);
-    make_specs.emplace_back("finepixreal3dw3", 6.1600f);
-    make_specs.emplace_back("finepixs1pro", 23.0000f);
-    make_specs.emplace_back("finepixs1000fd", 6.1600f);
-    make_specs.emplace_back("finepixs100fs", 8.8000f);
-    make_specs.emplace_back("finepixs1500", 6.1600f);
-    make_specs.emplace_back("finepixs1600", 6.1600f);
-    make_specs.emplace_back("finepixs1700", 6.1600f);
-    make_specs.emplace_back("finepixs1730", 6.1600f);
-    make_specs.emplace_back("finepixs1770", 6.1600f);
-    make_specs.emplace_back("finepixs1800", 6.1600f);
-    make_specs.emplace_back("finepixs1850", 6.1600f);
-    make_specs.emplace_back("finepixs1880", 6.1600f);
-    make_specs.emplace_back("finepixs1900", 6.1600f);
-    make_specs.emplace_back("finepixs1", 6.1600f);
-    make_specs.emplace_back("finepixs2pro", 23.0000f);
-    make_specs.emplace_back("finepixs20pro", 7.5300f);
-    make_specs.emplace_back("finepixs2000hd", 6.1600f);
-    make_specs.emplace_back("finepixs200exr", 8.0000f);
-    make_specs.emplace_back("finepixs205exr", 8.0000f);
-    make_specs.emplace_back("finepixs2500hd", 6.1600f);
-    make_specs.emplace_back("finepixs2550hd", 6.1600f);
-    make_specs.emplace_back("finepixs2600hd", 6.1600f);
-    make_specs.emplace_back("finepixs2800hd", 6.1600f);
-    make_specs.emplace_back("finepixs2900hd", 6.1600f);
-    make_specs.emplace_back("finepixs2950", 6.1600f);
-    make_specs.emplace_back("finepixs2980", 6.1600f);
-    make_specs.emplace_back("finepixs2990", 6.1600f);
-    make_specs.emplace_back("finepixs3pro", 23.5000f);
-    make_specs.emplace_back("finepixs3000z", 5.3300f);
-    make_specs.emplace_back("finepixs304", 5.3300f);
-    make_specs.emplace_back("finepixs3200", 6.1600f);
-    make_specs.emplace_back("finepixs3250", 6.1600f);
-    make_specs.emplace_back("finepixs3300", 6.1600f);
-    make_specs.emplace_back("finepixs3350", 6.1600f);
-    make_specs.emplace_back("finepixs3400", 6.1600f);
-    make_specs.emplace_back("finepixs3450", 6.1600f);
-    make_specs.emplace_back("finepixs3500zoom", 5.3300f);
-    make_specs.emplace_back("finepixs4000", 6.1600f);
-    make_specs.emplace_back("finepixs4050", 6.1600f);
-    make_specs.emplace_back("finepixs4200", 6.1600f);
-    make_specs.emplace_back("finepixs4300", 6.1600f);
-    make_specs.emplace_back("finepixs4400", 6.1600f);
-    make_specs.emplace_back("finepixs4500", 6.1600f);
-    make_specs.emplace_back("finepixs4600", 6.1600f);
-    make_specs.emplace_back("finepixs4700", 6.1600f);
-    make_specs.emplace_back("finepixs4800", 6.1600f);
-    make_specs.emplace_back("finepixs5pro", 23.0000f);
-    make_specs.emplace_back("finepixs5000zoom", 5.3300f);
-    make_specs.emplace_back("finepixs5100zoom", 5.3300f);
-    make_specs.emplace_back("finepixs5200zoom", 5.7500f);
-    make_specs.emplace_back("finepixs5500zoom", 5.3300f);
-    make_specs.emplace_back("finepixs5600zoom", 5.7500f);
-    make_specs.emplace_back("finepixs5700zoom", 5.7500f);
-    make_specs.emplace_back("finepixs5800", 5.7500f);
-    make_specs.emplace_back("finepixs6000fd", 7.5300f);
-    make_specs.emplace_back("finepixs602zoom", 7.5300f);
-    make_specs.emplace_back("finepixs602zpro", 7.5300f);
-    make_specs.emplace_back("finepixs6500fd", 7.5300f);
-    make_specs.emplace_back("finepixs6600", 6.1600f);
-    make_specs.emplace_back("finepixs6700", 6.1600f);
-    make_specs.emplace_back("finepixs6800", 6.1600f);
-    make_specs.emplace_back("finepixs7000zoom", 7.5300f);
-    make_specs.emplace_back("finepixs8000fd", 6.0300f);
-    make_specs.emplace_back("finepixs8100fd", 6.1600f);
-    make_specs.emplace_back("finepixs8200", 6.1600f);
-    make_specs.emplace_back("finepixs8300", 6.1600f);
-    make_specs.emplace_back("finepixs8400", 6.1600f);
-    make_specs.emplace_back("finepixs8500", 6.1600f);
-    make_specs.emplace_back("finepixs8600", 6.1600f);
-    make_specs.emplace_back("finepixs9000zoom", 8.0000f);
-    make_specs.emplace_back("finepixs9100", 8.0000f);
-    make_specs.emplace_back("finepixs9200", 6.1600f);
-    make_specs.emplace_back("finepixs9400w", 6.1600f);
-    make_specs.emplace_back("finepixs9500", 8.0000f);
-    make_specs.emplace_back("finepixs9600", 8.0000f);
-    make_specs.emplace_back("finepixs9800", 6.1600f);
-    make_specs.emplace_back("finepixs9900w", 6.1600f);
-    make_specs.emplace_back("finepixsl1000", 6.1600f);
-    make_specs.emplace_back("finepixsl240", 6.1600f);
-    make_specs.emplace_back("finepixsl260", 6.1600f);
-    make_specs.emplace_back("finepixsl280", 6.1600f);
-    make_specs.emplace_back("finepixsl300", 6.1600f);
-    make_specs.emplace_back("finepixt200", 6.1600f);
-    make_specs.emplace_back("finepixt205", 6.1600f);
-    make_specs.emplace_back("finepixt300", 6.1600f);
-    make_specs.emplace_back("finepixt305", 6.1600f);
-    make_specs.emplace_back("finepixt350", 6.1600f);
-    make_specs.emplace_back("finepixt400", 6.1600f);
-    make_specs.emplace_back("finepixt500", 6.1600f);
-    make_specs.emplace_back("finepixt550", 6.1600f);
-    make_specs.emplace_back("finepixv10zoom", 5.7500f);
-    make_specs.emplace_back("finepixx100", 23.6000f);
-    make_specs.emplace_back("finepixxp100", 6.1600f);
-    make_specs.emplace_back("finepixxp10", 6.1600f);
-    make_specs.emplace_back("finepixxp11", 6.1600f);
-    make_specs.emplace_back("finepixxp150", 6.1600f);
-    make_specs.emplace_back("finepixxp170", 6.1600f);
-    make_specs.emplace_back("finepixxp200", 6.1600f);
-    make_specs.emplace_back("finepixxp20", 6.1600f);
-    make_specs.emplace_back("finepixxp22", 6.1600f);
-    make_specs.emplace_back("finepixxp30", 6.1600f);
-    make_specs.emplace_back("finepixxp33", 6.1600f);
-    make_specs.emplace_back("finepixxp50", 6.1600f);
-    make_specs.emplace_back("finepixxp60", 6.1600f);
-    make_specs.emplace_back("finepixxp70", 6.1600f);
-    make_specs.emplace_back("finepixxp80", 6.1600f);
-    make_specs.emplace_back("finepixz1000exr", 6.4000f);
-    make_specs.emplace_back("finepixz100fd", 5.7500f);
-    make_specs.emplace_back("finepixz10fd", 5.7500f);
-    make_specs.emplace_back("finepixz110", 6.1600f);
-    make_specs.emplace_back("finepixz1", 5.7500f);
-    make_specs.emplace_back("finepixz200fd", 6.1600f);
-    make_specs.emplace_back("finepixz20fd", 6.1600f);
-    make_specs.emplace_back("finepixz2", 5.7500f);
-    make_specs.emplace_back("finepixz300", 6.1600f);
-    make_specs.emplace_back("finepixz30", 6.1600f);
-    make_specs.emplace_back("finepixz31", 6.1600f);
-    make_specs.emplace_back("finepixz33wp", 6.1600f);
-    make_specs.emplace_back("finepixz35", 6.1600f);
-    make_specs.emplace_back("finepixz37", 6.1600f);
-    make_specs.emplace_back("finepixz3", 5.7500f);
-    make_specs.emplace_back("finepixz5fd", 5.7500f);
-    make_specs.emplace_back("finepixz700exr", 6.4000f);
-    make_specs.emplace_back("finepixz707exr", 6.4000f);
-    make_specs.emplace_back("finepixz70", 6.1600f);
-    make_specs.emplace_back("finepixz71", 6.1600f);
-    make_specs.emplace_back("finepixz800exr", 6.4000f);
-    make_specs.emplace_back("finepixz808exr", 6.4000f);
-    make_specs.emplace_back("finepixz80", 6.1600f);
-    make_specs.emplace_back("finepixz81", 6.1600f);
-    make_specs.emplace_back("finepixz900exr", 6.4000f);
-    make_specs.emplace_back("finepixz909exr", 6.4000f);
-    make_specs.emplace_back("finepixz90", 6.1600f);
-    make_specs.emplace_back("finepixz91", 6.1600f);
-    make_specs.emplace_back("finepixz950exr", 6.4000f);
-    make_specs.emplace_back("mx1200", 6.4000f);
-    make_specs.emplace_back("mx1400", 5.3300f);
-    make_specs.emplace_back("mx1500", 6.4000f);
-    make_specs.emplace_back("mx1700", 6.4000f);
-    make_specs.emplace_back("mx2700", 6.4000f);
-    make_specs.emplace_back("mx2900zoom", 6.4000f);
-    make_specs.emplace_back("mx500", 6.4000f);
-    make_specs.emplace_back("mx600zoom", 6.4000f);
-    make_specs.emplace_back("mx700", 6.4000f);
-    make_specs.emplace_back("xa1", 23.6000f);
-    make_specs.emplace_back("xa2", 23.6000f);
-    make_specs.emplace_back("xe1", 23.6000f);
-    make_specs.emplace_back("xe2", 23.6000f);
-    make_specs.emplace_back("xm1", 23.6000f);
-    make_specs.emplace_back("xpro1", 23.6000f);
-    make_specs.emplace_back("xs1", 8.8000f);
-    make_specs.emplace_back("xt10", 23.6000f);
-    make_specs.emplace_back("xt1", 23.6000f);
-    make_specs.emplace_back("x100s", 23.6000f);
-    make_specs.emplace_back("x100t", 23.6000f);
-    make_specs.emplace_back("x10", 8.8000f);
-    make_specs.emplace_back("x20", 8.8000f);
-    make_specs.emplace_back("x30", 8.8000f);
-    make_specs.emplace_back("xf1", 8.8000f);
-    make_specs.emplace_back("xq1", 8.8000f);
-    make_specs.emplace_back("xq2", 8.8000f);
-  }
+constexpr CameraModelSpecs kGeModels[] = {
+    {"a1030", 7.5300f},
+    {"a1035", 6.0800f},
+    {"a1050", 6.0800f},
+    {"a1235", 6.1600f},
+    {"a1250", 6.1600f},
+    {"a1255", 6.0800f},
+    {"a1455", 6.1600f},
+    {"a1456w", 6.1600f},
+    {"a730", 5.7500f},
+    {"a735", 5.7500f},
+    {"a830", 5.7500f},
+    {"a835", 5.7500f},
+    {"a950", 6.0800f},
+    {"c1033", 6.0800f},
+    {"c1233", 6.0800f},
+    {"c1433", 6.1600f},
+    {"c1440w", 6.1600f},
+    {"create", 6.1600f},
+    {"e1030", 7.5300f},
+    {"e1035", 7.5300f},
+    {"e1040", 7.5300f},
+    {"e1050tw", 6.0800f},
+    {"e1050", 6.0800f},
+    {"e1055w", 6.0800f},
+    {"e1235", 7.4400f},
+    {"e1240", 7.5300f},
+    {"e1250tw", 6.1600f},
+    {"e1255w", 6.1600f},
+    {"e1276w", 6.1600f},
+    {"e1410sw", 6.1600f},
+    {"e1450w", 6.1600f},
+    {"e1480w", 6.1600f},
+    {"e1486tw", 6.1600f},
+    {"e1680w", 6.0800f},
+    {"e840s", 5.7500f},
+    {"e850", 5.7500f},
+    {"g100", 6.1600f},
+    {"g2", 6.0300f},
+    {"g3wp", 6.1600f},
+    {"g3", 6.0800f},
+    {"g5wp", 6.1600f},
+    {"g1", 5.7500f},
+    {"j1050", 6.0800f},
+    {"j1250", 6.1600f},
+    {"j1455", 6.1600f},
+    {"j1456w", 6.1600f},
+    {"j1458w", 6.1600f},
+    {"j1470s", 6.0800f},
+    {"pj1", 6.1600f},
+    {"x1", 5.7500f},
+    {"x3", 6.0800f},
+    {"x500", 6.1600f},
+    {"x550", 6.1600f},
+    {"x600", 6.1600f},
+};
 
-  {
-    auto& make_specs = specs["ge"];
-    make_specs.reserve(54);
-    make_specs.emplace_back("a1030", 7.5300f);
-    make_specs.emplace_back("a1035", 6.0800f);
-    make_specs.emplace_back("a1050", 6.0800f);
-    make_specs.emplace_back("a1235", 6.1600f);
-    make_specs.emplace_back("a1250", 6.1600f);
-    make_specs.emplace_back("a1255", 6.0800f);
-    make_specs.emplace_back("a1455", 6.1600f);
-    make_specs.emplace_back("a1456w", 6.1600f);
-    make_specs.emplace_back("a730", 5.7500f);
-    make_specs.emplace_back("a735", 5.7500f);
-    make_specs.emplace_back("a830", 5.7500f);
-    make_specs.emplace_back("a835", 5.7500f);
-    make_specs.emplace_back("a950", 6.0800f);
-    make_specs.emplace_back("c1033", 6.0800f);
-    make_specs.emplace_back("c1233", 6.0800f);
-    make_specs.emplace_back("c1433", 6.1600f);
-    make_specs.emplace_back("c1440w", 6.1600f);
-    make_specs.emplace_back("create", 6.1600f);
-    make_specs.emplace_back("e1030", 7.5300f);
-    make_specs.emplace_back("e1035", 7.5300f);
-    make_specs.emplace_back("e1040", 7.5300f);
-    make_specs.emplace_back("e1050tw", 6.0800f);
-    make_specs.emplace_back("e1050", 6.0800f);
-    make_specs.emplace_back("e1055w", 6.0800f);
-    make_specs.emplace_back("e1235", 7.4400f);
-    make_specs.emplace_back("e1240", 7.5300f);
-    make_specs.emplace_back("e1250tw", 6.1600f);
-    make_specs.emplace_back("e1255w", 6.1600f);
-    make_specs.emplace_back("e1276w", 6.1600f);
-    make_specs.emplace_back("e1410sw", 6.1600f);
-    make_specs.emplace_back("e1450w", 6.1600f);
-    make_specs.emplace_back("e1480w", 6.1600f);
-    make_specs.emplace_back("e1486tw", 6.1600f);
-    make_specs.emplace_back("e1680w", 6.0800f);
-    make_specs.emplace_back("e840s", 5.7500f);
-    make_specs.emplace_back("e850", 5.7500f);
-    make_specs.emplace_back("g100", 6.1600f);
-    make_specs.emplace_back("g2", 6.0300f);
-    make_specs.emplace_back("g3wp", 6.1600f);
-    make_specs.emplace_back("g3", 6.0800f);
-    make_specs.emplace_back("g5wp", 6.1600f);
-    make_specs.emplace_back("g1", 5.7500f);
-    make_specs.emplace_back("j1050", 6.0800f);
-    make_specs.emplace_back("j1250", 6.1600f);
-    make_specs.emplace_back("j1455", 6.1600f);
-    make_specs.emplace_back("j1456w", 6.1600f);
-    make_specs.emplace_back("j1458w", 6.1600f);
-    make_specs.emplace_back("j1470s", 6.0800f);
-    make_specs.emplace_back("pj1", 6.1600f);
-    make_specs.emplace_back("x1", 5.7500f);
-    make_specs.emplace_back("x3", 6.0800f);
-    make_specs.emplace_back("x500", 6.1600f);
-    make_specs.emplace_back("x550", 6.1600f);
-    make_specs.emplace_back("x600", 6.1600f);
-  }
+constexpr CameraModelSpecs kHpModels[] = {
+    {"ca350", 6.1600f},
+    {"cb350", 6.1600f},
+    {"cw450t", 6.1600f},
+    {"cw450", 6.1600f},
+    {"photosmart120", 6.4000f},
+    {"photosmart318", 5.3300f},
+    {"photosmart320", 5.3300f},
+    {"photosmart435", 5.3300f},
+    {"photosmart612", 5.3300f},
+    {"photosmart620", 4.8000f},
+    {"photosmart635", 4.5000f},
+    {"photosmart715", 7.1100f},
+    {"photosmart720", 7.1100f},
+    {"photosmart733", 5.3300f},
+    {"photosmart735", 5.3300f},
+    {"photosmart812", 7.1100f},
+    {"photosmart850", 7.1100f},
+    {"photosmart935", 7.1100f},
+    {"photosmart945", 7.1100f},
+    {"photosmartc200", 8.8000f},
+    {"photosmartc20", 8.8000f},
+    {"photosmartc215", 5.3300f},
+    {"photosmartc30", 8.8000f},
+    {"photosmartc315", 5.3300f},
+    {"photosmartc500", 8.8000f},
+    {"photosmartc618", 5.3300f},
+    {"photosmartc912", 8.8000f},
+    {"photosmarte317", 5.7500f},
+    {"photosmarte327", 5.7500f},
+    {"photosmarte337", 5.7500f},
+    {"photosmarte427", 5.7500f},
+    {"photosmartm22", 5.7500f},
+    {"photosmartm23", 5.7500f},
+    {"photosmartm307", 5.3300f},
+    {"photosmartm407", 5.7500f},
+    {"photosmartm417", 5.7500f},
+    {"photosmartm425", 5.7500f},
+    {"photosmartm437", 5.7500f},
+    {"photosmartm447", 5.7500f},
+    {"photosmartm517", 5.7500f},
+    {"photosmartm525", 5.7500f},
+    {"photosmartm527", 5.7500f},
+    {"photosmartm537", 5.7500f},
+    {"photosmartm547", 5.7500f},
+    {"photosmartm627", 5.7500f},
+    {"photosmartm637", 5.7500f},
+    {"photosmartm737", 5.7500f},
+    {"photosmartmz67", 7.1100f},
+    {"photosmartr507", 5.7500f},
+    {"photosmartr607", 5.7500f},
+    {"photosmartr707", 7.1100f},
+    {"photosmartr717", 7.1100f},
+    {"photosmartr725", 5.7500f},
+    {"photosmartr727", 5.7500f},
+    {"photosmartr742", 5.7500f},
+    {"photosmartr817", 5.7500f},
+    {"photosmartr818", 5.7500f},
+    {"photosmartr827", 5.7500f},
+    {"photosmartr837", 5.7500f},
+    {"photosmartr847", 5.7500f},
+    {"photosmartr927", 7.1100f},
+    {"photosmartr937", 5.7500f},
+    {"photosmartr967", 7.1100f},
+    {"pw460t", 6.1600f},
+    {"pw550", 6.1600f},
+    {"r607bmw", 5.7500f},
+    {"r607harajuku", 5.7500f},
+    {"sb360", 6.1600f},
+    {"sw450", 6.1600f},
+};
 
-  {
-    auto& make_specs = specs["hp"];
-    make_specs.reserve(69);
-    make_specs.emplace_back("ca350", 6.1600f);
-    make_specs.emplace_back("cb350", 6.1600f);
-    make_specs.emplace_back("cw450t", 6.1600f);
-    make_specs.emplace_back("cw450", 6.1600f);
-    make_specs.emplace_back("photosmart120", 6.4000f);
-    make_specs.emplace_back("photosmart318", 5.3300f);
-    make_specs.emplace_back("photosmart320", 5.3300f);
-    make_specs.emplace_back("photosmart435", 5.3300f);
-    make_specs.emplace_back("photosmart612", 5.3300f);
-    make_specs.emplace_back("photosmart620", 4.8000f);
-    make_specs.emplace_back("photosmart635", 4.5000f);
-    make_specs.emplace_back("photosmart715", 7.1100f);
-    make_specs.emplace_back("photosmart720", 7.1100f);
-    make_specs.emplace_back("photosmart733", 5.3300f);
-    make_specs.emplace_back("photosmart735", 5.3300f);
-    make_specs.emplace_back("photosmart812", 7.1100f);
-    make_specs.emplace_back("photosmart850", 7.1100f);
-    make_specs.emplace_back("photosmart935", 7.1100f);
-    make_specs.emplace_back("photosmart945", 7.1100f);
-    make_specs.emplace_back("photosmartc200", 8.8000f);
-    make_specs.emplace_back("photosmartc20", 8.8000f);
-    make_specs.emplace_back("photosmartc215", 5.3300f);
-    make_specs.emplace_back("photosmartc30", 8.8000f);
-    make_specs.emplace_back("photosmartc315", 5.3300f);
-    make_specs.emplace_back("photosmartc500", 8.8000f);
-    make_specs.emplace_back("photosmartc618", 5.3300f);
-    make_specs.emplace_back("photosmartc912", 8.8000f);
-    make_specs.emplace_back("photosmarte317", 5.7500f);
-    make_specs.emplace_back("photosmarte327", 5.7500f);
-    make_specs.emplace_back("photosmarte337", 5.7500f);
-    make_specs.emplace_back("photosmarte427", 5.7500f);
-    make_specs.emplace_back("photosmartm22", 5.7500f);
-    make_specs.emplace_back("photosmartm23", 5.7500f);
-    make_specs.emplace_back("photosmartm307", 5.3300f);
-    make_specs.emplace_back("photosmartm407", 5.7500f);
-    make_specs.emplace_back("photosmartm417", 5.7500f);
-    make_specs.emplace_back("photosmartm425", 5.7500f);
-    make_specs.emplace_back("photosmartm437", 5.7500f);
-    make_specs.emplace_back("photosmartm447", 5.7500f);
-    make_specs.emplace_back("photosmartm517", 5.7500f);
-    make_specs.emplace_back("photosmartm525", 5.7500f);
-    make_specs.emplace_back("photosmartm527", 5.7500f);
-    make_specs.emplace_back("photosmartm537", 5.7500f);
-    make_specs.emplace_back("photosmartm547", 5.7500f);
-    make_specs.emplace_back("photosmartm627", 5.7500f);
-    make_specs.emplace_back("photosmartm637", 5.7500f);
-    make_specs.emplace_back("photosmartm737", 5.7500f);
-    make_specs.emplace_back("photosmartmz67", 7.1100f);
-    make_specs.emplace_back("photosmartr507", 5.7500f);
-    make_specs.emplace_back("photosmartr607", 5.7500f);
-    make_specs.emplace_back("photosmartr707", 7.1100f);
-    make_specs.emplace_back("photosmartr717", 7.1100f);
-    make_specs.emplace_back("photosmartr725", 5.7500f);
-    make_specs.emplace_back("photosmartr727", 5.7500f);
-    make_specs.emplace_back("photosmartr742", 5.7500f);
-    make_specs.emplace_back("photosmartr817", 5.7500f);
-    make_specs.emplace_back("photosmartr818", 5.7500f);
-    make_specs.emplace_back("photosmartr827", 5.7500f);
-    make_specs.emplace_back("photosmartr837", 5.7500f);
-    make_specs.emplace_back("photosmartr847", 5.7500f);
-    make_specs.emplace_back("photosmartr927", 7.1100f);
-    make_specs.emplace_back("photosmartr937", 5.7500f);
-    make_specs.emplace_back("photosmartr967", 7.1100f);
-    make_specs.emplace_back("pw460t", 6.1600f);
-    make_specs.emplace_back("pw550", 6.1600f);
-    make_specs.emplace_back("r607bmw", 5.7500f);
-    make_specs.emplace_back("r607harajuku", 5.7500f);
-    make_specs.emplace_back("sb360", 6.1600f);
-    make_specs.emplace_back("sw450", 6.1600f);
-  }
+constexpr CameraModelSpecs kJenoptikModels[] = {
+    {"jd1300d", 6.4000f},
+    {"jd1300f", 6.4000f},
+    {"jd1500z3", 6.4000f},
+    {"jd2.1ff", 4.5000f},
+    {"jd2.1xz3", 4.5000f},
+    {"jd2100af", 5.3300f},
+    {"jd2100f", 5.3300f},
+    {"jd2100m", 5.3300f},
+    {"jd2100z3s", 5.3300f},
+    {"jd2300z3", 7.5300f},
+    {"jd3.1exclusiv", 6.4000f},
+    {"jd3.1z3mpeg4", 5.3300f},
+    {"jd3.3af", 5.3300f},
+    {"jd3.3xz3", 5.3300f},
+    {"jd3.3x4ie", 5.3300f},
+    {"jd3.3z10", 5.3300f},
+    {"jd3300z3s", 7.1100f},
+    {"jd3300z3", 7.1100f},
+    {"jd4.0lcd", 7.1100f},
+    {"jd4.1xz3", 5.7500f},
+    {"jd4.1z3mpeg4", 5.7500f},
+    {"jd4.1z8", 5.7500f},
+    {"jd4.1zoom", 5.7500f},
+    {"jd4100z3s", 7.1100f},
+    {"jd4100z3", 7.5300f},
+    {"jd4100zoom", 7.1100f},
+    {"jd4360z", 7.1100f},
+    {"jd4363z", 7.1100f},
+    {"jd5.0z3easyshot", 5.7500f},
+    {"jd5.2z3mpeg4", 7.1100f},
+    {"jd5.2z3", 7.1100f},
+    {"jd5.2zoom", 5.7500f},
+    {"jd5200z3", 7.1100f},
+    {"jd6.0z3exclusiv", 7.1100f},
+    {"jd6.0z3mpeg4", 7.1100f},
+    {"jd6.0z3", 7.1100f},
+    {"jd8.0exclusiv", 7.1100f},
+    {"jd8.0z3easyshot", 7.1100f},
+    {"jdc1.3lcd", 6.4000f},
+    {"jdc1.3sd", 6.4000f},
+    {"jdc1300", 6.4000f},
+    {"jdc2.1lcd", 6.4000f},
+    {"jdc3.0s", 6.4000f},
+    {"jdc3.1lcd", 6.4000f},
+    {"jdc3.1li", 6.4000f},
+    {"jdc3.1sl", 6.4000f},
+    {"jdc3.1z3", 6.4000f},
+    {"jdc5.0sl", 7.1100f},
+};
 
-  {
-    auto& make_specs = specs["jenoptik"];
-    make_specs.reserve(48);
-    make_specs.emplace_back("jd1300d", 6.4000f);
-    make_specs.emplace_back("jd1300f", 6.4000f);
-    make_specs.emplace_back("jd1500z3", 6.4000f);
-    make_specs.emplace_back("jd2.1ff", 4.5000f);
-    make_specs.emplace_back("jd2.1xz3", 4.5000f);
-    make_specs.emplace_back("jd2100af", 5.3300f);
-    make_specs.emplace_back("jd2100f", 5.3300f);
-    make_specs.emplace_back("jd2100m", 5.3300f);
-    make_specs.emplace_back("jd2100z3s", 5.3300f);
-    make_specs.emplace_back("jd2300z3", 7.5300f);
-    make_specs.emplace_back("jd3.1exclusiv", 6.4000f);
-    make_specs.emplace_back("jd3.1z3mpeg4", 5.3300f);
-    make_specs.emplace_back("jd3.3af", 5.3300f);
-    make_specs.emplace_back("jd3.3xz3", 5.3300f);
-    make_specs.emplace_back("jd3.3x4ie", 5.3300f);
-    make_specs.emplace_back("jd3.3z10", 5.3300f);
-    make_specs.emplace_back("jd3300z3s", 7.1100f);
-    make_specs.emplace_back("jd3300z3", 7.1100f);
-    make_specs.emplace_back("jd4.0lcd", 7.1100f);
-    make_specs.emplace_back("jd4.1xz3", 5.7500f);
-    make_specs.emplace_back("jd4.1z3mpeg4", 5.7500f);
-    make_specs.emplace_back("jd4.1z8", 5.7500f);
-    make_specs.emplace_back("jd4.1zoom", 5.7500f);
-    make_specs.emplace_back("jd4100z3s", 7.1100f);
-    make_specs.emplace_back("jd4100z3", 7.5300f);
-    make_specs.emplace_back("jd4100zoom", 7.1100f);
-    make_specs.emplace_back("jd4360z", 7.1100f);
-    make_specs.emplace_back("jd4363z", 7.1100f);
-    make_specs.emplace_back("jd5.0z3easyshot", 5.7500f);
-    make_specs.emplace_back("jd5.2z3mpeg4", 7.1100f);
-    make_specs.emplace_back("jd5.2z3", 7.1100f);
-    make_specs.emplace_back("jd5.2zoom", 5.7500f);
-    make_specs.emplace_back("jd5200z3", 7.1100f);
-    make_specs.emplace_back("jd6.0z3exclusiv", 7.1100f);
-    make_specs.emplace_back("jd6.0z3mpeg4", 7.1100f);
-    make_specs.emplace_back("jd6.0z3", 7.1100f);
-    make_specs.emplace_back("jd8.0exclusiv", 7.1100f);
-    make_specs.emplace_back("jd8.0z3easyshot", 7.1100f);
-    make_specs.emplace_back("jdc1.3lcd", 6.4000f);
-    make_specs.emplace_back("jdc1.3sd", 6.4000f);
-    make_specs.emplace_back("jdc1300", 6.4000f);
-    make_specs.emplace_back("jdc2.1lcd", 6.4000f);
-    make_specs.emplace_back("jdc3.0s", 6.4000f);
-    make_specs.emplace_back("jdc3.1lcd", 6.4000f);
-    make_specs.emplace_back("jdc3.1li", 6.4000f);
-    make_specs.emplace_back("jdc3.1sl", 6.4000f);
-    make_specs.emplace_back("jdc3.1z3", 6.4000f);
-    make_specs.emplace_back("jdc5.0sl", 7.1100f);
-  }
+constexpr CameraModelSpecs kJvcModels[] = {
+    {"gcqx3hd", 7.1100f},
+    {"gcqx5hd", 7.1100f},
+};
 
-  {
-    auto& make_specs = specs["jvc"];
-    make_specs.reserve(2);
-    make_specs.emplace_back("gcqx3hd", 7.1100f);
-    make_specs.emplace_back("gcqx5hd", 7.1100f);
-  }
+constexpr CameraModelSpecs kKodakModels[] = {
+    {"dc200plus", 7.2700f},
+    {"dc200", 7.2700f},
+    {"dc210plus", 7.2700f},
+    {"dc215", 7.2700f},
+    {"dc220", 7.2700f},
+    {"dc240", 7.2700f},
+    {"dc260", 7.2700f},
+    {"dc265", 7.2700f},
+    {"dc280", 7.5300f},
+    {"dc290", 7.2700f},
+    {"dc3200", 7.5300f},
+    {"dc3400", 7.5300f},
+    {"dc3800", 7.5300f},
+    {"dc4800", 7.2700f},
+    {"dc5000", 7.2700f},
+    {"dcspro14n", 36.0000f},
+    {"dcsproslr/c", 36.0000f},
+    {"dcsproslr/n", 36.0000f},
+    {"dcs315", 27.6500f},
+    {"dcs330", 18.1000f},
+    {"dcs420", 14.0000f},
+    {"dcs460", 27.6500f},
+    {"dcs520", 27.6500f},
+    {"dcs560", 27.6500f},
+    {"dcs620x", 22.8000f},
+    {"dcs620", 27.6500f},
+    {"dcs660", 27.6500f},
+    {"dcs720x", 22.8000f},
+    {"dcs760", 27.6500f},
+    {"dx3215", 5.3300f},
+    {"dx3500", 6.4000f},
+    {"dx3600", 6.4000f},
+    {"dx3700", 7.1100f},
+    {"dx3900", 7.1100f},
+    {"dx4330", 5.7500f},
+    {"dx4530", 5.7500f},
+    {"dx4900", 5.7500f},
+    {"dx6340", 5.3300f},
+    {"dx6440", 5.7500f},
+    {"dx6490", 5.7500f},
+    {"dx7440", 5.7500f},
+    {"dx7590", 5.7500f},
+    {"dx7630", 7.1100f},
+    {"easysharec1013", 6.1600f},
+    {"easysharec135", 6.1600f},
+    {"easysharec140", 5.7500f},
+    {"easysharec142", 5.7500f},
+    {"easysharec143", 6.1600f},
+    {"easysharec1505", 6.1600f},
+    {"easysharec1530", 6.1600f},
+    {"easysharec1550", 6.1600f},
+    {"easysharec160", 5.7500f},
+    {"easysharec180", 6.1600f},
+    {"easysharec182", 6.1600f},
+    {"easysharec183", 6.1600f},
+    {"easysharec190", 6.1600f},
+    {"easysharec195", 6.1600f},
+    {"easysharec300", 7.1100f},
+    {"easysharec310", 7.1100f},
+    {"easysharec330", 7.1100f},
+    {"easysharec340", 7.1100f},
+    {"easysharec360", 7.1100f},
+    {"easysharec433", 5.7500f},
+    {"easysharec503", 5.7500f},
+    {"easysharec513", 5.7500f},
+    {"easysharec530", 5.7500f},
+    {"easysharec533", 5.7500f},
+    {"easysharec610", 5.7500f},
+    {"easysharec613", 5.7500f},
+    {"easysharec623", 5.7500f},
+    {"easysharec643", 5.7500f},
+    {"easysharec653", 5.7500f},
+    {"easysharec663", 5.7500f},
+    {"easysharec703", 5.7500f},
+    {"easysharec713", 5.7500f},
+    {"easysharec743", 5.7500f},
+    {"easysharec763", 5.7500f},
+    {"easysharec813", 5.7500f},
+    {"easysharec875", 7.1100f},
+    {"easysharec913", 5.7500f},
+    {"easysharecd1013", 6.1600f},
+    {"easysharecd703", 5.7500f},
+    {"easysharecd80", 6.1600f},
+    {"easysharecd82", 6.0800f},
+    {"easysharecd90", 6.0800f},
+    {"easysharecd93", 5.7500f},
+    {"easysharecx4200", 5.3300f},
+    {"easysharecx4230", 5.3300f},
+    {"easysharecx4300", 5.3300f},
+    {"easysharecx6200", 5.7500f},
+    {"easysharecx6230", 5.7500f},
+    {"easysharecx6330", 5.7500f},
+    {"easysharecx6445", 5.7500f},
+    {"easysharecx7220", 5.7500f},
+    {"easysharecx7300", 5.3300f},
+    {"easysharecx7330", 5.7500f},
+    {"easysharecx7430", 5.7500f},
+    {"easysharecx7525", 5.7500f},
+    {"easysharecx7530", 5.7500f},
+    {"easysharels745", 7.1100f},
+    {"easysharem1033", 6.1600f},
+    {"easysharem1063", 5.7500f},
+    {"easysharem1073is", 5.7500f},
+    {"easysharem1093is", 6.1600f},
+    {"easysharem215", 4.8000f},
+    {"easysharem320", 5.7500f},
+    {"easysharem340", 6.1600f},
+    {"easysharem341", 6.1600f},
+    {"easysharem380", 6.1600f},
+    {"easysharem381", 6.1600f},
+    {"easysharem420", 6.1600f},
+    {"easysharem522", 6.1600f},
+    {"easysharem530", 6.1600f},
+    {"easysharem531", 6.1600f},
+    {"easysharem532", 6.1600f},
+    {"easysharem5370", 6.1600f},
+    {"easysharem550", 6.1600f},
+    {"easysharem552", 6.1600f},
+    {"easysharem565", 6.1600f},
+    {"easysharem575", 6.1600f},
+    {"easysharem580", 6.1600f},
+    {"easysharem583", 6.0800f},
+    {"easysharem750", 6.1600f},
+    {"easysharem753", 5.7500f},
+    {"easysharem763", 5.7500f},
+    {"easysharem853", 5.7500f},
+    {"easysharem863", 5.7500f},
+    {"easysharem873", 5.7500f},
+    {"easysharem883", 5.7500f},
+    {"easysharem893is", 5.7500f},
+    {"easysharemaxz990", 6.0800f},
+    {"easysharemd1063", 6.0800f},
+    {"easysharemd30", 6.0800f},
+    {"easysharemd41", 6.0800f},
+    {"easysharemd81", 6.0800f},
+    {"easysharemd853", 5.7500f},
+    {"easysharemd863", 5.7500f},
+    {"easysharemini", 4.8000f},
+    {"easysharemx1063", 6.0800f},
+    {"easyshareone6mp", 5.7500f},
+    {"easyshareone", 5.7500f},
+    {"easysharep712", 5.7500f},
+    {"easysharep850", 5.7500f},
+    {"easysharep880", 7.1100f},
+    {"easysharesport", 6.1600f},
+    {"easysharetouchm577", 6.1600f},
+    {"easysharev1003", 7.1100f},
+    {"easysharev1073", 7.8500f},
+    {"easysharev1233", 7.4400f},
+    {"easysharev1253", 7.4400f},
+    {"easysharev1273", 7.4400f},
+    {"easysharev530", 5.7500f},
+    {"easysharev550", 5.7500f},
+    {"easysharev570", 5.7500f},
+    {"easysharev603", 5.7500f},
+    {"easysharev610", 5.7500f},
+    {"easysharev705", 5.7500f},
+    {"easysharev803", 7.1100f},
+    {"easysharez1012is", 6.0800f},
+    {"easysharez1015is", 6.0800f},
+    {"easysharez1085is", 7.8500f},
+    {"easysharez1275", 7.4400f},
+    {"easysharez1285", 7.4400f},
+    {"easysharez1485is", 7.4400f},
+    {"easysharez5010", 6.1600f},
+    {"easysharez5120", 6.0800f},
+    {"easysharez612", 5.7500f},
+    {"easysharez650", 5.7500f},
+    {"easysharez700", 5.7500f},
+    {"easysharez710", 5.7500f},
+    {"easysharez712is", 5.7500f},
+    {"easysharez730", 5.7500f},
+    {"easysharez740", 5.7500f},
+    {"easysharez7590", 5.7500f},
+    {"easysharez760", 7.1100f},
+    {"easysharez812is", 5.7500f},
+    {"easysharez8612is", 5.7500f},
+    {"easysharez885", 7.1100f},
+    {"easysharez915", 6.1600f},
+    {"easysharez950", 6.0800f},
+    {"easysharez980", 6.0800f},
+    {"easysharez981", 6.0800f},
+    {"easysharez990", 6.0800f},
+    {"easysharezd15", 6.1600f},
+    {"easysharezd710", 5.7500f},
+    {"easysharezd8612is", 5.7500f},
+    {"ls420", 7.1100f},
+    {"ls443", 5.3300f},
+    {"ls633", 5.7500f},
+    {"ls743", 7.1100f},
+    {"ls753", 7.1100f},
+    {"ls755", 5.7500f},
+    {"m590", 4.8000f},
+    {"mc3", 6.4000f},
+    {"pixproaz251", 6.1600f},
+    {"pixproaz361", 6.1600f},
+    {"pixproaz362", 6.1600f},
+    {"pixproaz501", 6.1600f},
+    {"pixproaz521", 6.1600f},
+    {"pixproaz522", 6.1600f},
+    {"pixproaz651", 6.1600f},
+    {"pixprofz151", 6.1600f},
+    {"pixprofz201", 6.1600f},
+    {"pixprofz41", 6.1600f},
+    {"pixprofz51", 6.1600f},
+    {"s1", 17.3000f},
+    {"slice", 6.1600f},
+};
 
-  {
-    auto& make_specs = specs["kodak"];
-    make_specs.reserve(207);
-    make_specs.emplace_back("dc200plus", 7.2700f);
-    make_specs.emplace_back("dc200", 7.2700f);
-    make_specs.emplace_back("dc210plus", 7.2700f);
-    make_specs.emplace_back("dc215", 7.2700f);
-    make_specs.emplace_back("dc220", 7.2700f);
-    make_specs.emplace_back("dc240", 7.2700f);
-    make_specs.emplace_back("dc260", 7.2700f);
-    make_specs.emplace_back("dc265", 7.2700f);
-    make_specs.emplace_back("dc280", 7.5300f);
-    make_specs.emplace_back("dc290", 7.2700f);
-    make_specs.emplace_back("dc3200", 7.5300f);
-    make_specs.emplace_back("dc3400", 7.5300f);
-    make_specs.emplace_back("dc3800", 7.5300f);
-    make_specs.emplace_back("dc4800", 7.2700f);
-    make_specs.emplace_back("dc5000", 7.2700f);
-    make_specs.emplace_back("dcspro14n", 36.0000f);
-    make_specs.emplace_back("dcsproslr/c", 36.0000f);
-    make_specs.emplace_back("dcsproslr/n", 36.0000f);
-    make_specs.emplace_back("dcs315", 27.6500f);
-    make_specs.emplace_back("dcs330", 18.1000f);
-    make_specs.emplace_back("dcs420", 14.0000f);
-    make_specs.emplace_back("dcs460", 27.6500f);
-    make_specs.emplace_back("dcs520", 27.6500f);
-    make_specs.emplace_back("dcs560", 27.6500f);
-    make_specs.emplace_back("dcs620x", 22.8000f);
-    make_specs.emplace_back("dcs620", 27.6500f);
-    make_specs.emplace_back("dcs660", 27.6500f);
-    make_specs.emplace_back("dcs720x", 22.8000f);
-    make_specs.emplace_back("dcs760", 27.6500f);
-    make_specs.emplace_back("dx3215", 5.3300f);
-    make_specs.emplace_back("dx3500", 6.4000f);
-    make_specs.emplace_back("dx3600", 6.4000f);
-    make_specs.emplace_back("dx3700", 7.1100f);
-    make_specs.emplace_back("dx3900", 7.1100f);
-    make_specs.emplace_back("dx4330", 5.7500f);
-    make_specs.emplace_back("dx4530", 5.7500f);
-    make_specs.emplace_back("dx4900", 5.7500f);
-    make_specs.emplace_back("dx6340", 5.3300f);
-    make_specs.emplace_back("dx6440", 5.7500f);
-    make_specs.emplace_back("dx6490", 5.7500f);
-    make_specs.emplace_back("dx7440", 5.7500f);
-    make_specs.emplace_back("dx7590", 5.7500f);
-    make_specs.emplace_back("dx7630", 7.1100f);
-    make_specs.emplace_back("easysharec1013", 6.1600f);
-    make_specs.emplace_back("easysharec135", 6.1600f);
-    make_specs.emplace_back("easysharec140", 5.7500f);
-    make_specs.emplace_back("easysharec142", 5.7500f);
-    make_specs.emplace_back("easysharec143", 6.1600f);
-    make_specs.emplace_back("easysharec1505", 6.1600f);
-    make_specs.emplace_back("easysharec1530", 6.1600f);
-    make_specs.emplace_back("easysharec1550", 6.1600f);
-    make_specs.emplace_back("easysharec160", 5.7500f);
-    make_specs.emplace_back("easysharec180", 6.1600f);
-    make_specs.emplace_back("easysharec182", 6.1600f);
-    make_specs.emplace_back("easysharec183", 6.1600f);
-    make_specs.emplace_back("easysharec190", 6.1600f);
-    make_specs.emplace_back("easysharec195", 6.1600f);
-    make_specs.emplace_back("easysharec300", 7.1100f);
-    make_specs.emplace_back("easysharec310", 7.1100f);
-    make_specs.emplace_back("easysharec330", 7.1100f);
-    make_specs.emplace_back("easysharec340", 7.1100f);
-    make_specs.emplace_back("easysharec360", 7.1100f);
-    make_specs.emplace_back("easysharec433", 5.7500f);
-    make_specs.emplace_back("easysharec503", 5.7500f);
-    make_specs.emplace_back("easysharec513", 5.7500f);
-    make_specs.emplace_back("easysharec530", 5.7500f);
-    make_specs.emplace_back("easysharec533", 5.7500f);
-    make_specs.emplace_back("easysharec610", 5.7500f);
-    make_specs.emplace_back("easysharec613", 5.7500f);
-    make_specs.emplace_back("easysharec623", 5.7500f);
-    make_specs.emplace_back("easysharec643", 5.7500f);
-    make_specs.emplace_back("easysharec653", 5.7500f);
-    make_specs.emplace_back("easysharec663", 5.7500f);
-    make_specs.emplace_back("easysharec703", 5.7500f);
-    make_specs.emplace_back("easysharec713", 5.7500f);
-    make_specs.emplace_back("easysharec743", 5.7500f);
-    make_specs.emplace_back("easysharec763", 5.7500f);
-    make_specs.emplace_back("easysharec813", 5.7500f);
-    make_specs.emplace_back("easysharec875", 7.1100f);
-    make_specs.emplace_back("easysharec913", 5.7500f);
-    make_specs.emplace_back("easysharecd1013", 6.1600f);
-    make_specs.emplace_back("easysharecd703", 5.7500f);
-    make_specs.emplace_back("easysharecd80", 6.1600f);
-    make_specs.emplace_back("easysharecd82", 6.0800f);
-    make_specs.emplace_back("easysharecd90", 6.0800f);
-    make_specs.emplace_back("easysharecd93", 5.7500f);
-    make_specs.emplace_back("easysharecx4200", 5.3300f);
-    make_specs.emplace_back("easysharecx4230", 5.3300f);
-    make_specs.emplace_back("easysharecx4300", 5.3300f);
-    make_specs.emplace_back("easysharecx6200", 5.7500f);
-    make_specs.emplace_back("easysharecx6230", 5.7500f);
-    make_specs.emplace_back("easysharecx6330", 5.7500f);
-    make_specs.emplace_back("easysharecx6445", 5.7500f);
-    make_specs.emplace_back("easysharecx7220", 5.7500f);
-    make_specs.emplace_back("easysharecx7300", 5.3300f);
-    make_specs.emplace_back("easysharecx7330", 5.7500f);
-    make_specs.emplace_back("easysharecx7430", 5.7500f);
-    make_specs.emplace_back("easysharecx7525", 5.7500f);
-    make_specs.emplace_back("easysharecx7530", 5.7500f);
-    make_specs.emplace_back("easysharels745", 7.1100f);
-    make_specs.emplace_back("easysharem1033", 6.1600f);
-    make_specs.emplace_back("easysharem1063", 5.7500f);
-    make_specs.emplace_back("easysharem1073is", 5.7500f);
-    make_specs.emplace_back("easysharem1093is", 6.1600f);
-    make_specs.emplace_back("easysharem215", 4.8000f);
-    make_specs.emplace_back("easysharem320", 5.7500f);
-    make_specs.emplace_back("easysharem340", 6.1600f);
-    make_specs.emplace_back("easysharem341", 6.1600f);
-    make_specs.emplace_back("easysharem380", 6.1600f);
-    make_specs.emplace_back("easysharem381", 6.1600f);
-    make_specs.emplace_back("easysharem420", 6.1600f);
-    make_specs.emplace_back("easysharem522", 6.1600f);
-    make_specs.emplace_back("easysharem530", 6.1600f);
-    make_specs.emplace_back("easysharem531", 6.1600f);
-    make_specs.emplace_back("easysharem532", 6.1600f);
-    make_specs.emplace_back("easysharem5370", 6.1600f);
-    make_specs.emplace_back("easysharem550", 6.1600f);
-    make_specs.emplace_back("easysharem552", 6.1600f);
-    make_specs.emplace_back("easysharem565", 6.1600f);
-    make_specs.emplace_back("easysharem575", 6.1600f);
-    make_specs.emplace_back("easysharem580", 6.1600f);
-    make_specs.emplace_back("easysharem583", 6.0800f);
-    make_specs.emplace_back("easysharem750", 6.1600f);
-    make_specs.emplace_back("easysharem753", 5.7500f);
-    make_specs.emplace_back("easysharem763", 5.7500f);
-    make_specs.emplace_back("easysharem853", 5.7500f);
-    make_specs.emplace_back("easysharem863", 5.7500f);
-    make_specs.emplace_back("easysharem873", 5.7500f);
-    make_specs.emplace_back("easysharem883", 5.7500f);
-    make_specs.emplace_back("easysharem893is", 5.7500f);
-    make_specs.emplace_back("easysharemaxz990", 6.0800f);
-    make_specs.emplace_back("easysharemd1063", 6.0800f);
-    make_specs.emplace_back("easysharemd30", 6.0800f);
-    make_specs.emplace_back("easysharemd41", 6.0800f);
-    make_specs.emplace_back("easysharemd81", 6.0800f);
-    make_specs.emplace_back("easysharemd853", 5.7500f);
-    make_specs.emplace_back("easysharemd863", 5.7500f);
-    make_specs.emplace_back("easysharemini", 4.8000f);
-    make_specs.emplace_back("easysharemx1063", 6.0800f);
-    make_specs.emplace_back("easyshareone6mp", 5.7500f);
-    make_specs.emplace_back("easyshareone", 5.7500f);
-    make_specs.emplace_back("easysharep712", 5.7500f);
-    make_specs.emplace_back("easysharep850", 5.7500f);
-    make_specs.emplace_back("easysharep880", 7.1100f);
-    make_specs.emplace_back("easysharesport", 6.1600f);
-    make_specs.emplace_back("easysharetouchm577", 6.1600f);
-    make_specs.emplace_back("easysharev1003", 7.1100f);
-    make_specs.emplace_back("easysharev1073", 7.8500f);
-    make_specs.emplace_back("easysharev1233", 7.4400f);
-    make_specs.emplace_back("easysharev1253", 7.4400f);
-    make_specs.emplace_back("easysharev1273", 7.4400f);
-    make_specs.emplace_back("easysharev530", 5.7500f);
-    make_specs.emplace_back("easysharev550", 5.7500f);
-    make_specs.emplace_back("easysharev570", 5.7500f);
-    make_specs.emplace_back("easysharev603", 5.7500f);
-    make_specs.emplace_back("easysharev610", 5.7500f);
-    make_specs.emplace_back("easysharev705", 5.7500f);
-    make_specs.emplace_back("easysharev803", 7.1100f);
-    make_specs.emplace_back("easysharez1012is", 6.0800f);
-    make_specs.emplace_back("easysharez1015is", 6.0800f);
-    make_specs.emplace_back("easysharez1085is", 7.8500f);
-    make_specs.emplace_back("easysharez1275", 7.4400f);
-    make_specs.emplace_back("easysharez1285", 7.4400f);
-    make_specs.emplace_back("easysharez1485is", 7.4400f);
-    make_specs.emplace_back("easysharez5010", 6.1600f);
-    make_specs.emplace_back("easysharez5120", 6.0800f);
-    make_specs.emplace_back("easysharez612", 5.7500f);
-    make_specs.emplace_back("easysharez650", 5.7500f);
-    make_specs.emplace_back("easysharez700", 5.7500f);
-    make_specs.emplace_back("easysharez710", 5.7500f);
-    make_specs.emplace_back("easysharez712is", 5.7500f);
-    make_specs.emplace_back("easysharez730", 5.7500f);
-    make_specs.emplace_back("easysharez740", 5.7500f);
-    make_specs.emplace_back("easysharez7590", 5.7500f);
-    make_specs.emplace_back("easysharez760", 7.1100f);
-    make_specs.emplace_back("easysharez812is", 5.7500f);
-    make_specs.emplace_back("easysharez8612is", 5.7500f);
-    make_specs.emplace_back("easysharez885", 7.1100f);
-    make_specs.emplace_back("easysharez915", 6.1600f);
-    make_specs.emplace_back("easysharez950", 6.0800f);
-    make_specs.emplace_back("easysharez980", 6.0800f);
-    make_specs.emplace_back("easysharez981", 6.0800f);
-    make_specs.emplace_back("easysharez990", 6.0800f);
-    make_specs.emplace_back("easysharezd15", 6.1600f);
-    make_specs.emplace_back("easysharezd710", 5.7500f);
-    make_specs.emplace_back("easysharezd8612is", 5.7500f);
-    make_specs.emplace_back("ls420", 7.1100f);
-    make_specs.emplace_back("ls443", 5.3300f);
-    make_specs.emplace_back("ls633", 5.7500f);
-    make_specs.emplace_back("ls743", 7.1100f);
-    make_specs.emplace_back("ls753", 7.1100f);
-    make_specs.emplace_back("ls755", 5.7500f);
-    make_specs.emplace_back("m590", 4.8000f);
-    make_specs.emplace_back("mc3", 6.4000f);
-    make_specs.emplace_back("pixproaz251", 6.1600f);
-    make_specs.emplace_back("pixproaz361", 6.1600f);
-    make_specs.emplace_back("pixproaz362", 6.1600f);
-    make_specs.emplace_back("pixproaz501", 6.1600f);
-    make_specs.emplace_back("pixproaz521", 6.1600f);
-    make_specs.emplace_back("pixproaz522", 6.1600f);
-    make_specs.emplace_back("pixproaz651", 6.1600f);
-    make_specs.emplace_back("pixprofz151", 6.1600f);
-    make_specs.emplace_back("pixprofz201", 6.1600f);
-    make_specs.emplace_back("pixprofz41", 6.1600f);
-    make_specs.emplace_back("pixprofz51", 6.1600f);
-    make_specs.emplace_back("s1", 17.3000f);
-    make_specs.emplace_back("slice", 6.1600f);
-  }
+constexpr CameraModelSpecs kKonicaModels[] = {
+    {"dg2", 5.3300f},
+    {"dg3z", 5.3300f},
+    {"qm100", 4.8000f},
+    {"qm200", 6.4000f},
+    {"revioc2", 4.2300f},
+    {"reviokd200z", 5.3300f},
+    {"reviokd210z", 7.1100f},
+    {"reviokd220z", 4.5000f},
+    {"reviokd25", 7.1100f},
+    {"reviokd300z", 7.1100f},
+    {"reviokd310z", 7.1100f},
+    {"reviokd3300z", 5.7500f},
+    {"reviokd4000z", 7.1100f},
+    {"reviokd400z", 7.1100f},
+    {"reviokd410z", 7.1100f},
+    {"reviokd420z", 5.7500f},
+    {"reviokd500z", 7.1100f},
+    {"reviokd510z", 7.1100f},
+};
 
-  {
-    auto& make_specs = specs["konica"];
-    make_specs.reserve(18);
-    make_specs.emplace_back("dg2", 5.3300f);
-    make_specs.emplace_back("dg3z", 5.3300f);
-    make_specs.emplace_back("qm100", 4.8000f);
-    make_specs.emplace_back("qm200", 6.4000f);
-    make_specs.emplace_back("revioc2", 4.2300f);
-    make_specs.emplace_back("reviokd200z", 5.3300f);
-    make_specs.emplace_back("reviokd210z", 7.1100f);
-    make_specs.emplace_back("reviokd220z", 4.5000f);
-    make_specs.emplace_back("reviokd25", 7.1100f);
-    make_specs.emplace_back("reviokd300z", 7.1100f);
-    make_specs.emplace_back("reviokd310z", 7.1100f);
-    make_specs.emplace_back("reviokd3300z", 5.7500f);
-    make_specs.emplace_back("reviokd4000z", 7.1100f);
-    make_specs.emplace_back("reviokd400z", 7.1100f);
-    make_specs.emplace_back("reviokd410z", 7.1100f);
-    make_specs.emplace_back("reviokd420z", 5.7500f);
-    make_specs.emplace_back("reviokd500z", 7.1100f);
-    make_specs.emplace_back("reviokd510z", 7.1100f);
-  }
+constexpr CameraModelSpecs kKonicaMinoltaModels[] = {
+    {"dg5w", 5.7500f},
+    {"dimagea200", 8.8000f},
+    {"dimagea2", 8.8000f},
+    {"dimagee40", 6.4000f},
+    {"dimagee500", 5.7500f},
+    {"dimagee50", 5.7500f},
+    {"dimageg530", 5.7500f},
+    {"dimageg600", 7.2700f},
+    {"dimagex1", 7.1100f},
+    {"dimagex31", 4.5000f},
+    {"dimagex50", 5.7500f},
+    {"dimagex60", 5.7500f},
+    {"dimagexg", 5.3300f},
+    {"dimagez10", 5.7500f},
+    {"dimagez20", 5.7500f},
+    {"dimagez2", 5.7500f},
+    {"dimagez3", 5.7500f},
+    {"dimagez5", 5.7500f},
+    {"dimagez6", 5.7500f},
+    {"dynax5d", 23.5000f},
+    {"dynax7d", 23.5000f},
+    {"eminid", 8.8000f},
+    {"eminim", 8.8000f},
+    {"emini", 8.8000f},
+};
 
-  {
-    auto& make_specs = specs["konica-minolta"];
-    make_specs.reserve(24);
-    make_specs.emplace_back("dg5w", 5.7500f);
-    make_specs.emplace_back("dimagea200", 8.8000f);
-    make_specs.emplace_back("dimagea2", 8.8000f);
-    make_specs.emplace_back("dimagee40", 6.4000f);
-    make_specs.emplace_back("dimagee500", 5.7500f);
-    make_specs.emplace_back("dimagee50", 5.7500f);
-    make_specs.emplace_back("dimageg530", 5.7500f);
-    make_specs.emplace_back("dimageg600", 7.2700f);
-    make_specs.emplace_back("dimagex1", 7.1100f);
-    make_specs.emplace_back("dimagex31", 4.5000f);
-    make_specs.emplace_back("dimagex50", 5.7500f);
-    make_specs.emplace_back("dimagex60", 5.7500f);
-    make_specs.emplace_back("dimagexg", 5.3300f);
-    make_specs.emplace_back("dimagez10", 5.7500f);
-    make_specs.emplace_back("dimagez20", 5.7500f);
-    make_specs.emplace_back("dimagez2", 5.7500f);
-    make_specs.emplace_back("dimagez3", 5.7500f);
-    make_specs.emplace_back("dimagez5", 5.7500f);
-    make_specs.emplace_back("dimagez6", 5.7500f);
-    make_specs.emplace_back("dynax5d", 23.5000f);
-    make_specs.emplace_back("dynax7d", 23.5000f);
-    make_specs.emplace_back("eminid", 8.8000f);
-    make_specs.emplace_back("eminim", 8.8000f);
-    make_specs.emplace_back("emini", 8.8000f);
-  }
+constexpr CameraModelSpecs kKyoceraModels[] = {
+    {"finecam3300", 7.1100f},
+    {"finecaml30", 5.3300f},
+    {"finecaml3v", 5.3300f},
+    {"finecaml3", 5.3300f},
+    {"finecaml4v", 7.1100f},
+    {"finecaml4", 5.7500f},
+    {"finecamm400r", 5.3300f},
+    {"finecamm410r", 5.3300f},
+    {"finecams3l", 7.1100f},
+    {"finecams3r", 7.1100f},
+    {"finecams3x", 7.1100f},
+    {"finecams3", 7.1100f},
+    {"finecams4", 7.1100f},
+    {"finecams5r", 7.1100f},
+    {"finecams5", 7.1100f},
+    {"finecamsl300r", 5.3300f},
+    {"finecamsl400r", 5.3300f},
+};
 
-  {
-    auto& make_specs = specs["kyocera"];
-    make_specs.reserve(17);
-    make_specs.emplace_back("finecam3300", 7.1100f);
-    make_specs.emplace_back("finecaml30", 5.3300f);
-    make_specs.emplace_back("finecaml3v", 5.3300f);
-    make_specs.emplace_back("finecaml3", 5.3300f);
-    make_specs.emplace_back("finecaml4v", 7.1100f);
-    make_specs.emplace_back("finecaml4", 5.7500f);
-    make_specs.emplace_back("finecamm400r", 5.3300f);
-    make_specs.emplace_back("finecamm410r", 5.3300f);
-    make_specs.emplace_back("finecams3l", 7.1100f);
-    make_specs.emplace_back("finecams3r", 7.1100f);
-    make_specs.emplace_back("finecams3x", 7.1100f);
-    make_specs.emplace_back("finecams3", 7.1100f);
-    make_specs.emplace_back("finecams4", 7.1100f);
-    make_specs.emplace_back("finecams5r", 7.1100f);
-    make_specs.emplace_back("finecams5", 7.1100f);
-    make_specs.emplace_back("finecamsl300r", 5.3300f);
-    make_specs.emplace_back("finecamsl400r", 5.3300f);
-  }
+constexpr CameraModelSpecs kLeicaModels[] = {
+    {"clux1", 5.7500f},
+    {"clux2", 5.7500f},
+    {"clux3", 6.0800f},
+    {"c(typ112)", 7.5300f},
+    {"dlux2", 7.7600f},
+    {"dlux3", 7.7600f},
+    {"dlux4", 7.8500f},
+    {"dlux5", 7.8500f},
+    {"dlux6", 7.5300f},
+    {"dlux(typ109)", 17.3000f},
+    {"dlux", 5.7500f},
+    {"digilux1", 7.5300f},
+    {"digilux2", 8.8000f},
+    {"digilux3", 17.3000f},
+    {"digilux4.3", 7.5300f},
+    {"digiluxzoom", 6.4000f},
+    {"digilux", 6.4000f},
+    {"medition60", 36.0000f},
+    {"mmonochrom(typ246)", 35.8000f},
+    {"mmonochrom", 35.8000f},
+    {"mp", 36.0000f},
+    {"mtyp240", 36.0000f},
+    {"m8.2", 27.0000f},
+    {"m8", 27.0000f},
+    {"m9p", 35.8000f},
+    {"m9titanium", 35.8000f},
+    {"m9", 35.8000f},
+    {"metyp220", 35.8000f},
+    {"q(typ116)", 36.0000f},
+    {"se", 45.0000f},
+    {"s(type007)", 45.0000f},
+    {"s2", 45.0000f},
+    {"sl(typ601)", 36.0000f},
+    {"t(typ701)", 23.6000f},
+    {"vlux1", 7.1100f},
+    {"vlux20", 6.0800f},
+    {"vlux2", 6.0800f},
+    {"vlux30", 6.0800f},
+    {"vlux3", 6.0800f},
+    {"vlux40", 6.0800f},
+    {"vlux4", 6.1600f},
+    {"vlux(typ114)", 13.2000f},
+    {"x1", 23.6000f},
+    {"xe", 23.6000f},
+    {"x(typ113)", 23.6000f},
+    {"xvario", 23.6000f},
+    {"x2", 23.6000f},
+};
 
-  {
-    auto& make_specs = specs["leica"];
-    make_specs.reserve(47);
-    make_specs.emplace_back("clux1", 5.7500f);
-    make_specs.emplace_back("clux2", 5.7500f);
-    make_specs.emplace_back("clux3", 6.0800f);
-    make_specs.emplace_back("c(typ112)", 7.5300f);
-    make_specs.emplace_back("dlux2", 7.7600f);
-    make_specs.emplace_back("dlux3", 7.7600f);
-    make_specs.emplace_back("dlux4", 7.8500f);
-    make_specs.emplace_back("dlux5", 7.8500f);
-    make_specs.emplace_back("dlux6", 7.5300f);
-    make_specs.emplace_back("dlux(typ109)", 17.3000f);
-    make_specs.emplace_back("dlux", 5.7500f);
-    make_specs.emplace_back("digilux1", 7.5300f);
-    make_specs.emplace_back("digilux2", 8.8000f);
-    make_specs.emplace_back("digilux3", 17.3000f);
-    make_specs.emplace_back("digilux4.3", 7.5300f);
-    make_specs.emplace_back("digiluxzoom", 6.4000f);
-    make_specs.emplace_back("digilux", 6.4000f);
-    make_specs.emplace_back("medition60", 36.0000f);
-    make_specs.emplace_back("mmonochrom(typ246)", 35.8000f);
-    make_specs.emplace_back("mmonochrom", 35.8000f);
-    make_specs.emplace_back("mp", 36.0000f);
-    make_specs.emplace_back("mtyp240", 36.0000f);
-    make_specs.emplace_back("m8.2", 27.0000f);
-    make_specs.emplace_back("m8", 27.0000f);
-    make_specs.emplace_back("m9p", 35.8000f);
-    make_specs.emplace_back("m9titanium", 35.8000f);
-    make_specs.emplace_back("m9", 35.8000f);
-    make_specs.emplace_back("metyp220", 35.8000f);
-    make_specs.emplace_back("q(typ116)", 36.0000f);
-    make_specs.emplace_back("se", 45.0000f);
-    make_specs.emplace_back("s(type007)", 45.0000f);
-    make_specs.emplace_back("s2", 45.0000f);
-    make_specs.emplace_back("sl(typ601)", 36.0000f);
-    make_specs.emplace_back("t(typ701)", 23.6000f);
-    make_specs.emplace_back("vlux1", 7.1100f);
-    make_specs.emplace_back("vlux20", 6.0800f);
-    make_specs.emplace_back("vlux2", 6.0800f);
-    make_specs.emplace_back("vlux30", 6.0800f);
-    make_specs.emplace_back("vlux3", 6.0800f);
-    make_specs.emplace_back("vlux40", 6.0800f);
-    make_specs.emplace_back("vlux4", 6.1600f);
-    make_specs.emplace_back("vlux(typ114)", 13.2000f);
-    make_specs.emplace_back("x1", 23.6000f);
-    make_specs.emplace_back("xe", 23.6000f);
-    make_specs.emplace_back("x(typ113)", 23.6000f);
-    make_specs.emplace_back("xvario", 23.6000f);
-    make_specs.emplace_back("x2", 23.6000f);
-  }
+constexpr CameraModelSpecs kMinoltaModels[] = {
+    {"dimage2300", 7.5300f},
+    {"dimage2330", 7.5300f},
+    {"dimage5", 7.1100f},
+    {"dimage7hi", 8.8000f},
+    {"dimage7i", 8.8000f},
+    {"dimage7", 8.8000f},
+    {"dimagea1", 8.8000f},
+    {"dimagee201", 7.5300f},
+    {"dimagee203", 5.3300f},
+    {"dimagee223", 5.3300f},
+    {"dimagee323", 5.3300f},
+    {"dimageex1500wide", 6.4000f},
+    {"dimageex1500zoom", 6.4000f},
+    {"dimagef100", 7.1100f},
+    {"dimagef200", 7.1100f},
+    {"dimagef300", 7.1100f},
+    {"dimageg400", 5.7500f},
+    {"dimageg500", 7.1100f},
+    {"dimages304", 7.1100f},
+    {"dimages404", 7.1100f},
+    {"dimages414", 7.1100f},
+    {"dimagex20", 4.5000f},
+    {"dimagexi", 5.3300f},
+    {"dimagext", 5.3300f},
+    {"dimagex", 5.3300f},
+    {"dimagez1", 5.3300f},
+    {"rd3000", 6.4000f},
+};
 
-  {
-    auto& make_specs = specs["minolta"];
-    make_specs.reserve(27);
-    make_specs.emplace_back("dimage2300", 7.5300f);
-    make_specs.emplace_back("dimage2330", 7.5300f);
-    make_specs.emplace_back("dimage5", 7.1100f);
-    make_specs.emplace_back("dimage7hi", 8.8000f);
-    make_specs.emplace_back("dimage7i", 8.8000f);
-    make_specs.emplace_back("dimage7", 8.8000f);
-    make_specs.emplace_back("dimagea1", 8.8000f);
-    make_specs.emplace_back("dimagee201", 7.5300f);
-    make_specs.emplace_back("dimagee203", 5.3300f);
-    make_specs.emplace_back("dimagee223", 5.3300f);
-    make_specs.emplace_back("dimagee323", 5.3300f);
-    make_specs.emplace_back("dimageex1500wide", 6.4000f);
-    make_specs.emplace_back("dimageex1500zoom", 6.4000f);
-    make_specs.emplace_back("dimagef100", 7.1100f);
-    make_specs.emplace_back("dimagef200", 7.1100f);
-    make_specs.emplace_back("dimagef300", 7.1100f);
-    make_specs.emplace_back("dimageg400", 5.7500f);
-    make_specs.emplace_back("dimageg500", 7.1100f);
-    make_specs.emplace_back("dimages304", 7.1100f);
-    make_specs.emplace_back("dimages404", 7.1100f);
-    make_specs.emplace_back("dimages414", 7.1100f);
-    make_specs.emplace_back("dimagex20", 4.5000f);
-    make_specs.emplace_back("dimagexi", 5.3300f);
-    make_specs.emplace_back("dimagext", 5.3300f);
-    make_specs.emplace_back("dimagex", 5.3300f);
-    make_specs.emplace_back("dimagez1", 5.3300f);
-    make_specs.emplace_back("rd3000", 6.4000f);
-  }
+constexpr CameraModelSpecs kMinoxModels[] = {
+    {"classicleicam32.1", 6.4000f},
+    {"classicleicam33mp", 6.4000f},
+    {"classicleicam34mp", 6.4000f},
+    {"classicleicam35mp", 6.4000f},
+    {"dc1011carat", 7.5300f},
+    {"dc1011", 7.5300f},
+    {"dc1022", 7.5300f},
+    {"dc1033", 5.7500f},
+    {"dc1044", 6.0800f},
+    {"dc1055", 6.0800f},
+    {"dc1211", 6.0800f},
+    {"dc1222", 6.1600f},
+    {"dc1233", 6.0800f},
+    {"dc1311", 5.3300f},
+    {"dc1422", 6.0800f},
+    {"dc2111", 5.3300f},
+    {"dc2122", 5.3300f},
+    {"dc2133", 4.5000f},
+    {"dc3311", 7.1100f},
+    {"dc4011", 7.1100f},
+    {"dc4211", 5.7500f},
+    {"dc5011", 5.7500f},
+    {"dc5211", 7.1100f},
+    {"dc5222", 5.7500f},
+    {"dc6011", 5.7500f},
+    {"dc6033wp", 5.7500f},
+    {"dc6211", 5.7500f},
+    {"dc6311", 7.1100f},
+    {"dc7011", 5.7500f},
+    {"dc7022", 5.7500f},
+    {"dc7411", 5.7500f},
+    {"dc8011", 5.7500f},
+    {"dc8022wp", 5.7500f},
+    {"dc8111", 7.1100f},
+    {"dc8122", 7.1100f},
+    {"dc9011wp", 6.1600f},
+    {"dcc14.0", 6.1600f},
+    {"dcc5.0whiteedition", 6.1600f},
+    {"dcc5.1", 6.1600f},
+    {"dccleicam35mpgold", 6.1600f},
+    {"dccrolleiflexaf5.0", 6.4000f},
+    {"dd1diamond", 6.4000f},
+    {"dd100", 6.4000f},
+    {"dd1", 6.4000f},
+    {"dd200", 6.4000f},
+    {"dm1", 6.4000f},
+    {"mobidv", 6.4000f},
+    {"rolleiflexminidigi", 6.4000f},
+};
 
-  {
-    auto& make_specs = specs["minox"];
-    make_specs.reserve(48);
-    make_specs.emplace_back("classicleicam32.1", 6.4000f);
-    make_specs.emplace_back("classicleicam33mp", 6.4000f);
-    make_specs.emplace_back("classicleicam34mp", 6.4000f);
-    make_specs.emplace_back("classicleicam35mp", 6.4000f);
-    make_specs.emplace_back("dc1011carat", 7.5300f);
-    make_specs.emplace_back("dc1011", 7.5300f);
-    make_specs.emplace_back("dc1022", 7.5300f);
-    make_specs.emplace_back("dc1033", 5.7500f);
-    make_specs.emplace_back("dc1044", 6.0800f);
-    make_specs.emplace_back("dc1055", 6.0800f);
-    make_specs.emplace_back("dc1211", 6.0800f);
-    make_specs.emplace_back("dc1222", 6.1600f);
-    make_specs.emplace_back("dc1233", 6.0800f);
-    make_specs.emplace_back("dc1311", 5.3300f);
-    make_specs.emplace_back("dc1422", 6.0800f);
-    make_specs.emplace_back("dc2111", 5.3300f);
-    make_specs.emplace_back("dc2122", 5.3300f);
-    make_specs.emplace_back("dc2133", 4.5000f);
-    make_specs.emplace_back("dc3311", 7.1100f);
-    make_specs.emplace_back("dc4011", 7.1100f);
-    make_specs.emplace_back("dc4211", 5.7500f);
-    make_specs.emplace_back("dc5011", 5.7500f);
-    make_specs.emplace_back("dc5211", 7.1100f);
-    make_specs.emplace_back("dc5222", 5.7500f);
-    make_specs.emplace_back("dc6011", 5.7500f);
-    make_specs.emplace_back("dc6033wp", 5.7500f);
-    make_specs.emplace_back("dc6211", 5.7500f);
-    make_specs.emplace_back("dc6311", 7.1100f);
-    make_specs.emplace_back("dc7011", 5.7500f);
-    make_specs.emplace_back("dc7022", 5.7500f);
-    make_specs.emplace_back("dc7411", 5.7500f);
-    make_specs.emplace_back("dc8011", 5.7500f);
-    make_specs.emplace_back("dc8022wp", 5.7500f);
-    make_specs.emplace_back("dc8111", 7.1100f);
-    make_specs.emplace_back("dc8122", 7.1100f);
-    make_specs.emplace_back("dc9011wp", 6.1600f);
-    make_specs.emplace_back("dcc14.0", 6.1600f);
-    make_specs.emplace_back("dcc5.0whiteedition", 6.1600f);
-    make_specs.emplace_back("dcc5.1", 6.1600f);
-    make_specs.emplace_back("dccleicam35mpgold", 6.1600f);
-    make_specs.emplace_back("dccrolleiflexaf5.0", 6.4000f);
-    make_specs.emplace_back("dd1diamond", 6.4000f);
-    make_specs.emplace_back("dd100", 6.4000f);
-    make_specs.emplace_back("dd1", 6.4000f);
-    make_specs.emplace_back("dd200", 6.4000f);
-    make_specs.emplace_back("dm1", 6.4000f);
-    make_specs.emplace_back("mobidv", 6.4000f);
-    make_specs.emplace_back("rolleiflexminidigi", 6.4000f);
-  }
+constexpr CameraModelSpecs kNikonModels[] = {
+    {"1aw1", 13.2000f},
+    {"1j1", 13.2000f},
+    {"1j2", 13.2000f},
+    {"1j3", 13.2000f},
+    {"1j4", 13.2000f},
+    {"1j5", 13.2000f},
+    {"1s1", 13.2000f},
+    {"1s2", 13.2000f},
+    {"1v1", 13.2000f},
+    {"1v2", 13.2000f},
+    {"1v3", 13.2000f},
+    {"coolpix100", 4.8000f},
+    {"coolpix2000", 5.3300f},
+    {"coolpix2100", 4.5000f},
+    {"coolpix2200", 4.5000f},
+    {"coolpix2500", 5.3300f},
+    {"coolpix300", 4.8000f},
+    {"coolpix3100", 5.3300f},
+    {"coolpix3200", 5.3300f},
+    {"coolpix3500", 5.3300f},
+    {"coolpix3700", 5.3300f},
+    {"coolpix4100", 5.7500f},
+    {"coolpix4200", 7.1100f},
+    {"coolpix4300", 7.1100f},
+    {"coolpix4500", 7.1100f},
+    {"coolpix4600", 5.7500f},
+    {"coolpix4800", 5.7500f},
+    {"coolpix5000", 8.8000f},
+    {"coolpix5200", 7.1100f},
+    {"coolpix5400", 7.1100f},
+    {"coolpix5600", 5.7500f},
+    {"coolpix5700", 8.8000f},
+    {"coolpix5900", 7.1100f},
+    {"coolpix600", 5.3300f},
+    {"coolpix700", 6.4000f},
+    {"coolpix7600", 7.1100f},
+    {"coolpix775", 5.3300f},
+    {"coolpix7900", 7.1100f},
+    {"coolpix800", 6.4000f},
+    {"coolpix8400", 8.8000f},
+    {"coolpix8700", 8.8000f},
+    {"coolpix8800", 8.8000f},
+    {"coolpix880", 7.1100f},
+    {"coolpix885", 7.1100f},
+    {"coolpix900s", 5.3300f},
+    {"coolpix900", 5.3300f},
+    {"coolpix910", 6.4000f},
+    {"coolpix950", 6.4000f},
+    {"coolpix990", 7.1100f},
+    {"coolpix995", 7.1100f},
+    {"coolpixaw100s", 6.1600f},
+    {"coolpixaw100", 6.1600f},
+    {"coolpixaw110", 6.1600f},
+    {"coolpixaw120", 6.1600f},
+    {"coolpixaw130", 6.1600f},
+    {"coolpixa", 23.6000f},
+    {"coolpixl100", 6.0800f},
+    {"coolpixl101", 5.7500f},
+    {"coolpixl10", 5.7500f},
+    {"coolpixl110", 6.1600f},
+    {"coolpixl11", 5.7500f},
+    {"coolpixl120", 6.1600f},
+    {"coolpixl12", 5.7500f},
+    {"coolpixl14", 5.7500f},
+    {"coolpixl15", 5.7500f},
+    {"coolpixl16", 5.7500f},
+    {"coolpixl18", 5.7500f},
+    {"coolpixl19", 5.7500f},
+    {"coolpixl1", 5.7500f},
+    {"coolpixl20", 6.0800f},
+    {"coolpixl21", 6.0800f},
+    {"coolpixl22", 6.1600f},
+    {"coolpixl23", 4.9600f},
+    {"coolpixl24", 6.1600f},
+    {"coolpixl25", 4.8000f},
+    {"coolpixl26", 6.1600f},
+    {"coolpixl27", 6.1600f},
+    {"coolpixl28", 6.1600f},
+    {"coolpixl29", 6.1600f},
+    {"coolpixl30", 6.1600f},
+    {"coolpixl310", 6.1600f},
+    {"coolpixl31", 6.1600f},
+    {"coolpixl320", 6.1600f},
+    {"coolpixl32", 6.1600f},
+    {"coolpixl330", 6.1600f},
+    {"coolpixl5", 5.7500f},
+    {"coolpixl610", 6.1600f},
+    {"coolpixl620", 6.1600f},
+    {"coolpixl6", 5.7500f},
+    {"coolpixl810", 6.1600f},
+    {"coolpixl820", 6.1600f},
+    {"coolpixl830", 6.1600f},
+    {"coolpixl840", 6.1600f},
+    {"coolpixp100", 6.1600f},
+    {"coolpixp1", 7.1100f},
+    {"coolpixp2", 7.1100f},
+    {"coolpixp300", 6.1600f},
+    {"coolpixp310", 6.1600f},
+    {"coolpixp330", 7.5300f},
+    {"coolpixp340", 7.5300f},
+    {"coolpixp3", 7.1100f},
+    {"coolpixp4", 7.1100f},
+    {"coolpixp5000", 7.1100f},
+    {"coolpixp500", 6.1600f},
+    {"coolpixp50", 5.7500f},
+    {"coolpixp5100", 7.4400f},
+    {"coolpixp510", 6.1600f},
+    {"coolpixp520", 6.1600f},
+    {"coolpixp530", 6.1600f},
+    {"coolpixp6000", 7.4400f},
+    {"coolpixp600", 6.1600f},
+    {"coolpixp60", 5.7500f},
+    {"coolpixp610", 6.1600f},
+    {"coolpixp7000", 7.5300f},
+    {"coolpixp7100", 7.5300f},
+    {"coolpixp7700", 7.5300f},
+    {"coolpixp7800", 7.5300f},
+    {"coolpixp80", 6.0800f},
+    {"coolpixp900", 6.1600f},
+    {"coolpixp90", 6.0800f},
+    {"coolpixs01", 4.9600f},
+    {"coolpixs02", 4.8000f},
+    {"coolpixs1000pj", 6.1600f},
+    {"coolpixs100", 6.1600f},
+    {"coolpixs10", 5.7500f},
+    {"coolpixs1100pj", 6.1600f},
+    {"coolpixs1200pj", 6.1600f},
+    {"coolpixs1", 5.7500f},
+    {"coolpixs200", 5.7500f},
+    {"coolpixs210", 5.7500f},
+    {"coolpixs220", 6.0800f},
+    {"coolpixs225", 6.0800f},
+    {"coolpixs230", 6.0800f},
+    {"coolpixs2500", 6.1600f},
+    {"coolpixs2600", 6.1600f},
+    {"coolpixs2700", 6.1600f},
+    {"coolpixs2750", 6.1600f},
+    {"coolpixs2800", 6.1600f},
+    {"coolpixs2900", 6.1600f},
+    {"coolpixs2", 5.7500f},
+    {"coolpixs3000", 6.1600f},
+    {"coolpixs30", 4.8000f},
+    {"coolpixs3100", 6.1600f},
+    {"coolpixs31", 4.9600f},
+    {"coolpixs3200", 6.1600f},
+    {"coolpixs32", 4.8000f},
+    {"coolpixs3300", 6.1600f},
+    {"coolpixs33", 4.8000f},
+    {"coolpixs3400", 6.1600f},
+    {"coolpixs3500", 6.1600f},
+    {"coolpixs3600", 6.1600f},
+    {"coolpixs3700", 6.1600f},
+    {"coolpixs3", 5.7500f},
+    {"coolpixs4000", 6.1600f},
+    {"coolpixs4100", 6.1600f},
+    {"coolpixs4150", 6.1600f},
+    {"coolpixs4200", 6.1600f},
+    {"coolpixs4300", 6.1600f},
+    {"coolpixs4400", 6.1600f},
+    {"coolpixs4", 5.7500f},
+    {"coolpixs500", 5.7500f},
+    {"coolpixs50c", 5.7500f},
+    {"coolpixs50", 5.7500f},
+    {"coolpixs5100", 6.1600f},
+    {"coolpixs510", 5.7500f},
+    {"coolpixs51c", 5.7500f},
+    {"coolpixs51", 5.7500f},
+    {"coolpixs5200", 6.1600f},
+    {"coolpixs520", 5.7500f},
+    {"coolpixs52c", 5.7500f},
+    {"coolpixs52", 5.7500f},
+    {"coolpixs5300", 6.1600f},
+    {"coolpixs550", 6.1600f},
+    {"coolpixs560", 6.0800f},
+    {"coolpixs570", 6.1600f},
+    {"coolpixs5", 5.7500f},
+    {"coolpixs6000", 6.1600f},
+    {"coolpixs600", 6.0800f},
+    {"coolpixs60", 6.1600f},
+    {"coolpixs6100", 6.1600f},
+    {"coolpixs610c", 6.0800f},
+    {"coolpixs610", 6.0800f},
+    {"coolpixs6150", 6.1600f},
+    {"coolpixs6200", 6.1600f},
+    {"coolpixs620", 6.0800f},
+    {"coolpixs6300", 6.1600f},
+    {"coolpixs630", 6.0800f},
+    {"coolpixs6400", 6.1600f},
+    {"coolpixs640", 6.0800f},
+    {"coolpixs6500", 6.1600f},
+    {"coolpixs6600", 6.1600f},
+    {"coolpixs6700", 6.1600f},
+    {"coolpixs6800", 6.1600f},
+    {"coolpixs6900", 6.1600f},
+    {"coolpixs6", 5.7500f},
+    {"coolpixs7000", 6.1600f},
+    {"coolpixs700", 7.4400f},
+    {"coolpixs70", 6.1600f},
+    {"coolpixs710", 7.4400f},
+    {"coolpixs7c", 5.7500f},
+    {"coolpixs8000", 6.1600f},
+    {"coolpixs800c", 6.1600f},
+    {"coolpixs80", 6.1600f},
+    {"coolpixs8100", 6.1600f},
+    {"coolpixs810c", 6.1600f},
+    {"coolpixs8200", 6.1600f},
+    {"coolpixs9050", 6.1600f},
+    {"coolpixs9100", 6.1600f},
+    {"coolpixs9200", 6.1600f},
+    {"coolpixs9300", 6.1600f},
+    {"coolpixs9400", 6.1600f},
+    {"coolpixs9500", 6.1600f},
+    {"coolpixs9600", 6.1600f},
+    {"coolpixs9700", 6.1600f},
+    {"coolpixs9900", 6.1600f},
+    {"coolpixs9", 5.7500f},
+    {"coolpixsq", 5.3300f},
+    {"d100", 23.7000f},
+    {"d1h", 23.7000f},
+    {"d1x", 23.7000f},
+    {"d1", 23.7000f},
+    {"d200", 23.6000f},
+    {"d2hs", 23.2000f},
+    {"d2h", 23.7000f},
+    {"d2xs", 23.7000f},
+    {"d2x", 23.7000f},
+    {"d3000", 23.6000f},
+    {"d300s", 23.6000f},
+    {"d300", 23.6000f},
+    {"d3100", 23.1000f},
+    {"d3200", 23.2000f},
+    {"d3300", 23.5000f},
+    {"d3s", 36.0000f},
+    {"d3x", 35.9000f},
+    {"d3", 36.0000f},
+    {"d40x", 23.6000f},
+    {"d40", 23.7000f},
+    {"d4s", 36.0000f},
+    {"d4", 36.0000f},
+    {"d5000", 23.6000f},
+    {"d50", 23.7000f},
+    {"d5100", 23.6000f},
+    {"d5200", 23.5000f},
+    {"d5300", 23.5000f},
+    {"d5500", 23.5000f},
+    {"d600", 35.9000f},
+    {"d60", 23.6000f},
+    {"d610", 35.9000f},
+    {"d7000", 23.6000f},
+    {"d700", 36.0000f},
+    {"d70s", 23.7000f},
+    {"d70", 23.7000f},
+    {"d7100", 23.5000f},
+    {"d7200", 23.5000f},
+    {"d750", 35.9000f},
+    {"d800e", 35.9000f},
+    {"d800", 35.9000f},
+    {"d80", 23.6000f},
+    {"d810", 35.9000f},
+    {"d90", 23.6000f},
+    {"df", 36.0000f},
+    {"e2ns", 8.8000f},
+    {"e2n", 8.8000f},
+    {"e2s", 8.8000f},
+    {"e3s", 8.8000f},
+    {"e3", 8.8000f},
+};
 
-  {
-    auto& make_specs = specs["nikon"];
-    make_specs.reserve(266);
-    make_specs.emplace_back("1aw1", 13.2000f);
-    make_specs.emplace_back("1j1", 13.2000f);
-    make_specs.emplace_back("1j2", 13.2000f);
-    make_specs.emplace_back("1j3", 13.2000f);
-    make_specs.emplace_back("1j4", 13.2000f);
-    make_specs.emplace_back("1j5", 13.2000f);
-    make_specs.emplace_back("1s1", 13.2000f);
-    make_specs.emplace_back("1s2", 13.2000f);
-    make_specs.emplace_back("1v1", 13.2000f);
-    make_specs.emplace_back("1v2", 13.2000f);
-    make_specs.emplace_back("1v3", 13.2000f);
-    make_specs.emplace_back("coolpix100", 4.8000f);
-    make_specs.emplace_back("coolpix2000", 5.3300f);
-    make_specs.emplace_back("coolpix2100", 4.5000f);
-    make_specs.emplace_back("coolpix2200", 4.5000f);
-    make_specs.emplace_back("coolpix2500", 5.3300f);
-    make_specs.emplace_back("coolpix300", 4.8000f);
-    make_specs.emplace_back("coolpix3100", 5.3300f);
-    make_specs.emplace_back("coolpix3200", 5.3300f);
-    make_specs.emplace_back("coolpix3500", 5.3300f);
-    make_specs.emplace_back("coolpix3700", 5.3300f);
-    make_specs.emplace_back("coolpix4100", 5.7500f);
-    make_specs.emplace_back("coolpix4200", 7.1100f);
-    make_specs.emplace_back("coolpix4300", 7.1100f);
-    make_specs.emplace_back("coolpix4500", 7.1100f);
-    make_specs.emplace_back("coolpix4600", 5.7500f);
-    make_specs.emplace_back("coolpix4800", 5.7500f);
-    make_specs.emplace_back("coolpix5000", 8.8000f);
-    make_specs.emplace_back("coolpix5200", 7.1100f);
-    make_specs.emplace_back("coolpix5400", 7.1100f);
-    make_specs.emplace_back("coolpix5600", 5.7500f);
-    make_specs.emplace_back("coolpix5700", 8.8000f);
-    make_specs.emplace_back("coolpix5900", 7.1100f);
-    make_specs.emplace_back("coolpix600", 5.3300f);
-    make_specs.emplace_back("coolpix700", 6.4000f);
-    make_specs.emplace_back("coolpix7600", 7.1100f);
-    make_specs.emplace_back("coolpix775", 5.3300f);
-    make_specs.emplace_back("coolpix7900", 7.1100f);
-    make_specs.emplace_back("coolpix800", 6.4000f);
-    make_specs.emplace_back("coolpix8400", 8.8000f);
-    make_specs.emplace_back("coolpix8700", 8.8000f);
-    make_specs.emplace_back("coolpix8800", 8.8000f);
-    make_specs.emplace_back("coolpix880", 7.1100f);
-    make_specs.emplace_back("coolpix885", 7.1100f);
-    make_specs.emplace_back("coolpix900s", 5.3300f);
-    make_specs.emplace_back("coolpix900", 5.3300f);
-    make_specs.emplace_back("coolpix910", 6.4000f);
-    make_specs.emplace_back("coolpix950", 6.4000f);
-    make_specs.emplace_back("coolpix990", 7.1100f);
-    make_specs.emplace_back("coolpix995", 7.1100f);
-    make_specs.emplace_back("coolpixaw100s", 6.1600f);
-    make_specs.emplace_back("coolpixaw100", 6.1600f);
-    make_specs.emplace_back("coolpixaw110", 6.1600f);
-    make_specs.emplace_back("coolpixaw120", 6.1600f);
-    make_specs.emplace_back("coolpixaw130", 6.1600f);
-    make_specs.emplace_back("coolpixa", 23.6000f);
-    make_specs.emplace_back("coolpixl100", 6.0800f);
-    make_specs.emplace_back("coolpixl101", 5.7500f);
-    make_specs.emplace_back("coolpixl10", 5.7500f);
-    make_specs.emplace_back("coolpixl110", 6.1600f);
-    make_specs.emplace_back("coolpixl11", 5.7500f);
-    make_specs.emplace_back("coolpixl120", 6.1600f);
-    make_specs.emplace_back("coolpixl12", 5.7500f);
-    make_specs.emplace_back("coolpixl14", 5.7500f);
-    make_specs.emplace_back("coolpixl15", 5.7500f);
-    make_specs.emplace_back("coolpixl16", 5.7500f);
-    make_specs.emplace_back("coolpixl18", 5.7500f);
-    make_specs.emplace_back("coolpixl19", 5.7500f);
-    make_specs.emplace_back("coolpixl1", 5.7500f);
-    make_specs.emplace_back("coolpixl20", 6.0800f);
-    make_specs.emplace_back("coolpixl21", 6.0800f);
-    make_specs.emplace_back("coolpixl22", 6.1600f);
-    make_specs.emplace_back("coolpixl23", 4.9600f);
-    make_specs.emplace_back("coolpixl24", 6.1600f);
-    make_specs.emplace_back("coolpixl25", 4.8000f);
-    make_specs.emplace_back("coolpixl26", 6.1600f);
-    make_specs.emplace_back("coolpixl27", 6.1600f);
-    make_specs.emplace_back("coolpixl28", 6.1600f);
-    make_specs.emplace_back("coolpixl29", 6.1600f);
-    make_specs.emplace_back("coolpixl30", 6.1600f);
-    make_specs.emplace_back("coolpixl310", 6.1600f);
-    make_specs.emplace_back("coolpixl31", 6.1600f);
-    make_specs.emplace_back("coolpixl320", 6.1600f);
-    make_specs.emplace_back("coolpixl32", 6.1600f);
-    make_specs.emplace_back("coolpixl330", 6.1600f);
-    make_specs.emplace_back("coolpixl5", 5.7500f);
-    make_specs.emplace_back("coolpixl610", 6.1600f);
-    make_specs.emplace_back("coolpixl620", 6.1600f);
-    make_specs.emplace_back("coolpixl6", 5.7500f);
-    make_specs.emplace_back("coolpixl810", 6.1600f);
-    make_specs.emplace_back("coolpixl820", 6.1600f);
-    make_specs.emplace_back("coolpixl830", 6.1600f);
-    make_specs.emplace_back("coolpixl840", 6.1600f);
-    make_specs.emplace_back("coolpixp100", 6.1600f);
-    make_specs.emplace_back("coolpixp1", 7.1100f);
-    make_specs.emplace_back("coolpixp2", 7.1100f);
-    make_specs.emplace_back("coolpixp300", 6.1600f);
-    make_specs.emplace_back("coolpixp310", 6.1600f);
-    make_specs.emplace_back("coolpixp330", 7.5300f);
-    make_specs.emplace_back("coolpixp340", 7.5300f);
-    make_specs.emplace_back("coolpixp3", 7.1100f);
-    make_specs.emplace_back("coolpixp4", 7.1100f);
-    make_specs.emplace_back("coolpixp5000", 7.1100f);
-    make_specs.emplace_back("coolpixp500", 6.1600f);
-    make_specs.emplace_back("coolpixp50", 5.7500f);
-    make_specs.emplace_back("coolpixp5100", 7.4400f);
-    make_specs.emplace_back("coolpixp510", 6.1600f);
-    make_specs.emplace_back("coolpixp520", 6.1600f);
-    make_specs.emplace_back("coolpixp530", 6.1600f);
-    make_specs.emplace_back("coolpixp6000", 7.4400f);
-    make_specs.emplace_back("coolpixp600", 6.1600f);
-    make_specs.emplace_back("coolpixp60", 5.7500f);
-    make_specs.emplace_back("coolpixp610", 6.1600f);
-    make_specs.emplace_back("coolpixp7000", 7.5300f);
-    make_specs.emplace_back("coolpixp7100", 7.5300f);
-    make_specs.emplace_back("coolpixp7700", 7.5300f);
-    make_specs.emplace_back("coolpixp7800", 7.5300f);
-    make_specs.emplace_back("coolpixp80", 6.0800f);
-    make_specs.emplace_back("coolpixp900", 6.1600f);
-    make_specs.emplace_back("coolpixp90", 6.0800f);
-    make_specs.emplace_back("coolpixs01", 4.9600f);
-    make_specs.emplace_back("coolpixs02", 4.8000f);
-    make_specs.emplace_back("coolpixs1000pj", 6.1600f);
-    make_specs.emplace_back("coolpixs100", 6.1600f);
-    make_specs.emplace_back("coolpixs10", 5.7500f);
-    make_specs.emplace_back("coolpixs1100pj", 6.1600f);
-    make_specs.emplace_back("coolpixs1200pj", 6.1600f);
-    make_specs.emplace_back("coolpixs1", 5.7500f);
-    make_specs.emplace_back("coolpixs200", 5.7500f);
-    make_specs.emplace_back("coolpixs210", 5.7500f);
-    make_specs.emplace_back("coolpixs220", 6.0800f);
-    make_specs.emplace_back("coolpixs225", 6.0800f);
-    make_specs.emplace_back("coolpixs230", 6.0800f);
-    make_specs.emplace_back("coolpixs2500", 6.1600f);
-    make_specs.emplace_back("coolpixs2600", 6.1600f);
-    make_specs.emplace_back("coolpixs2700", 6.1600f);
-    make_specs.emplace_back("coolpixs2750", 6.1600f);
-    make_specs.emplace_back("coolpixs2800", 6.1600f);
-    make_specs.emplace_back("coolpixs2900", 6.1600f);
-    make_specs.emplace_back("coolpixs2", 5.7500f);
-    make_specs.emplace_back("coolpixs3000", 6.1600f);
-    make_specs.emplace_back("coolpixs30", 4.8000f);
-    make_specs.emplace_back("coolpixs3100", 6.1600f);
-    make_specs.emplace_back("coolpixs31", 4.9600f);
-    make_specs.emplace_back("coolpixs3200", 6.1600f);
-    make_specs.emplace_back("coolpixs32", 4.8000f);
-    make_specs.emplace_back("coolpixs3300", 6.1600f);
-    make_specs.emplace_back("coolpixs33", 4.8000f);
-    make_specs.emplace_back("coolpixs3400", 6.1600f);
-    make_specs.emplace_back("coolpixs3500", 6.1600f);
-    make_specs.emplace_back("coolpixs3600", 6.1600f);
-    make_specs.emplace_back("coolpixs3700", 6.1600f);
-    make_specs.emplace_back("coolpixs3", 5.7500f);
-    make_specs.emplace_back("coolpixs4000", 6.1600f);
-    make_specs.emplace_back("coolpixs4100", 6.1600f);
-    make_specs.emplace_back("coolpixs4150", 6.1600f);
-    make_specs.emplace_back("coolpixs4200", 6.1600f);
-    make_specs.emplace_back("coolpixs4300", 6.1600f);
-    make_specs.emplace_back("coolpixs4400", 6.1600f);
-    make_specs.emplace_back("coolpixs4", 5.7500f);
-    make_specs.emplace_back("coolpixs500", 5.7500f);
-    make_specs.emplace_back("coolpixs50c", 5.7500f);
-    make_specs.emplace_back("coolpixs50", 5.7500f);
-    make_specs.emplace_back("coolpixs5100", 6.1600f);
-    make_specs.emplace_back("coolpixs510", 5.7500f);
-    make_specs.emplace_back("coolpixs51c", 5.7500f);
-    make_specs.emplace_back("coolpixs51", 5.7500f);
-    make_specs.emplace_back("coolpixs5200", 6.1600f);
-    make_specs.emplace_back("coolpixs520", 5.7500f);
-    make_specs.emplace_back("coolpixs52c", 5.7500f);
-    make_specs.emplace_back("coolpixs52", 5.7500f);
-    make_specs.emplace_back("coolpixs5300", 6.1600f);
-    make_specs.emplace_back("coolpixs550", 6.1600f);
-    make_specs.emplace_back("coolpixs560", 6.0800f);
-    make_specs.emplace_back("coolpixs570", 6.1600f);
-    make_specs.emplace_back("coolpixs5", 5.7500f);
-    make_specs.emplace_back("coolpixs6000", 6.1600f);
-    make_specs.emplace_back("coolpixs600", 6.0800f);
-    make_specs.emplace_back("coolpixs60", 6.1600f);
-    make_specs.emplace_back("coolpixs6100", 6.1600f);
-    make_specs.emplace_back("coolpixs610c", 6.0800f);
-    make_specs.emplace_back("coolpixs610", 6.0800f);
-    make_specs.emplace_back("coolpixs6150", 6.1600f);
-    make_specs.emplace_back("coolpixs6200", 6.1600f);
-    make_specs.emplace_back("coolpixs620", 6.0800f);
-    make_specs.emplace_back("coolpixs6300", 6.1600f);
-    make_specs.emplace_back("coolpixs630", 6.0800f);
-    make_specs.emplace_back("coolpixs6400", 6.1600f);
-    make_specs.emplace_back("coolpixs640", 6.0800f);
-    make_specs.emplace_back("coolpixs6500", 6.1600f);
-    make_specs.emplace_back("coolpixs6600", 6.1600f);
-    make_specs.emplace_back("coolpixs6700", 6.1600f);
-    make_specs.emplace_back("coolpixs6800", 6.1600f);
-    make_specs.emplace_back("coolpixs6900", 6.1600f);
-    make_specs.emplace_back("coolpixs6", 5.7500f);
-    make_specs.emplace_back("coolpixs7000", 6.1600f);
-    make_specs.emplace_back("coolpixs700", 7.4400f);
-    make_specs.emplace_back("coolpixs70", 6.1600f);
-    make_specs.emplace_back("coolpixs710", 7.4400f);
-    make_specs.emplace_back("coolpixs7c", 5.7500f);
-    make_specs.emplace_back("coolpixs8000", 6.1600f);
-    make_specs.emplace_back("coolpixs800c", 6.1600f);
-    make_specs.emplace_back("coolpixs80", 6.1600f);
-    make_specs.emplace_back("coolpixs8100", 6.1600f);
-    make_specs.emplace_back("coolpixs810c", 6.1600f);
-    make_specs.emplace_back("coolpixs8200", 6.1600f);
-    make_specs.emplace_back("coolpixs9050", 6.1600f);
-    make_specs.emplace_back("coolpixs9100", 6.1600f);
-    make_specs.emplace_back("coolpixs9200", 6.1600f);
-    make_specs.emplace_back("coolpixs9300", 6.1600f);
-    make_specs.emplace_back("coolpixs9400", 6.1600f);
-    make_specs.emplace_back("coolpixs9500", 6.1600f);
-    make_specs.emplace_back("coolpixs9600", 6.1600f);
-    make_specs.emplace_back("coolpixs9700", 6.1600f);
-    make_specs.emplace_back("coolpixs9900", 6.1600f);
-    make_specs.emplace_back("coolpixs9", 5.7500f);
-    make_specs.emplace_back("coolpixsq", 5.3300f);
-    make_specs.emplace_back("d100", 23.7000f);
-    make_specs.emplace_back("d1h", 23.7000f);
-    make_specs.emplace_back("d1x", 23.7000f);
-    make_specs.emplace_back("d1", 23.7000f);
-    make_specs.emplace_back("d200", 23.6000f);
-    make_specs.emplace_back("d2hs", 23.2000f);
-    make_specs.emplace_back("d2h", 23.7000f);
-    make_specs.emplace_back("d2xs", 23.7000f);
-    make_specs.emplace_back("d2x", 23.7000f);
-    make_specs.emplace_back("d3000", 23.6000f);
-    make_specs.emplace_back("d300s", 23.6000f);
-    make_specs.emplace_back("d300", 23.6000f);
-    make_specs.emplace_back("d3100", 23.1000f);
-    make_specs.emplace_back("d3200", 23.2000f);
-    make_specs.emplace_back("d3300", 23.5000f);
-    make_specs.emplace_back("d3s", 36.0000f);
-    make_specs.emplace_back("d3x", 35.9000f);
-    make_specs.emplace_back("d3", 36.0000f);
-    make_specs.emplace_back("d40x", 23.6000f);
-    make_specs.emplace_back("d40", 23.7000f);
-    make_specs.emplace_back("d4s", 36.0000f);
-    make_specs.emplace_back("d4", 36.0000f);
-    make_specs.emplace_back("d5000", 23.6000f);
-    make_specs.emplace_back("d50", 23.7000f);
-    make_specs.emplace_back("d5100", 23.6000f);
-    make_specs.emplace_back("d5200", 23.5000f);
-    make_specs.emplace_back("d5300", 23.5000f);
-    make_specs.emplace_back("d5500", 23.5000f);
-    make_specs.emplace_back("d600", 35.9000f);
-    make_specs.emplace_back("d60", 23.6000f);
-    make_specs.emplace_back("d610", 35.9000f);
-    make_specs.emplace_back("d7000", 23.6000f);
-    make_specs.emplace_back("d700", 36.0000f);
-    make_specs.emplace_back("d70s", 23.7000f);
-    make_specs.emplace_back("d70", 23.7000f);
-    make_specs.emplace_back("d7100", 23.5000f);
-    make_specs.emplace_back("d7200", 23.5000f);
-    make_specs.emplace_back("d750", 35.9000f);
-    make_specs.emplace_back("d800e", 35.9000f);
-    make_specs.emplace_back("d800", 35.9000f);
-    make_specs.emplace_back("d80", 23.6000f);
-    make_specs.emplace_back("d810", 35.9000f);
-    make_specs.emplace_back("d90", 23.6000f);
-    make_specs.emplace_back("df", 36.0000f);
-    make_specs.emplace_back("e2ns", 8.8000f);
-    make_specs.emplace_back("e2n", 8.8000f);
-    make_specs.emplace_back("e2s", 8.8000f);
-    make_specs.emplace_back("e3s", 8.8000f);
-    make_specs.emplace_back("e3", 8.8000f);
-  }
+constexpr CameraModelSpecs kNokiaModels[] = {
+    {"808pureview", 10.8200f},
+    {"lumia1020", 8.6400f},
+};
 
-  {
-    auto& make_specs = specs["nokia"];
-    make_specs.reserve(2);
-    make_specs.emplace_back("808pureview", 10.8200f);
-    make_specs.emplace_back("lumia1020", 8.6400f);
-  }
+constexpr CameraModelSpecs kOlympusModels[] = {
+    {"aira01", 17.3000f},
+    {"az1ferrari2004", 5.3300f},
+    {"az1", 5.3300f},
+    {"az2zoom", 5.3300f},
+    {"c1zoom", 4.5000f},
+    {"c1000l", 6.4000f},
+    {"c100", 4.5000f},
+    {"c120", 4.5000f},
+    {"c1400l", 8.8000f},
+    {"c1400xl", 8.8000f},
+    {"c150", 4.5000f},
+    {"c160", 5.3300f},
+    {"c170", 5.7500f},
+    {"c180", 5.7500f},
+    {"c1", 4.5000f},
+    {"c200zoom", 5.3300f},
+    {"c2000zoom", 6.4000f},
+    {"c2020zoom", 6.4000f},
+    {"c2040zoom", 6.4000f},
+    {"c2100uz", 6.4000f},
+    {"c21", 6.4000f},
+    {"c220zoom", 4.5000f},
+    {"c2500l", 8.8000f},
+    {"c2", 5.3300f},
+    {"c300zoom", 5.7500f},
+    {"c3000zoom", 7.1100f},
+    {"c3020zoom", 7.1100f},
+    {"c3030zoom", 7.1100f},
+    {"c3040zoom", 7.1100f},
+    {"c310zoom", 5.3300f},
+    {"c315zoom", 5.7500f},
+    {"c350zoom", 5.7500f},
+    {"c360zoom", 5.7500f},
+    {"c370zoom", 5.3300f},
+    {"c40zoom", 7.1100f},
+    {"c4000zoom", 7.1100f},
+    {"c4040zoom", 7.1100f},
+    {"c450zoom", 5.7500f},
+    {"c460zoomdelsol", 5.7500f},
+    {"c470zoom", 5.7500f},
+    {"c480zoom", 5.7500f},
+    {"c50zoom", 7.1100f},
+    {"c5000zoom", 7.2700f},
+    {"c5050zoom", 7.1100f},
+    {"c5060widezoom", 7.1100f},
+    {"c55zoom", 7.1100f},
+    {"c5500sportzoom", 7.1100f},
+    {"c60zoom", 7.2700f},
+    {"c70zoom", 7.1100f},
+    {"c700uz", 5.3300f},
+    {"c7000zoom", 7.1100f},
+    {"c7070widezoom", 7.1100f},
+    {"c720uz", 5.7500f},
+    {"c730uz", 5.3300f},
+    {"c740uz", 5.7500f},
+    {"c750uz", 5.3300f},
+    {"c760uz", 5.3300f},
+    {"c765uz", 5.7500f},
+    {"c770uz", 5.7500f},
+    {"c8080widezoom", 8.8000f},
+    {"c820l", 4.8000f},
+    {"c840l", 5.3300f},
+    {"c860l", 5.3300f},
+    {"c900zoom", 5.3300f},
+    {"c920zoom", 5.3300f},
+    {"c960zoom", 5.3300f},
+    {"c990zoom", 5.3300f},
+    {"d150z", 4.5000f},
+    {"d200l", 8.8000f},
+    {"d300l", 8.8000f},
+    {"d340l", 8.8000f},
+    {"d340r", 6.4000f},
+    {"d360l", 7.1100f},
+    {"d370", 4.5000f},
+    {"d380", 4.5000f},
+    {"d390", 4.5000f},
+    {"d395", 5.3300f},
+    {"d40zoom", 7.1100f},
+    {"d400zoom", 6.4000f},
+    {"d425", 5.7500f},
+    {"d435", 5.7500f},
+    {"d450zoom", 5.3300f},
+    {"d460zoom", 7.1100f},
+    {"d490zoom", 5.3300f},
+    {"d500l", 8.8000f},
+    {"d510zoom", 5.3300f},
+    {"d520zoom", 4.5000f},
+    {"d535zoom", 5.3300f},
+    {"d540zoom", 5.3300f},
+    {"d545zoom", 5.7500f},
+    {"d560zoom", 5.7500f},
+    {"d580zoom", 5.3300f},
+    {"d595zoom", 5.7500f},
+    {"d600l", 8.8000f},
+    {"d620l", 8.8000f},
+    {"d630zoom", 5.7500f},
+    {"e100rs", 6.4000f},
+    {"e10", 8.8000f},
+    {"e1", 17.3000f},
+    {"e20", 8.8000f},
+    {"e30", 17.3000f},
+    {"e3", 17.3000f},
+    {"e400", 17.3000f},
+    {"e410/evolte410", 17.3000f},
+    {"e420", 17.3000f},
+    {"e450", 17.3000f},
+    {"e510/evolte510", 17.3000f},
+    {"e520", 17.3000f},
+    {"e5", 17.3000f},
+    {"e600", 17.3000f},
+    {"e620", 17.3000f},
+    {"e300/evolte300", 17.3000f},
+    {"e500/evolte500", 17.3000f},
+    {"fe100", 5.7500f},
+    {"fe110", 5.7500f},
+    {"fe115", 5.7500f},
+    {"fe120", 5.7500f},
+    {"fe130", 5.7500f},
+    {"fe140", 5.7500f},
+    {"fe150", 5.7500f},
+    {"fe160", 5.7500f},
+    {"fe170", 5.7500f},
+    {"fe180", 5.7500f},
+    {"fe190", 5.7500f},
+    {"fe200", 5.7500f},
+    {"fe20", 6.0300f},
+    {"fe210", 5.7500f},
+    {"fe220", 5.7500f},
+    {"fe230", 5.7500f},
+    {"fe240", 5.7500f},
+    {"fe250", 7.1100f},
+    {"fe25", 6.0800f},
+    {"fe26", 6.0800f},
+    {"fe270", 5.7500f},
+    {"fe280", 6.1600f},
+    {"fe290", 5.7500f},
+    {"fe3000", 6.0800f},
+    {"fe300", 7.4400f},
+    {"fe3010", 6.0800f},
+    {"fe310", 5.7500f},
+    {"fe340", 6.0300f},
+    {"fe350", 5.7500f},
+    {"fe360", 6.0300f},
+    {"fe370", 6.0300f},
+    {"fe4000", 6.1600f},
+    {"fe4010", 6.1600f},
+    {"fe4020", 6.1600f},
+    {"fe4030", 6.0800f},
+    {"fe4040", 6.0800f},
+    {"fe4050", 6.1600f},
+    {"fe45", 6.0800f},
+    {"fe47", 6.0800f},
+    {"fe48", 6.1600f},
+    {"fe5000", 6.0800f},
+    {"fe5010", 6.0800f},
+    {"fe5020", 6.1600f},
+    {"fe5030", 6.0800f},
+    {"fe5035", 6.0800f},
+    {"fe5040", 6.1600f},
+    {"fe5050", 6.1600f},
+    {"ir300", 5.7500f},
+    {"ir500", 5.3300f},
+    {"m:robemr500i", 3.2000f},
+    {"mju1060", 6.0800f},
+    {"mju400digitalferrari", 5.7500f},
+    {"mju5000", 6.0800f},
+    {"mju7050", 6.1600f},
+    {"mju800black", 7.1100f},
+    {"mjuminidigitals", 5.7500f},
+    {"mjuminidigital", 5.7500f},
+    {"omdem10ii", 17.3000f},
+    {"omdem10", 17.3000f},
+    {"omdem1", 17.3000f},
+    {"omdem5markii", 17.3000f},
+    {"omdem5", 17.3000f},
+    {"penep1", 17.3000f},
+    {"penep2", 17.3000f},
+    {"penep3", 17.3000f},
+    {"penep5", 17.3000f},
+    {"penepl1s", 17.3000f},
+    {"penepl1", 17.3000f},
+    {"penepl2", 17.3000f},
+    {"penepl3", 17.3000f},
+    {"penepl5", 17.3000f},
+    {"penepl6", 17.3000f},
+    {"penepl7", 17.3000f},
+    {"penepm1", 17.3000f},
+    {"penepm2", 17.3000f},
+    {"sh21", 6.1600f},
+    {"sh25mr", 6.1600f},
+    {"sh50ihs", 6.1600f},
+    {"sp100", 6.1600f},
+    {"sp310", 7.1100f},
+    {"sp320", 7.1100f},
+    {"sp350", 7.1100f},
+    {"sp500uz", 5.7500f},
+    {"sp510uz", 5.7500f},
+    {"sp550uz", 5.7500f},
+    {"sp560uz", 6.1600f},
+    {"sp565uz", 6.0800f},
+    {"sp570uz", 6.0800f},
+    {"sp590uz", 6.0800f},
+    {"sp600uz", 6.0800f},
+    {"sp610uz", 6.1600f},
+    {"sp620uz", 6.1600f},
+    {"sp700", 5.7500f},
+    {"sp720uz", 6.1600f},
+    {"sp800uz", 6.0800f},
+    {"sp810uz", 6.1600f},
+    {"stylus1000", 7.1100f},
+    {"stylus1010", 6.0800f},
+    {"stylus1020", 6.0800f},
+    {"stylus1030sw", 6.0800f},
+    {"stylus1040", 6.0800f},
+    {"stylus1050sw", 6.0800f},
+    {"stylus1200", 7.4400f},
+    {"stylus1s", 7.5300f},
+    {"stylus1", 7.5300f},
+    {"stylus300", 5.7500f},
+    {"stylus400", 5.7500f},
+    {"stylus410", 5.7500f},
+    {"stylus500", 5.7500f},
+    {"stylus5010", 6.0800f},
+    {"stylus550wp", 6.0800f},
+    {"stylus600", 5.7500f},
+    {"stylus7000", 6.0800f},
+    {"stylus700", 6.1600f},
+    {"stylus7010", 6.0800f},
+    {"stylus7030", 6.0800f},
+    {"stylus7040", 6.0800f},
+    {"stylus720sw", 6.1600f},
+    {"stylus725sw", 6.1600f},
+    {"stylus730", 6.1600f},
+    {"stylus740", 6.1600f},
+    {"stylus750", 6.1600f},
+    {"stylus760", 6.1600f},
+    {"stylus770sw", 6.1600f},
+    {"stylus780", 6.1600f},
+    {"stylus790sw", 6.1600f},
+    {"stylus800", 7.1100f},
+    {"stylus810", 7.1100f},
+    {"stylus820", 6.1600f},
+    {"stylus830", 6.1600f},
+    {"stylus840", 6.0300f},
+    {"stylus850sw", 6.0300f},
+    {"stylus9000", 6.0800f},
+    {"stylus9010", 6.0800f},
+    {"stylussh1", 6.1600f},
+    {"stylussh2", 6.1600f},
+    {"stylussp820uz", 6.1600f},
+    {"stylustough3000", 6.0800f},
+    {"stylustough6000", 6.1600f},
+    {"stylustough6010", 6.1600f},
+    {"stylustough6020", 6.0800f},
+    {"stylustough8000", 6.0800f},
+    {"stylustough8010", 6.0800f},
+    {"stylusverves", 5.7500f},
+    {"stylusverve", 5.7500f},
+    {"stylusxz10", 6.1600f},
+    {"sz10", 6.1600f},
+    {"sz11", 6.1600f},
+    {"sz12", 6.1600f},
+    {"sz14", 6.1600f},
+    {"sz15", 6.1600f},
+    {"sz16", 6.1600f},
+    {"sz20", 6.1600f},
+    {"sz30mr", 6.1600f},
+    {"sz31mrihs", 6.1600f},
+    {"t100", 6.1600f},
+    {"t10", 6.1600f},
+    {"t110", 6.1600f},
+    {"tg310", 6.1600f},
+    {"tg320", 6.1600f},
+    {"tg610", 6.1600f},
+    {"tg630ihs", 6.1600f},
+    {"tg810", 6.1600f},
+    {"tg820ihs", 6.1600f},
+    {"tg830ihs", 6.1600f},
+    {"tg850ihs", 6.1600f},
+    {"toughtg1ihs", 6.1600f},
+    {"toughtg2ihs", 6.1600f},
+    {"toughtg3", 6.1600f},
+    {"toughtg4", 6.1600f},
+    {"toughtg620", 6.1600f},
+    {"toughtg860", 6.1600f},
+    {"vg110", 6.1600f},
+    {"vg120", 6.1600f},
+    {"vg130", 6.1600f},
+    {"vg145", 6.1600f},
+    {"vg150", 6.1600f},
+    {"vg160", 6.1600f},
+    {"vg165", 6.1600f},
+    {"vg170", 6.1600f},
+    {"vg180", 6.1600f},
+    {"vg190", 6.1600f},
+    {"vh210", 6.1600f},
+    {"vh410", 6.1600f},
+    {"vh510", 6.1600f},
+    {"vh515", 6.1600f},
+    {"vh520", 6.1600f},
+    {"vr310", 6.1600f},
+    {"vr320", 6.1600f},
+    {"vr330", 6.1600f},
+    {"vr340", 6.1600f},
+    {"vr350", 6.1600f},
+    {"vr360", 6.1600f},
+    {"vr370", 6.1600f},
+    {"x15", 6.0300f},
+    {"x775", 5.7500f},
+    {"x785", 5.7500f},
+    {"x905", 6.1600f},
+    {"x920", 6.1600f},
+    {"xz1", 7.8500f},
+    {"xz2ihs", 7.5300f},
+};
 
-  {
-    auto& make_specs = specs["olympus"];
-    make_specs.reserve(314);
-    make_specs.emplace_back("aira01", 17.3000f);
-    make_specs.emplace_back("az1ferrari2004", 5.3300f);
-    make_specs.emplace_back("az1", 5.3300f);
-    make_specs.emplace_back("az2zoom", 5.3300f);
-    make_specs.emplace_back("c1zoom", 4.5000f);
-    make_specs.emplace_back("c1000l", 6.4000f);
-    make_specs.emplace_back("c100", 4.5000f);
-    make_specs.emplace_back("c120", 4.5000f);
-    make_specs.emplace_back("c1400l", 8.8000f);
-    make_specs.emplace_back("c1400xl", 8.8000f);
-    make_specs.emplace_back("c150", 4.5000f);
-    make_specs.emplace_back("c160", 5.3300f);
-    make_specs.emplace_back("c170", 5.7500f);
-    make_specs.emplace_back("c180", 5.7500f);
-    make_specs.emplace_back("c1", 4.5000f);
-    make_specs.emplace_back("c200zoom", 5.3300f);
-    make_specs.emplace_back("c2000zoom", 6.4000f);
-    make_specs.emplace_back("c2020zoom", 6.4000f);
-    make_specs.emplace_back("c2040zoom", 6.4000f);
-    make_specs.emplace_back("c2100uz", 6.4000f);
-    make_specs.emplace_back("c21", 6.4000f);
-    make_specs.emplace_back("c220zoom", 4.5000f);
-    make_specs.emplace_back("c2500l", 8.8000f);
-    make_specs.emplace_back("c2", 5.3300f);
-    make_specs.emplace_back("c300zoom", 5.7500f);
-    make_specs.emplace_back("c3000zoom", 7.1100f);
-    make_specs.emplace_back("c3020zoom", 7.1100f);
-    make_specs.emplace_back("c3030zoom", 7.1100f);
-    make_specs.emplace_back("c3040zoom", 7.1100f);
-    make_specs.emplace_back("c310zoom", 5.3300f);
-    make_specs.emplace_back("c315zoom", 5.7500f);
-    make_specs.emplace_back("c350zoom", 5.7500f);
-    make_specs.emplace_back("c360zoom", 5.7500f);
-    make_specs.emplace_back("c370zoom", 5.3300f);
-    make_specs.emplace_back("c40zoom", 7.1100f);
-    make_specs.emplace_back("c4000zoom", 7.1100f);
-    make_specs.emplace_back("c4040zoom", 7.1100f);
-    make_specs.emplace_back("c450zoom", 5.7500f);
-    make_specs.emplace_back("c460zoomdelsol", 5.7500f);
-    make_specs.emplace_back("c470zoom", 5.7500f);
-    make_specs.emplace_back("c480zoom", 5.7500f);
-    make_specs.emplace_back("c50zoom", 7.1100f);
-    make_specs.emplace_back("c5000zoom", 7.2700f);
-    make_specs.emplace_back("c5050zoom", 7.1100f);
-    make_specs.emplace_back("c5060widezoom", 7.1100f);
-    make_specs.emplace_back("c55zoom", 7.1100f);
-    make_specs.emplace_back("c5500sportzoom", 7.1100f);
-    make_specs.emplace_back("c60zoom", 7.2700f);
-    make_specs.emplace_back("c70zoom", 7.1100f);
-    make_specs.emplace_back("c700uz", 5.3300f);
-    make_specs.emplace_back("c7000zoom", 7.1100f);
-    make_specs.emplace_back("c7070widezoom", 7.1100f);
-    make_specs.emplace_back("c720uz", 5.7500f);
-    make_specs.emplace_back("c730uz", 5.3300f);
-    make_specs.emplace_back("c740uz", 5.7500f);
-    make_specs.emplace_back("c750uz", 5.3300f);
-    make_specs.emplace_back("c760uz", 5.3300f);
-    make_specs.emplace_back("c765uz", 5.7500f);
-    make_specs.emplace_back("c770uz", 5.7500f);
-    make_specs.emplace_back("c8080widezoom", 8.8000f);
-    make_specs.emplace_back("c820l", 4.8000f);
-    make_specs.emplace_back("c840l", 5.3300f);
-    make_specs.emplace_back("c860l", 5.3300f);
-    make_specs.emplace_back("c900zoom", 5.3300f);
-    make_specs.emplace_back("c920zoom", 5.3300f);
-    make_specs.emplace_back("c960zoom", 5.3300f);
-    make_specs.emplace_back("c990zoom", 5.3300f);
-    make_specs.emplace_back("d150z", 4.5000f);
-    make_specs.emplace_back("d200l", 8.8000f);
-    make_specs.emplace_back("d300l", 8.8000f);
-    make_specs.emplace_back("d340l", 8.8000f);
-    make_specs.emplace_back("d340r", 6.4000f);
-    make_specs.emplace_back("d360l", 7.1100f);
-    make_specs.emplace_back("d370", 4.5000f);
-    make_specs.emplace_back("d380", 4.5000f);
-    make_specs.emplace_back("d390", 4.5000f);
-    make_specs.emplace_back("d395", 5.3300f);
-    make_specs.emplace_back("d40zoom", 7.1100f);
-    make_specs.emplace_back("d400zoom", 6.4000f);
-    make_specs.emplace_back("d425", 5.7500f);
-    make_specs.emplace_back("d435", 5.7500f);
-    make_specs.emplace_back("d450zoom", 5.3300f);
-    make_specs.emplace_back("d460zoom", 7.1100f);
-    make_specs.emplace_back("d490zoom", 5.3300f);
-    make_specs.emplace_back("d500l", 8.8000f);
-    make_specs.emplace_back("d510zoom", 5.3300f);
-    make_specs.emplace_back("d520zoom", 4.5000f);
-    make_specs.emplace_back("d535zoom", 5.3300f);
-    make_specs.emplace_back("d540zoom", 5.3300f);
-    make_specs.emplace_back("d545zoom", 5.7500f);
-    make_specs.emplace_back("d560zoom", 5.7500f);
-    make_specs.emplace_back("d580zoom", 5.3300f);
-    make_specs.emplace_back("d595zoom", 5.7500f);
-    make_specs.emplace_back("d600l", 8.8000f);
-    make_specs.emplace_back("d620l", 8.8000f);
-    make_specs.emplace_back("d630zoom", 5.7500f);
-    make_specs.emplace_back("e100rs", 6.4000f);
-    make_specs.emplace_back("e10", 8.8000f);
-    make_specs.emplace_back("e1", 17.3000f);
-    make_specs.emplace_back("e20", 8.8000f);
-    make_specs.emplace_back("e30", 17.3000f);
-    make_specs.emplace_back("e3", 17.3000f);
-    make_specs.emplace_back("e400", 17.3000f);
-    make_specs.emplace_back("e410/evolte410", 17.3000f);
-    make_specs.emplace_back("e420", 17.3000f);
-    make_specs.emplace_back("e450", 17.3000f);
-    make_specs.emplace_back("e510/evolte510", 17.3000f);
-    make_specs.emplace_back("e520", 17.3000f);
-    make_specs.emplace_back("e5", 17.3000f);
-    make_specs.emplace_back("e600", 17.3000f);
-    make_specs.emplace_back("e620", 17.3000f);
-    make_specs.emplace_back("e300/evolte300", 17.3000f);
-    make_specs.emplace_back("e500/evolte500", 17.3000f);
-    make_specs.emplace_back("fe100", 5.7500f);
-    make_specs.emplace_back("fe110", 5.7500f);
-    make_specs.emplace_back("fe115", 5.7500f);
-    make_specs.emplace_back("fe120", 5.7500f);
-    make_specs.emplace_back("fe130", 5.7500f);
-    make_specs.emplace_back("fe140", 5.7500f);
-    make_specs.emplace_back("fe150", 5.7500f);
-    make_specs.emplace_back("fe160", 5.7500f);
-    make_specs.emplace_back("fe170", 5.7500f);
-    make_specs.emplace_back("fe180", 5.7500f);
-    make_specs.emplace_back("fe190", 5.7500f);
-    make_specs.emplace_back("fe200", 5.7500f);
-    make_specs.emplace_back("fe20", 6.0300f);
-    make_specs.emplace_back("fe210", 5.7500f);
-    make_specs.emplace_back("fe220", 5.7500f);
-    make_specs.emplace_back("fe230", 5.7500f);
-    make_specs.emplace_back("fe240", 5.7500f);
-    make_specs.emplace_back("fe250", 7.1100f);
-    make_specs.emplace_back("fe25", 6.0800f);
-    make_specs.emplace_back("fe26", 6.0800f);
-    make_specs.emplace_back("fe270", 5.7500f);
-    make_specs.emplace_back("fe280", 6.1600f);
-    make_specs.emplace_back("fe290", 5.7500f);
-    make_specs.emplace_back("fe3000", 6.0800f);
-    make_specs.emplace_back("fe300", 7.4400f);
-    make_specs.emplace_back("fe3010", 6.0800f);
-    make_specs.emplace_back("fe310", 5.7500f);
-    make_specs.emplace_back("fe340", 6.0300f);
-    make_specs.emplace_back("fe350", 5.7500f);
-    make_specs.emplace_back("fe360", 6.0300f);
-    make_specs.emplace_back("fe370", 6.0300f);
-    make_specs.emplace_back("fe4000", 6.1600f);
-    make_specs.emplace_back("fe4010", 6.1600f);
-    make_specs.emplace_back("fe4020", 6.1600f);
-    make_specs.emplace_back("fe4030", 6.0800f);
-    make_specs.emplace_back("fe4040", 6.0800f);
-    make_specs.emplace_back("fe4050", 6.1600f);
-    make_specs.emplace_back("fe45", 6.0800f);
-    make_specs.emplace_back("fe47", 6.0800f);
-    make_specs.emplace_back("fe48", 6.1600f);
-    make_specs.emplace_back("fe5000", 6.0800f);
-    make_specs.emplace_back("fe5010", 6.0800f);
-    make_specs.emplace_back("fe5020", 6.1600f);
-    make_specs.emplace_back("fe5030", 6.0800f);
-    make_specs.emplace_back("fe5035", 6.0800f);
-    make_specs.emplace_back("fe5040", 6.1600f);
-    make_specs.emplace_back("fe5050", 6.1600f);
-    make_specs.emplace_back("ir300", 5.7500f);
-    make_specs.emplace_back("ir500", 5.3300f);
-    make_specs.emplace_back("m:robemr500i", 3.2000f);
-    make_specs.emplace_back("mju1060", 6.0800f);
-    make_specs.emplace_back("mju400digitalferrari", 5.7500f);
-    make_specs.emplace_back("mju5000", 6.0800f);
-    make_specs.emplace_back("mju7050", 6.1600f);
-    make_specs.emplace_back("mju800black", 7.1100f);
-    make_specs.emplace_back("mjuminidigitals", 5.7500f);
-    make_specs.emplace_back("mjuminidigital", 5.7500f);
-    make_specs.emplace_back("omdem10ii", 17.3000f);
-    make_specs.emplace_back("omdem10", 17.3000f);
-    make_specs.emplace_back("omdem1", 17.3000f);
-    make_specs.emplace_back("omdem5markii", 17.3000f);
-    make_specs.emplace_back("omdem5", 17.3000f);
-    make_specs.emplace_back("penep1", 17.3000f);
-    make_specs.emplace_back("penep2", 17.3000f);
-    make_specs.emplace_back("penep3", 17.3000f);
-    make_specs.emplace_back("penep5", 17.3000f);
-    make_specs.emplace_back("penepl1s", 17.3000f);
-    make_specs.emplace_back("penepl1", 17.3000f);
-    make_specs.emplace_back("penepl2", 17.3000f);
-    make_specs.emplace_back("penepl3", 17.3000f);
-    make_specs.emplace_back("penepl5", 17.3000f);
-    make_specs.emplace_back("penepl6", 17.3000f);
-    make_specs.emplace_back("penepl7", 17.3000f);
-    make_specs.emplace_back("penepm1", 17.3000f);
-    make_specs.emplace_back("penepm2", 17.3000f);
-    make_specs.emplace_back("sh21", 6.1600f);
-    make_specs.emplace_back("sh25mr", 6.1600f);
-    make_specs.emplace_back("sh50ihs", 6.1600f);
-    make_specs.emplace_back("sp100", 6.1600f);
-    make_specs.emplace_back("sp310", 7.1100f);
-    make_specs.emplace_back("sp320", 7.1100f);
-    make_specs.emplace_back("sp350", 7.1100f);
-    make_specs.emplace_back("sp500uz", 5.7500f);
-    make_specs.emplace_back("sp510uz", 5.7500f);
-    make_specs.emplace_back("sp550uz", 5.7500f);
-    make_specs.emplace_back("sp560uz", 6.1600f);
-    make_specs.emplace_back("sp565uz", 6.0800f);
-    make_specs.emplace_back("sp570uz", 6.0800f);
-    make_specs.emplace_back("sp590uz", 6.0800f);
-    make_specs.emplace_back("sp600uz", 6.0800f);
-    make_specs.emplace_back("sp610uz", 6.1600f);
-    make_specs.emplace_back("sp620uz", 6.1600f);
-    make_specs.emplace_back("sp700", 5.7500f);
-    make_specs.emplace_back("sp720uz", 6.1600f);
-    make_specs.emplace_back("sp800uz", 6.0800f);
-    make_specs.emplace_back("sp810uz", 6.1600f);
-    make_specs.emplace_back("stylus1000", 7.1100f);
-    make_specs.emplace_back("stylus1010", 6.0800f);
-    make_specs.emplace_back("stylus1020", 6.0800f);
-    make_specs.emplace_back("stylus1030sw", 6.0800f);
-    make_specs.emplace_back("stylus1040", 6.0800f);
-    make_specs.emplace_back("stylus1050sw", 6.0800f);
-    make_specs.emplace_back("stylus1200", 7.4400f);
-    make_specs.emplace_back("stylus1s", 7.5300f);
-    make_specs.emplace_back("stylus1", 7.5300f);
-    make_specs.emplace_back("stylus300", 5.7500f);
-    make_specs.emplace_back("stylus400", 5.7500f);
-    make_specs.emplace_back("stylus410", 5.7500f);
-    make_specs.emplace_back("stylus500", 5.7500f);
-    make_specs.emplace_back("stylus5010", 6.0800f);
-    make_specs.emplace_back("stylus550wp", 6.0800f);
-    make_specs.emplace_back("stylus600", 5.7500f);
-    make_specs.emplace_back("stylus7000", 6.0800f);
-    make_specs.emplace_back("stylus700", 6.1600f);
-    make_specs.emplace_back("stylus7010", 6.0800f);
-    make_specs.emplace_back("stylus7030", 6.0800f);
-    make_specs.emplace_back("stylus7040", 6.0800f);
-    make_specs.emplace_back("stylus720sw", 6.1600f);
-    make_specs.emplace_back("stylus725sw", 6.1600f);
-    make_specs.emplace_back("stylus730", 6.1600f);
-    make_specs.emplace_back("stylus740", 6.1600f);
-    make_specs.emplace_back("stylus750", 6.1600f);
-    make_specs.emplace_back("stylus760", 6.1600f);
-    make_specs.emplace_back("stylus770sw", 6.1600f);
-    make_specs.emplace_back("stylus780", 6.1600f);
-    make_specs.emplace_back("stylus790sw", 6.1600f);
-    make_specs.emplace_back("stylus800", 7.1100f);
-    make_specs.emplace_back("stylus810", 7.1100f);
-    make_specs.emplace_back("stylus820", 6.1600f);
-    make_specs.emplace_back("stylus830", 6.1600f);
-    make_specs.emplace_back("stylus840", 6.0300f);
-    make_specs.emplace_back("stylus850sw", 6.0300f);
-    make_specs.emplace_back("stylus9000", 6.0800f);
-    make_specs.emplace_back("stylus9010", 6.0800f);
-    make_specs.emplace_back("stylussh1", 6.1600f);
-    make_specs.emplace_back("stylussh2", 6.1600f);
-    make_specs.emplace_back("stylussp820uz", 6.1600f);
-    make_specs.emplace_back("stylustough3000", 6.0800f);
-    make_specs.emplace_back("stylustough6000", 6.1600f);
-    make_specs.emplace_back("stylustough6010", 6.1600f);
-    make_specs.emplace_back("stylustough6020", 6.0800f);
-    make_specs.emplace_back("stylustough8000", 6.0800f);
-    make_specs.emplace_back("stylustough8010", 6.0800f);
-    make_specs.emplace_back("stylusverves", 5.7500f);
-    make_specs.emplace_back("stylusverve", 5.7500f);
-    make_specs.emplace_back("stylusxz10", 6.1600f);
-    make_specs.emplace_back("sz10", 6.1600f);
-    make_specs.emplace_back("sz11", 6.1600f);
-    make_specs.emplace_back("sz12", 6.1600f);
-    make_specs.emplace_back("sz14", 6.1600f);
-    make_specs.emplace_back("sz15", 6.1600f);
-    make_specs.emplace_back("sz16", 6.1600f);
-    make_specs.emplace_back("sz20", 6.1600f);
-    make_specs.emplace_back("sz30mr", 6.1600f);
-    make_specs.emplace_back("sz31mrihs", 6.1600f);
-    make_specs.emplace_back("t100", 6.1600f);
-    make_specs.emplace_back("t10", 6.1600f);
-    make_specs.emplace_back("t110", 6.1600f);
-    make_specs.emplace_back("tg310", 6.1600f);
-    make_specs.emplace_back("tg320", 6.1600f);
-    make_specs.emplace_back("tg610", 6.1600f);
-    make_specs.emplace_back("tg630ihs", 6.1600f);
-    make_specs.emplace_back("tg810", 6.1600f);
-    make_specs.emplace_back("tg820ihs", 6.1600f);
-    make_specs.emplace_back("tg830ihs", 6.1600f);
-    make_specs.emplace_back("tg850ihs", 6.1600f);
-    make_specs.emplace_back("toughtg1ihs", 6.1600f);
-    make_specs.emplace_back("toughtg2ihs", 6.1600f);
-    make_specs.emplace_back("toughtg3", 6.1600f);
-    make_specs.emplace_back("toughtg4", 6.1600f);
-    make_specs.emplace_back("toughtg620", 6.1600f);
-    make_specs.emplace_back("toughtg860", 6.1600f);
-    make_specs.emplace_back("vg110", 6.1600f);
-    make_specs.emplace_back("vg120", 6.1600f);
-    make_specs.emplace_back("vg130", 6.1600f);
-    make_specs.emplace_back("vg145", 6.1600f);
-    make_specs.emplace_back("vg150", 6.1600f);
-    make_specs.emplace_back("vg160", 6.1600f);
-    make_specs.emplace_back("vg165", 6.1600f);
-    make_specs.emplace_back("vg170", 6.1600f);
-    make_specs.emplace_back("vg180", 6.1600f);
-    make_specs.emplace_back("vg190", 6.1600f);
-    make_specs.emplace_back("vh210", 6.1600f);
-    make_specs.emplace_back("vh410", 6.1600f);
-    make_specs.emplace_back("vh510", 6.1600f);
-    make_specs.emplace_back("vh515", 6.1600f);
-    make_specs.emplace_back("vh520", 6.1600f);
-    make_specs.emplace_back("vr310", 6.1600f);
-    make_specs.emplace_back("vr320", 6.1600f);
-    make_specs.emplace_back("vr330", 6.1600f);
-    make_specs.emplace_back("vr340", 6.1600f);
-    make_specs.emplace_back("vr350", 6.1600f);
-    make_specs.emplace_back("vr360", 6.1600f);
-    make_specs.emplace_back("vr370", 6.1600f);
-    make_specs.emplace_back("x15", 6.0300f);
-    make_specs.emplace_back("x775", 5.7500f);
-    make_specs.emplace_back("x785", 5.7500f);
-    make_specs.emplace_back("x905", 6.1600f);
-    make_specs.emplace_back("x920", 6.1600f);
-    make_specs.emplace_back("xz1", 7.8500f);
-    make_specs.emplace_back("xz2ihs", 7.5300f);
-  }
+constexpr CameraModelSpecs kPanasonicModels[] = {
+    {"dsnapsvas10", 4.5000f},
+    {"dsnapsvas30", 4.5000f},
+    {"dsnapsvas3", 4.5000f},
+    {"lumixdmc3d1", 6.1600f},
+    {"lumixdmcf1", 5.7500f},
+    {"lumixdmcf3", 6.0800f},
+    {"lumixdmcf5", 6.0800f},
+    {"lumixdmcf7", 5.3300f},
+    {"lumixdmcfh10", 6.0800f},
+    {"lumixdmcfh1", 6.0800f},
+    {"lumixdmcfh20", 6.0800f},
+    {"lumixdmcfh22", 6.0800f},
+    {"lumixdmcfh25", 6.1600f},
+    {"lumixdmcfh27", 6.1600f},
+    {"lumixdmcfh2", 6.0800f},
+    {"lumixdmcfh3", 6.0800f},
+    {"lumixdmcfh4", 6.0800f},
+    {"lumixdmcfh5", 6.0800f},
+    {"lumixdmcfh6", 6.0800f},
+    {"lumixdmcfh7", 6.0800f},
+    {"lumixdmcfh8", 6.0800f},
+    {"lumixdmcfp1", 6.0800f},
+    {"lumixdmcfp2", 6.0800f},
+    {"lumixdmcfp3", 6.0800f},
+    {"lumixdmcfp5", 6.0800f},
+    {"lumixdmcfp7", 6.0800f},
+    {"lumixdmcfp8", 6.0800f},
+    {"lumixdmcfs10", 6.0800f},
+    {"lumixdmcfs11", 6.0800f},
+    {"lumixdmcfs12", 6.0800f},
+    {"lumixdmcfs15", 6.0800f},
+    {"lumixdmcfs16", 6.0800f},
+    {"lumixdmcfs18", 6.0800f},
+    {"lumixdmcfs20", 6.0800f},
+    {"lumixdmcfs22", 6.0800f},
+    {"lumixdmcfs25", 6.0800f},
+    {"lumixdmcfs28", 6.0800f},
+    {"lumixdmcfs2", 5.7500f},
+    {"lumixdmcfs30", 6.0800f},
+    {"lumixdmcfs33", 6.0800f},
+    {"lumixdmcfs35", 6.1600f},
+    {"lumixdmcfs37", 6.1600f},
+    {"lumixdmcfs3", 5.7500f},
+    {"lumixdmcfs40", 6.0800f},
+    {"lumixdmcfs42", 5.7500f},
+    {"lumixdmcfs45", 6.0800f},
+    {"lumixdmcfs5", 6.0800f},
+    {"lumixdmcfs62", 5.7500f},
+    {"lumixdmcfs6", 5.7500f},
+    {"lumixdmcfs7", 5.7500f},
+    {"lumixdmcft10", 6.0800f},
+    {"lumixdmcft1", 6.0800f},
+    {"lumixdmcft20", 6.0800f},
+    {"lumixdmcft2", 6.0800f},
+    {"lumixdmcft30", 6.0800f},
+    {"lumixdmcft3", 6.0800f},
+    {"lumixdmcft4", 6.0800f},
+    {"lumixdmcfx01", 5.7500f},
+    {"lumixdmcfx07", 5.7500f},
+    {"lumixdmcfx100", 7.4400f},
+    {"lumixdmcfx10", 5.7500f},
+    {"lumixdmcfx12", 5.7500f},
+    {"lumixdmcfx150", 7.4400f},
+    {"lumixdmcfx1", 5.7500f},
+    {"lumixdmcfx2", 5.7500f},
+    {"lumixdmcfx30", 5.7500f},
+    {"lumixdmcfx33", 5.7500f},
+    {"lumixdmcfx35", 6.0800f},
+    {"lumixdmcfx37", 6.0800f},
+    {"lumixdmcfx3", 5.7500f},
+    {"lumixdmcfx40", 6.0800f},
+    {"lumixdmcfx48", 6.0800f},
+    {"lumixdmcfx500", 6.0800f},
+    {"lumixdmcfx50", 5.7500f},
+    {"lumixdmcfx550", 6.0800f},
+    {"lumixdmcfx55", 5.7500f},
+    {"lumixdmcfx580", 6.0800f},
+    {"lumixdmcfx5", 5.7500f},
+    {"lumixdmcfx60", 6.0800f},
+    {"lumixdmcfx65", 6.0800f},
+    {"lumixdmcfx66", 6.0800f},
+    {"lumixdmcfx68", 6.0800f},
+    {"lumixdmcfx700", 6.0800f},
+    {"lumixdmcfx70", 6.0800f},
+    {"lumixdmcfx75", 6.0800f},
+    {"lumixdmcfx77", 6.0800f},
+    {"lumixdmcfx78", 6.0800f},
+    {"lumixdmcfx7", 5.7500f},
+    {"lumixdmcfx80", 6.0800f},
+    {"lumixdmcfx8", 5.7500f},
+    {"lumixdmcfx90", 6.0800f},
+    {"lumixdmcfx9", 5.7500f},
+    {"lumixdmcfz1000", 13.2000f},
+    {"lumixdmcfz100", 6.0800f},
+    {"lumixdmcfz10", 5.7500f},
+    {"lumixdmcfz150", 6.0800f},
+    {"lumixdmcfz15", 5.7500f},
+    {"lumixdmcfz18", 5.7500f},
+    {"lumixdmcfz1", 4.5000f},
+    {"lumixdmcfz200", 6.1600f},
+    {"lumixdmcfz20", 5.7500f},
+    {"lumixdmcfz28", 6.0800f},
+    {"lumixdmcfz2", 4.5000f},
+    {"lumixdmcfz300", 6.1600f},
+    {"lumixdmcfz30", 7.1100f},
+    {"lumixdmcfz35", 6.0800f},
+    {"lumixdmcfz38", 6.0800f},
+    {"lumixdmcfz3", 4.5000f},
+    {"lumixdmcfz40", 6.0800f},
+    {"lumixdmcfz45", 6.0800f},
+    {"lumixdmcfz47", 6.0800f},
+    {"lumixdmcfz48", 6.0800f},
+    {"lumixdmcfz4", 5.7500f},
+    {"lumixdmcfz50", 7.1100f},
+    {"lumixdmcfz5", 5.7500f},
+    {"lumixdmcfz60", 6.0800f},
+    {"lumixdmcfz70", 6.1600f},
+    {"lumixdmcfz7", 5.7500f},
+    {"lumixdmcfz8", 5.7500f},
+    {"lumixdmcg10", 17.3000f},
+    {"lumixdmcg1", 17.3000f},
+    {"lumixdmcg2", 17.3000f},
+    {"lumixdmcg3", 17.3000f},
+    {"lumixdmcg5", 17.3000f},
+    {"lumixdmcg6", 17.3000f},
+    {"lumixdmcg7", 17.3000f},
+    {"lumixdmcgf1", 17.3000f},
+    {"lumixdmcgf2", 17.3000f},
+    {"lumixdmcgf3", 17.3000f},
+    {"lumixdmcgf5", 17.3000f},
+    {"lumixdmcgf6", 17.3000f},
+    {"lumixdmcgf7", 17.3000f},
+    {"lumixdmcgh1", 17.3000f},
+    {"lumixdmcgh2", 17.3000f},
+    {"lumixdmcgh3", 17.3000f},
+    {"lumixdmcgh4", 17.3000f},
+    {"lumixdmcgm1", 17.3000f},
+    {"lumixdmcgm5", 17.3000f},
+    {"lumixdmcgx1", 17.3000f},
+    {"lumixdmcgx7", 17.3000f},
+    {"lumixdmcgx8", 17.3000f},
+    {"lumixdmcl10", 17.3000f},
+    {"lumixdmcl1", 17.3000f},
+    {"lumixdmclc1", 8.8000f},
+    {"lumixdmclc20", 5.3300f},
+    {"lumixdmclc33", 5.7500f},
+    {"lumixdmclc40", 7.5300f},
+    {"lumixdmclc43", 5.7500f},
+    {"lumixdmclc50", 5.7500f},
+    {"lumixdmclc5", 7.5300f},
+    {"lumixdmclc70", 5.7500f},
+    {"lumixdmclc80", 5.7500f},
+    {"lumixdmclf1", 7.5300f},
+    {"lumixdmcls1", 5.7500f},
+    {"lumixdmcls2", 5.7500f},
+    {"lumixdmcls3", 5.7500f},
+    {"lumixdmcls5", 6.0800f},
+    {"lumixdmcls60", 5.7500f},
+    {"lumixdmcls6", 6.0800f},
+    {"lumixdmcls75", 5.7500f},
+    {"lumixdmcls80", 5.7500f},
+    {"lumixdmcls85", 5.7500f},
+    {"lumixdmclx100", 17.3000f},
+    {"lumixdmclx1", 7.7600f},
+    {"lumixdmclx2", 7.7600f},
+    {"lumixdmclx3", 7.8500f},
+    {"lumixdmclx5", 7.8500f},
+    {"lumixdmclx7", 7.5300f},
+    {"lumixdmclz10", 6.0800f},
+    {"lumixdmclz1", 5.7500f},
+    {"lumixdmclz20", 6.0800f},
+    {"lumixdmclz2", 5.7500f},
+    {"lumixdmclz30", 6.1600f},
+    {"lumixdmclz3", 5.7500f},
+    {"lumixdmclz40", 6.1600f},
+    {"lumixdmclz5", 5.7500f},
+    {"lumixdmclz6", 5.7500f},
+    {"lumixdmclz7", 5.7500f},
+    {"lumixdmclz8", 5.7500f},
+    {"lumixdmcs1", 6.0800f},
+    {"lumixdmcs2", 6.0800f},
+    {"lumixdmcs3", 6.0800f},
+    {"lumixdmcs5", 6.0800f},
+    {"lumixdmcsz10", 6.0800f},
+    {"lumixdmcsz1", 6.0800f},
+    {"lumixdmcsz3", 6.0800f},
+    {"lumixdmcsz5", 6.0800f},
+    {"lumixdmcsz7", 6.0800f},
+    {"lumixdmcsz8", 6.0800f},
+    {"lumixdmcsz9", 6.0800f},
+    {"lumixdmcts10", 6.0800f},
+    {"lumixdmcts1", 6.0800f},
+    {"lumixdmcts20", 6.0800f},
+    {"lumixdmcts25", 6.0800f},
+    {"lumixdmcts2", 6.0800f},
+    {"lumixdmcts3", 6.0800f},
+    {"lumixdmcts4", 6.0800f},
+    {"lumixdmcts5", 6.0800f},
+    {"lumixdmctz10", 6.0800f},
+    {"lumixdmctz18", 6.0800f},
+    {"lumixdmctz1", 5.7500f},
+    {"lumixdmctz20", 6.0800f},
+    {"lumixdmctz22", 6.0800f},
+    {"lumixdmctz25", 6.1600f},
+    {"lumixdmctz2", 6.0800f},
+    {"lumixdmctz30", 6.0800f},
+    {"lumixdmctz31", 6.0800f},
+    {"lumixdmctz3", 6.0800f},
+    {"lumixdmctz4", 5.7500f},
+    {"lumixdmctz50", 6.0800f},
+    {"lumixdmctz57", 6.0800f},
+    {"lumixdmctz5", 6.0800f},
+    {"lumixdmctz6", 5.7500f},
+    {"lumixdmctz70", 6.1600f},
+    {"lumixdmctz7", 6.0800f},
+    {"lumixdmcxs1", 6.0800f},
+    {"lumixdmcxs3", 6.0800f},
+    {"lumixdmczr1", 6.0800f},
+    {"lumixdmczr3", 6.0800f},
+    {"lumixdmczs10", 6.0800f},
+    {"lumixdmczs15", 6.1600f},
+    {"lumixdmczs1", 5.7500f},
+    {"lumixdmczs20", 6.0800f},
+    {"lumixdmczs25", 6.0800f},
+    {"lumixdmczs30", 6.1600f},
+    {"lumixdmczs35/tz55", 6.0800f},
+    {"lumixdmczs3", 6.0800f},
+    {"lumixdmczs40/tz60", 6.1600f},
+    {"lumixdmczs5", 6.0800f},
+    {"lumixdmczs7", 6.0800f},
+    {"lumixdmczs8", 6.0800f},
+    {"lumixdmczx1", 6.0800f},
+    {"lumixdmczx3", 6.0800f},
+    {"pvdc3000", 7.1100f},
+};
 
-  {
-    auto& make_specs = specs["panasonic"];
-    make_specs.reserve(234);
-    make_specs.emplace_back("dsnapsvas10", 4.5000f);
-    make_specs.emplace_back("dsnapsvas30", 4.5000f);
-    make_specs.emplace_back("dsnapsvas3", 4.5000f);
-    make_specs.emplace_back("lumixdmc3d1", 6.1600f);
-    make_specs.emplace_back("lumixdmcf1", 5.7500f);
-    make_specs.emplace_back("lumixdmcf3", 6.0800f);
-    make_specs.emplace_back("lumixdmcf5", 6.0800f);
-    make_specs.emplace_back("lumixdmcf7", 5.3300f);
-    make_specs.emplace_back("lumixdmcfh10", 6.0800f);
-    make_specs.emplace_back("lumixdmcfh1", 6.0800f);
-    make_specs.emplace_back("lumixdmcfh20", 6.0800f);
-    make_specs.emplace_back("lumixdmcfh22", 6.0800f);
-    make_specs.emplace_back("lumixdmcfh25", 6.1600f);
-    make_specs.emplace_back("lumixdmcfh27", 6.1600f);
-    make_specs.emplace_back("lumixdmcfh2", 6.0800f);
-    make_specs.emplace_back("lumixdmcfh3", 6.0800f);
-    make_specs.emplace_back("lumixdmcfh4", 6.0800f);
-    make_specs.emplace_back("lumixdmcfh5", 6.0800f);
-    make_specs.emplace_back("lumixdmcfh6", 6.0800f);
-    make_specs.emplace_back("lumixdmcfh7", 6.0800f);
-    make_specs.emplace_back("lumixdmcfh8", 6.0800f);
-    make_specs.emplace_back("lumixdmcfp1", 6.0800f);
-    make_specs.emplace_back("lumixdmcfp2", 6.0800f);
-    make_specs.emplace_back("lumixdmcfp3", 6.0800f);
-    make_specs.emplace_back("lumixdmcfp5", 6.0800f);
-    make_specs.emplace_back("lumixdmcfp7", 6.0800f);
-    make_specs.emplace_back("lumixdmcfp8", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs10", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs11", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs12", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs15", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs16", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs18", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs20", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs22", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs25", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs28", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs2", 5.7500f);
-    make_specs.emplace_back("lumixdmcfs30", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs33", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs35", 6.1600f);
-    make_specs.emplace_back("lumixdmcfs37", 6.1600f);
-    make_specs.emplace_back("lumixdmcfs3", 5.7500f);
-    make_specs.emplace_back("lumixdmcfs40", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs42", 5.7500f);
-    make_specs.emplace_back("lumixdmcfs45", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs5", 6.0800f);
-    make_specs.emplace_back("lumixdmcfs62", 5.7500f);
-    make_specs.emplace_back("lumixdmcfs6", 5.7500f);
-    make_specs.emplace_back("lumixdmcfs7", 5.7500f);
-    make_specs.emplace_back("lumixdmcft10", 6.0800f);
-    make_specs.emplace_back("lumixdmcft1", 6.0800f);
-    make_specs.emplace_back("lumixdmcft20", 6.0800f);
-    make_specs.emplace_back("lumixdmcft2", 6.0800f);
-    make_specs.emplace_back("lumixdmcft30", 6.0800f);
-    make_specs.emplace_back("lumixdmcft3", 6.0800f);
-    make_specs.emplace_back("lumixdmcft4", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx01", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx07", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx100", 7.4400f);
-    make_specs.emplace_back("lumixdmcfx10", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx12", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx150", 7.4400f);
-    make_specs.emplace_back("lumixdmcfx1", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx2", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx30", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx33", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx35", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx37", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx3", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx40", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx48", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx500", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx50", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx550", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx55", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx580", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx5", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx60", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx65", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx66", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx68", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx700", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx70", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx75", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx77", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx78", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx7", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx80", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx8", 5.7500f);
-    make_specs.emplace_back("lumixdmcfx90", 6.0800f);
-    make_specs.emplace_back("lumixdmcfx9", 5.7500f);
-    make_specs.emplace_back("lumixdmcfz1000", 13.2000f);
-    make_specs.emplace_back("lumixdmcfz100", 6.0800f);
-    make_specs.emplace_back("lumixdmcfz10", 5.7500f);
-    make_specs.emplace_back("lumixdmcfz150", 6.0800f);
-    make_specs.emplace_back("lumixdmcfz15", 5.7500f);
-    make_specs.emplace_back("lumixdmcfz18", 5.7500f);
-    make_specs.emplace_back("lumixdmcfz1", 4.5000f);
-    make_specs.emplace_back("lumixdmcfz200", 6.1600f);
-    make_specs.emplace_back("lumixdmcfz20", 5.7500f);
-    make_specs.emplace_back("lumixdmcfz28", 6.0800f);
-    make_specs.emplace_back("lumixdmcfz2", 4.5000f);
-    make_specs.emplace_back("lumixdmcfz300", 6.1600f);
-    make_specs.emplace_back("lumixdmcfz30", 7.1100f);
-    make_specs.emplace_back("lumixdmcfz35", 6.0800f);
-    make_specs.emplace_back("lumixdmcfz38", 6.0800f);
-    make_specs.emplace_back("lumixdmcfz3", 4.5000f);
-    make_specs.emplace_back("lumixdmcfz40", 6.0800f);
-    make_specs.emplace_back("lumixdmcfz45", 6.0800f);
-    make_specs.emplace_back("lumixdmcfz47", 6.0800f);
-    make_specs.emplace_back("lumixdmcfz48", 6.0800f);
-    make_specs.emplace_back("lumixdmcfz4", 5.7500f);
-    make_specs.emplace_back("lumixdmcfz50", 7.1100f);
-    make_specs.emplace_back("lumixdmcfz5", 5.7500f);
-    make_specs.emplace_back("lumixdmcfz60", 6.0800f);
-    make_specs.emplace_back("lumixdmcfz70", 6.1600f);
-    make_specs.emplace_back("lumixdmcfz7", 5.7500f);
-    make_specs.emplace_back("lumixdmcfz8", 5.7500f);
-    make_specs.emplace_back("lumixdmcg10", 17.3000f);
-    make_specs.emplace_back("lumixdmcg1", 17.3000f);
-    make_specs.emplace_back("lumixdmcg2", 17.3000f);
-    make_specs.emplace_back("lumixdmcg3", 17.3000f);
-    make_specs.emplace_back("lumixdmcg5", 17.3000f);
-    make_specs.emplace_back("lumixdmcg6", 17.3000f);
-    make_specs.emplace_back("lumixdmcg7", 17.3000f);
-    make_specs.emplace_back("lumixdmcgf1", 17.3000f);
-    make_specs.emplace_back("lumixdmcgf2", 17.3000f);
-    make_specs.emplace_back("lumixdmcgf3", 17.3000f);
-    make_specs.emplace_back("lumixdmcgf5", 17.3000f);
-    make_specs.emplace_back("lumixdmcgf6", 17.3000f);
-    make_specs.emplace_back("lumixdmcgf7", 17.3000f);
-    make_specs.emplace_back("lumixdmcgh1", 17.3000f);
-    make_specs.emplace_back("lumixdmcgh2", 17.3000f);
-    make_specs.emplace_back("lumixdmcgh3", 17.3000f);
-    make_specs.emplace_back("lumixdmcgh4", 17.3000f);
-    make_specs.emplace_back("lumixdmcgm1", 17.3000f);
-    make_specs.emplace_back("lumixdmcgm5", 17.3000f);
-    make_specs.emplace_back("lumixdmcgx1", 17.3000f);
-    make_specs.emplace_back("lumixdmcgx7", 17.3000f);
-    make_specs.emplace_back("lumixdmcgx8", 17.3000f);
-    make_specs.emplace_back("lumixdmcl10", 17.3000f);
-    make_specs.emplace_back("lumixdmcl1", 17.3000f);
-    make_specs.emplace_back("lumixdmclc1", 8.8000f);
-    make_specs.emplace_back("lumixdmclc20", 5.3300f);
-    make_specs.emplace_back("lumixdmclc33", 5.7500f);
-    make_specs.emplace_back("lumixdmclc40", 7.5300f);
-    make_specs.emplace_back("lumixdmclc43", 5.7500f);
-    make_specs.emplace_back("lumixdmclc50", 5.7500f);
-    make_specs.emplace_back("lumixdmclc5", 7.5300f);
-    make_specs.emplace_back("lumixdmclc70", 5.7500f);
-    make_specs.emplace_back("lumixdmclc80", 5.7500f);
-    make_specs.emplace_back("lumixdmclf1", 7.5300f);
-    make_specs.emplace_back("lumixdmcls1", 5.7500f);
-    make_specs.emplace_back("lumixdmcls2", 5.7500f);
-    make_specs.emplace_back("lumixdmcls3", 5.7500f);
-    make_specs.emplace_back("lumixdmcls5", 6.0800f);
-    make_specs.emplace_back("lumixdmcls60", 5.7500f);
-    make_specs.emplace_back("lumixdmcls6", 6.0800f);
-    make_specs.emplace_back("lumixdmcls75", 5.7500f);
-    make_specs.emplace_back("lumixdmcls80", 5.7500f);
-    make_specs.emplace_back("lumixdmcls85", 5.7500f);
-    make_specs.emplace_back("lumixdmclx100", 17.3000f);
-    make_specs.emplace_back("lumixdmclx1", 7.7600f);
-    make_specs.emplace_back("lumixdmclx2", 7.7600f);
-    make_specs.emplace_back("lumixdmclx3", 7.8500f);
-    make_specs.emplace_back("lumixdmclx5", 7.8500f);
-    make_specs.emplace_back("lumixdmclx7", 7.5300f);
-    make_specs.emplace_back("lumixdmclz10", 6.0800f);
-    make_specs.emplace_back("lumixdmclz1", 5.7500f);
-    make_specs.emplace_back("lumixdmclz20", 6.0800f);
-    make_specs.emplace_back("lumixdmclz2", 5.7500f);
-    make_specs.emplace_back("lumixdmclz30", 6.1600f);
-    make_specs.emplace_back("lumixdmclz3", 5.7500f);
-    make_specs.emplace_back("lumixdmclz40", 6.1600f);
-    make_specs.emplace_back("lumixdmclz5", 5.7500f);
-    make_specs.emplace_back("lumixdmclz6", 5.7500f);
-    make_specs.emplace_back("lumixdmclz7", 5.7500f);
-    make_specs.emplace_back("lumixdmclz8", 5.7500f);
-    make_specs.emplace_back("lumixdmcs1", 6.0800f);
-    make_specs.emplace_back("lumixdmcs2", 6.0800f);
-    make_specs.emplace_back("lumixdmcs3", 6.0800f);
-    make_specs.emplace_back("lumixdmcs5", 6.0800f);
-    make_specs.emplace_back("lumixdmcsz10", 6.0800f);
-    make_specs.emplace_back("lumixdmcsz1", 6.0800f);
-    make_specs.emplace_back("lumixdmcsz3", 6.0800f);
-    make_specs.emplace_back("lumixdmcsz5", 6.0800f);
-    make_specs.emplace_back("lumixdmcsz7", 6.0800f);
-    make_specs.emplace_back("lumixdmcsz8", 6.0800f);
-    make_specs.emplace_back("lumixdmcsz9", 6.0800f);
-    make_specs.emplace_back("lumixdmcts10", 6.0800f);
-    make_specs.emplace_back("lumixdmcts1", 6.0800f);
-    make_specs.emplace_back("lumixdmcts20", 6.0800f);
-    make_specs.emplace_back("lumixdmcts25", 6.0800f);
-    make_specs.emplace_back("lumixdmcts2", 6.0800f);
-    make_specs.emplace_back("lumixdmcts3", 6.0800f);
-    make_specs.emplace_back("lumixdmcts4", 6.0800f);
-    make_specs.emplace_back("lumixdmcts5", 6.0800f);
-    make_specs.emplace_back("lumixdmctz10", 6.0800f);
-    make_specs.emplace_back("lumixdmctz18", 6.0800f);
-    make_specs.emplace_back("lumixdmctz1", 5.7500f);
-    make_specs.emplace_back("lumixdmctz20", 6.0800f);
-    make_specs.emplace_back("lumixdmctz22", 6.0800f);
-    make_specs.emplace_back("lumixdmctz25", 6.1600f);
-    make_specs.emplace_back("lumixdmctz2", 6.0800f);
-    make_specs.emplace_back("lumixdmctz30", 6.0800f);
-    make_specs.emplace_back("lumixdmctz31", 6.0800f);
-    make_specs.emplace_back("lumixdmctz3", 6.0800f);
-    make_specs.emplace_back("lumixdmctz4", 5.7500f);
-    make_specs.emplace_back("lumixdmctz50", 6.0800f);
-    make_specs.emplace_back("lumixdmctz57", 6.0800f);
-    make_specs.emplace_back("lumixdmctz5", 6.0800f);
-    make_specs.emplace_back("lumixdmctz6", 5.7500f);
-    make_specs.emplace_back("lumixdmctz70", 6.1600f);
-    make_specs.emplace_back("lumixdmctz7", 6.0800f);
-    make_specs.emplace_back("lumixdmcxs1", 6.0800f);
-    make_specs.emplace_back("lumixdmcxs3", 6.0800f);
-    make_specs.emplace_back("lumixdmczr1", 6.0800f);
-    make_specs.emplace_back("lumixdmczr3", 6.0800f);
-    make_specs.emplace_back("lumixdmczs10", 6.0800f);
-    make_specs.emplace_back("lumixdmczs15", 6.1600f);
-    make_specs.emplace_back("lumixdmczs1", 5.7500f);
-    make_specs.emplace_back("lumixdmczs20", 6.0800f);
-    make_specs.emplace_back("lumixdmczs25", 6.0800f);
-    make_specs.emplace_back("lumixdmczs30", 6.1600f);
-    make_specs.emplace_back("lumixdmczs35/tz55", 6.0800f);
-    make_specs.emplace_back("lumixdmczs3", 6.0800f);
-    make_specs.emplace_back("lumixdmczs40/tz60", 6.1600f);
-    make_specs.emplace_back("lumixdmczs5", 6.0800f);
-    make_specs.emplace_back("lumixdmczs7", 6.0800f);
-    make_specs.emplace_back("lumixdmczs8", 6.0800f);
-    make_specs.emplace_back("lumixdmczx1", 6.0800f);
-    make_specs.emplace_back("lumixdmczx3", 6.0800f);
-    make_specs.emplace_back("pvdc3000", 7.1100f);
-  }
+constexpr CameraModelSpecs kPentaxModels[] = {
+    {"645d", 44.0000f},
+    {"645z", 44.0000f},
+    {"efina", 6.1600f},
+    {"ei100", 4.5000f},
+    {"ei2000", 8.8000f},
+    {"ei200", 5.3300f},
+    {"*istdl2", 23.5000f},
+    {"*istdl", 23.5000f},
+    {"*istds2", 23.5000f},
+    {"*istds", 23.5000f},
+    {"*istd", 23.5000f},
+    {"k01", 23.7000f},
+    {"k3ii", 23.5000f},
+    {"k30", 23.7000f},
+    {"k3", 23.5000f},
+    {"k5ii", 23.7000f},
+    {"k500", 23.7000f},
+    {"k50", 23.7000f},
+    {"k5", 23.6000f},
+    {"k7", 23.4000f},
+    {"km", 23.5000f},
+    {"kr", 23.6000f},
+    {"ks1", 23.5000f},
+    {"ks2", 23.5000f},
+    {"kx", 23.6000f},
+    {"k100dsuper", 23.5000f},
+    {"k100d", 23.5000f},
+    {"k10d", 23.5000f},
+    {"k110d", 23.7000f},
+    {"k200d", 23.5000f},
+    {"k20d", 23.4000f},
+    {"mx1", 7.5300f},
+    {"optio230", 5.3300f},
+    {"optio30", 5.3300f},
+    {"optio330gs", 5.3300f},
+    {"optio330rs", 7.1100f},
+    {"optio330", 7.1100f},
+    {"optio33lf", 5.3300f},
+    {"optio33l", 5.3300f},
+    {"optio33wr", 5.3300f},
+    {"optio430rs", 7.1100f},
+    {"optio430", 7.1100f},
+    {"optio43wr", 5.3300f},
+    {"optio450", 7.1100f},
+    {"optio50l", 5.7500f},
+    {"optio50", 5.7500f},
+    {"optio550", 7.1100f},
+    {"optio555", 7.1100f},
+    {"optio60", 7.1100f},
+    {"optio750z", 7.1100f},
+    {"optioa10", 7.1100f},
+    {"optioa20", 5.7500f},
+    {"optioa30", 7.1100f},
+    {"optioa40", 7.5300f},
+    {"optioe10", 5.7500f},
+    {"optioe20", 5.7500f},
+    {"optioe25", 5.7500f},
+    {"optioe30", 5.7500f},
+    {"optioe40", 5.7500f},
+    {"optioe50", 5.7500f},
+    {"optioe60", 6.0800f},
+    {"optioe70l", 6.1600f},
+    {"optioe70", 6.1600f},
+    {"optioe75", 6.0800f},
+    {"optioe80", 6.0800f},
+    {"optioe85", 6.1600f},
+    {"optioe90", 6.1600f},
+    {"optioh90", 6.1600f},
+    {"optioi10", 6.1600f},
+    {"optiol20", 5.7500f},
+    {"optiol50", 6.0300f},
+    {"optiols1000", 6.1600f},
+    {"optiols1100", 6.0800f},
+    {"optiols465", 23.7000f},
+    {"optiom10", 5.7500f},
+    {"optiom20", 5.7500f},
+    {"optiom30", 5.7500f},
+    {"optiom40", 6.0300f},
+    {"optiom50", 6.0300f},
+    {"optiom60", 6.1600f},
+    {"optiom85", 6.1600f},
+    {"optiom90", 6.0800f},
+    {"optiomx4", 5.3300f},
+    {"optiomx", 5.3300f},
+    {"optiop70", 6.1600f},
+    {"optiop80", 6.1600f},
+    {"optiors1000", 6.1600f},
+    {"optiors1500", 6.0800f},
+    {"optiorz10", 6.0800f},
+    {"optiorz18", 6.0800f},
+    {"optios10", 7.1100f},
+    {"optios12", 7.5300f},
+    {"optios1", 6.1600f},
+    {"optios30", 5.3300f},
+    {"optios40", 5.7500f},
+    {"optios45", 5.7500f},
+    {"optios4i", 5.7500f},
+    {"optios4", 5.7500f},
+    {"optios50", 5.7500f},
+    {"optios55", 5.7500f},
+    {"optios5i", 5.7500f},
+    {"optios5n", 5.7500f},
+    {"optios5z", 5.7500f},
+    {"optios60", 5.7500f},
+    {"optios6", 5.7500f},
+    {"optios7", 5.7500f},
+    {"optiosvi", 5.7500f},
+    {"optiosv", 5.7500f},
+    {"optios", 5.7500f},
+    {"optiot10", 5.7500f},
+    {"optiot20", 5.7500f},
+    {"optiot30", 5.7500f},
+    {"optiov10", 6.0300f},
+    {"optiov20", 6.0300f},
+    {"optiovs20", 6.0800f},
+    {"optiow10", 5.7500f},
+    {"optiow20", 5.7500f},
+    {"optiow30", 5.7500f},
+    {"optiow60", 6.1600f},
+    {"optiow80", 6.1600f},
+    {"optiow90", 6.1600f},
+    {"optiowg1gps", 6.1600f},
+    {"optiowg1", 6.1600f},
+    {"optiowg2gps", 6.1600f},
+    {"optiowg2", 6.1600f},
+    {"optiowpi", 5.7500f},
+    {"optiowp", 5.7500f},
+    {"optiows80", 6.0800f},
+    {"optiox", 5.7500f},
+    {"optioz10", 5.7500f},
+    {"qs1", 7.5300f},
+    {"q10", 6.1600f},
+    {"q7", 7.5300f},
+    {"q", 6.1600f},
+    {"wg10", 6.1600f},
+    {"wg3", 6.1600f},
+    {"x5", 6.0800f},
+    {"x70", 6.0800f},
+    {"x90", 6.0800f},
+    {"xg1", 6.0800f},
+};
 
-  {
-    auto& make_specs = specs["pentax"];
-    make_specs.reserve(140);
-    make_specs.emplace_back("645d", 44.0000f);
-    make_specs.emplace_back("645z", 44.0000f);
-    make_specs.emplace_back("efina", 6.1600f);
-    make_specs.emplace_back("ei100", 4.5000f);
-    make_specs.emplace_back("ei2000", 8.8000f);
-    make_specs.emplace_back("ei200", 5.3300f);
-    make_specs.emplace_back("*istdl2", 23.5000f);
-    make_specs.emplace_back("*istdl", 23.5000f);
-    make_specs.emplace_back("*istds2", 23.5000f);
-    make_specs.emplace_back("*istds", 23.5000f);
-    make_specs.emplace_back("*istd", 23.5000f);
-    make_specs.emplace_back("k01", 23.7000f);
-    make_specs.emplace_back("k3ii", 23.5000f);
-    make_specs.emplace_back("k30", 23.7000f);
-    make_specs.emplace_back("k3", 23.5000f);
-    make_specs.emplace_back("k5ii", 23.7000f);
-    make_specs.emplace_back("k500", 23.7000f);
-    make_specs.emplace_back("k50", 23.7000f);
-    make_specs.emplace_back("k5", 23.6000f);
-    make_specs.emplace_back("k7", 23.4000f);
-    make_specs.emplace_back("km", 23.5000f);
-    make_specs.emplace_back("kr", 23.6000f);
-    make_specs.emplace_back("ks1", 23.5000f);
-    make_specs.emplace_back("ks2", 23.5000f);
-    make_specs.emplace_back("kx", 23.6000f);
-    make_specs.emplace_back("k100dsuper", 23.5000f);
-    make_specs.emplace_back("k100d", 23.5000f);
-    make_specs.emplace_back("k10d", 23.5000f);
-    make_specs.emplace_back("k110d", 23.7000f);
-    make_specs.emplace_back("k200d", 23.5000f);
-    make_specs.emplace_back("k20d", 23.4000f);
-    make_specs.emplace_back("mx1", 7.5300f);
-    make_specs.emplace_back("optio230", 5.3300f);
-    make_specs.emplace_back("optio30", 5.3300f);
-    make_specs.emplace_back("optio330gs", 5.3300f);
-    make_specs.emplace_back("optio330rs", 7.1100f);
-    make_specs.emplace_back("optio330", 7.1100f);
-    make_specs.emplace_back("optio33lf", 5.3300f);
-    make_specs.emplace_back("optio33l", 5.3300f);
-    make_specs.emplace_back("optio33wr", 5.3300f);
-    make_specs.emplace_back("optio430rs", 7.1100f);
-    make_specs.emplace_back("optio430", 7.1100f);
-    make_specs.emplace_back("optio43wr", 5.3300f);
-    make_specs.emplace_back("optio450", 7.1100f);
-    make_specs.emplace_back("optio50l", 5.7500f);
-    make_specs.emplace_back("optio50", 5.7500f);
-    make_specs.emplace_back("optio550", 7.1100f);
-    make_specs.emplace_back("optio555", 7.1100f);
-    make_specs.emplace_back("optio60", 7.1100f);
-    make_specs.emplace_back("optio750z", 7.1100f);
-    make_specs.emplace_back("optioa10", 7.1100f);
-    make_specs.emplace_back("optioa20", 5.7500f);
-    make_specs.emplace_back("optioa30", 7.1100f);
-    make_specs.emplace_back("optioa40", 7.5300f);
-    make_specs.emplace_back("optioe10", 5.7500f);
-    make_specs.emplace_back("optioe20", 5.7500f);
-    make_specs.emplace_back("optioe25", 5.7500f);
-    make_specs.emplace_back("optioe30", 5.7500f);
-    make_specs.emplace_back("optioe40", 5.7500f);
-    make_specs.emplace_back("optioe50", 5.7500f);
-    make_specs.emplace_back("optioe60", 6.0800f);
-    make_specs.emplace_back("optioe70l", 6.1600f);
-    make_specs.emplace_back("optioe70", 6.1600f);
-    make_specs.emplace_back("optioe75", 6.0800f);
-    make_specs.emplace_back("optioe80", 6.0800f);
-    make_specs.emplace_back("optioe85", 6.1600f);
-    make_specs.emplace_back("optioe90", 6.1600f);
-    make_specs.emplace_back("optioh90", 6.1600f);
-    make_specs.emplace_back("optioi10", 6.1600f);
-    make_specs.emplace_back("optiol20", 5.7500f);
-    make_specs.emplace_back("optiol50", 6.0300f);
-    make_specs.emplace_back("optiols1000", 6.1600f);
-    make_specs.emplace_back("optiols1100", 6.0800f);
-    make_specs.emplace_back("optiols465", 23.7000f);
-    make_specs.emplace_back("optiom10", 5.7500f);
-    make_specs.emplace_back("optiom20", 5.7500f);
-    make_specs.emplace_back("optiom30", 5.7500f);
-    make_specs.emplace_back("optiom40", 6.0300f);
-    make_specs.emplace_back("optiom50", 6.0300f);
-    make_specs.emplace_back("optiom60", 6.1600f);
-    make_specs.emplace_back("optiom85", 6.1600f);
-    make_specs.emplace_back("optiom90", 6.0800f);
-    make_specs.emplace_back("optiomx4", 5.3300f);
-    make_specs.emplace_back("optiomx", 5.3300f);
-    make_specs.emplace_back("optiop70", 6.1600f);
-    make_specs.emplace_back("optiop80", 6.1600f);
-    make_specs.emplace_back("optiors1000", 6.1600f);
-    make_specs.emplace_back("optiors1500", 6.0800f);
-    make_specs.emplace_back("optiorz10", 6.0800f);
-    make_specs.emplace_back("optiorz18", 6.0800f);
-    make_specs.emplace_back("optios10", 7.1100f);
-    make_specs.emplace_back("optios12", 7.5300f);
-    make_specs.emplace_back("optios1", 6.1600f);
-    make_specs.emplace_back("optios30", 5.3300f);
-    make_specs.emplace_back("optios40", 5.7500f);
-    make_specs.emplace_back("optios45", 5.7500f);
-    make_specs.emplace_back("optios4i", 5.7500f);
-    make_specs.emplace_back("optios4", 5.7500f);
-    make_specs.emplace_back("optios50", 5.7500f);
-    make_specs.emplace_back("optios55", 5.7500f);
-    make_specs.emplace_back("optios5i", 5.7500f);
-    make_specs.emplace_back("optios5n", 5.7500f);
-    make_specs.emplace_back("optios5z", 5.7500f);
-    make_specs.emplace_back("optios60", 5.7500f);
-    make_specs.emplace_back("optios6", 5.7500f);
-    make_specs.emplace_back("optios7", 5.7500f);
-    make_specs.emplace_back("optiosvi", 5.7500f);
-    make_specs.emplace_back("optiosv", 5.7500f);
-    make_specs.emplace_back("optios", 5.7500f);
-    make_specs.emplace_back("optiot10", 5.7500f);
-    make_specs.emplace_back("optiot20", 5.7500f);
-    make_specs.emplace_back("optiot30", 5.7500f);
-    make_specs.emplace_back("optiov10", 6.0300f);
-    make_specs.emplace_back("optiov20", 6.0300f);
-    make_specs.emplace_back("optiovs20", 6.0800f);
-    make_specs.emplace_back("optiow10", 5.7500f);
-    make_specs.emplace_back("optiow20", 5.7500f);
-    make_specs.emplace_back("optiow30", 5.7500f);
-    make_specs.emplace_back("optiow60", 6.1600f);
-    make_specs.emplace_back("optiow80", 6.1600f);
-    make_specs.emplace_back("optiow90", 6.1600f);
-    make_specs.emplace_back("optiowg1gps", 6.1600f);
-    make_specs.emplace_back("optiowg1", 6.1600f);
-    make_specs.emplace_back("optiowg2gps", 6.1600f);
-    make_specs.emplace_back("optiowg2", 6.1600f);
-    make_specs.emplace_back("optiowpi", 5.7500f);
-    make_specs.emplace_back("optiowp", 5.7500f);
-    make_specs.emplace_back("optiows80", 6.0800f);
-    make_specs.emplace_back("optiox", 5.7500f);
-    make_specs.emplace_back("optioz10", 5.7500f);
-    make_specs.emplace_back("qs1", 7.5300f);
-    make_specs.emplace_back("q10", 6.1600f);
-    make_specs.emplace_back("q7", 7.5300f);
-    make_specs.emplace_back("q", 6.1600f);
-    make_specs.emplace_back("wg10", 6.1600f);
-    make_specs.emplace_back("wg3", 6.1600f);
-    make_specs.emplace_back("x5", 6.0800f);
-    make_specs.emplace_back("x70", 6.0800f);
-    make_specs.emplace_back("x90", 6.0800f);
-    make_specs.emplace_back("xg1", 6.0800f);
-  }
+constexpr CameraModelSpecs kPrakticaModels[] = {
+    {"dc20", 6.4000f},
+    {"dc21", 5.3300f},
+    {"dc22", 5.3300f},
+    {"dc32", 5.3300f},
+    {"dc34", 5.3300f},
+    {"dc42", 5.7500f},
+    {"dc44", 5.7500f},
+    {"dc50", 5.7500f},
+    {"dc52", 5.7500f},
+    {"dc60", 5.7500f},
+    {"dcslim2", 6.4000f},
+    {"dcslim5", 7.1100f},
+    {"dc440", 5.7500f},
+    {"dcz1.3", 6.4000f},
+    {"dcz10.1", 7.1100f},
+    {"dcz10.2", 6.1600f},
+    {"dcz10.3", 6.0800f},
+    {"dcz10.4", 6.1600f},
+    {"dcz12.1", 6.1600f},
+    {"dcz12.z4", 6.1600f},
+    {"dcz14.1", 6.1600f},
+    {"dcz14.2", 6.1600f},
+    {"dcz2.0", 4.8000f},
+    {"dcz2.1s", 4.5000f},
+    {"dcz2.1", 4.8000f},
+    {"dcz2.2s", 6.4000f},
+    {"dcz2.2", 5.3300f},
+    {"dcz3.0", 6.4000f},
+    {"dcz3.2d", 6.4000f},
+    {"dcz3.2s", 6.4000f},
+    {"dcz3.2", 7.1100f},
+    {"dcz3.3", 7.1100f},
+    {"dcz3.4", 5.7500f},
+    {"dcz3.5", 5.7500f},
+    {"dcz4.1", 7.1100f},
+    {"dcz4.2", 7.1100f},
+    {"dcz4.3", 7.1100f},
+    {"dcz4.4", 5.7500f},
+    {"dcz5.1", 7.1100f},
+    {"dcz5.2", 7.1100f},
+    {"dcz5.3", 5.7500f},
+    {"dcz5.4", 5.7500f},
+    {"dcz5.5", 5.7500f},
+    {"dcz5.8", 5.7500f},
+    {"dcz6.1", 5.7500f},
+    {"dcz6.2", 5.7500f},
+    {"dcz6.3", 5.7500f},
+    {"dcz6.8", 5.7500f},
+    {"dcz7.1", 5.7500f},
+    {"dcz7.2", 5.7500f},
+    {"dcz7.3", 5.7500f},
+    {"dcz7.4", 5.7500f},
+    {"dcz8.1", 5.7500f},
+    {"dcz8.2", 5.7500f},
+    {"dcz8.3", 5.7500f},
+    {"digi3lm", 6.4000f},
+    {"digi30", 6.4000f},
+    {"digi3", 6.4000f},
+    {"digicam3", 6.4000f},
+    {"dmmc4", 4.8000f},
+    {"dmmc", 4.8000f},
+    {"dpix1000z", 6.1600f},
+    {"dpix1100z", 5.7500f},
+    {"dpix1220z", 6.0800f},
+    {"dpix3000", 6.4000f},
+    {"dpix3200", 4.8000f},
+    {"dpix3300", 4.8000f},
+    {"dpix5000wp", 4.5000f},
+    {"dpix5100", 5.7500f},
+    {"dpix510z", 5.7500f},
+    {"dpix5200", 5.7500f},
+    {"dpix530z", 5.7500f},
+    {"dpix740z", 5.7500f},
+    {"dpix750z", 5.7500f},
+    {"dpix810z", 5.7500f},
+    {"dpix820z", 5.7500f},
+    {"dpix9000", 6.1600f},
+    {"dpix910z", 6.4000f},
+    {"dvc6.1", 5.7500f},
+    {"exaktadc4200", 7.1100f},
+    {"g2.0", 6.4000f},
+    {"g3.2", 6.4000f},
+    {"luxmedia1003", 6.1600f},
+    {"luxmedia1023", 6.1600f},
+    {"luxmedia10ts", 6.1600f},
+    {"luxmedia10x3", 7.1100f},
+    {"luxmedia10xs", 5.7500f},
+    {"luxmedia1203", 5.7500f},
+    {"luxmedia1204", 6.1600f},
+    {"luxmedia1223", 6.1600f},
+    {"luxmedia12hd", 7.4400f},
+    {"luxmedia12ts", 6.1600f},
+    {"luxmedia12xs", 5.7500f},
+    {"luxmedia12z4ts", 6.1600f},
+    {"luxmedia12z4", 6.1600f},
+    {"luxmedia12z5", 6.1600f},
+    {"luxmedia14z50s", 6.1600f},
+    {"luxmedia14z51", 6.1600f},
+    {"luxmedia14z80s", 6.1600f},
+    {"luxmedia16z12s", 6.1600f},
+    {"luxmedia16z21c", 6.1600f},
+    {"luxmedia16z21s", 6.1600f},
+    {"luxmedia16z24s", 6.1600f},
+    {"luxmedia16z51", 6.1600f},
+    {"luxmedia16z52", 6.1600f},
+    {"luxmedia18z36c", 6.1600f},
+    {"luxmedia4008", 5.7500f},
+    {"luxmedia5003", 7.1100f},
+    {"luxmedia5008", 5.7500f},
+    {"luxmedia5103", 7.1100f},
+    {"luxmedia5203", 5.7500f},
+    {"luxmedia5303", 5.7500f},
+    {"luxmedia6103", 7.1100f},
+    {"luxmedia6105", 5.7500f},
+    {"luxmedia6203", 5.7500f},
+    {"luxmedia6403", 5.7500f},
+    {"luxmedia6503", 5.7500f},
+    {"luxmedia7103", 5.7500f},
+    {"luxmedia7105", 5.7500f},
+    {"luxmedia7203", 5.7500f},
+    {"luxmedia7303", 5.7500f},
+    {"luxmedia7403", 5.7500f},
+    {"luxmedia8003", 7.1100f},
+    {"luxmedia8203", 5.7500f},
+    {"luxmedia8213", 5.7500f},
+    {"luxmedia8303", 5.7500f},
+    {"luxmedia8403", 5.7500f},
+    {"luxmedia8503", 5.7500f},
+    {"mini", 6.4000f},
+    {"v2.1", 6.4000f},
+    {"v3.2", 6.4000f},
+};
 
-  {
-    auto& make_specs = specs["praktica"];
-    make_specs.reserve(131);
-    make_specs.emplace_back("dc20", 6.4000f);
-    make_specs.emplace_back("dc21", 5.3300f);
-    make_specs.emplace_back("dc22", 5.3300f);
-    make_specs.emplace_back("dc32", 5.3300f);
-    make_specs.emplace_back("dc34", 5.3300f);
-    make_specs.emplace_back("dc42", 5.7500f);
-    make_specs.emplace_back("dc44", 5.7500f);
-    make_specs.emplace_back("dc50", 5.7500f);
-    make_specs.emplace_back("dc52", 5.7500f);
-    make_specs.emplace_back("dc60", 5.7500f);
-    make_specs.emplace_back("dcslim2", 6.4000f);
-    make_specs.emplace_back("dcslim5", 7.1100f);
-    make_specs.emplace_back("dc440", 5.7500f);
-    make_specs.emplace_back("dcz1.3", 6.4000f);
-    make_specs.emplace_back("dcz10.1", 7.1100f);
-    make_specs.emplace_back("dcz10.2", 6.1600f);
-    make_specs.emplace_back("dcz10.3", 6.0800f);
-    make_specs.emplace_back("dcz10.4", 6.1600f);
-    make_specs.emplace_back("dcz12.1", 6.1600f);
-    make_specs.emplace_back("dcz12.z4", 6.1600f);
-    make_specs.emplace_back("dcz14.1", 6.1600f);
-    make_specs.emplace_back("dcz14.2", 6.1600f);
-    make_specs.emplace_back("dcz2.0", 4.8000f);
-    make_specs.emplace_back("dcz2.1s", 4.5000f);
-    make_specs.emplace_back("dcz2.1", 4.8000f);
-    make_specs.emplace_back("dcz2.2s", 6.4000f);
-    make_specs.emplace_back("dcz2.2", 5.3300f);
-    make_specs.emplace_back("dcz3.0", 6.4000f);
-    make_specs.emplace_back("dcz3.2d", 6.4000f);
-    make_specs.emplace_back("dcz3.2s", 6.4000f);
-    make_specs.emplace_back("dcz3.2", 7.1100f);
-    make_specs.emplace_back("dcz3.3", 7.1100f);
-    make_specs.emplace_back("dcz3.4", 5.7500f);
-    make_specs.emplace_back("dcz3.5", 5.7500f);
-    make_specs.emplace_back("dcz4.1", 7.1100f);
-    make_specs.emplace_back("dcz4.2", 7.1100f);
-    make_specs.emplace_back("dcz4.3", 7.1100f);
-    make_specs.emplace_back("dcz4.4", 5.7500f);
-    make_specs.emplace_back("dcz5.1", 7.1100f);
-    make_specs.emplace_back("dcz5.2", 7.1100f);
-    make_specs.emplace_back("dcz5.3", 5.7500f);
-    make_specs.emplace_back("dcz5.4", 5.7500f);
-    make_specs.emplace_back("dcz5.5", 5.7500f);
-    make_specs.emplace_back("dcz5.8", 5.7500f);
-    make_specs.emplace_back("dcz6.1", 5.7500f);
-    make_specs.emplace_back("dcz6.2", 5.7500f);
-    make_specs.emplace_back("dcz6.3", 5.7500f);
-    make_specs.emplace_back("dcz6.8", 5.7500f);
-    make_specs.emplace_back("dcz7.1", 5.7500f);
-    make_specs.emplace_back("dcz7.2", 5.7500f);
-    make_specs.emplace_back("dcz7.3", 5.7500f);
-    make_specs.emplace_back("dcz7.4", 5.7500f);
-    make_specs.emplace_back("dcz8.1", 5.7500f);
-    make_specs.emplace_back("dcz8.2", 5.7500f);
-    make_specs.emplace_back("dcz8.3", 5.7500f);
-    make_specs.emplace_back("digi3lm", 6.4000f);
-    make_specs.emplace_back("digi30", 6.4000f);
-    make_specs.emplace_back("digi3", 6.4000f);
-    make_specs.emplace_back("digicam3", 6.4000f);
-    make_specs.emplace_back("dmmc4", 4.8000f);
-    make_specs.emplace_back("dmmc", 4.8000f);
-    make_specs.emplace_back("dpix1000z", 6.1600f);
-    make_specs.emplace_back("dpix1100z", 5.7500f);
-    make_specs.emplace_back("dpix1220z", 6.0800f);
-    make_specs.emplace_back("dpix3000", 6.4000f);
-    make_specs.emplace_back("dpix3200", 4.8000f);
-    make_specs.emplace_back("dpix3300", 4.8000f);
-    make_specs.emplace_back("dpix5000wp", 4.5000f);
-    make_specs.emplace_back("dpix5100", 5.7500f);
-    make_specs.emplace_back("dpix510z", 5.7500f);
-    make_specs.emplace_back("dpix5200", 5.7500f);
-    make_specs.emplace_back("dpix530z", 5.7500f);
-    make_specs.emplace_back("dpix740z", 5.7500f);
-    make_specs.emplace_back("dpix750z", 5.7500f);
-    make_specs.emplace_back("dpix810z", 5.7500f);
-    make_specs.emplace_back("dpix820z", 5.7500f);
-    make_specs.emplace_back("dpix9000", 6.1600f);
-    make_specs.emplace_back("dpix910z", 6.4000f);
-    make_specs.emplace_back("dvc6.1", 5.7500f);
-    make_specs.emplace_back("exaktadc4200", 7.1100f);
-    make_specs.emplace_back("g2.0", 6.4000f);
-    make_specs.emplace_back("g3.2", 6.4000f);
-    make_specs.emplace_back("luxmedia1003", 6.1600f);
-    make_specs.emplace_back("luxmedia1023", 6.1600f);
-    make_specs.emplace_back("luxmedia10ts", 6.1600f);
-    make_specs.emplace_back("luxmedia10x3", 7.1100f);
-    make_specs.emplace_back("luxmedia10xs", 5.7500f);
-    make_specs.emplace_back("luxmedia1203", 5.7500f);
-    make_specs.emplace_back("luxmedia1204", 6.1600f);
-    make_specs.emplace_back("luxmedia1223", 6.1600f);
-    make_specs.emplace_back("luxmedia12hd", 7.4400f);
-    make_specs.emplace_back("luxmedia12ts", 6.1600f);
-    make_specs.emplace_back("luxmedia12xs", 5.7500f);
-    make_specs.emplace_back("luxmedia12z4ts", 6.1600f);
-    make_specs.emplace_back("luxmedia12z4", 6.1600f);
-    make_specs.emplace_back("luxmedia12z5", 6.1600f);
-    make_specs.emplace_back("luxmedia14z50s", 6.1600f);
-    make_specs.emplace_back("luxmedia14z51", 6.1600f);
-    make_specs.emplace_back("luxmedia14z80s", 6.1600f);
-    make_specs.emplace_back("luxmedia16z12s", 6.1600f);
-    make_specs.emplace_back("luxmedia16z21c", 6.1600f);
-    make_specs.emplace_back("luxmedia16z21s", 6.1600f);
-    make_specs.emplace_back("luxmedia16z24s", 6.1600f);
-    make_specs.emplace_back("luxmedia16z51", 6.1600f);
-    make_specs.emplace_back("luxmedia16z52", 6.1600f);
-    make_specs.emplace_back("luxmedia18z36c", 6.1600f);
-    make_specs.emplace_back("luxmedia4008", 5.7500f);
-    make_specs.emplace_back("luxmedia5003", 7.1100f);
-    make_specs.emplace_back("luxmedia5008", 5.7500f);
-    make_specs.emplace_back("luxmedia5103", 7.1100f);
-    make_specs.emplace_back("luxmedia5203", 5.7500f);
-    make_specs.emplace_back("luxmedia5303", 5.7500f);
-    make_specs.emplace_back("luxmedia6103", 7.1100f);
-    make_specs.emplace_back("luxmedia6105", 5.7500f);
-    make_specs.emplace_back("luxmedia6203", 5.7500f);
-    make_specs.emplace_back("luxmedia6403", 5.7500f);
-    make_specs.emplace_back("luxmedia6503", 5.7500f);
-    make_specs.emplace_back("luxmedia7103", 5.7500f);
-    make_specs.emplace_back("luxmedia7105", 5.7500f);
-    make_specs.emplace_back("luxmedia7203", 5.7500f);
-    make_specs.emplace_back("luxmedia7303", 5.7500f);
-    make_specs.emplace_back("luxmedia7403", 5.7500f);
-    make_specs.emplace_back("luxmedia8003", 7.1100f);
-    make_specs.emplace_back("luxmedia8203", 5.7500f);
-    make_specs.emplace_back("luxmedia8213", 5.7500f);
-    make_specs.emplace_back("luxmedia8303", 5.7500f);
-    make_specs.emplace_back("luxmedia8403", 5.7500f);
-    make_specs.emplace_back("luxmedia8503", 5.7500f);
-    make_specs.emplace_back("mini", 6.4000f);
-    make_specs.emplace_back("v2.1", 6.4000f);
-    make_specs.emplace_back("v3.2", 6.4000f);
-  }
+constexpr CameraModelSpecs kRicohModels[] = {
+    {"caplio400gwide", 5.3300f},
+    {"caplio500gwide", 7.1100f},
+    {"caplio500g", 7.1100f},
+    {"caplio500se", 7.1100f},
+    {"capliog3s", 5.3300f},
+    {"capliog3", 5.3300f},
+    {"capliogx100", 7.3100f},
+    {"capliogx200", 7.5300f},
+    {"capliogx8", 7.1100f},
+    {"capliogx", 7.1100f},
+    {"caplior1v", 5.7500f},
+    {"caplior1", 7.1100f},
+    {"caplior2s", 5.7500f},
+    {"caplior2", 5.7500f},
+    {"caplior30", 5.7500f},
+    {"caplior3", 5.7500f},
+    {"caplior40", 5.7500f},
+    {"caplior4", 5.7500f},
+    {"caplior5", 5.7500f},
+    {"caplior6", 5.7500f},
+    {"caplior7", 5.7500f},
+    {"caplior8", 6.1600f},
+    {"capliorr10", 5.3300f},
+    {"capliorr120", 4.5000f},
+    {"capliorr1", 7.1100f},
+    {"capliorr230", 4.5000f},
+    {"capliorr30", 5.3300f},
+    {"capliorr330", 5.7500f},
+    {"capliorr530", 5.7500f},
+    {"capliorr630", 7.1100f},
+    {"capliorr660", 5.7500f},
+    {"capliorr750", 5.7500f},
+    {"capliorr770", 5.7500f},
+    {"capliorx", 5.3300f},
+    {"capliorz1", 5.7500f},
+    {"cx1", 6.1600f},
+    {"cx2", 6.1600f},
+    {"cx3", 6.1600f},
+    {"cx4", 6.1600f},
+    {"cx5", 6.1600f},
+    {"cx6", 6.1600f},
+    {"g600", 6.1600f},
+    {"g700se", 6.1600f},
+    {"g700", 6.1600f},
+    {"g800", 6.1600f},
+    {"grdigital3", 7.5300f},
+    {"grdigital4", 7.5300f},
+    {"grdigitalii", 7.3100f},
+    {"grdigital", 7.1100f},
+    {"grii", 23.6000f},
+    {"gr", 23.6000f},
+    {"gx200", 7.5300f},
+    {"gxra1250mmf2.5macro", 23.6000f},
+    {"gxra162485mmf3.55.5", 23.6000f},
+    {"gxrgrlensa1228mmf2.5", 23.6000f},
+    {"gxrmounta12", 23.6000f},
+    {"gxrp1028300mmf3.55.6vc", 6.1600f},
+    {"gxrs102472mmf2.54.4vc", 7.5300f},
+    {"hz15", 6.1600f},
+    {"px", 6.1600f},
+    {"r10", 6.1600f},
+    {"r50", 6.0800f},
+    {"r8", 6.1600f},
+    {"rdc200g", 6.4000f},
+    {"rdc4300", 4.8000f},
+    {"rdc5000", 5.3300f},
+    {"rdc5300", 5.3300f},
+    {"rdc6000", 6.4000f},
+    {"rdc7", 7.1100f},
+    {"rdci500", 7.1100f},
+    {"rdci700", 7.1100f},
+    {"wg20", 6.1600f},
+    {"wg30", 6.1600f},
+    {"wg4", 6.1600f},
+    {"wg5gps", 6.1600f},
+    {"wgm1", 6.1600f},
+};
 
-  {
-    auto& make_specs = specs["ricoh"];
-    make_specs.reserve(76);
-    make_specs.emplace_back("caplio400gwide", 5.3300f);
-    make_specs.emplace_back("caplio500gwide", 7.1100f);
-    make_specs.emplace_back("caplio500g", 7.1100f);
-    make_specs.emplace_back("caplio500se", 7.1100f);
-    make_specs.emplace_back("capliog3s", 5.3300f);
-    make_specs.emplace_back("capliog3", 5.3300f);
-    make_specs.emplace_back("capliogx100", 7.3100f);
-    make_specs.emplace_back("capliogx200", 7.5300f);
-    make_specs.emplace_back("capliogx8", 7.1100f);
-    make_specs.emplace_back("capliogx", 7.1100f);
-    make_specs.emplace_back("caplior1v", 5.7500f);
-    make_specs.emplace_back("caplior1", 7.1100f);
-    make_specs.emplace_back("caplior2s", 5.7500f);
-    make_specs.emplace_back("caplior2", 5.7500f);
-    make_specs.emplace_back("caplior30", 5.7500f);
-    make_specs.emplace_back("caplior3", 5.7500f);
-    make_specs.emplace_back("caplior40", 5.7500f);
-    make_specs.emplace_back("caplior4", 5.7500f);
-    make_specs.emplace_back("caplior5", 5.7500f);
-    make_specs.emplace_back("caplior6", 5.7500f);
-    make_specs.emplace_back("caplior7", 5.7500f);
-    make_specs.emplace_back("caplior8", 6.1600f);
-    make_specs.emplace_back("capliorr10", 5.3300f);
-    make_specs.emplace_back("capliorr120", 4.5000f);
-    make_specs.emplace_back("capliorr1", 7.1100f);
-    make_specs.emplace_back("capliorr230", 4.5000f);
-    make_specs.emplace_back("capliorr30", 5.3300f);
-    make_specs.emplace_back("capliorr330", 5.7500f);
-    make_specs.emplace_back("capliorr530", 5.7500f);
-    make_specs.emplace_back("capliorr630", 7.1100f);
-    make_specs.emplace_back("capliorr660", 5.7500f);
-    make_specs.emplace_back("capliorr750", 5.7500f);
-    make_specs.emplace_back("capliorr770", 5.7500f);
-    make_specs.emplace_back("capliorx", 5.3300f);
-    make_specs.emplace_back("capliorz1", 5.7500f);
-    make_specs.emplace_back("cx1", 6.1600f);
-    make_specs.emplace_back("cx2", 6.1600f);
-    make_specs.emplace_back("cx3", 6.1600f);
-    make_specs.emplace_back("cx4", 6.1600f);
-    make_specs.emplace_back("cx5", 6.1600f);
-    make_specs.emplace_back("cx6", 6.1600f);
-    make_specs.emplace_back("g600", 6.1600f);
-    make_specs.emplace_back("g700se", 6.1600f);
-    make_specs.emplace_back("g700", 6.1600f);
-    make_specs.emplace_back("g800", 6.1600f);
-    make_specs.emplace_back("grdigital3", 7.5300f);
-    make_specs.emplace_back("grdigital4", 7.5300f);
-    make_specs.emplace_back("grdigitalii", 7.3100f);
-    make_specs.emplace_back("grdigital", 7.1100f);
-    make_specs.emplace_back("grii", 23.6000f);
-    make_specs.emplace_back("gr", 23.6000f);
-    make_specs.emplace_back("gx200", 7.5300f);
-    make_specs.emplace_back("gxra1250mmf2.5macro", 23.6000f);
-    make_specs.emplace_back("gxra162485mmf3.55.5", 23.6000f);
-    make_specs.emplace_back("gxrgrlensa1228mmf2.5", 23.6000f);
-    make_specs.emplace_back("gxrmounta12", 23.6000f);
-    make_specs.emplace_back("gxrp1028300mmf3.55.6vc", 6.1600f);
-    make_specs.emplace_back("gxrs102472mmf2.54.4vc", 7.5300f);
-    make_specs.emplace_back("hz15", 6.1600f);
-    make_specs.emplace_back("px", 6.1600f);
-    make_specs.emplace_back("r10", 6.1600f);
-    make_specs.emplace_back("r50", 6.0800f);
-    make_specs.emplace_back("r8", 6.1600f);
-    make_specs.emplace_back("rdc200g", 6.4000f);
-    make_specs.emplace_back("rdc4300", 4.8000f);
-    make_specs.emplace_back("rdc5000", 5.3300f);
-    make_specs.emplace_back("rdc5300", 5.3300f);
-    make_specs.emplace_back("rdc6000", 6.4000f);
-    make_specs.emplace_back("rdc7", 7.1100f);
-    make_specs.emplace_back("rdci500", 7.1100f);
-    make_specs.emplace_back("rdci700", 7.1100f);
-    make_specs.emplace_back("wg20", 6.1600f);
-    make_specs.emplace_back("wg30", 6.1600f);
-    make_specs.emplace_back("wg4", 6.1600f);
-    make_specs.emplace_back("wg5gps", 6.1600f);
-    make_specs.emplace_back("wgm1", 6.1600f);
-  }
+constexpr CameraModelSpecs kRolleiModels[] = {
+    {"compactline100", 6.1600f},
+    {"compactline101", 5.7500f},
+    {"compactline102", 5.7500f},
+    {"compactline103", 6.0800f},
+    {"compactline110", 5.7500f},
+    {"compactline130", 5.7500f},
+    {"compactline150", 6.0800f},
+    {"compactline200", 6.1600f},
+    {"compactline202", 6.0800f},
+    {"compactline203", 6.0800f},
+    {"compactline230", 6.0800f},
+    {"compactline302", 6.0800f},
+    {"compactline304", 6.0800f},
+    {"compactline312", 6.1600f},
+    {"compactline320", 6.0800f},
+    {"compactline350", 6.1600f},
+    {"compactline360ts", 6.1600f},
+    {"compactline370ts", 6.1600f},
+    {"compactline390se", 6.1600f},
+    {"compactline412", 6.0800f},
+    {"compactline415", 6.0800f},
+    {"compactline425", 6.1600f},
+    {"compactline50", 6.1600f},
+    {"compactline52", 6.1600f},
+    {"compactline55", 6.1600f},
+    {"compactline80", 5.7500f},
+    {"compactline81", 5.7500f},
+    {"compactline90", 6.1600f},
+    {"d20motion", 7.1100f},
+    {"d210motion", 4.5000f},
+    {"d23com", 7.5300f},
+    {"d33com", 7.1100f},
+    {"d330motion", 5.3300f},
+    {"d41com", 7.1100f},
+    {"d530flex", 8.8000f},
+    {"da10", 5.7500f},
+    {"da1325prego", 5.7500f},
+    {"da5324", 5.7500f},
+    {"da5325prego", 5.7500f},
+    {"da6324", 5.7500f},
+    {"da7325prego", 5.7500f},
+    {"da8324", 5.7500f},
+    {"dc3100", 5.3300f},
+    {"dcx310", 7.1100f},
+    {"dcx400", 7.1100f},
+    {"dk3000", 5.3300f},
+    {"dk4010", 5.3300f},
+    {"dp300", 5.3300f},
+    {"dp3210", 5.3300f},
+    {"dp6500", 7.1100f},
+    {"dpx310", 5.3300f},
+    {"dr5100", 7.1100f},
+    {"dr5", 5.7500f},
+    {"ds6", 5.7500f},
+    {"dsx410", 5.7500f},
+    {"dt3200", 5.7500f},
+    {"dt4000", 5.7500f},
+    {"dt4200", 5.7500f},
+    {"dt6tribute", 5.7500f},
+    {"dx63", 5.7500f},
+    {"flexline100it", 5.7500f},
+    {"flexline100", 5.7500f},
+    {"flexline140", 6.0800f},
+    {"flexline200", 6.0800f},
+    {"flexline202", 6.1600f},
+    {"flexline250", 6.0800f},
+    {"kids100", 8.8000f},
+    {"powerflex240hd", 6.1600f},
+    {"powerflex360fullhd", 6.1600f},
+    {"powerflex3d", 6.0800f},
+    {"powerflex400", 6.0800f},
+    {"powerflex440", 6.0800f},
+    {"powerflex450", 6.0800f},
+    {"powerflex455", 6.0800f},
+    {"powerflex460", 6.0800f},
+    {"powerflex470", 6.0800f},
+    {"powerflex500", 6.0800f},
+    {"powerflex600", 6.1600f},
+    {"powerflex610hd", 6.1600f},
+    {"powerflex700fullhd", 6.0800f},
+    {"powerflex800", 6.0800f},
+    {"powerflex820", 6.0800f},
+    {"pregoda3", 5.3300f},
+    {"pregoda4", 5.7500f},
+    {"pregoda5", 5.7500f},
+    {"pregoda6", 7.1100f},
+    {"pregodp4200", 5.7500f},
+    {"pregodp5200", 5.7500f},
+    {"pregodp5300", 7.1100f},
+    {"pregodp5500", 5.7500f},
+    {"pregodp6000", 7.1100f},
+    {"pregodp6200", 7.1100f},
+    {"pregodp6300", 7.1100f},
+    {"pregodp8300", 7.1100f},
+    {"rcp10325x", 7.1100f},
+    {"rcp5324", 5.7500f},
+    {"rcp6324", 5.7500f},
+    {"rcp7324", 5.7500f},
+    {"rcp7325xs", 5.7500f},
+    {"rcp7330x", 5.7500f},
+    {"rcp7430xw", 5.7500f},
+    {"rcp8325xs", 5.7500f},
+    {"rcp8325x", 7.1100f},
+    {"rcp8325", 5.7500f},
+    {"rcp8330x", 5.7500f},
+    {"rcp8427xw", 5.7500f},
+    {"rcp8527x", 5.7500f},
+    {"rcps10", 6.1600f},
+    {"rcps8", 5.7500f},
+    {"sportsline50", 6.1600f},
+    {"sportsline60camouflage", 6.1600f},
+    {"sportsline62", 6.1600f},
+    {"sportsline90", 6.1600f},
+    {"sportsline99", 6.1600f},
+    {"x8compact", 5.7500f},
+    {"x8sports", 5.7500f},
+    {"x8", 5.7500f},
+    {"xs10intouch", 6.1600f},
+    {"xs10", 5.7500f},
+    {"xs8crystal", 5.7500f},
+    {"xs8", 5.7500f},
+};
 
-  {
-    auto& make_specs = specs["rollei"];
-    make_specs.reserve(121);
-    make_specs.emplace_back("compactline100", 6.1600f);
-    make_specs.emplace_back("compactline101", 5.7500f);
-    make_specs.emplace_back("compactline102", 5.7500f);
-    make_specs.emplace_back("compactline103", 6.0800f);
-    make_specs.emplace_back("compactline110", 5.7500f);
-    make_specs.emplace_back("compactline130", 5.7500f);
-    make_specs.emplace_back("compactline150", 6.0800f);
-    make_specs.emplace_back("compactline200", 6.1600f);
-    make_specs.emplace_back("compactline202", 6.0800f);
-    make_specs.emplace_back("compactline203", 6.0800f);
-    make_specs.emplace_back("compactline230", 6.0800f);
-    make_specs.emplace_back("compactline302", 6.0800f);
-    make_specs.emplace_back("compactline304", 6.0800f);
-    make_specs.emplace_back("compactline312", 6.1600f);
-    make_specs.emplace_back("compactline320", 6.0800f);
-    make_specs.emplace_back("compactline350", 6.1600f);
-    make_specs.emplace_back("compactline360ts", 6.1600f);
-    make_specs.emplace_back("compactline370ts", 6.1600f);
-    make_specs.emplace_back("compactline390se", 6.1600f);
-    make_specs.emplace_back("compactline412", 6.0800f);
-    make_specs.emplace_back("compactline415", 6.0800f);
-    make_specs.emplace_back("compactline425", 6.1600f);
-    make_specs.emplace_back("compactline50", 6.1600f);
-    make_specs.emplace_back("compactline52", 6.1600f);
-    make_specs.emplace_back("compactline55", 6.1600f);
-    make_specs.emplace_back("compactline80", 5.7500f);
-    make_specs.emplace_back("compactline81", 5.7500f);
-    make_specs.emplace_back("compactline90", 6.1600f);
-    make_specs.emplace_back("d20motion", 7.1100f);
-    make_specs.emplace_back("d210motion", 4.5000f);
-    make_specs.emplace_back("d23com", 7.5300f);
-    make_specs.emplace_back("d33com", 7.1100f);
-    make_specs.emplace_back("d330motion", 5.3300f);
-    make_specs.emplace_back("d41com", 7.1100f);
-    make_specs.emplace_back("d530flex", 8.8000f);
-    make_specs.emplace_back("da10", 5.7500f);
-    make_specs.emplace_back("da1325prego", 5.7500f);
-    make_specs.emplace_back("da5324", 5.7500f);
-    make_specs.emplace_back("da5325prego", 5.7500f);
-    make_specs.emplace_back("da6324", 5.7500f);
-    make_specs.emplace_back("da7325prego", 5.7500f);
-    make_specs.emplace_back("da8324", 5.7500f);
-    make_specs.emplace_back("dc3100", 5.3300f);
-    make_specs.emplace_back("dcx310", 7.1100f);
-    make_specs.emplace_back("dcx400", 7.1100f);
-    make_specs.emplace_back("dk3000", 5.3300f);
-    make_specs.emplace_back("dk4010", 5.3300f);
-    make_specs.emplace_back("dp300", 5.3300f);
-    make_specs.emplace_back("dp3210", 5.3300f);
-    make_specs.emplace_back("dp6500", 7.1100f);
-    make_specs.emplace_back("dpx310", 5.3300f);
-    make_specs.emplace_back("dr5100", 7.1100f);
-    make_specs.emplace_back("dr5", 5.7500f);
-    make_specs.emplace_back("ds6", 5.7500f);
-    make_specs.emplace_back("dsx410", 5.7500f);
-    make_specs.emplace_back("dt3200", 5.7500f);
-    make_specs.emplace_back("dt4000", 5.7500f);
-    make_specs.emplace_back("dt4200", 5.7500f);
-    make_specs.emplace_back("dt6tribute", 5.7500f);
-    make_specs.emplace_back("dx63", 5.7500f);
-    make_specs.emplace_back("flexline100it", 5.7500f);
-    make_specs.emplace_back("flexline100", 5.7500f);
-    make_specs.emplace_back("flexline140", 6.0800f);
-    make_specs.emplace_back("flexline200", 6.0800f);
-    make_specs.emplace_back("flexline202", 6.1600f);
-    make_specs.emplace_back("flexline250", 6.0800f);
-    make_specs.emplace_back("kids100", 8.8000f);
-    make_specs.emplace_back("powerflex240hd", 6.1600f);
-    make_specs.emplace_back("powerflex360fullhd", 6.1600f);
-    make_specs.emplace_back("powerflex3d", 6.0800f);
-    make_specs.emplace_back("powerflex400", 6.0800f);
-    make_specs.emplace_back("powerflex440", 6.0800f);
-    make_specs.emplace_back("powerflex450", 6.0800f);
-    make_specs.emplace_back("powerflex455", 6.0800f);
-    make_specs.emplace_back("powerflex460", 6.0800f);
-    make_specs.emplace_back("powerflex470", 6.0800f);
-    make_specs.emplace_back("powerflex500", 6.0800f);
-    make_specs.emplace_back("powerflex600", 6.1600f);
-    make_specs.emplace_back("powerflex610hd", 6.1600f);
-    make_specs.emplace_back("powerflex700fullhd", 6.0800f);
-    make_specs.emplace_back("powerflex800", 6.0800f);
-    make_specs.emplace_back("powerflex820", 6.0800f);
-    make_specs.emplace_back("pregoda3", 5.3300f);
-    make_specs.emplace_back("pregoda4", 5.7500f);
-    make_specs.emplace_back("pregoda5", 5.7500f);
-    make_specs.emplace_back("pregoda6", 7.1100f);
-    make_specs.emplace_back("pregodp4200", 5.7500f);
-    make_specs.emplace_back("pregodp5200", 5.7500f);
-    make_specs.emplace_back("pregodp5300", 7.1100f);
-    make_specs.emplace_back("pregodp5500", 5.7500f);
-    make_specs.emplace_back("pregodp6000", 7.1100f);
-    make_specs.emplace_back("pregodp6200", 7.1100f);
-    make_specs.emplace_back("pregodp6300", 7.1100f);
-    make_specs.emplace_back("pregodp8300", 7.1100f);
-    make_specs.emplace_back("rcp10325x", 7.1100f);
-    make_specs.emplace_back("rcp5324", 5.7500f);
-    make_specs.emplace_back("rcp6324", 5.7500f);
-    make_specs.emplace_back("rcp7324", 5.7500f);
-    make_specs.emplace_back("rcp7325xs", 5.7500f);
-    make_specs.emplace_back("rcp7330x", 5.7500f);
-    make_specs.emplace_back("rcp7430xw", 5.7500f);
-    make_specs.emplace_back("rcp8325xs", 5.7500f);
-    make_specs.emplace_back("rcp8325x", 7.1100f);
-    make_specs.emplace_back("rcp8325", 5.7500f);
-    make_specs.emplace_back("rcp8330x", 5.7500f);
-    make_specs.emplace_back("rcp8427xw", 5.7500f);
-    make_specs.emplace_back("rcp8527x", 5.7500f);
-    make_specs.emplace_back("rcps10", 6.1600f);
-    make_specs.emplace_back("rcps8", 5.7500f);
-    make_specs.emplace_back("sportsline50", 6.1600f);
-    make_specs.emplace_back("sportsline60camouflage", 6.1600f);
-    make_specs.emplace_back("sportsline62", 6.1600f);
-    make_specs.emplace_back("sportsline90", 6.1600f);
-    make_specs.emplace_back("sportsline99", 6.1600f);
-    make_specs.emplace_back("x8compact", 5.7500f);
-    make_specs.emplace_back("x8sports", 5.7500f);
-    make_specs.emplace_back("x8", 5.7500f);
-    make_specs.emplace_back("xs10intouch", 6.1600f);
-    make_specs.emplace_back("xs10", 5.7500f);
-    make_specs.emplace_back("xs8crystal", 5.7500f);
-    make_specs.emplace_back("xs8", 5.7500f);
-  }
+constexpr CameraModelSpecs kSamsungModels[] = {
+    {"aq100", 6.0800f},
+    {"cl5", 5.7500f},
+    {"cl65", 6.0800f},
+    {"cl80", 6.1600f},
+    {"d75", 5.7500f},
+    {"d830", 7.1100f},
+    {"d85", 5.7500f},
+    {"d860", 5.7500f},
+    {"digimax101", 6.4000f},
+    {"digimax130", 4.5000f},
+    {"digimax200", 5.3300f},
+    {"digimax201", 4.5000f},
+    {"digimax202", 6.4000f},
+    {"digimax210se", 5.3300f},
+    {"digimax220se", 5.3300f},
+    {"digimax230", 5.3300f},
+    {"digimax240", 4.5000f},
+    {"digimax250", 4.5000f},
+    {"digimax301", 5.3300f},
+    {"digimax330", 7.5300f},
+    {"digimax340", 7.1100f},
+    {"digimax35mp3", 4.8000f},
+    {"digimax350se", 7.1100f},
+    {"digimax360", 7.1100f},
+    {"digimax370", 5.7500f},
+    {"digimax401", 5.7500f},
+    {"digimax410", 7.1100f},
+    {"digimax420", 7.1100f},
+    {"digimax430", 5.7500f},
+    {"digimax50duo", 4.8000f},
+    {"digimax530", 7.1100f},
+    {"digimaxa400", 5.7500f},
+    {"digimaxa402", 5.7500f},
+    {"digimaxa502", 5.7500f},
+    {"digimaxa503", 5.7500f},
+    {"digimaxa50", 5.7500f},
+    {"digimaxa55w", 5.7500f},
+    {"digimaxa5", 7.1100f},
+    {"digimaxa6", 7.1100f},
+    {"digimaxa7", 7.1100f},
+    {"digimaxd103", 7.1100f},
+    {"digimaxi50mp3", 5.7500f},
+    {"digimaxi5", 5.7500f},
+    {"digimaxi6", 5.7500f},
+    {"digimaxl50", 5.7500f},
+    {"digimaxl55w", 5.7500f},
+    {"digimaxl60", 5.7500f},
+    {"digimaxl70", 5.7500f},
+    {"digimaxl85", 7.1100f},
+    {"digimaxs1000", 7.1100f},
+    {"digimaxs500", 5.7500f},
+    {"digimaxs600", 5.7500f},
+    {"digimaxs700", 5.7500f},
+    {"digimaxs800", 7.1100f},
+    {"digimaxuca3", 5.3300f},
+    {"digimaxuca401", 5.7500f},
+    {"digimaxuca4", 5.7500f},
+    {"digimaxuca501", 5.7500f},
+    {"digimaxuca505", 5.7500f},
+    {"digimaxuca5", 5.7500f},
+    {"digimaxv3", 7.1100f},
+    {"digimaxv4000", 7.1100f},
+    {"digimaxv40", 7.1100f},
+    {"digimaxv4", 7.1100f},
+    {"digimaxv50", 7.1100f},
+    {"digimaxv5", 7.1100f},
+    {"digimaxv600", 7.1100f},
+    {"digimaxv6", 6.7400f},
+    {"digimaxv700", 7.1100f},
+    {"digimaxv70", 7.1100f},
+    {"digimaxv800", 7.1100f},
+    {"dv100", 6.1600f},
+    {"dv150f", 6.1600f},
+    {"dv300f", 6.1600f},
+    {"es10", 5.7500f},
+    {"es15", 6.0800f},
+    {"es17", 6.0800f},
+    {"es20", 6.0800f},
+    {"es25", 6.0800f},
+    {"es28", 6.0800f},
+    {"es30", 6.1600f},
+    {"es50", 6.0800f},
+    {"es55", 6.0800f},
+    {"es60", 6.0800f},
+    {"es65", 6.0800f},
+    {"es70", 6.0800f},
+    {"es73", 6.0800f},
+    {"es75", 6.0800f},
+    {"es80", 6.1600f},
+    {"es90", 6.1600f},
+    {"es95", 6.1600f},
+    {"ex1", 7.5300f},
+    {"ex2f", 7.5300f},
+    {"galaxycamera2", 6.1600f},
+    {"galaxycamera", 6.1600f},
+    {"galaxynx", 23.5000f},
+    {"gx10", 23.5000f},
+    {"gx1l", 23.5000f},
+    {"gx1s", 23.5000f},
+    {"gx20", 23.4000f},
+    {"hz10w", 6.0800f},
+    {"hz15w", 6.0800f},
+    {"hz25w", 6.0800f},
+    {"hz30w", 6.1600f},
+    {"hz35w", 6.1600f},
+    {"hz50w", 6.1600f},
+    {"i100", 6.0800f},
+    {"i70", 5.7500f},
+    {"i7", 5.7500f},
+    {"i80", 5.7500f},
+    {"i85", 5.7500f},
+    {"i8", 5.7500f},
+    {"it100", 6.0800f},
+    {"l100", 5.7500f},
+    {"l110", 5.7500f},
+    {"l200", 5.7500f},
+    {"l201", 6.0800f},
+    {"l210", 6.0800f},
+    {"l301", 6.0800f},
+    {"l310w", 7.4400f},
+    {"l700", 5.7500f},
+    {"l730", 5.7500f},
+    {"l73", 5.7500f},
+    {"l74wide", 5.7500f},
+    {"l74", 5.7500f},
+    {"l77", 5.7500f},
+    {"l80", 7.1100f},
+    {"l830", 5.7500f},
+    {"l83t", 5.7500f},
+    {"m100", 5.7500f},
+    {"miniketvpms10", 5.7500f},
+    {"miniketvpms11", 5.7500f},
+    {"miniketvpms15", 5.7500f},
+    {"mv800", 6.1600f},
+    {"nv100hd", 7.4400f},
+    {"nv10", 7.1100f},
+    {"nv11", 7.1100f},
+    {"nv15", 7.2700f},
+    {"nv20", 7.4400f},
+    {"nv24hd", 6.1600f},
+    {"nv30", 5.7500f},
+    {"nv3", 5.7500f},
+    {"nv40", 6.0800f},
+    {"nv4", 5.7500f},
+    {"nv7ops", 5.7500f},
+    {"nv8", 7.2700f},
+    {"nv9", 6.1600f},
+    {"nxmini", 13.2000f},
+    {"nx1000", 23.5000f},
+    {"nx100", 23.4000f},
+    {"nx10", 23.4000f},
+    {"nx1100", 23.5000f},
+    {"nx11", 23.4000f},
+    {"nx1", 23.5000f},
+    {"nx2000", 23.5000f},
+    {"nx200", 23.5000f},
+    {"nx20", 23.5000f},
+    {"nx210", 23.5000f},
+    {"nx3000", 23.5000f},
+    {"nx300", 23.5000f},
+    {"nx30", 23.5000f},
+    {"nx500", 23.5000f},
+    {"nx5", 23.4000f},
+    {"pl100", 6.0800f},
+    {"pl10", 5.7500f},
+    {"pl120", 6.1600f},
+    {"pl150", 6.0800f},
+    {"pl160", 6.0800f},
+    {"pl170", 6.0800f},
+    {"pl200", 6.1600f},
+    {"pl20", 6.1600f},
+    {"pl210", 6.1600f},
+    {"pl50", 6.0800f},
+    {"pl51", 6.1600f},
+    {"pl55", 6.0800f},
+    {"pl60", 6.0800f},
+    {"pl65", 6.0800f},
+    {"pl70", 6.0800f},
+    {"pl80", 6.0800f},
+    {"pl90", 6.0800f},
+    {"pro815", 8.8000f},
+    {"s1030", 7.1100f},
+    {"s1050", 7.1100f},
+    {"s1060", 6.0800f},
+    {"s1070", 6.0800f},
+    {"s630", 5.7500f},
+    {"s730", 5.7500f},
+    {"s750", 5.7500f},
+    {"s760", 5.7500f},
+    {"s830", 7.1100f},
+    {"s850", 7.1100f},
+    {"s85", 5.7500f},
+    {"s860", 5.7500f},
+    {"sdcms61", 5.7500f},
+    {"sh100", 6.0800f},
+    {"sl102", 6.0800f},
+    {"sl201", 6.0800f},
+    {"sl202", 6.0800f},
+    {"sl30", 6.0800f},
+    {"sl310w", 7.4400f},
+    {"sl502", 6.0800f},
+    {"sl50", 6.0800f},
+    {"sl600", 6.0800f},
+    {"sl605", 6.0800f},
+    {"sl620", 6.0800f},
+    {"sl630", 6.0800f},
+    {"sl720", 6.0800f},
+    {"sl820", 6.0800f},
+    {"st1000", 6.1600f},
+    {"st100", 6.1600f},
+    {"st10", 5.7500f},
+    {"st150f", 6.1600f},
+    {"st200f", 6.1600f},
+    {"st30", 4.8000f},
+    {"st45", 6.0800f},
+    {"st5000", 6.1600f},
+    {"st500", 6.1600f},
+    {"st50", 6.0800f},
+    {"st5500", 6.1600f},
+    {"st550", 6.0800f},
+    {"st600", 6.0800f},
+    {"st60", 6.1600f},
+    {"st6500", 6.0800f},
+    {"st65", 6.1600f},
+    {"st66", 6.1600f},
+    {"st700", 6.1600f},
+    {"st70", 6.1600f},
+    {"st72", 6.1600f},
+    {"st76", 6.1600f},
+    {"st77", 6.1600f},
+    {"st80", 6.0800f},
+    {"st88", 6.1600f},
+    {"st90", 6.1600f},
+    {"st93", 6.1600f},
+    {"st95", 6.1600f},
+    {"st96", 6.1600f},
+    {"tl100", 6.0800f},
+    {"tl105", 6.1600f},
+    {"tl110", 6.1600f},
+    {"tl205", 6.0800f},
+    {"tl210", 6.0800f},
+    {"tl220", 6.0800f},
+    {"tl225", 6.0800f},
+    {"tl240", 6.1600f},
+    {"tl320", 6.0800f},
+    {"tl34hd", 7.4400f},
+    {"tl350", 6.0800f},
+    {"tl500", 7.5300f},
+    {"tl9", 6.1600f},
+    {"wb1000", 6.0800f},
+    {"wb100", 6.1600f},
+    {"wb1100f", 6.1600f},
+    {"wb110", 6.1600f},
+    {"wb150f", 6.1600f},
+    {"wb2000", 6.0800f},
+    {"wb200f", 6.1600f},
+    {"wb2100", 6.1600f},
+    {"wb210", 6.1600f},
+    {"wb2200f", 6.1600f},
+    {"wb250f", 6.1600f},
+    {"wb30f", 6.1600f},
+    {"wb350f", 6.1600f},
+    {"wb35f", 6.1600f},
+    {"wb5000", 6.0800f},
+    {"wb500", 6.0800f},
+    {"wb50f", 6.1600f},
+    {"wb510", 6.0800f},
+    {"wb5500", 6.1600f},
+    {"wb550", 6.0800f},
+    {"wb560", 6.0800f},
+    {"wb600", 6.1600f},
+    {"wb650", 6.1600f},
+    {"wb660", 6.1600f},
+    {"wb690", 6.0800f},
+    {"wb700", 6.0800f},
+    {"wb750", 6.0800f},
+    {"wb800f", 6.1600f},
+    {"wb850f", 6.1600f},
+    {"wp10", 6.0800f},
+};
 
-  {
-    auto& make_specs = specs["samsung"];
-    make_specs.reserve(279);
-    make_specs.emplace_back("aq100", 6.0800f);
-    make_specs.emplace_back("cl5", 5.7500f);
-    make_specs.emplace_back("cl65", 6.0800f);
-    make_specs.emplace_back("cl80", 6.1600f);
-    make_specs.emplace_back("d75", 5.7500f);
-    make_specs.emplace_back("d830", 7.1100f);
-    make_specs.emplace_back("d85", 5.7500f);
-    make_specs.emplace_back("d860", 5.7500f);
-    make_specs.emplace_back("digimax101", 6.4000f);
-    make_specs.emplace_back("digimax130", 4.5000f);
-    make_specs.emplace_back("digimax200", 5.3300f);
-    make_specs.emplace_back("digimax201", 4.5000f);
-    make_specs.emplace_back("digimax202", 6.4000f);
-    make_specs.emplace_back("digimax210se", 5.3300f);
-    make_specs.emplace_back("digimax220se", 5.3300f);
-    make_specs.emplace_back("digimax230", 5.3300f);
-    make_specs.emplace_back("digimax240", 4.5000f);
-    make_specs.emplace_back("digimax250", 4.5000f);
-    make_specs.emplace_back("digimax301", 5.3300f);
-    make_specs.emplace_back("digimax330", 7.5300f);
-    make_specs.emplace_back("digimax340", 7.1100f);
-    make_specs.emplace_back("digimax35mp3", 4.8000f);
-    make_specs.emplace_back("digimax350se", 7.1100f);
-    make_specs.emplace_back("digimax360", 7.1100f);
-    make_specs.emplace_back("digimax370", 5.7500f);
-    make_specs.emplace_back("digimax401", 5.7500f);
-    make_specs.emplace_back("digimax410", 7.1100f);
-    make_specs.emplace_back("digimax420", 7.1100f);
-    make_specs.emplace_back("digimax430", 5.7500f);
-    make_specs.emplace_back("digimax50duo", 4.8000f);
-    make_specs.emplace_back("digimax530", 7.1100f);
-    make_specs.emplace_back("digimaxa400", 5.7500f);
-    make_specs.emplace_back("digimaxa402", 5.7500f);
-    make_specs.emplace_back("digimaxa502", 5.7500f);
-    make_specs.emplace_back("digimaxa503", 5.7500f);
-    make_specs.emplace_back("digimaxa50", 5.7500f);
-    make_specs.emplace_back("digimaxa55w", 5.7500f);
-    make_specs.emplace_back("digimaxa5", 7.1100f);
-    make_specs.emplace_back("digimaxa6", 7.1100f);
-    make_specs.emplace_back("digimaxa7", 7.1100f);
-    make_specs.emplace_back("digimaxd103", 7.1100f);
-    make_specs.emplace_back("digimaxi50mp3", 5.7500f);
-    make_specs.emplace_back("digimaxi5", 5.7500f);
-    make_specs.emplace_back("digimaxi6", 5.7500f);
-    make_specs.emplace_back("digimaxl50", 5.7500f);
-    make_specs.emplace_back("digimaxl55w", 5.7500f);
-    make_specs.emplace_back("digimaxl60", 5.7500f);
-    make_specs.emplace_back("digimaxl70", 5.7500f);
-    make_specs.emplace_back("digimaxl85", 7.1100f);
-    make_specs.emplace_back("digimaxs1000", 7.1100f);
-    make_specs.emplace_back("digimaxs500", 5.7500f);
-    make_specs.emplace_back("digimaxs600", 5.7500f);
-    make_specs.emplace_back("digimaxs700", 5.7500f);
-    make_specs.emplace_back("digimaxs800", 7.1100f);
-    make_specs.emplace_back("digimaxuca3", 5.3300f);
-    make_specs.emplace_back("digimaxuca401", 5.7500f);
-    make_specs.emplace_back("digimaxuca4", 5.7500f);
-    make_specs.emplace_back("digimaxuca501", 5.7500f);
-    make_specs.emplace_back("digimaxuca505", 5.7500f);
-    make_specs.emplace_back("digimaxuca5", 5.7500f);
-    make_specs.emplace_back("digimaxv3", 7.1100f);
-    make_specs.emplace_back("digimaxv4000", 7.1100f);
-    make_specs.emplace_back("digimaxv40", 7.1100f);
-    make_specs.emplace_back("digimaxv4", 7.1100f);
-    make_specs.emplace_back("digimaxv50", 7.1100f);
-    make_specs.emplace_back("digimaxv5", 7.1100f);
-    make_specs.emplace_back("digimaxv600", 7.1100f);
-    make_specs.emplace_back("digimaxv6", 6.7400f);
-    make_specs.emplace_back("digimaxv700", 7.1100f);
-    make_specs.emplace_back("digimaxv70", 7.1100f);
-    make_specs.emplace_back("digimaxv800", 7.1100f);
-    make_specs.emplace_back("dv100", 6.1600f);
-    make_specs.emplace_back("dv150f", 6.1600f);
-    make_specs.emplace_back("dv300f", 6.1600f);
-    make_specs.emplace_back("es10", 5.7500f);
-    make_specs.emplace_back("es15", 6.0800f);
-    make_specs.emplace_back("es17", 6.0800f);
-    make_specs.emplace_back("es20", 6.0800f);
-    make_specs.emplace_back("es25", 6.0800f);
-    make_specs.emplace_back("es28", 6.0800f);
-    make_specs.emplace_back("es30", 6.1600f);
-    make_specs.emplace_back("es50", 6.0800f);
-    make_specs.emplace_back("es55", 6.0800f);
-    make_specs.emplace_back("es60", 6.0800f);
-    make_specs.emplace_back("es65", 6.0800f);
-    make_specs.emplace_back("es70", 6.0800f);
-    make_specs.emplace_back("es73", 6.0800f);
-    make_specs.emplace_back("es75", 6.0800f);
-    make_specs.emplace_back("es80", 6.1600f);
-    make_specs.emplace_back("es90", 6.1600f);
-    make_specs.emplace_back("es95", 6.1600f);
-    make_specs.emplace_back("ex1", 7.5300f);
-    make_specs.emplace_back("ex2f", 7.5300f);
-    make_specs.emplace_back("galaxycamera2", 6.1600f);
-    make_specs.emplace_back("galaxycamera", 6.1600f);
-    make_specs.emplace_back("galaxynx", 23.5000f);
-    make_specs.emplace_back("gx10", 23.5000f);
-    make_specs.emplace_back("gx1l", 23.5000f);
-    make_specs.emplace_back("gx1s", 23.5000f);
-    make_specs.emplace_back("gx20", 23.4000f);
-    make_specs.emplace_back("hz10w", 6.0800f);
-    make_specs.emplace_back("hz15w", 6.0800f);
-    make_specs.emplace_back("hz25w", 6.0800f);
-    make_specs.emplace_back("hz30w", 6.1600f);
-    make_specs.emplace_back("hz35w", 6.1600f);
-    make_specs.emplace_back("hz50w", 6.1600f);
-    make_specs.emplace_back("i100", 6.0800f);
-    make_specs.emplace_back("i70", 5.7500f);
-    make_specs.emplace_back("i7", 5.7500f);
-    make_specs.emplace_back("i80", 5.7500f);
-    make_specs.emplace_back("i85", 5.7500f);
-    make_specs.emplace_back("i8", 5.7500f);
-    make_specs.emplace_back("it100", 6.0800f);
-    make_specs.emplace_back("l100", 5.7500f);
-    make_specs.emplace_back("l110", 5.7500f);
-    make_specs.emplace_back("l200", 5.7500f);
-    make_specs.emplace_back("l201", 6.0800f);
-    make_specs.emplace_back("l210", 6.0800f);
-    make_specs.emplace_back("l301", 6.0800f);
-    make_specs.emplace_back("l310w", 7.4400f);
-    make_specs.emplace_back("l700", 5.7500f);
-    make_specs.emplace_back("l730", 5.7500f);
-    make_specs.emplace_back("l73", 5.7500f);
-    make_specs.emplace_back("l74wide", 5.7500f);
-    make_specs.emplace_back("l74", 5.7500f);
-    make_specs.emplace_back("l77", 5.7500f);
-    make_specs.emplace_back("l80", 7.1100f);
-    make_specs.emplace_back("l830", 5.7500f);
-    make_specs.emplace_back("l83t", 5.7500f);
-    make_specs.emplace_back("m100", 5.7500f);
-    make_specs.emplace_back("miniketvpms10", 5.7500f);
-    make_specs.emplace_back("miniketvpms11", 5.7500f);
-    make_specs.emplace_back("miniketvpms15", 5.7500f);
-    make_specs.emplace_back("mv800", 6.1600f);
-    make_specs.emplace_back("nv100hd", 7.4400f);
-    make_specs.emplace_back("nv10", 7.1100f);
-    make_specs.emplace_back("nv11", 7.1100f);
-    make_specs.emplace_back("nv15", 7.2700f);
-    make_specs.emplace_back("nv20", 7.4400f);
-    make_specs.emplace_back("nv24hd", 6.1600f);
-    make_specs.emplace_back("nv30", 5.7500f);
-    make_specs.emplace_back("nv3", 5.7500f);
-    make_specs.emplace_back("nv40", 6.0800f);
-    make_specs.emplace_back("nv4", 5.7500f);
-    make_specs.emplace_back("nv7ops", 5.7500f);
-    make_specs.emplace_back("nv8", 7.2700f);
-    make_specs.emplace_back("nv9", 6.1600f);
-    make_specs.emplace_back("nxmini", 13.2000f);
-    make_specs.emplace_back("nx1000", 23.5000f);
-    make_specs.emplace_back("nx100", 23.4000f);
-    make_specs.emplace_back("nx10", 23.4000f);
-    make_specs.emplace_back("nx1100", 23.5000f);
-    make_specs.emplace_back("nx11", 23.4000f);
-    make_specs.emplace_back("nx1", 23.5000f);
-    make_specs.emplace_back("nx2000", 23.5000f);
-    make_specs.emplace_back("nx200", 23.5000f);
-    make_specs.emplace_back("nx20", 23.5000f);
-    make_specs.emplace_back("nx210", 23.5000f);
-    make_specs.emplace_back("nx3000", 23.5000f);
-    make_specs.emplace_back("nx300", 23.5000f);
-    make_specs.emplace_back("nx30", 23.5000f);
-    make_specs.emplace_back("nx500", 23.5000f);
-    make_specs.emplace_back("nx5", 23.4000f);
-    make_specs.emplace_back("pl100", 6.0800f);
-    make_specs.emplace_back("pl10", 5.7500f);
-    make_specs.emplace_back("pl120", 6.1600f);
-    make_specs.emplace_back("pl150", 6.0800f);
-    make_specs.emplace_back("pl160", 6.0800f);
-    make_specs.emplace_back("pl170", 6.0800f);
-    make_specs.emplace_back("pl200", 6.1600f);
-    make_specs.emplace_back("pl20", 6.1600f);
-    make_specs.emplace_back("pl210", 6.1600f);
-    make_specs.emplace_back("pl50", 6.0800f);
-    make_specs.emplace_back("pl51", 6.1600f);
-    make_specs.emplace_back("pl55", 6.0800f);
-    make_specs.emplace_back("pl60", 6.0800f);
-    make_specs.emplace_back("pl65", 6.0800f);
-    make_specs.emplace_back("pl70", 6.0800f);
-    make_specs.emplace_back("pl80", 6.0800f);
-    make_specs.emplace_back("pl90", 6.0800f);
-    make_specs.emplace_back("pro815", 8.8000f);
-    make_specs.emplace_back("s1030", 7.1100f);
-    make_specs.emplace_back("s1050", 7.1100f);
-    make_specs.emplace_back("s1060", 6.0800f);
-    make_specs.emplace_back("s1070", 6.0800f);
-    make_specs.emplace_back("s630", 5.7500f);
-    make_specs.emplace_back("s730", 5.7500f);
-    make_specs.emplace_back("s750", 5.7500f);
-    make_specs.emplace_back("s760", 5.7500f);
-    make_specs.emplace_back("s830", 7.1100f);
-    make_specs.emplace_back("s850", 7.1100f);
-    make_specs.emplace_back("s85", 5.7500f);
-    make_specs.emplace_back("s860", 5.7500f);
-    make_specs.emplace_back("sdcms61", 5.7500f);
-    make_specs.emplace_back("sh100", 6.0800f);
-    make_specs.emplace_back("sl102", 6.0800f);
-    make_specs.emplace_back("sl201", 6.0800f);
-    make_specs.emplace_back("sl202", 6.0800f);
-    make_specs.emplace_back("sl30", 6.0800f);
-    make_specs.emplace_back("sl310w", 7.4400f);
-    make_specs.emplace_back("sl502", 6.0800f);
-    make_specs.emplace_back("sl50", 6.0800f);
-    make_specs.emplace_back("sl600", 6.0800f);
-    make_specs.emplace_back("sl605", 6.0800f);
-    make_specs.emplace_back("sl620", 6.0800f);
-    make_specs.emplace_back("sl630", 6.0800f);
-    make_specs.emplace_back("sl720", 6.0800f);
-    make_specs.emplace_back("sl820", 6.0800f);
-    make_specs.emplace_back("st1000", 6.1600f);
-    make_specs.emplace_back("st100", 6.1600f);
-    make_specs.emplace_back("st10", 5.7500f);
-    make_specs.emplace_back("st150f", 6.1600f);
-    make_specs.emplace_back("st200f", 6.1600f);
-    make_specs.emplace_back("st30", 4.8000f);
-    make_specs.emplace_back("st45", 6.0800f);
-    make_specs.emplace_back("st5000", 6.1600f);
-    make_specs.emplace_back("st500", 6.1600f);
-    make_specs.emplace_back("st50", 6.0800f);
-    make_specs.emplace_back("st5500", 6.1600f);
-    make_specs.emplace_back("st550", 6.0800f);
-    make_specs.emplace_back("st600", 6.0800f);
-    make_specs.emplace_back("st60", 6.1600f);
-    make_specs.emplace_back("st6500", 6.0800f);
-    make_specs.emplace_back("st65", 6.1600f);
-    make_specs.emplace_back("st66", 6.1600f);
-    make_specs.emplace_back("st700", 6.1600f);
-    make_specs.emplace_back("st70", 6.1600f);
-    make_specs.emplace_back("st72", 6.1600f);
-    make_specs.emplace_back("st76", 6.1600f);
-    make_specs.emplace_back("st77", 6.1600f);
-    make_specs.emplace_back("st80", 6.0800f);
-    make_specs.emplace_back("st88", 6.1600f);
-    make_specs.emplace_back("st90", 6.1600f);
-    make_specs.emplace_back("st93", 6.1600f);
-    make_specs.emplace_back("st95", 6.1600f);
-    make_specs.emplace_back("st96", 6.1600f);
-    make_specs.emplace_back("tl100", 6.0800f);
-    make_specs.emplace_back("tl105", 6.1600f);
-    make_specs.emplace_back("tl110", 6.1600f);
-    make_specs.emplace_back("tl205", 6.0800f);
-    make_specs.emplace_back("tl210", 6.0800f);
-    make_specs.emplace_back("tl220", 6.0800f);
-    make_specs.emplace_back("tl225", 6.0800f);
-    make_specs.emplace_back("tl240", 6.1600f);
-    make_specs.emplace_back("tl320", 6.0800f);
-    make_specs.emplace_back("tl34hd", 7.4400f);
-    make_specs.emplace_back("tl350", 6.0800f);
-    make_specs.emplace_back("tl500", 7.5300f);
-    make_specs.emplace_back("tl9", 6.1600f);
-    make_specs.emplace_back("wb1000", 6.0800f);
-    make_specs.emplace_back("wb100", 6.1600f);
-    make_specs.emplace_back("wb1100f", 6.1600f);
-    make_specs.emplace_back("wb110", 6.1600f);
-    make_specs.emplace_back("wb150f", 6.1600f);
-    make_specs.emplace_back("wb2000", 6.0800f);
-    make_specs.emplace_back("wb200f", 6.1600f);
-    make_specs.emplace_back("wb2100", 6.1600f);
-    make_specs.emplace_back("wb210", 6.1600f);
-    make_specs.emplace_back("wb2200f", 6.1600f);
-    make_specs.emplace_back("wb250f", 6.1600f);
-    make_specs.emplace_back("wb30f", 6.1600f);
-    make_specs.emplace_back("wb350f", 6.1600f);
-    make_specs.emplace_back("wb35f", 6.1600f);
-    make_specs.emplace_back("wb5000", 6.0800f);
-    make_specs.emplace_back("wb500", 6.0800f);
-    make_specs.emplace_back("wb50f", 6.1600f);
-    make_specs.emplace_back("wb510", 6.0800f);
-    make_specs.emplace_back("wb5500", 6.1600f);
-    make_specs.emplace_back("wb550", 6.0800f);
-    make_specs.emplace_back("wb560", 6.0800f);
-    make_specs.emplace_back("wb600", 6.1600f);
-    make_specs.emplace_back("wb650", 6.1600f);
-    make_specs.emplace_back("wb660", 6.1600f);
-    make_specs.emplace_back("wb690", 6.0800f);
-    make_specs.emplace_back("wb700", 6.0800f);
-    make_specs.emplace_back("wb750", 6.0800f);
-    make_specs.emplace_back("wb800f", 6.1600f);
-    make_specs.emplace_back("wb850f", 6.1600f);
-    make_specs.emplace_back("wp10", 6.0800f);
-  }
+constexpr CameraModelSpecs kSanyoModels[] = {
+    {"dscs1", 5.3300f},
+    {"dscs3", 5.3300f},
+    {"dscs4", 5.7500f},
+    {"dscs5", 5.7500f},
+    {"vpca5", 5.7500f},
+    {"vpcaz1", 7.1100f},
+    {"vpcaz3ex", 7.1100f},
+    {"vpce1090", 6.1600f},
+    {"vpce1403", 6.1600f},
+    {"vpce1500tp", 6.0800f},
+    {"vpce890", 5.7500f},
+    {"vpchd1ex", 5.7500f},
+    {"vpcj1ex", 5.3300f},
+    {"vpcj2ex", 5.3300f},
+    {"vpcj4ex", 5.3300f},
+    {"vpcmz1", 7.1100f},
+    {"vpcmz2", 7.1100f},
+    {"vpcs1085", 6.0800f},
+    {"vpcs122", 6.1600f},
+    {"vpcs1275", 6.1600f},
+    {"vpcs1414", 6.0800f},
+    {"vpcs885", 5.7500f},
+    {"vpct1495", 6.0800f},
+    {"vpcx1200", 6.1600f},
+    {"vpcx1220", 6.1600f},
+    {"vpcx1420", 6.1600f},
+    {"xactic1", 5.3300f},
+    {"xactic40", 5.3300f},
+    {"xactic4", 5.3300f},
+    {"xactic5", 5.7500f},
+    {"xactic6", 5.7500f},
+    {"xactidmxca65", 5.7500f},
+    {"xactidmxca8", 5.7500f},
+    {"xactidmxcg65", 5.7500f},
+    {"xactidmxcg9", 6.0800f},
+    {"xactidmxhd700", 5.7500f},
+    {"xactidmxhd800", 5.7500f},
+    {"xactie60", 5.7500f},
+    {"xactie6", 5.7500f},
+    {"xactis50", 5.7500f},
+    {"xactis60", 5.7500f},
+    {"xactis6", 5.7500f},
+    {"xactis70", 5.7500f},
+    {"xactivpc503", 5.7500f},
+    {"xactivpc603", 5.7500f},
+    {"xactivpcca6", 5.7500f},
+    {"xactivpcca9", 5.7500f},
+    {"xactivpccg10", 6.0800f},
+    {"xactivpccg6", 5.7500f},
+    {"xactivpce1075", 6.0800f},
+    {"xactivpce10", 6.1600f},
+    {"xactivpce760", 5.7500f},
+    {"xactivpce7", 5.7500f},
+    {"xactivpce860", 5.7500f},
+    {"xactivpce870", 5.7500f},
+    {"xactivpce875", 5.7500f},
+    {"xactivpchd1a", 5.7500f},
+    {"xactivpchd2000", 5.7500f},
+    {"xactivpchd2", 5.7500f},
+    {"xactivpcs1ex", 5.3300f},
+    {"xactivpcs1070", 6.0800f},
+    {"xactivpcs3ex", 5.3300f},
+    {"xactivpcs4ex", 5.7500f},
+    {"xactivpcs500", 5.7500f},
+    {"xactivpcs600", 5.7500f},
+    {"xactivpcs650", 5.7500f},
+    {"xactivpcs670", 5.7500f},
+    {"xactivpcs750", 5.7500f},
+    {"xactivpcs760", 5.7500f},
+    {"xactivpcs770", 5.7500f},
+    {"xactivpcs7", 5.7500f},
+    {"xactivpcs870", 5.7500f},
+    {"xactivpcs880", 5.7500f},
+    {"xactivpct1060", 6.0800f},
+    {"xactivpct700", 5.7500f},
+    {"xactivpct850", 5.7500f},
+    {"xactivpcw800", 5.7500f},
+    {"xactivpcx1200", 6.1600f},
+};
 
-  {
-    auto& make_specs = specs["sanyo"];
-    make_specs.reserve(78);
-    make_specs.emplace_back("dscs1", 5.3300f);
-    make_specs.emplace_back("dscs3", 5.3300f);
-    make_specs.emplace_back("dscs4", 5.7500f);
-    make_specs.emplace_back("dscs5", 5.7500f);
-    make_specs.emplace_back("vpca5", 5.7500f);
-    make_specs.emplace_back("vpcaz1", 7.1100f);
-    make_specs.emplace_back("vpcaz3ex", 7.1100f);
-    make_specs.emplace_back("vpce1090", 6.1600f);
-    make_specs.emplace_back("vpce1403", 6.1600f);
-    make_specs.emplace_back("vpce1500tp", 6.0800f);
-    make_specs.emplace_back("vpce890", 5.7500f);
-    make_specs.emplace_back("vpchd1ex", 5.7500f);
-    make_specs.emplace_back("vpcj1ex", 5.3300f);
-    make_specs.emplace_back("vpcj2ex", 5.3300f);
-    make_specs.emplace_back("vpcj4ex", 5.3300f);
-    make_specs.emplace_back("vpcmz1", 7.1100f);
-    make_specs.emplace_back("vpcmz2", 7.1100f);
-    make_specs.emplace_back("vpcs1085", 6.0800f);
-    make_specs.emplace_back("vpcs122", 6.1600f);
-    make_specs.emplace_back("vpcs1275", 6.1600f);
-    make_specs.emplace_back("vpcs1414", 6.0800f);
-    make_specs.emplace_back("vpcs885", 5.7500f);
-    make_specs.emplace_back("vpct1495", 6.0800f);
-    make_specs.emplace_back("vpcx1200", 6.1600f);
-    make_specs.emplace_back("vpcx1220", 6.1600f);
-    make_specs.emplace_back("vpcx1420", 6.1600f);
-    make_specs.emplace_back("xactic1", 5.3300f);
-    make_specs.emplace_back("xactic40", 5.3300f);
-    make_specs.emplace_back("xactic4", 5.3300f);
-    make_specs.emplace_back("xactic5", 5.7500f);
-    make_specs.emplace_back("xactic6", 5.7500f);
-    make_specs.emplace_back("xactidmxca65", 5.7500f);
-    make_specs.emplace_back("xactidmxca8", 5.7500f);
-    make_specs.emplace_back("xactidmxcg65", 5.7500f);
-    make_specs.emplace_back("xactidmxcg9", 6.0800f);
-    make_specs.emplace_back("xactidmxhd700", 5.7500f);
-    make_specs.emplace_back("xactidmxhd800", 5.7500f);
-    make_specs.emplace_back("xactie60", 5.7500f);
-    make_specs.emplace_back("xactie6", 5.7500f);
-    make_specs.emplace_back("xactis50", 5.7500f);
-    make_specs.emplace_back("xactis60", 5.7500f);
-    make_specs.emplace_back("xactis6", 5.7500f);
-    make_specs.emplace_back("xactis70", 5.7500f);
-    make_specs.emplace_back("xactivpc503", 5.7500f);
-    make_specs.emplace_back("xactivpc603", 5.7500f);
-    make_specs.emplace_back("xactivpcca6", 5.7500f);
-    make_specs.emplace_back("xactivpcca9", 5.7500f);
-    make_specs.emplace_back("xactivpccg10", 6.0800f);
-    make_specs.emplace_back("xactivpccg6", 5.7500f);
-    make_specs.emplace_back("xactivpce1075", 6.0800f);
-    make_specs.emplace_back("xactivpce10", 6.1600f);
-    make_specs.emplace_back("xactivpce760", 5.7500f);
-    make_specs.emplace_back("xactivpce7", 5.7500f);
-    make_specs.emplace_back("xactivpce860", 5.7500f);
-    make_specs.emplace_back("xactivpce870", 5.7500f);
-    make_specs.emplace_back("xactivpce875", 5.7500f);
-    make_specs.emplace_back("xactivpchd1a", 5.7500f);
-    make_specs.emplace_back("xactivpchd2000", 5.7500f);
-    make_specs.emplace_back("xactivpchd2", 5.7500f);
-    make_specs.emplace_back("xactivpcs1ex", 5.3300f);
-    make_specs.emplace_back("xactivpcs1070", 6.0800f);
-    make_specs.emplace_back("xactivpcs3ex", 5.3300f);
-    make_specs.emplace_back("xactivpcs4ex", 5.7500f);
-    make_specs.emplace_back("xactivpcs500", 5.7500f);
-    make_specs.emplace_back("xactivpcs600", 5.7500f);
-    make_specs.emplace_back("xactivpcs650", 5.7500f);
-    make_specs.emplace_back("xactivpcs670", 5.7500f);
-    make_specs.emplace_back("xactivpcs750", 5.7500f);
-    make_specs.emplace_back("xactivpcs760", 5.7500f);
-    make_specs.emplace_back("xactivpcs770", 5.7500f);
-    make_specs.emplace_back("xactivpcs7", 5.7500f);
-    make_specs.emplace_back("xactivpcs870", 5.7500f);
-    make_specs.emplace_back("xactivpcs880", 5.7500f);
-    make_specs.emplace_back("xactivpct1060", 6.0800f);
-    make_specs.emplace_back("xactivpct700", 5.7500f);
-    make_specs.emplace_back("xactivpct850", 5.7500f);
-    make_specs.emplace_back("xactivpcw800", 5.7500f);
-    make_specs.emplace_back("xactivpcx1200", 6.1600f);
-  }
+constexpr CameraModelSpecs kSigmaModels[] = {
+    {"dp1merrill", 24.0000f},
+    {"dp1s", 20.7000f},
+    {"dp1x", 20.7000f},
+    {"dp1", 20.7000f},
+    {"dp2merrill", 24.0000f},
+    {"dp2s", 20.7000f},
+    {"dp2x", 20.7000f},
+    {"dp2", 20.7000f},
+    {"dp3merrill", 24.0000f},
+    {"sd1merrill", 24.0000f},
+    {"sd10", 20.7000f},
+    {"sd14", 20.7000f},
+    {"sd15", 20.7000f},
+    {"sd1", 24.0000f},
+    {"sd9", 20.7000f},
+};
 
-  {
-    auto& make_specs = specs["sigma"];
-    make_specs.reserve(15);
-    make_specs.emplace_back("dp1merrill", 24.0000f);
-    make_specs.emplace_back("dp1s", 20.7000f);
-    make_specs.emplace_back("dp1x", 20.7000f);
-    make_specs.emplace_back("dp1", 20.7000f);
-    make_specs.emplace_back("dp2merrill", 24.0000f);
-    make_specs.emplace_back("dp2s", 20.7000f);
-    make_specs.emplace_back("dp2x", 20.7000f);
-    make_specs.emplace_back("dp2", 20.7000f);
-    make_specs.emplace_back("dp3merrill", 24.0000f);
-    make_specs.emplace_back("sd1merrill", 24.0000f);
-    make_specs.emplace_back("sd10", 20.7000f);
-    make_specs.emplace_back("sd14", 20.7000f);
-    make_specs.emplace_back("sd15", 20.7000f);
-    make_specs.emplace_back("sd1", 24.0000f);
-    make_specs.emplace_back("sd9", 20.7000f);
-  }
+constexpr CameraModelSpecs kSonyModels[] = {
+    {"a77ii", 23.5000f},
+    {"alpha7ii", 35.8000f},
+    {"alpha7r", 35.9000f},
+    {"alpha7rii", 35.9000f},
+    {"alpha7sii", 35.6000f},
+    {"alpha7s", 35.6000f},
+    {"alpha7", 35.8000f},
+    {"alphaa3000", 23.5000f},
+    {"alphaa5000", 23.5000f},
+    {"alphaa5100", 23.5000f},
+    {"alphaa6000", 23.5000f},
+    {"alphadslra100", 23.6000f},
+    {"alphadslra200", 23.6000f},
+    {"alphadslra230", 23.5000f},
+    {"alphadslra290", 23.5000f},
+    {"alphadslra300", 23.6000f},
+    {"alphadslra330", 23.5000f},
+    {"alphadslra350", 23.6000f},
+    {"alphadslra380", 23.6000f},
+    {"alphadslra390", 23.5000f},
+    {"alphadslra450", 23.4000f},
+    {"alphadslra500", 23.5000f},
+    {"alphadslra550", 23.4000f},
+    {"alphadslra560", 23.5000f},
+    {"alphadslra580", 23.5000f},
+    {"alphadslra700", 23.5000f},
+    {"alphadslra850", 35.9000f},
+    {"alphadslra900", 35.9000f},
+    {"alphanex3n", 23.5000f},
+    {"alphanex3", 23.4000f},
+    {"alphanex5n", 23.4000f},
+    {"alphanex5r", 23.4000f},
+    {"alphanex5t", 23.4000f},
+    {"alphanex5", 23.4000f},
+    {"alphanex7", 23.5000f},
+    {"alphanexc3", 23.4000f},
+    {"alphanexf3", 23.4000f},
+    {"alphanex6", 23.5000f},
+    {"cybershotdscrx1rii", 35.9000f},
+    {"cybershotdscrx1", 35.8000f},
+    {"cybershotdscd700", 6.4000f},
+    {"cybershotdscd770", 6.4000f},
+    {"cybershotdscf505v", 7.1100f},
+    {"cybershotdscf505", 6.4000f},
+    {"cybershotdscf55v", 7.1100f},
+    {"cybershotdscf55", 6.4000f},
+    {"cybershotdscf707", 8.8000f},
+    {"cybershotdscf717", 8.8000f},
+    {"cybershotdscf77", 7.1100f},
+    {"cybershotdscf828", 8.8000f},
+    {"cybershotdscf88", 5.9000f},
+    {"cybershotdscfx77", 7.1100f},
+    {"cybershotdscg1", 5.7500f},
+    {"cybershotdscg3", 6.1600f},
+    {"cybershotdsch100", 6.1600f},
+    {"cybershotdsch10", 5.7500f},
+    {"cybershotdsch1", 5.7500f},
+    {"cybershotdsch200", 6.1600f},
+    {"cybershotdsch20", 6.1600f},
+    {"cybershotdsch2", 5.7500f},
+    {"cybershotdsch300", 6.1600f},
+    {"cybershotdsch3", 5.7500f},
+    {"cybershotdsch400", 6.1600f},
+    {"cybershotdsch50", 6.1600f},
+    {"cybershotdsch55", 6.1600f},
+    {"cybershotdsch5", 5.7500f},
+    {"cybershotdsch70", 6.1600f},
+    {"cybershotdsch7", 5.7500f},
+    {"cybershotdsch90", 6.1600f},
+    {"cybershotdsch9", 5.7500f},
+    {"cybershotdschx100v", 6.1600f},
+    {"cybershotdschx10v", 6.1600f},
+    {"cybershotdschx1", 5.9000f},
+    {"cybershotdschx200v", 6.1600f},
+    {"cybershotdschx20v", 6.1600f},
+    {"cybershotdschx300", 6.1600f},
+    {"cybershotdschx30v", 6.1600f},
+    {"cybershotdschx400", 6.1600f},
+    {"cybershotdschx50", 6.1600f},
+    {"cybershotdschx5", 5.9000f},
+    {"cybershotdschx60", 6.1600f},
+    {"cybershotdschx7v", 6.1600f},
+    {"cybershotdschx90v", 6.1600f},
+    {"cybershotdschx9v", 6.1600f},
+    {"cybershotdscj10", 6.1600f},
+    {"cybershotdscl1", 5.3300f},
+    {"cybershotdscm1", 5.9000f},
+    {"cybershotdscm2", 5.7500f},
+    {"cybershotdscn1", 7.1100f},
+    {"cybershotdscn2", 7.5300f},
+    {"cybershotdscp100", 7.1100f},
+    {"cybershotdscp10", 7.1100f},
+    {"cybershotdscp120", 7.1100f},
+    {"cybershotdscp12", 7.1100f},
+    {"cybershotdscp150", 7.1100f},
+    {"cybershotdscp1", 7.1100f},
+    {"cybershotdscp200", 7.1100f},
+    {"cybershotdscp20", 5.3300f},
+    {"cybershotdscp2", 5.3300f},
+    {"cybershotdscp30", 5.3300f},
+    {"cybershotdscp31", 5.3300f},
+    {"cybershotdscp32", 5.3300f},
+    {"cybershotdscp3", 7.1100f},
+    {"cybershotdscp41", 5.3300f},
+    {"cybershotdscp43", 5.3300f},
+    {"cybershotdscp50", 5.3300f},
+    {"cybershotdscp51", 5.3300f},
+    {"cybershotdscp52", 5.3300f},
+    {"cybershotdscp5", 7.1100f},
+    {"cybershotdscp71", 7.1100f},
+    {"cybershotdscp72", 7.1100f},
+    {"cybershotdscp73", 5.3300f},
+    {"cybershotdscp7", 7.1100f},
+    {"cybershotdscp8", 5.3300f},
+    {"cybershotdscp92", 7.1100f},
+    {"cybershotdscp93", 7.1100f},
+    {"cybershotdscp9", 7.1100f},
+    {"cybershotdscqx100", 13.2000f},
+    {"cybershotdscqx10", 6.1600f},
+    {"cybershotdscr1", 21.5000f},
+    {"cybershotdscrx10ii", 13.2000f},
+    {"cybershotdscrx100iii", 13.2000f},
+    {"cybershotdscrx100ii", 13.2000f},
+    {"cybershotdscrx100iv", 13.2000f},
+    {"cybershotdscrx100", 13.2000f},
+    {"cybershotdscrx10", 13.2000f},
+    {"cybershotdscrx1r", 35.8000f},
+    {"cybershotdscs2000", 6.1600f},
+    {"cybershotdscs2100", 6.1600f},
+    {"cybershotdscs3000", 4.9600f},
+    {"cybershotdscs30", 5.3300f},
+    {"cybershotdscs40", 5.3300f},
+    {"cybershotdscs45", 5.7500f},
+    {"cybershotdscs5000", 6.1600f},
+    {"cybershotdscs50", 5.3300f},
+    {"cybershotdscs600", 5.7500f},
+    {"cybershotdscs60", 5.3300f},
+    {"cybershotdscs650", 5.7500f},
+    {"cybershotdscs700", 5.7500f},
+    {"cybershotdscs70", 7.1100f},
+    {"cybershotdscs730", 5.7500f},
+    {"cybershotdscs750", 5.7500f},
+    {"cybershotdscs75", 7.1100f},
+    {"cybershotdscs780", 5.7500f},
+    {"cybershotdscs800", 7.1100f},
+    {"cybershotdscs80", 5.3300f},
+    {"cybershotdscs85", 7.1100f},
+    {"cybershotdscs90", 5.3300f},
+    {"cybershotdscs930", 6.0800f},
+    {"cybershotdscs950", 6.1600f},
+    {"cybershotdscs980", 6.0800f},
+    {"cybershotdsct100", 5.7500f},
+    {"cybershotdsct10", 5.7500f},
+    {"cybershotdsct110", 6.1600f},
+    {"cybershotdsct11", 5.9000f},
+    {"cybershotdsct1", 5.9000f},
+    {"cybershotdsct200", 5.7500f},
+    {"cybershotdsct20", 5.7500f},
+    {"cybershotdsct2", 5.7500f},
+    {"cybershotdsct300", 6.1600f},
+    {"cybershotdsct30", 5.7500f},
+    {"cybershotdsct33", 5.9000f},
+    {"cybershotdsct3", 5.9000f},
+    {"cybershotdsct500", 6.1600f},
+    {"cybershotdsct50", 5.7500f},
+    {"cybershotdsct5", 5.7500f},
+    {"cybershotdsct700", 6.1600f},
+    {"cybershotdsct70", 5.7500f},
+    {"cybershotdsct77", 6.1600f},
+    {"cybershotdsct7", 5.9000f},
+    {"cybershotdsct900", 6.1600f},
+    {"cybershotdsct90", 6.1600f},
+    {"cybershotdsct99", 6.1600f},
+    {"cybershotdsct9", 5.7500f},
+    {"cybershotdsctf1", 6.1600f},
+    {"cybershotdsctx100v", 6.1600f},
+    {"cybershotdsctx10", 6.1600f},
+    {"cybershotdsctx1", 5.9000f},
+    {"cybershotdsctx200v", 6.1600f},
+    {"cybershotdsctx20", 6.1600f},
+    {"cybershotdsctx30", 6.1600f},
+    {"cybershotdsctx55", 6.1600f},
+    {"cybershotdsctx5", 5.9000f},
+    {"cybershotdsctx66", 6.1600f},
+    {"cybershotdsctx7", 5.9000f},
+    {"cybershotdsctx9", 6.1600f},
+    {"cybershotdscu10", 5.3300f},
+    {"cybershotdscu20", 5.3300f},
+    {"cybershotdscu30", 5.3300f},
+    {"cybershotdscu40", 5.3300f},
+    {"cybershotdscu50", 5.3300f},
+    {"cybershotdscu60", 5.3300f},
+    {"cybershotdscv1", 7.1100f},
+    {"cybershotdscv3", 7.1100f},
+    {"cybershotdscw100", 7.1100f},
+    {"cybershotdscw110", 5.7500f},
+    {"cybershotdscw115", 5.7500f},
+    {"cybershotdscw120", 5.7500f},
+    {"cybershotdscw125", 5.7500f},
+    {"cybershotdscw12", 7.1100f},
+    {"cybershotdscw130", 5.7500f},
+    {"cybershotdscw150", 5.7500f},
+    {"cybershotdscw170", 6.1600f},
+    {"cybershotdscw17", 7.1100f},
+    {"cybershotdscw180", 6.0800f},
+    {"cybershotdscw190", 6.0800f},
+    {"cybershotdscw1", 7.1100f},
+    {"cybershotdscw200", 7.5300f},
+    {"cybershotdscw210", 6.1600f},
+    {"cybershotdscw215", 6.1600f},
+    {"cybershotdscw220", 6.1600f},
+    {"cybershotdscw230", 6.1600f},
+    {"cybershotdscw270", 7.5300f},
+    {"cybershotdscw275", 6.1600f},
+    {"cybershotdscw290", 6.1600f},
+    {"cybershotdscw300", 7.5300f},
+    {"cybershotdscw30", 5.7500f},
+    {"cybershotdscw310", 6.1600f},
+    {"cybershotdscw320", 6.1600f},
+    {"cybershotdscw330", 6.1600f},
+    {"cybershotdscw350", 6.1600f},
+    {"cybershotdscw35", 5.7500f},
+    {"cybershotdscw360", 6.1600f},
+    {"cybershotdscw370", 6.1600f},
+    {"cybershotdscw380", 6.1600f},
+    {"cybershotdscw40", 5.7500f},
+    {"cybershotdscw50", 5.7500f},
+    {"cybershotdscw510", 6.1600f},
+    {"cybershotdscw520", 6.1600f},
+    {"cybershotdscw530", 6.1600f},
+    {"cybershotdscw550", 6.1600f},
+    {"cybershotdscw55", 5.7500f},
+    {"cybershotdscw560", 6.1600f},
+    {"cybershotdscw570", 6.1600f},
+    {"cybershotdscw580", 6.1600f},
+    {"cybershotdscw5", 7.1100f},
+    {"cybershotdscw610", 6.1600f},
+    {"cybershotdscw620", 6.1600f},
+    {"cybershotdscw630", 6.1600f},
+    {"cybershotdscw650", 6.1600f},
+    {"cybershotdscw670", 6.1600f},
+    {"cybershotdscw690", 6.1600f},
+    {"cybershotdscw70", 5.7500f},
+    {"cybershotdscw710", 6.1600f},
+    {"cybershotdscw730", 6.1600f},
+    {"cybershotdscw7", 7.1100f},
+    {"cybershotdscw800", 6.1600f},
+    {"cybershotdscw80", 5.7500f},
+    {"cybershotdscw810", 6.1600f},
+    {"cybershotdscw830", 6.1600f},
+    {"cybershotdscw85", 5.7500f},
+    {"cybershotdscw90", 5.7500f},
+    {"cybershotdscwx100", 6.1600f},
+    {"cybershotdscwx10", 6.1600f},
+    {"cybershotdscwx150", 6.1600f},
+    {"cybershotdscwx1", 5.9000f},
+    {"cybershotdscwx200", 6.1600f},
+    {"cybershotdscwx220", 6.1600f},
+    {"cybershotdscwx300", 6.1600f},
+    {"cybershotdscwx30", 6.1600f},
+    {"cybershotdscwx350", 6.1600f},
+    {"cybershotdscwx500", 6.1600f},
+    {"cybershotdscwx50", 6.1600f},
+    {"cybershotdscwx5", 6.1600f},
+    {"cybershotdscwx60", 6.1600f},
+    {"cybershotdscwx70", 6.1600f},
+    {"cybershotdscwx7", 6.1600f},
+    {"cybershotdscwx80", 6.1600f},
+    {"cybershotdscwx9", 6.1600f},
+    {"mavicacd1000", 5.3300f},
+    {"mavicacd200", 5.3300f},
+    {"mavicacd250", 5.3300f},
+    {"mavicacd300", 7.1100f},
+    {"mavicacd350", 5.3300f},
+    {"mavicacd400", 7.1100f},
+    {"mavicacd500", 7.1100f},
+    {"mavicafd100", 5.3300f},
+    {"mavicafd200", 5.3300f},
+    {"mavicafd71", 6.4000f},
+    {"mavicafd73", 6.4000f},
+    {"mavicafd75", 7.1100f},
+    {"mavicafd81", 4.8000f},
+    {"mavicafd83", 4.8000f},
+    {"mavicafd85", 5.3300f},
+    {"mavicafd87", 5.3300f},
+    {"mavicafd88", 4.8000f},
+    {"mavicafd90", 5.3300f},
+    {"mavicafd91", 4.8000f},
+    {"mavicafd92", 5.3300f},
+    {"mavicafd95", 5.3300f},
+    {"mavicafd97", 5.3300f},
+    {"qx1", 23.5000f},
+    {"qx30", 6.1600f},
+    {"slta33", 23.5000f},
+    {"slta35", 23.5000f},
+    {"slta37", 23.5000f},
+    {"slta55", 23.5000f},
+    {"slta57", 23.5000f},
+    {"slta58", 23.2000f},
+    {"slta65", 23.5000f},
+    {"slta77", 23.5000f},
+    {"slta99", 35.8000f},
+};
 
-  {
-    auto& make_specs = specs["sony"];
-    make_specs.reserve(302);
-    make_specs.emplace_back("a77ii", 23.5000f);
-    make_specs.emplace_back("alpha7ii", 35.8000f);
-    make_specs.emplace_back("alpha7r", 35.9000f);
-    make_specs.emplace_back("alpha7rii", 35.9000f);
-    make_specs.emplace_back("alpha7sii", 35.6000f);
-    make_specs.emplace_back("alpha7s", 35.6000f);
-    make_specs.emplace_back("alpha7", 35.8000f);
-    make_specs.emplace_back("alphaa3000", 23.5000f);
-    make_specs.emplace_back("alphaa5000", 23.5000f);
-    make_specs.emplace_back("alphaa5100", 23.5000f);
-    make_specs.emplace_back("alphaa6000", 23.5000f);
-    make_specs.emplace_back("alphadslra100", 23.6000f);
-    make_specs.emplace_back("alphadslra200", 23.6000f);
-    make_specs.emplace_back("alphadslra230", 23.5000f);
-    make_specs.emplace_back("alphadslra290", 23.5000f);
-    make_specs.emplace_back("alphadslra300", 23.6000f);
-    make_specs.emplace_back("alphadslra330", 23.5000f);
-    make_specs.emplace_back("alphadslra350", 23.6000f);
-    make_specs.emplace_back("alphadslra380", 23.6000f);
-    make_specs.emplace_back("alphadslra390", 23.5000f);
-    make_specs.emplace_back("alphadslra450", 23.4000f);
-    make_specs.emplace_back("alphadslra500", 23.5000f);
-    make_specs.emplace_back("alphadslra550", 23.4000f);
-    make_specs.emplace_back("alphadslra560", 23.5000f);
-    make_specs.emplace_back("alphadslra580", 23.5000f);
-    make_specs.emplace_back("alphadslra700", 23.5000f);
-    make_specs.emplace_back("alphadslra850", 35.9000f);
-    make_specs.emplace_back("alphadslra900", 35.9000f);
-    make_specs.emplace_back("alphanex3n", 23.5000f);
-    make_specs.emplace_back("alphanex3", 23.4000f);
-    make_specs.emplace_back("alphanex5n", 23.4000f);
-    make_specs.emplace_back("alphanex5r", 23.4000f);
-    make_specs.emplace_back("alphanex5t", 23.4000f);
-    make_specs.emplace_back("alphanex5", 23.4000f);
-    make_specs.emplace_back("alphanex7", 23.5000f);
-    make_specs.emplace_back("alphanexc3", 23.4000f);
-    make_specs.emplace_back("alphanexf3", 23.4000f);
-    make_specs.emplace_back("alphanex6", 23.5000f);
-    make_specs.emplace_back("cybershotdscrx1rii", 35.9000f);
-    make_specs.emplace_back("cybershotdscrx1", 35.8000f);
-    make_specs.emplace_back("cybershotdscd700", 6.4000f);
-    make_specs.emplace_back("cybershotdscd770", 6.4000f);
-    make_specs.emplace_back("cybershotdscf505v", 7.1100f);
-    make_specs.emplace_back("cybershotdscf505", 6.4000f);
-    make_specs.emplace_back("cybershotdscf55v", 7.1100f);
-    make_specs.emplace_back("cybershotdscf55", 6.4000f);
-    make_specs.emplace_back("cybershotdscf707", 8.8000f);
-    make_specs.emplace_back("cybershotdscf717", 8.8000f);
-    make_specs.emplace_back("cybershotdscf77", 7.1100f);
-    make_specs.emplace_back("cybershotdscf828", 8.8000f);
-    make_specs.emplace_back("cybershotdscf88", 5.9000f);
-    make_specs.emplace_back("cybershotdscfx77", 7.1100f);
-    make_specs.emplace_back("cybershotdscg1", 5.7500f);
-    make_specs.emplace_back("cybershotdscg3", 6.1600f);
-    make_specs.emplace_back("cybershotdsch100", 6.1600f);
-    make_specs.emplace_back("cybershotdsch10", 5.7500f);
-    make_specs.emplace_back("cybershotdsch1", 5.7500f);
-    make_specs.emplace_back("cybershotdsch200", 6.1600f);
-    make_specs.emplace_back("cybershotdsch20", 6.1600f);
-    make_specs.emplace_back("cybershotdsch2", 5.7500f);
-    make_specs.emplace_back("cybershotdsch300", 6.1600f);
-    make_specs.emplace_back("cybershotdsch3", 5.7500f);
-    make_specs.emplace_back("cybershotdsch400", 6.1600f);
-    make_specs.emplace_back("cybershotdsch50", 6.1600f);
-    make_specs.emplace_back("cybershotdsch55", 6.1600f);
-    make_specs.emplace_back("cybershotdsch5", 5.7500f);
-    make_specs.emplace_back("cybershotdsch70", 6.1600f);
-    make_specs.emplace_back("cybershotdsch7", 5.7500f);
-    make_specs.emplace_back("cybershotdsch90", 6.1600f);
-    make_specs.emplace_back("cybershotdsch9", 5.7500f);
-    make_specs.emplace_back("cybershotdschx100v", 6.1600f);
-    make_specs.emplace_back("cybershotdschx10v", 6.1600f);
-    make_specs.emplace_back("cybershotdschx1", 5.9000f);
-    make_specs.emplace_back("cybershotdschx200v", 6.1600f);
-    make_specs.emplace_back("cybershotdschx20v", 6.1600f);
-    make_specs.emplace_back("cybershotdschx300", 6.1600f);
-    make_specs.emplace_back("cybershotdschx30v", 6.1600f);
-    make_specs.emplace_back("cybershotdschx400", 6.1600f);
-    make_specs.emplace_back("cybershotdschx50", 6.1600f);
-    make_specs.emplace_back("cybershotdschx5", 5.9000f);
-    make_specs.emplace_back("cybershotdschx60", 6.1600f);
-    make_specs.emplace_back("cybershotdschx7v", 6.1600f);
-    make_specs.emplace_back("cybershotdschx90v", 6.1600f);
-    make_specs.emplace_back("cybershotdschx9v", 6.1600f);
-    make_specs.emplace_back("cybershotdscj10", 6.1600f);
-    make_specs.emplace_back("cybershotdscl1", 5.3300f);
-    make_specs.emplace_back("cybershotdscm1", 5.9000f);
-    make_specs.emplace_back("cybershotdscm2", 5.7500f);
-    make_specs.emplace_back("cybershotdscn1", 7.1100f);
-    make_specs.emplace_back("cybershotdscn2", 7.5300f);
-    make_specs.emplace_back("cybershotdscp100", 7.1100f);
-    make_specs.emplace_back("cybershotdscp10", 7.1100f);
-    make_specs.emplace_back("cybershotdscp120", 7.1100f);
-    make_specs.emplace_back("cybershotdscp12", 7.1100f);
-    make_specs.emplace_back("cybershotdscp150", 7.1100f);
-    make_specs.emplace_back("cybershotdscp1", 7.1100f);
-    make_specs.emplace_back("cybershotdscp200", 7.1100f);
-    make_specs.emplace_back("cybershotdscp20", 5.3300f);
-    make_specs.emplace_back("cybershotdscp2", 5.3300f);
-    make_specs.emplace_back("cybershotdscp30", 5.3300f);
-    make_specs.emplace_back("cybershotdscp31", 5.3300f);
-    make_specs.emplace_back("cybershotdscp32", 5.3300f);
-    make_specs.emplace_back("cybershotdscp3", 7.1100f);
-    make_specs.emplace_back("cybershotdscp41", 5.3300f);
-    make_specs.emplace_back("cybershotdscp43", 5.3300f);
-    make_specs.emplace_back("cybershotdscp50", 5.3300f);
-    make_specs.emplace_back("cybershotdscp51", 5.3300f);
-    make_specs.emplace_back("cybershotdscp52", 5.3300f);
-    make_specs.emplace_back("cybershotdscp5", 7.1100f);
-    make_specs.emplace_back("cybershotdscp71", 7.1100f);
-    make_specs.emplace_back("cybershotdscp72", 7.1100f);
-    make_specs.emplace_back("cybershotdscp73", 5.3300f);
-    make_specs.emplace_back("cybershotdscp7", 7.1100f);
-    make_specs.emplace_back("cybershotdscp8", 5.3300f);
-    make_specs.emplace_back("cybershotdscp92", 7.1100f);
-    make_specs.emplace_back("cybershotdscp93", 7.1100f);
-    make_specs.emplace_back("cybershotdscp9", 7.1100f);
-    make_specs.emplace_back("cybershotdscqx100", 13.2000f);
-    make_specs.emplace_back("cybershotdscqx10", 6.1600f);
-    make_specs.emplace_back("cybershotdscr1", 21.5000f);
-    make_specs.emplace_back("cybershotdscrx10ii", 13.2000f);
-    make_specs.emplace_back("cybershotdscrx100iii", 13.2000f);
-    make_specs.emplace_back("cybershotdscrx100ii", 13.2000f);
-    make_specs.emplace_back("cybershotdscrx100iv", 13.2000f);
-    make_specs.emplace_back("cybershotdscrx100", 13.2000f);
-    make_specs.emplace_back("cybershotdscrx10", 13.2000f);
-    make_specs.emplace_back("cybershotdscrx1r", 35.8000f);
-    make_specs.emplace_back("cybershotdscs2000", 6.1600f);
-    make_specs.emplace_back("cybershotdscs2100", 6.1600f);
-    make_specs.emplace_back("cybershotdscs3000", 4.9600f);
-    make_specs.emplace_back("cybershotdscs30", 5.3300f);
-    make_specs.emplace_back("cybershotdscs40", 5.3300f);
-    make_specs.emplace_back("cybershotdscs45", 5.7500f);
-    make_specs.emplace_back("cybershotdscs5000", 6.1600f);
-    make_specs.emplace_back("cybershotdscs50", 5.3300f);
-    make_specs.emplace_back("cybershotdscs600", 5.7500f);
-    make_specs.emplace_back("cybershotdscs60", 5.3300f);
-    make_specs.emplace_back("cybershotdscs650", 5.7500f);
-    make_specs.emplace_back("cybershotdscs700", 5.7500f);
-    make_specs.emplace_back("cybershotdscs70", 7.1100f);
-    make_specs.emplace_back("cybershotdscs730", 5.7500f);
-    make_specs.emplace_back("cybershotdscs750", 5.7500f);
-    make_specs.emplace_back("cybershotdscs75", 7.1100f);
-    make_specs.emplace_back("cybershotdscs780", 5.7500f);
-    make_specs.emplace_back("cybershotdscs800", 7.1100f);
-    make_specs.emplace_back("cybershotdscs80", 5.3300f);
-    make_specs.emplace_back("cybershotdscs85", 7.1100f);
-    make_specs.emplace_back("cybershotdscs90", 5.3300f);
-    make_specs.emplace_back("cybershotdscs930", 6.0800f);
-    make_specs.emplace_back("cybershotdscs950", 6.1600f);
-    make_specs.emplace_back("cybershotdscs980", 6.0800f);
-    make_specs.emplace_back("cybershotdsct100", 5.7500f);
-    make_specs.emplace_back("cybershotdsct10", 5.7500f);
-    make_specs.emplace_back("cybershotdsct110", 6.1600f);
-    make_specs.emplace_back("cybershotdsct11", 5.9000f);
-    make_specs.emplace_back("cybershotdsct1", 5.9000f);
-    make_specs.emplace_back("cybershotdsct200", 5.7500f);
-    make_specs.emplace_back("cybershotdsct20", 5.7500f);
-    make_specs.emplace_back("cybershotdsct2", 5.7500f);
-    make_specs.emplace_back("cybershotdsct300", 6.1600f);
-    make_specs.emplace_back("cybershotdsct30", 5.7500f);
-    make_specs.emplace_back("cybershotdsct33", 5.9000f);
-    make_specs.emplace_back("cybershotdsct3", 5.9000f);
-    make_specs.emplace_back("cybershotdsct500", 6.1600f);
-    make_specs.emplace_back("cybershotdsct50", 5.7500f);
-    make_specs.emplace_back("cybershotdsct5", 5.7500f);
-    make_specs.emplace_back("cybershotdsct700", 6.1600f);
-    make_specs.emplace_back("cybershotdsct70", 5.7500f);
-    make_specs.emplace_back("cybershotdsct77", 6.1600f);
-    make_specs.emplace_back("cybershotdsct7", 5.9000f);
-    make_specs.emplace_back("cybershotdsct900", 6.1600f);
-    make_specs.emplace_back("cybershotdsct90", 6.1600f);
-    make_specs.emplace_back("cybershotdsct99", 6.1600f);
-    make_specs.emplace_back("cybershotdsct9", 5.7500f);
-    make_specs.emplace_back("cybershotdsctf1", 6.1600f);
-    make_specs.emplace_back("cybershotdsctx100v", 6.1600f);
-    make_specs.emplace_back("cybershotdsctx10", 6.1600f);
-    make_specs.emplace_back("cybershotdsctx1", 5.9000f);
-    make_specs.emplace_back("cybershotdsctx200v", 6.1600f);
-    make_specs.emplace_back("cybershotdsctx20", 6.1600f);
-    make_specs.emplace_back("cybershotdsctx30", 6.1600f);
-    make_specs.emplace_back("cybershotdsctx55", 6.1600f);
-    make_specs.emplace_back("cybershotdsctx5", 5.9000f);
-    make_specs.emplace_back("cybershotdsctx66", 6.1600f);
-    make_specs.emplace_back("cybershotdsctx7", 5.9000f);
-    make_specs.emplace_back("cybershotdsctx9", 6.1600f);
-    make_specs.emplace_back("cybershotdscu10", 5.3300f);
-    make_specs.emplace_back("cybershotdscu20", 5.3300f);
-    make_specs.emplace_back("cybershotdscu30", 5.3300f);
-    make_specs.emplace_back("cybershotdscu40", 5.3300f);
-    make_specs.emplace_back("cybershotdscu50", 5.3300f);
-    make_specs.emplace_back("cybershotdscu60", 5.3300f);
-    make_specs.emplace_back("cybershotdscv1", 7.1100f);
-    make_specs.emplace_back("cybershotdscv3", 7.1100f);
-    make_specs.emplace_back("cybershotdscw100", 7.1100f);
-    make_specs.emplace_back("cybershotdscw110", 5.7500f);
-    make_specs.emplace_back("cybershotdscw115", 5.7500f);
-    make_specs.emplace_back("cybershotdscw120", 5.7500f);
-    make_specs.emplace_back("cybershotdscw125", 5.7500f);
-    make_specs.emplace_back("cybershotdscw12", 7.1100f);
-    make_specs.emplace_back("cybershotdscw130", 5.7500f);
-    make_specs.emplace_back("cybershotdscw150", 5.7500f);
-    make_specs.emplace_back("cybershotdscw170", 6.1600f);
-    make_specs.emplace_back("cybershotdscw17", 7.1100f);
-    make_specs.emplace_back("cybershotdscw180", 6.0800f);
-    make_specs.emplace_back("cybershotdscw190", 6.0800f);
-    make_specs.emplace_back("cybershotdscw1", 7.1100f);
-    make_specs.emplace_back("cybershotdscw200", 7.5300f);
-    make_specs.emplace_back("cybershotdscw210", 6.1600f);
-    make_specs.emplace_back("cybershotdscw215", 6.1600f);
-    make_specs.emplace_back("cybershotdscw220", 6.1600f);
-    make_specs.emplace_back("cybershotdscw230", 6.1600f);
-    make_specs.emplace_back("cybershotdscw270", 7.5300f);
-    make_specs.emplace_back("cybershotdscw275", 6.1600f);
-    make_specs.emplace_back("cybershotdscw290", 6.1600f);
-    make_specs.emplace_back("cybershotdscw300", 7.5300f);
-    make_specs.emplace_back("cybershotdscw30", 5.7500f);
-    make_specs.emplace_back("cybershotdscw310", 6.1600f);
-    make_specs.emplace_back("cybershotdscw320", 6.1600f);
-    make_specs.emplace_back("cybershotdscw330", 6.1600f);
-    make_specs.emplace_back("cybershotdscw350", 6.1600f);
-    make_specs.emplace_back("cybershotdscw35", 5.7500f);
-    make_specs.emplace_back("cybershotdscw360", 6.1600f);
-    make_specs.emplace_back("cybershotdscw370", 6.1600f);
-    make_specs.emplace_back("cybershotdscw380", 6.1600f);
-    make_specs.emplace_back("cybershotdscw40", 5.7500f);
-    make_specs.emplace_back("cybershotdscw50", 5.7500f);
-    make_specs.emplace_back("cybershotdscw510", 6.1600f);
-    make_specs.emplace_back("cybershotdscw520", 6.1600f);
-    make_specs.emplace_back("cybershotdscw530", 6.1600f);
-    make_specs.emplace_back("cybershotdscw550", 6.1600f);
-    make_specs.emplace_back("cybershotdscw55", 5.7500f);
-    make_specs.emplace_back("cybershotdscw560", 6.1600f);
-    make_specs.emplace_back("cybershotdscw570", 6.1600f);
-    make_specs.emplace_back("cybershotdscw580", 6.1600f);
-    make_specs.emplace_back("cybershotdscw5", 7.1100f);
-    make_specs.emplace_back("cybershotdscw610", 6.1600f);
-    make_specs.emplace_back("cybershotdscw620", 6.1600f);
-    make_specs.emplace_back("cybershotdscw630", 6.1600f);
-    make_specs.emplace_back("cybershotdscw650", 6.1600f);
-    make_specs.emplace_back("cybershotdscw670", 6.1600f);
-    make_specs.emplace_back("cybershotdscw690", 6.1600f);
-    make_specs.emplace_back("cybershotdscw70", 5.7500f);
-    make_specs.emplace_back("cybershotdscw710", 6.1600f);
-    make_specs.emplace_back("cybershotdscw730", 6.1600f);
-    make_specs.emplace_back("cybershotdscw7", 7.1100f);
-    make_specs.emplace_back("cybershotdscw800", 6.1600f);
-    make_specs.emplace_back("cybershotdscw80", 5.7500f);
-    make_specs.emplace_back("cybershotdscw810", 6.1600f);
-    make_specs.emplace_back("cybershotdscw830", 6.1600f);
-    make_specs.emplace_back("cybershotdscw85", 5.7500f);
-    make_specs.emplace_back("cybershotdscw90", 5.7500f);
-    make_specs.emplace_back("cybershotdscwx100", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx10", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx150", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx1", 5.9000f);
-    make_specs.emplace_back("cybershotdscwx200", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx220", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx300", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx30", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx350", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx500", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx50", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx5", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx60", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx70", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx7", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx80", 6.1600f);
-    make_specs.emplace_back("cybershotdscwx9", 6.1600f);
-    make_specs.emplace_back("mavicacd1000", 5.3300f);
-    make_specs.emplace_back("mavicacd200", 5.3300f);
-    make_specs.emplace_back("mavicacd250", 5.3300f);
-    make_specs.emplace_back("mavicacd300", 7.1100f);
-    make_specs.emplace_back("mavicacd350", 5.3300f);
-    make_specs.emplace_back("mavicacd400", 7.1100f);
-    make_specs.emplace_back("mavicacd500", 7.1100f);
-    make_specs.emplace_back("mavicafd100", 5.3300f);
-    make_specs.emplace_back("mavicafd200", 5.3300f);
-    make_specs.emplace_back("mavicafd71", 6.4000f);
-    make_specs.emplace_back("mavicafd73", 6.4000f);
-    make_specs.emplace_back("mavicafd75", 7.1100f);
-    make_specs.emplace_back("mavicafd81", 4.8000f);
-    make_specs.emplace_back("mavicafd83", 4.8000f);
-    make_specs.emplace_back("mavicafd85", 5.3300f);
-    make_specs.emplace_back("mavicafd87", 5.3300f);
-    make_specs.emplace_back("mavicafd88", 4.8000f);
-    make_specs.emplace_back("mavicafd90", 5.3300f);
-    make_specs.emplace_back("mavicafd91", 4.8000f);
-    make_specs.emplace_back("mavicafd92", 5.3300f);
-    make_specs.emplace_back("mavicafd95", 5.3300f);
-    make_specs.emplace_back("mavicafd97", 5.3300f);
-    make_specs.emplace_back("qx1", 23.5000f);
-    make_specs.emplace_back("qx30", 6.1600f);
-    make_specs.emplace_back("slta33", 23.5000f);
-    make_specs.emplace_back("slta35", 23.5000f);
-    make_specs.emplace_back("slta37", 23.5000f);
-    make_specs.emplace_back("slta55", 23.5000f);
-    make_specs.emplace_back("slta57", 23.5000f);
-    make_specs.emplace_back("slta58", 23.2000f);
-    make_specs.emplace_back("slta65", 23.5000f);
-    make_specs.emplace_back("slta77", 23.5000f);
-    make_specs.emplace_back("slta99", 35.8000f);
-  }
+constexpr CameraModelSpecs kToshibaModels[] = {
+    {"pdr2300", 5.3300f},
+    {"pdr3300", 7.1100f},
+    {"pdr3310", 7.1100f},
+    {"pdr3320", 7.1100f},
+    {"pdr4300", 7.1100f},
+    {"pdr5300", 7.1100f},
+    {"pdrm25", 5.3300f},
+    {"pdrm500", 5.3300f},
+    {"pdrm5", 6.4000f},
+    {"pdrm60", 6.4000f},
+    {"pdrm61", 6.4000f},
+    {"pdrm65", 6.4000f},
+    {"pdrm700", 5.3300f},
+    {"pdrm70", 7.1100f},
+    {"pdrm71", 7.1100f},
+    {"pdrm81", 7.1100f},
+    {"pdrt10", 5.3300f},
+    {"pdrt20", 5.3300f},
+    {"pdrt30", 5.3300f},
+};
 
-  {
-    auto& make_specs = specs["toshiba"];
-    make_specs.reserve(19);
-    make_specs.emplace_back("pdr2300", 5.3300f);
-    make_specs.emplace_back("pdr3300", 7.1100f);
-    make_specs.emplace_back("pdr3310", 7.1100f);
-    make_specs.emplace_back("pdr3320", 7.1100f);
-    make_specs.emplace_back("pdr4300", 7.1100f);
-    make_specs.emplace_back("pdr5300", 7.1100f);
-    make_specs.emplace_back("pdrm25", 5.3300f);
-    make_specs.emplace_back("pdrm500", 5.3300f);
-    make_specs.emplace_back("pdrm5", 6.4000f);
-    make_specs.emplace_back("pdrm60", 6.4000f);
-    make_specs.emplace_back("pdrm61", 6.4000f);
-    make_specs.emplace_back("pdrm65", 6.4000f);
-    make_specs.emplace_back("pdrm700", 5.3300f);
-    make_specs.emplace_back("pdrm70", 7.1100f);
-    make_specs.emplace_back("pdrm71", 7.1100f);
-    make_specs.emplace_back("pdrm81", 7.1100f);
-    make_specs.emplace_back("pdrt10", 5.3300f);
-    make_specs.emplace_back("pdrt20", 5.3300f);
-    make_specs.emplace_back("pdrt30", 5.3300f);
-  }
+constexpr CameraModelSpecs kVivitarModels[] = {
+    {"v8025", 7.1100f},
+    {"vivicam5105s", 5.7500f},
+    {"vivicam5150s", 5.7500f},
+    {"vivicam5160s", 5.7500f},
+    {"vivicam5195", 5.7500f},
+    {"vivicam5350s", 5.7500f},
+    {"vivicam5355", 5.7500f},
+    {"vivicam5385", 5.7500f},
+    {"vivicam5386", 5.7500f},
+    {"vivicam5388", 5.7500f},
+    {"vivicam6150s", 5.7500f},
+    {"vivicam6200w", 5.7500f},
+    {"vivicam6300", 5.7500f},
+    {"vivicam6320", 5.7500f},
+    {"vivicam6326", 5.7500f},
+    {"vivicam6330", 5.7500f},
+    {"vivicam6380u", 5.7500f},
+    {"vivicam6385u", 5.7500f},
+    {"vivicam6388s", 5.7500f},
+    {"vivicam7100s", 5.7500f},
+    {"vivicam7310", 5.7500f},
+    {"vivicam7388s", 5.7500f},
+    {"vivicam7500i", 5.7500f},
+    {"vivicam8300s", 7.1100f},
+    {"vivicam8400", 7.1100f},
+    {"vivicam8600s", 7.1100f},
+    {"vivicam8600", 7.1100f},
+    {"vivicam8625", 7.1100f},
+    {"vivicamx30", 7.1100f},
+    {"vivicamx60", 7.1100f},
+};
 
-  {
-    auto& make_specs = specs["vivitar"];
-    make_specs.reserve(30);
-    make_specs.emplace_back("v8025", 7.1100f);
-    make_specs.emplace_back("vivicam5105s", 5.7500f);
-    make_specs.emplace_back("vivicam5150s", 5.7500f);
-    make_specs.emplace_back("vivicam5160s", 5.7500f);
-    make_specs.emplace_back("vivicam5195", 5.7500f);
-    make_specs.emplace_back("vivicam5350s", 5.7500f);
-    make_specs.emplace_back("vivicam5355", 5.7500f);
-    make_specs.emplace_back("vivicam5385", 5.7500f);
-    make_specs.emplace_back("vivicam5386", 5.7500f);
-    make_specs.emplace_back("vivicam5388", 5.7500f);
-    make_specs.emplace_back("vivicam6150s", 5.7500f);
-    make_specs.emplace_back("vivicam6200w", 5.7500f);
-    make_specs.emplace_back("vivicam6300", 5.7500f);
-    make_specs.emplace_back("vivicam6320", 5.7500f);
-    make_specs.emplace_back("vivicam6326", 5.7500f);
-    make_specs.emplace_back("vivicam6330", 5.7500f);
-    make_specs.emplace_back("vivicam6380u", 5.7500f);
-    make_specs.emplace_back("vivicam6385u", 5.7500f);
-    make_specs.emplace_back("vivicam6388s", 5.7500f);
-    make_specs.emplace_back("vivicam7100s", 5.7500f);
-    make_specs.emplace_back("vivicam7310", 5.7500f);
-    make_specs.emplace_back("vivicam7388s", 5.7500f);
-    make_specs.emplace_back("vivicam7500i", 5.7500f);
-    make_specs.emplace_back("vivicam8300s", 7.1100f);
-    make_specs.emplace_back("vivicam8400", 7.1100f);
-    make_specs.emplace_back("vivicam8600s", 7.1100f);
-    make_specs.emplace_back("vivicam8600", 7.1100f);
-    make_specs.emplace_back("vivicam8625", 7.1100f);
-    make_specs.emplace_back("vivicamx30", 7.1100f);
-    make_specs.emplace_back("vivicamx60", 7.1100f);
-  }
+constexpr CameraModelSpecs kYakumoModels[] = {
+    {"cammastersd432", 5.3300f},
+    {"cammastersd482", 5.7500f},
+    {"megaimage34", 5.3300f},
+    {"megaimage35", 7.1100f},
+    {"megaimage37", 5.7500f},
+    {"megaimage410", 5.7500f},
+    {"megaimage45", 7.1100f},
+    {"megaimage47sl", 5.7500f},
+    {"megaimage47sx", 7.1100f},
+    {"megaimage47", 5.7500f},
+    {"megaimage55cx", 7.1100f},
+    {"megaimage57x", 7.1100f},
+    {"megaimage57", 7.1100f},
+    {"megaimage610x", 7.1100f},
+    {"megaimage67x", 7.1100f},
+    {"megaimage811x", 7.1100f},
+    {"megaimage84d", 5.7500f},
+    {"megaimage85d", 5.7500f},
+    {"megaimageii", 7.1100f},
+    {"megaimageiv", 7.1100f},
+    {"megaimagevii", 6.4000f},
+    {"megaimagevi", 7.1100f},
+    {"megaimagexl", 4.2300f},
+    {"megaimagexs", 6.4000f},
+    {"megaimagex", 7.1100f},
+};
 
-  {
-    auto& make_specs = specs["yakumo"];
-    make_specs.reserve(25);
-    make_specs.emplace_back("cammastersd432", 5.3300f);
-    make_specs.emplace_back("cammastersd482", 5.7500f);
-    make_specs.emplace_back("megaimage34", 5.3300f);
-    make_specs.emplace_back("megaimage35", 7.1100f);
-    make_specs.emplace_back("megaimage37", 5.7500f);
-    make_specs.emplace_back("megaimage410", 5.7500f);
-    make_specs.emplace_back("megaimage45", 7.1100f);
-    make_specs.emplace_back("megaimage47sl", 5.7500f);
-    make_specs.emplace_back("megaimage47sx", 7.1100f);
-    make_specs.emplace_back("megaimage47", 5.7500f);
-    make_specs.emplace_back("megaimage55cx", 7.1100f);
-    make_specs.emplace_back("megaimage57x", 7.1100f);
-    make_specs.emplace_back("megaimage57", 7.1100f);
-    make_specs.emplace_back("megaimage610x", 7.1100f);
-    make_specs.emplace_back("megaimage67x", 7.1100f);
-    make_specs.emplace_back("megaimage811x", 7.1100f);
-    make_specs.emplace_back("megaimage84d", 5.7500f);
-    make_specs.emplace_back("megaimage85d", 5.7500f);
-    make_specs.emplace_back("megaimageii", 7.1100f);
-    make_specs.emplace_back("megaimageiv", 7.1100f);
-    make_specs.emplace_back("megaimagevii", 6.4000f);
-    make_specs.emplace_back("megaimagevi", 7.1100f);
-    make_specs.emplace_back("megaimagexl", 4.2300f);
-    make_specs.emplace_back("megaimagexs", 6.4000f);
-    make_specs.emplace_back("megaimagex", 7.1100f);
+constexpr CameraMakeSpecs kCameraMakeSpecs[] = {
+    {"acer", kAcerModels, std::size(kAcerModels)},
+    {"agfaphoto", kAgfaphotoModels, std::size(kAgfaphotoModels)},
+    {"benq", kBenqModels, std::size(kBenqModels)},
+    {"canon", kCanonModels, std::size(kCanonModels)},
+    {"casio", kCasioModels, std::size(kCasioModels)},
+    {"concord", kConcordModels, std::size(kConcordModels)},
+    {"contax", kContaxModels, std::size(kContaxModels)},
+    {"epson", kEpsonModels, std::size(kEpsonModels)},
+    {"fujifilm", kFujifilmModels, std::size(kFujifilmModels)},
+    {"ge", kGeModels, std::size(kGeModels)},
+    {"hp", kHpModels, std::size(kHpModels)},
+    {"jenoptik", kJenoptikModels, std::size(kJenoptikModels)},
+    {"jvc", kJvcModels, std::size(kJvcModels)},
+    {"kodak", kKodakModels, std::size(kKodakModels)},
+    {"konica", kKonicaModels, std::size(kKonicaModels)},
+    {"konica-minolta", kKonicaMinoltaModels, std::size(kKonicaMinoltaModels)},
+    {"kyocera", kKyoceraModels, std::size(kKyoceraModels)},
+    {"leica", kLeicaModels, std::size(kLeicaModels)},
+    {"minolta", kMinoltaModels, std::size(kMinoltaModels)},
+    {"minox", kMinoxModels, std::size(kMinoxModels)},
+    {"nikon", kNikonModels, std::size(kNikonModels)},
+    {"nokia", kNokiaModels, std::size(kNokiaModels)},
+    {"olympus", kOlympusModels, std::size(kOlympusModels)},
+    {"panasonic", kPanasonicModels, std::size(kPanasonicModels)},
+    {"pentax", kPentaxModels, std::size(kPentaxModels)},
+    {"praktica", kPrakticaModels, std::size(kPrakticaModels)},
+    {"ricoh", kRicohModels, std::size(kRicohModels)},
+    {"rollei", kRolleiModels, std::size(kRolleiModels)},
+    {"samsung", kSamsungModels, std::size(kSamsungModels)},
+    {"sanyo", kSanyoModels, std::size(kSanyoModels)},
+    {"sigma", kSigmaModels, std::size(kSigmaModels)},
+    {"sony", kSonyModels, std::size(kSonyModels)},
+    {"toshiba", kToshibaModels, std::size(kToshibaModels)},
+    {"vivitar", kVivitarModels, std::size(kVivitarModels)},
+    {"yakumo", kYakumoModels, std::size(kYakumoModels)},
+};
+
+constexpr bool IsSortedByMake(const CameraMakeSpecs* makes,
+                              const size_t num_makes) {
+  for (size_t i = 1; i < num_makes; ++i) {
+    if (!(makes[i - 1].make < makes[i].make)) {
+      return false;
+    }
   }
+  return true;
+}
+
+static_assert(IsSortedByMake(kCameraMakeSpecs, std::size(kCameraMakeSpecs)),
+              "Camera makes must be unique and sorted.");
+
+}  // namespace
 
-  return specs;
+CameraSpecs GetCameraSpecs() {
+  return {kCameraMakeSpecs, std::size(kCameraMakeSpecs)};
 }
 
 }  // namespace colmap
@@ -29,16 +29,39 @@
 
 #pragma once
 
-#include <string>
-#include <unordered_map>
-#include <vector>
+#include <cstddef>
+#include <string_view>
 
 namespace colmap {
 
-// { make1 : ({ model1 : sensor-width in mm }, ...), ... }
-typedef std::vector<std::pair<std::string, float>> camera_make_specs_t;
-typedef std::unordered_map<std::string, camera_make_specs_t> camera_specs_t;
+// Sensor width in mm of a camera model.
+struct CameraModelSpecs {
+  std::string_view model;
+  float sensor_width;
+};
 
-camera_specs_t InitializeCameraSpecs();
+// Camera models of a make.
+struct CameraMakeSpecs {
+  std::string_view make;
+  const CameraModelSpecs* models;
+  size_t num_models;
+
+  const CameraModelSpecs* begin() const { return models; }
+  const CameraModelSpecs* end() const { return models + num_models; }
+};
+
+// Camera makes sorted by name.
+struct CameraSpecs {
+  const CameraMakeSpecs* makes;
+  size_t num_makes;
+
+  const CameraMakeSpecs* begin() const { return makes; }
+  const CameraMakeSpecs* end() const { return makes + num_makes; }
+  size_t size() const { return num_makes; }
+};
+
+// Returns the camera specs, which are a compile-time constant table such that
+// no initialization or allocation is required at startup.
+CameraSpecs GetCameraSpecs();
 
 }  // namespace colmap
@@ -37,11 +37,23 @@
 #include "colmap/sensor/bitmap.h"
 #include "colmap/sfm/incremental_mapper_impl.h"
 #include "colmap/util/misc.h"
+#include "colmap/util/threading.h"
 
 #include <array>
 #include <fstream>
 
 namespace colmap {
+namespace {
+
+void CheckKnownSensorFromRig(const Frame& frame) {
+  for (const auto& [_, sensor_from_rig] : frame.RigPtr()->Sensors()) {
+    THROW_CHECK(sensor_from_rig.has_value())
+        << "Registration only implemented for frames with known "
+           "sensor_from_rig poses";
+  }
+}
+
+}  // namespace
 
 bool IncrementalMapper::Options::Check() const {
   CHECK_OPTION_GT(init_min_num_inliers, 0);
@@ -124,6 +136,7 @@ bool IncrementalMapper::FindInitialImagePair(const Options& options,
       reg_stats_.init_num_reg_trials,
       reg_stats_.num_registrations,
       reg_stats_.init_image_pairs,
+      reg_stats_.init_pair_geometries,
       image_id1,
       image_id2,
       cam2_from_cam1);
@@ -184,34 +197,11 @@ bool IncrementalMapper::RegisterNextImage(const Options& options,
   Image& image = reconstruction_->Image(image_id);
   Camera& camera = *image.CameraPtr();
 
-  for (const auto& [_, sensor_from_rig] :
-       image.FramePtr()->RigPtr()->Sensors()) {
-    THROW_CHECK(sensor_from_rig.has_value())
-        << "Registration only implemented for frames with known "
-           "sensor_from_rig poses";
-  }
+  CheckKnownSensorFromRig(*image.FramePtr());
 
-  // Use central camera pose estimation for trivial frames and when we don't
-  // have a good estimate of the camera's focal length, because we don't have a
-  // focal length estimator for non-central/generalized cameras.
-  if (image.FramePtr()->RigPtr()->NumSensors() > 1) {
-    bool all_cameras_have_good_focal_length = true;
-    for (const data_t& data_id : image.FramePtr()->ImageIds()) {
-      const Image& frame_image = reconstruction_->Image(data_id.id);
-      if ((!frame_image.CameraPtr()->has_prior_focal_length &&
-           reg_stats_.num_reg_images_per_camera[frame_image.CameraId()] == 0) ||
-          frame_image.CameraPtr()->HasBogusParams(
-              options.min_focal_length_ratio,
-              options.max_focal_length_ratio,
-              options.max_extra_param)) {
-        all_cameras_have_good_focal_length = false;
-        break;
-      }
-    }
-    if (all_cameras_have_good_focal_length) {
-      VLOG(2) << "Registering image using generalized pose estimation";
-      return RegisterNextGeneralFrame(options, *image.FramePtr());
-    }
+  if (UseGeneralizedRegistration(options, image)) {
+    VLOG(2) << "Registering image using generalized pose estimation";
+    return RegisterNextGeneralFrame(options, *image.FramePtr());
   }
 
   reg_stats_.num_reg_trials[image_id] += 1;
@@ -421,89 +411,253 @@ bool IncrementalMapper::RegisterNextImage(const Options& options,
   return true;
 }
 
+image_t IncrementalMapper::RegisterNextImageFromCandidates(
+    const Options& options, const std::vector<image_t>& image_ids) {
+  THROW_CHECK_NOTNULL(reconstruction_);
+  THROW_CHECK_GT(reconstruction_->NumRegFrames(), 0);
+  THROW_CHECK(options.Check());
+
+  const size_t num_threads =
+      static_cast<size_t>(GetEffectiveNumThreads(options.num_threads));
+
+  size_t candidate_idx = 0;
+  while (candidate_idx < image_ids.size()) {
+    // Collect a batch of consecutive candidates that are registered using
+    // generalized pose estimation. Their poses can be estimated concurrently,
+    // because failed estimations do not modify the reconstruction. Candidates
+    // of the same frame end the batch, since they would be estimated twice.
+    std::vector<image_t> batch_image_ids;
+    std::unordered_set<frame_t> batch_frame_ids;
+    while (num_threads > 1 && batch_image_ids.size() < num_threads &&
+           candidate_idx + batch_image_ids.size() < image_ids.size()) {
+      const Image& image = reconstruction_->Image(
+          image_ids[candidate_idx + batch_image_ids.size()]);
+      CheckKnownSensorFromRig(*image.FramePtr());
+      if (!UseGeneralizedRegistration(options, image) ||
+          !batch_frame_ids.insert(image.FrameId()).second) {
+        break;
+      }
+      batch_image_ids.push_back(image.ImageId());
+    }
+
+    if (batch_image_ids.size() <= 1) {
+      const image_t image_id = image_ids[candidate_idx++];
+      if (RegisterNextImage(options, image_id)) {
+        return image_id;
+      }
+      continue;
+    }
+
+    std::vector<GeneralFramePose> poses(batch_image_ids.size());
+    std::vector<char> success(batch_image_ids.size(), false);
+    ParallelFor(batch_image_ids.size(),
+                /*chunk_size=*/1,
+                num_threads,
+                [&](const size_t i) {
+                  success[i] = EstimateGeneralFramePose(
+                      options,
+                      *reconstruction_->Image(batch_image_ids[i]).FramePtr(),
+                      /*num_threads=*/1,
+                      &poses[i]);
+                });
+
+    // Register the first successful candidate in the given order, such that
+    // the result is the same as when trying the candidates one after another.
+    for (size_t i = 0; i < batch_image_ids.size(); ++i) {
+      Frame& frame = *reconstruction_->Image(batch_image_ids[i]).FramePtr();
+      for (const data_t& data_id : frame.ImageIds()) {
+        reg_stats_.num_reg_trials[data_id.id] += 1;
+      }
+      if (success[i]) {
+        RegisterGeneralFrame(frame, poses[i]);
+        return batch_image_ids[i];
+      }
+    }
+
+    candidate_idx += batch_image_ids.size();
+  }
+
+  return kInvalidImageId;
+}
+
+size_t IncrementalMapper::RegisterFramesFromPosePriors(const Options& options) {
+  THROW_CHECK_NOTNULL(reconstruction_);
+  THROW_CHECK_NOTNULL(obs_manager_);
+  THROW_CHECK_EQ(reconstruction_->NumRegFrames(), 0);
+
+  THROW_CHECK(options.Check());
+
+  const std::unordered_map<frame_t, Rigid3d> rigs_from_world =
+      IncrementalMapperImpl::EstimateFramePosesFromPosePriors(
+          options, *database_cache_, *reconstruction_);
+  if (rigs_from_world.size() < 2) {
+    return 0;
+  }
+
+  for (const auto& [frame_id, rig_from_world] : rigs_from_world) {
+    for (const data_t& data_id : reconstruction_->Frame(frame_id).ImageIds()) {
+      reg_stats_.num_reg_trials[data_id.id] += 1;
+    }
+    reconstruction_->Frame(frame_id).SetRigFromWorld(rig_from_world);
+    reconstruction_->RegisterFrame(frame_id);
+    RegisterFrameEvent(frame_id);
+  }
+
+  return rigs_from_world.size();
+}
+
+bool IncrementalMapper::UseGeneralizedRegistration(const Options& options,
+                                                   const Image& image) const {
+  // Use central camera pose estimation for trivial frames and when we don't
+  // have a good estimate of the camera's focal length, because we don't have a
+  // focal length estimator for non-central/generalized cameras.
+  if (image.FramePtr()->RigPtr()->NumSensors() <= 1) {
+    return false;
+  }
+  for (const data_t& data_id : image.FramePtr()->ImageIds()) {
+    const Image& frame_image = reconstruction_->Image(data_id.id);
+    const auto num_reg_images_it =
+        reg_stats_.num_reg_images_per_camera.find(frame_image.CameraId());
+    if ((!frame_image.CameraPtr()->has_prior_focal_length &&
+         (num_reg_images_it == reg_stats_.num_reg_images_per_camera.end() ||
+          num_reg_images_it->second == 0)) ||
+        frame_image.CameraPtr()->HasBogusParams(options.min_focal_length_ratio,
+                                                options.max_focal_length_ratio,
+                                                options.max_extra_param)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool IncrementalMapper::RegisterNextGeneralFrame(const Options& options,
                                                  Frame& frame) {
+  for (const data_t& data_id : frame.ImageIds()) {
+    reg_stats_.num_reg_trials[data_id.id] += 1;
+  }
+
+  GeneralFramePose pose;
+  if (!EstimateGeneralFramePose(options, frame, options.num_threads, &pose)) {
+    return false;
+  }
+
+  RegisterGeneralFrame(frame, pose);
+
+  return true;
+}
+
+bool IncrementalMapper::EstimateGeneralFramePose(const Options& options,
+                                                 const Frame& frame,
+                                                 const int num_threads,
+                                                 GeneralFramePose* pose) const {
   // Only call this method for frames with more than
   THROW_CHECK_GT(frame.RigPtr()->NumSensors(), 1);
 
-  struct Corr {
-    point2D_t point2D_idx;
-    image_t image_id;
-    point3D_t point3D_id;
+  struct SensorCorrs {
+    std::vector<GeneralFramePose::Corr> corrs;
+    std::vector<Eigen::Vector2d> points2D;
+    std::vector<Eigen::Vector3d> points3D;
   };
 
-  std::vector<Corr> tri_corrs;
-  std::vector<Eigen::Vector2d> tri_points2D;
-  std::vector<Eigen::Vector3d> tri_points3D;
-  std::vector<size_t> tri_camera_idxs;
-
+  std::vector<image_t> image_ids;
+  image_ids.reserve(frame.RigPtr()->NumSensors());
   std::vector<Rigid3d> cams_from_rig;
   cams_from_rig.reserve(frame.RigPtr()->NumSensors());
   std::vector<Camera> cameras;
   cameras.reserve(frame.RigPtr()->NumSensors());
-
-  const std::shared_ptr<const CorrespondenceGraph> correspondence_graph =
-      database_cache_->CorrespondenceGraph();
-
   for (const data_t& data_id : frame.ImageIds()) {
-    const image_t image_id = data_id.id;
-    const Image& image = reconstruction_->Image(image_id);
-    const Camera& camera = *image.CameraPtr();
-
-    const size_t camera_idx = cameras.size();
+    const Camera& camera = *reconstruction_->Image(data_id.id).CameraPtr();
     if (frame.RigPtr()->IsRefSensor(camera.SensorId())) {
       cams_from_rig.push_back(Rigid3d());
     } else {
       cams_from_rig.push_back(frame.RigPtr()->SensorFromRig(camera.SensorId()));
     }
     cameras.push_back(camera);
+    image_ids.push_back(data_id.id);
+  }
 
-    reg_stats_.num_reg_trials[image_id] += 1;
-
-    std::unordered_set<point3D_t> corr_point3D_ids;
-    for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
-         ++point2D_idx) {
-      const Point2D& point2D = image.Point2D(point2D_idx);
-
-      corr_point3D_ids.clear();
-      const auto corr_range =
-          correspondence_graph->FindCorrespondences(image_id, point2D_idx);
-      for (const auto* corr = corr_range.beg; corr < corr_range.end; ++corr) {
-        const Image& corr_image = reconstruction_->Image(corr->image_id);
-        if (!corr_image.HasPose()) {
-          continue;
-        }
-
-        const Point2D& corr_point2D = corr_image.Point2D(corr->point2D_idx);
-        if (!corr_point2D.HasPoint3D()) {
-          continue;
-        }
-
-        // Avoid duplicate correspondences.
-        if (corr_point3D_ids.count(corr_point2D.point3D_id) > 0) {
-          continue;
-        }
-
-        const Camera& corr_camera = *corr_image.CameraPtr();
+  const std::shared_ptr<const CorrespondenceGraph> correspondence_graph =
+      database_cache_->CorrespondenceGraph();
 
-        // Avoid correspondences to images with bogus camera parameters.
-        if (corr_camera.HasBogusParams(options.min_focal_length_ratio,
-                                       options.max_focal_length_ratio,
-                                       options.max_extra_param)) {
-          continue;
+  // Search for 2D-3D correspondences of all sensors in parallel. The search
+  // only reads the reconstruction and the results are concatenated in the
+  // order of the sensors, so they do not depend on the number of threads.
+  std::vector<SensorCorrs> sensor_corrs(image_ids.size());
+  ParallelFor(
+      image_ids.size(), /*chunk_size=*/1, num_threads, [&](const size_t i) {
+        const image_t image_id = image_ids[i];
+        const Image& image = reconstruction_->Image(image_id);
+        SensorCorrs& corrs = sensor_corrs[i];
+
+        std::unordered_set<point3D_t> corr_point3D_ids;
+        for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
+             ++point2D_idx) {
+          const Point2D& point2D = image.Point2D(point2D_idx);
+
+          corr_point3D_ids.clear();
+          const auto corr_range =
+              correspondence_graph->FindCorrespondences(image_id, point2D_idx);
+          for (const auto* corr = corr_range.beg; corr < corr_range.end;
+               ++corr) {
+            const Image& corr_image = reconstruction_->Image(corr->image_id);
+            if (!corr_image.HasPose()) {
+              continue;
+            }
+
+            const Point2D& corr_point2D =
+                corr_image.Point2D(corr->point2D_idx);
+            if (!corr_point2D.HasPoint3D()) {
+              continue;
+            }
+
+            // Avoid duplicate correspondences.
+            if (corr_point3D_ids.count(corr_point2D.point3D_id) > 0) {
+              continue;
+            }
+
+            const Camera& corr_camera = *corr_image.CameraPtr();
+
+            // Avoid correspondences to images with bogus camera parameters.
+            if (corr_camera.HasBogusParams(options.min_focal_length_ratio,
+                                           options.max_focal_length_ratio,
+                                           options.max_extra_param)) {
+              continue;
+            }
+
+            const Point3D& point3D =
+                reconstruction_->Point3D(corr_point2D.point3D_id);
+
+            corrs.corrs.push_back(GeneralFramePose::Corr{
+                image_id, point2D_idx, corr_point2D.point3D_id});
+            corr_point3D_ids.insert(corr_point2D.point3D_id);
+            corrs.points2D.push_back(point2D.xy);
+            corrs.points3D.push_back(point3D.xyz);
+          }
         }
+      });
 
-        const Point3D& point3D =
-            reconstruction_->Point3D(corr_point2D.point3D_id);
+  size_t num_corrs = 0;
+  for (const SensorCorrs& corrs : sensor_corrs) {
+    num_corrs += corrs.corrs.size();
+  }
 
-        tri_corrs.push_back(
-            Corr{point2D_idx, image_id, corr_point2D.point3D_id});
-        corr_point3D_ids.insert(corr_point2D.point3D_id);
-        tri_points2D.push_back(point2D.xy);
-        tri_points3D.push_back(point3D.xyz);
-        tri_camera_idxs.push_back(camera_idx);
-      }
-    }
+  std::vector<GeneralFramePose::Corr> tri_corrs;
+  tri_corrs.reserve(num_corrs);
+  std::vector<Eigen::Vector2d> tri_points2D;
+  tri_points2D.reserve(num_corrs);
+  std::vector<Eigen::Vector3d> tri_points3D;
+  tri_points3D.reserve(num_corrs);
+  std::vector<size_t> tri_camera_idxs;
+  tri_camera_idxs.reserve(num_corrs);
+  for (size_t camera_idx = 0; camera_idx < sensor_corrs.size(); ++camera_idx) {
+    SensorCorrs& corrs = sensor_corrs[camera_idx];
+    tri_corrs.insert(tri_corrs.end(), corrs.corrs.begin(), corrs.corrs.end());
+    tri_points2D.insert(
+        tri_points2D.end(), corrs.points2D.begin(), corrs.points2D.end());
+    tri_points3D.insert(
+        tri_points3D.end(), corrs.points3D.begin(), corrs.points3D.end());
+    tri_camera_idxs.insert(
+        tri_camera_idxs.end(), corrs.corrs.size(), camera_idx);
   }
 
   // The size of `next_image.num_tri_obs` and `tri_corrs_point2D_idxs.size()`
@@ -534,25 +688,25 @@ bool IncrementalMapper::RegisterNextGeneralFrame(const Options& options,
   abs_pose_refinement_options.refine_focal_length = false;
   abs_pose_refinement_options.refine_extra_params = false;
 
-  size_t num_inliers;
   std::vector<char> inlier_mask;
-  Rigid3d rig_from_world;
   if (!EstimateGeneralizedAbsolutePose(abs_pose_options,
                                        tri_points2D,
                                        tri_points3D,
                                        tri_camera_idxs,
                                        cams_from_rig,
                                        cameras,
-                                       &rig_from_world,
-                                       &num_inliers,
+                                       &pose->rig_from_world,
+                                       &pose->num_inliers,
                                        &inlier_mask)) {
     VLOG(2) << "Absolute pose estimation failed";
     return false;
   }
 
-  if (num_inliers < static_cast<size_t>(options.abs_pose_min_num_inliers)) {
+  if (pose->num_inliers <
+      static_cast<size_t>(options.abs_pose_min_num_inliers)) {
     VLOG(2) << "Absolute pose estimation failed due to insufficient inliers ("
-            << num_inliers << " < " << options.abs_pose_min_num_inliers << ")";
+            << pose->num_inliers << " < " << options.abs_pose_min_num_inliers
+            << ")";
     return false;
   }
 
@@ -566,38 +720,42 @@ bool IncrementalMapper::RegisterNextGeneralFrame(const Options& options,
                                      tri_points3D,
                                      tri_camera_idxs,
                                      cams_from_rig,
-                                     &rig_from_world,
+                                     &pose->rig_from_world,
                                      &cameras)) {
     VLOG(2) << "Absolute pose refinement failed";
     return false;
   }
 
-  //////////////////////////////////////////////////////////////////////////////
-  // Continue tracks
-  //////////////////////////////////////////////////////////////////////////////
+  pose->inlier_corrs.clear();
+  pose->inlier_corrs.reserve(pose->num_inliers);
+  for (size_t i = 0; i < inlier_mask.size(); ++i) {
+    if (inlier_mask[i]) {
+      pose->inlier_corrs.push_back(tri_corrs[i]);
+    }
+  }
 
-  VLOG(2) << "Continuing tracks for " << num_inliers
+  return true;
+}
+
+void IncrementalMapper::RegisterGeneralFrame(Frame& frame,
+                                             const GeneralFramePose& pose) {
+  VLOG(2) << "Continuing tracks for " << pose.num_inliers
           << " inlier 2D-3D correspondences";
 
-  frame.SetRigFromWorld(rig_from_world);
+  frame.SetRigFromWorld(pose.rig_from_world);
 
   reconstruction_->RegisterFrame(frame.FrameId());
   RegisterFrameEvent(frame.FrameId());
 
-  for (size_t i = 0; i < inlier_mask.size(); ++i) {
-    if (inlier_mask[i]) {
-      const Corr& corr = tri_corrs[i];
-      const Image& image = reconstruction_->Image(corr.image_id);
-      const Point2D& point2D = image.Point2D(corr.point2D_idx);
-      if (!point2D.HasPoint3D()) {
-        const TrackElement track_el(corr.image_id, corr.point2D_idx);
-        obs_manager_->AddObservation(corr.point3D_id, track_el);
-        triangulator_->AddModifiedPoint3D(corr.point3D_id);
-      }
+  for (const GeneralFramePose::Corr& corr : pose.inlier_corrs) {
+    const Image& image = reconstruction_->Image(corr.image_id);
+    const Point2D& point2D = image.Point2D(corr.point2D_idx);
+    if (!point2D.HasPoint3D()) {
+      const TrackElement track_el(corr.image_id, corr.point2D_idx);
+      obs_manager_->AddObservation(corr.point3D_id, track_el);
+      triangulator_->AddModifiedPoint3D(corr.point3D_id);
     }
   }
-
-  return true;
 }
 
 size_t IncrementalMapper::TriangulateImage(
@@ -761,12 +919,16 @@ IncrementalMapper::AdjustLocalBundle(
   // there are no outlier points in the model. This results in duplicate work as
   // many of the provided 3D points may also be contained in the adjusted
   // images, but the filtering is not a bottleneck at this point.
-  report.num_filtered_observations = obs_manager_->FilterPoints3DInImages(
-      options.filter_max_reproj_error, options.filter_min_tri_angle, image_ids);
+  report.num_filtered_observations =
+      obs_manager_->FilterPoints3DInImages(options.filter_max_reproj_error,
+                                           options.filter_min_tri_angle,
+                                           image_ids,
+                                           options.num_threads);
   report.num_filtered_observations +=
       obs_manager_->FilterPoints3D(options.filter_max_reproj_error,
                                    options.filter_min_tri_angle,
-                                   point3D_ids);
+                                   point3D_ids,
+                                   options.num_threads);
 
   return report;
 }
@@ -947,8 +1109,10 @@ size_t IncrementalMapper::FilterFrames(const Options& options) {
 size_t IncrementalMapper::FilterPoints(const Options& options) {
   THROW_CHECK_NOTNULL(obs_manager_);
   THROW_CHECK(options.Check());
-  const size_t num_filtered_observations = obs_manager_->FilterAllPoints3D(
-      options.filter_max_reproj_error, options.filter_min_tri_angle);
+  const size_t num_filtered_observations =
+      obs_manager_->FilterAllPoints3D(options.filter_max_reproj_error,
+                                      options.filter_min_tri_angle,
+                                      options.num_threads);
   VLOG(1) << "=> Filtered observations: " << num_filtered_observations;
   return num_filtered_observations;
 }
@@ -157,6 +157,26 @@ class IncrementalMapper {
     size_t num_adjusted_observations = 0;
   };
 
+  // Calibrated two-view geometry of a candidate initial image pair. The
+  // geometry only depends on the RANSAC options and not on the initialization
+  // thresholds, so it can be reused after relaxing the thresholds.
+  struct InitialPairGeometry {
+    // The first image of the pair, which defines the direction of the
+    // relative pose.
+    image_t image_id1 = kInvalidImageId;
+    // Whether the relative pose could be estimated.
+    bool success = false;
+    size_t num_inliers = 0;
+    double tri_angle = 0;
+    Rigid3d cam2_from_cam1;
+    // The maximum error used for estimation, used to invalidate the cache.
+    double max_error = 0;
+  };
+
+  // Cache of initial pair geometries indexed by image pair identifier.
+  using InitialPairGeometryCache =
+      std::unordered_map<image_pair_t, InitialPairGeometry>;
+
   // Create incremental mapper. The database cache must live for the entire
   // life-time of the incremental mapper.
   explicit IncrementalMapper(
@@ -176,6 +196,8 @@ class IncrementalMapper {
   // Find initial image pair to seed the incremental reconstruction. The image
   // pairs should be passed to `RegisterInitialImagePair`. This function
   // automatically ignores image pairs that failed to register previously.
+  // Candidate pairs are evaluated in parallel and their two-view geometries
+  // are cached across calls.
   bool FindInitialImagePair(const Options& options,
                             image_t& image_id1,
                             image_t& image_id2,
@@ -196,6 +218,22 @@ class IncrementalMapper {
   // a previous call to `RegisterInitialImagePair` was successful.
   bool RegisterNextImage(const Options& options, image_t image_id);
 
+  // Attempt to register the first of the given candidate images (e.g., from
+  // `FindNextImages`) that can be registered, which is equivalent to calling
+  // `RegisterNextImage` for each candidate until one succeeds. The poses of
+  // consecutive candidates in non-trivial rig frames are estimated
+  // concurrently. Returns the registered image or kInvalidImageId.
+  image_t RegisterNextImageFromCandidates(
+      const Options& options, const std::vector<image_t>& image_ids);
+
+  // Register all frames with pose priors at once without triangulating any
+  // points, as an alternative to `RegisterInitialImagePair` for an empty
+  // reconstruction with accurate position priors. The frame poses are
+  // estimated by `IncrementalMapperImpl::EstimateFramePosesFromPosePriors`.
+  // Returns the number of registered frames, which is zero if fewer than two
+  // frames could be initialized.
+  size_t RegisterFramesFromPosePriors(const Options& options);
+
   // Triangulate observations of image.
   size_t TriangulateImage(const IncrementalTriangulator::Options& tri_options,
                           image_t image_id);
@@ -313,6 +351,11 @@ class IncrementalMapper {
     std::unordered_map<image_t, size_t> init_num_reg_trials;
     std::unordered_set<image_pair_t> init_image_pairs;
 
+    // Two-view geometries of candidate initial image pairs. In contrast to the
+    // statistics above, these are kept when resetting the initialization
+    // statistics, since they do not depend on the initialization thresholds.
+    InitialPairGeometryCache init_pair_geometries;
+
     // The number of registered frames/images per rig/camera. This information
     // is used to avoid duplicate refinement of rig/camera parameters and
     // degradation of already refined rig/camera parameters in local bundle
@@ -328,9 +371,38 @@ class IncrementalMapper {
     std::unordered_map<image_t, size_t> num_reg_trials;
   };
 
+  // Estimated rig pose of a frame and its inlier 2D-3D correspondences.
+  struct GeneralFramePose {
+    struct Corr {
+      image_t image_id;
+      point2D_t point2D_idx;
+      point3D_t point3D_id;
+    };
+
+    Rigid3d rig_from_world;
+    size_t num_inliers = 0;
+    std::vector<Corr> inlier_corrs;
+  };
+
+  // Whether the frame of the image is registered using generalized absolute
+  // pose estimation instead of the image alone.
+  bool UseGeneralizedRegistration(const Options& options,
+                                  const Image& image) const;
+
   // Registers a frame using generalized absolute pose estimation.
   bool RegisterNextGeneralFrame(const Options& options, Frame& frame);
 
+  // Estimates the pose of a frame using generalized absolute pose estimation
+  // without modifying the reconstruction. The 2D-3D correspondences of the
+  // frame's images are searched using the given number of threads.
+  bool EstimateGeneralFramePose(const Options& options,
+                                const Frame& frame,
+                                int num_threads,
+                                GeneralFramePose* pose) const;
+
+  // Registers a frame with a pose from `EstimateGeneralFramePose`.
+  void RegisterGeneralFrame(Frame& frame, const GeneralFramePose& pose);
+
   // Register / De-register frame in current reconstruction and update
   // the (shared) registration statistics.
   void RegisterFrameEvent(frame_t frame_id);
@@ -32,12 +32,16 @@
 #include "colmap/estimators/generalized_pose.h"
 #include "colmap/estimators/pose.h"
 #include "colmap/estimators/two_view_geometry.h"
+#include "colmap/geometry/pose.h"
 #include "colmap/geometry/triangulation.h"
 #include "colmap/scene/projection.h"
 #include "colmap/util/misc.h"
+#include "colmap/util/threading.h"
 
 #include <array>
 #include <fstream>
+#include <map>
+#include <queue>
 
 namespace colmap {
 namespace {
@@ -235,11 +239,20 @@ bool IncrementalMapperImpl::FindInitialImagePair(
     const std::unordered_map<image_t, size_t>& init_num_reg_trials,
     const std::unordered_map<image_t, size_t>& num_registrations,
     std::unordered_set<image_pair_t>& init_image_pairs,
+    IncrementalMapper::InitialPairGeometryCache& init_pair_geometries,
     image_t& image_id1,
     image_t& image_id2,
     Rigid3d& cam2_from_cam1) {
   THROW_CHECK(options.Check());
 
+  const int num_threads = GetEffectiveNumThreads(options.num_threads);
+
+  auto IsCached = [&](const image_pair_t pair_id) {
+    const auto it = init_pair_geometries.find(pair_id);
+    return it != init_pair_geometries.end() &&
+           it->second.max_error == options.init_max_error;
+  };
+
   std::vector<image_t> image_ids1;
   if (image_id1 != kInvalidImageId && image_id2 == kInvalidImageId) {
     // Only image_id1 provided.
@@ -275,19 +288,66 @@ bool IncrementalMapperImpl::FindInitialImagePair(
             reconstruction,
             num_registrations);
 
-    for (size_t i2 = 0; i2 < image_ids2.size(); ++i2) {
-      image_id2 = image_ids2[i2];
+    // Try every pair only once.
+    std::vector<image_t> candidate_image_ids2;
+    candidate_image_ids2.reserve(image_ids2.size());
+    for (const image_t candidate_image_id2 : image_ids2) {
+      if (init_image_pairs.count(
+              ImagePairToPairId(image_id1, candidate_image_id2)) == 0) {
+        candidate_image_ids2.push_back(candidate_image_id2);
+      }
+    }
 
-      const image_pair_t pair_id = ImagePairToPairId(image_id1, image_id2);
+    // Estimate the geometries of the candidate pairs in batches of one pair
+    // per thread and then check them in the order of their ranking, such that
+    // the selected pair is the same as in sequential evaluation. Geometries of
+    // pairs beyond the selected pair remain cached for later trials.
+    for (size_t batch_begin = 0; batch_begin < candidate_image_ids2.size();
+         batch_begin += num_threads) {
+      const size_t batch_end = std::min(candidate_image_ids2.size(),
+                                        batch_begin + num_threads);
+
+      std::vector<image_t> uncached_image_ids2;
+      for (size_t i2 = batch_begin; i2 < batch_end; ++i2) {
+        if (!IsCached(ImagePairToPairId(image_id1, candidate_image_ids2[i2]))) {
+          uncached_image_ids2.push_back(candidate_image_ids2[i2]);
+        }
+      }
 
-      // Try every pair only once.
-      if (!init_image_pairs.emplace(pair_id).second) {
-        continue;
+      std::vector<IncrementalMapper::InitialPairGeometry> uncached_geometries(
+          uncached_image_ids2.size());
+      ParallelFor(uncached_image_ids2.size(),
+                  /*chunk_size=*/1,
+                  num_threads,
+                  [&](const size_t i) {
+                    uncached_geometries[i] =
+                        IncrementalMapperImpl::EstimateInitialPairGeometry(
+                            options,
+                            database_cache,
+                            image_id1,
+                            uncached_image_ids2[i]);
+                  });
+      for (size_t i = 0; i < uncached_image_ids2.size(); ++i) {
+        init_pair_geometries[ImagePairToPairId(
+            image_id1, uncached_image_ids2[i])] =
+            std::move(uncached_geometries[i]);
       }
 
-      if (IncrementalMapperImpl::EstimateInitialTwoViewGeometry(
-              options, database_cache, image_id1, image_id2, cam2_from_cam1)) {
-        return true;
+      for (size_t i2 = batch_begin; i2 < batch_end; ++i2) {
+        image_id2 = candidate_image_ids2[i2];
+
+        const image_pair_t pair_id = ImagePairToPairId(image_id1, image_id2);
+        init_image_pairs.insert(pair_id);
+
+        if (IncrementalMapperImpl::EstimateInitialTwoViewGeometry(
+                options,
+                database_cache,
+                init_pair_geometries.at(pair_id),
+                image_id1,
+                image_id2,
+                cam2_from_cam1)) {
+          return true;
+        }
       }
     }
   }
@@ -656,12 +716,12 @@ bool EstimateInitialGeneralizedTwoViewGeometry(
 
 }  // namespace
 
-bool IncrementalMapperImpl::EstimateInitialTwoViewGeometry(
+IncrementalMapper::InitialPairGeometry
+IncrementalMapperImpl::EstimateInitialPairGeometry(
     const IncrementalMapper::Options& options,
     const DatabaseCache& database_cache,
     const image_t image_id1,
-    const image_t image_id2,
-    Rigid3d& cam2_from_cam1) {
+    const image_t image_id2) {
   const Image& image1 = database_cache.Image(image_id1);
   const Image& image2 = database_cache.Image(image_id2);
   const Camera& camera1 = database_cache.Camera(image1.CameraId());
@@ -690,9 +750,13 @@ bool IncrementalMapperImpl::EstimateInitialTwoViewGeometry(
   TwoViewGeometry two_view_geometry = EstimateCalibratedTwoViewGeometry(
       camera1, points1, camera2, points2, matches, two_view_geometry_options);
 
-  if (!EstimateTwoViewGeometryPose(
-          camera1, points1, camera2, points2, &two_view_geometry)) {
-    return false;
+  IncrementalMapper::InitialPairGeometry geometry;
+  geometry.image_id1 = image_id1;
+  geometry.max_error = options.init_max_error;
+  geometry.success = EstimateTwoViewGeometryPose(
+      camera1, points1, camera2, points2, &two_view_geometry);
+  if (!geometry.success) {
+    return geometry;
   }
 
   VLOG(3) << "Initial image pair with config " << two_view_geometry.config
@@ -702,14 +766,58 @@ bool IncrementalMapperImpl::EstimateInitialTwoViewGeometry(
           << " z translation, " << RadToDeg(two_view_geometry.tri_angle)
           << " deg triangulation angle";
 
-  if (static_cast<int>(two_view_geometry.inlier_matches.size()) <
-          options.init_min_num_inliers ||
-      std::abs(two_view_geometry.cam2_from_cam1.translation.z()) >=
+  geometry.num_inliers = two_view_geometry.inlier_matches.size();
+  geometry.tri_angle = two_view_geometry.tri_angle;
+  geometry.cam2_from_cam1 = two_view_geometry.cam2_from_cam1;
+
+  return geometry;
+}
+
+bool IncrementalMapperImpl::EstimateInitialTwoViewGeometry(
+    const IncrementalMapper::Options& options,
+    const DatabaseCache& database_cache,
+    const image_t image_id1,
+    const image_t image_id2,
+    Rigid3d& cam2_from_cam1) {
+  const IncrementalMapper::InitialPairGeometry geometry =
+      EstimateInitialPairGeometry(
+          options, database_cache, image_id1, image_id2);
+  return EstimateInitialTwoViewGeometry(
+      options,
+      database_cache,
+      geometry,
+      image_id1,
+      image_id2,
+      cam2_from_cam1);
+}
+
+bool IncrementalMapperImpl::EstimateInitialTwoViewGeometry(
+    const IncrementalMapper::Options& options,
+    const DatabaseCache& database_cache,
+    const IncrementalMapper::InitialPairGeometry& geometry,
+    const image_t image_id1,
+    const image_t image_id2,
+    Rigid3d& cam2_from_cam1) {
+  if (!geometry.success) {
+    return false;
+  }
+
+  // The cached geometry may have been estimated for the swapped image pair.
+  THROW_CHECK(geometry.image_id1 == image_id1 ||
+              geometry.image_id1 == image_id2);
+  const Rigid3d pair_cam2_from_cam1 = geometry.image_id1 == image_id1
+                                          ? geometry.cam2_from_cam1
+                                          : Inverse(geometry.cam2_from_cam1);
+
+  if (static_cast<int>(geometry.num_inliers) < options.init_min_num_inliers ||
+      std::abs(pair_cam2_from_cam1.translation.z()) >=
           options.init_max_forward_motion ||
-      two_view_geometry.tri_angle <= DegToRad(options.init_min_tri_angle)) {
+      geometry.tri_angle <= DegToRad(options.init_min_tri_angle)) {
     return false;
   }
 
+  const Image& image1 = database_cache.Image(image_id1);
+  const Image& image2 = database_cache.Image(image_id2);
   const Frame& frame1 = database_cache.Frame(image1.FrameId());
   const Frame& frame2 = database_cache.Frame(image2.FrameId());
   const Rig& rig1 = database_cache.Rig(frame1.RigId());
@@ -730,9 +838,340 @@ bool IncrementalMapperImpl::EstimateInitialTwoViewGeometry(
                                                      cam2_from_cam1);
   }
 
-  cam2_from_cam1 = two_view_geometry.cam2_from_cam1;
+  cam2_from_cam1 = pair_cam2_from_cam1;
 
   return true;
 }
 
+namespace {
+
+// Relative rotation and translation direction between two frames, derived
+// from the two-view geometry of the image pair with the most correspondences
+// between the two frames.
+struct FramePairGeometry {
+  frame_t frame_id1 = kInvalidFrameId;
+  frame_t frame_id2 = kInvalidFrameId;
+  image_t image_id1 = kInvalidImageId;
+  image_t image_id2 = kInvalidImageId;
+  point2D_t num_corrs = 0;
+  // Zero if the relative pose could not be estimated.
+  size_t num_inliers = 0;
+  Eigen::Matrix3d rig2_from_rig1 = Eigen::Matrix3d::Identity();
+  // Direction from the second to the first camera center in the second rig.
+  Eigen::Vector3d dir_in_rig2 = Eigen::Vector3d::Zero();
+};
+
+double RotationAngle(const Eigen::Matrix3d& rotation) {
+  return std::acos(std::clamp((rotation.trace() - 1) / 2, -1.0, 1.0));
+}
+
+// Weight of a residual angle under the Cauchy loss.
+double CauchyWeight(const double angle, const double scale) {
+  return 1 / (1 + (angle / scale) * (angle / scale));
+}
+
+}  // namespace
+
+std::unordered_map<frame_t, Rigid3d>
+IncrementalMapperImpl::EstimateFramePosesFromPosePriors(
+    const IncrementalMapper::Options& options,
+    const DatabaseCache& database_cache,
+    const Reconstruction& reconstruction) {
+  const auto cam_from_rig = [&reconstruction](const image_t image_id) {
+    const Image& image = reconstruction.Image(image_id);
+    const Rig& rig = *image.FramePtr()->RigPtr();
+    const sensor_t sensor_id = image.CameraPtr()->SensorId();
+    return rig.IsRefSensor(sensor_id) ? Rigid3d()
+                                      : rig.SensorFromRig(sensor_id);
+  };
+
+  // The position of a frame is given by the prior of its reference sensor
+  // image, whose projection center coincides with the rig origin.
+  std::unordered_map<frame_t, Eigen::Vector3d> frame_positions;
+  for (const auto& [frame_id, frame] : reconstruction.Frames()) {
+    const Rig& rig = *frame.RigPtr();
+    bool has_sensors_from_rig = true;
+    const PosePrior* ref_pose_prior = nullptr;
+    for (const data_t& data_id : frame.ImageIds()) {
+      const sensor_t sensor_id =
+          reconstruction.Image(data_id.id).CameraPtr()->SensorId();
+      if (rig.IsRefSensor(sensor_id)) {
+        if (database_cache.ExistsPosePrior(data_id.id) &&
+            database_cache.PosePrior(data_id.id).IsValid()) {
+          ref_pose_prior = &database_cache.PosePrior(data_id.id);
+        }
+      } else if (!rig.HasSensorFromRig(sensor_id)) {
+        has_sensors_from_rig = false;
+      }
+    }
+    if (has_sensors_from_rig && ref_pose_prior != nullptr) {
+      frame_positions.emplace(frame_id, ref_pose_prior->position);
+    }
+  }
+
+  // Connect the frames through their image pair with the most correspondences.
+  const std::unordered_map<image_pair_t, point2D_t> num_corrs_between_images =
+      database_cache.CorrespondenceGraph()->NumCorrespondencesBetweenImages();
+  std::map<std::pair<frame_t, frame_t>, FramePairGeometry> frame_pairs;
+  for (const auto& [pair_id, num_corrs] : num_corrs_between_images) {
+    image_t image_id1;
+    image_t image_id2;
+    std::tie(image_id1, image_id2) = PairIdToImagePair(pair_id);
+    frame_t frame_id1 = reconstruction.Image(image_id1).FrameId();
+    frame_t frame_id2 = reconstruction.Image(image_id2).FrameId();
+    if (frame_id1 == frame_id2 || frame_positions.count(frame_id1) == 0 ||
+        frame_positions.count(frame_id2) == 0) {
+      continue;
+    }
+    if (frame_id1 > frame_id2) {
+      std::swap(frame_id1, frame_id2);
+      std::swap(image_id1, image_id2);
+    }
+    FramePairGeometry& frame_pair = frame_pairs[{frame_id1, frame_id2}];
+    if (num_corrs > frame_pair.num_corrs) {
+      frame_pair.frame_id1 = frame_id1;
+      frame_pair.frame_id2 = frame_id2;
+      frame_pair.image_id1 = image_id1;
+      frame_pair.image_id2 = image_id2;
+      frame_pair.num_corrs = num_corrs;
+    }
+  }
+
+  std::vector<FramePairGeometry> candidate_pairs;
+  candidate_pairs.reserve(frame_pairs.size());
+  std::unordered_map<frame_t, std::vector<size_t>> frame_pair_idxs;
+  for (auto& [_, frame_pair] : frame_pairs) {
+    frame_pair_idxs[frame_pair.frame_id1].push_back(candidate_pairs.size());
+    frame_pair_idxs[frame_pair.frame_id2].push_back(candidate_pairs.size());
+    candidate_pairs.push_back(frame_pair);
+  }
+
+  // Only estimate the relative poses to the most connected neighbors of each
+  // frame, which is sufficient for a well-connected frame graph and avoids
+  // quadratic complexity for dense matching.
+  const size_t kMaxNumNeighbors = 5;
+  std::vector<char> is_selected(candidate_pairs.size(), false);
+  for (auto& [_, pair_idxs] : frame_pair_idxs) {
+    std::sort(pair_idxs.begin(),
+              pair_idxs.end(),
+              [&candidate_pairs](const size_t idx1, const size_t idx2) {
+                return candidate_pairs[idx1].num_corrs >
+                           candidate_pairs[idx2].num_corrs ||
+                       (candidate_pairs[idx1].num_corrs ==
+                            candidate_pairs[idx2].num_corrs &&
+                        idx1 < idx2);
+              });
+    for (size_t i = 0; i < std::min(kMaxNumNeighbors, pair_idxs.size());
+         ++i) {
+      is_selected[pair_idxs[i]] = true;
+    }
+  }
+
+  std::vector<FramePairGeometry> pairs;
+  for (size_t i = 0; i < candidate_pairs.size(); ++i) {
+    if (is_selected[i]) {
+      pairs.push_back(candidate_pairs[i]);
+    }
+  }
+
+  const int num_threads = GetEffectiveNumThreads(options.num_threads);
+  ParallelFor(pairs.size(), /*chunk_size=*/1, num_threads, [&](const size_t i) {
+    FramePairGeometry& pair = pairs[i];
+    const IncrementalMapper::InitialPairGeometry geometry =
+        EstimateInitialPairGeometry(
+            options, database_cache, pair.image_id1, pair.image_id2);
+    if (!geometry.success ||
+        static_cast<int>(geometry.num_inliers) < options.init_min_num_inliers) {
+      return;
+    }
+    const Eigen::Matrix3d cam2_from_rig2 =
+        cam_from_rig(pair.image_id2).rotation.toRotationMatrix();
+    pair.num_inliers = geometry.num_inliers;
+    pair.rig2_from_rig1 =
+        cam2_from_rig2.transpose() *
+        geometry.cam2_from_cam1.rotation.toRotationMatrix() *
+        cam_from_rig(pair.image_id1).rotation.toRotationMatrix();
+    pair.dir_in_rig2 = cam2_from_rig2.transpose() *
+                       geometry.cam2_from_cam1.translation.normalized();
+  });
+
+  // Find the maximum spanning tree of the frame graph weighted by the number
+  // of inliers and select its largest connected component.
+  std::vector<size_t> sorted_pair_idxs;
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    if (pairs[i].num_inliers > 0) {
+      sorted_pair_idxs.push_back(i);
+    }
+  }
+  std::stable_sort(sorted_pair_idxs.begin(),
+                   sorted_pair_idxs.end(),
+                   [&pairs](const size_t idx1, const size_t idx2) {
+                     return pairs[idx1].num_inliers > pairs[idx2].num_inliers;
+                   });
+
+  std::unordered_map<frame_t, frame_t> parent_frame_ids;
+  for (const auto& [frame_id, _] : frame_positions) {
+    parent_frame_ids.emplace(frame_id, frame_id);
+  }
+  const auto find_root = [&parent_frame_ids](frame_t frame_id) {
+    while (parent_frame_ids.at(frame_id) != frame_id) {
+      frame_t& parent_frame_id = parent_frame_ids.at(frame_id);
+      parent_frame_id = parent_frame_ids.at(parent_frame_id);
+      frame_id = parent_frame_id;
+    }
+    return frame_id;
+  };
+
+  std::unordered_map<frame_t, std::vector<size_t>> tree_pair_idxs;
+  for (const size_t pair_idx : sorted_pair_idxs) {
+    const FramePairGeometry& pair = pairs[pair_idx];
+    const frame_t root_frame_id1 = find_root(pair.frame_id1);
+    const frame_t root_frame_id2 = find_root(pair.frame_id2);
+    if (root_frame_id1 != root_frame_id2) {
+      parent_frame_ids.at(root_frame_id1) = root_frame_id2;
+      tree_pair_idxs[pair.frame_id1].push_back(pair_idx);
+      tree_pair_idxs[pair.frame_id2].push_back(pair_idx);
+    }
+  }
+
+  std::unordered_map<frame_t, size_t> component_sizes;
+  for (const auto& [frame_id, _] : frame_positions) {
+    component_sizes[find_root(frame_id)] += 1;
+  }
+  frame_t root_frame_id = kInvalidFrameId;
+  size_t max_component_size = 0;
+  for (const auto& [frame_id, component_size] : component_sizes) {
+    if (component_size > max_component_size ||
+        (component_size == max_component_size && frame_id < root_frame_id)) {
+      root_frame_id = frame_id;
+      max_component_size = component_size;
+    }
+  }
+  if (max_component_size < 2) {
+    return {};
+  }
+
+  // Initialize the frame rotations by chaining the relative rotations along
+  // the spanning tree. The rotations are relative to an arbitrary world frame,
+  // which is aligned to the world frame of the priors below.
+  std::unordered_map<frame_t, Eigen::Matrix3d> rigs_from_world;
+  rigs_from_world.emplace(root_frame_id, Eigen::Matrix3d::Identity());
+  std::queue<frame_t> frame_queue;
+  frame_queue.push(root_frame_id);
+  while (!frame_queue.empty()) {
+    const frame_t frame_id = frame_queue.front();
+    frame_queue.pop();
+    const Eigen::Matrix3d rig_from_world = rigs_from_world.at(frame_id);
+    for (const size_t pair_idx : tree_pair_idxs[frame_id]) {
+      const FramePairGeometry& pair = pairs[pair_idx];
+      const bool is_first = pair.frame_id1 == frame_id;
+      const frame_t other_frame_id = is_first ? pair.frame_id2 : pair.frame_id1;
+      const Eigen::Matrix3d other_rig_from_world =
+          is_first ? Eigen::Matrix3d(pair.rig2_from_rig1 * rig_from_world)
+                   : Eigen::Matrix3d(pair.rig2_from_rig1.transpose() *
+                                     rig_from_world);
+      if (rigs_from_world.emplace(other_frame_id, other_rig_from_world)
+              .second) {
+        frame_queue.push(other_frame_id);
+      }
+    }
+  }
+
+  std::vector<size_t> component_pair_idxs;
+  for (const size_t pair_idx : sorted_pair_idxs) {
+    if (rigs_from_world.count(pairs[pair_idx].frame_id1)) {
+      component_pair_idxs.push_back(pair_idx);
+    }
+  }
+
+  // Refine the rotations using all relative rotations by robust chordal
+  // rotation averaging with the root frame fixed.
+  const int kNumRotationAveragingIterations = 10;
+  const double kRotationResidualScale = DegToRad(5.0);
+  for (int iter = 0; iter < kNumRotationAveragingIterations; ++iter) {
+    std::unordered_map<frame_t, Eigen::Matrix3d> rotation_sums;
+    for (const auto& [frame_id, _] : rigs_from_world) {
+      rotation_sums.emplace(frame_id, Eigen::Matrix3d::Zero());
+    }
+    for (const size_t pair_idx : component_pair_idxs) {
+      const FramePairGeometry& pair = pairs[pair_idx];
+      const Eigen::Matrix3d& rig1_from_world =
+          rigs_from_world.at(pair.frame_id1);
+      const Eigen::Matrix3d& rig2_from_world =
+          rigs_from_world.at(pair.frame_id2);
+      const double residual = RotationAngle(
+          pair.rig2_from_rig1 * rig1_from_world * rig2_from_world.transpose());
+      const double weight = pair.num_inliers *
+                            CauchyWeight(residual, kRotationResidualScale);
+      rotation_sums.at(pair.frame_id2) +=
+          weight * pair.rig2_from_rig1 * rig1_from_world;
+      rotation_sums.at(pair.frame_id1) +=
+          weight * pair.rig2_from_rig1.transpose() * rig2_from_world;
+    }
+    for (auto& [frame_id, rig_from_world] : rigs_from_world) {
+      if (frame_id != root_frame_id) {
+        rig_from_world =
+            ComputeClosestRotationMatrix(rotation_sums.at(frame_id));
+      }
+    }
+  }
+
+  // Align the rotations to the world frame of the priors, such that the
+  // relative translation directions agree with the directions between the
+  // prior positions. The offsets of non-reference sensors in the rig are
+  // neglected, which is sufficient for the subsequent bundle adjustment.
+  std::vector<Eigen::Vector3d> prior_dirs;
+  std::vector<Eigen::Vector3d> dirs;
+  std::vector<double> dir_weights;
+  for (const size_t pair_idx : component_pair_idxs) {
+    const FramePairGeometry& pair = pairs[pair_idx];
+    const Eigen::Vector3d baseline = frame_positions.at(pair.frame_id1) -
+                                     frame_positions.at(pair.frame_id2);
+    if (baseline.squaredNorm() == 0 || pair.dir_in_rig2.squaredNorm() == 0) {
+      continue;
+    }
+    prior_dirs.push_back(baseline.normalized());
+    dirs.push_back(rigs_from_world.at(pair.frame_id2).transpose() *
+                   pair.dir_in_rig2);
+    dir_weights.push_back(pair.num_inliers);
+  }
+
+  const int kNumAlignmentIterations = 5;
+  const double kAlignmentResidualScale = DegToRad(5.0);
+  const double kMinSingularValueRatio = 0.1;
+  Eigen::Matrix3d world_from_prior_world = Eigen::Matrix3d::Identity();
+  for (int iter = 0; iter < kNumAlignmentIterations; ++iter) {
+    Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+    for (size_t i = 0; i < dirs.size(); ++i) {
+      double weight = dir_weights[i];
+      if (iter > 0) {
+        const double residual = std::acos(std::clamp(
+            dirs[i].dot(world_from_prior_world * prior_dirs[i]), -1.0, 1.0));
+        weight *= CauchyWeight(residual, kAlignmentResidualScale);
+      }
+      covariance += weight * dirs[i] * prior_dirs[i].transpose();
+    }
+    const Eigen::Vector3d singular_values =
+        Eigen::JacobiSVD<Eigen::Matrix3d>(covariance).singularValues();
+    if (singular_values(1) <= kMinSingularValueRatio * singular_values(0)) {
+      VLOG(2) << "Degenerate alignment of frame rotations to the priors";
+      return {};
+    }
+    world_from_prior_world = ComputeClosestRotationMatrix(covariance);
+  }
+
+  std::unordered_map<frame_t, Rigid3d> rigs_from_prior_world;
+  rigs_from_prior_world.reserve(rigs_from_world.size());
+  for (const auto& [frame_id, rig_from_world] : rigs_from_world) {
+    const Eigen::Matrix3d rig_from_prior_world =
+        rig_from_world * world_from_prior_world;
+    rigs_from_prior_world.emplace(
+        frame_id,
+        Rigid3d(Eigen::Quaterniond(rig_from_prior_world),
+                -rig_from_prior_world * frame_positions.at(frame_id)));
+  }
+
+  return rigs_from_prior_world;
+}
+
 }  // namespace colmap
@@ -69,6 +69,7 @@ class IncrementalMapperImpl {
       const std::unordered_map<image_t, size_t>& init_num_reg_trials,
       const std::unordered_map<image_t, size_t>& num_registrations,
       std::unordered_set<image_pair_t>& init_image_pairs,
+      IncrementalMapper::InitialPairGeometryCache& init_pair_geometries,
       image_t& image_id1,
       image_t& image_id2,
       Rigid3d& cam2_from_cam1);
@@ -93,6 +94,36 @@ class IncrementalMapperImpl {
       image_t image_id1,
       image_t image_id2,
       Rigid3d& cam2_from_cam1);
+
+  // Estimate the calibrated two-view geometry of a candidate initial pair
+  // without checking it against the initialization thresholds.
+  static IncrementalMapper::InitialPairGeometry EstimateInitialPairGeometry(
+      const IncrementalMapper::Options& options,
+      const DatabaseCache& database_cache,
+      image_t image_id1,
+      image_t image_id2);
+
+  // Check a previously estimated initial pair geometry against the
+  // initialization thresholds and compute the final relative pose.
+  static bool EstimateInitialTwoViewGeometry(
+      const IncrementalMapper::Options& options,
+      const DatabaseCache& database_cache,
+      const IncrementalMapper::InitialPairGeometry& geometry,
+      image_t image_id1,
+      image_t image_id2,
+      Rigid3d& cam2_from_cam1);
+
+  // Estimate the poses of all frames with a position prior for the reference
+  // sensor image and known sensor_from_rig for all other sensors. The frame
+  // rotations are obtained from the relative poses between strongly connected
+  // frames and the global orientation is fixed by aligning the relative
+  // translation directions to the prior positions. Only the largest connected
+  // set of frames is returned and the result is empty if the alignment is
+  // degenerate, e.g., for collinear prior positions.
+  static std::unordered_map<frame_t, Rigid3d> EstimateFramePosesFromPosePriors(
+      const IncrementalMapper::Options& options,
+      const DatabaseCache& database_cache,
+      const Reconstruction& reconstruction);
 };
 
 }  // namespace colmap
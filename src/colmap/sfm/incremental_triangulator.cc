@@ -31,11 +31,16 @@
 
 #include "colmap/estimators/triangulation.h"
 #include "colmap/scene/projection.h"
+#include "colmap/scene/track_table.h"
 #include "colmap/util/misc.h"
+#include "colmap/util/threading.h"
 
 namespace colmap {
 namespace {
 
+// Enforce exhaustive sampling for small track lengths.
+constexpr int kExhaustiveSamplingThreshold = 15;
+
 bool TriangulateTrack(
     const EstimateTriangulationOptions& options,
     const std::vector<IncrementalTriangulator::CorrData>& corrs_data,
@@ -54,15 +59,67 @@ bool TriangulateTrack(
     cameras[i] = corr_data.camera;
   }
 
-  // Enforce exhaustive sampling for small track lengths.
-  EstimateTriangulationOptions options_(options);
-  const size_t kExhaustiveSamplingThreshold = 15;
-  if (points.size() <= kExhaustiveSamplingThreshold) {
-    options_.ransac_options.min_num_trials = NChooseK(points.size(), 2);
+  return EstimateTriangulation(
+      options, points, cams_from_world, cameras, &inlier_mask, &xyz);
+}
+
+EstimateTriangulationOptions CreateTriangulationOptions(
+    const IncrementalTriangulator::Options& options) {
+  EstimateTriangulationOptions tri_options;
+  tri_options.min_tri_angle = DegToRad(options.min_angle);
+  tri_options.residual_type =
+      TriangulationEstimator::ResidualType::ANGULAR_ERROR;
+  tri_options.max_num_exhaustive_sampling_observations =
+      kExhaustiveSamplingThreshold;
+  tri_options.ransac_options.max_error =
+      DegToRad(options.create_max_angle_error);
+  tri_options.ransac_options.random_seed = options.random_seed;
+  return tri_options;
+}
+
+// Extract correspondences without an existing triangulated observation.
+std::vector<IncrementalTriangulator::CorrData> ExtractCreateCorrsData(
+    const std::vector<IncrementalTriangulator::CorrData>& corrs_data) {
+  std::vector<IncrementalTriangulator::CorrData> create_corrs_data;
+  create_corrs_data.reserve(corrs_data.size());
+  for (const auto& corr_data : corrs_data) {
+    if (!corr_data.point2D->HasPoint3D()) {
+      create_corrs_data.push_back(corr_data);
+    }
   }
+  return create_corrs_data;
+}
 
-  return EstimateTriangulation(
-      options_, points, cams_from_world, cameras, &inlier_mask, &xyz);
+bool IsCreateCandidate(
+    const IncrementalTriangulator::Options& options,
+    const CorrespondenceGraph& correspondence_graph,
+    const std::vector<IncrementalTriangulator::CorrData>& create_corrs_data) {
+  if (create_corrs_data.size() < 2) {
+    // Need at least two observations for triangulation.
+    return false;
+  } else if (options.ignore_two_view_tracks && create_corrs_data.size() == 2) {
+    const auto& corr_data1 = create_corrs_data[0];
+    if (correspondence_graph.IsTwoViewObservation(corr_data1.image_id,
+                                                  corr_data1.point2D_idx)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HaveSameObservations(
+    const std::vector<IncrementalTriangulator::CorrData>& corrs_data1,
+    const std::vector<IncrementalTriangulator::CorrData>& corrs_data2) {
+  if (corrs_data1.size() != corrs_data2.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < corrs_data1.size(); ++i) {
+    if (corrs_data1[i].image_id != corrs_data2[i].image_id ||
+        corrs_data1[i].point2D_idx != corrs_data2[i].point2D_idx) {
+      return false;
+    }
+  }
+  return true;
 }
 
 }  // namespace
@@ -80,6 +137,7 @@ bool IncrementalTriangulator::Options::Check() const {
   CHECK_OPTION_GE(re_max_trials, 0);
   CHECK_OPTION_GT(min_angle, 0);
   CHECK_OPTION_GE(random_seed, -1);
+  CHECK_OPTION_GE(num_threads, -1);
   return true;
 }
 
@@ -124,15 +182,55 @@ size_t IncrementalTriangulator::TriangulateImage(const Options& options,
   // Container for correspondences from reference observation to other images.
   std::vector<CorrData> corrs_data;
 
+  // Estimate the new triangulations of observations without any triangulated
+  // correspondence in parallel. They are committed sequentially below, where
+  // the estimates are discarded if the observations changed in the meantime.
+  // The found correspondences only depend on the correspondence graph and the
+  // image poses, which do not change while committing, so they are reused
+  // and only their number of triangulated observations is updated.
+  std::vector<std::vector<CorrData>> points_corrs_data;
+  std::vector<CreateEstimate> create_estimates;
+  if (GetEffectiveNumThreads(options.num_threads) > 1) {
+    points_corrs_data.resize(image.NumPoints2D());
+    std::vector<std::vector<CorrData>> candidates_corrs_data(
+        image.NumPoints2D());
+    for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
+         ++point2D_idx) {
+      std::vector<CorrData>& point_corrs_data = points_corrs_data[point2D_idx];
+      const size_t num_triangulated =
+          Find(options,
+               image_id,
+               point2D_idx,
+               static_cast<size_t>(options.max_transitivity),
+               &point_corrs_data);
+      if (num_triangulated == 0 && !point_corrs_data.empty()) {
+        ref_corr_data.point2D_idx = point2D_idx;
+        ref_corr_data.point2D = &image.Point2D(point2D_idx);
+        candidates_corrs_data[point2D_idx] = point_corrs_data;
+        candidates_corrs_data[point2D_idx].push_back(ref_corr_data);
+      }
+    }
+    create_estimates = EstimateCreateCandidates(options, candidates_corrs_data);
+  }
+
   // Try to triangulate all image observations.
   for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
        ++point2D_idx) {
-    const size_t num_triangulated =
-        Find(options,
-             image_id,
-             point2D_idx,
-             static_cast<size_t>(options.max_transitivity),
-             &corrs_data);
+    size_t num_triangulated = 0;
+    if (points_corrs_data.empty()) {
+      num_triangulated = Find(options,
+                              image_id,
+                              point2D_idx,
+                              static_cast<size_t>(options.max_transitivity),
+                              &corrs_data);
+    } else {
+      corrs_data = std::move(points_corrs_data[point2D_idx]);
+      for (const CorrData& corr_data : corrs_data) {
+        if (corr_data.point2D->HasPoint3D()) {
+          num_triangulated += 1;
+        }
+      }
+    }
     if (corrs_data.empty()) {
       continue;
     }
@@ -143,7 +241,11 @@ size_t IncrementalTriangulator::TriangulateImage(const Options& options,
 
     if (num_triangulated == 0) {
       corrs_data.push_back(ref_corr_data);
-      num_tris += Create(options, corrs_data);
+      num_tris += Create(options,
+                         corrs_data,
+                         create_estimates.empty()
+                             ? nullptr
+                             : &create_estimates[point2D_idx]);
     } else {
       // Continue correspondences to existing 3D points.
       num_tris += Continue(options, ref_corr_data, corrs_data);
@@ -156,6 +258,60 @@ size_t IncrementalTriangulator::TriangulateImage(const Options& options,
   return num_tris;
 }
 
+size_t IncrementalTriangulator::TriangulateAllTracks(const Options& options) {
+  THROW_CHECK(options.Check());
+
+  ClearCaches();
+
+  std::vector<image_t> image_ids;
+  for (const image_t image_id : reconstruction_.RegImageIds()) {
+    if (!HasCameraBogusParams(options,
+                              *reconstruction_.Image(image_id).CameraPtr())) {
+      image_ids.push_back(image_id);
+    }
+  }
+
+  const TrackTable track_table = BuildTrackTable(
+      *correspondence_graph_, image_ids, options.num_threads);
+  const size_t num_tracks = track_table.NumTracks();
+
+  // Triangulate the tracks block-wise to bound the memory of the candidates.
+  const size_t kNumTracksPerBlock = 100000;
+  size_t num_tris = 0;
+  std::vector<std::vector<CorrData>> candidates_corrs_data;
+  for (size_t block_begin = 0; block_begin < num_tracks;
+       block_begin += kNumTracksPerBlock) {
+    const size_t block_end =
+        std::min(block_begin + kNumTracksPerBlock, num_tracks);
+    candidates_corrs_data.resize(block_end - block_begin);
+    for (size_t track_idx = block_begin; track_idx < block_end; ++track_idx) {
+      std::vector<CorrData>& corrs_data =
+          candidates_corrs_data[track_idx - block_begin];
+      corrs_data.clear();
+      for (const TrackElement& track_el : track_table.Track(track_idx)) {
+        const Image& image = reconstruction_.Image(track_el.image_id);
+        CorrData corr_data;
+        corr_data.image_id = track_el.image_id;
+        corr_data.point2D_idx = track_el.point2D_idx;
+        corr_data.image = &image;
+        corr_data.camera = image.CameraPtr();
+        corr_data.point2D = &image.Point2D(track_el.point2D_idx);
+        corrs_data.push_back(corr_data);
+      }
+    }
+
+    // Tracks are disjoint, so their estimates remain valid while committing.
+    const std::vector<CreateEstimate> create_estimates =
+        EstimateCreateCandidates(options, candidates_corrs_data);
+    for (size_t i = 0; i < candidates_corrs_data.size(); ++i) {
+      num_tris +=
+          Create(options, candidates_corrs_data[i], &create_estimates[i]);
+    }
+  }
+
+  return num_tris;
+}
+
 size_t IncrementalTriangulator::CompleteImage(const Options& options,
                                               const image_t image_id) {
   THROW_CHECK(options.Check());
@@ -179,6 +335,8 @@ size_t IncrementalTriangulator::CompleteImage(const Options& options,
   tri_options.min_tri_angle = DegToRad(options.min_angle);
   tri_options.residual_type =
       TriangulationEstimator::ResidualType::REPROJECTION_ERROR;
+  tri_options.max_num_exhaustive_sampling_observations =
+      kExhaustiveSamplingThreshold;
   tri_options.ransac_options.max_error = options.complete_max_reproj_error;
   tri_options.ransac_options.random_seed = options.random_seed;
 
@@ -358,7 +516,35 @@ size_t IncrementalTriangulator::Retriangulate(const Options& options) {
         correspondence_graph_->FindCorrespondencesBetweenImages(image_id1,
                                                                 image_id2);
 
-    for (const auto& corr : corrs) {
+    // Estimate the new triangulations of correspondences without any
+    // triangulated observation in parallel and commit them sequentially below.
+    std::vector<CreateEstimate> create_estimates;
+    if (GetEffectiveNumThreads(options.num_threads) > 1) {
+      std::vector<std::vector<CorrData>> candidates_corrs_data(corrs.size());
+      for (size_t corr_idx = 0; corr_idx < corrs.size(); ++corr_idx) {
+        const FeatureMatch& corr = corrs[corr_idx];
+        const Point2D& point2D1 = image1.Point2D(corr.point2D_idx1);
+        const Point2D& point2D2 = image2.Point2D(corr.point2D_idx2);
+        if (!point2D1.HasPoint3D() && !point2D2.HasPoint3D()) {
+          candidates_corrs_data[corr_idx] = {
+              CorrData{image_id1,
+                       corr.point2D_idx1,
+                       &image1,
+                       &camera1,
+                       &point2D1},
+              CorrData{image_id2,
+                       corr.point2D_idx2,
+                       &image2,
+                       &camera2,
+                       &point2D2}};
+        }
+      }
+      create_estimates =
+          EstimateCreateCandidates(options, candidates_corrs_data);
+    }
+
+    for (size_t corr_idx = 0; corr_idx < corrs.size(); ++corr_idx) {
+      const FeatureMatch& corr = corrs[corr_idx];
       const Point2D& point2D1 = image1.Point2D(corr.point2D_idx1);
       const Point2D& point2D2 = image2.Point2D(corr.point2D_idx2);
 
@@ -395,7 +581,11 @@ size_t IncrementalTriangulator::Retriangulate(const Options& options) {
         const std::vector<CorrData> corrs_data = {corr_data1, corr_data2};
         // Do not use larger triangulation threshold as this causes
         // significant drift when creating points (options vs. re_options).
-        num_tris += Create(options, corrs_data);
+        num_tris += Create(options,
+                           corrs_data,
+                           create_estimates.empty()
+                               ? nullptr
+                               : &create_estimates[corr_idx]);
       }
       // Else both points have a 3D point, but we do not want to
       // merge points in retriangulation.
@@ -474,41 +664,84 @@ size_t IncrementalTriangulator::Find(const Options& options,
   return num_triangulated;
 }
 
-size_t IncrementalTriangulator::Create(
-    const Options& options, const std::vector<CorrData>& corrs_data) {
-  // Extract correspondences without an existing triangulated observation.
-  std::vector<CorrData> create_corrs_data;
-  create_corrs_data.reserve(corrs_data.size());
-  for (const CorrData& corr_data : corrs_data) {
-    if (!corr_data.point2D->HasPoint3D()) {
-      create_corrs_data.push_back(corr_data);
+std::vector<IncrementalTriangulator::CreateEstimate>
+IncrementalTriangulator::EstimateCreateCandidates(
+    const Options& options,
+    const std::vector<std::vector<CorrData>>& candidates_corrs_data) const {
+  std::vector<CreateEstimate> estimates(candidates_corrs_data.size());
+
+  // Gather the observations of all candidates into contiguous arrays.
+  std::vector<size_t> estimate_idxs;
+  std::vector<size_t> point_offsets = {0};
+  std::vector<Eigen::Vector2d> points;
+  std::vector<Rigid3d> cams_from_world;
+  std::vector<Camera const*> cameras;
+  for (size_t i = 0; i < candidates_corrs_data.size(); ++i) {
+    CreateEstimate& estimate = estimates[i];
+    estimate.corrs_data = ExtractCreateCorrsData(candidates_corrs_data[i]);
+    if (!IsCreateCandidate(
+            options, *correspondence_graph_, estimate.corrs_data)) {
+      continue;
+    }
+    estimate_idxs.push_back(i);
+    for (const CorrData& corr_data : estimate.corrs_data) {
+      points.push_back(corr_data.point2D->xy);
+      cams_from_world.push_back(corr_data.image->CamFromWorld());
+      cameras.push_back(corr_data.camera);
     }
+    point_offsets.push_back(points.size());
   }
 
-  if (create_corrs_data.size() < 2) {
-    // Need at least two observations for triangulation.
-    return 0;
-  } else if (options.ignore_two_view_tracks && create_corrs_data.size() == 2) {
-    const CorrData& corr_data1 = create_corrs_data[0];
-    if (correspondence_graph_->IsTwoViewObservation(corr_data1.image_id,
-                                                    corr_data1.point2D_idx)) {
-      return 0;
+  std::vector<char> success;
+  std::vector<char> inlier_masks;
+  std::vector<Eigen::Vector3d> xyzs;
+  EstimateTriangulations(CreateTriangulationOptions(options),
+                         point_offsets,
+                         points,
+                         cams_from_world,
+                         cameras,
+                         options.num_threads,
+                         &success,
+                         &inlier_masks,
+                         &xyzs);
+
+  for (size_t k = 0; k < estimate_idxs.size(); ++k) {
+    CreateEstimate& estimate = estimates[estimate_idxs[k]];
+    estimate.success = success[k];
+    if (estimate.success) {
+      estimate.inlier_mask.assign(inlier_masks.begin() + point_offsets[k],
+                                  inlier_masks.begin() + point_offsets[k + 1]);
+      estimate.xyz = xyzs[k];
     }
   }
 
-  // Setup estimation options.
-  EstimateTriangulationOptions tri_options;
-  tri_options.min_tri_angle = DegToRad(options.min_angle);
-  tri_options.residual_type =
-      TriangulationEstimator::ResidualType::ANGULAR_ERROR;
-  tri_options.ransac_options.max_error =
-      DegToRad(options.create_max_angle_error);
-  tri_options.ransac_options.random_seed = options.random_seed;
+  return estimates;
+}
+
+size_t IncrementalTriangulator::Create(const Options& options,
+                                       const std::vector<CorrData>& corrs_data,
+                                       const CreateEstimate* estimate) {
+  const std::vector<CorrData> create_corrs_data =
+      ExtractCreateCorrsData(corrs_data);
+  if (!IsCreateCandidate(options, *correspondence_graph_, create_corrs_data)) {
+    return 0;
+  }
 
-  // Estimate triangulation.
+  // Estimate triangulation or reuse the given estimate for the same
+  // observations, which yields the same result.
   Eigen::Vector3d xyz;
   std::vector<char> inlier_mask;
-  if (!TriangulateTrack(tri_options, create_corrs_data, inlier_mask, xyz)) {
+  if (estimate != nullptr &&
+      HaveSameObservations(estimate->corrs_data, create_corrs_data)) {
+    if (!estimate->success) {
+      return 0;
+    }
+    xyz = estimate->xyz;
+    inlier_mask = estimate->inlier_mask;
+  } else if (!TriangulateTrack(CreateTriangulationOptions(options),
+                               create_corrs_data,
+                               inlier_mask,
+                               xyz)) {
     return 0;
   }
 
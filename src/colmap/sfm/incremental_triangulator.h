@@ -86,6 +86,11 @@ class IncrementalTriangulator {
     // PRNG seed for all stochastic methods during triangulation.
     int random_seed = -1;
 
+    // Number of threads to estimate independent new triangulations in
+    // parallel. The results are the same as for sequential triangulation,
+    // if the random seed is set.
+    int num_threads = -1;
+
     bool Check() const;
   };
 
@@ -105,6 +110,15 @@ class IncrementalTriangulator {
   // in the associated reconstruction.
   size_t TriangulateImage(const Options& options, image_t image_id);
 
+  // Triangulate all tracks between registered images at once, e.g., for
+  // triangulation against known and fixed poses.
+  //
+  // The tracks are the connected components of the correspondence graph
+  // restricted to registered images. Since the tracks are disjoint, they are
+  // triangulated independently in parallel. Already triangulated observations
+  // are not changed. Returns the number of triangulated observations.
+  size_t TriangulateAllTracks(const Options& options);
+
   // Complete triangulations for image. Tries to create new tracks for not
   // yet triangulated observations and tries to complete existing tracks.
   // Returns the number of completed observations.
@@ -173,9 +187,29 @@ class IncrementalTriangulator {
               size_t transitivity,
               std::vector<CorrData>* corrs_data);
 
-  // Try to create a new 3D point from the given correspondences.
+  // Result of a triangulation estimated ahead of its creation.
+  struct CreateEstimate {
+    // Observations that were triangulated, i.e. not yet triangulated
+    // observations at the time of the estimation.
+    std::vector<CorrData> corrs_data;
+    bool success = false;
+    std::vector<char> inlier_mask;
+    Eigen::Vector3d xyz;
+  };
+
+  // Estimate the triangulations of the given create candidates in parallel.
+  // The estimation only reads the reconstruction, so that the estimates can
+  // then be committed sequentially by Create in the original order.
+  std::vector<CreateEstimate> EstimateCreateCandidates(
+      const Options& options,
+      const std::vector<std::vector<CorrData>>& candidates_corrs_data) const;
+
+  // Try to create a new 3D point from the given correspondences. If the
+  // given estimate was computed for the same observations, it is used instead
+  // of estimating the triangulation again.
   size_t Create(const Options& options,
-                const std::vector<CorrData>& corrs_data);
+                const std::vector<CorrData>& corrs_data,
+                const CreateEstimate* estimate = nullptr);
 
   // Try to continue the 3D point with the given correspondences.
   size_t Continue(const Options& options,
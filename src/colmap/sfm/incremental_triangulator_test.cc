@@ -29,6 +29,10 @@
 
 #include "colmap/sfm/incremental_triangulator.h"
 
+#include "colmap/scene/database_cache.h"
+#include "colmap/scene/synthetic.h"
+#include "colmap/util/eigen_matchers.h"
+
 #include <gtest/gtest.h>
 
 namespace colmap {
@@ -48,5 +52,50 @@ TEST(IncrementalTriangulator, Print) {
       "num_image_pairs=0))");
 }
 
+TEST(IncrementalTriangulator, TriangulateAllTracks) {
+  Database database(Database::kInMemoryDatabasePath);
+  Reconstruction gt_reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_frames_per_rig = 5;
+  synthetic_dataset_options.num_points3D = 100;
+  synthetic_dataset_options.point2D_stddev = 0;
+  SynthesizeDataset(synthetic_dataset_options, &gt_reconstruction, &database);
+  const auto database_cache =
+      DatabaseCache::Create(database,
+                            /*min_num_matches=*/0,
+                            /*ignore_watermarks=*/false,
+                            /*image_names=*/{});
+
+  for (const int num_threads : {1, 3}) {
+    Reconstruction reconstruction = gt_reconstruction;
+    reconstruction.DeleteAllPoints2DAndPoints3D();
+    reconstruction.Load(*database_cache);
+    IncrementalTriangulator triangulator(
+        database_cache->CorrespondenceGraph(), reconstruction);
+
+    IncrementalTriangulator::Options options;
+    options.num_threads = num_threads;
+    options.random_seed = 42;
+    EXPECT_EQ(triangulator.TriangulateAllTracks(options),
+              gt_reconstruction.ComputeNumObservations());
+    EXPECT_EQ(reconstruction.NumPoints3D(), gt_reconstruction.NumPoints3D());
+    EXPECT_EQ(triangulator.GetModifiedPoints3D().size(),
+              gt_reconstruction.NumPoints3D());
+
+    for (const auto& [_, point3D] : reconstruction.Points3D()) {
+      const TrackElement& track_el = point3D.track.Element(0);
+      const point3D_t gt_point3D_id = gt_reconstruction.Image(track_el.image_id)
+                                          .Point2D(track_el.point2D_idx)
+                                          .point3D_id;
+      const Point3D& gt_point3D = gt_reconstruction.Point3D(gt_point3D_id);
+      EXPECT_EQ(point3D.track.Length(), gt_point3D.track.Length());
+      EXPECT_THAT(point3D.xyz, EigenMatrixNear(gt_point3D.xyz, 1e-4));
+    }
+
+    // Already triangulated observations are not changed.
+    EXPECT_EQ(triangulator.TriangulateAllTracks(options), 0);
+  }
+}
+
 }  // namespace
 }  // namespace colmap
@@ -0,0 +1,393 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "colmap/sfm/localized_registration.h"
+
+#include "colmap/geometry/gps.h"
+#include "colmap/util/logging.h"
+#include "colmap/util/misc.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace colmap {
+namespace {
+
+// Read the valid pose prior positions of the given images. WGS84 positions are
+// converted to ECEF coordinates, such that all positions are metric.
+std::vector<std::pair<image_t, Eigen::Vector3d>> ReadPriorPositions(
+    const Database& database, const std::unordered_set<image_t>& image_ids) {
+  std::vector<image_t> gps_image_ids;
+  std::vector<Eigen::Vector3d> gps_positions;
+  std::vector<std::pair<image_t, Eigen::Vector3d>> positions;
+  for (const image_t image_id : image_ids) {
+    if (!database.ExistsPosePrior(image_id)) {
+      continue;
+    }
+    const PosePrior pose_prior = database.ReadPosePrior(image_id);
+    if (!pose_prior.IsValid()) {
+      continue;
+    }
+    if (pose_prior.coordinate_system == PosePrior::CoordinateSystem::WGS84) {
+      gps_image_ids.push_back(image_id);
+      gps_positions.push_back(pose_prior.position);
+    } else {
+      positions.emplace_back(image_id, pose_prior.position);
+    }
+  }
+
+  if (!gps_positions.empty()) {
+    const GPSTransform gps_transform(GPSTransform::Ellipsoid::WGS84);
+    const std::vector<Eigen::Vector3d> ecef_positions =
+        gps_transform.EllipsoidToECEF(gps_positions);
+    for (size_t i = 0; i < gps_image_ids.size(); ++i) {
+      positions.emplace_back(gps_image_ids[i], ecef_positions[i]);
+    }
+  }
+
+  return positions;
+}
+
+}  // namespace
+
+bool LocalizedRegistrationOptions::Check() const {
+  CHECK_OPTION_GE(min_num_matches, 0);
+  CHECK_OPTION_GT(max_num_neighbors, 0);
+  return true;
+}
+
+std::unordered_set<std::string> FindLocalizedRegistrationImageNames(
+    const LocalizedRegistrationOptions& options,
+    const Database& database,
+    const Reconstruction& reconstruction) {
+  THROW_CHECK(options.Check());
+
+  std::unordered_map<image_t, std::string> image_names;
+  std::unordered_set<image_t> new_image_ids;
+  std::unordered_set<image_t> reg_image_ids;
+  for (const Image& image : database.ReadAllImages()) {
+    const image_t image_id = image.ImageId();
+    if (reconstruction.ExistsImage(image_id) &&
+        reconstruction.Image(image_id).HasPose()) {
+      reg_image_ids.insert(image_id);
+    } else if (options.image_names.empty() ||
+               options.image_names.count(image.Name()) > 0) {
+      new_image_ids.insert(image_id);
+    }
+    image_names.emplace(image_id, image.Name());
+  }
+
+  std::unordered_set<std::string> neighborhood_image_names;
+  neighborhood_image_names.reserve(new_image_ids.size() *
+                                   (options.max_num_neighbors + 1));
+  for (const image_t image_id : new_image_ids) {
+    neighborhood_image_names.insert(image_names.at(image_id));
+  }
+
+  // Add the registered images with the most inlier matches to each new image.
+  std::unordered_map<image_t, std::vector<std::pair<int, image_t>>> neighbors;
+  for (const auto& [pair_id, num_inliers] :
+       database.ReadTwoViewGeometryNumInliers()) {
+    if (num_inliers < options.min_num_matches) {
+      continue;
+    }
+    const auto [image_id1, image_id2] = PairIdToImagePair(pair_id);
+    if (new_image_ids.count(image_id1) > 0 &&
+        reg_image_ids.count(image_id2) > 0) {
+      neighbors[image_id1].emplace_back(num_inliers, image_id2);
+    } else if (new_image_ids.count(image_id2) > 0 &&
+               reg_image_ids.count(image_id1) > 0) {
+      neighbors[image_id2].emplace_back(num_inliers, image_id1);
+    }
+  }
+
+  for (auto& [_, image_neighbors] : neighbors) {
+    const size_t num_neighbors = std::min(
+        image_neighbors.size(), static_cast<size_t>(options.max_num_neighbors));
+    std::partial_sort(image_neighbors.begin(),
+                      image_neighbors.begin() + num_neighbors,
+                      image_neighbors.end(),
+                      std::greater<>());
+    for (size_t i = 0; i < num_neighbors; ++i) {
+      neighborhood_image_names.insert(
+          image_names.at(image_neighbors[i].second));
+    }
+  }
+
+  // Add the registered images with nearby pose priors.
+  if (options.max_prior_distance > 0) {
+    const std::vector<std::pair<image_t, Eigen::Vector3d>>
+        new_prior_positions = ReadPriorPositions(database, new_image_ids);
+    if (!new_prior_positions.empty()) {
+      const double max_squared_prior_distance =
+          options.max_prior_distance * options.max_prior_distance;
+      for (const auto& [reg_image_id, reg_position] :
+           ReadPriorPositions(database, reg_image_ids)) {
+        for (const auto& [_, new_position] : new_prior_positions) {
+          if ((reg_position - new_position).squaredNorm() <=
+              max_squared_prior_distance) {
+            neighborhood_image_names.insert(image_names.at(reg_image_id));
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  LOG(INFO) << StringPrintf(
+      "Localized registration of %d new images with %d neighbor images",
+      new_image_ids.size(),
+      neighborhood_image_names.size() - new_image_ids.size());
+
+  return neighborhood_image_names;
+}
+
+std::unordered_set<frame_t> FindLocalFrameIds(
+    const DatabaseCache& database_cache, const Reconstruction& reconstruction) {
+  std::unordered_set<frame_t> frame_ids;
+  for (const auto& [image_id, _] : database_cache.Images()) {
+    if (!reconstruction.ExistsImage(image_id)) {
+      continue;
+    }
+    const Image& image = reconstruction.Image(image_id);
+    if (!image.HasPose() || frame_ids.count(image.FrameId()) > 0) {
+      continue;
+    }
+    // The mapper requires correspondences for all images of a frame.
+    bool has_all_images = true;
+    for (const data_t& data_id : image.FramePtr()->ImageIds()) {
+      if (!database_cache.ExistsImage(data_id.id)) {
+        has_all_images = false;
+        break;
+      }
+    }
+    if (has_all_images) {
+      frame_ids.insert(image.FrameId());
+    }
+  }
+  return frame_ids;
+}
+
+Reconstruction ExtractLocalReconstruction(
+    const Reconstruction& reconstruction,
+    const std::unordered_set<frame_t>& frame_ids) {
+  Reconstruction local_reconstruction;
+
+  std::unordered_set<image_t> image_ids;
+  for (const frame_t frame_id : frame_ids) {
+    Frame frame = reconstruction.Frame(frame_id);
+    THROW_CHECK(frame.HasPose());
+
+    if (!local_reconstruction.ExistsRig(frame.RigId())) {
+      const Rig& rig = reconstruction.Rig(frame.RigId());
+      for (const auto& [sensor_id, _] : rig.Sensors()) {
+        if (sensor_id.type == SensorType::CAMERA &&
+            !local_reconstruction.ExistsCamera(sensor_id.id)) {
+          local_reconstruction.AddCamera(reconstruction.Camera(sensor_id.id));
+        }
+      }
+      const sensor_t& ref_sensor_id = rig.RefSensorId();
+      if (ref_sensor_id.type == SensorType::CAMERA &&
+          !local_reconstruction.ExistsCamera(ref_sensor_id.id)) {
+        local_reconstruction.AddCamera(reconstruction.Camera(ref_sensor_id.id));
+      }
+      local_reconstruction.AddRig(rig);
+    }
+
+    frame.ResetRigPtr();
+    local_reconstruction.AddFrame(std::move(frame));
+
+    for (const data_t& data_id : reconstruction.Frame(frame_id).ImageIds()) {
+      Image image = reconstruction.Image(data_id.id);
+      image.ResetCameraPtr();
+      image.ResetFramePtr();
+      const point2D_t num_points2D = image.NumPoints2D();
+      for (point2D_t point2D_idx = 0; point2D_idx < num_points2D;
+           ++point2D_idx) {
+        image.ResetPoint3DForPoint2D(point2D_idx);
+      }
+      local_reconstruction.AddImage(std::move(image));
+      image_ids.insert(data_id.id);
+    }
+  }
+
+  for (const image_t image_id : image_ids) {
+    for (const Point2D& point2D : reconstruction.Image(image_id).Points2D()) {
+      if (!point2D.HasPoint3D() ||
+          local_reconstruction.ExistsPoint3D(point2D.point3D_id)) {
+        continue;
+      }
+
+      Point3D point3D = reconstruction.Point3D(point2D.point3D_id);
+      std::vector<TrackElement> local_track_elements;
+      local_track_elements.reserve(point3D.track.Length());
+      for (const TrackElement& track_el : point3D.track.Elements()) {
+        if (image_ids.count(track_el.image_id) > 0) {
+          local_reconstruction.Image(track_el.image_id)
+              .SetPoint3DForPoint2D(track_el.point2D_idx, point2D.point3D_id);
+          local_track_elements.push_back(track_el);
+        }
+      }
+      point3D.track.SetElements(std::move(local_track_elements));
+
+      local_reconstruction.AddPoint3D(point2D.point3D_id, std::move(point3D));
+    }
+  }
+
+  return local_reconstruction;
+}
+
+void MergeLocalReconstruction(const Reconstruction& local_reconstruction,
+                              const std::unordered_set<frame_t>& frame_ids,
+                              Reconstruction& reconstruction) {
+  // Add new rigs, cameras, frames, and images.
+
+  for (const auto& [camera_id, camera] : local_reconstruction.Cameras()) {
+    if (!reconstruction.ExistsCamera(camera_id)) {
+      reconstruction.AddCamera(camera);
+    }
+  }
+
+  for (const auto& [rig_id, rig] : local_reconstruction.Rigs()) {
+    if (!reconstruction.ExistsRig(rig_id)) {
+      reconstruction.AddRig(rig);
+    }
+  }
+
+  for (auto [frame_id, frame] : local_reconstruction.Frames()) {
+    if (!reconstruction.ExistsFrame(frame_id)) {
+      frame.ResetRigPtr();
+      frame.ResetPose();
+      reconstruction.AddFrame(std::move(frame));
+    }
+  }
+
+  for (auto [image_id, image] : local_reconstruction.Images()) {
+    if (!reconstruction.ExistsImage(image_id)) {
+      image.ResetCameraPtr();
+      image.ResetFramePtr();
+      const point2D_t num_points2D = image.NumPoints2D();
+      for (point2D_t point2D_idx = 0; point2D_idx < num_points2D;
+           ++point2D_idx) {
+        image.ResetPoint3DForPoint2D(point2D_idx);
+      }
+      reconstruction.AddImage(std::move(image));
+    }
+  }
+
+  // Detach the extracted 3D points from the reconstruction and only keep their
+  // observations outside of the local reconstruction.
+
+  std::unordered_set<image_t> local_image_ids;
+  for (const frame_t frame_id : frame_ids) {
+    for (const data_t& data_id : reconstruction.Frame(frame_id).ImageIds()) {
+      local_image_ids.insert(data_id.id);
+    }
+  }
+
+  std::unordered_map<point3D_t, Point3D> outer_points3D;
+  for (const image_t image_id : local_image_ids) {
+    for (const Point2D& point2D : reconstruction.Image(image_id).Points2D()) {
+      if (!point2D.HasPoint3D() ||
+          outer_points3D.count(point2D.point3D_id) > 0) {
+        continue;
+      }
+      Point3D point3D = reconstruction.Point3D(point2D.point3D_id);
+      std::vector<TrackElement>& track_elements = point3D.track.Elements();
+      track_elements.erase(
+          std::remove_if(track_elements.begin(),
+                         track_elements.end(),
+                         [&local_image_ids](const TrackElement& track_el) {
+                           return local_image_ids.count(track_el.image_id) > 0;
+                         }),
+          track_elements.end());
+      outer_points3D.emplace(point2D.point3D_id, std::move(point3D));
+    }
+  }
+
+  for (const auto& [point3D_id, _] : outer_points3D) {
+    reconstruction.DeletePoint3D(point3D_id);
+  }
+
+  // Update the poses of the local frames.
+
+  for (const auto& [frame_id, local_frame] : local_reconstruction.Frames()) {
+    if (local_frame.HasPose()) {
+      reconstruction.Frame(frame_id).SetRigFromWorld(
+          local_frame.RigFromWorld());
+      reconstruction.RegisterFrame(frame_id);
+    }
+  }
+
+  for (const frame_t frame_id : frame_ids) {
+    if (!local_reconstruction.ExistsFrame(frame_id) ||
+        !local_reconstruction.Frame(frame_id).HasPose()) {
+      reconstruction.DeRegisterFrame(frame_id);
+    }
+  }
+
+  // Re-attach the extracted 3D points with their updated local observations.
+
+  for (auto& [point3D_id, point3D] : outer_points3D) {
+    if (local_reconstruction.ExistsPoint3D(point3D_id)) {
+      const Point3D& local_point3D =
+          local_reconstruction.Point3D(point3D_id);
+      // 3D points observed outside of the local reconstruction keep their
+      // position, as the local reconstruction only sees part of their track.
+      if (point3D.track.Length() == 0) {
+        point3D.xyz = local_point3D.xyz;
+        point3D.error = local_point3D.error;
+      }
+      point3D.color = local_point3D.color;
+      point3D.track.AddElements(local_point3D.track.Elements());
+    }
+
+    if (point3D.track.Length() < 2) {
+      continue;
+    }
+
+    for (const TrackElement& track_el : point3D.track.Elements()) {
+      reconstruction.Image(track_el.image_id)
+          .SetPoint3DForPoint2D(track_el.point2D_idx, point3D_id);
+    }
+    reconstruction.AddPoint3D(point3D_id, std::move(point3D));
+  }
+
+  // Add the new 3D points of the local reconstruction.
+
+  for (const auto& [point3D_id, point3D] : local_reconstruction.Points3D()) {
+    if (outer_points3D.count(point3D_id) == 0) {
+      const point3D_t new_point3D_id =
+          reconstruction.AddPoint3D(point3D.xyz, point3D.track, point3D.color);
+      reconstruction.Point3D(new_point3D_id).error = point3D.error;
+    }
+  }
+}
+
+}  // namespace colmap
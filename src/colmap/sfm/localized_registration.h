@@ -0,0 +1,119 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "colmap/scene/database.h"
+#include "colmap/scene/database_cache.h"
+#include "colmap/scene/reconstruction.h"
+#include "colmap/util/types.h"
+
+#include <string>
+#include <unordered_set>
+
+namespace colmap {
+
+// Localized registration of a small batch of new images into a large existing
+// reconstruction. Instead of loading the full database and reconstruction into
+// the incremental mapper, only the neighborhood of the new images is loaded
+// and reconstructed, and the changes are then written back:
+//
+//    const auto image_names = FindLocalizedRegistrationImageNames(
+//        options, database, reconstruction);
+//    auto database_cache = DatabaseCache::Create(
+//        database, min_num_matches, ignore_watermarks, image_names);
+//    const auto frame_ids = FindLocalFrameIds(*database_cache, reconstruction);
+//    auto local_reconstruction = std::make_shared<Reconstruction>(
+//        ExtractLocalReconstruction(reconstruction, frame_ids));
+//    // Register the new images into the local reconstruction.
+//    MergeLocalReconstruction(*local_reconstruction, frame_ids,
+//                             reconstruction);
+//
+struct LocalizedRegistrationOptions {
+  // Minimum number of inlier matches for a registered image to be considered
+  // a neighbor of a new image.
+  int min_num_matches = 15;
+
+  // Maximum number of registered neighbor images per new image, ranked by
+  // their number of inlier matches to the new image.
+  int max_num_neighbors = 50;
+
+  // Registered images whose pose prior is closer than this distance to the
+  // pose prior of a new image are also added to the neighborhood. WGS84
+  // priors are compared in ECEF coordinates. Disabled if non-positive.
+  double max_prior_distance = 0.0;
+
+  // Only register the unregistered database images with the given names.
+  // All unregistered database images are registered if empty.
+  std::unordered_set<std::string> image_names;
+
+  bool Check() const;
+};
+
+// Find the names of the new images to register, i.e., the database images
+// that are not registered in the reconstruction, together with the names of
+// their registered neighbor images. The returned names are intended to be
+// passed to `DatabaseCache::Load`. Only the number of inlier matches is read
+// from the database and not the matches themselves.
+std::unordered_set<std::string> FindLocalizedRegistrationImageNames(
+    const LocalizedRegistrationOptions& options,
+    const Database& database,
+    const Reconstruction& reconstruction);
+
+// Find the registered frames of the reconstruction with images in the
+// correspondence graph of the database cache.
+std::unordered_set<frame_t> FindLocalFrameIds(
+    const DatabaseCache& database_cache, const Reconstruction& reconstruction);
+
+// Extract the given registered frames together with their rigs, cameras,
+// images, and all observed 3D points into a new reconstruction. The tracks of
+// the 3D points are restricted to the images of the extracted frames and the
+// 3D points keep their identifiers.
+Reconstruction ExtractLocalReconstruction(
+    const Reconstruction& reconstruction,
+    const std::unordered_set<frame_t>& frame_ids);
+
+// Write the changes of a local reconstruction, previously extracted from the
+// given frames, back into the full reconstruction:
+//
+// - New rigs, cameras, frames, and images are added. Existing rigs and cameras
+//   are left unchanged, as they may be shared with frames outside of the local
+//   reconstruction.
+// - The poses of the local frames are updated and frames, which are no longer
+//   registered in the local reconstruction, are de-registered.
+// - The tracks of the extracted 3D points are updated, while keeping their
+//   observations outside of the local reconstruction. 3D points observed
+//   outside of the local reconstruction keep their position. Extracted 3D
+//   points with less than two remaining observations are deleted.
+// - New 3D points are added with new identifiers.
+void MergeLocalReconstruction(const Reconstruction& local_reconstruction,
+                              const std::unordered_set<frame_t>& frame_ids,
+                              Reconstruction& reconstruction);
+
+}  // namespace colmap
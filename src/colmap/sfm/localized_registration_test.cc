@@ -0,0 +1,221 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "colmap/sfm/localized_registration.h"
+
+#include "colmap/scene/synthetic.h"
+
+#include <gtest/gtest.h>
+
+namespace colmap {
+namespace {
+
+std::unordered_set<frame_t> FirstRegFrameIds(
+    const Reconstruction& reconstruction, size_t num_frames) {
+  std::unordered_set<frame_t> frame_ids;
+  for (const frame_t frame_id : reconstruction.RegFrameIds()) {
+    if (frame_ids.size() == num_frames) {
+      break;
+    }
+    frame_ids.insert(frame_id);
+  }
+  return frame_ids;
+}
+
+TEST(LocalizedRegistration, FindImageNames) {
+  Database database(Database::kInMemoryDatabasePath);
+  Reconstruction reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_rigs = 1;
+  synthetic_dataset_options.num_cameras_per_rig = 1;
+  synthetic_dataset_options.num_frames_per_rig = 6;
+  synthetic_dataset_options.num_points3D = 50;
+  SynthesizeDataset(synthetic_dataset_options, &reconstruction, &database);
+
+  const frame_t new_frame_id = reconstruction.RegFrameIds().front();
+  const image_t new_image_id =
+      reconstruction.Frame(new_frame_id).ImageIds().begin()->id;
+  const std::string new_image_name = reconstruction.Image(new_image_id).Name();
+  reconstruction.DeRegisterFrame(new_frame_id);
+
+  LocalizedRegistrationOptions options;
+  options.max_num_neighbors = 2;
+  const std::unordered_set<std::string> image_names =
+      FindLocalizedRegistrationImageNames(options, database, reconstruction);
+  EXPECT_EQ(image_names.size(), 3);
+  EXPECT_EQ(image_names.count(new_image_name), 1);
+
+  const auto database_cache =
+      DatabaseCache::Create(database,
+                            options.min_num_matches,
+                            /*ignore_watermarks=*/false,
+                            image_names);
+  const std::unordered_set<frame_t> frame_ids =
+      FindLocalFrameIds(*database_cache, reconstruction);
+  EXPECT_EQ(frame_ids.size(), 2);
+  EXPECT_EQ(frame_ids.count(new_frame_id), 0);
+
+  options.max_num_neighbors = 100;
+  EXPECT_EQ(
+      FindLocalizedRegistrationImageNames(options, database, reconstruction)
+          .size(),
+      reconstruction.NumImages());
+
+  options.image_names = {"unknown"};
+  EXPECT_TRUE(
+      FindLocalizedRegistrationImageNames(options, database, reconstruction)
+          .empty());
+}
+
+TEST(LocalizedRegistration, ExtractAndMergeUnchanged) {
+  Reconstruction reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_rigs = 2;
+  synthetic_dataset_options.num_cameras_per_rig = 2;
+  synthetic_dataset_options.num_frames_per_rig = 4;
+  synthetic_dataset_options.num_points3D = 50;
+  SynthesizeDataset(synthetic_dataset_options, &reconstruction);
+
+  const std::unordered_set<frame_t> frame_ids =
+      FirstRegFrameIds(reconstruction, 3);
+  const Reconstruction local_reconstruction =
+      ExtractLocalReconstruction(reconstruction, frame_ids);
+  EXPECT_EQ(local_reconstruction.NumRegFrames(), frame_ids.size());
+  EXPECT_EQ(local_reconstruction.NumImages(), 2 * frame_ids.size());
+  EXPECT_GT(local_reconstruction.NumPoints3D(), 0);
+  for (const auto& [point3D_id, point3D] : local_reconstruction.Points3D()) {
+    EXPECT_EQ(point3D.xyz, reconstruction.Point3D(point3D_id).xyz);
+    for (const auto& track_el : point3D.track.Elements()) {
+      const Image& image = local_reconstruction.Image(track_el.image_id);
+      EXPECT_EQ(frame_ids.count(image.FrameId()), 1);
+      EXPECT_EQ(image.Point2D(track_el.point2D_idx).point3D_id, point3D_id);
+    }
+  }
+
+  Reconstruction merged_reconstruction = reconstruction;
+  MergeLocalReconstruction(
+      local_reconstruction, frame_ids, merged_reconstruction);
+  EXPECT_EQ(merged_reconstruction.NumRegFrames(),
+            reconstruction.NumRegFrames());
+  EXPECT_EQ(merged_reconstruction.NumPoints3D(), reconstruction.NumPoints3D());
+  EXPECT_EQ(merged_reconstruction.ComputeNumObservations(),
+            reconstruction.ComputeNumObservations());
+  for (const auto& [point3D_id, point3D] : reconstruction.Points3D()) {
+    ASSERT_TRUE(merged_reconstruction.ExistsPoint3D(point3D_id));
+    const Point3D& merged_point3D = merged_reconstruction.Point3D(point3D_id);
+    EXPECT_EQ(merged_point3D.xyz, point3D.xyz);
+    EXPECT_EQ(merged_point3D.track.Length(), point3D.track.Length());
+  }
+}
+
+TEST(LocalizedRegistration, MergeRegisteredFrame) {
+  Reconstruction reconstruction;
+  SyntheticDatasetOptions synthetic_dataset_options;
+  synthetic_dataset_options.num_rigs = 1;
+  synthetic_dataset_options.num_cameras_per_rig = 1;
+  synthetic_dataset_options.num_frames_per_rig = 6;
+  synthetic_dataset_options.num_points3D = 50;
+  SynthesizeDataset(synthetic_dataset_options, &reconstruction);
+
+  // Simulate the registration of a previously unregistered frame with
+  // observations of existing and new 3D points in the local reconstruction.
+  const frame_t new_frame_id = reconstruction.RegFrameIds().front();
+  const image_t new_image_id =
+      reconstruction.Frame(new_frame_id).ImageIds().begin()->id;
+  Reconstruction partial_reconstruction = reconstruction;
+  partial_reconstruction.DeRegisterFrame(new_frame_id);
+
+  std::unordered_set<frame_t> frame_ids(
+      partial_reconstruction.RegFrameIds().begin(),
+      partial_reconstruction.RegFrameIds().end());
+  frame_ids.erase(partial_reconstruction.RegFrameIds().back());
+  Reconstruction local_reconstruction =
+      ExtractLocalReconstruction(partial_reconstruction, frame_ids);
+
+  Frame new_frame = reconstruction.Frame(new_frame_id);
+  new_frame.ResetRigPtr();
+  local_reconstruction.AddFrame(new_frame);
+  Image new_image = reconstruction.Image(new_image_id);
+  new_image.ResetCameraPtr();
+  new_image.ResetFramePtr();
+  for (point2D_t point2D_idx = 0; point2D_idx < new_image.NumPoints2D();
+       ++point2D_idx) {
+    new_image.ResetPoint3DForPoint2D(point2D_idx);
+  }
+  local_reconstruction.AddImage(new_image);
+
+  size_t num_continued_points3D = 0;
+  point2D_t untriangulated_point2D_idx = kInvalidPoint2DIdx;
+  const Image& image = reconstruction.Image(new_image_id);
+  for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
+       ++point2D_idx) {
+    const Point2D& point2D = image.Point2D(point2D_idx);
+    if (!point2D.HasPoint3D()) {
+      untriangulated_point2D_idx = point2D_idx;
+    } else if (local_reconstruction.ExistsPoint3D(point2D.point3D_id)) {
+      local_reconstruction.AddObservation(
+          point2D.point3D_id, TrackElement(new_image_id, point2D_idx));
+      ++num_continued_points3D;
+    }
+  }
+  ASSERT_GT(num_continued_points3D, 0);
+  ASSERT_NE(untriangulated_point2D_idx, kInvalidPoint2DIdx);
+
+  const image_t local_image_id =
+      reconstruction.Frame(*frame_ids.begin()).ImageIds().begin()->id;
+  const Image& local_image = local_reconstruction.Image(local_image_id);
+  for (point2D_t point2D_idx = 0; point2D_idx < local_image.NumPoints2D();
+       ++point2D_idx) {
+    if (!local_image.Point2D(point2D_idx).HasPoint3D()) {
+      Track track;
+      track.AddElement(new_image_id, untriangulated_point2D_idx);
+      track.AddElement(local_image_id, point2D_idx);
+      local_reconstruction.AddPoint3D(Eigen::Vector3d::Zero(), track);
+      break;
+    }
+  }
+
+  const size_t num_points3D = partial_reconstruction.NumPoints3D();
+  const size_t num_observations =
+      partial_reconstruction.ComputeNumObservations();
+  MergeLocalReconstruction(
+      local_reconstruction, frame_ids, partial_reconstruction);
+
+  EXPECT_EQ(partial_reconstruction.NumRegFrames(),
+            reconstruction.NumRegFrames());
+  EXPECT_TRUE(partial_reconstruction.Frame(new_frame_id).HasPose());
+  EXPECT_EQ(partial_reconstruction.NumPoints3D(), num_points3D + 1);
+  EXPECT_EQ(partial_reconstruction.ComputeNumObservations(),
+            num_observations + num_continued_points3D + 2);
+  EXPECT_EQ(partial_reconstruction.Image(new_image_id).NumPoints3D(),
+            num_continued_points3D + 1);
+}
+
+}  // namespace
+}  // namespace colmap
@@ -35,8 +35,30 @@
 #include "colmap/scene/projection.h"
 #include "colmap/util/logging.h"
 #include "colmap/util/misc.h"
+#include "colmap/util/threading.h"
 
 namespace colmap {
+namespace {
+
+// Filter decisions only depend on the 3D point itself. They are evaluated in
+// parallel for batches of 3D points and then applied sequentially.
+constexpr size_t kFilterBatchSize = 1 << 16;
+constexpr size_t kFilterChunkSize = 4096;
+
+std::vector<point3D_t> ExistingPoint3DIds(
+    const Reconstruction& reconstruction,
+    const std::unordered_set<point3D_t>& point3D_ids) {
+  std::vector<point3D_t> existing_point3D_ids;
+  existing_point3D_ids.reserve(point3D_ids.size());
+  for (const point3D_t point3D_id : point3D_ids) {
+    if (reconstruction.ExistsPoint3D(point3D_id)) {
+      existing_point3D_ids.push_back(point3D_id);
+    }
+  }
+  return existing_point3D_ids;
+}
+
+}  // namespace
 
 bool MergeAndFilterReconstructions(const double max_reproj_error,
                                    const Reconstruction& src_reconstruction,
@@ -277,19 +299,21 @@ point3D_t ObservationManager::MergePoints3D(const point3D_t point3D_id1,
 size_t ObservationManager::FilterPoints3D(
     const double max_reproj_error,
     const double min_tri_angle,
-    const std::unordered_set<point3D_t>& point3D_ids) {
+    const std::unordered_set<point3D_t>& point3D_ids,
+    const int num_threads) {
   size_t num_filtered_observations = 0;
-  num_filtered_observations +=
-      FilterPoints3DWithLargeReprojectionError(max_reproj_error, point3D_ids);
-  num_filtered_observations +=
-      FilterPoints3DWithSmallTriangulationAngle(min_tri_angle, point3D_ids);
+  num_filtered_observations += FilterPoints3DWithLargeReprojectionError(
+      max_reproj_error, point3D_ids, num_threads);
+  num_filtered_observations += FilterPoints3DWithSmallTriangulationAngle(
+      min_tri_angle, point3D_ids, num_threads);
   return num_filtered_observations;
 }
 
 size_t ObservationManager::FilterPoints3DInImages(
     const double max_reproj_error,
     const double min_tri_angle,
-    const std::unordered_set<image_t>& image_ids) {
+    const std::unordered_set<image_t>& image_ids,
+    const int num_threads) {
   std::unordered_set<point3D_t> point3D_ids;
   for (const image_t image_id : image_ids) {
     const Image& image = reconstruction_.Image(image_id);
@@ -299,21 +323,23 @@ size_t ObservationManager::FilterPoints3DInImages(
       }
     }
   }
-  return FilterPoints3D(max_reproj_error, min_tri_angle, point3D_ids);
+  return FilterPoints3D(
+      max_reproj_error, min_tri_angle, point3D_ids, num_threads);
 }
 
 size_t ObservationManager::FilterAllPoints3D(const double max_reproj_error,
-                                             const double min_tri_angle) {
+                                             const double min_tri_angle,
+                                             const int num_threads) {
   // Important: First filter observations and points with large reprojection
   // error, so that observations with large reprojection error do not make
   // a point stable through a large triangulation angle.
   const std::unordered_set<point3D_t>& point3D_ids =
       reconstruction_.Point3DIds();
   size_t num_filtered_observations = 0;
-  num_filtered_observations +=
-      FilterPoints3DWithLargeReprojectionError(max_reproj_error, point3D_ids);
-  num_filtered_observations +=
-      FilterPoints3DWithSmallTriangulationAngle(min_tri_angle, point3D_ids);
+  num_filtered_observations += FilterPoints3DWithLargeReprojectionError(
+      max_reproj_error, point3D_ids, num_threads);
+  num_filtered_observations += FilterPoints3DWithSmallTriangulationAngle(
+      min_tri_angle, point3D_ids, num_threads);
   return num_filtered_observations;
 }
 
@@ -342,61 +368,85 @@ size_t ObservationManager::FilterObservationsWithNegativeDepth() {
 
 size_t ObservationManager::FilterPoints3DWithSmallTriangulationAngle(
     const double min_tri_angle,
-    const std::unordered_set<point3D_t>& point3D_ids) {
+    const std::unordered_set<point3D_t>& point3D_ids,
+    const int num_threads) {
   // Number of filtered observations.
   size_t num_filtered_observations = 0;
 
   // Minimum triangulation angle in radians.
   const double min_tri_angle_rad = DegToRad(min_tri_angle);
 
-  // Cache for image projection centers.
-  std::unordered_map<image_t, Eigen::Vector3d> proj_centers;
-
-  for (const auto point3D_id : point3D_ids) {
-    if (!reconstruction_.ExistsPoint3D(point3D_id)) {
-      continue;
-    }
-
-    const struct Point3D& point3D = reconstruction_.Point3D(point3D_id);
-
-    // Calculate triangulation angle for all pairwise combinations of image
-    // poses in the track. Only delete point if none of the combinations
-    // has a sufficient triangulation angle.
-    bool keep_point = false;
-    for (size_t i1 = 0; i1 < point3D.track.Length(); ++i1) {
-      const image_t image_id1 = point3D.track.Element(i1).image_id;
-
-      Eigen::Vector3d proj_center1;
-      if (proj_centers.count(image_id1) == 0) {
-        const Image& image1 = reconstruction_.Image(image_id1);
-        proj_center1 = image1.ProjectionCenter();
-        proj_centers.emplace(image_id1, proj_center1);
-      } else {
-        proj_center1 = proj_centers.at(image_id1);
-      }
-
-      for (size_t i2 = 0; i2 < i1; ++i2) {
-        const image_t image_id2 = point3D.track.Element(i2).image_id;
-        const Eigen::Vector3d proj_center2 = proj_centers.at(image_id2);
-
-        const double tri_angle = CalculateTriangulationAngle(
-            proj_center1, proj_center2, point3D.xyz);
-
-        if (tri_angle >= min_tri_angle_rad) {
-          keep_point = true;
-          break;
-        }
-      }
-
-      if (keep_point) {
-        break;
+  const std::vector<point3D_t> filter_point3D_ids =
+      ExistingPoint3DIds(reconstruction_, point3D_ids);
+
+  // Not std::vector<bool> to allow for concurrent writes.
+  std::vector<char> keep_point3D;
+
+  for (size_t batch_begin = 0; batch_begin < filter_point3D_ids.size();
+       batch_begin += kFilterBatchSize) {
+    const size_t batch_size = std::min(
+        kFilterBatchSize, filter_point3D_ids.size() - batch_begin);
+    keep_point3D.assign(batch_size, false);
+
+    ParallelForChunks(
+        batch_size,
+        kFilterChunkSize,
+        num_threads,
+        [&](const size_t /*chunk_idx*/, const size_t begin, const size_t end) {
+          // Cache for image projection centers.
+          std::unordered_map<image_t, Eigen::Vector3d> proj_centers;
+
+          for (size_t i = begin; i < end; ++i) {
+            const struct Point3D& point3D =
+                reconstruction_.Point3D(filter_point3D_ids[batch_begin + i]);
+
+            // Calculate triangulation angle for all pairwise combinations of
+            // image poses in the track. Only delete point if none of the
+            // combinations has a sufficient triangulation angle.
+            bool keep_point = false;
+            for (size_t i1 = 0; i1 < point3D.track.Length(); ++i1) {
+              const image_t image_id1 = point3D.track.Element(i1).image_id;
+
+              Eigen::Vector3d proj_center1;
+              if (proj_centers.count(image_id1) == 0) {
+                const Image& image1 = reconstruction_.Image(image_id1);
+                proj_center1 = image1.ProjectionCenter();
+                proj_centers.emplace(image_id1, proj_center1);
+              } else {
+                proj_center1 = proj_centers.at(image_id1);
+              }
+
+              for (size_t i2 = 0; i2 < i1; ++i2) {
+                const image_t image_id2 = point3D.track.Element(i2).image_id;
+                const Eigen::Vector3d proj_center2 =
+                    proj_centers.at(image_id2);
+
+                const double tri_angle = CalculateTriangulationAngle(
+                    proj_center1, proj_center2, point3D.xyz);
+
+                if (tri_angle >= min_tri_angle_rad) {
+                  keep_point = true;
+                  break;
+                }
+              }
+
+              if (keep_point) {
+                break;
+              }
+            }
+
+            keep_point3D[i] = keep_point;
+          }
+        });
+
+    for (size_t i = 0; i < batch_size; ++i) {
+      if (!keep_point3D[i]) {
+        const point3D_t point3D_id = filter_point3D_ids[batch_begin + i];
+        num_filtered_observations +=
+            reconstruction_.Point3D(point3D_id).track.Length();
+        DeletePoint3D(point3D_id);
       }
     }
-
-    if (!keep_point) {
-      num_filtered_observations += point3D.track.Length();
-      DeletePoint3D(point3D_id);
-    }
   }
 
   return num_filtered_observations;
@@ -404,51 +454,76 @@ size_t ObservationManager::FilterPoints3DWithSmallTriangulationAngle(
 
 size_t ObservationManager::FilterPoints3DWithLargeReprojectionError(
     const double max_reproj_error,
-    const std::unordered_set<point3D_t>& point3D_ids) {
+    const std::unordered_set<point3D_t>& point3D_ids,
+    const int num_threads) {
   const double max_squared_reproj_error = max_reproj_error * max_reproj_error;
 
   // Number of filtered observations.
   size_t num_filtered_observations = 0;
 
-  for (const auto point3D_id : point3D_ids) {
-    if (!reconstruction_.ExistsPoint3D(point3D_id)) {
-      continue;
-    }
-
-    struct Point3D& point3D = reconstruction_.Point3D(point3D_id);
-
-    if (point3D.track.Length() < 2) {
-      num_filtered_observations += point3D.track.Length();
-      DeletePoint3D(point3D_id);
-      continue;
-    }
+  const std::vector<point3D_t> filter_point3D_ids =
+      ExistingPoint3DIds(reconstruction_, point3D_ids);
 
+  struct FilterResult {
+    bool delete_point3D = false;
     double reproj_error_sum = 0.0;
-
     std::vector<TrackElement> track_els_to_delete;
+  };
+  std::vector<FilterResult> results;
+
+  for (size_t batch_begin = 0; batch_begin < filter_point3D_ids.size();
+       batch_begin += kFilterBatchSize) {
+    const size_t batch_size = std::min(
+        kFilterBatchSize, filter_point3D_ids.size() - batch_begin);
+    results.assign(batch_size, FilterResult());
+
+    ParallelFor(
+        batch_size,
+        kFilterChunkSize,
+        num_threads,
+        [&](const size_t i) {
+          const struct Point3D& point3D =
+              reconstruction_.Point3D(filter_point3D_ids[batch_begin + i]);
+          FilterResult& result = results[i];
 
-    for (const auto& track_el : point3D.track.Elements()) {
-      const Image& image = reconstruction_.Image(track_el.image_id);
-      const struct Camera& camera = *image.CameraPtr();
-      const Point2D& point2D = image.Point2D(track_el.point2D_idx);
-      const double squared_reproj_error = CalculateSquaredReprojectionError(
-          point2D.xy, point3D.xyz, image.CamFromWorld(), camera);
-      if (squared_reproj_error > max_squared_reproj_error) {
-        track_els_to_delete.push_back(track_el);
-      } else {
-        reproj_error_sum += std::sqrt(squared_reproj_error);
-      }
-    }
+          if (point3D.track.Length() < 2) {
+            result.delete_point3D = true;
+            return;
+          }
+
+          for (const auto& track_el : point3D.track.Elements()) {
+            const Image& image = reconstruction_.Image(track_el.image_id);
+            const struct Camera& camera = *image.CameraPtr();
+            const Point2D& point2D = image.Point2D(track_el.point2D_idx);
+            const double squared_reproj_error =
+                CalculateSquaredReprojectionError(
+                    point2D.xy, point3D.xyz, image.CamFromWorld(), camera);
+            if (squared_reproj_error > max_squared_reproj_error) {
+              result.track_els_to_delete.push_back(track_el);
+            } else {
+              result.reproj_error_sum += std::sqrt(squared_reproj_error);
+            }
+          }
 
-    if (track_els_to_delete.size() >= point3D.track.Length() - 1) {
-      num_filtered_observations += point3D.track.Length();
-      DeletePoint3D(point3D_id);
-    } else {
-      num_filtered_observations += track_els_to_delete.size();
-      for (const auto& track_el : track_els_to_delete) {
-        DeleteObservation(track_el.image_id, track_el.point2D_idx);
+          result.delete_point3D =
+              result.track_els_to_delete.size() >= point3D.track.Length() - 1;
+        });
+
+    for (size_t i = 0; i < batch_size; ++i) {
+      const point3D_t point3D_id = filter_point3D_ids[batch_begin + i];
+      const FilterResult& result = results[i];
+      if (result.delete_point3D) {
+        num_filtered_observations +=
+            reconstruction_.Point3D(point3D_id).track.Length();
+        DeletePoint3D(point3D_id);
+      } else {
+        num_filtered_observations += result.track_els_to_delete.size();
+        for (const auto& track_el : result.track_els_to_delete) {
+          DeleteObservation(track_el.image_id, track_el.point2D_idx);
+        }
+        struct Point3D& point3D = reconstruction_.Point3D(point3D_id);
+        point3D.error = result.reproj_error_sum / point3D.track.Length();
       }
-      point3D.error = reproj_error_sum / point3D.track.Length();
     }
   }
 
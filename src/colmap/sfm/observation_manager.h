@@ -85,15 +85,20 @@ class ObservationManager {
   // @param max_reproj_error    The maximum reprojection error.
   // @param min_tri_angle       The minimum triangulation angle.
   // @param point3D_ids         The points to be filtered.
+  // @param num_threads         The number of threads evaluating the points.
   //
   // @return                    The number of filtered observations.
   size_t FilterPoints3D(double max_reproj_error,
                         double min_tri_angle,
-                        const std::unordered_set<point3D_t>& point3D_ids);
+                        const std::unordered_set<point3D_t>& point3D_ids,
+                        int num_threads = 1);
   size_t FilterPoints3DInImages(double max_reproj_error,
                                 double min_tri_angle,
-                                const std::unordered_set<image_t>& image_ids);
-  size_t FilterAllPoints3D(double max_reproj_error, double min_tri_angle);
+                                const std::unordered_set<image_t>& image_ids,
+                                int num_threads = 1);
+  size_t FilterAllPoints3D(double max_reproj_error,
+                           double min_tri_angle,
+                           int num_threads = 1);
 
   // Filter observations that have negative depth.
   //
@@ -101,10 +106,13 @@ class ObservationManager {
   size_t FilterObservationsWithNegativeDepth();
 
   size_t FilterPoints3DWithSmallTriangulationAngle(
-      double min_tri_angle, const std::unordered_set<point3D_t>& point3D_ids);
+      double min_tri_angle,
+      const std::unordered_set<point3D_t>& point3D_ids,
+      int num_threads = 1);
   size_t FilterPoints3DWithLargeReprojectionError(
       double max_reproj_error,
-      const std::unordered_set<point3D_t>& point3D_ids);
+      const std::unordered_set<point3D_t>& point3D_ids,
+      int num_threads = 1);
 
   // Filter frames without observations or bogus camera parameters.
   //
@@ -45,12 +45,16 @@ class PointColormapBase {
 
   virtual void Prepare(std::unordered_map<camera_t, Camera>& cameras,
                        std::unordered_map<image_t, Image>& images,
-                       std::unordered_map<point3D_t, Point3D>& points3D,
+                       DenseIdMap<point3D_t, Point3D>& points3D,
                        std::vector<image_t>& reg_image_ids) = 0;
 
   virtual Eigen::Vector4f ComputeColor(point3D_t point3D_id,
                                        const Point3D& point3D) = 0;
 
+  // Whether the color of a point only depends on the point itself, such that
+  // the colors of unmodified points remain valid when the scene changes.
+  virtual bool IsPointwise() const { return false; }
+
   void UpdateScale(std::vector<float>* values);
   float AdjustScale(float gray);
 
@@ -67,11 +71,13 @@ class PointColormapPhotometric : public PointColormapBase {
  public:
   void Prepare(std::unordered_map<camera_t, Camera>& cameras,
                std::unordered_map<image_t, Image>& images,
-               std::unordered_map<point3D_t, Point3D>& points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   Eigen::Vector4f ComputeColor(point3D_t point3D_id,
                                const Point3D& point3D) override;
+
+  bool IsPointwise() const override { return true; }
 };
 
 // Map color according to error.
@@ -79,7 +85,7 @@ class PointColormapError : public PointColormapBase {
  public:
   void Prepare(std::unordered_map<camera_t, Camera>& cameras,
                std::unordered_map<image_t, Image>& images,
-               std::unordered_map<point3D_t, Point3D>& points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   Eigen::Vector4f ComputeColor(point3D_t point3D_id,
@@ -91,7 +97,7 @@ class PointColormapTrackLen : public PointColormapBase {
  public:
   void Prepare(std::unordered_map<camera_t, Camera>& cameras,
                std::unordered_map<image_t, Image>& images,
-               std::unordered_map<point3D_t, Point3D>& points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   Eigen::Vector4f ComputeColor(point3D_t point3D_id,
@@ -103,7 +109,7 @@ class PointColormapGroundResolution : public PointColormapBase {
  public:
   void Prepare(std::unordered_map<camera_t, Camera>& cameras,
                std::unordered_map<image_t, Image>& images,
-               std::unordered_map<point3D_t, Point3D>& points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   Eigen::Vector4f ComputeColor(point3D_t point3D_id,
@@ -121,7 +127,7 @@ class ImageColormapBase {
 
   virtual void Prepare(std::unordered_map<camera_t, Camera>& cameras,
                        std::unordered_map<image_t, Image>& images,
-                       std::unordered_map<point3D_t, Point3D>& points3D,
+                       DenseIdMap<point3D_t, Point3D>& points3D,
                        std::vector<image_t>& reg_image_ids) = 0;
 
   virtual void ComputeColor(const Image& image,
@@ -137,7 +143,7 @@ class ImageColormapUniform : public ImageColormapBase {
  public:
   void Prepare(std::unordered_map<camera_t, Camera>& cameras,
                std::unordered_map<image_t, Image>& images,
-               std::unordered_map<point3D_t, Point3D>& points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   void ComputeColor(const Image& image,
@@ -153,7 +159,7 @@ class ImageColormapNameFilter : public ImageColormapBase {
  public:
   void Prepare(std::unordered_map<camera_t, Camera>& cameras,
                std::unordered_map<image_t, Image>& images,
-               std::unordered_map<point3D_t, Point3D>& points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   void AddColorForWord(const std::string& word,
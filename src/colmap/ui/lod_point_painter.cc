@@ -0,0 +1,202 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "colmap/ui/lod_point_painter.h"
+
+#include "colmap/ui/qt_utils.h"
+#include "colmap/util/logging.h"
+
+namespace colmap {
+
+void LODPointPainter::Setup() {
+  painter_.Setup();
+  SetPoints(Points());
+}
+
+void LODPointPainter::Upload(std::vector<PointPainter::Data> data,
+                             std::vector<point3D_t> point3D_ids) {
+  THROW_CHECK_EQ(data.size(), point3D_ids.size());
+
+  if (data.empty()) {
+    SetPoints(Points());
+  }
+
+  if (build_future_.valid()) {
+    queued_points_.emplace(std::move(data), std::move(point3D_ids));
+    return;
+  }
+
+  if (data.empty()) {
+    return;
+  }
+
+  // Only the colors changed, so reuse the octree and upload the new colors.
+  const std::vector<size_t>& point_idxs = points_.octree.PointIdxs();
+  bool same_points = point_idxs.size() == point3D_ids.size();
+  for (size_t i = 0; same_points && i < point_idxs.size(); ++i) {
+    same_points = point3D_ids[point_idxs[i]] == points_.point3D_ids[i];
+  }
+  if (same_points) {
+    for (size_t i = 0; i < point_idxs.size(); ++i) {
+      points_.data[i] = data[point_idxs[i]];
+    }
+    std::fill(num_uploaded_points_.begin(), num_uploaded_points_.end(), 0);
+    return;
+  }
+
+  build_future_ = std::async(std::launch::async,
+                             &LODPointPainter::BuildPoints,
+                             std::move(data),
+                             std::move(point3D_ids));
+}
+
+void LODPointPainter::Clear() { Upload({}, {}); }
+
+bool LODPointPainter::IsActive() const {
+  return !points_.data.empty() || build_future_.valid();
+}
+
+bool LODPointPainter::Render(const QMatrix4x4& pmv_matrix,
+                             const int width,
+                             const int height,
+                             const float point_size,
+                             const size_t max_num_points) {
+  bool needs_update = false;
+
+  if (build_future_.valid()) {
+    if (build_future_.wait_for(std::chrono::seconds(0)) ==
+        std::future_status::ready) {
+      SetPoints(build_future_.get());
+      if (queued_points_) {
+        auto [data, point3D_ids] = std::move(*queued_points_);
+        queued_points_.reset();
+        Upload(std::move(data), std::move(point3D_ids));
+      }
+    }
+    needs_update = build_future_.valid();
+  }
+
+  rendered_ranges_.clear();
+  if (points_.data.empty()) {
+    return needs_update;
+  }
+
+  const std::vector<PointOctree::LeafSelection> leaves =
+      points_.octree.SelectLOD(QMatrixToEigen(pmv_matrix),
+                               width,
+                               height,
+                               point_size,
+                               max_num_points);
+
+  size_t num_upload_points = 0;
+  for (const PointOctree::LeafSelection& leaf : leaves) {
+    const PointOctree::Node& node = points_.octree.Nodes()[leaf.node_idx];
+
+    // Upload the missing points of the leaf within the per-frame budget.
+    size_t& num_uploaded_points = num_uploaded_points_[leaf.node_idx];
+    if (num_uploaded_points < leaf.num_points) {
+      const size_t offset = node.begin + num_uploaded_points;
+      const size_t num_points =
+          std::min(leaf.num_points - num_uploaded_points,
+                   kMaxNumUploadPointsPerFrame - num_upload_points);
+      painter_.UploadRange(offset, points_.data.data() + offset, num_points);
+      num_uploaded_points += num_points;
+      num_upload_points += num_points;
+      if (num_uploaded_points < leaf.num_points) {
+        needs_update = true;
+      }
+    }
+
+    const size_t num_points = std::min(num_uploaded_points, leaf.num_points);
+    if (num_points == 0) {
+      continue;
+    }
+
+    // Merge with the previous range if it ends at the start of this leaf.
+    if (!rendered_ranges_.empty() &&
+        rendered_ranges_.back().first + rendered_ranges_.back().second ==
+            node.begin) {
+      rendered_ranges_.back().second += num_points;
+    } else {
+      rendered_ranges_.emplace_back(node.begin, num_points);
+    }
+  }
+
+  painter_.Render(pmv_matrix, point_size, rendered_ranges_);
+
+  return needs_update;
+}
+
+void LODPointPainter::RenderedPoints(
+    std::vector<point3D_t>* point3D_ids,
+    std::vector<PointPainter::Data>* data) const {
+  point3D_ids->clear();
+  data->clear();
+  for (const auto& [offset, num_points] : rendered_ranges_) {
+    point3D_ids->insert(point3D_ids->end(),
+                        points_.point3D_ids.begin() + offset,
+                        points_.point3D_ids.begin() + offset + num_points);
+    data->insert(data->end(),
+                 points_.data.begin() + offset,
+                 points_.data.begin() + offset + num_points);
+  }
+}
+
+LODPointPainter::Points LODPointPainter::BuildPoints(
+    std::vector<PointPainter::Data> data, std::vector<point3D_t> point3D_ids) {
+  std::vector<Eigen::Vector3f> positions;
+  positions.reserve(data.size());
+  for (const PointPainter::Data& point : data) {
+    positions.emplace_back(point.x, point.y, point.z);
+  }
+
+  Points points;
+  points.octree = PointOctree(PointOctree::Options(), positions);
+  positions.clear();
+  positions.shrink_to_fit();
+
+  const std::vector<size_t>& point_idxs = points.octree.PointIdxs();
+  points.data.reserve(data.size());
+  points.point3D_ids.reserve(data.size());
+  for (const size_t point_idx : point_idxs) {
+    points.data.push_back(data[point_idx]);
+    points.point3D_ids.push_back(point3D_ids[point_idx]);
+  }
+
+  return points;
+}
+
+void LODPointPainter::SetPoints(Points points) {
+  points_ = std::move(points);
+  num_uploaded_points_.assign(points_.octree.Nodes().size(), 0);
+  rendered_ranges_.clear();
+  painter_.Allocate(points_.data.size());
+}
+
+}  // namespace colmap
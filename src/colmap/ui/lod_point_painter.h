@@ -0,0 +1,108 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "colmap/ui/point_octree.h"
+#include "colmap/ui/point_painter.h"
+#include "colmap/util/types.h"
+
+#include <future>
+#include <optional>
+#include <vector>
+
+#include <QtCore>
+#include <QtOpenGL>
+
+namespace colmap {
+
+// Renders large point clouds at a view-dependent level of detail. The octree
+// over the points is built on a background thread, while the previous points
+// continue to be rendered. The points of visible octree leaves are uploaded to
+// the GPU incrementally, when they are first needed at the current level of
+// detail.
+class LODPointPainter {
+ public:
+  // Maximum number of points uploaded to the GPU per rendered frame.
+  const size_t kMaxNumUploadPointsPerFrame = 2000000;
+
+  void Setup();
+
+  // Set the points to render and their identifiers. If the identifiers are
+  // unchanged, the existing octree is reused and only the colors are uploaded
+  // again. Otherwise, the octree is rebuilt in the background.
+  void Upload(std::vector<PointPainter::Data> data,
+              std::vector<point3D_t> point3D_ids);
+  void Clear();
+
+  // Whether there are points to render or an octree is being built.
+  bool IsActive() const;
+
+  // Render the points with at most max_num_points points. Returns true if
+  // further frames are needed to finish building the octree or uploading the
+  // points required for the current view.
+  bool Render(const QMatrix4x4& pmv_matrix,
+              int width,
+              int height,
+              float point_size,
+              size_t max_num_points);
+
+  // The points rendered in the last frame.
+  void RenderedPoints(std::vector<point3D_t>* point3D_ids,
+                      std::vector<PointPainter::Data>* data) const;
+
+ private:
+  // Points and their identifiers in octree order.
+  struct Points {
+    std::vector<PointPainter::Data> data;
+    std::vector<point3D_t> point3D_ids;
+    PointOctree octree;
+  };
+
+  static Points BuildPoints(std::vector<PointPainter::Data> data,
+                            std::vector<point3D_t> point3D_ids);
+
+  void SetPoints(Points points);
+
+  PointPainter painter_;
+
+  Points points_;
+  // Number of points uploaded from the front of each octree node.
+  std::vector<size_t> num_uploaded_points_;
+  // The (offset, number of points) ranges rendered in the last frame.
+  std::vector<std::pair<size_t, size_t>> rendered_ranges_;
+
+  std::future<Points> build_future_;
+  // The most recent points set while the octree was being built.
+  std::optional<std::pair<std::vector<PointPainter::Data>,
+                          std::vector<point3D_t>>>
+      queued_points_;
+};
+
+}  // namespace colmap
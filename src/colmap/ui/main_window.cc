@@ -1291,7 +1291,8 @@ void MainWindow::ExtractColors() {
 
   thread_control_widget_->StartFunction("Extracting colors...", [this]() {
     reconstruction_manager_->Get(SelectedReconstructionIdx())
-        ->ExtractColorsForAllImages(*options_.image_path);
+        ->ExtractColorsForAllImages(*options_.image_path,
+                                    options_.mapper->num_threads);
   });
 }
 
@@ -371,7 +371,20 @@ void ModelViewerWidget::paintGL() {
   }
 
   // Points
-  point_painter_.Render(pmv_matrix, point_size_);
+  if (point_buffer_.valid) {
+    point_painter_.Render(pmv_matrix * PointBufferModelMatrix(),
+                          point_size_,
+                          {{0, point_buffer_.point3D_ids.size()}});
+  } else {
+    point_painter_.Render(pmv_matrix, point_size_);
+  }
+  if (lod_point_painter_.Render(pmv_matrix,
+                                width(),
+                                height(),
+                                point_size_,
+                                options_->render->max_num_points)) {
+    update();
+  }
   point_connection_painter_.Render(pmv_matrix, width(), height(), 1);
 
   // Images
@@ -398,16 +411,37 @@ void ModelViewerWidget::ReloadReconstruction() {
 
   rigs = reconstruction->Rigs();
   cameras = reconstruction->Cameras();
-  frames = reconstruction->Frames();
-  points3D = reconstruction->Points3D();
 
-  frames.clear();
-  images.clear();
+  // This is called from blocking callbacks while the reconstruction is
+  // growing, so only copy the modified points and keep the existing frames
+  // and images to reuse their memory.
+  std::vector<point3D_t> deleted_point3D_ids;
+  for (const auto& [point3D_id, _] : points3D) {
+    if (!reconstruction->ExistsPoint3D(point3D_id)) {
+      deleted_point3D_ids.push_back(point3D_id);
+    }
+  }
+  for (const point3D_t point3D_id : deleted_point3D_ids) {
+    points3D.erase(point3D_id);
+    modified_point3D_ids_.insert(point3D_id);
+  }
+  for (const auto& [point3D_id, point3D] : reconstruction->Points3D()) {
+    const auto [it, inserted] = points3D.emplace(point3D_id, point3D);
+    if (inserted) {
+      modified_point3D_ids_.insert(point3D_id);
+    } else if (!(it->second == point3D)) {
+      it->second = point3D;
+      modified_point3D_ids_.insert(point3D_id);
+    }
+  }
+
   reg_image_ids.clear();
+  std::unordered_set<frame_t> reg_frame_ids;
   for (const frame_t frame_id : reconstruction->RegFrameIds()) {
     Frame& frame = frames[frame_id];
     frame = reconstruction->Frame(frame_id);
     frame.SetRigPtr(&rigs[frame.RigId()]);
+    reg_frame_ids.insert(frame_id);
     for (const data_t& data_id : frame.ImageIds()) {
       Image& image = images[data_id.id];
       image = reconstruction->Image(data_id.id);
@@ -419,6 +453,22 @@ void ModelViewerWidget::ReloadReconstruction() {
 
   std::sort(reg_image_ids.begin(), reg_image_ids.end());
 
+  for (auto it = frames.begin(); it != frames.end();) {
+    if (reg_frame_ids.count(it->first) == 0) {
+      it = frames.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = images.begin(); it != images.end();) {
+    if (!std::binary_search(
+            reg_image_ids.begin(), reg_image_ids.end(), it->first)) {
+      it = images.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
   if (selected_point3D_id_ != kInvalidPoint3DId &&
       points3D.count(selected_point3D_id_) == 0) {
     selected_point3D_id_ = kInvalidPoint3DId;
@@ -436,14 +486,17 @@ void ModelViewerWidget::ReloadReconstruction() {
                          static_cast<int>(reg_image_ids.size()),
                          static_cast<int>(points3D.size())));
 
-  Upload();
+  ScheduleUpload();
 }
 
 void ModelViewerWidget::ClearReconstruction() {
   cameras.clear();
+  frames.clear();
   images.clear();
   points3D.clear();
   reg_image_ids.clear();
+  point_buffer_.valid = false;
+  modified_point3D_ids_.clear();
   reconstruction = nullptr;
   selected_image_id_ = kInvalidImageId;
   selected_point3D_id_ = kInvalidPoint3DId;
@@ -456,6 +509,7 @@ int ModelViewerWidget::GetProjectionType() const {
 
 void ModelViewerWidget::SetPointColormap(PointColormapBase* colormap) {
   point_colormap_.reset(colormap);
+  point_buffer_.valid = false;
 }
 
 void ModelViewerWidget::SetImageColormap(ImageColormapBase* colormap) {
@@ -831,6 +885,7 @@ void ModelViewerWidget::SetupPainters() {
   coordinate_grid_painter_.Setup();
 
   point_painter_.Setup();
+  lod_point_painter_.Setup();
   point_connection_painter_.Setup();
 
   image_line_painter_.Setup();
@@ -897,6 +952,20 @@ void ModelViewerWidget::Upload() {
   update();
 }
 
+void ModelViewerWidget::ScheduleUpload() {
+  // Upload from the event loop, such that blocking callbacks of the mapper
+  // return as soon as the scene is copied. Multiple reloads before the upload
+  // are merged into a single upload.
+  if (upload_scheduled_) {
+    return;
+  }
+  upload_scheduled_ = true;
+  QTimer::singleShot(0, this, [this]() {
+    upload_scheduled_ = false;
+    Upload();
+  });
+}
+
 void ModelViewerWidget::UploadCoordinateGridData() {
   makeCurrent();
 
@@ -1005,68 +1074,182 @@ void ModelViewerWidget::UploadCoordinateGridData() {
 void ModelViewerWidget::UploadPointData(const bool selection_mode) {
   makeCurrent();
 
+  if (!selection_mode && CanUploadModifiedPointData()) {
+    UploadModifiedPointData();
+    return;
+  }
+
+  point_buffer_.valid = false;
+  modified_point3D_ids_.clear();
+
   std::vector<PointPainter::Data> data;
+  std::vector<point3D_t> point3D_ids;
+
+  // At a reduced level of detail, only the rendered points can be selected.
+  if (selection_mode && lod_point_painter_.IsActive()) {
+    lod_point_painter_.RenderedPoints(&point3D_ids, &data);
+    for (size_t i = 0; i < data.size(); ++i) {
+      const Eigen::Vector4f color = IndexToRGB(selection_buffer_.size());
+      selection_buffer_.push_back(
+          std::make_pair(point3D_ids[i], SELECTION_BUFFER_POINT_IDX));
+      data[i].r = color(0);
+      data[i].g = color(1);
+      data[i].b = color(2);
+      data[i].a = color(3);
+    }
+    point_painter_.Upload(data);
+    return;
+  }
 
   // Assume we want to display the majority of points
   data.reserve(points3D.size());
+  point3D_ids.reserve(points3D.size());
+
+  for (const auto& [point3D_id, point3D] : points3D) {
+    if (IsPointVisible(point3D)) {
+      const Eigen::Vector3f xyz =
+          (model_scale_ * (point3D.xyz + model_origin_)).cast<float>();
+
+      Eigen::Vector4f color;
+      if (selection_mode) {
+        const size_t index = selection_buffer_.size();
+        selection_buffer_.push_back(
+            std::make_pair(point3D_id, SELECTION_BUFFER_POINT_IDX));
+        color = IndexToRGB(index);
+      } else {
+        color = ComputePointColor(point3D_id, point3D);
+      }
 
-  const size_t min_track_len =
-      static_cast<size_t>(options_->render->min_track_len);
-
-  if (selected_image_id_ == kInvalidImageId &&
-      images.count(selected_image_id_) == 0) {
-    for (const auto& [point3D_id, point3D] : points3D) {
-      if (point3D.error <= options_->render->max_error &&
-          point3D.track.Length() >= min_track_len) {
-        const Eigen::Vector3f xyz =
-            (model_scale_ * (point3D.xyz + model_origin_)).cast<float>();
-
-        Eigen::Vector4f color;
-        if (selection_mode) {
-          const size_t index = selection_buffer_.size();
-          selection_buffer_.push_back(
-              std::make_pair(point3D_id, SELECTION_BUFFER_POINT_IDX));
-          color = IndexToRGB(index);
-
-        } else if (point3D_id == selected_point3D_id_) {
-          color = kSelectedPointColor;
-        } else {
-          color = point_colormap_->ComputeColor(point3D_id, point3D);
-        }
+      data.emplace_back(
+          xyz(0), xyz(1), xyz(2), color(0), color(1), color(2), color(3));
+      point3D_ids.push_back(point3D_id);
+    }
+  }
+
+  if (selection_mode) {
+    lod_point_painter_.Clear();
+    point_painter_.Upload(data);
+    return;
+  }
+
+  // Render huge models at a view-dependent level of detail.
+  if (data.size() > static_cast<size_t>(options_->render->max_num_points)) {
+    point_painter_.Upload({});
+    lod_point_painter_.Upload(std::move(data), std::move(point3D_ids));
+    return;
+  }
+
+  lod_point_painter_.Clear();
+
+  // Leave room for the points added while the reconstruction is growing.
+  constexpr size_t kMinPointBufferCapacity = 1024;
+  point_buffer_.capacity =
+      std::max(kMinPointBufferCapacity, 2 * point3D_ids.size());
+  point_painter_.Allocate(point_buffer_.capacity);
+  point_painter_.UploadRange(0, data.data(), data.size());
+
+  point_buffer_.valid = true;
+  point_buffer_.selected_image_id = selected_image_id_;
+  point_buffer_.selected_point3D_id = selected_point3D_id_;
+  point_buffer_.min_track_len = options_->render->min_track_len;
+  point_buffer_.max_error = options_->render->max_error;
+  point_buffer_.model_origin = model_origin_;
+  point_buffer_.model_scale = model_scale_;
+  point_buffer_.idxs.clear();
+  point_buffer_.idxs.reserve(point3D_ids.size());
+  for (size_t i = 0; i < point3D_ids.size(); ++i) {
+    point_buffer_.idxs.emplace(point3D_ids[i], i);
+  }
+  point_buffer_.point3D_ids = std::move(point3D_ids);
+}
 
-        data.emplace_back(
-            xyz(0), xyz(1), xyz(2), color(0), color(1), color(2), color(3));
+bool ModelViewerWidget::CanUploadModifiedPointData() const {
+  // Re-upload all points, if the model scale changed significantly, to limit
+  // the loss of precision of the buffer's relative coordinates.
+  constexpr double kMaxModelScaleRatio = 2.0;
+  const double model_scale_ratio = model_scale_ / point_buffer_.model_scale;
+  return point_buffer_.valid && point_colormap_->IsPointwise() &&
+         point_buffer_.selected_image_id == selected_image_id_ &&
+         point_buffer_.selected_point3D_id == selected_point3D_id_ &&
+         point_buffer_.min_track_len == options_->render->min_track_len &&
+         point_buffer_.max_error == options_->render->max_error &&
+         model_scale_ratio <= kMaxModelScaleRatio &&
+         model_scale_ratio >= 1 / kMaxModelScaleRatio &&
+         modified_point3D_ids_.size() <= points3D.size() / 2;
+}
+
+void ModelViewerWidget::UploadModifiedPointData() {
+  std::vector<point3D_t>& point3D_ids = point_buffer_.point3D_ids;
+  std::vector<size_t> modified_idxs;
+  modified_idxs.reserve(modified_point3D_ids_.size());
+
+  for (const point3D_t point3D_id : modified_point3D_ids_) {
+    const auto point3D_it = points3D.find(point3D_id);
+    if (point3D_it != points3D.end() && IsPointVisible(point3D_it->second)) {
+      const auto [it, inserted] =
+          point_buffer_.idxs.emplace(point3D_id, point3D_ids.size());
+      if (inserted) {
+        point3D_ids.push_back(point3D_id);
       }
+      modified_idxs.push_back(it->second);
+      continue;
     }
-  } else {  // Image selected
-    const auto& selected_image = images[selected_image_id_];
-    for (const auto& [point3D_id, point3D] : points3D) {
-      if (point3D.error <= options_->render->max_error &&
-          point3D.track.Length() >= min_track_len) {
-        const Eigen::Vector3f xyz =
-            (model_scale_ * (point3D.xyz + model_origin_)).cast<float>();
-
-        Eigen::Vector4f color;
-        if (selection_mode) {
-          const size_t index = selection_buffer_.size();
-          selection_buffer_.push_back(
-              std::make_pair(point3D_id, SELECTION_BUFFER_POINT_IDX));
-          color = IndexToRGB(index);
-        } else if (selected_image.HasPoint3D(point3D_id)) {
-          color = kSelectedImagePlaneColor;
-        } else if (point3D_id == selected_point3D_id_) {
-          color = kSelectedPointColor;
-        } else {
-          color = point_colormap_->ComputeColor(point3D_id, point3D);
-        }
 
-        data.emplace_back(
-            xyz(0), xyz(1), xyz(2), color(0), color(1), color(2), color(3));
-      }
+    // Remove the point by moving the last point into its place.
+    const auto it = point_buffer_.idxs.find(point3D_id);
+    if (it == point_buffer_.idxs.end()) {
+      continue;
+    }
+    const size_t idx = it->second;
+    point_buffer_.idxs.erase(it);
+    const point3D_t last_point3D_id = point3D_ids.back();
+    point3D_ids.pop_back();
+    if (idx < point3D_ids.size()) {
+      point3D_ids[idx] = last_point3D_id;
+      point_buffer_.idxs[last_point3D_id] = idx;
+      modified_idxs.push_back(idx);
     }
   }
 
-  point_painter_.Upload(data);
+  modified_point3D_ids_.clear();
+
+  if (point3D_ids.size() > point_buffer_.capacity ||
+      point3D_ids.size() >
+          static_cast<size_t>(options_->render->max_num_points)) {
+    point_buffer_.valid = false;
+    UploadPointData();
+    return;
+  }
+
+  std::sort(modified_idxs.begin(), modified_idxs.end());
+  modified_idxs.erase(std::unique(modified_idxs.begin(), modified_idxs.end()),
+                      modified_idxs.end());
+  while (!modified_idxs.empty() && modified_idxs.back() >= point3D_ids.size()) {
+    modified_idxs.pop_back();
+  }
+
+  // Upload consecutive runs of modified points at once. New points are
+  // appended to the end of the buffer and thus form a single run.
+  std::vector<PointPainter::Data> data;
+  for (size_t i = 0; i < modified_idxs.size();) {
+    data.clear();
+    size_t j = i;
+    while (j < modified_idxs.size() &&
+           modified_idxs[j] == modified_idxs[i] + (j - i)) {
+      const point3D_t point3D_id = point3D_ids[modified_idxs[j]];
+      const Point3D& point3D = points3D.at(point3D_id);
+      const Eigen::Vector3f xyz =
+          (point_buffer_.model_scale *
+           (point3D.xyz + point_buffer_.model_origin))
+              .cast<float>();
+      const Eigen::Vector4f color = ComputePointColor(point3D_id, point3D);
+      data.emplace_back(
+          xyz(0), xyz(1), xyz(2), color(0), color(1), color(2), color(3));
+      ++j;
+    }
+    point_painter_.UploadRange(modified_idxs[i], data.data(), data.size());
+    i = j;
+  }
 }
 
 void ModelViewerWidget::UploadPointConnectionData() {
@@ -1339,6 +1522,37 @@ void ModelViewerWidget::ComposeProjectionMatrix() {
   }
 }
 
+bool ModelViewerWidget::IsPointVisible(const Point3D& point3D) const {
+  return point3D.error <= options_->render->max_error &&
+         point3D.track.Length() >=
+             static_cast<size_t>(options_->render->min_track_len);
+}
+
+Eigen::Vector4f ModelViewerWidget::ComputePointColor(
+    const point3D_t point3D_id, const Point3D& point3D) {
+  if (selected_image_id_ != kInvalidImageId) {
+    const auto image_it = images.find(selected_image_id_);
+    if (image_it != images.end() && image_it->second.HasPoint3D(point3D_id)) {
+      return kSelectedImagePlaneColor;
+    }
+  }
+  if (point3D_id == selected_point3D_id_) {
+    return kSelectedPointColor;
+  }
+  return point_colormap_->ComputeColor(point3D_id, point3D);
+}
+
+QMatrix4x4 ModelViewerWidget::PointBufferModelMatrix() const {
+  // The buffered points were transformed by the model origin and scale at the
+  // time of their upload, so map them to the current model origin and scale.
+  const Eigen::Vector3d translation =
+      model_scale_ * (model_origin_ - point_buffer_.model_origin);
+  QMatrix4x4 matrix;
+  matrix.translate(translation.x(), translation.y(), translation.z());
+  matrix.scale(static_cast<float>(model_scale_ / point_buffer_.model_scale));
+  return matrix;
+}
+
 float ModelViewerWidget::ZoomScale() const {
   // "Constant" scale factor w.r.t. zoom-level.
   return 2.0f * std::tan(static_cast<float>(DegToRad(kFieldOfView)) / 2.0f) *
@@ -35,12 +35,15 @@
 #include "colmap/ui/colormaps.h"
 #include "colmap/ui/image_viewer_widget.h"
 #include "colmap/ui/line_painter.h"
+#include "colmap/ui/lod_point_painter.h"
 #include "colmap/ui/movie_grabber_widget.h"
 #include "colmap/ui/point_painter.h"
 #include "colmap/ui/point_viewer_widget.h"
 #include "colmap/ui/render_options.h"
 #include "colmap/ui/triangle_painter.h"
 
+#include <unordered_set>
+
 #include <QOpenGLFunctions_3_2_Core>
 #include <QtCore>
 #include <QtOpenGL>
@@ -121,7 +124,7 @@ class ModelViewerWidget : public QOpenGLWidget,
   std::unordered_map<camera_t, Camera> cameras;
   std::unordered_map<frame_t, Frame> frames;
   std::unordered_map<image_t, Image> images;
-  std::unordered_map<point3D_t, Point3D> points3D;
+  DenseIdMap<point3D_t, Point3D> points3D;
   std::vector<image_t> reg_image_ids;
 
   QLabel* statusbar_status_label;
@@ -143,8 +146,11 @@ class ModelViewerWidget : public QOpenGLWidget,
   void ComputeModelOriginAndScale();
 
   void Upload();
+  void ScheduleUpload();
   void UploadCoordinateGridData();
   void UploadPointData(bool selection_mode = false);
+  bool CanUploadModifiedPointData() const;
+  void UploadModifiedPointData();
   void UploadPointConnectionData();
   void UploadImageData(bool selection_mode = false);
   void UploadImageConnectionData();
@@ -152,6 +158,11 @@ class ModelViewerWidget : public QOpenGLWidget,
 
   void ComposeProjectionMatrix();
 
+  bool IsPointVisible(const Point3D& point3D) const;
+  Eigen::Vector4f ComputePointColor(point3D_t point3D_id,
+                                    const Point3D& point3D);
+  QMatrix4x4 PointBufferModelMatrix() const;
+
   float ZoomScale() const;
   float AspectRatio() const;
   float OrthographicWindowExtent() const;
@@ -170,6 +181,29 @@ class ModelViewerWidget : public QOpenGLWidget,
   LinePainter coordinate_grid_painter_;
 
   PointPainter point_painter_;
+  LODPointPainter lod_point_painter_;
+
+  // Points uploaded to the point painter's buffer, which allows to only upload
+  // the modified points while the reconstruction is growing. The buffer is
+  // only valid for the render state under which it was uploaded.
+  struct PointBuffer {
+    bool valid = false;
+    image_t selected_image_id = kInvalidImageId;
+    point3D_t selected_point3D_id = kInvalidPoint3DId;
+    int min_track_len = 0;
+    double max_error = 0;
+    Eigen::Vector3d model_origin = Eigen::Vector3d::Zero();
+    double model_scale = 1.0;
+    // Index of each point in the buffer and the points per buffer index.
+    std::unordered_map<point3D_t, size_t> idxs;
+    std::vector<point3D_t> point3D_ids;
+    size_t capacity = 0;
+  };
+  PointBuffer point_buffer_;
+
+  // Points added, changed, or deleted since the last upload of point data.
+  std::unordered_set<point3D_t> modified_point3D_ids_;
+  bool upload_scheduled_ = false;
   LinePainter point_connection_painter_;
 
   LinePainter image_line_painter_;
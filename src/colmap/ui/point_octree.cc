@@ -0,0 +1,219 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "colmap/ui/point_octree.h"
+
+#include "colmap/util/logging.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace colmap {
+
+bool PointOctree::Options::Check() const {
+  CHECK_OPTION_GT(max_num_points_per_leaf, 0);
+  CHECK_OPTION_GE(max_depth, 0);
+  CHECK_OPTION_GT(num_points_per_pixel, 0);
+  return true;
+}
+
+PointOctree::PointOctree(const Options& options,
+                         const std::vector<Eigen::Vector3f>& points)
+    : options_(options) {
+  THROW_CHECK(options.Check());
+
+  point_idxs_.resize(points.size());
+  std::iota(point_idxs_.begin(), point_idxs_.end(), 0);
+
+  if (points.empty()) {
+    return;
+  }
+
+  Node& root = nodes_.emplace_back();
+  root.begin = 0;
+  root.end = points.size();
+  for (const Eigen::Vector3f& point : points) {
+    root.bbox.extend(point);
+  }
+
+  BuildNode(points, 0, 0);
+}
+
+void PointOctree::BuildNode(const std::vector<Eigen::Vector3f>& points,
+                            const size_t node_idx,
+                            const int depth) {
+  const size_t begin = nodes_[node_idx].begin;
+  const size_t end = nodes_[node_idx].end;
+
+  if (end - begin <= static_cast<size_t>(options_.max_num_points_per_leaf) ||
+      depth >= options_.max_depth) {
+    // Shuffle the leaf such that any prefix is a uniform subsample. Seeding by
+    // the node's offset keeps the rendered subsets deterministic.
+    std::mt19937 prng(static_cast<std::mt19937::result_type>(begin));
+    std::shuffle(point_idxs_.begin() + begin, point_idxs_.begin() + end, prng);
+    return;
+  }
+
+  // Partition the points into octants by splitting the range along x, then
+  // both halves along y, and finally all quarters along z. Octant k contains
+  // the points with x, y, z above the center for the set bits 2, 1, 0 of k.
+  const Eigen::Vector3f center = nodes_[node_idx].bbox.center();
+  const auto below = [&points, &center](const int dim) {
+    return [&points, &center, dim](const size_t point_idx) {
+      return points[point_idx](dim) < center(dim);
+    };
+  };
+  std::array<std::vector<size_t>::iterator, 9> bounds;
+  bounds[0] = point_idxs_.begin() + begin;
+  bounds[8] = point_idxs_.begin() + end;
+  bounds[4] = std::partition(bounds[0], bounds[8], below(0));
+  bounds[2] = std::partition(bounds[0], bounds[4], below(1));
+  bounds[6] = std::partition(bounds[4], bounds[8], below(1));
+  for (int i = 1; i < 8; i += 2) {
+    bounds[i] = std::partition(bounds[i - 1], bounds[i + 1], below(2));
+  }
+
+  const size_t first_child = nodes_.size();
+  for (int k = 0; k < 8; ++k) {
+    if (bounds[k] == bounds[k + 1]) {
+      continue;
+    }
+    Node& child = nodes_.emplace_back();
+    child.begin = bounds[k] - point_idxs_.begin();
+    child.end = bounds[k + 1] - point_idxs_.begin();
+    for (size_t i = child.begin; i < child.end; ++i) {
+      child.bbox.extend(points[point_idxs_[i]]);
+    }
+  }
+
+  const size_t num_children = nodes_.size() - first_child;
+  nodes_[node_idx].first_child = first_child;
+  nodes_[node_idx].num_children = num_children;
+
+  for (size_t i = 0; i < num_children; ++i) {
+    BuildNode(points, first_child + i, depth + 1);
+  }
+}
+
+std::vector<PointOctree::LeafSelection> PointOctree::SelectLOD(
+    const Eigen::Matrix4f& pmv_matrix,
+    const int viewport_width,
+    const int viewport_height,
+    const float point_size,
+    const size_t max_num_points) const {
+  std::vector<LeafSelection> selection;
+  if (nodes_.empty()) {
+    return selection;
+  }
+
+  const double point_area = std::max(1.0f, point_size * point_size);
+
+  size_t num_selected_points = 0;
+  std::vector<size_t> node_idxs = {0};
+  while (!node_idxs.empty()) {
+    const size_t node_idx = node_idxs.back();
+    node_idxs.pop_back();
+    const Node& node = nodes_[node_idx];
+
+    // Project the bounding box corners and count the corners outside of each
+    // of the six clipping planes.
+    std::array<int, 6> num_outside;
+    num_outside.fill(0);
+    bool behind_camera = false;
+    Eigen::Vector2f ndc_min = Eigen::Vector2f::Constant(1);
+    Eigen::Vector2f ndc_max = Eigen::Vector2f::Constant(-1);
+    for (int i = 0; i < 8; ++i) {
+      const Eigen::Vector4f corner =
+          pmv_matrix *
+          node.bbox.corner(static_cast<Eigen::AlignedBox3f::CornerType>(i))
+              .homogeneous();
+      for (int d = 0; d < 3; ++d) {
+        if (corner(d) < -corner(3)) {
+          ++num_outside[2 * d];
+        }
+        if (corner(d) > corner(3)) {
+          ++num_outside[2 * d + 1];
+        }
+      }
+      if (corner(3) <= 0) {
+        behind_camera = true;
+      } else {
+        const Eigen::Vector2f ndc = corner.head<2>() / corner(3);
+        ndc_min = ndc_min.cwiseMin(ndc);
+        ndc_max = ndc_max.cwiseMax(ndc);
+      }
+    }
+
+    if (std::find(num_outside.begin(), num_outside.end(), 8) !=
+        num_outside.end()) {
+      continue;
+    }
+
+    if (!node.IsLeaf()) {
+      for (size_t i = 0; i < node.num_children; ++i) {
+        node_idxs.push_back(node.first_child + i);
+      }
+      continue;
+    }
+
+    size_t num_points = node.NumPoints();
+    if (!behind_camera) {
+      // Screen area in pixels covered by the leaf, clipped to the viewport.
+      const Eigen::Vector2f extent =
+          (ndc_max.cwiseMin(1.0f) - ndc_min.cwiseMax(-1.0f)).cwiseMax(0.0f);
+      const double area = 0.25 * extent.x() * viewport_width * extent.y() *
+                          viewport_height;
+      const double num_visible_points =
+          std::ceil(options_.num_points_per_pixel * area / point_area);
+      if (num_visible_points < num_points) {
+        num_points = std::max<size_t>(1, num_visible_points);
+      }
+    }
+
+    selection.push_back({node_idx, num_points});
+    num_selected_points += num_points;
+  }
+
+  if (num_selected_points > max_num_points) {
+    const double scale =
+        static_cast<double>(max_num_points) / num_selected_points;
+    for (LeafSelection& leaf : selection) {
+      leaf.num_points =
+          std::max<size_t>(1, static_cast<size_t>(scale * leaf.num_points));
+    }
+  }
+
+  return selection;
+}
+
+}  // namespace colmap
@@ -0,0 +1,112 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+namespace colmap {
+
+// Octree over a static set of points for level-of-detail rendering. The points
+// are reordered such that every node covers a contiguous range of points and
+// the points within each leaf are randomly shuffled, so that any prefix of a
+// leaf is a uniform subsample of the leaf. Rendering a subset of the points
+// thus reduces to drawing a prefix of each visible leaf.
+class PointOctree {
+ public:
+  struct Options {
+    // Maximum number of points in a leaf node.
+    int max_num_points_per_leaf = 4096;
+
+    // Maximum depth of the tree, in case of many coincident points.
+    int max_depth = 20;
+
+    // Number of points rendered per pixel covered by a leaf's projection,
+    // relative to the area of a single rendered point.
+    double num_points_per_pixel = 1.0;
+
+    bool Check() const;
+  };
+
+  struct Node {
+    Eigen::AlignedBox3f bbox;
+    // Range of points in the node in octree order.
+    size_t begin = 0;
+    size_t end = 0;
+    // Children are stored consecutively. Leaf nodes have no children.
+    size_t first_child = 0;
+    size_t num_children = 0;
+
+    inline size_t NumPoints() const { return end - begin; }
+    inline bool IsLeaf() const { return num_children == 0; }
+  };
+
+  // Number of points to render from the front of a leaf node.
+  struct LeafSelection {
+    size_t node_idx = 0;
+    size_t num_points = 0;
+  };
+
+  PointOctree() = default;
+  PointOctree(const Options& options,
+              const std::vector<Eigen::Vector3f>& points);
+
+  inline size_t NumPoints() const { return point_idxs_.size(); }
+  inline const std::vector<Node>& Nodes() const { return nodes_; }
+
+  // Index of the input point for each point in octree order.
+  inline const std::vector<size_t>& PointIdxs() const { return point_idxs_; }
+
+  // Select the leaf nodes and number of points per leaf to render for the
+  // given projection-model-view matrix and viewport. Leaves outside the view
+  // frustum are culled and the number of points per leaf is limited by the
+  // screen area covered by the leaf. If the total number of selected points
+  // exceeds max_num_points, the points are uniformly thinned out over all
+  // selected leaves.
+  std::vector<LeafSelection> SelectLOD(const Eigen::Matrix4f& pmv_matrix,
+                                       int viewport_width,
+                                       int viewport_height,
+                                       float point_size,
+                                       size_t max_num_points) const;
+
+ private:
+  void BuildNode(const std::vector<Eigen::Vector3f>& points,
+                 size_t node_idx,
+                 int depth);
+
+  Options options_;
+  std::vector<Node> nodes_;
+  std::vector<size_t> point_idxs_;
+};
+
+}  // namespace colmap
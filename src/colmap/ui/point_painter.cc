@@ -29,6 +29,7 @@
 
 #include "colmap/ui/point_painter.h"
 
+#include "colmap/util/logging.h"
 #include "colmap/util/opengl_utils.h"
 
 namespace colmap {
@@ -77,15 +78,7 @@ void PointPainter::Upload(const std::vector<PointPainter::Data>& data) {
   vbo_.allocate(data.data(),
                 static_cast<int>(data.size() * sizeof(PointPainter::Data)));
 
-  // in_position
-  shader_program_.enableAttributeArray("a_position");
-  shader_program_.setAttributeBuffer(
-      "a_position", GL_FLOAT, 0, 3, sizeof(PointPainter::Data));
-
-  // in_color
-  shader_program_.enableAttributeArray("a_color");
-  shader_program_.setAttributeBuffer(
-      "a_color", GL_FLOAT, 3 * sizeof(GLfloat), 4, sizeof(PointPainter::Data));
+  SetupAttributes();
 
   // Make sure they are not changed from the outside
   vbo_.release();
@@ -96,6 +89,48 @@ void PointPainter::Upload(const std::vector<PointPainter::Data>& data) {
 #endif
 }
 
+void PointPainter::Allocate(const size_t num_points) {
+  num_geoms_ = num_points;
+  if (num_geoms_ == 0) {
+    return;
+  }
+
+  vao_.bind();
+  vbo_.bind();
+
+  vbo_.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+  vbo_.allocate(static_cast<int>(num_points * sizeof(PointPainter::Data)));
+
+  SetupAttributes();
+
+  vbo_.release();
+  vao_.release();
+
+#if DEBUG
+  glDebugLog();
+#endif
+}
+
+void PointPainter::UploadRange(const size_t offset,
+                               const PointPainter::Data* data,
+                               const size_t num) {
+  if (num == 0) {
+    return;
+  }
+
+  THROW_CHECK_LE(offset + num, num_geoms_);
+
+  vbo_.bind();
+  vbo_.write(static_cast<int>(offset * sizeof(PointPainter::Data)),
+             data,
+             static_cast<int>(num * sizeof(PointPainter::Data)));
+  vbo_.release();
+
+#if DEBUG
+  glDebugLog();
+#endif
+}
+
 void PointPainter::Render(const QMatrix4x4& pmv_matrix,
                           const float point_size) {
   if (num_geoms_ == 0) {
@@ -119,4 +154,42 @@ void PointPainter::Render(const QMatrix4x4& pmv_matrix,
 #endif
 }
 
+void PointPainter::Render(
+    const QMatrix4x4& pmv_matrix,
+    const float point_size,
+    const std::vector<std::pair<size_t, size_t>>& ranges) {
+  if (num_geoms_ == 0 || ranges.empty()) {
+    return;
+  }
+
+  shader_program_.bind();
+  vao_.bind();
+
+  shader_program_.setUniformValue("u_pmv_matrix", pmv_matrix);
+  shader_program_.setUniformValue("u_point_size", point_size);
+
+  QOpenGLFunctions* gl_funcs = QOpenGLContext::currentContext()->functions();
+  for (const auto& [offset, num] : ranges) {
+    gl_funcs->glDrawArrays(GL_POINTS, (GLint)offset, (GLsizei)num);
+  }
+
+  vao_.release();
+
+#if DEBUG
+  glDebugLog();
+#endif
+}
+
+void PointPainter::SetupAttributes() {
+  // in_position
+  shader_program_.enableAttributeArray("a_position");
+  shader_program_.setAttributeBuffer(
+      "a_position", GL_FLOAT, 0, 3, sizeof(PointPainter::Data));
+
+  // in_color
+  shader_program_.enableAttributeArray("a_color");
+  shader_program_.setAttributeBuffer(
+      "a_color", GL_FLOAT, 3 * sizeof(GLfloat), 4, sizeof(PointPainter::Data));
+}
+
 }  // namespace colmap
@@ -58,7 +58,19 @@ class PointPainter {
   void Upload(const std::vector<PointPainter::Data>& data);
   void Render(const QMatrix4x4& pmv_matrix, float point_size);
 
+  // Allocate the buffer for the given number of points without uploading any
+  // data, which can then be uploaded incrementally using UploadRange.
+  void Allocate(size_t num_points);
+  void UploadRange(size_t offset, const PointPainter::Data* data, size_t num);
+
+  // Render the given (offset, number of points) ranges of the buffer.
+  void Render(const QMatrix4x4& pmv_matrix,
+              float point_size,
+              const std::vector<std::pair<size_t, size_t>>& ranges);
+
  private:
+  void SetupAttributes();
+
   QOpenGLShaderProgram shader_program_;
   QOpenGLVertexArrayObject vao_;
   QOpenGLBuffer vbo_;
@@ -47,6 +47,10 @@ struct RenderOptions {
   // Maximum error for a point to be rendered.
   double max_error = 2;
 
+  // Maximum number of points rendered per frame. Models with more points are
+  // rendered at a view-dependent level of detail.
+  int max_num_points = 5000000;
+
   // The rate of registered images at which to refresh.
   int refresh_rate = 1;
 
@@ -63,6 +67,7 @@ struct RenderOptions {
   inline bool Check() const {
     CHECK_OPTION_GE(min_track_len, 0);
     CHECK_OPTION_GE(max_error, 0);
+    CHECK_OPTION_GT(max_num_points, 0);
     CHECK_OPTION_GT(refresh_rate, 0);
     CHECK_OPTION(projection_type == ProjectionType::PERSPECTIVE ||
                  projection_type == ProjectionType::ORTHOGRAPHIC);
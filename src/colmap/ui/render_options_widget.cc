@@ -31,6 +31,8 @@
 
 #include "colmap/ui/colormaps.h"
 
+#include <limits>
+
 namespace colmap {
 
 RenderOptionsWidget::RenderOptionsWidget(QWidget* parent,
@@ -103,6 +105,10 @@ RenderOptionsWidget::RenderOptionsWidget(QWidget* parent,
 
   AddOptionDouble(&options->render->max_error, "Point max. error [px]");
   AddOptionInt(&options->render->min_track_len, "Point min. track length", 0);
+  AddOptionInt(&options->render->max_num_points,
+               "Point max. number",
+               1,
+               std::numeric_limits<int>::max());
 
   AddSpacer();
 
@@ -0,0 +1,351 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "colmap/util/logging.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace colmap {
+
+// Associative container for unsigned integer identifiers that stores its
+// elements contiguously in memory. Identifiers are mapped to their slot in the
+// element array through a direct-address table, as long as the identifiers
+// are reasonably compact (e.g., sequentially generated), and through a hash
+// table for outliers. Iteration visits the elements in memory order.
+//
+// The interface mirrors the subset of std::unordered_map used in the code base.
+// In contrast to std::unordered_map, insertion invalidates all references and
+// iterators, and erasure moves the last element into the erased slot. Keys
+// must not be modified through iterators.
+template <typename key_t, typename value_t>
+class DenseIdMap {
+ public:
+  static_assert(std::is_integral_v<key_t> && std::is_unsigned_v<key_t>,
+                "Keys must be unsigned integers");
+
+  using key_type = key_t;
+  using mapped_type = value_t;
+  using value_type = std::pair<key_t, value_t>;
+  using size_type = size_t;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  // The number of elements.
+  inline size_t size() const;
+  inline bool empty() const;
+
+  // Iterate over all elements in memory order.
+  inline iterator begin();
+  inline iterator end();
+  inline const_iterator begin() const;
+  inline const_iterator end() const;
+  inline const_iterator cbegin() const;
+  inline const_iterator cend() const;
+
+  // Find the element with the given key or return end().
+  inline iterator find(key_t key);
+  inline const_iterator find(key_t key) const;
+  inline size_t count(key_t key) const;
+
+  // Access the element with the given key. Throws std::out_of_range if the
+  // element does not exist.
+  inline value_t& at(key_t key);
+  inline const value_t& at(key_t key) const;
+
+  // Access the element with the given key and default-insert it, if it does
+  // not exist.
+  value_t& operator[](key_t key);
+
+  // Insert a new element constructed from the given arguments, if no element
+  // with the same key exists. Returns the position of the element with the
+  // given key and whether insertion took place.
+  template <typename... args_t>
+  std::pair<iterator, bool> emplace(key_t key, args_t&&... args);
+
+  // Erase the element at the given position and return the iterator to the
+  // element that was moved into its place (or end()).
+  iterator erase(const_iterator pos);
+
+  // Erase the element with the given key and return the number of erased
+  // elements.
+  size_t erase(key_t key);
+
+  void clear();
+  void reserve(size_t num_elements);
+
+  bool operator==(const DenseIdMap& other) const;
+  bool operator!=(const DenseIdMap& other) const;
+
+ private:
+  using slot_t = uint32_t;
+  static constexpr slot_t kInvalidSlot = std::numeric_limits<slot_t>::max();
+
+  // Keys smaller than max(kMinNumDirectSlots, kMaxDirectSparsity * size()) are
+  // indexed through the direct-address table, all others are hashed.
+  static constexpr size_t kMinNumDirectSlots = 1024;
+  static constexpr size_t kMaxDirectSparsity = 4;
+
+  inline slot_t FindSlot(key_t key) const;
+  void InsertSlot(key_t key, slot_t slot);
+  void UpdateSlot(key_t key, slot_t slot);
+  void EraseSlot(key_t key);
+
+  std::vector<value_type> values_;
+  std::vector<slot_t> direct_slots_;
+  std::unordered_map<key_t, slot_t> sparse_slots_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename key_t, typename value_t>
+size_t DenseIdMap<key_t, value_t>::size() const {
+  return values_.size();
+}
+
+template <typename key_t, typename value_t>
+bool DenseIdMap<key_t, value_t>::empty() const {
+  return values_.empty();
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::iterator
+DenseIdMap<key_t, value_t>::begin() {
+  return values_.begin();
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::iterator DenseIdMap<key_t, value_t>::end() {
+  return values_.end();
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::const_iterator
+DenseIdMap<key_t, value_t>::begin() const {
+  return values_.begin();
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::const_iterator
+DenseIdMap<key_t, value_t>::end() const {
+  return values_.end();
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::const_iterator
+DenseIdMap<key_t, value_t>::cbegin() const {
+  return values_.cbegin();
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::const_iterator
+DenseIdMap<key_t, value_t>::cend() const {
+  return values_.cend();
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::iterator DenseIdMap<key_t, value_t>::find(
+    const key_t key) {
+  const slot_t slot = FindSlot(key);
+  return slot == kInvalidSlot ? values_.end() : values_.begin() + slot;
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::const_iterator
+DenseIdMap<key_t, value_t>::find(const key_t key) const {
+  const slot_t slot = FindSlot(key);
+  return slot == kInvalidSlot ? values_.end() : values_.begin() + slot;
+}
+
+template <typename key_t, typename value_t>
+size_t DenseIdMap<key_t, value_t>::count(const key_t key) const {
+  return FindSlot(key) == kInvalidSlot ? 0 : 1;
+}
+
+template <typename key_t, typename value_t>
+value_t& DenseIdMap<key_t, value_t>::at(const key_t key) {
+  const slot_t slot = FindSlot(key);
+  if (slot == kInvalidSlot) {
+    throw std::out_of_range("DenseIdMap::at");
+  }
+  return values_[slot].second;
+}
+
+template <typename key_t, typename value_t>
+const value_t& DenseIdMap<key_t, value_t>::at(const key_t key) const {
+  const slot_t slot = FindSlot(key);
+  if (slot == kInvalidSlot) {
+    throw std::out_of_range("DenseIdMap::at");
+  }
+  return values_[slot].second;
+}
+
+template <typename key_t, typename value_t>
+value_t& DenseIdMap<key_t, value_t>::operator[](const key_t key) {
+  return emplace(key).first->second;
+}
+
+template <typename key_t, typename value_t>
+template <typename... args_t>
+std::pair<typename DenseIdMap<key_t, value_t>::iterator, bool>
+DenseIdMap<key_t, value_t>::emplace(const key_t key, args_t&&... args) {
+  const slot_t existing_slot = FindSlot(key);
+  if (existing_slot != kInvalidSlot) {
+    return {values_.begin() + existing_slot, false};
+  }
+  THROW_CHECK_LT(values_.size(), kInvalidSlot);
+  const slot_t slot = static_cast<slot_t>(values_.size());
+  values_.emplace_back(std::piecewise_construct,
+                       std::forward_as_tuple(key),
+                       std::forward_as_tuple(std::forward<args_t>(args)...));
+  InsertSlot(key, slot);
+  return {values_.begin() + slot, true};
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::iterator
+DenseIdMap<key_t, value_t>::erase(const const_iterator pos) {
+  const size_t slot = pos - values_.cbegin();
+  EraseSlot(values_[slot].first);
+  const size_t last_slot = values_.size() - 1;
+  if (slot != last_slot) {
+    values_[slot] = std::move(values_[last_slot]);
+    UpdateSlot(values_[slot].first, static_cast<slot_t>(slot));
+  }
+  values_.pop_back();
+  return values_.begin() + slot;
+}
+
+template <typename key_t, typename value_t>
+size_t DenseIdMap<key_t, value_t>::erase(const key_t key) {
+  const slot_t slot = FindSlot(key);
+  if (slot == kInvalidSlot) {
+    return 0;
+  }
+  erase(values_.cbegin() + slot);
+  return 1;
+}
+
+template <typename key_t, typename value_t>
+void DenseIdMap<key_t, value_t>::clear() {
+  values_.clear();
+  direct_slots_.clear();
+  sparse_slots_.clear();
+}
+
+template <typename key_t, typename value_t>
+void DenseIdMap<key_t, value_t>::reserve(const size_t num_elements) {
+  values_.reserve(num_elements);
+}
+
+template <typename key_t, typename value_t>
+bool DenseIdMap<key_t, value_t>::operator==(const DenseIdMap& other) const {
+  if (size() != other.size()) {
+    return false;
+  }
+  for (const auto& [key, value] : values_) {
+    const auto it = other.find(key);
+    if (it == other.end() || !(it->second == value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename key_t, typename value_t>
+bool DenseIdMap<key_t, value_t>::operator!=(const DenseIdMap& other) const {
+  return !(*this == other);
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::slot_t
+DenseIdMap<key_t, value_t>::FindSlot(const key_t key) const {
+  if (key < direct_slots_.size()) {
+    return direct_slots_[key];
+  }
+  const auto it = sparse_slots_.find(key);
+  return it == sparse_slots_.end() ? kInvalidSlot : it->second;
+}
+
+template <typename key_t, typename value_t>
+void DenseIdMap<key_t, value_t>::InsertSlot(const key_t key,
+                                            const slot_t slot) {
+  const size_t max_num_direct_slots =
+      std::max(kMinNumDirectSlots, kMaxDirectSparsity * values_.size());
+  if (key >= direct_slots_.size() && key < max_num_direct_slots) {
+    // Grow the direct-address table geometrically and move all hashed keys
+    // that are now covered by the table.
+    const size_t num_direct_slots =
+        std::min(max_num_direct_slots,
+                 std::max(static_cast<size_t>(key) + 1,
+                          2 * direct_slots_.size()));
+    direct_slots_.resize(num_direct_slots, kInvalidSlot);
+    for (auto it = sparse_slots_.begin(); it != sparse_slots_.end();) {
+      if (it->first < num_direct_slots) {
+        direct_slots_[it->first] = it->second;
+        it = sparse_slots_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  UpdateSlot(key, slot);
+}
+
+template <typename key_t, typename value_t>
+void DenseIdMap<key_t, value_t>::UpdateSlot(const key_t key,
+                                            const slot_t slot) {
+  if (key < direct_slots_.size()) {
+    direct_slots_[key] = slot;
+  } else {
+    sparse_slots_[key] = slot;
+  }
+}
+
+template <typename key_t, typename value_t>
+void DenseIdMap<key_t, value_t>::EraseSlot(const key_t key) {
+  if (key < direct_slots_.size()) {
+    direct_slots_[key] = kInvalidSlot;
+  } else {
+    sparse_slots_.erase(key);
+  }
+}
+
+}  // namespace colmap
@@ -0,0 +1,167 @@
+// Copyright (c), ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "colmap/util/dense_id_map.h"
+
+#include <string>
+#include <unordered_map>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace colmap {
+namespace {
+
+TEST(DenseIdMap, Empty) {
+  DenseIdMap<uint64_t, int> map;
+  EXPECT_EQ(map.size(), 0);
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+  EXPECT_EQ(map.find(0), map.end());
+  EXPECT_EQ(map.count(0), 0);
+  EXPECT_ANY_THROW(map.at(0));
+}
+
+TEST(DenseIdMap, EmplaceAndFind) {
+  DenseIdMap<uint64_t, std::string> map;
+  EXPECT_TRUE(map.emplace(1, "a").second);
+  EXPECT_TRUE(map.emplace(3, "c").second);
+  EXPECT_FALSE(map.emplace(1, "b").second);
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_FALSE(map.empty());
+  EXPECT_EQ(map.at(1), "a");
+  EXPECT_EQ(map.at(3), "c");
+  EXPECT_EQ(map.count(1), 1);
+  EXPECT_EQ(map.count(2), 0);
+  EXPECT_EQ(map.find(2), map.end());
+  EXPECT_EQ(map.find(3)->first, 3);
+  EXPECT_EQ(map.find(3)->second, "c");
+  map[2] = "b";
+  EXPECT_EQ(map.size(), 3);
+  EXPECT_EQ(map.at(2), "b");
+}
+
+TEST(DenseIdMap, IterateInInsertionOrder) {
+  DenseIdMap<uint32_t, int> map;
+  for (uint32_t i = 10; i > 0; --i) {
+    map.emplace(i, 2 * i);
+  }
+  uint32_t expected_key = 10;
+  for (const auto& [key, value] : map) {
+    EXPECT_EQ(key, expected_key);
+    EXPECT_EQ(value, 2 * expected_key);
+    --expected_key;
+  }
+}
+
+TEST(DenseIdMap, Erase) {
+  DenseIdMap<uint64_t, int> map;
+  for (uint64_t i = 0; i < 10; ++i) {
+    map.emplace(i, i);
+  }
+  EXPECT_EQ(map.erase(3), 1);
+  EXPECT_EQ(map.erase(3), 0);
+  EXPECT_EQ(map.size(), 9);
+  EXPECT_EQ(map.count(3), 0);
+  // The last element is moved into the erased slot.
+  EXPECT_EQ(map.begin()[3].first, 9);
+  for (uint64_t i = 0; i < 10; ++i) {
+    if (i != 3) {
+      EXPECT_EQ(map.at(i), i);
+    }
+  }
+
+  for (auto it = map.begin(); it != map.end();) {
+    if (it->first % 2 == 0) {
+      it = map.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  EXPECT_EQ(map.size(), 4);
+  for (uint64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(map.count(i), i % 2 == 1 && i != 3);
+  }
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.count(1), 0);
+}
+
+TEST(DenseIdMap, SparseKeys) {
+  DenseIdMap<uint64_t, uint64_t> map;
+  std::unordered_map<uint64_t, uint64_t> ref_map;
+  const std::vector<uint64_t> keys = {
+      1, 1000000, 2, std::numeric_limits<uint64_t>::max() - 1, 5000, 3, 1023};
+  for (const uint64_t key : keys) {
+    map.emplace(key, key + 1);
+    ref_map.emplace(key, key + 1);
+  }
+  // Densely fill up so that previously hashed keys become directly indexed.
+  for (uint64_t key = 4; key < 400000; ++key) {
+    map.emplace(key, key + 1);
+    ref_map.emplace(key, key + 1);
+  }
+  EXPECT_EQ(map.size(), ref_map.size());
+  for (const auto& [key, value] : ref_map) {
+    EXPECT_EQ(map.at(key), value);
+  }
+  for (const uint64_t key : keys) {
+    EXPECT_EQ(map.erase(key), 1);
+    EXPECT_EQ(map.count(key), 0);
+  }
+  EXPECT_EQ(map.size(), ref_map.size() - keys.size());
+}
+
+TEST(DenseIdMap, Equals) {
+  DenseIdMap<uint64_t, int> map1;
+  DenseIdMap<uint64_t, int> map2;
+  EXPECT_EQ(map1, map2);
+  map1.emplace(1, 1);
+  map1.emplace(2, 2);
+  EXPECT_NE(map1, map2);
+  map2.emplace(2, 2);
+  map2.emplace(1, 1);
+  EXPECT_EQ(map1, map2);
+  map2.at(1) = 3;
+  EXPECT_NE(map1, map2);
+}
+
+TEST(DenseIdMap, Copy) {
+  DenseIdMap<uint64_t, int> map1;
+  map1.emplace(1, 1);
+  DenseIdMap<uint64_t, int> map2 = map1;
+  EXPECT_EQ(map1, map2);
+  map2.emplace(2, 2);
+  map1 = map2;
+  EXPECT_EQ(map1.at(2), 2);
+}
+
+}  // namespace
+}  // namespace colmap
@@ -31,6 +31,7 @@
 
 #include "colmap/util/timer.h"
 
+#include <algorithm>
 #include <climits>
 #include <functional>
 #include <future>
@@ -39,6 +40,7 @@
 #include <thread>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 namespace colmap {
 
@@ -294,6 +296,10 @@ class JobQueue {
   // Pop a job from the queue. Waits if there is no job in the queue.
   Job Pop();
 
+  // Pop a job from the queue without waiting. Returns an invalid job if there
+  // is no job in the queue or if the queue is stopped.
+  Job TryPop();
+
   // Wait for all jobs to be popped and then stop the queue.
   void Wait();
 
@@ -317,6 +323,39 @@ class JobQueue {
 // otherwise return the input value of num_threads.
 int GetEffectiveNumThreads(int num_threads);
 
+// Number of chunks of the given size to cover num_items items.
+inline size_t NumChunks(size_t num_items, size_t chunk_size);
+
+// Process the index range [0, num_items) in chunks of chunk_size consecutive
+// indices using up to num_threads threads (see GetEffectiveNumThreads), e.g.:
+//
+//    std::vector<double> chunk_sums(NumChunks(values.size(), kChunkSize), 0);
+//    ParallelForChunks(values.size(), kChunkSize, num_threads,
+//        [&](size_t chunk_idx, size_t begin, size_t end) {
+//          for (size_t i = begin; i < end; ++i) {
+//            chunk_sums[chunk_idx] += values[i];
+//          }
+//        });
+//    const double sum =
+//        std::accumulate(chunk_sums.begin(), chunk_sums.end(), 0.0);
+//
+// The partitioning into chunks does not depend on the number of threads, so
+// per-chunk results combined in chunk order are deterministic. If there is
+// only a single chunk or thread, all chunks are processed on the calling
+// thread. Exceptions thrown by func are rethrown on the calling thread.
+template <typename func_t>
+void ParallelForChunks(size_t num_items,
+                       size_t chunk_size,
+                       int num_threads,
+                       func_t&& func);
+
+// Same as ParallelForChunks but calls func(idx) for every index.
+template <typename func_t>
+void ParallelFor(size_t num_items,
+                 size_t chunk_size,
+                 int num_threads,
+                 func_t&& func);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
@@ -346,6 +385,59 @@ auto ThreadPool::AddTask(func_t&& f, args_t&&... args)
   return result;
 }
 
+size_t NumChunks(const size_t num_items, const size_t chunk_size) {
+  return (num_items + chunk_size - 1) / chunk_size;
+}
+
+template <typename func_t>
+void ParallelForChunks(const size_t num_items,
+                       const size_t chunk_size,
+                       const int num_threads,
+                       func_t&& func) {
+  const size_t num_chunks = NumChunks(num_items, chunk_size);
+  const auto process_chunk = [&](const size_t chunk_idx) {
+    const size_t begin = chunk_idx * chunk_size;
+    const size_t end = std::min(begin + chunk_size, num_items);
+    func(chunk_idx, begin, end);
+  };
+
+  const size_t num_eff_threads = std::min(
+      static_cast<size_t>(GetEffectiveNumThreads(num_threads)), num_chunks);
+  if (num_eff_threads <= 1) {
+    for (size_t chunk_idx = 0; chunk_idx < num_chunks; ++chunk_idx) {
+      process_chunk(chunk_idx);
+    }
+    return;
+  }
+
+  ThreadPool thread_pool(static_cast<int>(num_eff_threads));
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_chunks);
+  for (size_t chunk_idx = 0; chunk_idx < num_chunks; ++chunk_idx) {
+    futures.push_back(thread_pool.AddTask(process_chunk, chunk_idx));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+}
+
+template <typename func_t>
+void ParallelFor(const size_t num_items,
+                 const size_t chunk_size,
+                 const int num_threads,
+                 func_t&& func) {
+  ParallelForChunks(num_items,
+                    chunk_size,
+                    num_threads,
+                    [&func](const size_t /*chunk_idx*/,
+                            const size_t begin,
+                            const size_t end) {
+                      for (size_t idx = begin; idx < end; ++idx) {
+                        func(idx);
+                      }
+                    });
+}
+
 template <typename T>
 JobQueue<T>::JobQueue() : JobQueue(std::numeric_limits<size_t>::max()) {}
 
@@ -398,6 +490,21 @@ typename JobQueue<T>::Job JobQueue<T>::Pop() {
   }
 }
 
+template <typename T>
+typename JobQueue<T>::Job JobQueue<T>::TryPop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (jobs_.empty() || stop_) {
+    return Job();
+  }
+  Job job(std::move(jobs_.front()));
+  jobs_.pop();
+  pop_condition_.notify_one();
+  if (jobs_.empty()) {
+    empty_condition_.notify_all();
+  }
+  return job;
+}
+
 template <typename T>
 void JobQueue<T>::Wait() {
   std::unique_lock<std::mutex> lock(mutex_);
@@ -887,6 +887,22 @@ TEST(JobQueue, Clear) {
   EXPECT_EQ(job_queue.Size(), 0);
 }
 
+TEST(JobQueue, TryPop) {
+  JobQueue<int> job_queue;
+
+  EXPECT_FALSE(job_queue.TryPop().IsValid());
+
+  EXPECT_TRUE(job_queue.Push(1));
+  EXPECT_TRUE(job_queue.Push(2));
+  auto job = job_queue.TryPop();
+  EXPECT_TRUE(job.IsValid());
+  EXPECT_EQ(job.Data(), 1);
+  EXPECT_EQ(job_queue.Size(), 1);
+
+  job_queue.Stop();
+  EXPECT_FALSE(job_queue.TryPop().IsValid());
+}
+
 TEST(GetEffectiveNumThreads, Nominal) {
   EXPECT_GT(GetEffectiveNumThreads(-2), 0);
   EXPECT_GT(GetEffectiveNumThreads(-1), 0);
@@ -896,5 +912,63 @@ TEST(GetEffectiveNumThreads, Nominal) {
   EXPECT_EQ(GetEffectiveNumThreads(3), 3);
 }
 
+TEST(NumChunks, Nominal) {
+  EXPECT_EQ(NumChunks(0, 4), 0);
+  EXPECT_EQ(NumChunks(1, 4), 1);
+  EXPECT_EQ(NumChunks(4, 4), 1);
+  EXPECT_EQ(NumChunks(5, 4), 2);
+}
+
+TEST(ParallelForChunks, Nominal) {
+  for (const int num_threads : {1, 2, 4}) {
+    for (const size_t num_items : {0, 1, 7, 8, 100}) {
+      const size_t kChunkSize = 8;
+      std::vector<int> visited(num_items, 0);
+      std::vector<size_t> chunk_sizes(NumChunks(num_items, kChunkSize), 0);
+      ParallelForChunks(
+          num_items,
+          kChunkSize,
+          num_threads,
+          [&](const size_t chunk_idx, const size_t begin, const size_t end) {
+            chunk_sizes[chunk_idx] = end - begin;
+            for (size_t i = begin; i < end; ++i) {
+              visited[i] += 1;
+            }
+          });
+      for (const int v : visited) {
+        EXPECT_EQ(v, 1);
+      }
+      for (size_t chunk_idx = 0; chunk_idx < chunk_sizes.size(); ++chunk_idx) {
+        EXPECT_EQ(chunk_sizes[chunk_idx],
+                  std::min(kChunkSize, num_items - chunk_idx * kChunkSize));
+      }
+    }
+  }
+}
+
+TEST(ParallelForChunks, RethrowsException) {
+  EXPECT_THROW(ParallelForChunks(100,
+                                 1,
+                                 4,
+                                 [](const size_t chunk_idx, size_t, size_t) {
+                                   if (chunk_idx == 42) {
+                                     throw std::runtime_error("error");
+                                   }
+                                 }),
+               std::runtime_error);
+}
+
+TEST(ParallelFor, Nominal) {
+  for (const int num_threads : {1, 3}) {
+    std::vector<int> values(1000, 0);
+    ParallelFor(values.size(), 16, num_threads, [&](const size_t i) {
+      values[i] = static_cast<int>(i);
+    });
+    for (size_t i = 0; i < values.size(); ++i) {
+      EXPECT_EQ(values[i], i);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace colmap
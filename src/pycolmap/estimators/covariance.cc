@@ -92,7 +92,19 @@ void BindCovarianceEstimator(py::module& m) {
           "to specify a custom set of pose parameter blocks to consider. Note "
           "that these pose blocks must not necessarily be part of the "
           "reconstruction but they must follow the standard requirement for "
-          "applying the Schur complement trick.");
+          "applying the Schur complement trick.")
+      .def_readwrite(
+          "use_selected_inversion",
+          &BACovarianceOptions::use_selected_inversion,
+          "Whether to only compute the entries of the inverse Schur "
+          "complement in the sparsity pattern of its factorization instead "
+          "of the dense inverse. Scales to large problems but only provides "
+          "cross-covariances for connected poses.")
+      .def_readwrite(
+          "num_threads",
+          &BACovarianceOptions::num_threads,
+          "The number of threads used for the Schur elimination of the "
+          "points.");
   MakeDataclass(PyBACovarianceOptions);
 
   py::class_<BACovariance>(m, "BACovariance")
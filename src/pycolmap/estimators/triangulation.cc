@@ -54,6 +54,10 @@ void BindTriangulationEstimator(py::module& m) {
                      "Minimum triangulation angle in radians.")
       .def_readwrite(
           "residual_type", &Options::residual_type, "Employed residual type.")
+      .def_readwrite("max_num_exhaustive_sampling_observations",
+                     &Options::max_num_exhaustive_sampling_observations,
+                     "Enforce exhaustive sampling of all observation pairs for "
+                     "points with at most this number of observations.")
       .def_readwrite("ransac", &Options::ransac_options, "RANSAC options.");
   MakeDataclass(PyTriangulationOptions);
 
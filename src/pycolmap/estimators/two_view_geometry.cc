@@ -46,6 +46,13 @@ void BindTwoViewGeometryEstimator(py::module& m) {
                      &TwoViewGeometryOptions::compute_relative_pose)
       .def_readwrite("multiple_models",
                      &TwoViewGeometryOptions::multiple_models)
+      .def_readwrite("staged_calibrated_estimation",
+                     &TwoViewGeometryOptions::staged_calibrated_estimation)
+      .def_readwrite("pre_filter", &TwoViewGeometryOptions::pre_filter)
+      .def_readwrite("pre_filter_min_inlier_ratio",
+                     &TwoViewGeometryOptions::pre_filter_min_inlier_ratio)
+      .def_readwrite("pre_filter_confidence",
+                     &TwoViewGeometryOptions::pre_filter_confidence)
       .def_readwrite("ransac", &TwoViewGeometryOptions::ransac_options);
   MakeDataclass(PyTwoViewGeometryOptions);
 
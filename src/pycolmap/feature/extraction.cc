@@ -1,6 +1,9 @@
+#include "colmap/feature/extractor.h"
 #include "colmap/feature/sift.h"
 #include "colmap/feature/utils.h"
+#include "colmap/sensor/bitmap.h"
 
+#include "pycolmap/feature/types.h"
 #include "pycolmap/helpers.h"
 #include "pycolmap/utils.h"
 
@@ -26,6 +29,8 @@ typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
 typedef Eigen::Matrix<float, Eigen::Dynamic, kKeypointDim, Eigen::RowMajor>
     keypoints_t;
 typedef std::tuple<keypoints_t, descriptors_t> sift_output_t;
+typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+    custom_keypoints_t;
 
 static std::map<int, std::unique_ptr<std::mutex>> sift_gpu_mutexes;
 
@@ -98,6 +103,57 @@ class Sift {
   bool use_gpu_ = false;
 };
 
+// Feature extractor that calls the extract method of a Python object, which
+// receives a Bitmap and returns the keypoints as an Nx2, Nx4, or Nx6 array
+// (see FeatureKeypoint for the format) and the descriptors as an NxD uint8
+// array. The GIL is only held during the call.
+class PyFeatureExtractor : public FeatureExtractor {
+ public:
+  explicit PyFeatureExtractor(std::shared_ptr<py::object> extractor)
+      : extractor_(std::move(extractor)) {}
+
+  bool Extract(const Bitmap& bitmap,
+               FeatureKeypoints* keypoints,
+               FeatureDescriptors* descriptors) override {
+    py::gil_scoped_acquire acquire;
+    try {
+      const py::tuple result = extractor_->attr("extract")(
+          py::cast(&bitmap, py::return_value_policy::reference));
+      THROW_CHECK_EQ(result.size(), 2);
+      const auto keypoints_matrix = result[0].cast<custom_keypoints_t>();
+      *descriptors = result[1].cast<FeatureDescriptors>();
+      THROW_CHECK_EQ(keypoints_matrix.rows(), descriptors->rows());
+
+      keypoints->resize(keypoints_matrix.rows());
+      for (Eigen::Index i = 0; i < keypoints_matrix.rows(); ++i) {
+        const auto row = keypoints_matrix.row(i);
+        switch (keypoints_matrix.cols()) {
+          case 2:
+            (*keypoints)[i] = FeatureKeypoint(row(0), row(1));
+            break;
+          case 4:
+            (*keypoints)[i] = FeatureKeypoint(row(0), row(1), row(2), row(3));
+            break;
+          case 6:
+            (*keypoints)[i] = FeatureKeypoint(
+                row(0), row(1), row(2), row(3), row(4), row(5));
+            break;
+          default:
+            throw std::invalid_argument(
+                "Keypoints must have 2, 4, or 6 columns");
+        }
+      }
+    } catch (const std::exception& error) {
+      LOG(ERROR) << "Custom feature extraction failed: " << error.what();
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  std::shared_ptr<py::object> extractor_;
+};
+
 void BindFeatureExtraction(py::module& m) {
   auto PyNormalization =
       py::enum_<SiftExtractionOptions::Normalization>(m, "Normalization")
@@ -171,11 +227,19 @@ void BindFeatureExtraction(py::module& m) {
           .def("check", &SiftExtractionOptions::Check);
   MakeDataclass(PySiftExtractionOptions);
 
+  auto PyFeatureExtractorType =
+      py::enum_<FeatureExtractorType>(m, "FeatureExtractorType")
+          .value("SIFT", FeatureExtractorType::SIFT)
+          .value("CUSTOM", FeatureExtractorType::CUSTOM);
+  AddStringToEnumConstructor(PyFeatureExtractorType);
+
   auto PyFeatureExtractionOptions =
       py::class_<FeatureExtractionOptions,
                  std::shared_ptr<FeatureExtractionOptions>>(
           m, "FeatureExtractionOptions")
           .def(py::init<>())
+          .def(py::init<FeatureExtractorType>(), "type"_a)
+          .def_readwrite("type", &FeatureExtractionOptions::type)
           .def_readwrite("num_threads",
                          &FeatureExtractionOptions::num_threads,
                          "Number of threads for feature matching and "
@@ -187,9 +251,46 @@ void BindFeatureExtraction(py::module& m) {
                          "multi-GPU matching, you should separate multiple "
                          "GPU indices by comma, e.g., '0,1,2,3'.")
           .def_readwrite("sift", &FeatureExtractionOptions::sift)
+          .def_readwrite("custom_extractor",
+                         &FeatureExtractionOptions::custom_extractor,
+                         "Name of the registered feature extractor used for "
+                         "the CUSTOM type.")
+          .def_readwrite("custom_max_image_size",
+                         &FeatureExtractionOptions::custom_max_image_size,
+                         "Maximum image size for the CUSTOM type, otherwise "
+                         "image will be down-scaled.")
           .def("check", &FeatureExtractionOptions::Check);
   MakeDataclass(PyFeatureExtractionOptions);
 
+  m.def(
+      "register_feature_extractor",
+      [](const std::string& name, py::object factory) {
+        std::shared_ptr<py::object> shared_factory =
+            MakeSharedPyObject(std::move(factory));
+        RegisterFeatureExtractor(
+            name,
+            [shared_factory](const FeatureExtractionOptions& options)
+                -> std::unique_ptr<FeatureExtractor> {
+              py::gil_scoped_acquire acquire;
+              try {
+                return std::make_unique<PyFeatureExtractor>(
+                    MakeSharedPyObject((*shared_factory)(options)));
+              } catch (const std::exception& error) {
+                LOG(ERROR) << "Failed to create custom feature extractor: "
+                           << error.what();
+                return nullptr;
+              }
+            });
+      },
+      "name"_a,
+      "factory"_a,
+      "Register a custom feature extractor for the CUSTOM extractor type. "
+      "The factory is called with the FeatureExtractionOptions once per "
+      "extraction thread and must return an object with a method "
+      "extract(bitmap) -> (keypoints, descriptors), where keypoints is an "
+      "Nx2, Nx4, or Nx6 float array and descriptors an NxD uint8 array.");
+  m.def("unregister_feature_extractor", &UnregisterFeatureExtractor, "name"_a);
+
   py::class_<Sift>(m, "Sift")
       .def(py::init<std::optional<FeatureExtractionOptions>, Device>(),
            "options"_a = std::nullopt,
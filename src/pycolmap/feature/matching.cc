@@ -1,5 +1,7 @@
+#include "colmap/feature/matcher.h"
 #include "colmap/feature/sift.h"
 #include "colmap/feature/utils.h"
+#include "colmap/scene/two_view_geometry.h"
 
 #include "pycolmap/feature/types.h"
 #include "pycolmap/helpers.h"
@@ -8,11 +10,101 @@
 #include <Eigen/Core>
 #include <pybind11/eigen.h>
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 
 using namespace colmap;
 using namespace pybind11::literals;
 namespace py = pybind11;
 
+// Feature matcher that calls the methods of a Python object. The object must
+// implement match(image1, image2) returning an Nx2 array of keypoint indices
+// and may implement match_batch(image_pairs) returning a list of such arrays,
+// match_guided(max_error, image1, image2) returning a TwoViewGeometry, and a
+// max_batch_size attribute. The GIL is only held during the calls.
+class PyFeatureMatcher : public FeatureMatcher {
+ public:
+  explicit PyFeatureMatcher(std::shared_ptr<py::object> matcher)
+      : matcher_(std::move(matcher)) {
+    py::gil_scoped_acquire acquire;
+    has_match_batch_ = py::hasattr(*matcher_, "match_batch");
+    if (py::hasattr(*matcher_, "max_batch_size")) {
+      max_batch_size_ = matcher_->attr("max_batch_size").cast<int>();
+    }
+  }
+
+  void Match(const Image& image1,
+             const Image& image2,
+             FeatureMatches* matches) override {
+    py::gil_scoped_acquire acquire;
+    try {
+      *matches = FeatureMatchesFromMatrix(
+          matcher_->attr("match")(CastImage(image1), CastImage(image2))
+              .cast<PyFeatureMatches>());
+    } catch (const std::exception& error) {
+      LOG(ERROR) << "Custom feature matching failed: " << error.what();
+      matches->clear();
+    }
+  }
+
+  void MatchGuided(double max_error,
+                   const Image& image1,
+                   const Image& image2,
+                   TwoViewGeometry* two_view_geometry) override {
+    py::gil_scoped_acquire acquire;
+    try {
+      *two_view_geometry =
+          matcher_
+              ->attr("match_guided")(
+                  max_error, CastImage(image1), CastImage(image2))
+              .cast<TwoViewGeometry>();
+    } catch (const std::exception& error) {
+      LOG(ERROR) << "Custom guided feature matching failed: " << error.what();
+    }
+  }
+
+  int MaxBatchSize() const override { return max_batch_size_; }
+
+  void MatchBatch(const std::vector<std::pair<Image, Image>>& image_pairs,
+                  std::vector<FeatureMatches>* matches) override {
+    if (!has_match_batch_) {
+      FeatureMatcher::MatchBatch(image_pairs, matches);
+      return;
+    }
+    matches->resize(image_pairs.size());
+    py::gil_scoped_acquire acquire;
+    try {
+      py::list py_image_pairs;
+      for (const auto& [image1, image2] : image_pairs) {
+        py_image_pairs.append(
+            py::make_tuple(CastImage(image1), CastImage(image2)));
+      }
+      const py::list batch_matches =
+          matcher_->attr("match_batch")(py_image_pairs);
+      THROW_CHECK_EQ(batch_matches.size(), image_pairs.size());
+      for (size_t i = 0; i < image_pairs.size(); ++i) {
+        (*matches)[i] = FeatureMatchesFromMatrix(
+            batch_matches[i].cast<PyFeatureMatches>());
+      }
+    } catch (const std::exception& error) {
+      LOG(ERROR) << "Custom batched feature matching failed: " << error.what();
+      for (FeatureMatches& pair_matches : *matches) {
+        pair_matches.clear();
+      }
+    }
+  }
+
+ private:
+  // The images are copied, since they are cheap to copy and the Python side
+  // may keep references to them beyond the call.
+  static py::object CastImage(const Image& image) {
+    return py::cast(image, py::return_value_policy::copy);
+  }
+
+  std::shared_ptr<py::object> matcher_;
+  bool has_match_batch_ = false;
+  int max_batch_size_ = 1;
+};
+
 void BindFeatureMatching(py::module& m) {
   auto PySiftMatchingOptions =
       py::class_<SiftMatchingOptions, std::shared_ptr<SiftMatchingOptions>>(
@@ -35,11 +127,19 @@ void BindFeatureMatching(py::module& m) {
           .def("check", &SiftMatchingOptions::Check);
   MakeDataclass(PySiftMatchingOptions);
 
+  auto PyFeatureMatcherType =
+      py::enum_<FeatureMatcherType>(m, "FeatureMatcherType")
+          .value("SIFT", FeatureMatcherType::SIFT)
+          .value("CUSTOM", FeatureMatcherType::CUSTOM);
+  AddStringToEnumConstructor(PyFeatureMatcherType);
+
   auto PyFeatureMatchingOptions =
       py::class_<FeatureMatchingOptions,
                  std::shared_ptr<FeatureMatchingOptions>>(
           m, "FeatureMatchingOptions")
           .def(py::init<>())
+          .def(py::init<FeatureMatcherType>(), "type"_a)
+          .def_readwrite("type", &FeatureMatchingOptions::type)
           .def_readwrite("num_threads", &FeatureMatchingOptions::num_threads)
           .def_readwrite("use_gpu", &FeatureMatchingOptions::use_gpu)
           .def_readwrite("gpu_index",
@@ -61,6 +161,69 @@ void BindFeatureMatching(py::module& m) {
               "Whether to skip matching images within the same frame. This is "
               "useful for the case of non-overlapping cameras in a rig.")
           .def_readwrite("sift", &FeatureMatchingOptions::sift)
+          .def_readwrite("custom_matcher",
+                         &FeatureMatchingOptions::custom_matcher,
+                         "Name of the registered feature matcher used for the "
+                         "CUSTOM type.")
           .def("check", &FeatureMatchingOptions::Check);
   MakeDataclass(PyFeatureMatchingOptions);
+
+  static_assert(sizeof(FeatureKeypoint) == 6 * sizeof(float),
+                "FeatureKeypoint must be six packed floats");
+  py::class_<FeatureMatcher::Image>(m, "FeatureMatcherImage")
+      .def_readonly("image_id", &FeatureMatcher::Image::image_id)
+      .def_readonly("width", &FeatureMatcher::Image::width)
+      .def_readonly("height", &FeatureMatcher::Image::height)
+      .def_property_readonly(
+          "keypoints",
+          [](const FeatureMatcher::Image& self) {
+            return Eigen::Map<const Eigen::Matrix<float,
+                                                  Eigen::Dynamic,
+                                                  6,
+                                                  Eigen::RowMajor>>(
+                reinterpret_cast<const float*>(self.keypoints->data()),
+                self.keypoints->size(),
+                6);
+          },
+          py::return_value_policy::reference_internal,
+          "Nx6 array of keypoints with x, y, a11, a12, a21, a22 columns.")
+      .def_property_readonly(
+          "descriptors",
+          [](const FeatureMatcher::Image& self) -> const FeatureDescriptors& {
+            return *self.descriptors;
+          },
+          py::return_value_policy::reference_internal,
+          "NxD array of descriptors.");
+
+  m.def(
+      "register_feature_matcher",
+      [](const std::string& name, py::object factory) {
+        std::shared_ptr<py::object> shared_factory =
+            MakeSharedPyObject(std::move(factory));
+        RegisterFeatureMatcher(
+            name,
+            [shared_factory](const FeatureMatchingOptions& options)
+                -> std::unique_ptr<FeatureMatcher> {
+              py::gil_scoped_acquire acquire;
+              try {
+                return std::make_unique<PyFeatureMatcher>(
+                    MakeSharedPyObject((*shared_factory)(options)));
+              } catch (const std::exception& error) {
+                LOG(ERROR) << "Failed to create custom feature matcher: "
+                           << error.what();
+                return nullptr;
+              }
+            });
+      },
+      "name"_a,
+      "factory"_a,
+      "Register a custom feature matcher for the CUSTOM matcher type. The "
+      "factory is called with the FeatureMatchingOptions once per matching "
+      "thread and must return an object with a method match(image1, image2) "
+      "-> matches, where the images are FeatureMatcherImage objects and "
+      "matches is an Nx2 array of keypoint indices. The object may "
+      "additionally provide match_batch(image_pairs) -> list of matches with "
+      "a max_batch_size attribute to match multiple pairs per call, and "
+      "match_guided(max_error, image1, image2) -> TwoViewGeometry.");
+  m.def("unregister_feature_matcher", &UnregisterFeatureMatcher, "name"_a);
 }
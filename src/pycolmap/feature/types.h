@@ -11,6 +11,23 @@
 
 namespace py = pybind11;
 
+// Wrap a Python object such that it can be shared with C++ threads, which do
+// not hold the GIL. The GIL is acquired when the last reference is released.
+inline std::shared_ptr<py::object> MakeSharedPyObject(py::object object) {
+  return std::shared_ptr<py::object>(
+      new py::object(std::move(object)), [](py::object* object) {
+        if (Py_IsInitialized()) {
+          py::gil_scoped_acquire acquire;
+          delete object;
+        } else {
+          // The interpreter is already finalized, e.g., when the registries of
+          // custom extractors/matchers are destroyed at exit.
+          object->release();
+          delete object;
+        }
+      });
+}
+
 PYBIND11_MAKE_OPAQUE(colmap::FeatureKeypoints);
 
 PYBIND11_MAKE_OPAQUE(colmap::FeatureMatches);
@@ -1,9 +1,14 @@
 #include "colmap/scene/database.h"
 
+#include "colmap/util/logging.h"
+
 #include "pycolmap/pybind11_extension.h"
 
+#include <mutex>
+
 #include <pybind11/eigen.h>
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 
 using namespace colmap;
 using namespace pybind11::literals;
@@ -17,6 +22,8 @@ class DatabaseTransactionWrapper {
       : database_(database) {}
 
   void Enter() {
+    // Do not block other Python threads while waiting for their transactions.
+    py::gil_scoped_release release;
     transaction_ = std::make_unique<DatabaseTransaction>(database_);
   }
 
@@ -27,66 +34,166 @@ class DatabaseTransactionWrapper {
   std::unique_ptr<DatabaseTransaction> transaction_;
 };
 
+// Python threads can access the same database concurrently, when the batch
+// methods release the GIL. Hence, all methods serialize the use of the shared
+// SQL statements with the statement mutex of the database. Methods holding
+// the GIL must not wait for the GIL while holding the mutex.
+template <typename Return, typename... Args>
+auto WithStatementLock(Return (Database::*method)(Args...) const) {
+  return [method](const Database& self, Args... args) -> Return {
+    std::lock_guard<std::mutex> lock(self.StatementMutex());
+    return (self.*method)(std::forward<Args>(args)...);
+  };
+}
+
+template <typename Return, typename... Args>
+auto WithStatementLock(Return (Database::*method)(Args...)) {
+  return [method](Database& self, Args... args) -> Return {
+    std::lock_guard<std::mutex> lock(self.StatementMutex());
+    return (self.*method)(std::forward<Args>(args)...);
+  };
+}
+
+using PyRowOffsets = Eigen::Matrix<int64_t, Eigen::Dynamic, 1>;
+using PyImagePairs = Eigen::Matrix<image_t, Eigen::Dynamic, 2, Eigen::RowMajor>;
+
+// Concatenate the rows of the given matrices into a single matrix, where the
+// rows of the i-th matrix are stored in [offsets[i], offsets[i + 1]). Empty
+// matrices are skipped when determining the number of columns, all other
+// matrices must have the same number of columns.
+template <typename MatrixType>
+std::pair<MatrixType, PyRowOffsets> ConcatenateRows(
+    const std::vector<MatrixType>& matrices) {
+  PyRowOffsets offsets(matrices.size() + 1);
+  offsets(0) = 0;
+  Eigen::Index num_cols = MatrixType::ColsAtCompileTime == Eigen::Dynamic
+                              ? 0
+                              : MatrixType::ColsAtCompileTime;
+  for (size_t i = 0; i < matrices.size(); ++i) {
+    offsets(i + 1) = offsets(i) + matrices[i].rows();
+    if (matrices[i].rows() == 0) {
+      continue;
+    }
+    if (num_cols == 0) {
+      num_cols = matrices[i].cols();
+    } else {
+      THROW_CHECK_EQ(matrices[i].cols(), num_cols)
+          << "All non-empty matrices must have the same number of columns";
+    }
+  }
+
+  MatrixType concatenated(offsets(matrices.size()), num_cols);
+  for (size_t i = 0; i < matrices.size(); ++i) {
+    if (matrices[i].rows() > 0) {
+      concatenated.middleRows(offsets(i), matrices[i].rows()) = matrices[i];
+    }
+  }
+
+  return {std::move(concatenated), std::move(offsets)};
+}
+
+void CheckRowOffsets(const PyRowOffsets& offsets,
+                     const size_t num_items,
+                     const Eigen::Index num_rows) {
+  THROW_CHECK_EQ(offsets.size(), num_items + 1);
+  THROW_CHECK_EQ(offsets(0), 0);
+  THROW_CHECK_EQ(offsets(num_items), num_rows);
+  for (size_t i = 0; i < num_items; ++i) {
+    THROW_CHECK_LE(offsets(i), offsets(i + 1));
+  }
+}
+
 }  // namespace
 
 void BindDatabase(py::module& m) {
   py::class_<Database, std::shared_ptr<Database>> PyDatabase(m, "Database");
   PyDatabase.def(py::init<>())
       .def(py::init<const std::string&>(), "path"_a)
-      .def("open", &Database::Open, "path"_a)
-      .def("close", &Database::Close)
+      .def("open", WithStatementLock(&Database::Open), "path"_a)
+      .def("close", WithStatementLock(&Database::Close))
       .def("__enter__", [](Database& self) { return &self; })
-      .def("__exit__", [](Database& self, const py::args&) { self.Close(); })
-      .def("exists_camera", &Database::ExistsCamera, "camera_id"_a)
-      .def("exists_image", &Database::ExistsImage, "image_id"_a)
-      .def("exists_image", &Database::ExistsImageWithName, "name"_a)
-      .def("exists_pose_prior", &Database::ExistsPosePrior, "image_id"_a)
-      .def("exists_keypoints", &Database::ExistsKeypoints, "image_id"_a)
-      .def("exists_descriptors", &Database::ExistsDescriptors, "image_id"_a)
+      .def("__exit__",
+           [](Database& self, const py::args&) {
+             std::lock_guard<std::mutex> lock(self.StatementMutex());
+             self.Close();
+           })
+      .def("exists_camera",
+           WithStatementLock(&Database::ExistsCamera),
+           "camera_id"_a)
+      .def("exists_image",
+           WithStatementLock(&Database::ExistsImage),
+           "image_id"_a)
+      .def("exists_image",
+           WithStatementLock(&Database::ExistsImageWithName),
+           "name"_a)
+      .def("exists_pose_prior",
+           WithStatementLock(&Database::ExistsPosePrior),
+           "image_id"_a)
+      .def("exists_keypoints",
+           WithStatementLock(&Database::ExistsKeypoints),
+           "image_id"_a)
+      .def("exists_descriptors",
+           WithStatementLock(&Database::ExistsDescriptors),
+           "image_id"_a)
       .def("exists_matches",
-           &Database::ExistsMatches,
+           WithStatementLock(&Database::ExistsMatches),
            "image_id1"_a,
            "image_id2"_a)
       .def("exists_inlier_matches",
-           &Database::ExistsInlierMatches,
+           WithStatementLock(&Database::ExistsInlierMatches),
            "image_id1"_a,
            "image_id2"_a)
-      .def("num_rigs", &Database::NumRigs)
-      .def("num_cameras", &Database::NumCameras)
-      .def("num_frames", &Database::NumFrames)
-      .def("num_images", &Database::NumImages)
-      .def("num_pose_priors", &Database::NumPosePriors)
-      .def("num_keypoints", &Database::NumKeypoints)
+      .def("num_rigs", WithStatementLock(&Database::NumRigs))
+      .def("num_cameras", WithStatementLock(&Database::NumCameras))
+      .def("num_frames", WithStatementLock(&Database::NumFrames))
+      .def("num_images", WithStatementLock(&Database::NumImages))
+      .def("num_pose_priors", WithStatementLock(&Database::NumPosePriors))
+      .def("num_keypoints", WithStatementLock(&Database::NumKeypoints))
       .def("num_keypoints_for_image",
-           &Database::NumKeypointsForImage,
+           WithStatementLock(&Database::NumKeypointsForImage),
            "image_id"_a)
-      .def("num_descriptors", &Database::NumDescriptors)
+      .def("num_descriptors", WithStatementLock(&Database::NumDescriptors))
       .def("num_descriptors_for_image",
-           &Database::NumDescriptorsForImage,
+           WithStatementLock(&Database::NumDescriptorsForImage),
+           "image_id"_a)
+      .def("num_matches", WithStatementLock(&Database::NumMatches))
+      .def("num_inlier_matches", WithStatementLock(&Database::NumInlierMatches))
+      .def("num_matched_image_pairs",
+           WithStatementLock(&Database::NumMatchedImagePairs))
+      .def("num_verified_image_pairs",
+           WithStatementLock(&Database::NumVerifiedImagePairs))
+      .def("read_rig", WithStatementLock(&Database::ReadRig), "rig_id"_a)
+      .def("read_rig_with_sensor",
+           WithStatementLock(&Database::ReadRigWithSensor),
+           "sensor_id"_a)
+      .def("read_all_rigs", WithStatementLock(&Database::ReadAllRigs))
+      .def("read_camera",
+           WithStatementLock(&Database::ReadCamera),
+           "camera_id"_a)
+      .def("read_all_cameras", WithStatementLock(&Database::ReadAllCameras))
+      .def("read_frame", WithStatementLock(&Database::ReadFrame), "frame_id"_a)
+      .def("read_all_frames", WithStatementLock(&Database::ReadAllFrames))
+      .def("read_image", WithStatementLock(&Database::ReadImage), "image_id"_a)
+      .def("read_image_with_name",
+           WithStatementLock(&Database::ReadImageWithName),
+           "name"_a)
+      .def("read_all_images", WithStatementLock(&Database::ReadAllImages))
+      .def("read_pose_prior",
+           WithStatementLock(&Database::ReadPosePrior),
+           "image_id"_a)
+      .def("read_keypoints",
+           WithStatementLock(&Database::ReadKeypointsBlob),
+           "image_id"_a)
+      .def("read_descriptors",
+           WithStatementLock(&Database::ReadDescriptors),
            "image_id"_a)
-      .def("num_matches", &Database::NumMatches)
-      .def("num_inlier_matches", &Database::NumInlierMatches)
-      .def("num_matched_image_pairs", &Database::NumMatchedImagePairs)
-      .def("num_verified_image_pairs", &Database::NumVerifiedImagePairs)
-      .def("read_rig", &Database::ReadRig, "rig_id"_a)
-      .def("read_rig_with_sensor", &Database::ReadRigWithSensor, "sensor_id"_a)
-      .def("read_all_rigs", &Database::ReadAllRigs)
-      .def("read_camera", &Database::ReadCamera, "camera_id"_a)
-      .def("read_all_cameras", &Database::ReadAllCameras)
-      .def("read_frame", &Database::ReadFrame, "frame_id"_a)
-      .def("read_all_frames", &Database::ReadAllFrames)
-      .def("read_image", &Database::ReadImage, "image_id"_a)
-      .def("read_image_with_name", &Database::ReadImageWithName, "name"_a)
-      .def("read_all_images", &Database::ReadAllImages)
-      .def("read_pose_prior", &Database::ReadPosePrior, "image_id"_a)
-      .def("read_keypoints", &Database::ReadKeypointsBlob, "image_id"_a)
-      .def("read_descriptors", &Database::ReadDescriptors, "image_id"_a)
       .def("read_matches",
-           &Database::ReadMatchesBlob,
+           WithStatementLock(&Database::ReadMatchesBlob),
            "image_id1"_a,
            "image_id2"_a)
       .def("read_all_matches",
            [](const Database& self) {
+             std::lock_guard<std::mutex> lock(self.StatementMutex());
              std::vector<std::pair<image_pair_t, FeatureMatchesBlob>>
                  pair_ids_and_matches = self.ReadAllMatchesBlob();
              std::vector<image_pair_t> all_pair_ids;
@@ -100,12 +207,78 @@ void BindDatabase(py::module& m) {
              return std::make_pair(std::move(all_pair_ids),
                                    std::move(all_matches));
            })
+      .def(
+          "read_keypoints_batch",
+          [](const Database& self, const std::vector<image_t>& image_ids) {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(self.StatementMutex());
+            std::vector<FeatureKeypointsBlob> keypoints(image_ids.size());
+            for (size_t i = 0; i < image_ids.size(); ++i) {
+              keypoints[i] = self.ReadKeypointsBlob(image_ids[i]);
+            }
+            return ConcatenateRows(keypoints);
+          },
+          "image_ids"_a,
+          "Read the keypoints of multiple images into a single array. Returns "
+          "the keypoints and the offsets, such that the keypoints of the i-th "
+          "image are keypoints[offsets[i]:offsets[i + 1]].")
+      .def(
+          "read_descriptors_batch",
+          [](const Database& self, const std::vector<image_t>& image_ids) {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(self.StatementMutex());
+            std::vector<FeatureDescriptors> descriptors(image_ids.size());
+            for (size_t i = 0; i < image_ids.size(); ++i) {
+              descriptors[i] = self.ReadDescriptors(image_ids[i]);
+            }
+            return ConcatenateRows(descriptors);
+          },
+          "image_ids"_a,
+          "Read the descriptors of multiple images into a single array. "
+          "Returns the descriptors and the offsets, such that the descriptors "
+          "of the i-th image are descriptors[offsets[i]:offsets[i + 1]].")
+      .def(
+          "read_matches_batch",
+          [](const Database& self, const PyImagePairs& image_pairs) {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(self.StatementMutex());
+            std::vector<FeatureMatchesBlob> matches(image_pairs.rows());
+            for (Eigen::Index i = 0; i < image_pairs.rows(); ++i) {
+              matches[i] =
+                  self.ReadMatchesBlob(image_pairs(i, 0), image_pairs(i, 1));
+            }
+            return ConcatenateRows(matches);
+          },
+          "image_pairs"_a,
+          "Read the matches of multiple image pairs, given as an Nx2 array of "
+          "image identifiers, into a single array. Returns the matches and the "
+          "offsets, such that the matches of the i-th pair are "
+          "matches[offsets[i]:offsets[i + 1]].")
+      .def(
+          "read_two_view_geometries_batch",
+          [](const Database& self, const PyImagePairs& image_pairs) {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(self.StatementMutex());
+            std::vector<TwoViewGeometry> two_view_geometries;
+            two_view_geometries.reserve(image_pairs.rows());
+            for (Eigen::Index i = 0; i < image_pairs.rows(); ++i) {
+              two_view_geometries.push_back(self.ReadTwoViewGeometry(
+                  image_pairs(i, 0), image_pairs(i, 1)));
+            }
+            return two_view_geometries;
+          },
+          "image_pairs"_a,
+          "Read the two-view geometries of multiple image pairs, given as an "
+          "Nx2 array of image identifiers. Can be combined with "
+          "read_two_view_geometry_num_inliers to iterate over all two-view "
+          "geometries in chunks.")
       .def("read_two_view_geometry",
-           &Database::ReadTwoViewGeometry,
+           WithStatementLock(&Database::ReadTwoViewGeometry),
            "image_id1"_a,
            "image_id2"_a)
       .def("read_two_view_geometries",
            [](const Database& self) {
+             std::lock_guard<std::mutex> lock(self.StatementMutex());
              std::vector<std::pair<image_pair_t, TwoViewGeometry>>
                  pair_ids_and_two_view_geometries =
                      self.ReadTwoViewGeometries();
@@ -125,6 +298,7 @@ void BindDatabase(py::module& m) {
       .def(
           "read_two_view_geometry_num_inliers",
           [](const Database& self) {
+            std::lock_guard<std::mutex> lock(self.StatementMutex());
             std::vector<std::pair<image_pair_t, int>> pair_ids_and_num_inliers =
                 self.ReadTwoViewGeometryNumInliers();
             std::vector<image_pair_t> all_pair_ids;
@@ -139,55 +313,133 @@ void BindDatabase(py::module& m) {
                                   std::move(all_num_inliers));
           })
       .def("write_camera",
-           &Database::WriteCamera,
+           WithStatementLock(&Database::WriteCamera),
            "camera"_a,
            "use_camera_id"_a = false)
       .def("write_image",
-           &Database::WriteImage,
+           WithStatementLock(&Database::WriteImage),
            "image"_a,
            "use_image_id"_a = false)
       .def("write_pose_prior",
-           &Database::WritePosePrior,
+           WithStatementLock(&Database::WritePosePrior),
            "image_id"_a,
            "pose_prior"_a)
       .def("write_keypoints",
-           py::overload_cast<image_t, const FeatureKeypointsBlob&>(
-               &Database::WriteKeypoints, py::const_),
+           WithStatementLock(
+               py::overload_cast<image_t, const FeatureKeypointsBlob&>(
+                   &Database::WriteKeypoints, py::const_)),
            "image_id"_a,
            "keypoints"_a)
       .def("write_descriptors",
-           &Database::WriteDescriptors,
+           WithStatementLock(&Database::WriteDescriptors),
            "image_id"_a,
            "descriptors"_a)
       .def("write_matches",
-           py::overload_cast<image_t, image_t, const FeatureMatchesBlob&>(
-               &Database::WriteMatches, py::const_),
+           WithStatementLock(
+               py::overload_cast<image_t, image_t, const FeatureMatchesBlob&>(
+                   &Database::WriteMatches, py::const_)),
            "image_id1"_a,
            "image_id2"_a,
            "matches"_a)
+      .def(
+          "write_keypoints_batch",
+          [](Database& self,
+             const std::vector<image_t>& image_ids,
+             const FeatureKeypointsBlob& keypoints,
+             const PyRowOffsets& offsets) {
+            CheckRowOffsets(offsets, image_ids.size(), keypoints.rows());
+            py::gil_scoped_release release;
+            // Part of the active transaction, if the calling thread owns one.
+            DatabaseTransaction transaction(&self);
+            std::lock_guard<std::mutex> lock(self.StatementMutex());
+            for (size_t i = 0; i < image_ids.size(); ++i) {
+              self.WriteKeypoints(
+                  image_ids[i],
+                  FeatureKeypointsBlob(keypoints.middleRows(
+                      offsets(i), offsets(i + 1) - offsets(i))));
+            }
+          },
+          "image_ids"_a,
+          "keypoints"_a,
+          "offsets"_a,
+          "Write the keypoints of multiple images in a single transaction. "
+          "The keypoints of the i-th image are "
+          "keypoints[offsets[i]:offsets[i + 1]].")
+      .def(
+          "write_descriptors_batch",
+          [](Database& self,
+             const std::vector<image_t>& image_ids,
+             const FeatureDescriptors& descriptors,
+             const PyRowOffsets& offsets) {
+            CheckRowOffsets(offsets, image_ids.size(), descriptors.rows());
+            py::gil_scoped_release release;
+            // Part of the active transaction, if the calling thread owns one.
+            DatabaseTransaction transaction(&self);
+            std::lock_guard<std::mutex> lock(self.StatementMutex());
+            for (size_t i = 0; i < image_ids.size(); ++i) {
+              self.WriteDescriptors(
+                  image_ids[i],
+                  FeatureDescriptors(descriptors.middleRows(
+                      offsets(i), offsets(i + 1) - offsets(i))));
+            }
+          },
+          "image_ids"_a,
+          "descriptors"_a,
+          "offsets"_a,
+          "Write the descriptors of multiple images in a single transaction. "
+          "The descriptors of the i-th image are "
+          "descriptors[offsets[i]:offsets[i + 1]].")
+      .def(
+          "write_matches_batch",
+          [](Database& self,
+             const PyImagePairs& image_pairs,
+             const FeatureMatchesBlob& matches,
+             const PyRowOffsets& offsets) {
+            CheckRowOffsets(offsets, image_pairs.rows(), matches.rows());
+            py::gil_scoped_release release;
+            // Part of the active transaction, if the calling thread owns one.
+            DatabaseTransaction transaction(&self);
+            std::lock_guard<std::mutex> lock(self.StatementMutex());
+            for (Eigen::Index i = 0; i < image_pairs.rows(); ++i) {
+              self.WriteMatches(
+                  image_pairs(i, 0),
+                  image_pairs(i, 1),
+                  FeatureMatchesBlob(matches.middleRows(
+                      offsets(i), offsets(i + 1) - offsets(i))));
+            }
+          },
+          "image_pairs"_a,
+          "matches"_a,
+          "offsets"_a,
+          "Write the matches of multiple image pairs, given as an Nx2 array of "
+          "image identifiers, in a single transaction. The matches of the i-th "
+          "pair are matches[offsets[i]:offsets[i + 1]].")
       .def("write_two_view_geometry",
-           &Database::WriteTwoViewGeometry,
+           WithStatementLock(&Database::WriteTwoViewGeometry),
            "image_id1"_a,
            "image_id2"_a,
            "two_view_geometry"_a)
-      .def("update_camera", &Database::UpdateCamera, "camera"_a)
-      .def("update_image", &Database::UpdateImage, "image"_a)
+      .def("update_camera",
+           WithStatementLock(&Database::UpdateCamera),
+           "camera"_a)
+      .def("update_image", WithStatementLock(&Database::UpdateImage), "image"_a)
       .def("delete_matches",
-           &Database::DeleteMatches,
+           WithStatementLock(&Database::DeleteMatches),
            "image_id1"_a,
            "image_id2"_a)
       .def("delete_inlier_matches",
-           &Database::DeleteInlierMatches,
+           WithStatementLock(&Database::DeleteInlierMatches),
            "image_id1"_a,
            "image_id2"_a)
-      .def("clear_all_tables", &Database::ClearAllTables)
-      .def("clear_cameras", &Database::ClearCameras)
-      .def("clear_images", &Database::ClearImages)
-      .def("clear_pose_priors", &Database::ClearPosePriors)
-      .def("clear_descriptors", &Database::ClearDescriptors)
-      .def("clear_keypoints", &Database::ClearKeypoints)
-      .def("clear_matches", &Database::ClearMatches)
-      .def("clear_two_view_geometries", &Database::ClearTwoViewGeometries)
+      .def("clear_all_tables", WithStatementLock(&Database::ClearAllTables))
+      .def("clear_cameras", WithStatementLock(&Database::ClearCameras))
+      .def("clear_images", WithStatementLock(&Database::ClearImages))
+      .def("clear_pose_priors", WithStatementLock(&Database::ClearPosePriors))
+      .def("clear_descriptors", WithStatementLock(&Database::ClearDescriptors))
+      .def("clear_keypoints", WithStatementLock(&Database::ClearKeypoints))
+      .def("clear_matches", WithStatementLock(&Database::ClearMatches))
+      .def("clear_two_view_geometries",
+           WithStatementLock(&Database::ClearTwoViewGeometries))
       .def_static("merge",
                   &Database::Merge,
                   "database1"_a,
@@ -38,6 +38,46 @@ std::shared_ptr<Image> MakeImage(const std::string& name,
   return image;
 }
 
+using PyPoints2DXY = Eigen::Matrix<double, Eigen::Dynamic, 2, Eigen::RowMajor>;
+using PyPoint3DIds = Eigen::Matrix<point3D_t, Eigen::Dynamic, 1>;
+
+// Gather the keypoints and their 3D point identifiers into contiguous arrays,
+// which are moved into the returned NumPy arrays without additional copies.
+py::dict Points2DToArrays(const Image& image) {
+  const Eigen::Index num_points2D = image.NumPoints2D();
+  PyPoints2DXY xy(num_points2D, 2);
+  PyPoint3DIds point3D_ids(num_points2D);
+  for (Eigen::Index i = 0; i < num_points2D; ++i) {
+    const struct Point2D& point2D = image.Point2D(i);
+    xy.row(i) = point2D.xy;
+    point3D_ids(i) = point2D.point3D_id;
+  }
+  return py::dict("xy"_a = std::move(xy),
+                  "point3D_ids"_a = std::move(point3D_ids));
+}
+
+void SetPoints2DFromArrays(Image& image,
+                           const Eigen::Ref<const PyPoints2DXY>& xy,
+                           const std::optional<PyPoint3DIds>& point3D_ids) {
+  const Eigen::Index num_points2D = image.NumPoints2D();
+  THROW_CHECK_EQ(xy.rows(), num_points2D);
+  if (point3D_ids) {
+    THROW_CHECK_EQ(point3D_ids->size(), num_points2D);
+  }
+  for (Eigen::Index i = 0; i < num_points2D; ++i) {
+    image.Point2D(i).xy = xy.row(i);
+    if (!point3D_ids) {
+      continue;
+    }
+    const point3D_t point3D_id = (*point3D_ids)(i);
+    if (point3D_id == kInvalidPoint3DId) {
+      image.ResetPoint3DForPoint2D(i);
+    } else {
+      image.SetPoint3DForPoint2D(i, point3D_id);
+    }
+  }
+}
+
 void BindSceneImage(py::module& m) {
   py::class_<Image, std::shared_ptr<Image>> PyImage(m, "Image");
   PyImage.def(py::init<>())
@@ -160,6 +200,19 @@ void BindSceneImage(py::module& m) {
           &Image::NumPoints3D,
           "Get the number of triangulations, i.e. the number of points that\n"
           "are part of a 3D point track.")
+      .def("points2D_arrays",
+           &Points2DToArrays,
+           "Get the keypoints as a dictionary of contiguous arrays with the "
+           "keys xy and point3D_ids. Much faster than iterating over points2D "
+           "for images with many keypoints.")
+      .def("set_points2D_arrays",
+           &SetPoints2DFromArrays,
+           "xy"_a,
+           "point3D_ids"_a = py::none(),
+           "Set the positions and optionally the 3D point identifiers of all "
+           "existing keypoints from contiguous arrays. Invalid identifiers "
+           "reset the 3D point of the keypoint. Note that this does not update "
+           "the tracks of a reconstruction containing the image.")
       .def(
           "get_observation_point2D_idxs",
           [](const Image& self) {
@@ -15,6 +15,7 @@
 #include "pycolmap/scene/types.h"
 
 #include <memory>
+#include <optional>
 #include <sstream>
 
 #include <pybind11/eigen.h>
@@ -26,6 +27,92 @@ using namespace colmap;
 using namespace pybind11::literals;
 namespace py = pybind11;
 
+using PyPoints3DXYZ = Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>;
+using PyPoints3DColor =
+    Eigen::Matrix<uint8_t, Eigen::Dynamic, 3, Eigen::RowMajor>;
+
+// Gather all 3D points into contiguous arrays in the memory order of the
+// reconstruction. The track of the i-th point is stored in the elements
+// [track_offsets[i], track_offsets[i + 1]) of the track arrays. The arrays are
+// moved into the returned NumPy arrays without additional copies. The GIL is
+// held throughout, since the reconstruction is owned by Python and may be
+// modified concurrently by other Python threads.
+py::dict Points3DToArrays(const Reconstruction& reconstruction) {
+  const Point3DMap& points3D = reconstruction.Points3D();
+  const Eigen::Index num_points3D = points3D.size();
+
+  Eigen::Matrix<point3D_t, Eigen::Dynamic, 1> point3D_ids(num_points3D);
+  PyPoints3DXYZ xyz(num_points3D, 3);
+  PyPoints3DColor color(num_points3D, 3);
+  Eigen::VectorXd error(num_points3D);
+  Eigen::Matrix<int64_t, Eigen::Dynamic, 1> track_offsets(num_points3D + 1);
+  Eigen::Matrix<image_t, Eigen::Dynamic, 1> track_image_ids;
+  Eigen::Matrix<point2D_t, Eigen::Dynamic, 1> track_point2D_idxs;
+
+  Eigen::Index i = 0;
+  track_offsets(0) = 0;
+  for (const auto& [point3D_id, point3D] : points3D) {
+    point3D_ids(i) = point3D_id;
+    xyz.row(i) = point3D.xyz;
+    color.row(i) = point3D.color;
+    error(i) = point3D.error;
+    track_offsets(i + 1) = track_offsets(i) + point3D.track.Length();
+    ++i;
+  }
+
+  track_image_ids.resize(track_offsets(num_points3D));
+  track_point2D_idxs.resize(track_offsets(num_points3D));
+  i = 0;
+  for (const auto& [_, point3D] : points3D) {
+    Eigen::Index j = track_offsets(i++);
+    for (const TrackElement& track_el : point3D.track.Elements()) {
+      track_image_ids(j) = track_el.image_id;
+      track_point2D_idxs(j) = track_el.point2D_idx;
+      ++j;
+    }
+  }
+
+  return py::dict("point3D_ids"_a = std::move(point3D_ids),
+                  "xyz"_a = std::move(xyz),
+                  "color"_a = std::move(color),
+                  "error"_a = std::move(error),
+                  "track_offsets"_a = std::move(track_offsets),
+                  "track_image_ids"_a = std::move(track_image_ids),
+                  "track_point2D_idxs"_a = std::move(track_point2D_idxs));
+}
+
+void SetPoints3DFromArrays(
+    Reconstruction& reconstruction,
+    const Eigen::Ref<const Eigen::Matrix<point3D_t, Eigen::Dynamic, 1>>&
+        point3D_ids,
+    const Eigen::Ref<const PyPoints3DXYZ>& xyz,
+    const std::optional<PyPoints3DColor>& color,
+    const std::optional<Eigen::VectorXd>& error) {
+  const Eigen::Index num_points3D = point3D_ids.size();
+  THROW_CHECK_EQ(xyz.rows(), num_points3D);
+  if (color) {
+    THROW_CHECK_EQ(color->rows(), num_points3D);
+  }
+  if (error) {
+    THROW_CHECK_EQ(error->size(), num_points3D);
+  }
+  for (Eigen::Index i = 0; i < num_points3D; ++i) {
+    THROW_CHECK(reconstruction.ExistsPoint3D(point3D_ids(i)))
+        << "3D point " << point3D_ids(i) << " does not exist";
+  }
+
+  for (Eigen::Index i = 0; i < num_points3D; ++i) {
+    Point3D& point3D = reconstruction.Point3D(point3D_ids(i));
+    point3D.xyz = xyz.row(i);
+    if (color) {
+      point3D.color = color->row(i);
+    }
+    if (error) {
+      point3D.error = (*error)(i);
+    }
+  }
+}
+
 void BindReconstruction(py::module& m) {
   py::class_<Reconstruction, std::shared_ptr<Reconstruction>>(m,
                                                               "Reconstruction")
@@ -88,14 +175,38 @@ void BindReconstruction(py::module& m) {
            "image_id"_a,
            "Direct accessor for an image.",
            py::return_value_policy::reference_internal)
-      .def_property_readonly("points3D",
-                             &Reconstruction::Points3D,
-                             py::return_value_policy::reference_internal)
+      // The 3D points are stored contiguously and move when 3D points are
+      // added or deleted, so Python references into the storage must be
+      // obtained again after such modifications.
+      .def_property_readonly(
+          "points3D",
+          &Reconstruction::Points3D,
+          py::return_value_policy::reference_internal,
+          "Reference to all 3D points. References to the map and its 3D "
+          "points are invalidated when 3D points are added or deleted.")
       .def("point3D",
            py::overload_cast<point3D_t>(&Reconstruction::Point3D),
            "point3D_id"_a,
-           "Direct accessor for a Point3D.",
+           "Direct accessor for a Point3D. The returned reference is "
+           "invalidated when 3D points are added or deleted.",
            py::return_value_policy::reference_internal)
+      .def("points3D_arrays",
+           &Points3DToArrays,
+           "Get all 3D points as a dictionary of contiguous arrays with the "
+           "keys point3D_ids, xyz, color, error, track_offsets, "
+           "track_image_ids, and track_point2D_idxs. The track of the i-th "
+           "point is given by the elements track_offsets[i] to "
+           "track_offsets[i + 1] of the track arrays. Much faster than "
+           "iterating over points3D for large reconstructions.")
+      .def("set_points3D_arrays",
+           &SetPoints3DFromArrays,
+           "point3D_ids"_a,
+           "xyz"_a,
+           "color"_a = py::none(),
+           "error"_a = py::none(),
+           "Set the positions and optionally the colors and errors of the "
+           "given existing 3D points from contiguous arrays. Tracks must be "
+           "modified through add_observation and delete_observation.")
       .def("reg_image_ids", &Reconstruction::RegImageIds)
       .def("reg_frame_ids", &Reconstruction::RegFrameIds)
       .def("point3D_ids", &Reconstruction::Point3DIds)
@@ -180,6 +291,7 @@ void BindReconstruction(py::module& m) {
       .def("transform",
            &Reconstruction::Transform,
            "new_from_old_world"_a,
+           "num_threads"_a = 1,
            "Apply the 3D similarity transformation to all images and points.")
       .def("compute_centroid",
            &Reconstruction::ComputeCentroid,
@@ -202,13 +314,16 @@ void BindReconstruction(py::module& m) {
            "other"_a,
            "Find images that are both present in this and the given "
            "reconstruction.")
-      .def("update_point_3d_errors", &Reconstruction::UpdatePoint3DErrors)
+      .def("update_point_3d_errors",
+           &Reconstruction::UpdatePoint3DErrors,
+           "num_threads"_a = 1)
       .def("compute_num_observations", &Reconstruction::ComputeNumObservations)
       .def("compute_mean_track_length", &Reconstruction::ComputeMeanTrackLength)
       .def("compute_mean_observations_per_reg_image",
            &Reconstruction::ComputeMeanObservationsPerRegImage)
       .def("compute_mean_reprojection_error",
-           &Reconstruction::ComputeMeanReprojectionError)
+           &Reconstruction::ComputeMeanReprojectionError,
+           "num_threads"_a = 1)
       .def("import_PLY",
            py::overload_cast<const std::string&>(&Reconstruction::ImportPLY),
            "path"_a,
@@ -230,7 +345,8 @@ void BindReconstruction(py::module& m) {
            &Reconstruction::ExtractColorsForAllImages,
            "Extract colors for all 3D points by computing the mean color of "
            "all images.",
-           "path"_a)
+           "path"_a,
+           "num_threads"_a = 1)
       .def("create_image_dirs",
            &Reconstruction::CreateImageDirs,
            "path"_a,
@@ -5,6 +5,7 @@
 #include "colmap/scene/image.h"
 #include "colmap/scene/point2d.h"
 #include "colmap/scene/point3d.h"
+#include "colmap/util/dense_id_map.h"
 #include "colmap/util/types.h"
 
 #include <pybind11/eigen.h>
@@ -27,5 +28,5 @@ PYBIND11_MAKE_OPAQUE(ImageMap);
 using Point2DVector = std::vector<struct colmap::Point2D>;
 PYBIND11_MAKE_OPAQUE(Point2DVector);
 
-using Point3DMap = std::unordered_map<colmap::point3D_t, colmap::Point3D>;
+using Point3DMap = colmap::DenseIdMap<colmap::point3D_t, colmap::Point3D>;
 PYBIND11_MAKE_OPAQUE(Point3DMap);
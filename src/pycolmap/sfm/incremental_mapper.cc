@@ -184,6 +184,18 @@ void BindIncrementalPipeline(py::module& m) {
                      &Opts::fix_existing_frames,
                      "If reconstruction is provided as input, fix the existing "
                      "frame poses.")
+      .def_readwrite("parallel_point_triangulation",
+                     &Opts::parallel_point_triangulation,
+                     "Whether to triangulate all tracks of an existing "
+                     "reconstruction at once in parallel instead of image by "
+                     "image. Only used when triangulating points for known "
+                     "poses.")
+      .def_readwrite("init_frames_from_pose_priors",
+                     &Opts::init_frames_from_pose_priors,
+                     "Whether to initialize the reconstruction by registering "
+                     "all frames with pose priors at once instead of from an "
+                     "initial image pair. Only used together with "
+                     "use_prior_position and requires accurate priors.")
       .def_readwrite("constant_cameras",
                      &Opts::constant_cameras,
                      "List of cameras for which to fix the camera parameters "
@@ -262,6 +274,11 @@ void BindIncrementalPipeline(py::module& m) {
            "mapper"_a,
            "mapper_options"_a,
            "reconstruction"_a)
+      .def("initialize_reconstruction_from_pose_priors",
+           &IncrementalPipeline::InitializeReconstructionFromPosePriors,
+           "mapper"_a,
+           "mapper_options"_a,
+           "reconstruction"_a)
       .def("run", &IncrementalPipeline::Run);
 }
 
@@ -447,6 +464,13 @@ void BindIncrementalMapperImpl(py::module& m) {
            &IncrementalMapper::RegisterNextImage,
            "options"_a,
            "image_id"_a)
+      .def("register_next_image_from_candidates",
+           &IncrementalMapper::RegisterNextImageFromCandidates,
+           "options"_a,
+           "image_ids"_a)
+      .def("register_frames_from_pose_priors",
+           &IncrementalMapper::RegisterFramesFromPosePriors,
+           "options"_a)
       .def("triangulate_image",
            &IncrementalMapper::TriangulateImage,
            "tri_options"_a,
@@ -74,6 +74,10 @@ void BindIncrementalTriangulator(py::module& m) {
           "random_seed",
           &Opts::random_seed,
           "PRNG seed for all stochastic methods during triangulation.")
+      .def_readwrite("num_threads",
+                     &Opts::num_threads,
+                     "Number of threads to estimate independent new "
+                     "triangulations in parallel.")
       .def("check", &Opts::Check);
   MakeDataclass(PyOpts);
 
@@ -93,6 +97,9 @@ void BindIncrementalTriangulator(py::module& m) {
            &IncrementalTriangulator::TriangulateImage,
            "options"_a,
            "image_id"_a)
+      .def("triangulate_all_tracks",
+           &IncrementalTriangulator::TriangulateAllTracks,
+           "options"_a)
       .def("complete_image",
            &IncrementalTriangulator::CompleteImage,
            "options"_a,
@@ -63,6 +63,7 @@ void BindObservationManager(py::module& m) {
            "max_reproj_error"_a,
            "min_tri_angle"_a,
            "point3D_ids"_a,
+           "num_threads"_a = 1,
            "Filter 3D points with large reprojection error, negative depth, or"
            "insufficient triangulation angle. Return the number of filtered "
            "observations.")
@@ -71,6 +72,7 @@ void BindObservationManager(py::module& m) {
            "max_reproj_error"_a,
            "min_tri_angle"_a,
            "image_ids"_a,
+           "num_threads"_a = 1,
            "Filter 3D points with large reprojection error, negative depth, or"
            "insufficient triangulation angle. Return the number of filtered "
            "observations.")
@@ -78,6 +80,7 @@ void BindObservationManager(py::module& m) {
            &ObservationManager::FilterAllPoints3D,
            "max_reproj_error"_a,
            "min_tri_angle"_a,
+           "num_threads"_a = 1,
            "Filter 3D points with large reprojection error, negative depth, or"
            "insufficient triangulation angle. Return the number of filtered "
            "observations.")